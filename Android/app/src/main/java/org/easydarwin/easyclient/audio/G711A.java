@@ -1,6 +1,22 @@
 package org.easydarwin.easyclient.audio;
 /*G711A--PCMA*/
 public class G711A {
+	/** native codec (libEasyG711.so), the java loops below are used when it is missing */
+	private static boolean sNative = false;
+
+	static {
+		try {
+			System.loadLibrary("EasyG711");
+			sNative = true;
+		} catch (UnsatisfiedLinkError e) {
+			sNative = false;
+		}
+	}
+
+	private static native int nativeEncode(byte[] src, int offset, int len, byte[] res);
+
+	private static native int nativeDecode(byte[] src, int offset, int len, byte[] res);
+
 	/** decompress table constants */
 	private static short aLawDecompressTable[] = new short[] { -5504, -5248,
 			-6016, -5760, -4480, -4224, -4992, -4736, -7552, -7296, -8064,
@@ -49,6 +65,9 @@ public class G711A {
 	* @返回 int  压缩后的数据长度
 	*/
 	public int encode(byte[] src, int offset, int len, byte[] res) {
+		if (sNative) {
+			return nativeEncode(src, offset, len, res);
+		}
 		int j = offset;
 		int count = len / 2;
 		short sample = 0;
@@ -94,6 +113,10 @@ public class G711A {
 	* @返回 void
 	*/
 	public void decode(byte[] src, int offset, int len, byte[] res) {
+		if (sNative) {
+			nativeDecode(src, offset, len, res);
+			return;
+		}
 		int j = 0;
 		for (int i = 0; i < len; i++) {
 			short s = aLawDecompressTable[src[i + offset] & 0xff];
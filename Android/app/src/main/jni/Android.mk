@@ -0,0 +1,13 @@
+LOCAL_PATH := $(call my-dir)
+
+EASY_PROTOCOL_PATH := $(LOCAL_PATH)/../../../../../win32/EasyProtocol
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := EasyG711
+LOCAL_SRC_FILES := EasyG711JNI.cpp \
+	../../../../../win32/EasyProtocol/EasyProtocol/EasyG711.cpp
+LOCAL_C_INCLUDES := $(EASY_PROTOCOL_PATH)/Include
+LOCAL_CFLAGS := -O2
+
+include $(BUILD_SHARED_LIBRARY)
@@ -0,0 +1,4 @@
+# armeabi only: the prebuilt libraries in jniLibs are armeabi, an armeabi-v7a directory would hide them
+APP_ABI := armeabi
+APP_PLATFORM := android-16
+APP_STL := c++_static
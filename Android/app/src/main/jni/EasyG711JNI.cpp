@@ -0,0 +1,76 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyG711JNI.cpp
+ *
+ * Native methods of org.easydarwin.easyclient.audio.G711A
+*/
+
+#include <jni.h>
+#include <EasyG711.h>
+
+//what the java loops would do: NullPointerException or ArrayIndexOutOfBoundsException when src[offset, offset+len)
+//is not inside src or res is shorter than resBytes; false with the exception pending
+static bool __CheckRange(JNIEnv *env, jbyteArray src, jint offset, jint len, jbyteArray res, jint resBytes)
+{
+	if (NULL == src || NULL == res)
+	{
+		env->ThrowNew(env->FindClass("java/lang/NullPointerException"), NULL);
+		return false;
+	}
+	jint srcLen = env->GetArrayLength(src);
+	if (offset < 0 || offset > srcLen || len > srcLen - offset || resBytes > env->GetArrayLength(res))
+	{
+		env->ThrowNew(env->FindClass("java/lang/ArrayIndexOutOfBoundsException"), NULL);
+		return false;
+	}
+	return true;
+}
+
+extern "C" {
+
+//src: little-endian 16bit pcm, len in bytes; returns the number of A-law bytes written
+JNIEXPORT jint JNICALL Java_org_easydarwin_easyclient_audio_G711A_nativeEncode(JNIEnv *env, jclass clazz, jbyteArray src, jint offset, jint len, jbyteArray res)
+{
+	int samples = len / 2;
+	if (samples <= 0)	return 0;
+	if (!__CheckRange(env, src, offset, samples * 2, res, samples))	return -1;
+
+	jbyte *pSrc = (jbyte *)env->GetPrimitiveArrayCritical(src, NULL);
+	jbyte *pRes = (jbyte *)env->GetPrimitiveArrayCritical(res, NULL);
+	int ret = -1;
+	if (NULL != pSrc && NULL != pRes)
+	{
+		ret = EasyG711::ALawEncode((unsigned char *)pRes, (const short *)(pSrc + offset), samples);
+	}
+	if (NULL != pRes)	env->ReleasePrimitiveArrayCritical(res, pRes, 0);
+	if (NULL != pSrc)	env->ReleasePrimitiveArrayCritical(src, pSrc, JNI_ABORT);
+
+	return ret;
+}
+
+//len: A-law bytes; res receives len*2 bytes of little-endian 16bit pcm
+JNIEXPORT jint JNICALL Java_org_easydarwin_easyclient_audio_G711A_nativeDecode(JNIEnv *env, jclass clazz, jbyteArray src, jint offset, jint len, jbyteArray res)
+{
+	if (len <= 0)	return 0;
+	//len*2 past jint cannot fit any res
+	if (!__CheckRange(env, src, offset, len, res, len > 0x3FFFFFFF ? 0x7FFFFFFF : len * 2))	return -1;
+
+	jbyte *pSrc = (jbyte *)env->GetPrimitiveArrayCritical(src, NULL);
+	jbyte *pRes = (jbyte *)env->GetPrimitiveArrayCritical(res, NULL);
+	int ret = -1;
+	if (NULL != pSrc && NULL != pRes)
+	{
+		ret = EasyG711::ALawDecode((short *)pRes, (const unsigned char *)(pSrc + offset), len);
+	}
+	if (NULL != pRes)	env->ReleasePrimitiveArrayCritical(res, pRes, 0);
+	if (NULL != pSrc)	env->ReleasePrimitiveArrayCritical(src, pSrc, JNI_ABORT);
+
+	return ret;
+}
+
+}
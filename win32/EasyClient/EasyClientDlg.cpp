@@ -67,9 +67,14 @@ CEasyClientDlg::CEasyClientDlg(CWnd* pParent /*=NULL*/)
 	InitialComponents();
 
 	SetUnhandledExceptionFilter((LPTOP_LEVEL_EXCEPTION_FILTER)CrashHandler_Player);
-	m_pSession = NULL;
 	m_strCMSIP = _T("121.40.50.44"); //121.40.50.44 192.168.1.121
 	m_nCMSPort = 10000;
+	//CMSӿ߳, ÿ½TCP
+	m_pCMSClient = new EasyDarwin::Protocol::EasyHttpClient(ToAnsi(m_strCMSIP), (unsigned short)m_nCMSPort);
+	//PTZֻһһ߳, ֤stopƶ
+	m_pPTZClient = new EasyDarwin::Protocol::EasyHttpClient(ToAnsi(m_strCMSIP), (unsigned short)m_nCMSPort, 1);
+	m_pFetcher = new EasyDarwin::Protocol::EasyFetchScheduler();
+	m_bQuit = false;
 	m_nCurSelWnd = -1;
 	m_hReqDeviceListThread = INVALID_HANDLE_VALUE;
 	m_bReqDeviceListThreadRuning = false;
@@ -87,6 +92,8 @@ BEGIN_MESSAGE_MAP(CEasyClientDlg, CSkinDialog)
 	ON_WM_PAINT()
 	ON_WM_QUERYDRAGICON()
 	ON_MESSAGE(WM_WINDOW_MAXIMIZED, OnWindowMaximized)
+	ON_MESSAGE(WM_DEVICE_LIST, OnDeviceList)
+	ON_MESSAGE(WM_DEVICE_CHANNELS, OnDeviceChannels)
 	ON_CBN_SELCHANGE(IDC_COMBO_SPLIT_SCREEN, &CEasyClientDlg::OnCbnSelchangeComboSplitScreen)
 	ON_CBN_SELCHANGE(IDC_COMBO_RENDER_FORMAT, &CEasyClientDlg::OnCbnSelchangeComboRenderFormat)
 	ON_BN_CLICKED(IDC_CHECK_SHOWNTOSCALE, &CEasyClientDlg::OnBnClickedCheckShowntoscale)
@@ -243,12 +250,19 @@ int CEasyClientDlg::SendHttpReqDeviceList()
 {
 	if (!m_bReqDeviceListThreadRuning)
 	{
+		//һε߳Ѿ
+		if (m_hReqDeviceListThread != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_hReqDeviceListThread);
+			m_hReqDeviceListThread = INVALID_HANDLE_VALUE;
+		}
 		m_bReqDeviceListThreadRuning = true;
 		//߳
 		m_hReqDeviceListThread=(HANDLE)_beginthreadex(NULL,0,(&CEasyClientDlg::ReqDeviceListThread),
 			this,THREAD_PRIORITY_NORMAL,NULL);
 		if (!m_hReqDeviceListThread)
 		{
+			m_hReqDeviceListThread = INVALID_HANDLE_VALUE;
 			m_bReqDeviceListThreadRuning = false;
 			return -1;
 		}
@@ -283,206 +297,295 @@ void CEasyClientDlg::ProcessReqDevListThread()
 
 	if (m_pTreeCtrDevList)
 	{
-		DeleteChildren(m_pTreeCtrDevList, m_hRoot);
-
 		//1. 豸б
-		CString strReqURL =_T(""); 
-		strReqURL.Format(_T("http://%s:%d/API/getdevicelist"), m_strCMSIP, m_nCMSPort);
-		if (!m_pSession)
+		std::string strData;
+		if (!RequestCMS("/API/getdevicelist", strData))
 		{
-			m_pSession = new CInternetSession(/*_T("Mozilla/5.0 (compatible; MSIE 9.0; Windows NT 6.1; Trident/5.0)")*/);
+			//not get any devices, ǰ豸
+			return;
 		}
 
-		std::string strData;
-		CHttpFile *pFile = (CHttpFile *)m_pSession->OpenURL(strReqURL, 1, INTERNET_FLAG_TRANSFER_ASCII | INTERNET_FLAG_RELOAD);
-		if (pFile)
+		//Jsonִ
+		EasyDarwin::Protocol::EasyMsgSCDeviceListACK deviceListAck(strData);
+		if (atoi(deviceListAck.GetHeaderValue(EASY_TAG_ERROR_NUM).c_str()) != EASY_ERROR_SUCCESS_OK)
 		{
-			char ch;
-			while (pFile->Read(&ch, 1))
-			{
-				strData += ch;
-			}
-			pFile->Close();
-			delete pFile;
-			pFile = NULL;
+			return;
 		}
 
-		//CString  m_strCode = (CString)strData.c_str();
-		if (!strData.empty())
+		//2~3. 豸ֻڽ߳, ͬOnDeviceList; Իʱٷ
+		if (m_bQuit)
 		{
-			m_devicesInfo.clear();
-			//Jsonִ
-			EasyDarwin::Protocol::EasyMsgSCDeviceListACK deviceListAck(strData.c_str());
-			EasyDarwin::Protocol::EasyDevices m_devices = deviceListAck.GetDevices();
-			int i = 0;
-			CString strTrmp = _T("");
-			for (EasyDevices::iterator it = m_devices.begin(); it != m_devices.end(); it++)
-			{
-#if 0
-				strTrmp = it->second.serial_.c_str();
-				pListCtrl->InsertItem(i, strTrmp);
-				strTrmp = it->second.name_.c_str();
-				pListCtrl->SetItemText(i,1,strTrmp);
-				strTrmp = it->second.appType_.c_str();
-				pListCtrl->SetItemText(i,2,strTrmp);
-#endif 
-				CString strAppType = (CString)it->second.appType_.c_str();
-				CString strName = (CString)it->second.name_.c_str();
-				CString strSerial = (CString)it->second.serial_.c_str();
-				strTrmp.Format(_T("%s(%s)"), strName, strSerial);
-				//ڵ
-				TVINSERTSTRUCT tvinsert;
-				tvinsert.hParent = m_hRoot;
-				tvinsert.hInsertAfter = TVI_LAST;
-				tvinsert.item.mask = TVIF_IMAGE|TVIF_SELECTEDIMAGE|TVIF_TEXT|TVIF_STATE;
-				tvinsert.item.hItem = NULL;
-				tvinsert.item.state = INDEXTOSTATEIMAGEMASK( 1 );
-				tvinsert.item.stateMask = TVIS_STATEIMAGEMASK;
-				tvinsert.item.cchTextMax = 6;
-				tvinsert.item.cchTextMax = 64;
-				tvinsert.item.cChildren = 1;
-				tvinsert.item.lParam = 0;
-				tvinsert.item.pszText = (LPTSTR)strTrmp.GetBuffer(strTrmp.GetLength());
-				tvinsert.item.iImage = 9;//FOR Image
-				tvinsert.item.iSelectedImage = 6;//FOR Image
-
-// 				string serial_;//豸к
-// 				string name_;//豸
-// 				string password_;//
-// 				string tag_;//ǩ
-// 				string channelCount_;//豸ͷ
-// 				string snapJpgPath_;//µĿ·
-				EasyDarwin::Protocol::strDevice deviceInfo;
-				deviceInfo.serial_ = it->second.serial_;
-				deviceInfo.name_ = it->second.name_;
-				deviceInfo.eDeviceType = static_cast<EasyDarwinTerminalType>(EasyProtocol::GetTerminalType( it->second.terminalType_));
-				deviceInfo.eAppType = static_cast<EasyDarwinAppType>(EasyProtocol::GetAppType(it->second.appType_));
-				deviceInfo.snapJpgPath_ = it->second.snapJpgPath_;
-
-				//nvrӽڵ
-				if (strAppType == _T("EasyNVR"))
-				{
-					//ȡ豸Ϣ
-					CString strReqURL =_T(""); 
-					strReqURL.Format(_T("http://%s:%d/API/getdeviceinfo?device=%s"), m_strCMSIP, m_nCMSPort, strSerial);
-					if (!m_pSession)
-					{
-						m_pSession = new CInternetSession(/*_T("Mozilla/5.0 (compatible; MSIE 9.0; Windows NT 6.1; Trident/5.0)")*/);
-					}
+			return;
+		}
+		SendMessage(WM_DEVICE_LIST, 0, (LPARAM)&deviceListAck);
 
-					std::string strData;
-					CHttpFile *pFile = (CHttpFile *)m_pSession->OpenURL(strReqURL, 1, INTERNET_FLAG_TRANSFER_ASCII | INTERNET_FLAG_RELOAD);
-					if (pFile)
-					{
-						char ch;
-						while (pFile->Read(&ch, 1))
-						{
-							strData += ch;
-						}
-						pFile->Close();
-						delete pFile;
-						pFile = NULL;
-					}
+		//4. ȱˢµȫ, ´ˢ²ſʼ; ˳ʱOnDestroyȡŶӵ
+		m_pFetcher->Wait();
+	}
+}
 
-					//CString  m_strCode = (CString)strData.c_str();
-					if (!strData.empty())
-					{
-						//Jsonִ
-						//EasyDarwin::Protocol::EasyMsgSCDeviceInfoACK deviceInfoAck(strData.c_str());
-						bool bRet = deviceInfo.GetDevInfo(strData.c_str());
-						if(bRet)
-						{
-							//ɹ
-						}
-					}
-					//ӵ豸Ϣб
-					m_devicesInfo[it->second.serial_] = deviceInfo;
+LRESULT CEasyClientDlg::OnDeviceList(WPARAM wParam, LPARAM lParam)
+{
+	if (m_bQuit)
+	{
+		return 0;
+	}
+	EasyDarwin::Protocol::EasyMsgSCDeviceListACK& deviceListAck = *(EasyDarwin::Protocol::EasyMsgSCDeviceListACK *)lParam;
 
-					HTREEITEM DeviceNo = NULL;
-					DeviceNo  = m_pTreeCtrDevList->InsertItem(&tvinsert);	
-					//ڵ(ǰ豸ID)
-					m_pTreeCtrDevList->SetItemData(DeviceNo, (DWORD_PTR)m_devicesInfo[it->second.serial_].serial_.c_str());//豸ΪֱӸIDк
+	//2. ϴεбȽϣֻɾб仯Ľڵ(OnDeviceAdded/OnDeviceRemoved/OnDeviceChanged)
+	m_snapSerials.clear();
+	const EasyDeviceTable& table = deviceListAck.GetDeviceTable();
+	if (table.Size() > 0)
+	{
+		m_registry.Update(table, this);
+	}
+	else
+	{
+		m_registry.Update(deviceListAck.GetDevices(), this);
+	}
 
-					for (EasyDevices::iterator itor = deviceInfo.channels_.begin(); itor != deviceInfo.channels_.end(); itor++)
-					{
-						tvinsert.hParent = DeviceNo;
-						tvinsert.hInsertAfter  = TVI_LAST;
-						tvinsert.item.iImage = 0;
-						tvinsert.item.iSelectedImage = 6;
-						CString strChannel = (CString)itor->second.channel_.c_str();
-						CString strChannelNode = _T("");
-						strChannelNode.Format(_T("Channel%s"), strChannel);
-						tvinsert.item.pszText = strChannelNode.GetBuffer(strChannelNode.GetLength());
-
-						HTREEITEM NVRMember = m_pTreeCtrDevList->InsertItem(&tvinsert);
-						//Աڵ(ǰԱIP)
-						m_pTreeCtrDevList->SetItemData(NVRMember, (DWORD_PTR)m_devicesInfo[it->second.serial_].channels_[itor->second.channel_].channel_.c_str());
-					}
-				}
-				else
-				{
-					//ӵ豸Ϣб
-					m_devicesInfo[it->second.serial_] = deviceInfo;
-					HTREEITEM DeviceNo = NULL;
-					DeviceNo  = m_pTreeCtrDevList->InsertItem(&tvinsert);	
-					//ڵ(ǰ豸ID)
-					m_pTreeCtrDevList->SetItemData(DeviceNo, (DWORD_PTR)m_devicesInfo[it->second.serial_].serial_.c_str());//豸ΪֱӸIDк
-				}
-				i++;
-			}
-			//չӽڵ
-			ExpandAllItem(m_pTreeCtrDevList, m_pTreeCtrDevList->GetRootItem(), true);
-				
-			//  [8/12/2016 SwordTwelve]
-			//ȡJPGͼƬ
-#if 1
-			for (EasyDevices::iterator it = m_devices.begin(); it != m_devices.end(); it++)
+	//չӽڵ
+	ExpandAllItem(m_pTreeCtrDevList, m_pTreeCtrDevList->GetRootItem(), true);
+
+	//3. nvrӽڵ: ֻ³ֻб仯NVR, ӦOnFetchedOnDeviceChannels
+	char szCMS[64] = {0};
+	sprintf(szCMS, "http://%s:%d", ToAnsi(m_strCMSIP).c_str(), m_nCMSPort);
+	for (EasyDevicesInfo::iterator it = m_devicesInfo.begin(); it != m_devicesInfo.end(); it++)
+	{
+		if (m_registry.NeedsChannels(it->first))
+		{
+			DEVICE_FETCH_T *fetch = new DEVICE_FETCH_T;
+			fetch->serial = it->first;
+			fetch->snapshot = false;
+			if (!m_pFetcher->Fetch(szCMS + ("/API/getdeviceinfo?device=" + it->first), FetchPriority(it->first), this, fetch))
 			{
-				CString strImgURL = (CString)it->second.snapJpgPath_.c_str();
-				if (!strImgURL.IsEmpty())
-				{
-					pFile = (CHttpFile *)m_pSession->OpenURL(strImgURL, 1, INTERNET_FLAG_TRANSFER_ASCII | INTERNET_FLAG_RELOAD);
+				delete fetch;
+			}
+		}
+	}
 
-					BYTE b;
-					strData.clear();
-					while (pFile->Read(&b, 1))
-					{
-						strData += b;
-					}
-					pFile->Close();
-					delete pFile;
-					pFile = NULL;
+	//  [8/12/2016 SwordTwelve]
+	//ȡJPGͼƬ, ֻȡ豸·б仯豸; ձд./snap, ڴƴͼ
+	CreateDirectory(_T("snap"), NULL);
+	CTime CurrentTime=CTime::GetCurrentTime(); 
+	CString strTime = _T("");
+	strTime.Format(_T("%04d%02d%02d-%02d%02d%02d"),CurrentTime.GetYear(),CurrentTime.GetMonth(),
+		CurrentTime.GetDay(),CurrentTime.GetHour(),  CurrentTime.GetMinute(),
+		CurrentTime.GetSecond());
+	for (size_t i = 0; i < m_snapSerials.size(); i++)
+	{
+		EasyDevicesInfo::iterator it = m_devicesInfo.find(m_snapSerials[i]);
+		if (it == m_devicesInfo.end())
+		{
+			continue;
+		}
 
-					if (!strData.empty())
-					{
-						CString strTime = _T("");
-						CTime CurrentTime=CTime::GetCurrentTime(); 
-						strTime.Format(_T("%04d%02d%02d-%02d%02d%02d"),CurrentTime.GetYear(),CurrentTime.GetMonth(),
-							CurrentTime.GetDay(),CurrentTime.GetHour(),  CurrentTime.GetMinute(),
-							CurrentTime.GetSecond());
-
-						CString lpszPath = _T("");
-						CString strSerial =  (CString)it->second.serial_.c_str();
-						lpszPath.Format(_T("./snap/%s-%s.jpg") , strSerial, strTime);
-						CFile file;
-						if (!file.Open(lpszPath, CFile::modeCreate | CFile::modeWrite))
-						{
-							return ;
-						}
-						file.Write((LPCTSTR)strData.c_str(), strData.length());
-						file.Close();
+		CString lpszPath = _T("");
+		CString strSerial =  (CString)it->first.c_str();
+		lpszPath.Format(_T("./snap/%s-%s.jpg") , strSerial, strTime);
 
-						//pListCtrl->InsertImage(i,lpszPath);		
-					}
-				}
+		DEVICE_FETCH_T *fetch = new DEVICE_FETCH_T;
+		fetch->serial = it->first;
+		fetch->snapshot = true;
+		//ͬһյַֻһ
+		if (!m_pFetcher->Fetch(it->second.snapJpgPath_, FetchPriority(it->first), this, fetch, ToAnsi(lpszPath)))
+		{
+			delete fetch;
+		}
+	}
+	return 0;
+}
+
+std::string CEasyClientDlg::ToAnsi(const CString& str)
+{
+	char szBuf[1024] = {0};
+	__WCharToMByte((LPCWSTR)str, szBuf, sizeof(szBuf));
+	return szBuf;
+}
+
+BOOL CEasyClientDlg::RequestCMS(const std::string& strPath, std::string& strData)
+{
+	EasyDarwin::Protocol::EASY_HTTP_RESPONSE_T response;
+	m_pCMSClient->Get(strPath, response);
+	strData.swap(response.body);
+	return response.status > 0 && !strData.empty();
+}
+
+int CEasyClientDlg::FetchPriority(const std::string& serial)
+{
+	std::map<std::string, HTREEITEM>::iterator node = m_deviceNodes.find(serial);
+	CRect rcItem, rcClient, rcVisible;
+	if (node != m_deviceNodes.end() && m_pTreeCtrDevList->GetItemRect(node->second, &rcItem, FALSE))
+	{
+		//չ˵Ľڵ㲻
+		m_pTreeCtrDevList->GetClientRect(&rcClient);
+		if (rcVisible.IntersectRect(&rcItem, &rcClient))
+		{
+			return EASY_FETCH_PRIORITY_VISIBLE;
+		}
+	}
+	return EASY_FETCH_PRIORITY_NORMAL;
+}
+
+void CEasyClientDlg::OnFetched(const std::string& url, void *context, const EasyDarwin::Protocol::EASY_HTTP_RESPONSE_T& response)
+{
+	DEVICE_FETCH_T *fetch = (DEVICE_FETCH_T *)context;
+	//m_pFetcherд, ʧʱ²ȱļ
+	if (!fetch->snapshot && response.status == 200 && !m_bQuit)
+	{
+		//ȡ豸Ϣ
+		EasyDarwin::Protocol::strDevice deviceInfo;
+		if (deviceInfo.GetDevInfo(response.body))
+		{
+			//̲߳豸, ҲSendMessage: OnDestroyɾm_pFetcherʱҪ߳̽
+			DEVICE_CHANNELS_T *channels = new DEVICE_CHANNELS_T;
+			channels->serial = fetch->serial;
+			channels->channels.swap(deviceInfo.channels_);
+			if (!::PostMessage(m_hWnd, WM_DEVICE_CHANNELS, 0, (LPARAM)channels))
+			{
+				delete channels;
 			}
-#endif
 		}
-		else
+	}
+	delete fetch;
+}
+
+LRESULT CEasyClientDlg::OnDeviceChannels(WPARAM wParam, LPARAM lParam)
+{
+	DEVICE_CHANNELS_T *channels = (DEVICE_CHANNELS_T *)lParam;
+	std::map<std::string, HTREEITEM>::iterator node = m_deviceNodes.find(channels->serial);
+	//ڼ豸ѱɾ
+	if (!m_bQuit && node != m_deviceNodes.end())
+	{
+		//ɹ, ´ˢʱNVRû仯Ͳ
+		m_registry.SetChannels(channels->serial, channels->channels);
+		UpdateChannelNodes(channels->serial, channels->channels);
+		ExpandAllItem(m_pTreeCtrDevList, node->second, true);
+	}
+	delete channels;
+	return 0;
+}
+
+//豸ڵ: (к)
+static CString DeviceNodeText(const EasyDevice& device)
+{
+	CString strName = (CString)device.name_.c_str();
+	CString strSerial = (CString)device.serial_.c_str();
+	CString strText = _T("");
+	strText.Format(_T("%s(%s)"), strName, strSerial);
+	return strText;
+}
+
+void CEasyClientDlg::OnDeviceAdded(const EasyDevice& device)
+{
+	//ӵ豸Ϣб
+	EasyDarwin::Protocol::strDevice& deviceInfo = m_devicesInfo[device.serial_];
+	deviceInfo.serial_ = device.serial_;
+	deviceInfo.name_ = device.name_;
+	deviceInfo.eDeviceType = static_cast<EasyDarwinTerminalType>(EasyProtocol::GetTerminalType(device.terminalType_));
+	deviceInfo.eAppType = static_cast<EasyDarwinAppType>(EasyProtocol::GetAppType(device.appType_));
+	deviceInfo.snapJpgPath_ = device.snapJpgPath_;
+
+	//ڵ
+	CString strText = DeviceNodeText(device);
+	TVINSERTSTRUCT tvinsert;
+	tvinsert.hParent = m_hRoot;
+	tvinsert.hInsertAfter = TVI_LAST;
+	tvinsert.item.mask = TVIF_IMAGE|TVIF_SELECTEDIMAGE|TVIF_TEXT|TVIF_STATE;
+	tvinsert.item.hItem = NULL;
+	tvinsert.item.state = INDEXTOSTATEIMAGEMASK( 1 );
+	tvinsert.item.stateMask = TVIS_STATEIMAGEMASK;
+	tvinsert.item.cchTextMax = 64;
+	tvinsert.item.cChildren = 1;
+	tvinsert.item.lParam = 0;
+	tvinsert.item.pszText = (LPTSTR)strText.GetBuffer(strText.GetLength());
+	tvinsert.item.iImage = 9;//FOR Image
+	tvinsert.item.iSelectedImage = 6;//FOR Image
+
+	HTREEITEM DeviceNo = m_pTreeCtrDevList->InsertItem(&tvinsert);
+	//ڵ(ǰ豸ID), ڵڼserial_ٸı
+	m_pTreeCtrDevList->SetItemData(DeviceNo, (DWORD_PTR)deviceInfo.serial_.c_str());
+	m_deviceNodes[device.serial_] = DeviceNo;
+
+	if (!device.snapJpgPath_.empty())
+	{
+		m_snapSerials.push_back(device.serial_);
+	}
+}
+
+void CEasyClientDlg::OnDeviceRemoved(const EasyDevice& device)
+{
+	//ɾڵ(ͬͨӽڵ), ɾڵָ豸Ϣ
+	std::map<std::string, HTREEITEM>::iterator node = m_deviceNodes.find(device.serial_);
+	if (node != m_deviceNodes.end())
+	{
+		m_pTreeCtrDevList->DeleteItem(node->second);
+		m_deviceNodes.erase(node);
+	}
+	m_devicesInfo.erase(device.serial_);
+}
+
+void CEasyClientDlg::OnDeviceChanged(const EasyDevice& before, const EasyDevice& after)
+{
+	EasyDarwin::Protocol::strDevice& deviceInfo = m_devicesInfo[after.serial_];
+	deviceInfo.name_ = after.name_;
+	deviceInfo.eDeviceType = static_cast<EasyDarwinTerminalType>(EasyProtocol::GetTerminalType(after.terminalType_));
+	deviceInfo.eAppType = static_cast<EasyDarwinAppType>(EasyProtocol::GetAppType(after.appType_));
+	deviceInfo.snapJpgPath_ = after.snapJpgPath_;
+
+	std::map<std::string, HTREEITEM>::iterator node = m_deviceNodes.find(after.serial_);
+	if (node != m_deviceNodes.end())
+	{
+		m_pTreeCtrDevList->SetItemText(node->second, DeviceNodeText(after));
+		//NVRʱȥͨ; NVR, ͨNeedsChannels
+		if (deviceInfo.eAppType != EASY_APP_TYPE_NVR)
 		{
-			//not get any devices
+			UpdateChannelNodes(after.serial_, EasyDevices());
 		}
 	}
+
+	if (!after.snapJpgPath_.empty() && after.snapJpgPath_ != before.snapJpgPath_)
+	{
+		m_snapSerials.push_back(after.serial_);
+	}
+}
+
+void CEasyClientDlg::UpdateChannelNodes(const std::string& serial, const EasyDevices& channels)
+{
+	std::map<std::string, HTREEITEM>::iterator node = m_deviceNodes.find(serial);
+	if (node == m_deviceNodes.end())
+	{
+		return;
+	}
+
+	//ɵͨڵָchannels_, ɾڵ滻
+	DeleteChildren(m_pTreeCtrDevList, node->second);
+	EasyDarwin::Protocol::strDevice& deviceInfo = m_devicesInfo[serial];
+	deviceInfo.channels_ = channels;
+
+	TVINSERTSTRUCT tvinsert;
+	tvinsert.hParent = node->second;
+	tvinsert.hInsertAfter  = TVI_LAST;
+	tvinsert.item.mask = TVIF_IMAGE|TVIF_SELECTEDIMAGE|TVIF_TEXT|TVIF_STATE;
+	tvinsert.item.hItem = NULL;
+	tvinsert.item.state = INDEXTOSTATEIMAGEMASK( 1 );
+	tvinsert.item.stateMask = TVIS_STATEIMAGEMASK;
+	tvinsert.item.cchTextMax = 64;
+	tvinsert.item.cChildren = 1;
+	tvinsert.item.lParam = 0;
+	tvinsert.item.iImage = 0;
+	tvinsert.item.iSelectedImage = 6;
+	for (EasyDevices::iterator itor = deviceInfo.channels_.begin(); itor != deviceInfo.channels_.end(); itor++)
+	{
+		CString strChannel = (CString)itor->second.channel_.c_str();
+		CString strChannelNode = _T("");
+		strChannelNode.Format(_T("Channel%s"), strChannel);
+		tvinsert.item.pszText = strChannelNode.GetBuffer(strChannelNode.GetLength());
+
+		HTREEITEM NVRMember = m_pTreeCtrDevList->InsertItem(&tvinsert);
+		//Աڵ(ǰԱIP)
+		m_pTreeCtrDevList->SetItemData(NVRMember, (DWORD_PTR)itor->second.channel_.c_str());
+	}
 }
 
 //˫豸б
@@ -527,30 +630,11 @@ void CEasyClientDlg::OnNMDBClickListDevices(NMHDR *pNMHDR, LRESULT *pResult)
 			{
 				//http豸
 				//http://121.40.50.44:10000/api/getdevicestream?device=001001000010&channel=01&protocol=RTSP&reserve=1
-				CString strReqURL =_T(""); 
-				if (pData ==NULL)
-				{
-					strReqURL.Format(_T("http://%s:%d/API/getdevicestream?device=%s&channel=%s&protocol=RTSP&reserve=1"), m_strCMSIP, m_nCMSPort, strDeviceId,strChannel);
-				}
-				else
-				{
-					strReqURL.Format(_T("http://%s:%d/API/getdevicestream?device=%s&channel=%s&protocol=RTSP&reserve=1"), m_strCMSIP, m_nCMSPort, strDeviceId, strChannel);
-				}
+				CString strReqPath =_T(""); 
+				strReqPath.Format(_T("/API/getdevicestream?device=%s&channel=%s&protocol=RTSP&reserve=1"), strDeviceId, strChannel);
 
 				std::string strData;
-				CHttpFile *pFile = (CHttpFile *)m_pSession->OpenURL(strReqURL, 1, INTERNET_FLAG_TRANSFER_ASCII | INTERNET_FLAG_RELOAD);
-				if (pFile)
-				{
-					char ch;
-					while (pFile->Read(&ch, 1))
-					{
-						strData += ch;
-					}
-					pFile->Close();
-					delete pFile;
-					pFile = NULL;
-				}
-				if (!strData.empty())
+				if (RequestCMS(ToAnsi(strReqPath), strData))
 				{
 					//Jsonִ
 					EasyDarwin::Protocol::EasyMsgSCGetStreamACK getSreamAck(strData.c_str());
@@ -1024,13 +1108,36 @@ void CEasyClientDlg::OnLButtonDown(UINT nFlags, CPoint point)
 
 void CEasyClientDlg::OnDestroy()
 {
+	//ͣб߳, Ҫm_pCMSClientm_pFetcher: ŶӵĿպͨȡ, Wait֮
+	m_bQuit = true;
+	m_pFetcher->Cancel(true);
+	if (m_hReqDeviceListThread != INVALID_HANDLE_VALUE)
+	{
+		//б߳̿SendMessage(WM_DEVICE_LIST)߳, ȴʱճϢ
+		while (WAIT_OBJECT_0 + 1 == MsgWaitForMultipleObjects(1, &m_hReqDeviceListThread, FALSE, INFINITE, QS_SENDMESSAGE))
+		{
+			MSG msg;
+			PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE | PM_QS_SENDMESSAGE);
+		}
+		CloseHandle(m_hReqDeviceListThread);
+		m_hReqDeviceListThread = INVALID_HANDLE_VALUE;
+	}
 
-	if (NULL != m_pSession)
+	//ڽе, OnFetchedֻPostMessage, ȱ߳
+	delete m_pFetcher;
+	m_pFetcher = NULL;
+	MSG msg;
+	while (PeekMessage(&msg, m_hWnd, WM_DEVICE_CHANNELS, WM_DEVICE_CHANNELS, PM_REMOVE))
 	{
-		m_pSession->Close();
-		delete m_pSession;
+		delete (DEVICE_CHANNELS_T *)msg.lParam;
 	}
 
+	//δɵPTZȡ
+	delete m_pPTZClient;
+	m_pPTZClient = NULL;
+	delete m_pCMSClient;
+	m_pCMSClient = NULL;
+
 	CSkinDialog::OnDestroy();
 
 	// TODO: Add your message handler code here
@@ -1124,33 +1231,12 @@ LRESULT CEasyClientDlg::HandleButtonMessage(WPARAM wParam, LPARAM lParam)
 		strDeviceId = pVideoWindow->pDlgVideo[m_nCurSelWnd].GetDeviceSerial();
 		strChannel = pVideoWindow->pDlgVideo[m_nCurSelWnd].GetDeviceChannel();
 		//http://[ip]:[port]/api/ptzcontrol?device=001001000058&channel=0&actiontype=single&c ommand=down&speed=5&protocol=onvif
-		CString strReqURL =_T(""); //Continuous / single
-		strReqURL.Format(_T("http://%s:%d/api/ptzcontrol?device=%s&channel=%s&actiontype=Continuous&command=%s&speed=5&protocol=onvif"), 
-			m_strCMSIP, m_nCMSPort, strDeviceId, strChannel, sPtzCmd);
-		if (!m_pSession)
-		{
-			m_pSession = new CInternetSession(/*_T("Mozilla/5.0 (compatible; MSIE 9.0; Windows NT 6.1; Trident/5.0)")*/);
-		}
+		CString strReqPath =_T(""); //Continuous / single
+		strReqPath.Format(_T("/api/ptzcontrol?device=%s&channel=%s&actiontype=Continuous&command=%s&speed=5&protocol=onvif"), 
+			strDeviceId, strChannel, sPtzCmd);
 
-		std::string strData;
-		CHttpFile *pFile = (CHttpFile *)m_pSession->OpenURL(strReqURL, 1, INTERNET_FLAG_TRANSFER_ASCII | INTERNET_FLAG_RELOAD);
-		if (pFile)
-		{
-			char ch;
-			while (pFile->Read(&ch, 1))
-			{
-				strData += ch;
-			}
-			pFile->Close();
-			delete pFile;
-			pFile = NULL;
-		}
-
-		//CString  m_strCode = (CString)strData.c_str();
-		if (!strData.empty())
-		{
-			//PTZƳɹ~~
-		}
+		//ȴӦ, ϢHTTP
+		m_pPTZClient->GetAsync(ToAnsi(strReqPath), NULL, NULL);
 	}
 
 	return 0;
@@ -8,6 +8,9 @@
 #include ".\EasySkinUI\skindialog.h"
 // EasyProtocolЭ֧ [8/11/2016 Dingshuai]
 #include "EasyProtocol.h"
+#include "EasyDeviceRegistry.h"
+#include "EasyHttpClient.h"
+#include "EasyFetchScheduler.h"
 using namespace EasyDarwin::Protocol;
 #pragma comment(lib, "../bin/EasyProtocol.lib")
 #pragma comment(lib, "../bin/libjson.lib")
@@ -27,8 +30,27 @@ typedef struct __VIDEO_NODE_T
 	CDlgVideo	*pDlgVideo;
 }VIDEO_NODE_T;
 
+//m_pFetcherصʱ
+typedef struct __DEVICE_FETCH_T
+{
+	std::string	serial;
+	bool		snapshot;			//дļ, getdeviceinfoӦ
+}DEVICE_FETCH_T;
+
+//getdeviceinfoͨ, m_pFetcherĹ߳̽߳
+typedef struct __DEVICE_CHANNELS_T
+{
+	std::string	serial;
+	EasyDevices	channels;
+}DEVICE_CHANNELS_T;
+
+//豸ֻڽ߳޸
+#define	WM_DEVICE_LIST			(WM_USER+2101)		//б߳SendMessage, lParam: EasyMsgSCDeviceListACK*
+#define	WM_DEVICE_CHANNELS		(WM_USER+2102)		//OnFetched PostMessage, lParam: DEVICE_CHANNELS_T*, OnDeviceChannelsͷ
+
 // CEasyClientDlg Ի
-class CEasyClientDlg : public CSkinDialog
+class CEasyClientDlg : public CSkinDialog, public EasyDarwin::Protocol::EasyDeviceRegistryListener,
+	public EasyDarwin::Protocol::EasyFetchHandler
 {
 // 
 public:
@@ -58,6 +80,10 @@ protected:
 	afx_msg void	OnNMDBClickListDevices(NMHDR *pNMHDR, LRESULT *pResult);
 	afx_msg long HandleButtonMessage(WPARAM wCmdID, LPARAM lParm);	DECLARE_MESSAGE_MAP()
 	LRESULT OnWindowMaximized(WPARAM wParam, LPARAM lParam);
+	//б߳ȡ豸б: 豸, ͨͿ
+	LRESULT OnDeviceList(WPARAM wParam, LPARAM lParam);
+	//OnFetchedȡNVRͨ
+	LRESULT OnDeviceChannels(WPARAM wParam, LPARAM lParam);
 public:
 	virtual BOOL DestroyWindow();
 	virtual LRESULT WindowProc(UINT message, WPARAM wParam, LPARAM lParam);
@@ -66,6 +92,19 @@ public:
 	int SendHttpReqDeviceList();
 	static UINT WINAPI ReqDeviceListThread(LPVOID pParam);
 	void ProcessReqDevListThread();
+	//CMSӿ, strPath"/API/getdevicelist", Ƿ
+	BOOL RequestCMS(const std::string& strPath, std::string& strData);
+	static std::string ToAnsi(const CString& str);
+	//ϵǰܿ豸Ȼȡ
+	int FetchPriority(const std::string& serial);
+	//m_pFetcherĹ̻߳ص, ֻӦ, 豸OnDeviceChannels
+	virtual void OnFetched(const std::string& url, void *context, const EasyDarwin::Protocol::EASY_HTTP_RESPONSE_T& response);
+	//豸бˢʱm_registryص, ֻб仯Ľڵ
+	virtual void OnDeviceAdded(const EasyDevice& device);
+	virtual void OnDeviceRemoved(const EasyDevice& device);
+	virtual void OnDeviceChanged(const EasyDevice& before, const EasyDevice& after);
+	//channelsؽNVRͨӽڵ
+	void UpdateChannelNodes(const std::string& serial, const EasyDevices& channels);
 	void	InitialComponents();
 	void	CreateComponents();
 	void	UpdateComponents();
@@ -91,8 +130,16 @@ private:
 	CImageList	m_StatusImage;
 
 	// EasyClientչ [8/11/2016 Dingshuai]
-	CInternetSession *m_pSession;
+	EasyDarwin::Protocol::EasyHttpClient *m_pCMSClient;
+	EasyDarwin::Protocol::EasyHttpClient *m_pPTZClient;
+	//NVRͨͿղȡ, ÿͬʱ
+	EasyDarwin::Protocol::EasyFetchScheduler *m_pFetcher;
+	volatile bool m_bQuit;							//OnDestroyλ, ֮ԻϢ
 	EasyDarwin::Protocol::EasyDevicesInfo m_devicesInfo;
+	//ϴε豸б, 豸
+	EasyDarwin::Protocol::EasyDeviceRegistry m_registry;
+	std::map<std::string, HTREEITEM> m_deviceNodes;	//к -> 豸ڵ
+	std::vector<std::string> m_snapSerials;			//ˢҪȡյ豸
 	CString m_strCMSIP; 
 	int m_nCMSPort;
 	int m_nCurSelWnd;
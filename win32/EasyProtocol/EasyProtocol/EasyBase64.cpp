@@ -0,0 +1,611 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyBase64.cpp
+*/
+
+#include <EasyBase64.h>
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define EASY_BASE64_X86
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#if (defined(_MSC_VER) && _MSC_VER >= 1700) || defined(__GNUC__)
+#define EASY_BASE64_AVX2
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#define EASY_TARGET(x)
+#else
+#include <cpuid.h>
+#define EASY_TARGET(x)	__attribute__((target(x)))
+#endif
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define EASY_BASE64_NEON
+#include <arm_neon.h>
+#endif
+
+#define B64_INVALID		0x80
+#define B64_SKIP		0x81		//CR/LF
+#define B64_PAD			0x82		//'='
+
+enum
+{
+	KERNEL_SCALAR = 0,
+	KERNEL_SSSE3,
+	KERNEL_AVX2,
+	KERNEL_NEON
+};
+
+static const char s_EncodeTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const unsigned char s_DecodeTable[256] = {
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x81, 0x80, 0x80, 0x81, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x3E, 0x80, 0x80, 0x80, 0x3F,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x80, 0x80, 0x80, 0x82, 0x80, 0x80,
+	0x80, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+	0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80
+};
+
+static int s_Kernel = -1;
+static bool s_SimdEnabled = true;
+
+static int DetectKernel()
+{
+#if defined(EASY_BASE64_X86)
+	int info[4] = {0};
+#ifdef _MSC_VER
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+#else
+	unsigned int maxLeaf = __get_cpuid_max(0, NULL);
+	unsigned int a, b, c, d;
+	__cpuid(1, a, b, c, d);
+	info[2] = c;
+#endif
+	bool ssse3 = (info[2] & (1 << 9)) != 0;
+
+#if defined(EASY_BASE64_AVX2)
+	//AVX2 needs the OS to save the ymm state (OSXSAVE + XCR0 bits 1,2)
+	if (maxLeaf >= 7 && (info[2] & (1 << 27)) && (info[2] & (1 << 28)))
+	{
+		unsigned long long xcr0;
+#ifdef _MSC_VER
+		xcr0 = _xgetbv(0);
+		__cpuidex(info, 7, 0);
+		int ebx = info[1];
+#else
+		unsigned int lo, hi;
+		__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		xcr0 = ((unsigned long long)hi << 32) | lo;
+		__cpuid_count(7, 0, a, b, c, d);
+		int ebx = b;
+#endif
+		if ((xcr0 & 0x06) == 0x06 && (ebx & (1 << 5)))	return KERNEL_AVX2;
+	}
+#else
+	(void)maxLeaf;
+#endif
+	return ssse3 ? KERNEL_SSSE3 : KERNEL_SCALAR;
+#elif defined(EASY_BASE64_NEON)
+	return KERNEL_NEON;
+#else
+	return KERNEL_SCALAR;
+#endif
+}
+
+static int GetKernelId()
+{
+	if (!s_SimdEnabled)	return KERNEL_SCALAR;
+	if (s_Kernel < 0)	s_Kernel = DetectKernel();
+	return s_Kernel;
+}
+
+static void EncodeScalar(char *dest, const unsigned char *src, size_t groups)
+{
+	for (size_t i = 0; i < groups; i++, src += 3, dest += 4)
+	{
+		unsigned int v = (src[0] << 16) | (src[1] << 8) | src[2];
+		dest[0] = s_EncodeTable[v >> 18];
+		dest[1] = s_EncodeTable[(v >> 12) & 0x3F];
+		dest[2] = s_EncodeTable[(v >> 6) & 0x3F];
+		dest[3] = s_EncodeTable[v & 0x3F];
+	}
+}
+
+/*
+ * x86 kernels: 12 bytes are spread to 16 lanes of 6 bits with a shuffle and
+ * two multiplies, then mapped to ASCII with one pshufb of per range offsets.
+ * Decoding validates with two nibble lookups and packs with maddubs/madd.
+ * Any block with a character outside the alphabet is left to the scalar path.
+ */
+#if defined(EASY_BASE64_X86)
+EASY_TARGET("ssse3")
+static size_t EncodeSSSE3(char *dest, const unsigned char *src, size_t len)
+{
+	const __m128i shuf = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	const __m128i lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+	size_t i = 0;
+	for (; i + 16 <= len; i += 12, dest += 16)
+	{
+		__m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i)), shuf);
+		__m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+		__m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+		__m128i idx = _mm_or_si128(t0, t1);
+
+		__m128i r = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+		r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx), _mm_set1_epi8(13)));
+		r = _mm_add_epi8(_mm_shuffle_epi8(lut, r), idx);
+		_mm_storeu_si128((__m128i *)dest, r);
+	}
+	return i;
+}
+
+EASY_TARGET("ssse3")
+static size_t DecodeSSSE3(unsigned char *dest, size_t size, const char *src, size_t len, size_t *written)
+{
+	const __m128i shiftLut = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i maskLut = _mm_setr_epi8((char)0xA8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8,
+		(char)0xF8, (char)0xF8, (char)0xF0, 0x54, 0x50, 0x50, 0x50, 0x54);
+	const __m128i bitLut = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+	size_t i = 0, o = 0;
+	for (; i + 16 <= len && o + 16 <= size; i += 16, o += 12)
+	{
+		__m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i hi = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0F));
+		__m128i lo = _mm_and_si128(in, _mm_set1_epi8(0x0F));
+		__m128i ok = _mm_and_si128(_mm_shuffle_epi8(maskLut, lo), _mm_shuffle_epi8(bitLut, hi));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(ok, _mm_setzero_si128())))	break;
+
+		__m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+		__m128i shift = _mm_shuffle_epi8(shiftLut, hi);
+		shift = _mm_or_si128(_mm_andnot_si128(slash, shift), _mm_and_si128(slash, _mm_set1_epi8(16)));
+		__m128i v = _mm_add_epi8(in, shift);
+
+		v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+		v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+		_mm_storeu_si128((__m128i *)(dest + o), _mm_shuffle_epi8(v, pack));
+	}
+	*written = o;
+	return i;
+}
+
+#if defined(EASY_BASE64_AVX2)
+EASY_TARGET("avx2")
+static inline __m256i __Dup128(__m128i x)
+{
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(x), x, 1);
+}
+
+EASY_TARGET("avx2")
+static size_t EncodeAVX2(char *dest, const unsigned char *src, size_t len)
+{
+	const __m256i shuf = __Dup128(_mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+	const __m256i lut = __Dup128(_mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0));
+
+	size_t i = 0;
+	for (; i + 28 <= len; i += 24, dest += 32)
+	{
+		__m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(src + i))),
+			_mm_loadu_si128((const __m128i *)(src + i + 12)), 1);
+		in = _mm256_shuffle_epi8(in, shuf);
+		__m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+		__m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+		__m256i idx = _mm256_or_si256(t0, t1);
+
+		__m256i r = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+		r = _mm256_or_si256(r, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx), _mm256_set1_epi8(13)));
+		r = _mm256_add_epi8(_mm256_shuffle_epi8(lut, r), idx);
+		_mm256_storeu_si256((__m256i *)dest, r);
+	}
+	return i;
+}
+
+EASY_TARGET("avx2")
+static size_t DecodeAVX2(unsigned char *dest, size_t size, const char *src, size_t len, size_t *written)
+{
+	const __m256i shiftLut = __Dup128(_mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0));
+	const __m256i maskLut = __Dup128(_mm_setr_epi8((char)0xA8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8,
+		(char)0xF8, (char)0xF8, (char)0xF0, 0x54, 0x50, 0x50, 0x50, 0x54));
+	const __m256i bitLut = __Dup128(_mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0));
+	const __m256i pack = __Dup128(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+	const __m256i perm = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+	size_t i = 0, o = 0;
+	for (; i + 32 <= len && o + 32 <= size; i += 32, o += 24)
+	{
+		__m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+		__m256i hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0F));
+		__m256i lo = _mm256_and_si256(in, _mm256_set1_epi8(0x0F));
+		__m256i ok = _mm256_and_si256(_mm256_shuffle_epi8(maskLut, lo), _mm256_shuffle_epi8(bitLut, hi));
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(ok, _mm256_setzero_si256())))	break;
+
+		__m256i slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+		__m256i shift = _mm256_blendv_epi8(_mm256_shuffle_epi8(shiftLut, hi), _mm256_set1_epi8(16), slash);
+		__m256i v = _mm256_add_epi8(in, shift);
+
+		v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+		v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+		v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, pack), perm);
+		_mm256_storeu_si256((__m256i *)(dest + o), v);
+	}
+	*written = o;
+	return i;
+}
+#endif
+#endif
+
+/*
+ * NEON kernels: vld3/vst4 (and vld4/vst3 for decoding) do the byte
+ * (de)interleaving, the alphabet is mapped with range compares so the
+ * same code runs on ARMv7 and AArch64.
+ */
+#if defined(EASY_BASE64_NEON)
+static inline uint8x16_t __NeonToChars(uint8x16_t idx)
+{
+	uint8x16_t r = vaddq_u8(idx, vdupq_n_u8('A'));
+	r = vaddq_u8(r, vandq_u8(vcgeq_u8(idx, vdupq_n_u8(26)), vdupq_n_u8('a' - 26 - 'A')));
+	r = vaddq_u8(r, vandq_u8(vcgeq_u8(idx, vdupq_n_u8(52)), vdupq_n_u8((unsigned char)('0' - 52 - ('a' - 26)))));
+	r = vaddq_u8(r, vandq_u8(vcgeq_u8(idx, vdupq_n_u8(62)), vdupq_n_u8((unsigned char)('+' - 62 - ('0' - 52)))));
+	r = vaddq_u8(r, vandq_u8(vcgeq_u8(idx, vdupq_n_u8(63)), vdupq_n_u8((unsigned char)('/' - 63 - ('+' - 62)))));
+	return r;
+}
+
+static inline uint8x16_t __NeonFromChars(uint8x16_t c, uint8x16_t *bad)
+{
+	uint8x16_t upper = vandq_u8(vcgeq_u8(c, vdupq_n_u8('A')), vcleq_u8(c, vdupq_n_u8('Z')));
+	uint8x16_t lower = vandq_u8(vcgeq_u8(c, vdupq_n_u8('a')), vcleq_u8(c, vdupq_n_u8('z')));
+	uint8x16_t digit = vandq_u8(vcgeq_u8(c, vdupq_n_u8('0')), vcleq_u8(c, vdupq_n_u8('9')));
+	uint8x16_t plus = vceqq_u8(c, vdupq_n_u8('+'));
+	uint8x16_t slash = vceqq_u8(c, vdupq_n_u8('/'));
+
+	uint8x16_t shift = vandq_u8(upper, vdupq_n_u8((unsigned char)-'A'));
+	shift = vorrq_u8(shift, vandq_u8(lower, vdupq_n_u8((unsigned char)(26 - 'a'))));
+	shift = vorrq_u8(shift, vandq_u8(digit, vdupq_n_u8((unsigned char)(52 - '0'))));
+	shift = vorrq_u8(shift, vandq_u8(plus, vdupq_n_u8((unsigned char)(62 - '+'))));
+	shift = vorrq_u8(shift, vandq_u8(slash, vdupq_n_u8((unsigned char)(63 - '/'))));
+
+	uint8x16_t valid = vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, plus)), slash);
+	*bad = vorrq_u8(*bad, vmvnq_u8(valid));
+	return vaddq_u8(c, shift);
+}
+
+static size_t EncodeNEON(char *dest, const unsigned char *src, size_t len)
+{
+	size_t i = 0;
+	for (; i + 48 <= len; i += 48, dest += 64)
+	{
+		uint8x16x3_t in = vld3q_u8(src + i);
+		uint8x16x4_t out;
+		out.val[0] = vshrq_n_u8(in.val[0], 2);
+		out.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[0], vdupq_n_u8(0x03)), 4), vshrq_n_u8(in.val[1], 4));
+		out.val[2] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[1], vdupq_n_u8(0x0F)), 2), vshrq_n_u8(in.val[2], 6));
+		out.val[3] = vandq_u8(in.val[2], vdupq_n_u8(0x3F));
+
+		out.val[0] = __NeonToChars(out.val[0]);
+		out.val[1] = __NeonToChars(out.val[1]);
+		out.val[2] = __NeonToChars(out.val[2]);
+		out.val[3] = __NeonToChars(out.val[3]);
+		vst4q_u8((uint8_t *)dest, out);
+	}
+	return i;
+}
+
+static size_t DecodeNEON(unsigned char *dest, size_t size, const char *src, size_t len, size_t *written)
+{
+	size_t i = 0, o = 0;
+	for (; i + 64 <= len && o + 48 <= size; i += 64, o += 48)
+	{
+		uint8x16x4_t in = vld4q_u8((const uint8_t *)(src + i));
+		uint8x16_t bad = vdupq_n_u8(0);
+		uint8x16_t v0 = __NeonFromChars(in.val[0], &bad);
+		uint8x16_t v1 = __NeonFromChars(in.val[1], &bad);
+		uint8x16_t v2 = __NeonFromChars(in.val[2], &bad);
+		uint8x16_t v3 = __NeonFromChars(in.val[3], &bad);
+
+		uint64x2_t b = vreinterpretq_u64_u8(bad);
+		if (vgetq_lane_u64(b, 0) | vgetq_lane_u64(b, 1))	break;
+
+		uint8x16x3_t out;
+		out.val[0] = vorrq_u8(vshlq_n_u8(v0, 2), vshrq_n_u8(v1, 4));
+		out.val[1] = vorrq_u8(vshlq_n_u8(v1, 4), vshrq_n_u8(v2, 2));
+		out.val[2] = vorrq_u8(vshlq_n_u8(v2, 6), v3);
+		vst3q_u8(dest + o, out);
+	}
+	*written = o;
+	return i;
+}
+#endif
+
+//whole 3 byte groups
+static void EncodeGroups(char *dest, const unsigned char *src, size_t groups)
+{
+	size_t len = groups * 3;
+	size_t done = 0;
+
+	switch (GetKernelId())
+	{
+#if defined(EASY_BASE64_X86)
+#if defined(EASY_BASE64_AVX2)
+	case KERNEL_AVX2:
+		done = EncodeAVX2(dest, src, len);
+		done += EncodeSSSE3(dest + done / 3 * 4, src + done, len - done);
+		break;
+#endif
+	case KERNEL_SSSE3:
+		done = EncodeSSSE3(dest, src, len);
+		break;
+#elif defined(EASY_BASE64_NEON)
+	case KERNEL_NEON:
+		done = EncodeNEON(dest, src, len);
+		break;
+#endif
+	default:
+		break;
+	}
+
+	EncodeScalar(dest + done / 3 * 4, src + done, (len - done) / 3);
+}
+
+//leading run of alphabet characters, stops at the first block holding anything else
+static size_t DecodeBlocks(unsigned char *dest, size_t size, const char *src, size_t len, size_t *written)
+{
+	size_t done = 0;
+	*written = 0;
+
+	switch (GetKernelId())
+	{
+#if defined(EASY_BASE64_X86)
+#if defined(EASY_BASE64_AVX2)
+	case KERNEL_AVX2:
+		done = DecodeAVX2(dest, size, src, len, written);
+		break;
+#endif
+	case KERNEL_SSSE3:
+		done = DecodeSSSE3(dest, size, src, len, written);
+		break;
+#elif defined(EASY_BASE64_NEON)
+	case KERNEL_NEON:
+		done = DecodeNEON(dest, size, src, len, written);
+		break;
+#endif
+	default:
+		break;
+	}
+
+	return done;
+}
+
+int EasyBase64::Encode(char *dest, size_t size, const unsigned char *src, size_t len)
+{
+	if (NULL == dest || (NULL == src && len > 0) || size < EncodeLength(len))	return -1;
+
+	EasyBase64Encoder encoder;
+	int n = encoder.Update(dest, size, src, len);
+	int m = encoder.Final(dest + n, size - n);
+
+	return n + m;
+}
+
+int EasyBase64::Decode(unsigned char *dest, size_t size, const char *src, size_t len)
+{
+	EasyBase64Decoder decoder;
+	int n = decoder.Update(dest, size, src, len);
+	if (n < 0)	return -1;
+
+	int m = decoder.Final(dest + n, size - n);
+	if (m < 0)	return -1;
+
+	return n + m;
+}
+
+const char* EasyBase64::GetKernel()
+{
+	switch (GetKernelId())
+	{
+	case KERNEL_AVX2:	return "avx2";
+	case KERNEL_SSSE3:	return "ssse3";
+	case KERNEL_NEON:	return "neon";
+	default:			return "scalar";
+	}
+}
+
+void EasyBase64::EnableSimd(bool enable)
+{
+	s_SimdEnabled = enable;
+}
+
+EasyBase64Encoder::EasyBase64Encoder()
+{
+	Reset();
+}
+
+void EasyBase64Encoder::Reset()
+{
+	carryLen_ = 0;
+}
+
+int EasyBase64Encoder::Update(char *dest, size_t size, const unsigned char *src, size_t len)
+{
+	if (NULL == dest || (NULL == src && len > 0))	return -1;
+	if (size < (carryLen_ + len) / 3 * 4)	return -1;
+
+	char *p = dest;
+	if (carryLen_ > 0)
+	{
+		if (carryLen_ + len < 3)
+		{
+			memcpy(carry_ + carryLen_, src, len);
+			carryLen_ += (int)len;
+			return 0;
+		}
+
+		unsigned char group[3];
+		size_t take = 3 - carryLen_;
+		memcpy(group, carry_, carryLen_);
+		memcpy(group + carryLen_, src, take);
+		EncodeScalar(p, group, 1);
+		p += 4;
+		src += take;
+		len -= take;
+		carryLen_ = 0;
+	}
+
+	size_t groups = len / 3;
+	EncodeGroups(p, src, groups);
+	p += groups * 4;
+
+	carryLen_ = (int)(len - groups * 3);
+	if (carryLen_ > 0)	memcpy(carry_, src + groups * 3, carryLen_);
+
+	return (int)(p - dest);
+}
+
+int EasyBase64Encoder::Final(char *dest, size_t size)
+{
+	if (carryLen_ == 0)	return 0;
+	if (NULL == dest || size < 4)	return -1;
+
+	unsigned int v = carry_[0] << 16;
+	if (carryLen_ > 1)	v |= carry_[1] << 8;
+
+	dest[0] = s_EncodeTable[v >> 18];
+	dest[1] = s_EncodeTable[(v >> 12) & 0x3F];
+	dest[2] = carryLen_ > 1 ? s_EncodeTable[(v >> 6) & 0x3F] : '=';
+	dest[3] = '=';
+
+	carryLen_ = 0;
+	return 4;
+}
+
+EasyBase64Decoder::EasyBase64Decoder()
+{
+	Reset();
+}
+
+void EasyBase64Decoder::Reset()
+{
+	quadLen_ = 0;
+	pad_ = 0;
+	end_ = false;
+	error_ = false;
+}
+
+int EasyBase64Decoder::Update(unsigned char *dest, size_t size, const char *src, size_t len)
+{
+	if (error_ || NULL == dest || (NULL == src && len > 0))	return -1;
+	if (size < (quadLen_ + len) / 4 * 3)	return -1;
+
+	size_t i = 0, o = 0;
+	while (i < len)
+	{
+		if (quadLen_ == 0 && !end_ && len - i >= 16)
+		{
+			size_t written = 0;
+			i += DecodeBlocks(dest + o, size - o, src + i, len - i, &written);
+			o += written;
+
+			//whole groups until something other than the alphabet shows up
+			while (i + 4 <= len)
+			{
+				unsigned int a = s_DecodeTable[(unsigned char)src[i]];
+				unsigned int b = s_DecodeTable[(unsigned char)src[i + 1]];
+				unsigned int c = s_DecodeTable[(unsigned char)src[i + 2]];
+				unsigned int d = s_DecodeTable[(unsigned char)src[i + 3]];
+				if ((a | b | c | d) & 0x80)	break;
+
+				unsigned int v = (a << 18) | (b << 12) | (c << 6) | d;
+				dest[o] = (unsigned char)(v >> 16);
+				dest[o + 1] = (unsigned char)(v >> 8);
+				dest[o + 2] = (unsigned char)v;
+				i += 4;
+				o += 3;
+			}
+			if (i >= len)	break;
+		}
+
+		unsigned char v = s_DecodeTable[(unsigned char)src[i++]];
+		if (v < 64)
+		{
+			if (end_)
+			{
+				error_ = true;
+				return -1;
+			}
+
+			quad_[quadLen_++] = v;
+			if (quadLen_ == 4)
+			{
+				dest[o++] = (unsigned char)((quad_[0] << 2) | (quad_[1] >> 4));
+				dest[o++] = (unsigned char)((quad_[1] << 4) | (quad_[2] >> 2));
+				dest[o++] = (unsigned char)((quad_[2] << 6) | quad_[3]);
+				quadLen_ = 0;
+			}
+		}
+		else if (v == B64_SKIP)
+		{
+			continue;
+		}
+		else if (v == B64_PAD && !end_ && quadLen_ >= 2)
+		{
+			//first '=' closes the group
+			dest[o++] = (unsigned char)((quad_[0] << 2) | (quad_[1] >> 4));
+			if (quadLen_ == 3)	dest[o++] = (unsigned char)((quad_[1] << 4) | (quad_[2] >> 2));
+			pad_ = 3 - quadLen_;
+			quadLen_ = 0;
+			end_ = true;
+		}
+		else if (v == B64_PAD && end_ && pad_ > 0)
+		{
+			pad_--;
+		}
+		else
+		{
+			error_ = true;
+			return -1;
+		}
+	}
+
+	return (int)o;
+}
+
+int EasyBase64Decoder::Final(unsigned char *dest, size_t size)
+{
+	if (error_ || quadLen_ == 1)
+	{
+		Reset();
+		return -1;
+	}
+	if (NULL == dest || size < (size_t)(quadLen_ > 0 ? quadLen_ - 1 : 0))	return -1;
+
+	//unpadded tail
+	int o = 0;
+	if (quadLen_ >= 2)	dest[o++] = (unsigned char)((quad_[0] << 2) | (quad_[1] >> 4));
+	if (quadLen_ == 3)	dest[o++] = (unsigned char)((quad_[1] << 4) | (quad_[2] >> 2));
+
+	Reset();
+	return o;
+}
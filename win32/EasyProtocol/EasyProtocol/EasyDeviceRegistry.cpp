@@ -0,0 +1,248 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyDeviceRegistry.cpp
+*/
+
+#include <EasyDeviceRegistry.h>
+#include <algorithm>
+
+namespace EasyDarwin { namespace Protocol
+{
+	enum
+	{
+		DELTA_ADDED = 0,
+		DELTA_REMOVED,
+		DELTA_CHANGED
+	};
+
+	typedef struct __DELTA_EVENT_T
+	{
+		int kind;
+		size_t before;		//index into the old snapshot
+		size_t after;		//index into the new one
+	}DELTA_EVENT_T;
+
+	static bool EntrySerialLess(const EASY_DEVICE_ENTRY_T *a, const EASY_DEVICE_ENTRY_T *b)
+	{
+		return a->serial < b->serial;
+	}
+
+	static bool EntrySerialGreater(const EASY_DEVICE_ENTRY_T *a, const EASY_DEVICE_ENTRY_T *b)
+	{
+		return b->serial < a->serial;
+	}
+
+	static void Assign(string& out, boost::string_ref value)
+	{
+		out.assign(value.data(), value.size());
+	}
+
+	static void Fill(EasyDevice& device, const EASY_DEVICE_ENTRY_T& entry)
+	{
+		Assign(device.serial_, entry.serial);
+		Assign(device.name_, entry.name);
+		Assign(device.tag_, entry.tag);
+		Assign(device.snapJpgPath_, entry.snapURL);
+		Assign(device.appType_, entry.appType);
+		Assign(device.terminalType_, entry.terminalType);
+		Assign(device.status_, entry.status);
+		Assign(device.channel_, entry.channel);
+	}
+
+	//true if anything an NVR's channels could depend on differs
+	static bool IdentityChanged(const EasyDevice& device, const EASY_DEVICE_ENTRY_T& entry)
+	{
+		return entry.name != device.name_ || entry.tag != device.tag_ || entry.appType != device.appType_ ||
+			entry.terminalType != device.terminalType_ || entry.status != device.status_ || entry.channel != device.channel_;
+	}
+
+	//std::swap would copy every string before C++11
+	static void SwapDevice(EasyDevice& a, EasyDevice& b)
+	{
+		a.appType_.swap(b.appType_);
+		a.terminalType_.swap(b.terminalType_);
+		a.serial_.swap(b.serial_);
+		a.name_.swap(b.name_);
+		a.status_.swap(b.status_);
+		a.password_.swap(b.password_);
+		a.tag_.swap(b.tag_);
+		a.channel_.swap(b.channel_);
+		a.snapJpgPath_.swap(b.snapJpgPath_);
+	}
+
+	EasyDeviceRegistry::EasyDeviceRegistry()
+	{
+	}
+
+	EASY_REGISTRY_DELTA_T EasyDeviceRegistry::Update(const EasyDeviceTable& table, EasyDeviceRegistryListener *listener)
+	{
+		vector<const EASY_DEVICE_ENTRY_T*> sorted(table.Size());
+		for (size_t i = 0; i < sorted.size(); i++)	sorted[i] = &table[i];
+		return Merge(sorted, listener);
+	}
+
+	EASY_REGISTRY_DELTA_T EasyDeviceRegistry::Update(const EasyDevices& devices, EasyDeviceRegistryListener *listener)
+	{
+		vector<EASY_DEVICE_ENTRY_T> views(devices.size());
+		vector<const EASY_DEVICE_ENTRY_T*> sorted(devices.size());
+		size_t i = 0;
+		for (EasyDevices::const_iterator it = devices.begin(); it != devices.end(); ++it, ++i)
+		{
+			EASY_DEVICE_ENTRY_T& view = views[i];
+			view.serial = it->first;
+			view.name = it->second.name_;
+			view.tag = it->second.tag_;
+			view.snapURL = it->second.snapJpgPath_;
+			view.appType = it->second.appType_;
+			view.terminalType = it->second.terminalType_;
+			view.status = it->second.status_;
+			view.channel = it->second.channel_;
+			sorted[i] = &view;
+		}
+		return Merge(sorted, listener);
+	}
+
+	EASY_REGISTRY_DELTA_T EasyDeviceRegistry::Merge(vector<const EASY_DEVICE_ENTRY_T*>& sorted, EasyDeviceRegistryListener *listener)
+	{
+		//the CMS usually lists by serial already; stable, so the last of several
+		//equal serials is still the one the list gave last
+		if (std::adjacent_find(sorted.begin(), sorted.end(), EntrySerialGreater) != sorted.end())
+		{
+			std::stable_sort(sorted.begin(), sorted.end(), EntrySerialLess);
+		}
+
+		EASY_REGISTRY_DELTA_T delta = {0, 0, 0, 0};
+		vector<REGISTRY_ENTRY_T> next;
+		next.reserve(sorted.size());
+		vector<DELTA_EVENT_T> events;
+
+		size_t i = 0;
+		size_t j = 0;
+		while (i < entries_.size() || j < sorted.size())
+		{
+			//skip to the last of equal serials
+			while (j + 1 < sorted.size() && sorted[j + 1]->serial == sorted[j]->serial)	j++;
+
+			int order;		//< 0 only listed, > 0 only in the snapshot
+			if (i == entries_.size())		order = -1;
+			else if (j == sorted.size())	order = 1;
+			else							order = sorted[j]->serial.compare(entries_[i].device.serial_);
+
+			DELTA_EVENT_T event = {DELTA_ADDED, i, next.size()};
+			if (order > 0)
+			{
+				event.kind = DELTA_REMOVED;
+				events.push_back(event);
+				delta.removed++;
+				i++;
+				continue;
+			}
+
+			next.push_back(REGISTRY_ENTRY_T());
+			REGISTRY_ENTRY_T& entry = next.back();
+			entry.channelsValid = false;
+			const EASY_DEVICE_ENTRY_T& listed = *sorted[j];
+			if (order < 0)
+			{
+				Fill(entry.device, listed);
+				events.push_back(event);
+				delta.added++;
+				j++;
+				continue;
+			}
+
+			REGISTRY_ENTRY_T& old = entries_[i];
+			bool identityChanged = IdentityChanged(old.device, listed);
+			if (!identityChanged && listed.snapURL == old.device.snapJpgPath_)
+			{
+				SwapDevice(entry.device, old.device);
+				delta.unchanged++;
+			}
+			else
+			{
+				//old.device stays as it was for OnDeviceChanged
+				Fill(entry.device, listed);
+				entry.device.password_ = old.device.password_;
+				event.kind = DELTA_CHANGED;
+				events.push_back(event);
+				delta.changed++;
+			}
+			if (!identityChanged)
+			{
+				entry.channels.swap(old.channels);
+				entry.channelsValid = old.channelsValid;
+			}
+			i++;
+			j++;
+		}
+
+		entries_.swap(next);
+		if (NULL == listener)	return delta;
+
+		//next now holds the previous snapshot
+		for (size_t e = 0; e < events.size(); e++)
+		{
+			const DELTA_EVENT_T& event = events[e];
+			if (event.kind == DELTA_ADDED)			listener->OnDeviceAdded(entries_[event.after].device);
+			else if (event.kind == DELTA_REMOVED)	listener->OnDeviceRemoved(next[event.before].device);
+			else									listener->OnDeviceChanged(next[event.before].device, entries_[event.after].device);
+		}
+		return delta;
+	}
+
+	const EasyDeviceRegistry::REGISTRY_ENTRY_T* EasyDeviceRegistry::Lookup(boost::string_ref serial) const
+	{
+		size_t low = 0;
+		size_t high = entries_.size();
+		while (low < high)
+		{
+			size_t mid = low + (high - low) / 2;
+			if (serial.compare(entries_[mid].device.serial_) > 0)	low = mid + 1;
+			else													high = mid;
+		}
+		if (low == entries_.size() || serial != entries_[low].device.serial_)	return NULL;
+		return &entries_[low];
+	}
+
+	bool EasyDeviceRegistry::NeedsChannels(const string& serial) const
+	{
+		const REGISTRY_ENTRY_T *entry = Lookup(serial);
+		if (NULL == entry || entry->channelsValid)	return false;
+		return EasyProtocol::GetAppType(entry->device.appType_) == EASY_APP_TYPE_NVR;
+	}
+
+	void EasyDeviceRegistry::SetChannels(const string& serial, const EasyDevices& channels)
+	{
+		REGISTRY_ENTRY_T *entry = const_cast<REGISTRY_ENTRY_T*>(Lookup(serial));
+		if (NULL == entry)	return;
+
+		entry->channels = channels;
+		entry->channelsValid = true;
+	}
+
+	const EasyDevices* EasyDeviceRegistry::GetChannels(const string& serial) const
+	{
+		const REGISTRY_ENTRY_T *entry = Lookup(serial);
+		if (NULL == entry || !entry->channelsValid)	return NULL;
+		return &entry->channels;
+	}
+
+	void EasyDeviceRegistry::InvalidateChannels()
+	{
+		for (size_t i = 0; i < entries_.size(); i++)
+		{
+			entries_[i].channelsValid = false;
+		}
+	}
+
+	const EasyDevice* EasyDeviceRegistry::Find(const string& serial) const
+	{
+		const REGISTRY_ENTRY_T *entry = Lookup(serial);
+		return NULL == entry ? NULL : &entry->device;
+	}
+}}//namespace
@@ -0,0 +1,322 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyDeviceTable.cpp
+*/
+
+#include <EasyDeviceTable.h>
+#include <EasyJsonReader.h>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+namespace EasyDarwin { namespace Protocol
+{
+	class DeviceTableHandler : public EasyJsonHandler
+	{
+	public:
+		enum
+		{
+			SECTION_OTHER = 0,
+			SECTION_TOP,
+			SECTION_ROOT,
+			SECTION_HEADER,
+			SECTION_BODY,
+			SECTION_LIST,
+			SECTION_ITEM
+		};
+
+		DeviceTableHandler(vector<EASY_DEVICE_ENTRY_T>& entries, vector<EasyJsonField>& header, vector<EasyJsonField>& body,
+			const char *listTag, const char *countTag, bool& complete)
+			: entries_(entries)
+			, header_(header)
+			, body_(body)
+			, listTag_(listTag)
+			, countTag_(countTag)
+			, complete_(complete)
+			, depth_(0)
+		{
+			complete_ = true;
+		}
+
+		virtual bool StartObject()
+		{
+			int parent = Top();
+			int section = SECTION_OTHER;
+			if (parent == SECTION_HEADER || parent == SECTION_BODY)	complete_ = false;
+			if (depth_ == 0)
+			{
+				section = SECTION_TOP;
+			}
+			else if (parent == SECTION_TOP && key_ == EASY_TAG_ROOT)
+			{
+				section = SECTION_ROOT;
+			}
+			else if (parent == SECTION_ROOT && key_ == EASY_TAG_HEADER)
+			{
+				section = SECTION_HEADER;
+			}
+			else if (parent == SECTION_ROOT && key_ == EASY_TAG_BODY)
+			{
+				section = SECTION_BODY;
+			}
+			else if (parent == SECTION_LIST)
+			{
+				section = SECTION_ITEM;
+				entries_.push_back(EASY_DEVICE_ENTRY_T());
+			}
+			return Push(section);
+		}
+
+		virtual bool EndObject()
+		{
+			depth_--;
+			return true;
+		}
+
+		virtual bool StartArray()
+		{
+			int parent = Top();
+			if (parent == SECTION_BODY && key_ == listTag_)	return Push(SECTION_LIST);
+			if (parent == SECTION_HEADER || parent == SECTION_BODY)	complete_ = false;
+			return Push(SECTION_OTHER);
+		}
+
+		virtual bool EndArray()
+		{
+			depth_--;
+			return true;
+		}
+
+		virtual bool Key(const char *str, size_t len)
+		{
+			key_ = boost::string_ref(str, len);
+			return true;
+		}
+
+		virtual bool String(const char *str, size_t len)
+		{
+			return Value(boost::string_ref(str, len));
+		}
+
+		virtual bool Scalar(const char *str, size_t len)
+		{
+			//null reads as "", as asString() gives it
+			if (len == 4 && memcmp(str, "null", 4) == 0)	return Value(boost::string_ref());
+			return Value(boost::string_ref(str, len));
+		}
+
+	private:
+		int Top()
+		{
+			return depth_ > 0 ? stack_[depth_ - 1] : -1;
+		}
+
+		bool Push(int section)
+		{
+			if (depth_ >= EASY_JSON_MAX_DEPTH)	return false;
+			stack_[depth_++] = section;
+			return true;
+		}
+
+		bool Value(boost::string_ref value)
+		{
+			switch (Top())
+			{
+			case SECTION_HEADER:
+				header_.push_back(EasyJsonField(key_, value));
+				break;
+			case SECTION_BODY:
+				body_.push_back(EasyJsonField(key_, value));
+				if (key_ == countTag_)
+				{
+					//pre-size from the announced count, the list follows it in sorted output
+					size_t count = strtoul(value.to_string().c_str(), NULL, 10);
+					if (count > entries_.capacity() && count < (1 << 24))	entries_.reserve(count);
+				}
+				break;
+			case SECTION_ITEM:
+				SetField(entries_.back(), value);
+				break;
+			default:
+				break;
+			}
+			return true;
+		}
+
+		void SetField(EASY_DEVICE_ENTRY_T& entry, boost::string_ref value)
+		{
+			if (key_ == EASY_TAG_SERIAL)				entry.serial = value;
+			else if (key_ == EASY_TAG_NAME)				entry.name = value;
+			else if (key_ == EASY_TAG_TAG)				entry.tag = value;
+			else if (key_ == EASY_TAG_SNAP_URL)			entry.snapURL = value;
+			else if (key_ == EASY_TAG_APP_TYPE)			entry.appType = value;
+			else if (key_ == EASY_TAG_TERMINAL_TYPE)	entry.terminalType = value;
+			else if (key_ == EASY_TAG_STATUS)			entry.status = value;
+			else if (key_ == EASY_TAG_CHANNEL)			entry.channel = value;
+		}
+
+		vector<EASY_DEVICE_ENTRY_T>& entries_;
+		vector<EasyJsonField>& header_;
+		vector<EasyJsonField>& body_;
+		boost::string_ref listTag_;
+		boost::string_ref countTag_;
+		bool& complete_;
+
+		boost::string_ref key_;
+		int stack_[EASY_JSON_MAX_DEPTH];
+		int depth_;
+	};
+
+	class SerialLess
+	{
+	public:
+		SerialLess(const vector<EASY_DEVICE_ENTRY_T>& entries) : entries_(entries) {}
+
+		bool operator()(unsigned int a, unsigned int b) const					{return entries_[a].serial < entries_[b].serial;}
+		bool operator()(unsigned int a, const boost::string_ref& b) const		{return entries_[a].serial < b;}
+		bool operator()(const boost::string_ref& a, unsigned int b) const		{return a < entries_[b].serial;}
+
+	private:
+		const vector<EASY_DEVICE_ENTRY_T>& entries_;
+	};
+
+	EasyDeviceTable::EasyDeviceTable() : complete_(true)
+	{
+	}
+
+	EasyDeviceTable::EasyDeviceTable(const EasyDeviceTable& other)
+	{
+		Rebase(other);
+	}
+
+	EasyDeviceTable& EasyDeviceTable::operator=(const EasyDeviceTable& other)
+	{
+		if (this != &other)	Rebase(other);
+		return *this;
+	}
+
+	//copies point into the new arena
+	void EasyDeviceTable::Rebase(const EasyDeviceTable& other)
+	{
+		arena_ = other.arena_;
+		entries_ = other.entries_;
+		header_ = other.header_;
+		body_ = other.body_;
+		index_ = other.index_;
+		complete_ = other.complete_;
+
+		if (arena_.empty())	return;
+
+		const char *from = &other.arena_[0];
+		char *to = &arena_[0];
+
+		#define REBASE(ref)	if (!(ref).empty()) (ref) = boost::string_ref(to + ((ref).data() - from), (ref).size())
+		for (size_t i = 0; i < entries_.size(); i++)
+		{
+			EASY_DEVICE_ENTRY_T& entry = entries_[i];
+			REBASE(entry.serial);
+			REBASE(entry.name);
+			REBASE(entry.tag);
+			REBASE(entry.snapURL);
+			REBASE(entry.appType);
+			REBASE(entry.terminalType);
+			REBASE(entry.status);
+			REBASE(entry.channel);
+		}
+		for (size_t i = 0; i < header_.size(); i++)
+		{
+			REBASE(header_[i].first);
+			REBASE(header_[i].second);
+		}
+		for (size_t i = 0; i < body_.size(); i++)
+		{
+			REBASE(body_[i].first);
+			REBASE(body_[i].second);
+		}
+		#undef REBASE
+	}
+
+	void EasyDeviceTable::Clear()
+	{
+		arena_.clear();
+		entries_.clear();
+		header_.clear();
+		body_.clear();
+		index_.clear();
+		complete_ = true;
+	}
+
+	int EasyDeviceTable::Parse(const char *msg, size_t len, const char *listTag, const char *countTag)
+	{
+		Clear();
+		if (NULL == msg || len == 0)	return -1;
+
+		arena_.assign(msg, msg + len);
+		entries_.reserve(len / 160);		//about the size of one serialized device
+
+		DeviceTableHandler handler(entries_, header_, body_, listTag, countTag, complete_);
+		if (!EasyJsonReader::ParseInsitu(&arena_[0], len, handler))
+		{
+			Clear();
+			return -1;
+		}
+
+		return (int)entries_.size();
+	}
+
+	int EasyDeviceTable::ParseDeviceList(const char *msg, size_t len)
+	{
+		return Parse(msg, len, EASY_TAG_DEVICES, EASY_TAG_DEVICE_COUNT);
+	}
+
+	int EasyDeviceTable::ParseDeviceInfo(const char *msg, size_t len)
+	{
+		return Parse(msg, len, EASY_TAG_CHANNELS, EASY_TAG_CHANNEL_COUNT);
+	}
+
+	const EASY_DEVICE_ENTRY_T* EasyDeviceTable::Find(boost::string_ref serial)
+	{
+		if (index_.size() != entries_.size())
+		{
+			index_.resize(entries_.size());
+			for (size_t i = 0; i < index_.size(); i++)	index_[i] = (unsigned int)i;
+			std::stable_sort(index_.begin(), index_.end(), SerialLess(entries_));
+		}
+
+		vector<unsigned int>::iterator it = std::upper_bound(index_.begin(), index_.end(), serial, SerialLess(entries_));
+		if (it == index_.begin())	return NULL;
+
+		--it;
+		if (entries_[*it].serial != serial)	return NULL;
+		return &entries_[*it];
+	}
+
+	boost::string_ref EasyDeviceTable::GetHeaderValue(boost::string_ref tag) const
+	{
+		for (size_t i = 0; i < header_.size(); i++)
+		{
+			if (header_[i].first == tag)	return header_[i].second;
+		}
+		return boost::string_ref();
+	}
+
+	boost::string_ref EasyDeviceTable::GetBodyValue(boost::string_ref tag) const
+	{
+		for (size_t i = 0; i < body_.size(); i++)
+		{
+			if (body_[i].first == tag)	return body_[i].second;
+		}
+		return boost::string_ref();
+	}
+
+	size_t EasyDeviceTable::GetMemorySize() const
+	{
+		return arena_.capacity() + entries_.capacity() * sizeof(EASY_DEVICE_ENTRY_T) +
+			(header_.capacity() + body_.capacity()) * sizeof(EasyJsonField) + index_.capacity() * sizeof(unsigned int);
+	}
+}}//namespace
@@ -0,0 +1,287 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyFetchScheduler.cpp
+*/
+
+#include <EasyFetchScheduler.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef CRITICAL_SECTION	EASY_FETCH_LOCK_T;
+
+#define	_Fetch_InitLock(x)		InitializeCriticalSection(x)
+#define	_Fetch_DeinitLock(x)	DeleteCriticalSection(x)
+#define	_Fetch_Lock(x)			EnterCriticalSection(x)
+#define	_Fetch_Unlock(x)		LeaveCriticalSection(x)
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t		EASY_FETCH_LOCK_T;
+
+#define	_Fetch_InitLock(x)		pthread_mutex_init(x, NULL)
+#define	_Fetch_DeinitLock(x)	pthread_mutex_destroy(x)
+#define	_Fetch_Lock(x)			pthread_mutex_lock(x)
+#define	_Fetch_Unlock(x)		pthread_mutex_unlock(x)
+#endif
+
+namespace EasyDarwin { namespace Protocol
+{
+	//streams a body to file + ".part"
+	class FetchFileSink : public EasyHttpSink
+	{
+	public:
+		FetchFileSink(const string& file) : file_(file), part_(file + ".part"), fp_(NULL), failed_(false) {}
+		~FetchFileSink()	{if (fp_)	fclose(fp_);}
+
+		virtual bool OnHttpBody(const char *data, size_t len)
+		{
+			if (NULL == fp_ && !Open())	return false;
+			if (fwrite(data, 1, len, fp_) == len)	return true;
+			failed_ = true;
+			return false;
+		}
+
+		//renames the part file into place, or removes it; false if the file could not be written
+		bool Finish(bool complete)
+		{
+			if (complete && NULL == fp_)	Open();		//empty body
+			if (fp_ && fclose(fp_) != 0)	failed_ = true;
+			fp_ = NULL;
+
+			if (!complete || failed_)
+			{
+				remove(part_.c_str());
+				return !failed_;
+			}
+			remove(file_.c_str());
+			if (rename(part_.c_str(), file_.c_str()) == 0)	return true;
+			remove(part_.c_str());
+			return false;
+		}
+
+	private:
+		bool Open()
+		{
+			fp_ = fopen(part_.c_str(), "wb");
+			failed_ = NULL == fp_;
+			return !failed_;
+		}
+
+		string file_;
+		string part_;
+		FILE *fp_;
+		bool failed_;
+	};
+
+	EasyFetchScheduler::EasyFetchScheduler(int perHost, int timeoutMs)
+		: perHost_(perHost > 0 ? perHost : 1)
+		, timeoutMs_(timeoutMs)
+		, stopping_(false)
+		, seq_(0)
+		, requests_(0)
+		, merged_(0)
+	{
+		EASY_FETCH_LOCK_T *lock = new EASY_FETCH_LOCK_T;
+		_Fetch_InitLock(lock);
+		lock_ = lock;
+	}
+
+	EasyFetchScheduler::~EasyFetchScheduler()
+	{
+		Cancel(true);
+
+		//running fetches report from here
+		for (map<string, FETCH_HOST_T*>::iterator it = hosts_.begin(); it != hosts_.end(); ++it)
+		{
+			delete it->second->client;
+			delete it->second;
+		}
+		hosts_.clear();
+
+		EASY_FETCH_LOCK_T *lock = (EASY_FETCH_LOCK_T *)lock_;
+		_Fetch_DeinitLock(lock);
+		delete lock;
+	}
+
+	void EasyFetchScheduler::Cancel(bool stop)
+	{
+		EASY_FETCH_LOCK_T *lock = (EASY_FETCH_LOCK_T *)lock_;
+
+		vector<FETCH_ITEM_T*> cancelled;
+		_Fetch_Lock(lock);
+		if (stop)	stopping_ = true;
+		for (map<string, FETCH_HOST_T*>::iterator it = hosts_.begin(); it != hosts_.end(); ++it)
+		{
+			set<FETCH_ITEM_T*, ItemOrder>& queue = it->second->queue;
+			cancelled.insert(cancelled.end(), queue.begin(), queue.end());
+			queue.clear();
+		}
+		for (size_t i = 0; i < cancelled.size(); i++)	items_.erase(cancelled[i]->url);
+		_Fetch_Unlock(lock);
+
+		EASY_HTTP_RESPONSE_T response;
+		response.status = EASY_HTTP_ERROR_CANCELLED;
+		for (size_t i = 0; i < cancelled.size(); i++)
+		{
+			FETCH_ITEM_T *item = cancelled[i];
+			for (size_t w = 0; w < item->waiters.size(); w++)
+			{
+				if (item->waiters[w].handler)	item->waiters[w].handler->OnFetched(item->url, item->waiters[w].context, response);
+			}
+			delete item->sink;
+			delete item;
+		}
+	}
+
+	bool EasyFetchScheduler::Fetch(const string& url, int priority, EasyFetchHandler *handler, void *context, const string& file)
+	{
+		string host;
+		unsigned short port;
+		string path;
+		if (url.compare(0, 7, "http://") != 0 || !EasyHttpClient::SplitURL(url, host, port, path))	return false;
+
+		FETCH_WAITER_T waiter;
+		waiter.handler = handler;
+		waiter.context = context;
+
+		EASY_FETCH_LOCK_T *lock = (EASY_FETCH_LOCK_T *)lock_;
+		_Fetch_Lock(lock);
+		if (stopping_)
+		{
+			_Fetch_Unlock(lock);
+			return false;
+		}
+
+		map<string, FETCH_ITEM_T*>::iterator found = items_.find(url);
+		if (found != items_.end())
+		{
+			FETCH_ITEM_T *item = found->second;
+			item->waiters.push_back(waiter);
+			if (!item->running && priority > item->priority)
+			{
+				item->host->queue.erase(item);
+				item->priority = priority;
+				item->host->queue.insert(item);
+			}
+			merged_++;
+			_Fetch_Unlock(lock);
+			return true;
+		}
+
+		char key[16];
+		sprintf(key, ":%u", (unsigned)port);
+		FETCH_HOST_T *&fetchHost = hosts_[host + key];
+		if (NULL == fetchHost)
+		{
+			fetchHost = new FETCH_HOST_T;
+			fetchHost->client = new EasyHttpClient(host, port, perHost_, timeoutMs_);
+			fetchHost->running = 0;
+		}
+
+		FETCH_ITEM_T *item = new FETCH_ITEM_T;
+		item->url = url;
+		item->path = path;
+		item->priority = priority;
+		item->seq = seq_++;
+		item->running = false;
+		item->host = fetchHost;
+		item->sink = file.empty() ? NULL : new FetchFileSink(file);
+		item->waiters.push_back(waiter);
+		items_[url] = item;
+		fetchHost->queue.insert(item);
+		Dispatch(fetchHost);
+		_Fetch_Unlock(lock);
+		return true;
+	}
+
+	bool EasyFetchScheduler::SetPriority(const string& url, int priority)
+	{
+		EASY_FETCH_LOCK_T *lock = (EASY_FETCH_LOCK_T *)lock_;
+		_Fetch_Lock(lock);
+		map<string, FETCH_ITEM_T*>::iterator found = items_.find(url);
+		bool queued = found != items_.end() && !found->second->running;
+		if (queued)
+		{
+			FETCH_ITEM_T *item = found->second;
+			item->host->queue.erase(item);
+			item->priority = priority;
+			item->host->queue.insert(item);
+		}
+		_Fetch_Unlock(lock);
+		return queued;
+	}
+
+	void EasyFetchScheduler::Dispatch(FETCH_HOST_T *host)
+	{
+		//the client never holds more than it has connections, so the order stays ours
+		while (host->running < perHost_ && !host->queue.empty())
+		{
+			FETCH_ITEM_T *item = *host->queue.begin();
+			host->queue.erase(host->queue.begin());
+			item->running = true;
+			host->running++;
+			requests_++;
+			host->client->GetAsync(item->path, this, item, item->sink);
+		}
+	}
+
+	void EasyFetchScheduler::OnHttpResponse(const string&, void *context, const EASY_HTTP_RESPONSE_T& response)
+	{
+		FETCH_ITEM_T *item = (FETCH_ITEM_T *)context;
+
+		const EASY_HTTP_RESPONSE_T *result = &response;
+		EASY_HTTP_RESPONSE_T fileError;
+		if (item->sink)
+		{
+			bool complete = response.status >= 200 && response.status < 300;
+			if (!((FetchFileSink *)item->sink)->Finish(complete))
+			{
+				fileError.status = EASY_FETCH_ERROR_FILE;
+				result = &fileError;
+			}
+		}
+
+		EASY_FETCH_LOCK_T *lock = (EASY_FETCH_LOCK_T *)lock_;
+		_Fetch_Lock(lock);
+		items_.erase(item->url);
+		item->host->running--;
+		Dispatch(item->host);
+		//no one can join the item from here on
+		_Fetch_Unlock(lock);
+
+		for (size_t w = 0; w < item->waiters.size(); w++)
+		{
+			if (item->waiters[w].handler)	item->waiters[w].handler->OnFetched(item->url, item->waiters[w].context, *result);
+		}
+		delete item->sink;
+		delete item;
+	}
+
+	void EasyFetchScheduler::Wait()
+	{
+		EASY_FETCH_LOCK_T *lock = (EASY_FETCH_LOCK_T *)lock_;
+		for (;;)
+		{
+			vector<EasyHttpClient*> clients;
+			_Fetch_Lock(lock);
+			bool done = items_.empty();
+			for (map<string, FETCH_HOST_T*>::iterator it = hosts_.begin(); it != hosts_.end(); ++it)
+			{
+				clients.push_back(it->second->client);
+			}
+			_Fetch_Unlock(lock);
+			if (done)	break;
+
+			//a host drains its whole queue before its client goes idle, since the next
+			//fetch is dispatched from the completion of the last one
+			for (size_t i = 0; i < clients.size(); i++)	clients[i]->Wait();
+		}
+	}
+}}//namespace
@@ -0,0 +1,322 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyG711.cpp
+*/
+
+#include <EasyG711.h>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EASY_G711_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define EASY_G711_NEON
+#include <arm_neon.h>
+#endif
+
+//generated from DecodeSample()
+static const short s_ALawDecodeTable[256] =
+{
+	 -5504,  -5248,  -6016,  -5760,  -4480,  -4224,  -4992,  -4736,
+	 -7552,  -7296,  -8064,  -7808,  -6528,  -6272,  -7040,  -6784,
+	 -2752,  -2624,  -3008,  -2880,  -2240,  -2112,  -2496,  -2368,
+	 -3776,  -3648,  -4032,  -3904,  -3264,  -3136,  -3520,  -3392,
+	-22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
+	-30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+	-11008, -10496, -12032, -11520,  -8960,  -8448,  -9984,  -9472,
+	-15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+	  -344,   -328,   -376,   -360,   -280,   -264,   -312,   -296,
+	  -472,   -456,   -504,   -488,   -408,   -392,   -440,   -424,
+	   -88,    -72,   -120,   -104,    -24,     -8,    -56,    -40,
+	  -216,   -200,   -248,   -232,   -152,   -136,   -184,   -168,
+	 -1376,  -1312,  -1504,  -1440,  -1120,  -1056,  -1248,  -1184,
+	 -1888,  -1824,  -2016,  -1952,  -1632,  -1568,  -1760,  -1696,
+	  -688,   -656,   -752,   -720,   -560,   -528,   -624,   -592,
+	  -944,   -912,  -1008,   -976,   -816,   -784,   -880,   -848,
+	  5504,   5248,   6016,   5760,   4480,   4224,   4992,   4736,
+	  7552,   7296,   8064,   7808,   6528,   6272,   7040,   6784,
+	  2752,   2624,   3008,   2880,   2240,   2112,   2496,   2368,
+	  3776,   3648,   4032,   3904,   3264,   3136,   3520,   3392,
+	 22016,  20992,  24064,  23040,  17920,  16896,  19968,  18944,
+	 30208,  29184,  32256,  31232,  26112,  25088,  28160,  27136,
+	 11008,  10496,  12032,  11520,   8960,   8448,   9984,   9472,
+	 15104,  14592,  16128,  15616,  13056,  12544,  14080,  13568,
+	   344,    328,    376,    360,    280,    264,    312,    296,
+	   472,    456,    504,    488,    408,    392,    440,    424,
+	    88,     72,    120,    104,     24,      8,     56,     40,
+	   216,    200,    248,    232,    152,    136,    184,    168,
+	  1376,   1312,   1504,   1440,   1120,   1056,   1248,   1184,
+	  1888,   1824,   2016,   1952,   1632,   1568,   1760,   1696,
+	   688,    656,    752,    720,    560,    528,    624,    592,
+	   944,    912,   1008,    976,    816,    784,    880,    848
+};
+
+static const short s_ULawDecodeTable[256] =
+{
+	-32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956,
+	-23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764,
+	-15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412,
+	-11900, -11388, -10876, -10364,  -9852,  -9340,  -8828,  -8316,
+	 -7932,  -7676,  -7420,  -7164,  -6908,  -6652,  -6396,  -6140,
+	 -5884,  -5628,  -5372,  -5116,  -4860,  -4604,  -4348,  -4092,
+	 -3900,  -3772,  -3644,  -3516,  -3388,  -3260,  -3132,  -3004,
+	 -2876,  -2748,  -2620,  -2492,  -2364,  -2236,  -2108,  -1980,
+	 -1884,  -1820,  -1756,  -1692,  -1628,  -1564,  -1500,  -1436,
+	 -1372,  -1308,  -1244,  -1180,  -1116,  -1052,   -988,   -924,
+	  -876,   -844,   -812,   -780,   -748,   -716,   -684,   -652,
+	  -620,   -588,   -556,   -524,   -492,   -460,   -428,   -396,
+	  -372,   -356,   -340,   -324,   -308,   -292,   -276,   -260,
+	  -244,   -228,   -212,   -196,   -180,   -164,   -148,   -132,
+	  -120,   -112,   -104,    -96,    -88,    -80,    -72,    -64,
+	   -56,    -48,    -40,    -32,    -24,    -16,     -8,      0,
+	 32124,  31100,  30076,  29052,  28028,  27004,  25980,  24956,
+	 23932,  22908,  21884,  20860,  19836,  18812,  17788,  16764,
+	 15996,  15484,  14972,  14460,  13948,  13436,  12924,  12412,
+	 11900,  11388,  10876,  10364,   9852,   9340,   8828,   8316,
+	  7932,   7676,   7420,   7164,   6908,   6652,   6396,   6140,
+	  5884,   5628,   5372,   5116,   4860,   4604,   4348,   4092,
+	  3900,   3772,   3644,   3516,   3388,   3260,   3132,   3004,
+	  2876,   2748,   2620,   2492,   2364,   2236,   2108,   1980,
+	  1884,   1820,   1756,   1692,   1628,   1564,   1500,   1436,
+	  1372,   1308,   1244,   1180,   1116,   1052,    988,    924,
+	   876,    844,    812,    780,    748,    716,    684,    652,
+	   620,    588,    556,    524,    492,    460,    428,    396,
+	   372,    356,    340,    324,    308,    292,    276,    260,
+	   244,    228,    212,    196,    180,    164,    148,    132,
+	   120,    112,    104,     96,     88,     80,     72,     64,
+	    56,     48,     40,     32,     24,     16,      8,      0
+};
+
+//A-law depends only on pcm>>4, u-law only on pcm>>2
+static unsigned char s_ALawEncodeTable[1 << 12];
+static unsigned char s_ULawEncodeTable[1 << 14];
+
+static struct EasyG711TableInit
+{
+	EasyG711TableInit()
+	{
+		//index back to a signed sample; multiplied since shifting a negative value is undefined
+		for (int i = 0; i < (1 << 12); i++)
+		{
+			int v = (i ^ 0x800) - 0x800;
+			s_ALawEncodeTable[i] = EasyG711::ALawEncodeSample((short)(v * 16));
+		}
+		for (int i = 0; i < (1 << 14); i++)
+		{
+			int v = (i ^ 0x2000) - 0x2000;
+			s_ULawEncodeTable[i] = EasyG711::ULawEncodeSample((short)(v * 4));
+		}
+	}
+} s_EasyG711TableInit;
+
+/*
+ * Branch-free encoders. The segment and the 4 mantissa bits are read from
+ * the IEEE-754 representation of the magnitude: (bits >> 19) is
+ * (exponent << 4) | mantissa4, which only needs a constant offset to become
+ * the G.711 code.
+ */
+#if defined(EASY_G711_SSE2)
+static inline __m128i __ALawEncode8(__m128i x)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i sign = _mm_srai_epi16(x, 15);
+	__m128i ix   = _mm_xor_si128(_mm_srai_epi16(x, 4), sign);		//0..2047
+	__m128i e0   = _mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(_mm_unpacklo_epi16(ix, zero))), 19);
+	__m128i e1   = _mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(_mm_unpackhi_epi16(ix, zero))), 19);
+	__m128i seg  = _mm_sub_epi16(_mm_packs_epi32(e0, e1), _mm_set1_epi16((127 + 3) << 4));
+	__m128i lin  = _mm_cmplt_epi16(ix, _mm_set1_epi16(16));		//segment 0 is linear
+	__m128i code = _mm_or_si128(_mm_and_si128(lin, ix), _mm_andnot_si128(lin, seg));
+	code = _mm_or_si128(code, _mm_andnot_si128(sign, _mm_set1_epi16(0x80)));
+	return _mm_xor_si128(code, _mm_set1_epi16(0x55));
+}
+
+static inline __m128i __ULawEncode8(__m128i x)
+{
+	__m128i zero  = _mm_setzero_si128();
+	__m128i sign  = _mm_srai_epi16(x, 15);
+	__m128i ix    = _mm_xor_si128(_mm_srai_epi16(x, 2), sign);		//0..8191
+	__m128i absno = _mm_min_epi16(_mm_add_epi16(ix, _mm_set1_epi16(33)), _mm_set1_epi16(0x1FFF));
+	__m128i e0    = _mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(_mm_unpacklo_epi16(absno, zero))), 19);
+	__m128i e1    = _mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(_mm_unpackhi_epi16(absno, zero))), 19);
+	__m128i code  = _mm_sub_epi16(_mm_set1_epi16(0xCF + (127 << 4)), _mm_packs_epi32(e0, e1));
+	return _mm_or_si128(code, _mm_andnot_si128(sign, _mm_set1_epi16(0x80)));
+}
+#elif defined(EASY_G711_NEON)
+static inline int16x8_t __FloatBits19(int16x8_t v)
+{
+	uint32x4_t b0 = vshrq_n_u32(vreinterpretq_u32_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)))), 19);
+	uint32x4_t b1 = vshrq_n_u32(vreinterpretq_u32_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)))), 19);
+	return vcombine_s16(vmovn_s32(vreinterpretq_s32_u32(b0)), vmovn_s32(vreinterpretq_s32_u32(b1)));
+}
+
+static inline uint8x8_t __ALawEncode8(int16x8_t x)
+{
+	int16x8_t sign = vshrq_n_s16(x, 15);
+	int16x8_t ix   = veorq_s16(vshrq_n_s16(x, 4), sign);
+	int16x8_t seg  = vsubq_s16(__FloatBits19(ix), vdupq_n_s16((127 + 3) << 4));
+	int16x8_t code = vbslq_s16(vcltq_s16(ix, vdupq_n_s16(16)), ix, seg);
+	code = vorrq_s16(code, vbicq_s16(vdupq_n_s16(0x80), sign));
+	code = veorq_s16(code, vdupq_n_s16(0x55));
+	return vmovn_u16(vreinterpretq_u16_s16(code));
+}
+
+static inline uint8x8_t __ULawEncode8(int16x8_t x)
+{
+	int16x8_t sign  = vshrq_n_s16(x, 15);
+	int16x8_t ix    = veorq_s16(vshrq_n_s16(x, 2), sign);
+	int16x8_t absno = vminq_s16(vaddq_s16(ix, vdupq_n_s16(33)), vdupq_n_s16(0x1FFF));
+	int16x8_t code  = vsubq_s16(vdupq_n_s16(0xCF + (127 << 4)), __FloatBits19(absno));
+	code = vorrq_s16(code, vbicq_s16(vdupq_n_s16(0x80), sign));
+	return vmovn_u16(vreinterpretq_u16_s16(code));
+}
+#endif
+
+int EasyG711::ALawEncode(unsigned char *pOut, const short *pPcm, int samples)
+{
+	if (NULL == pOut || NULL == pPcm || samples < 0)	return -1;
+
+	int i = 0;
+#if defined(EASY_G711_SSE2)
+	for (; i + 16 <= samples; i += 16)
+	{
+		__m128i c0 = __ALawEncode8(_mm_loadu_si128((const __m128i *)(pPcm + i)));
+		__m128i c1 = __ALawEncode8(_mm_loadu_si128((const __m128i *)(pPcm + i + 8)));
+		_mm_storeu_si128((__m128i *)(pOut + i), _mm_packus_epi16(c0, c1));
+	}
+#elif defined(EASY_G711_NEON)
+	for (; i + 8 <= samples; i += 8)
+	{
+		vst1_u8(pOut + i, __ALawEncode8(vld1q_s16(pPcm + i)));
+	}
+#endif
+	for (; i < samples; i++)
+	{
+		pOut[i] = s_ALawEncodeTable[(pPcm[i] >> 4) & 0xFFF];
+	}
+	return samples;
+}
+
+int EasyG711::ULawEncode(unsigned char *pOut, const short *pPcm, int samples)
+{
+	if (NULL == pOut || NULL == pPcm || samples < 0)	return -1;
+
+	int i = 0;
+#if defined(EASY_G711_SSE2)
+	for (; i + 16 <= samples; i += 16)
+	{
+		__m128i c0 = __ULawEncode8(_mm_loadu_si128((const __m128i *)(pPcm + i)));
+		__m128i c1 = __ULawEncode8(_mm_loadu_si128((const __m128i *)(pPcm + i + 8)));
+		_mm_storeu_si128((__m128i *)(pOut + i), _mm_packus_epi16(c0, c1));
+	}
+#elif defined(EASY_G711_NEON)
+	for (; i + 8 <= samples; i += 8)
+	{
+		vst1_u8(pOut + i, __ULawEncode8(vld1q_s16(pPcm + i)));
+	}
+#endif
+	for (; i < samples; i++)
+	{
+		pOut[i] = s_ULawEncodeTable[(pPcm[i] >> 2) & 0x3FFF];
+	}
+	return samples;
+}
+
+int EasyG711::ALawDecode(short *pPcm, const unsigned char *pIn, int bytes)
+{
+	if (NULL == pPcm || NULL == pIn || bytes < 0)	return -1;
+
+	int i = 0;
+	for (; i + 4 <= bytes; i += 4)
+	{
+		pPcm[i]		= s_ALawDecodeTable[pIn[i]];
+		pPcm[i + 1] = s_ALawDecodeTable[pIn[i + 1]];
+		pPcm[i + 2] = s_ALawDecodeTable[pIn[i + 2]];
+		pPcm[i + 3] = s_ALawDecodeTable[pIn[i + 3]];
+	}
+	for (; i < bytes; i++)
+	{
+		pPcm[i] = s_ALawDecodeTable[pIn[i]];
+	}
+	return bytes;
+}
+
+int EasyG711::ULawDecode(short *pPcm, const unsigned char *pIn, int bytes)
+{
+	if (NULL == pPcm || NULL == pIn || bytes < 0)	return -1;
+
+	int i = 0;
+	for (; i + 4 <= bytes; i += 4)
+	{
+		pPcm[i]		= s_ULawDecodeTable[pIn[i]];
+		pPcm[i + 1] = s_ULawDecodeTable[pIn[i + 1]];
+		pPcm[i + 2] = s_ULawDecodeTable[pIn[i + 2]];
+		pPcm[i + 3] = s_ULawDecodeTable[pIn[i + 3]];
+	}
+	for (; i < bytes; i++)
+	{
+		pPcm[i] = s_ULawDecodeTable[pIn[i]];
+	}
+	return bytes;
+}
+
+unsigned char EasyG711::ALawEncodeSample(short pcm)
+{
+	int ix = pcm < 0 ? (~pcm) >> 4 : pcm >> 4;
+	if (ix > 15)
+	{
+		int iexp = 1;
+		while (ix > 16 + 15)
+		{
+			ix >>= 1;
+			iexp++;
+		}
+		ix -= 16;
+		ix += iexp << 4;
+	}
+	if (pcm >= 0)	ix |= 0x80;
+
+	return (unsigned char)(ix ^ 0x55);
+}
+
+short EasyG711::ALawDecodeSample(unsigned char code)
+{
+	int ix = (code ^ 0x55) & 0x7F;
+	int iexp = ix >> 4;
+	int mant = ix & 0x0F;
+	if (iexp > 0)	mant += 16;
+	mant = (mant << 4) + 0x08;
+	if (iexp > 1)	mant <<= (iexp - 1);
+
+	return (short)(code > 127 ? mant : -mant);
+}
+
+unsigned char EasyG711::ULawEncodeSample(short pcm)
+{
+	int absno = pcm < 0 ? ((~pcm) >> 2) + 33 : (pcm >> 2) + 33;
+	if (absno > 0x1FFF)		absno = 0x1FFF;
+
+	int segno = 1;
+	for (int i = absno >> 6; i != 0; i >>= 1)	segno++;
+
+	int high = 8 - segno;
+	int low = 0x0F - ((absno >> segno) & 0x0F);
+	int code = (high << 4) | low;
+	if (pcm >= 0)	code |= 0x80;
+
+	return (unsigned char)code;
+}
+
+short EasyG711::ULawDecodeSample(unsigned char code)
+{
+	int sign = code < 0x80 ? -1 : 1;
+	int mant = ~code & 0xFF;
+	int exponent = (mant >> 4) & 0x07;
+	int step = 4 << (exponent + 1);
+	mant &= 0x0F;
+
+	return (short)(sign * ((0x80 << exponent) + step * mant + step / 2 - 4 * 33));
+}
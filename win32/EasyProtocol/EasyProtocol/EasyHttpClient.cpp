@@ -0,0 +1,790 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyHttpClient.cpp
+*/
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <process.h>
+#pragma comment(lib, "ws2_32.lib")
+
+typedef SOCKET				EASY_SOCKET_T;
+typedef HANDLE				EASY_THREAD_T;
+
+#define	_Http_CloseSocket(x)	closesocket(x)
+#define	_Http_Nonblocking(x, on)	{u_long mode = (on); ioctlsocket((x), FIONBIO, &mode);}
+#define	_Http_InProgress()		(WSAGetLastError() == WSAEWOULDBLOCK)
+#define	MSG_NOSIGNAL			0
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+
+typedef int					EASY_SOCKET_T;
+typedef pthread_t			EASY_THREAD_T;
+
+#define	INVALID_SOCKET			(-1)
+#define	_Http_CloseSocket(x)	close(x)
+#define	_Http_Nonblocking(x, on)	fcntl((x), F_SETFL, (on) ? (fcntl((x), F_GETFL) | O_NONBLOCK) : (fcntl((x), F_GETFL) & ~O_NONBLOCK))
+#define	_Http_InProgress()		(errno == EINPROGRESS)
+#ifndef MSG_NOSIGNAL
+#define	MSG_NOSIGNAL			0
+#endif
+#endif
+
+#include <EasyHttpClient.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define EASY_HTTP_READ_CHUNK							16384
+#define EASY_HTTP_MAX_LINE								65536		//longest status or header line accepted
+
+namespace EasyDarwin { namespace Protocol
+{
+	//the lock guards the idle pool, the job queue and busy_; jobs and idle are
+	//waited on with the lock held, as a condition variable would be
+	typedef struct __HTTP_SYNC_T
+	{
+#ifdef _WIN32
+		CRITICAL_SECTION lock;
+		HANDLE jobs;			//semaphore, one count per queued job or stopping worker
+		HANDLE idle;			//manual reset, set while busy_ == 0
+#else
+		pthread_mutex_t lock;
+		pthread_cond_t jobs;
+		pthread_cond_t idle;
+#endif
+		vector<EASY_THREAD_T> workers;
+	}HTTP_SYNC_T;
+
+	static void SyncInit(HTTP_SYNC_T *sync)
+	{
+#ifdef _WIN32
+		InitializeCriticalSection(&sync->lock);
+		sync->jobs = CreateSemaphore(NULL, 0, 0x7fffffff, NULL);
+		sync->idle = CreateEvent(NULL, TRUE, TRUE, NULL);
+#else
+		pthread_mutex_init(&sync->lock, NULL);
+		pthread_cond_init(&sync->jobs, NULL);
+		pthread_cond_init(&sync->idle, NULL);
+#endif
+	}
+
+	static void SyncDeinit(HTTP_SYNC_T *sync)
+	{
+#ifdef _WIN32
+		CloseHandle(sync->jobs);
+		CloseHandle(sync->idle);
+		DeleteCriticalSection(&sync->lock);
+#else
+		pthread_cond_destroy(&sync->jobs);
+		pthread_cond_destroy(&sync->idle);
+		pthread_mutex_destroy(&sync->lock);
+#endif
+	}
+
+	static void Lock(HTTP_SYNC_T *sync)
+	{
+#ifdef _WIN32
+		EnterCriticalSection(&sync->lock);
+#else
+		pthread_mutex_lock(&sync->lock);
+#endif
+	}
+
+	static void Unlock(HTTP_SYNC_T *sync)
+	{
+#ifdef _WIN32
+		LeaveCriticalSection(&sync->lock);
+#else
+		pthread_mutex_unlock(&sync->lock);
+#endif
+	}
+
+	//lock held on entry and on return
+	static void WaitJob(HTTP_SYNC_T *sync)
+	{
+#ifdef _WIN32
+		LeaveCriticalSection(&sync->lock);
+		WaitForSingleObject(sync->jobs, INFINITE);
+		EnterCriticalSection(&sync->lock);
+#else
+		pthread_cond_wait(&sync->jobs, &sync->lock);
+#endif
+	}
+
+	static void PostJob(HTTP_SYNC_T *sync, int count)
+	{
+#ifdef _WIN32
+		if (count > 0)	ReleaseSemaphore(sync->jobs, count, NULL);
+#else
+		if (count == 1)	pthread_cond_signal(&sync->jobs);
+		else			pthread_cond_broadcast(&sync->jobs);
+#endif
+	}
+
+	static void WaitIdle(HTTP_SYNC_T *sync)
+	{
+#ifdef _WIN32
+		LeaveCriticalSection(&sync->lock);
+		WaitForSingleObject(sync->idle, INFINITE);
+		EnterCriticalSection(&sync->lock);
+#else
+		pthread_cond_wait(&sync->idle, &sync->lock);
+#endif
+	}
+
+	static void SetIdle(HTTP_SYNC_T *sync, bool idle)
+	{
+#ifdef _WIN32
+		if (idle)	SetEvent(sync->idle);
+		else		ResetEvent(sync->idle);
+#else
+		if (idle)	pthread_cond_broadcast(&sync->idle);
+#endif
+	}
+
+	static bool IEquals(const string& a, const char *b)
+	{
+		size_t len = strlen(b);
+		if (a.size() != len)	return false;
+		for (size_t i = 0; i < len; i++)
+		{
+			if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))	return false;
+		}
+		return true;
+	}
+
+	static bool IContains(const string& a, const char *b)
+	{
+		string lower(a);
+		for (size_t i = 0; i < lower.size(); i++)	lower[i] = (char)tolower((unsigned char)lower[i]);
+		return lower.find(b) != string::npos;
+	}
+
+	static void Trim(string& s)
+	{
+		size_t begin = s.find_first_not_of(" \t");
+		size_t end = s.find_last_not_of(" \t");
+		if (begin == string::npos)	s.clear();
+		else						s = s.substr(begin, end - begin + 1);
+	}
+
+	static void SetTimeout(EASY_SOCKET_T fd, int timeoutMs)
+	{
+#ifdef _WIN32
+		DWORD tv = timeoutMs;
+#else
+		struct timeval tv;
+		tv.tv_sec = timeoutMs / 1000;
+		tv.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+		setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (const char *)&tv, sizeof(tv));
+		setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, (const char *)&tv, sizeof(tv));
+	}
+
+	//non-blocking connect bounded by timeoutMs
+	static bool ConnectTimeout(EASY_SOCKET_T fd, const struct sockaddr *addr, int len, int timeoutMs)
+	{
+		_Http_Nonblocking(fd, 1);
+		if (connect(fd, addr, len) != 0)
+		{
+			if (!_Http_InProgress())	return false;
+
+			fd_set writable;
+			FD_ZERO(&writable);
+			FD_SET(fd, &writable);
+			struct timeval tv;
+			tv.tv_sec = timeoutMs / 1000;
+			tv.tv_usec = (timeoutMs % 1000) * 1000;
+			if (select((int)fd + 1, NULL, &writable, NULL, &tv) <= 0)	return false;
+
+			int error = 0;
+			socklen_t size = sizeof(error);
+			if (getsockopt(fd, SOL_SOCKET, SO_ERROR, (char *)&error, &size) != 0 || error != 0)	return false;
+		}
+		_Http_Nonblocking(fd, 0);
+		return true;
+	}
+
+	EasyHttpClient::EasyHttpClient(const string& host, unsigned short port, int connections, int timeoutMs)
+		: host_(host)
+		, port_(port)
+		, connections_(connections > 0 ? connections : 1)
+		, timeoutMs_(timeoutMs)
+		, connects_(0)
+		, busy_(0)
+		, stopping_(false)
+	{
+#ifdef _WIN32
+		WSADATA data;
+		WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+		HTTP_SYNC_T *sync = new HTTP_SYNC_T;
+		SyncInit(sync);
+		sync_ = sync;
+	}
+
+	EasyHttpClient::~EasyHttpClient()
+	{
+		HTTP_SYNC_T *sync = (HTTP_SYNC_T *)sync_;
+
+		Lock(sync);
+		stopping_ = true;
+		list<HTTP_JOB_T> cancelled;
+		cancelled.swap(jobs_);
+		Unlock(sync);
+
+		PostJob(sync, (int)sync->workers.size());
+		for (size_t i = 0; i < sync->workers.size(); i++)
+		{
+#ifdef _WIN32
+			WaitForSingleObject(sync->workers[i], INFINITE);
+			CloseHandle(sync->workers[i]);
+#else
+			pthread_join(sync->workers[i], NULL);
+#endif
+		}
+
+		EASY_HTTP_RESPONSE_T response;
+		response.status = EASY_HTTP_ERROR_CANCELLED;
+		for (list<HTTP_JOB_T>::iterator it = cancelled.begin(); it != cancelled.end(); ++it)
+		{
+			if (it->handler)	it->handler->OnHttpResponse(it->path, it->context, response);
+		}
+
+		CloseIdle();
+
+		SyncDeinit(sync);
+		delete sync;
+#ifdef _WIN32
+		WSACleanup();
+#endif
+	}
+
+	bool EasyHttpClient::SplitURL(const string& url, string& host, unsigned short& port, string& path)
+	{
+		size_t begin = 0;
+		if (url.compare(0, 7, "http://") == 0)	begin = 7;
+
+		size_t slash = url.find('/', begin);
+		string authority = url.substr(begin, slash == string::npos ? string::npos : slash - begin);
+		path = slash == string::npos ? "/" : url.substr(slash);
+
+		size_t colon = authority.find(':');
+		port = 80;
+		if (colon != string::npos)
+		{
+			int value = atoi(authority.c_str() + colon + 1);
+			if (value <= 0 || value > 65535)	return false;
+			port = (unsigned short)value;
+			authority.erase(colon);
+		}
+		host = authority;
+		return !host.empty();
+	}
+
+	EasyHttpClient::HTTP_CONNECTION_T* EasyHttpClient::Connect()
+	{
+		char service[8];
+		sprintf(service, "%u", (unsigned)port_);
+
+		struct addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		struct addrinfo *result = NULL;
+		if (getaddrinfo(host_.c_str(), service, &hints, &result) != 0)	return NULL;
+
+		EASY_SOCKET_T fd = INVALID_SOCKET;
+		for (struct addrinfo *ai = result; ai != NULL; ai = ai->ai_next)
+		{
+			fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+			if (fd == INVALID_SOCKET)	continue;
+			if (ConnectTimeout(fd, ai->ai_addr, (int)ai->ai_addrlen, timeoutMs_))	break;
+			_Http_CloseSocket(fd);
+			fd = INVALID_SOCKET;
+		}
+		freeaddrinfo(result);
+		if (fd == INVALID_SOCKET)	return NULL;
+
+		//requests are small and written whole, Nagle would only hold back a pipelined batch
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char *)&on, sizeof(on));
+		SetTimeout(fd, timeoutMs_);
+
+		HTTP_CONNECTION_T *conn = new HTTP_CONNECTION_T;
+		conn->fd = (long long)fd;
+		conn->inPos = 0;
+		conn->reused = false;
+		conn->received = 0;
+
+		HTTP_SYNC_T *sync = (HTTP_SYNC_T *)sync_;
+		Lock(sync);
+		connects_++;
+		Unlock(sync);
+		return conn;
+	}
+
+	EasyHttpClient::HTTP_CONNECTION_T* EasyHttpClient::Acquire()
+	{
+		HTTP_SYNC_T *sync = (HTTP_SYNC_T *)sync_;
+		HTTP_CONNECTION_T *conn = NULL;
+		Lock(sync);
+		if (!idle_.empty())
+		{
+			conn = idle_.back();
+			idle_.pop_back();
+		}
+		Unlock(sync);
+
+		return conn ? conn : Connect();
+	}
+
+	void EasyHttpClient::Release(HTTP_CONNECTION_T *conn, bool keepAlive)
+	{
+		//bytes beyond the last response would be taken for the next one
+		if (!keepAlive || conn->inPos != conn->in.size())
+		{
+			Close(conn);
+			return;
+		}
+
+		conn->reused = true;
+		conn->in.clear();
+		conn->inPos = 0;
+
+		HTTP_SYNC_T *sync = (HTTP_SYNC_T *)sync_;
+		Lock(sync);
+		bool kept = idle_.size() < (size_t)connections_;
+		if (kept)	idle_.push_back(conn);
+		Unlock(sync);
+
+		if (!kept)	Close(conn);
+	}
+
+	void EasyHttpClient::Close(HTTP_CONNECTION_T *conn)
+	{
+		_Http_CloseSocket((EASY_SOCKET_T)conn->fd);
+		delete conn;
+	}
+
+	void EasyHttpClient::CloseIdle()
+	{
+		HTTP_SYNC_T *sync = (HTTP_SYNC_T *)sync_;
+		vector<HTTP_CONNECTION_T*> idle;
+		Lock(sync);
+		idle.swap(idle_);
+		Unlock(sync);
+
+		for (size_t i = 0; i < idle.size(); i++)	Close(idle[i]);
+	}
+
+	string EasyHttpClient::Request(const string& path)
+	{
+		char port[8];
+		sprintf(port, ":%u", (unsigned)port_);
+
+		string req;
+		req.reserve(path.size() + host_.size() + 64);
+		req += "GET ";
+		req += path;
+		req += " HTTP/1.1\r\nHost: ";
+		req += host_;
+		if (port_ != 80)	req += port;
+		req += "\r\nConnection: Keep-Alive\r\n\r\n";
+		return req;
+	}
+
+	bool EasyHttpClient::Send(HTTP_CONNECTION_T *conn, const string& data)
+	{
+		size_t sent = 0;
+		while (sent < data.size())
+		{
+			int n = send((EASY_SOCKET_T)conn->fd, data.data() + sent, (int)(data.size() - sent), MSG_NOSIGNAL);
+			if (n <= 0)	return false;
+			sent += n;
+		}
+		return true;
+	}
+
+	bool EasyHttpClient::Fill(HTTP_CONNECTION_T *conn)
+	{
+		if (conn->inPos == conn->in.size())
+		{
+			conn->in.clear();
+			conn->inPos = 0;
+		}
+		else if (conn->inPos > EASY_HTTP_READ_CHUNK)
+		{
+			conn->in.erase(0, conn->inPos);
+			conn->inPos = 0;
+		}
+
+		size_t size = conn->in.size();
+		conn->in.resize(size + EASY_HTTP_READ_CHUNK);
+		int n = recv((EASY_SOCKET_T)conn->fd, &conn->in[size], EASY_HTTP_READ_CHUNK, 0);
+		conn->in.resize(size + (n > 0 ? n : 0));
+		if (n <= 0)	return false;
+
+		conn->received += n;
+		return true;
+	}
+
+	bool EasyHttpClient::ReadLine(HTTP_CONNECTION_T *conn, string& line)
+	{
+		size_t from = conn->inPos;
+		for (;;)
+		{
+			size_t end = conn->in.find("\r\n", from);
+			if (end != string::npos)
+			{
+				line.assign(conn->in, conn->inPos, end - conn->inPos);
+				conn->inPos = end + 2;
+				return true;
+			}
+			if (conn->in.size() - conn->inPos > EASY_HTTP_MAX_LINE)	return false;
+
+			//Fill may move the unread bytes to the front
+			from = conn->in.size() - conn->inPos;
+			if (from > 0)	from--;
+			if (!Fill(conn))	return false;
+			from += conn->inPos;
+		}
+	}
+
+	bool EasyHttpClient::ReadBody(HTTP_CONNECTION_T *conn, size_t length, string& body, EasyHttpSink *sink)
+	{
+		size_t buffered = conn->in.size() - conn->inPos;
+		size_t take = buffered < length ? buffered : length;
+		if (sink)
+		{
+			if (take > 0 && !sink->OnHttpBody(conn->in.data() + conn->inPos, take))	return false;
+		}
+		else
+		{
+			body.append(conn->in, conn->inPos, take);
+		}
+		conn->inPos += take;
+
+		if (sink)
+		{
+			char chunk[EASY_HTTP_READ_CHUNK];
+			size_t left = length - take;
+			while (left > 0)
+			{
+				int n = recv((EASY_SOCKET_T)conn->fd, chunk, (int)(left < sizeof(chunk) ? left : sizeof(chunk)), 0);
+				if (n <= 0 || !sink->OnHttpBody(chunk, n))	return false;
+				conn->received += n;
+				left -= n;
+			}
+			return true;
+		}
+
+		//the rest goes straight into the body
+		size_t at = body.size();
+		size_t end = at + (length - take);
+		body.resize(end);
+		while (at < end)
+		{
+			size_t want = end - at;
+			int n = recv((EASY_SOCKET_T)conn->fd, &body[at], (int)(want < 0x100000 ? want : 0x100000), 0);
+			if (n <= 0)
+			{
+				body.resize(at);
+				return false;
+			}
+			conn->received += n;
+			at += n;
+		}
+		return true;
+	}
+
+	bool EasyHttpClient::Receive(HTTP_CONNECTION_T *conn, EASY_HTTP_RESPONSE_T& response, bool& keepAlive, EasyHttpSink *sink)
+	{
+		response.body.clear();
+		string line;
+		bool http11;
+		for (;;)
+		{
+			if (!ReadLine(conn, line))
+			{
+				response.status = EASY_HTTP_ERROR_RECV;
+				return false;
+			}
+			if (line.compare(0, 7, "HTTP/1.") != 0 || line.size() < 12)
+			{
+				response.status = EASY_HTTP_ERROR_RESPONSE;
+				return false;
+			}
+			http11 = line[7] != '0';
+			response.status = atoi(line.c_str() + 9);
+
+			keepAlive = http11;
+			bool chunked = false;
+			bool haveLength = false;
+			size_t length = 0;
+			for (;;)
+			{
+				if (!ReadLine(conn, line))
+				{
+					response.status = EASY_HTTP_ERROR_RECV;
+					return false;
+				}
+				if (line.empty())	break;
+
+				size_t colon = line.find(':');
+				if (colon == string::npos)	continue;
+				string name = line.substr(0, colon);
+				string value = line.substr(colon + 1);
+				Trim(name);
+				Trim(value);
+				if (IEquals(name, "Content-Length"))
+				{
+					haveLength = true;
+					length = (size_t)strtoul(value.c_str(), NULL, 10);
+				}
+				else if (IEquals(name, "Transfer-Encoding"))	chunked = IContains(value, "chunked");
+				else if (IEquals(name, "Connection"))
+				{
+					if (IContains(value, "close"))				keepAlive = false;
+					else if (IContains(value, "keep-alive"))	keepAlive = true;
+				}
+			}
+
+			//100 Continue and the like come before the real response
+			if (response.status >= 100 && response.status < 200)	continue;
+			if (response.status == 204 || response.status == 304)	return true;
+			//error pages stay in response.body
+			EasyHttpSink *out = response.status >= 200 && response.status < 300 ? sink : NULL;
+
+			if (chunked)
+			{
+				for (;;)
+				{
+					if (!ReadLine(conn, line))
+					{
+						response.status = EASY_HTTP_ERROR_RECV;
+						return false;
+					}
+					size_t size = (size_t)strtoul(line.c_str(), NULL, 16);
+					if (size == 0)	break;
+					if (!ReadBody(conn, size, response.body, out) || !ReadLine(conn, line))
+					{
+						response.status = EASY_HTTP_ERROR_RECV;
+						return false;
+					}
+				}
+				//trailers
+				do
+				{
+					if (!ReadLine(conn, line))
+					{
+						response.status = EASY_HTTP_ERROR_RECV;
+						return false;
+					}
+				} while (!line.empty());
+				return true;
+			}
+
+			if (haveLength)
+			{
+				if (NULL == out)	response.body.reserve(length);
+				if (!ReadBody(conn, length, response.body, out))
+				{
+					response.status = EASY_HTTP_ERROR_RECV;
+					return false;
+				}
+				return true;
+			}
+
+			//no framing, the body ends with the connection
+			keepAlive = false;
+			for (;;)
+			{
+				if (!ReadBody(conn, conn->in.size() - conn->inPos, response.body, out))
+				{
+					response.status = EASY_HTTP_ERROR_RECV;
+					return false;
+				}
+				if (!Fill(conn))	break;
+			}
+			return true;
+		}
+	}
+
+	void EasyHttpClient::Exchange(const string *paths, size_t count, EASY_HTTP_RESPONSE_T *responses, EasyHttpSink *sink)
+	{
+		size_t done = 0;
+		bool fresh = false;
+		while (done < count)
+		{
+			HTTP_CONNECTION_T *conn = fresh ? Connect() : Acquire();
+			if (NULL == conn)
+			{
+				for (; done < count; done++)	responses[done].status = EASY_HTTP_ERROR_CONNECT;
+				return;
+			}
+
+			string data;
+			for (size_t i = done; i < count; i++)	data += Request(paths[i]);
+
+			size_t first = done;
+			bool reused = conn->reused;
+			bool keepAlive = true;
+			bool silent = false;		//the failing response got no bytes at all
+			int error = 0;
+			if (!Send(conn, data))
+			{
+				error = EASY_HTTP_ERROR_SEND;
+				silent = true;
+			}
+			while (0 == error && done < count && keepAlive)
+			{
+				unsigned long long received = conn->received;
+				size_t buffered = conn->in.size() - conn->inPos;
+				if (!Receive(conn, responses[done], keepAlive, sink))
+				{
+					error = responses[done].status;
+					silent = buffered == 0 && received == conn->received;
+					break;
+				}
+				done++;
+			}
+
+			if (0 == error)
+			{
+				//the server may close after any response; the rest go on a new connection
+				Release(conn, keepAlive);
+				continue;
+			}
+
+			Close(conn);
+			//an idle keep-alive the server dropped, or a server that closed a pipeline partway:
+			//nothing of this response came back, so a GET can simply be repeated
+			if (silent && (done > first || reused))
+			{
+				//the other idle connections are as old as this one
+				if (reused)	CloseIdle();
+				fresh = true;
+				continue;
+			}
+			for (; done < count; done++)	responses[done].status = error;
+		}
+	}
+
+	int EasyHttpClient::Get(const string& path, EASY_HTTP_RESPONSE_T& response, EasyHttpSink *sink)
+	{
+		Exchange(&path, 1, &response, sink);
+		return response.status;
+	}
+
+	int EasyHttpClient::Pipeline(const vector<string>& paths, vector<EASY_HTTP_RESPONSE_T>& responses)
+	{
+		responses.resize(paths.size());
+		if (paths.empty())	return 0;
+
+		Exchange(&paths[0], paths.size(), &responses[0], NULL);
+		int ok = 0;
+		for (size_t i = 0; i < responses.size(); i++)
+		{
+			if (responses[i].status > 0)	ok++;
+		}
+		return ok;
+	}
+
+	void EasyHttpClient::StartWorkers()
+	{
+		HTTP_SYNC_T *sync = (HTTP_SYNC_T *)sync_;
+		for (int i = 0; i < connections_; i++)
+		{
+#ifdef _WIN32
+			HANDLE thread = (HANDLE)_beginthreadex(NULL, 0, Worker, this, 0, NULL);
+			if (thread)	sync->workers.push_back(thread);
+#else
+			pthread_t thread;
+			if (pthread_create(&thread, NULL, Worker, this) == 0)	sync->workers.push_back(thread);
+#endif
+		}
+	}
+
+#ifdef _WIN32
+	unsigned int __stdcall EasyHttpClient::Worker(void *param)
+	{
+		((EasyHttpClient *)param)->RunJobs();
+		return 0;
+	}
+#else
+	void* EasyHttpClient::Worker(void *param)
+	{
+		((EasyHttpClient *)param)->RunJobs();
+		return NULL;
+	}
+#endif
+
+	void EasyHttpClient::RunJobs()
+	{
+		HTTP_SYNC_T *sync = (HTTP_SYNC_T *)sync_;
+		EASY_HTTP_RESPONSE_T response;
+		Lock(sync);
+		for (;;)
+		{
+			while (jobs_.empty() && !stopping_)	WaitJob(sync);
+			if (stopping_)	break;
+
+			HTTP_JOB_T job = jobs_.front();
+			jobs_.pop_front();
+			Unlock(sync);
+
+			Get(job.path, response, job.sink);
+			if (job.handler)	job.handler->OnHttpResponse(job.path, job.context, response);
+
+			Lock(sync);
+			if (--busy_ == 0)	SetIdle(sync, true);
+		}
+		Unlock(sync);
+	}
+
+	void EasyHttpClient::GetAsync(const string& path, EasyHttpHandler *handler, void *context, EasyHttpSink *sink)
+	{
+		HTTP_SYNC_T *sync = (HTTP_SYNC_T *)sync_;
+		HTTP_JOB_T job;
+		job.path = path;
+		job.handler = handler;
+		job.context = context;
+		job.sink = sink;
+
+		Lock(sync);
+		if (sync->workers.empty())	StartWorkers();
+		jobs_.push_back(job);
+		if (busy_++ == 0)	SetIdle(sync, false);
+		Unlock(sync);
+
+		PostJob(sync, 1);
+	}
+
+	void EasyHttpClient::Wait()
+	{
+		HTTP_SYNC_T *sync = (HTTP_SYNC_T *)sync_;
+		Lock(sync);
+		while (busy_ > 0)	WaitIdle(sync);
+		Unlock(sync);
+	}
+}}//namespace
@@ -0,0 +1,116 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyJsonPool.cpp
+*/
+
+#include <EasyJsonPool.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef CRITICAL_SECTION	EASY_POOL_LOCK_T;
+
+#define	_Pool_InitLock(x)		InitializeCriticalSection(x)
+#define	_Pool_DeinitLock(x)		DeleteCriticalSection(x)
+#define	_Pool_Lock(x)			EnterCriticalSection(x)
+#define	_Pool_Unlock(x)			LeaveCriticalSection(x)
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t		EASY_POOL_LOCK_T;
+
+#define	_Pool_InitLock(x)		pthread_mutex_init(x, NULL)
+#define	_Pool_DeinitLock(x)		pthread_mutex_destroy(x)
+#define	_Pool_Lock(x)			pthread_mutex_lock(x)
+#define	_Pool_Unlock(x)			pthread_mutex_unlock(x)
+#endif
+
+namespace EasyDarwin { namespace Protocol
+{
+	template <typename T>
+	class JsonObjectPool
+	{
+	public:
+		JsonObjectPool() : count_(0)
+		{
+			_Pool_InitLock(&lock_);
+		}
+
+		~JsonObjectPool()
+		{
+			Clear();
+			_Pool_DeinitLock(&lock_);
+		}
+
+		T* Get()
+		{
+			T *obj = NULL;
+			_Pool_Lock(&lock_);
+			if (count_ > 0)	obj = idle_[--count_];
+			_Pool_Unlock(&lock_);
+
+			return obj ? obj : new T();
+		}
+
+		void Put(T *obj)
+		{
+			if (NULL == obj)	return;
+
+			_Pool_Lock(&lock_);
+			if (count_ < EASY_JSON_POOL_SIZE)
+			{
+				idle_[count_++] = obj;
+				obj = NULL;
+			}
+			_Pool_Unlock(&lock_);
+
+			delete obj;
+		}
+
+		void Clear()
+		{
+			_Pool_Lock(&lock_);
+			while (count_ > 0)	delete idle_[--count_];
+			_Pool_Unlock(&lock_);
+		}
+
+	private:
+		EASY_POOL_LOCK_T lock_;
+		T *idle_[EASY_JSON_POOL_SIZE];
+		int count_;
+	};
+
+	static JsonObjectPool<Json::Reader> readerPool;
+	static JsonObjectPool<EasyJsonWriter> writerPool;
+
+	Json::Reader* EasyJsonPool::GetReader()
+	{
+		return readerPool.Get();
+	}
+
+	void EasyJsonPool::PutReader(Json::Reader *reader)
+	{
+		readerPool.Put(reader);
+	}
+
+	EasyJsonWriter* EasyJsonPool::GetWriter()
+	{
+		return writerPool.Get();
+	}
+
+	void EasyJsonPool::PutWriter(EasyJsonWriter *writer)
+	{
+		writerPool.Put(writer);
+	}
+
+	void EasyJsonPool::Clear()
+	{
+		readerPool.Clear();
+		writerPool.Clear();
+	}
+}}//namespace
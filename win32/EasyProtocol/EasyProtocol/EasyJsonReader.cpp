@@ -0,0 +1,271 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyJsonReader.cpp
+*/
+
+#include <EasyJsonReader.h>
+#include <string.h>
+
+namespace EasyDarwin { namespace Protocol
+{
+	class JsonInsituParser
+	{
+	public:
+		JsonInsituParser(char *buf, size_t len, EasyJsonHandler &handler)
+			: p_(buf)
+			, end_(buf + len)
+			, handler_(handler)
+			, depth_(0)
+		{
+		}
+
+		bool Parse()
+		{
+			SkipSpace();
+			if (!ParseValue())	return false;
+			SkipSpace();
+			return p_ == end_ || *p_ == '\0';
+		}
+
+	private:
+		void SkipSpace()
+		{
+			while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t'))	p_++;
+		}
+
+		static int Hex(char c)
+		{
+			if (c >= '0' && c <= '9')	return c - '0';
+			if (c >= 'a' && c <= 'f')	return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F')	return c - 'A' + 10;
+			return -1;
+		}
+
+		bool ReadHex4(const char *s, unsigned int *value)
+		{
+			if (end_ - s < 4)	return false;
+
+			unsigned int v = 0;
+			for (int i = 0; i < 4; i++)
+			{
+				int h = Hex(s[i]);
+				if (h < 0)	return false;
+				v = (v << 4) | h;
+			}
+			*value = v;
+			return true;
+		}
+
+		//p_ is on the opening quote; the unescaped text never grows, so it is written over the input
+		bool ParseString(char **str, size_t *len)
+		{
+			char *src = ++p_;
+			while (src < end_ && *src != '"' && *src != '\\' && (unsigned char)*src >= 0x20)	src++;
+
+			char *dst = src;
+			while (src < end_ && *src != '"')
+			{
+				if ((unsigned char)*src < 0x20)	return false;
+				if (*src != '\\')
+				{
+					*dst++ = *src++;
+					continue;
+				}
+
+				if (++src >= end_)	return false;
+				switch (*src++)
+				{
+				case '"':	*dst++ = '"';	break;
+				case '\\':	*dst++ = '\\';	break;
+				case '/':	*dst++ = '/';	break;
+				case 'b':	*dst++ = '\b';	break;
+				case 'f':	*dst++ = '\f';	break;
+				case 'n':	*dst++ = '\n';	break;
+				case 'r':	*dst++ = '\r';	break;
+				case 't':	*dst++ = '\t';	break;
+				case 'u':
+					{
+						unsigned int cp;
+						if (!ReadHex4(src, &cp))	return false;
+						src += 4;
+						if (cp >= 0xD800 && cp <= 0xDBFF)
+						{
+							unsigned int low;
+							if (end_ - src < 6 || src[0] != '\\' || src[1] != 'u' || !ReadHex4(src + 2, &low) || low < 0xDC00 || low > 0xDFFF)	return false;
+							src += 6;
+							cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+						}
+
+						if (cp < 0x80)
+						{
+							*dst++ = (char)cp;
+						}
+						else if (cp < 0x800)
+						{
+							*dst++ = (char)(0xC0 | (cp >> 6));
+							*dst++ = (char)(0x80 | (cp & 0x3F));
+						}
+						else if (cp < 0x10000)
+						{
+							*dst++ = (char)(0xE0 | (cp >> 12));
+							*dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+							*dst++ = (char)(0x80 | (cp & 0x3F));
+						}
+						else
+						{
+							*dst++ = (char)(0xF0 | (cp >> 18));
+							*dst++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+							*dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+							*dst++ = (char)(0x80 | (cp & 0x3F));
+						}
+					}
+					break;
+				default:
+					return false;
+				}
+			}
+			if (src >= end_)	return false;
+
+			*str = p_;
+			*len = dst - p_;
+			p_ = src + 1;
+			return true;
+		}
+
+		bool ParseScalar()
+		{
+			char *start = p_;
+			while (p_ < end_ && *p_ != ',' && *p_ != '}' && *p_ != ']' && *p_ != ' ' && *p_ != '\n' && *p_ != '\r' && *p_ != '\t')	p_++;
+
+			size_t len = p_ - start;
+			if (len == 0)	return false;
+
+			if (start[0] == '-' || (start[0] >= '0' && start[0] <= '9'))
+			{
+				for (size_t i = 1; i < len; i++)
+				{
+					char c = start[i];
+					if (!((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-'))	return false;
+				}
+			}
+			else if (!((len == 4 && memcmp(start, "true", 4) == 0) || (len == 5 && memcmp(start, "false", 5) == 0) ||
+				(len == 4 && memcmp(start, "null", 4) == 0)))
+			{
+				return false;
+			}
+
+			return handler_.Scalar(start, len);
+		}
+
+		bool ParseObject()
+		{
+			p_++;
+			if (!handler_.StartObject())	return false;
+
+			SkipSpace();
+			if (p_ < end_ && *p_ == '}')
+			{
+				p_++;
+				return handler_.EndObject();
+			}
+
+			for (;;)
+			{
+				if (p_ >= end_ || *p_ != '"')	return false;
+
+				char *key;
+				size_t len;
+				if (!ParseString(&key, &len) || !handler_.Key(key, len))	return false;
+
+				SkipSpace();
+				if (p_ >= end_ || *p_ != ':')	return false;
+				p_++;
+				SkipSpace();
+				if (!ParseValue())	return false;
+
+				SkipSpace();
+				if (p_ >= end_)	return false;
+				if (*p_ == '}')
+				{
+					p_++;
+					return handler_.EndObject();
+				}
+				if (*p_ != ',')	return false;
+				p_++;
+				SkipSpace();
+			}
+		}
+
+		bool ParseArray()
+		{
+			p_++;
+			if (!handler_.StartArray())	return false;
+
+			SkipSpace();
+			if (p_ < end_ && *p_ == ']')
+			{
+				p_++;
+				return handler_.EndArray();
+			}
+
+			for (;;)
+			{
+				if (!ParseValue())	return false;
+
+				SkipSpace();
+				if (p_ >= end_)	return false;
+				if (*p_ == ']')
+				{
+					p_++;
+					return handler_.EndArray();
+				}
+				if (*p_ != ',')	return false;
+				p_++;
+				SkipSpace();
+			}
+		}
+
+		bool ParseValue()
+		{
+			if (p_ >= end_)	return false;
+
+			switch (*p_)
+			{
+			case '{':
+			case '[':
+				{
+					if (++depth_ > EASY_JSON_MAX_DEPTH)	return false;
+					bool ret = (*p_ == '{') ? ParseObject() : ParseArray();
+					depth_--;
+					return ret;
+				}
+			case '"':
+				{
+					char *str;
+					size_t len;
+					return ParseString(&str, &len) && handler_.String(str, len);
+				}
+			default:
+				return ParseScalar();
+			}
+		}
+
+		char *p_;
+		char *end_;
+		EasyJsonHandler &handler_;
+		int depth_;
+	};
+
+	bool EasyJsonReader::ParseInsitu(char *buf, size_t len, EasyJsonHandler &handler)
+	{
+		if (NULL == buf)	return false;
+
+		JsonInsituParser parser(buf, len, handler);
+		return parser.Parse();
+	}
+}}//namespace
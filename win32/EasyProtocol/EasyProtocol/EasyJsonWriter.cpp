@@ -0,0 +1,388 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyJsonWriter.cpp
+*/
+
+#include <EasyJsonWriter.h>
+#include <stdio.h>
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define snprintf _snprintf
+#endif
+
+namespace EasyDarwin { namespace Protocol
+{
+	static const char digitPairs[201] =
+		"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+		"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	static const char hexDigits[] = "0123456789ABCDEF";
+
+	//output into either the writer's growable buffer or a fixed caller buffer
+	class JsonOut
+	{
+	public:
+		JsonOut(std::vector<char> *grow)
+			: grow_(grow)
+			, buf_(grow->empty() ? NULL : &(*grow)[0])
+			, len_(0)
+			, cap_(grow->size())
+			, overflow_(false)
+		{
+		}
+
+		JsonOut(char *dest, size_t size)
+			: grow_(NULL)
+			, buf_(dest)
+			, len_(0)
+			, cap_(size)
+			, overflow_(false)
+		{
+		}
+
+		//room for n more bytes, false once a fixed buffer is full
+		bool Reserve(size_t n)
+		{
+			if (len_ + n <= cap_)	return true;
+			if (NULL == grow_)
+			{
+				overflow_ = true;
+				return false;
+			}
+
+			size_t cap = cap_ < 256 ? 256 : cap_ * 2;
+			while (cap < len_ + n)	cap *= 2;
+			grow_->resize(cap);
+			buf_ = &(*grow_)[0];
+			cap_ = cap;
+			return true;
+		}
+
+		void Put(char c)
+		{
+			if (Reserve(1))	buf_[len_++] = c;
+		}
+
+		void Put(const char *str, size_t n)
+		{
+			if (!Reserve(n))	return;
+			memcpy(buf_ + len_, str, n);
+			len_ += n;
+		}
+
+		void PutQuoted(const char *str, size_t n)
+		{
+			//worst case every byte becomes \u00XX; a fixed buffer too small for that goes byte by byte
+			if (NULL == grow_ && len_ + n * 6 + 2 > cap_)
+			{
+				PutQuotedSlow(str, n);
+				return;
+			}
+			Reserve(n * 6 + 2);
+
+			char *p = buf_ + len_;
+			*p++ = '"';
+			for (const char *end = str + n; str < end; str++)
+			{
+				unsigned char c = (unsigned char)*str;
+				if (c >= 0x20 && c != '"' && c != '\\')
+				{
+					*p++ = (char)c;
+					continue;
+				}
+
+				*p++ = '\\';
+				switch (c)
+				{
+				case '"':	*p++ = '"';		break;
+				case '\\':	*p++ = '\\';	break;
+				case '\b':	*p++ = 'b';		break;
+				case '\f':	*p++ = 'f';		break;
+				case '\n':	*p++ = 'n';		break;
+				case '\r':	*p++ = 'r';		break;
+				case '\t':	*p++ = 't';		break;
+				default:
+					*p++ = 'u';
+					*p++ = '0';
+					*p++ = '0';
+					*p++ = hexDigits[c >> 4];
+					*p++ = hexDigits[c & 0x0F];
+					break;
+				}
+			}
+			*p++ = '"';
+			len_ = p - buf_;
+		}
+
+		void PutQuotedSlow(const char *str, size_t n)
+		{
+			char esc[6] = {'\\', 'u', '0', '0'};
+
+			Put('"');
+			for (const char *end = str + n; str < end; str++)
+			{
+				unsigned char c = (unsigned char)*str;
+				if (c >= 0x20 && c != '"' && c != '\\')
+				{
+					Put((char)c);
+					continue;
+				}
+
+				switch (c)
+				{
+				case '"':	Put("\\\"", 2);	break;
+				case '\\':	Put("\\\\", 2);	break;
+				case '\b':	Put("\\b", 2);	break;
+				case '\f':	Put("\\f", 2);	break;
+				case '\n':	Put("\\n", 2);	break;
+				case '\r':	Put("\\r", 2);	break;
+				case '\t':	Put("\\t", 2);	break;
+				default:
+					esc[4] = hexDigits[c >> 4];
+					esc[5] = hexDigits[c & 0x0F];
+					Put(esc, 6);
+					break;
+				}
+			}
+			Put('"');
+		}
+
+		void PutValue(const Json::Value& value)
+		{
+			char num[32];
+			switch (value.type())
+			{
+			case Json::nullValue:
+				Put("null", 4);
+				break;
+			case Json::intValue:
+				Put(num, EasyJsonWriter::FormatInt(num, value.asLargestInt()));
+				break;
+			case Json::uintValue:
+				Put(num, EasyJsonWriter::FormatUInt(num, value.asLargestUInt()));
+				break;
+			case Json::realValue:
+				Put(num, EasyJsonWriter::FormatDouble(num, value.asDouble()));
+				break;
+			case Json::stringValue:
+				{
+					const char *str;
+					const char *end;
+					if (value.getString(&str, &end))	PutQuoted(str, end - str);
+				}
+				break;
+			case Json::booleanValue:
+				if (value.asBool())	Put("true", 4);
+				else				Put("false", 5);
+				break;
+			case Json::arrayValue:
+				{
+					//FastWriter writes null for the holes of a sparse array
+					Put('[');
+					Json::ArrayIndex next = 0;
+					for (Json::Value::const_iterator it = value.begin(); it != value.end(); ++it)
+					{
+						for (; next < it.index(); next++)
+						{
+							if (next > 0)	Put(',');
+							Put("null", 4);
+						}
+						if (next > 0)	Put(',');
+						PutValue(*it);
+						next++;
+					}
+					Put(']');
+				}
+				break;
+			case Json::objectValue:
+				{
+					Put('{');
+					bool first = true;
+					for (Json::Value::const_iterator it = value.begin(); it != value.end(); ++it)
+					{
+						if (!first)	Put(',');
+						first = false;
+
+						const char *end;
+						const char *name = it.memberName(&end);
+						PutQuoted(name, name ? end - name : 0);
+						Put(':');
+						PutValue(*it);
+					}
+					Put('}');
+				}
+				break;
+			}
+		}
+
+		size_t Length() const	{ return len_; }
+		bool Overflow() const	{ return overflow_; }
+
+	private:
+		std::vector<char> *grow_;
+		char *buf_;
+		size_t len_;
+		size_t cap_;
+		bool overflow_;
+	};
+
+	EasyJsonWriter::EasyJsonWriter()
+	{
+	}
+
+	const char* EasyJsonWriter::Write(const Json::Value& root, size_t *len)
+	{
+		JsonOut out(&buffer_);
+		out.PutValue(root);
+		out.Put('\n');
+		out.Put('\0');
+
+		if (len)	*len = out.Length() - 1;
+		return &buffer_[0];
+	}
+
+	std::string EasyJsonWriter::Write(const Json::Value& root)
+	{
+		size_t len;
+		const char *msg = Write(root, &len);
+		return std::string(msg, len);
+	}
+
+	int EasyJsonWriter::Write(const Json::Value& root, char *dest, int size)
+	{
+		if (NULL == dest || size < 0)	return -1;
+
+		JsonOut out(dest, size);
+		out.PutValue(root);
+		out.Put('\n');
+		if (out.Overflow())	return -1;
+
+		int len = (int)out.Length();
+		if (len < size)	dest[len] = '\0';
+		return len;
+	}
+
+	int EasyJsonWriter::FormatUInt(char *buf, unsigned long long value)
+	{
+		//digits are produced backwards, two at a time
+		char tmp[24];
+		char *p = tmp + sizeof(tmp);
+		while (value >= 100)
+		{
+			unsigned int pair = (unsigned int)(value % 100) * 2;
+			value /= 100;
+			*--p = digitPairs[pair + 1];
+			*--p = digitPairs[pair];
+		}
+		if (value >= 10)
+		{
+			unsigned int pair = (unsigned int)value * 2;
+			*--p = digitPairs[pair + 1];
+			*--p = digitPairs[pair];
+		}
+		else
+		{
+			*--p = (char)('0' + value);
+		}
+
+		int len = (int)(tmp + sizeof(tmp) - p);
+		memcpy(buf, p, len);
+		return len;
+	}
+
+	int EasyJsonWriter::FormatInt(char *buf, long long value)
+	{
+		if (value >= 0)	return FormatUInt(buf, (unsigned long long)value);
+
+		buf[0] = '-';
+		return 1 + FormatUInt(buf + 1, 0 - (unsigned long long)value);
+	}
+
+	int EasyJsonWriter::FormatDouble(char *buf, double value)
+	{
+		if (value != value)
+		{
+			memcpy(buf, "null", 4);
+			return 4;
+		}
+		if (value > 1.7976931348623157e308 || value < -1.7976931348623157e308)
+		{
+			if (value < 0)
+			{
+				memcpy(buf, "-1e+9999", 8);
+				return 8;
+			}
+			memcpy(buf, "1e+9999", 7);
+			return 7;
+		}
+
+		int len = snprintf(buf, 32, "%.17g", value);
+		if (len < 0 || len >= 32)	len = 31;
+
+		//a locale with a decimal comma must not leak into the JSON
+		for (int i = 0; i < len; i++)
+		{
+			if (buf[i] == ',')	buf[i] = '.';
+		}
+		return len;
+	}
+
+	void EasyJsonWriter::AppendQuoted(std::string &out, const char *str, size_t len)
+	{
+		out += '"';
+
+		//copy runs that need no escaping in one go
+		const char *run = str;
+		for (const char *end = str + len; str < end; str++)
+		{
+			unsigned char c = (unsigned char)*str;
+			if (c >= 0x20 && c != '"' && c != '\\')	continue;
+
+			out.append(run, str - run);
+			run = str + 1;
+
+			char esc[6] = {'\\', 0, '0', '0', 0, 0};
+			size_t n = 2;
+			switch (c)
+			{
+			case '"':	esc[1] = '"';	break;
+			case '\\':	esc[1] = '\\';	break;
+			case '\b':	esc[1] = 'b';	break;
+			case '\f':	esc[1] = 'f';	break;
+			case '\n':	esc[1] = 'n';	break;
+			case '\r':	esc[1] = 'r';	break;
+			case '\t':	esc[1] = 't';	break;
+			default:
+				esc[1] = 'u';
+				esc[4] = hexDigits[c >> 4];
+				esc[5] = hexDigits[c & 0x0F];
+				n = 6;
+				break;
+			}
+			out.append(esc, n);
+		}
+		out.append(run, str - run);
+
+		out += '"';
+	}
+
+	EasyValueText::EasyValueText(float value)
+	{
+		int len = snprintf(buf_, sizeof(buf_), "%.9g", value);
+		if (len < 0 || len >= (int)sizeof(buf_))	len = sizeof(buf_) - 1;
+		Set(buf_, buf_ + len);
+	}
+
+	EasyValueText::EasyValueText(double value)
+	{
+		int len = snprintf(buf_, sizeof(buf_), "%.17g", value);
+		if (len < 0 || len >= (int)sizeof(buf_))	len = sizeof(buf_) - 1;
+		Set(buf_, buf_ + len);
+	}
+}}//namespace
@@ -0,0 +1,205 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyMessageCodec.cpp
+*/
+
+#include <EasyMessageCodec.h>
+#include <EasyJsonReader.h>
+#include <EasyJsonWriter.h>
+#include <EasyProtocolBase.h>
+#include <string.h>
+
+namespace EasyDarwin { namespace Protocol
+{
+	class MessageHandler : public EasyJsonHandler
+	{
+	public:
+		enum
+		{
+			LEVEL_OTHER = 0,
+			LEVEL_TOP,
+			LEVEL_ROOT,
+			LEVEL_HEADER,
+			LEVEL_BODY,
+			LEVEL_LIST,
+			LEVEL_ITEM
+		};
+
+		MessageHandler(int msgType, EASY_MSG_HEADER_T &header, void *msg, EasyMessageCodec::Setter setter, EasyMessageCodec::ItemAdder adder)
+			: msgType_(msgType)
+			, header_(header)
+			, msg_(msg)
+			, setter_(setter)
+			, adder_(adder)
+			, depth_(0)
+		{
+		}
+
+		virtual bool StartObject()
+		{
+			int parent = Top();
+			int level = LEVEL_OTHER;
+			if (depth_ == 0)
+			{
+				level = LEVEL_TOP;
+			}
+			else if (parent == LEVEL_TOP && key_ == EASY_TAG_ROOT)
+			{
+				level = LEVEL_ROOT;
+			}
+			else if (parent == LEVEL_ROOT && key_ == EASY_TAG_HEADER)
+			{
+				level = LEVEL_HEADER;
+			}
+			else if (parent == LEVEL_ROOT && key_ == EASY_TAG_BODY)
+			{
+				level = LEVEL_BODY;
+			}
+			else if (parent == LEVEL_LIST)
+			{
+				item_ = adder_(msg_, listKey_);
+				if (item_ >= 0)	level = LEVEL_ITEM;
+			}
+			return Push(level);
+		}
+
+		virtual bool EndObject()
+		{
+			depth_--;
+			return true;
+		}
+
+		virtual bool StartArray()
+		{
+			if (Top() == LEVEL_BODY)
+			{
+				listKey_ = key_;
+				return Push(LEVEL_LIST);
+			}
+			return Push(LEVEL_OTHER);
+		}
+
+		virtual bool EndArray()
+		{
+			depth_--;
+			return true;
+		}
+
+		virtual bool Key(const char *str, size_t len)
+		{
+			key_ = boost::string_ref(str, len);
+			return true;
+		}
+
+		virtual bool String(const char *str, size_t len)
+		{
+			return Value(boost::string_ref(str, len));
+		}
+
+		virtual bool Scalar(const char *str, size_t len)
+		{
+			return Value(boost::string_ref(str, len));
+		}
+
+	private:
+		int Top()
+		{
+			return depth_ > 0 ? stack_[depth_ - 1] : -1;
+		}
+
+		bool Push(int level)
+		{
+			if (depth_ >= EASY_JSON_MAX_DEPTH)	return false;
+			stack_[depth_++] = level;
+			return true;
+		}
+
+		bool Value(boost::string_ref value)
+		{
+			switch (Top())
+			{
+			case LEVEL_HEADER:
+				if (key_ == EASY_TAG_MESSAGE_TYPE)		return EasyProtocol::GetMsgType(value) == msgType_;
+				else if (key_ == EASY_TAG_CSEQ)			header_.cseq = EasyMessageCodec::ToInt(value);
+				else if (key_ == EASY_TAG_ERROR_NUM)	header_.errorNum = EasyMessageCodec::ToInt(value);
+				else if (key_ == EASY_TAG_ERROR_STRING)	EasyMessageCodec::Assign(header_.errorString, value);
+				else if (key_ == EASY_TAG_VERSION)		EasyMessageCodec::Assign(header_.version, value);
+				else									setter_(msg_, EASY_MSG_SECTION_HEADER, -1, key_, value);
+				break;
+			case LEVEL_BODY:
+				setter_(msg_, EASY_MSG_SECTION_BODY, -1, key_, value);
+				break;
+			case LEVEL_ITEM:
+				setter_(msg_, EASY_MSG_SECTION_ITEM, item_, key_, value);
+				break;
+			default:
+				break;
+			}
+			return true;
+		}
+
+		int msgType_;
+		EASY_MSG_HEADER_T &header_;
+		void *msg_;
+		EasyMessageCodec::Setter setter_;
+		EasyMessageCodec::ItemAdder adder_;
+
+		boost::string_ref key_;
+		boost::string_ref listKey_;
+		int item_;
+		int stack_[EASY_JSON_MAX_DEPTH];
+		int depth_;
+	};
+
+	bool EasyMessageCodec::Decode(char *buf, size_t len, int msgType, EASY_MSG_HEADER_T &header, void *msg, Setter setter, ItemAdder adder)
+	{
+		if (NULL == buf || len == 0)	return false;
+
+		MessageHandler handler(msgType, header, msg, setter, adder);
+		return EasyJsonReader::ParseInsitu(buf, len, handler);
+	}
+
+	void EasyMessageCodec::AppendString(std::string &out, boost::string_ref value)
+	{
+		EasyJsonWriter::AppendQuoted(out, value.data(), value.size());
+	}
+
+	void EasyMessageCodec::AppendInt(std::string &out, long long value)
+	{
+		char buf[24];
+		buf[0] = '"';
+		int len = EasyJsonWriter::FormatInt(buf + 1, value);
+		buf[len + 1] = '"';
+		out.append(buf, len + 2);
+	}
+
+	void EasyMessageCodec::AppendEnum(std::string &out, const EasyTypeMap &map, int value)
+	{
+		AppendString(out, map.String(value));
+	}
+
+	void EasyMessageCodec::AppendErrorString(std::string &out, const EASY_MSG_HEADER_T &header)
+	{
+		if (header.errorString.empty())	AppendString(out, EasyProtocol::GetErrorString(header.errorNum));
+		else							AppendString(out, header.errorString);
+	}
+
+	int EasyMessageCodec::ToInt(boost::string_ref value)
+	{
+		size_t i = 0;
+		bool negative = false;
+		if (i < value.size() && (value[i] == '-' || value[i] == '+'))	negative = (value[i++] == '-');
+
+		unsigned int result = 0;
+		for (; i < value.size() && value[i] >= '0' && value[i] <= '9'; i++)
+		{
+			result = result * 10 + (value[i] - '0');
+		}
+		return negative ? (int)(0 - result) : (int)result;
+	}
+}}//namespace
@@ -0,0 +1,2578 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyMessages.cpp
+ *
+ * Generated by Schema/gen_messages.py from Schema/EasyMessages.schema, do not edit.
+*/
+
+#include <EasyMessages.h>
+#include <EasyProtocolBase.h>
+#include <string.h>
+
+namespace EasyDarwin { namespace Protocol
+{
+	static int AddNone(void *, boost::string_ref)
+	{
+		return -1;
+	}
+
+	static void EncodeChannel(std::string &out, const EASY_MSG_CHANNEL_T &item)
+	{
+		char sep = '{';
+		if (!item.channel.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Channel\":", 10);
+			EasyMessageCodec::AppendString(out, item.channel);
+		}
+		if (!item.name.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Name\":", 7);
+			EasyMessageCodec::AppendString(out, item.name);
+		}
+		if (!item.serial.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Serial\":", 9);
+			EasyMessageCodec::AppendString(out, item.serial);
+		}
+		if (!item.snapURL.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"SnapURL\":", 10);
+			EasyMessageCodec::AppendString(out, item.snapURL);
+		}
+		if (!item.status.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Status\":", 9);
+			EasyMessageCodec::AppendString(out, item.status);
+		}
+		if (sep == '{')	out += sep;
+		out += '}';
+	}
+
+	static bool SetChannel(EASY_MSG_CHANNEL_T &item, boost::string_ref key, boost::string_ref value)
+	{
+		switch (key.size())
+		{
+		case 4:
+			if (memcmp(key.data(), "Name", 4) == 0)	{ EasyMessageCodec::Assign(item.name, value); return true; }
+			break;
+		case 6:
+			if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(item.serial, value); return true; }
+			if (memcmp(key.data(), "Status", 6) == 0)	{ EasyMessageCodec::Assign(item.status, value); return true; }
+			break;
+		case 7:
+			if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(item.channel, value); return true; }
+			if (memcmp(key.data(), "SnapURL", 7) == 0)	{ EasyMessageCodec::Assign(item.snapURL, value); return true; }
+			break;
+		}
+		return true;
+	}
+
+	static void EncodeDevice(std::string &out, const EASY_MSG_DEVICE_T &item)
+	{
+		char sep = '{';
+		if (!item.appType.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"AppType\":", 10);
+			EasyMessageCodec::AppendString(out, item.appType);
+		}
+		if (!item.name.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Name\":", 7);
+			EasyMessageCodec::AppendString(out, item.name);
+		}
+		if (!item.serial.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Serial\":", 9);
+			EasyMessageCodec::AppendString(out, item.serial);
+		}
+		if (!item.snapURL.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"SnapURL\":", 10);
+			EasyMessageCodec::AppendString(out, item.snapURL);
+		}
+		if (!item.tag.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Tag\":", 6);
+			EasyMessageCodec::AppendString(out, item.tag);
+		}
+		if (!item.terminalType.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"TerminalType\":", 15);
+			EasyMessageCodec::AppendString(out, item.terminalType);
+		}
+		if (sep == '{')	out += sep;
+		out += '}';
+	}
+
+	static bool SetDevice(EASY_MSG_DEVICE_T &item, boost::string_ref key, boost::string_ref value)
+	{
+		switch (key.size())
+		{
+		case 3:
+			if (memcmp(key.data(), "Tag", 3) == 0)	{ EasyMessageCodec::Assign(item.tag, value); return true; }
+			break;
+		case 4:
+			if (memcmp(key.data(), "Name", 4) == 0)	{ EasyMessageCodec::Assign(item.name, value); return true; }
+			break;
+		case 6:
+			if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(item.serial, value); return true; }
+			break;
+		case 7:
+			if (memcmp(key.data(), "AppType", 7) == 0)	{ EasyMessageCodec::Assign(item.appType, value); return true; }
+			if (memcmp(key.data(), "SnapURL", 7) == 0)	{ EasyMessageCodec::Assign(item.snapURL, value); return true; }
+			break;
+		case 12:
+			if (memcmp(key.data(), "TerminalType", 12) == 0)	{ EasyMessageCodec::Assign(item.terminalType, value); return true; }
+			break;
+		}
+		return true;
+	}
+
+	// MSG_DS_REGISTER_REQ
+	void EasyEncodeMsg(const EASY_MSG_DS_REGISTER_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		if (msg.channelCount != -1)
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"ChannelCount\":", 15);
+			EasyMessageCodec::AppendInt(out, msg.channelCount);
+		}
+		if (!msg.channels.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Channels\":", 11);
+			out += '[';
+			for (size_t i = 0; i < msg.channels.size(); i++)
+			{
+				if (i > 0)	out += ',';
+				EncodeChannel(out, msg.channels[i]);
+			}
+			out += ']';
+		}
+		out += sep;
+		sep = ',';
+		out.append("\"Name\":", 7);
+		EasyMessageCodec::AppendString(out, msg.name);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		out += sep;
+		sep = ',';
+		out.append("\"Tag\":", 6);
+		EasyMessageCodec::AppendString(out, msg.tag);
+		out += sep;
+		sep = ',';
+		out.append("\"Token\":", 8);
+		EasyMessageCodec::AppendString(out, msg.token);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"AppType\":", 10);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::AppTypes, msg.appType);
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_DS_REGISTER_REQ\"", 36);
+		out += sep;
+		sep = ',';
+		out.append("\"TerminalType\":", 15);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::TerminalTypes, msg.terminalType);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetDSRegisterREQ(void *ptr, int section, int list, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_DS_REGISTER_REQ_T &msg = *(EASY_MSG_DS_REGISTER_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_HEADER:
+			switch (key.size())
+			{
+			case 7:
+				if (memcmp(key.data(), "AppType", 7) == 0)	{ msg.appType = EasyProtocol::AppTypes.Value(value); return true; }
+				break;
+			case 12:
+				if (memcmp(key.data(), "TerminalType", 12) == 0)	{ msg.terminalType = EasyProtocol::TerminalTypes.Value(value); return true; }
+				break;
+			}
+			break;
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 3:
+				if (memcmp(key.data(), "Tag", 3) == 0)	{ EasyMessageCodec::Assign(msg.tag, value); return true; }
+				break;
+			case 4:
+				if (memcmp(key.data(), "Name", 4) == 0)	{ EasyMessageCodec::Assign(msg.name, value); return true; }
+				break;
+			case 5:
+				if (memcmp(key.data(), "Token", 5) == 0)	{ EasyMessageCodec::Assign(msg.token, value); return true; }
+				break;
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 12:
+				if (memcmp(key.data(), "ChannelCount", 12) == 0)	{ msg.channelCount = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			}
+			break;
+		case EASY_MSG_SECTION_ITEM:
+			if (list == 0)	return SetChannel(msg.channels.back(), key, value);
+			break;
+		}
+		return true;
+	}
+
+	static int AddDSRegisterREQ(void *ptr, boost::string_ref key)
+	{
+		EASY_MSG_DS_REGISTER_REQ_T &msg = *(EASY_MSG_DS_REGISTER_REQ_T *)ptr;
+		if (key.size() == 8 && memcmp(key.data(), "Channels", 8) == 0)
+		{
+			msg.channels.push_back(EASY_MSG_CHANNEL_T());
+			return 0;
+		}
+		return -1;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_REGISTER_REQ_T &msg)
+	{
+		msg = EASY_MSG_DS_REGISTER_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_DS_REGISTER_REQ, msg.header, &msg, SetDSRegisterREQ, AddDSRegisterREQ);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_REGISTER_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SD_REGISTER_ACK
+	void EasyEncodeMsg(const EASY_MSG_SD_REGISTER_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (!msg.sessionID.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"SessionID\":", 12);
+			EasyMessageCodec::AppendString(out, msg.sessionID);
+		}
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SD_REGISTER_ACK\"", 36);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSDRegisterACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SD_REGISTER_ACK_T &msg = *(EASY_MSG_SD_REGISTER_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 9:
+				if (memcmp(key.data(), "SessionID", 9) == 0)	{ EasyMessageCodec::Assign(msg.sessionID, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_REGISTER_ACK_T &msg)
+	{
+		msg = EASY_MSG_SD_REGISTER_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SD_REGISTER_ACK, msg.header, &msg, SetSDRegisterACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_REGISTER_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SD_PUSH_STREAM_REQ
+	void EasyEncodeMsg(const EASY_MSG_SD_PUSH_STREAM_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		out += sep;
+		sep = ',';
+		out.append("\"Server_IP\":", 12);
+		EasyMessageCodec::AppendString(out, msg.serverIP);
+		out += sep;
+		sep = ',';
+		out.append("\"Server_PORT\":", 14);
+		EasyMessageCodec::AppendString(out, msg.serverPort);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_SD_PUSH_STREAM_REQ\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSDPushStreamREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SD_PUSH_STREAM_REQ_T &msg = *(EASY_MSG_SD_PUSH_STREAM_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			case 9:
+				if (memcmp(key.data(), "Server_IP", 9) == 0)	{ EasyMessageCodec::Assign(msg.serverIP, value); return true; }
+				break;
+			case 11:
+				if (memcmp(key.data(), "Server_PORT", 11) == 0)	{ EasyMessageCodec::Assign(msg.serverPort, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_PUSH_STREAM_REQ_T &msg)
+	{
+		msg = EASY_MSG_SD_PUSH_STREAM_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SD_PUSH_STREAM_REQ, msg.header, &msg, SetSDPushStreamREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_PUSH_STREAM_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_DS_PUSH_STREAM_ACK
+	void EasyEncodeMsg(const EASY_MSG_DS_PUSH_STREAM_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		out += sep;
+		sep = ',';
+		out.append("\"Server_IP\":", 12);
+		EasyMessageCodec::AppendString(out, msg.serverIP);
+		out += sep;
+		sep = ',';
+		out.append("\"Server_PORT\":", 14);
+		EasyMessageCodec::AppendString(out, msg.serverPort);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_DS_PUSH_STREAM_ACK\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetDSPushStreamACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_DS_PUSH_STREAM_ACK_T &msg = *(EASY_MSG_DS_PUSH_STREAM_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			case 9:
+				if (memcmp(key.data(), "Server_IP", 9) == 0)	{ EasyMessageCodec::Assign(msg.serverIP, value); return true; }
+				break;
+			case 11:
+				if (memcmp(key.data(), "Server_PORT", 11) == 0)	{ EasyMessageCodec::Assign(msg.serverPort, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_PUSH_STREAM_ACK_T &msg)
+	{
+		msg = EASY_MSG_DS_PUSH_STREAM_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_DS_PUSH_STREAM_ACK, msg.header, &msg, SetDSPushStreamACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_PUSH_STREAM_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SD_STREAM_STOP_REQ
+	void EasyEncodeMsg(const EASY_MSG_SD_STREAM_STOP_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_SD_STREAM_STOP_REQ\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSDStreamStopREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SD_STREAM_STOP_REQ_T &msg = *(EASY_MSG_SD_STREAM_STOP_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_STREAM_STOP_REQ_T &msg)
+	{
+		msg = EASY_MSG_SD_STREAM_STOP_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SD_STREAM_STOP_REQ, msg.header, &msg, SetSDStreamStopREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_STREAM_STOP_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_DS_STREAM_STOP_ACK
+	void EasyEncodeMsg(const EASY_MSG_DS_STREAM_STOP_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_DS_STREAM_STOP_ACK\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetDSStreamStopACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_DS_STREAM_STOP_ACK_T &msg = *(EASY_MSG_DS_STREAM_STOP_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_STREAM_STOP_ACK_T &msg)
+	{
+		msg = EASY_MSG_DS_STREAM_STOP_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_DS_STREAM_STOP_ACK, msg.header, &msg, SetDSStreamStopACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_STREAM_STOP_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SC_DEVICE_LIST_ACK
+	void EasyEncodeMsg(const EASY_MSG_SC_DEVICE_LIST_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"DeviceCount\":", 14);
+		EasyMessageCodec::AppendInt(out, msg.deviceCount);
+		if (!msg.devices.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Devices\":", 10);
+			out += '[';
+			for (size_t i = 0; i < msg.devices.size(); i++)
+			{
+				if (i > 0)	out += ',';
+				EncodeDevice(out, msg.devices[i]);
+			}
+			out += ']';
+		}
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SC_DEVICE_LIST_ACK\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSCDeviceListACK(void *ptr, int section, int list, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SC_DEVICE_LIST_ACK_T &msg = *(EASY_MSG_SC_DEVICE_LIST_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 11:
+				if (memcmp(key.data(), "DeviceCount", 11) == 0)	{ msg.deviceCount = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			}
+			break;
+		case EASY_MSG_SECTION_ITEM:
+			if (list == 0)	return SetDevice(msg.devices.back(), key, value);
+			break;
+		}
+		return true;
+	}
+
+	static int AddSCDeviceListACK(void *ptr, boost::string_ref key)
+	{
+		EASY_MSG_SC_DEVICE_LIST_ACK_T &msg = *(EASY_MSG_SC_DEVICE_LIST_ACK_T *)ptr;
+		if (key.size() == 7 && memcmp(key.data(), "Devices", 7) == 0)
+		{
+			msg.devices.push_back(EASY_MSG_DEVICE_T());
+			return 0;
+		}
+		return -1;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_DEVICE_LIST_ACK_T &msg)
+	{
+		msg = EASY_MSG_SC_DEVICE_LIST_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SC_DEVICE_LIST_ACK, msg.header, &msg, SetSCDeviceListACK, AddSCDeviceListACK);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_DEVICE_LIST_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SC_DEVICE_INFO_ACK
+	void EasyEncodeMsg(const EASY_MSG_SC_DEVICE_INFO_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"ChannelCount\":", 15);
+		EasyMessageCodec::AppendInt(out, msg.channelCount);
+		if (!msg.channels.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Channels\":", 11);
+			out += '[';
+			for (size_t i = 0; i < msg.channels.size(); i++)
+			{
+				if (i > 0)	out += ',';
+				EncodeChannel(out, msg.channels[i]);
+			}
+			out += ']';
+		}
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SC_DEVICE_INFO_ACK\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSCDeviceInfoACK(void *ptr, int section, int list, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SC_DEVICE_INFO_ACK_T &msg = *(EASY_MSG_SC_DEVICE_INFO_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 12:
+				if (memcmp(key.data(), "ChannelCount", 12) == 0)	{ msg.channelCount = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			}
+			break;
+		case EASY_MSG_SECTION_ITEM:
+			if (list == 0)	return SetChannel(msg.channels.back(), key, value);
+			break;
+		}
+		return true;
+	}
+
+	static int AddSCDeviceInfoACK(void *ptr, boost::string_ref key)
+	{
+		EASY_MSG_SC_DEVICE_INFO_ACK_T &msg = *(EASY_MSG_SC_DEVICE_INFO_ACK_T *)ptr;
+		if (key.size() == 8 && memcmp(key.data(), "Channels", 8) == 0)
+		{
+			msg.channels.push_back(EASY_MSG_CHANNEL_T());
+			return 0;
+		}
+		return -1;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_DEVICE_INFO_ACK_T &msg)
+	{
+		msg = EASY_MSG_SC_DEVICE_INFO_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SC_DEVICE_INFO_ACK, msg.header, &msg, SetSCDeviceInfoACK, AddSCDeviceInfoACK);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_DEVICE_INFO_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SC_CAMERA_LIST_ACK
+	void EasyEncodeMsg(const EASY_MSG_SC_CAMERA_LIST_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"ChannelCount\":", 15);
+		EasyMessageCodec::AppendInt(out, msg.channelCount);
+		if (!msg.channels.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Channels\":", 11);
+			out += '[';
+			for (size_t i = 0; i < msg.channels.size(); i++)
+			{
+				if (i > 0)	out += ',';
+				EncodeChannel(out, msg.channels[i]);
+			}
+			out += ']';
+		}
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SC_CAMERA_LIST_ACK\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSCCameraListACK(void *ptr, int section, int list, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SC_CAMERA_LIST_ACK_T &msg = *(EASY_MSG_SC_CAMERA_LIST_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 12:
+				if (memcmp(key.data(), "ChannelCount", 12) == 0)	{ msg.channelCount = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			}
+			break;
+		case EASY_MSG_SECTION_ITEM:
+			if (list == 0)	return SetChannel(msg.channels.back(), key, value);
+			break;
+		}
+		return true;
+	}
+
+	static int AddSCCameraListACK(void *ptr, boost::string_ref key)
+	{
+		EASY_MSG_SC_CAMERA_LIST_ACK_T &msg = *(EASY_MSG_SC_CAMERA_LIST_ACK_T *)ptr;
+		if (key.size() == 8 && memcmp(key.data(), "Channels", 8) == 0)
+		{
+			msg.channels.push_back(EASY_MSG_CHANNEL_T());
+			return 0;
+		}
+		return -1;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_CAMERA_LIST_ACK_T &msg)
+	{
+		msg = EASY_MSG_SC_CAMERA_LIST_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SC_CAMERA_LIST_ACK, msg.header, &msg, SetSCCameraListACK, AddSCCameraListACK);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_CAMERA_LIST_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_CS_GET_STREAM_REQ
+	void EasyEncodeMsg(const EASY_MSG_CS_GET_STREAM_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_CS_GET_STREAM_REQ\"", 38);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetCSGetStreamREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_CS_GET_STREAM_REQ_T &msg = *(EASY_MSG_CS_GET_STREAM_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_GET_STREAM_REQ_T &msg)
+	{
+		msg = EASY_MSG_CS_GET_STREAM_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_CS_GET_STREAM_REQ, msg.header, &msg, SetCSGetStreamREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_GET_STREAM_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SC_GET_STREAM_ACK
+	void EasyEncodeMsg(const EASY_MSG_SC_GET_STREAM_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		out += sep;
+		sep = ',';
+		out.append("\"URL\":", 6);
+		EasyMessageCodec::AppendString(out, msg.url);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SC_GET_STREAM_ACK\"", 38);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSCGetStreamACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SC_GET_STREAM_ACK_T &msg = *(EASY_MSG_SC_GET_STREAM_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 3:
+				if (memcmp(key.data(), "URL", 3) == 0)	{ EasyMessageCodec::Assign(msg.url, value); return true; }
+				break;
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_GET_STREAM_ACK_T &msg)
+	{
+		msg = EASY_MSG_SC_GET_STREAM_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SC_GET_STREAM_ACK, msg.header, &msg, SetSCGetStreamACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_GET_STREAM_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_CS_FREE_STREAM_REQ
+	void EasyEncodeMsg(const EASY_MSG_CS_FREE_STREAM_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_CS_FREE_STREAM_REQ\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetCSFreeStreamREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_CS_FREE_STREAM_REQ_T &msg = *(EASY_MSG_CS_FREE_STREAM_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_FREE_STREAM_REQ_T &msg)
+	{
+		msg = EASY_MSG_CS_FREE_STREAM_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_CS_FREE_STREAM_REQ, msg.header, &msg, SetCSFreeStreamREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_FREE_STREAM_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SC_FREE_STREAM_ACK
+	void EasyEncodeMsg(const EASY_MSG_SC_FREE_STREAM_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SC_FREE_STREAM_ACK\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSCFreeStreamACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SC_FREE_STREAM_ACK_T &msg = *(EASY_MSG_SC_FREE_STREAM_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_FREE_STREAM_ACK_T &msg)
+	{
+		msg = EASY_MSG_SC_FREE_STREAM_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SC_FREE_STREAM_ACK, msg.header, &msg, SetSCFreeStreamACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_FREE_STREAM_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_DS_POST_SNAP_REQ
+	void EasyEncodeMsg(const EASY_MSG_DS_POST_SNAP_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Image\":", 8);
+		EasyMessageCodec::AppendString(out, msg.image);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		out += sep;
+		sep = ',';
+		out.append("\"Time\":", 7);
+		EasyMessageCodec::AppendString(out, msg.time);
+		out += sep;
+		sep = ',';
+		out.append("\"Type\":", 7);
+		EasyMessageCodec::AppendString(out, msg.type);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_DS_POST_SNAP_REQ\"", 37);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetDSPostSnapREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_DS_POST_SNAP_REQ_T &msg = *(EASY_MSG_DS_POST_SNAP_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 4:
+				if (memcmp(key.data(), "Time", 4) == 0)	{ EasyMessageCodec::Assign(msg.time, value); return true; }
+				if (memcmp(key.data(), "Type", 4) == 0)	{ EasyMessageCodec::Assign(msg.type, value); return true; }
+				break;
+			case 5:
+				if (memcmp(key.data(), "Image", 5) == 0)	{ EasyMessageCodec::Assign(msg.image, value); return true; }
+				break;
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_POST_SNAP_REQ_T &msg)
+	{
+		msg = EASY_MSG_DS_POST_SNAP_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_DS_POST_SNAP_REQ, msg.header, &msg, SetDSPostSnapREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_POST_SNAP_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SD_POST_SNAP_ACK
+	void EasyEncodeMsg(const EASY_MSG_SD_POST_SNAP_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		if (!msg.channel.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Channel\":", 10);
+			EasyMessageCodec::AppendString(out, msg.channel);
+		}
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SD_POST_SNAP_ACK\"", 37);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSDPostSnapACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SD_POST_SNAP_ACK_T &msg = *(EASY_MSG_SD_POST_SNAP_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_POST_SNAP_ACK_T &msg)
+	{
+		msg = EASY_MSG_SD_POST_SNAP_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SD_POST_SNAP_ACK, msg.header, &msg, SetSDPostSnapACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_POST_SNAP_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_CS_PTZ_CONTROL_REQ
+	void EasyEncodeMsg(const EASY_MSG_CS_PTZ_CONTROL_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"ActionType\":", 13);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::PTZActionTypes, msg.actionType);
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Command\":", 10);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::PTZCMDTypes, msg.command);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		out += sep;
+		sep = ',';
+		out.append("\"Speed\":", 8);
+		EasyMessageCodec::AppendInt(out, msg.speed);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_CS_PTZ_CONTROL_REQ\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetCSPtzControlREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_CS_PTZ_CONTROL_REQ_T &msg = *(EASY_MSG_CS_PTZ_CONTROL_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 5:
+				if (memcmp(key.data(), "Speed", 5) == 0)	{ msg.speed = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Command", 7) == 0)	{ msg.command = EasyProtocol::PTZCMDTypes.Value(value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			case 10:
+				if (memcmp(key.data(), "ActionType", 10) == 0)	{ msg.actionType = EasyProtocol::PTZActionTypes.Value(value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_PTZ_CONTROL_REQ_T &msg)
+	{
+		msg = EASY_MSG_CS_PTZ_CONTROL_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_CS_PTZ_CONTROL_REQ, msg.header, &msg, SetCSPtzControlREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_PTZ_CONTROL_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SC_PTZ_CONTROL_ACK
+	void EasyEncodeMsg(const EASY_MSG_SC_PTZ_CONTROL_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SC_PTZ_CONTROL_ACK\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSCPtzControlACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SC_PTZ_CONTROL_ACK_T &msg = *(EASY_MSG_SC_PTZ_CONTROL_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_PTZ_CONTROL_ACK_T &msg)
+	{
+		msg = EASY_MSG_SC_PTZ_CONTROL_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SC_PTZ_CONTROL_ACK, msg.header, &msg, SetSCPtzControlACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_PTZ_CONTROL_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SD_CONTROL_PTZ_REQ
+	void EasyEncodeMsg(const EASY_MSG_SD_CONTROL_PTZ_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"ActionType\":", 13);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::PTZActionTypes, msg.actionType);
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Command\":", 10);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::PTZCMDTypes, msg.command);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		out += sep;
+		sep = ',';
+		out.append("\"Speed\":", 8);
+		EasyMessageCodec::AppendInt(out, msg.speed);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_SD_CONTROL_PTZ_REQ\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSDControlPtzREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SD_CONTROL_PTZ_REQ_T &msg = *(EASY_MSG_SD_CONTROL_PTZ_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 5:
+				if (memcmp(key.data(), "Speed", 5) == 0)	{ msg.speed = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Command", 7) == 0)	{ msg.command = EasyProtocol::PTZCMDTypes.Value(value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			case 10:
+				if (memcmp(key.data(), "ActionType", 10) == 0)	{ msg.actionType = EasyProtocol::PTZActionTypes.Value(value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_CONTROL_PTZ_REQ_T &msg)
+	{
+		msg = EASY_MSG_SD_CONTROL_PTZ_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SD_CONTROL_PTZ_REQ, msg.header, &msg, SetSDControlPtzREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_CONTROL_PTZ_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_DS_CONTROL_PTZ_ACK
+	void EasyEncodeMsg(const EASY_MSG_DS_CONTROL_PTZ_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_DS_CONTROL_PTZ_ACK\"", 39);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetDSControlPtzACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_DS_CONTROL_PTZ_ACK_T &msg = *(EASY_MSG_DS_CONTROL_PTZ_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_CONTROL_PTZ_ACK_T &msg)
+	{
+		msg = EASY_MSG_DS_CONTROL_PTZ_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_DS_CONTROL_PTZ_ACK, msg.header, &msg, SetDSControlPtzACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_CONTROL_PTZ_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_CS_PRESET_CONTROL_REQ
+	void EasyEncodeMsg(const EASY_MSG_CS_PRESET_CONTROL_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Command\":", 10);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::PresetCMDTypes, msg.command);
+		out += sep;
+		sep = ',';
+		out.append("\"Preset\":", 9);
+		EasyMessageCodec::AppendInt(out, msg.preset);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_CS_PRESET_CONTROL_REQ\"", 42);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetCSPresetControlREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_CS_PRESET_CONTROL_REQ_T &msg = *(EASY_MSG_CS_PRESET_CONTROL_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Preset", 6) == 0)	{ msg.preset = EasyMessageCodec::ToInt(value); return true; }
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Command", 7) == 0)	{ msg.command = EasyProtocol::PresetCMDTypes.Value(value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_PRESET_CONTROL_REQ_T &msg)
+	{
+		msg = EASY_MSG_CS_PRESET_CONTROL_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_CS_PRESET_CONTROL_REQ, msg.header, &msg, SetCSPresetControlREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_PRESET_CONTROL_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SC_PRESET_CONTROL_ACK
+	void EasyEncodeMsg(const EASY_MSG_SC_PRESET_CONTROL_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SC_PRESET_CONTROL_ACK\"", 42);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSCPresetControlACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SC_PRESET_CONTROL_ACK_T &msg = *(EASY_MSG_SC_PRESET_CONTROL_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_PRESET_CONTROL_ACK_T &msg)
+	{
+		msg = EASY_MSG_SC_PRESET_CONTROL_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SC_PRESET_CONTROL_ACK, msg.header, &msg, SetSCPresetControlACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_PRESET_CONTROL_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SD_CONTROL_PRESET_REQ
+	void EasyEncodeMsg(const EASY_MSG_SD_CONTROL_PRESET_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Command\":", 10);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::PresetCMDTypes, msg.command);
+		out += sep;
+		sep = ',';
+		out.append("\"Preset\":", 9);
+		EasyMessageCodec::AppendInt(out, msg.preset);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_SD_CONTROL_PRESET_REQ\"", 42);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSDControlPresetREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SD_CONTROL_PRESET_REQ_T &msg = *(EASY_MSG_SD_CONTROL_PRESET_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Preset", 6) == 0)	{ msg.preset = EasyMessageCodec::ToInt(value); return true; }
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Command", 7) == 0)	{ msg.command = EasyProtocol::PresetCMDTypes.Value(value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_CONTROL_PRESET_REQ_T &msg)
+	{
+		msg = EASY_MSG_SD_CONTROL_PRESET_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SD_CONTROL_PRESET_REQ, msg.header, &msg, SetSDControlPresetREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_CONTROL_PRESET_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_DS_CONTROL_PRESET_ACK
+	void EasyEncodeMsg(const EASY_MSG_DS_CONTROL_PRESET_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_DS_CONTROL_PRESET_ACK\"", 42);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetDSControlPresetACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_DS_CONTROL_PRESET_ACK_T &msg = *(EASY_MSG_DS_CONTROL_PRESET_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_CONTROL_PRESET_ACK_T &msg)
+	{
+		msg = EASY_MSG_DS_CONTROL_PRESET_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_DS_CONTROL_PRESET_ACK, msg.header, &msg, SetDSControlPresetACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_CONTROL_PRESET_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_CS_TALKBACK_CONTROL_REQ
+	void EasyEncodeMsg(const EASY_MSG_CS_TALKBACK_CONTROL_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"AudioData\":", 12);
+		EasyMessageCodec::AppendString(out, msg.audioData);
+		out += sep;
+		sep = ',';
+		out.append("\"AudioType\":", 12);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::TalkbackAudioTypes, msg.audioType);
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Command\":", 10);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::TalkbackCMDTypes, msg.command);
+		if (msg.frameDuration != -1)
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"FrameDuration\":", 16);
+			EasyMessageCodec::AppendInt(out, msg.frameDuration);
+		}
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Pts\":", 6);
+		EasyMessageCodec::AppendInt(out, msg.pts);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (!msg.transport.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Transport\":", 12);
+			EasyMessageCodec::AppendString(out, msg.transport);
+		}
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_CS_TALKBACK_CONTROL_REQ\"", 44);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetCSTalkbackControlREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_CS_TALKBACK_CONTROL_REQ_T &msg = *(EASY_MSG_CS_TALKBACK_CONTROL_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 3:
+				if (memcmp(key.data(), "Pts", 3) == 0)	{ msg.pts = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Command", 7) == 0)	{ msg.command = EasyProtocol::TalkbackCMDTypes.Value(value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			case 9:
+				if (memcmp(key.data(), "AudioData", 9) == 0)	{ EasyMessageCodec::Assign(msg.audioData, value); return true; }
+				if (memcmp(key.data(), "AudioType", 9) == 0)	{ msg.audioType = EasyProtocol::TalkbackAudioTypes.Value(value); return true; }
+				if (memcmp(key.data(), "Transport", 9) == 0)	{ EasyMessageCodec::Assign(msg.transport, value); return true; }
+				break;
+			case 13:
+				if (memcmp(key.data(), "FrameDuration", 13) == 0)	{ msg.frameDuration = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_TALKBACK_CONTROL_REQ_T &msg)
+	{
+		msg = EASY_MSG_CS_TALKBACK_CONTROL_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_CS_TALKBACK_CONTROL_REQ, msg.header, &msg, SetCSTalkbackControlREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_TALKBACK_CONTROL_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SC_TALKBACK_CONTROL_ACK
+	void EasyEncodeMsg(const EASY_MSG_SC_TALKBACK_CONTROL_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (!msg.transport.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Transport\":", 12);
+			EasyMessageCodec::AppendString(out, msg.transport);
+		}
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_SC_TALKBACK_CONTROL_ACK\"", 44);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSCTalkbackControlACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SC_TALKBACK_CONTROL_ACK_T &msg = *(EASY_MSG_SC_TALKBACK_CONTROL_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			case 9:
+				if (memcmp(key.data(), "Transport", 9) == 0)	{ EasyMessageCodec::Assign(msg.transport, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_TALKBACK_CONTROL_ACK_T &msg)
+	{
+		msg = EASY_MSG_SC_TALKBACK_CONTROL_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SC_TALKBACK_CONTROL_ACK, msg.header, &msg, SetSCTalkbackControlACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_TALKBACK_CONTROL_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_SD_CONTROL_TALKBACK_REQ
+	void EasyEncodeMsg(const EASY_MSG_SD_CONTROL_TALKBACK_REQ_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"AudioData\":", 12);
+		EasyMessageCodec::AppendString(out, msg.audioData);
+		out += sep;
+		sep = ',';
+		out.append("\"AudioType\":", 12);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::TalkbackAudioTypes, msg.audioType);
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Command\":", 10);
+		EasyMessageCodec::AppendEnum(out, EasyProtocol::TalkbackCMDTypes, msg.command);
+		if (msg.frameDuration != -1)
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"FrameDuration\":", 16);
+			EasyMessageCodec::AppendInt(out, msg.frameDuration);
+		}
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Pts\":", 6);
+		EasyMessageCodec::AppendInt(out, msg.pts);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (!msg.transport.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Transport\":", 12);
+			EasyMessageCodec::AppendString(out, msg.transport);
+		}
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"MessageType\":\"MSG_SD_CONTROL_TALKBACK_REQ\"", 44);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetSDControlTalkbackREQ(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_SD_CONTROL_TALKBACK_REQ_T &msg = *(EASY_MSG_SD_CONTROL_TALKBACK_REQ_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 3:
+				if (memcmp(key.data(), "Pts", 3) == 0)	{ msg.pts = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Command", 7) == 0)	{ msg.command = EasyProtocol::TalkbackCMDTypes.Value(value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			case 9:
+				if (memcmp(key.data(), "AudioData", 9) == 0)	{ EasyMessageCodec::Assign(msg.audioData, value); return true; }
+				if (memcmp(key.data(), "AudioType", 9) == 0)	{ msg.audioType = EasyProtocol::TalkbackAudioTypes.Value(value); return true; }
+				if (memcmp(key.data(), "Transport", 9) == 0)	{ EasyMessageCodec::Assign(msg.transport, value); return true; }
+				break;
+			case 13:
+				if (memcmp(key.data(), "FrameDuration", 13) == 0)	{ msg.frameDuration = EasyMessageCodec::ToInt(value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_CONTROL_TALKBACK_REQ_T &msg)
+	{
+		msg = EASY_MSG_SD_CONTROL_TALKBACK_REQ_T();
+		return EasyMessageCodec::Decode(text, len, MSG_SD_CONTROL_TALKBACK_REQ, msg.header, &msg, SetSDControlTalkbackREQ, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_CONTROL_TALKBACK_REQ_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+
+	// MSG_DS_CONTROL_TALKBACK_ACK
+	void EasyEncodeMsg(const EASY_MSG_DS_CONTROL_TALKBACK_ACK_T &msg, std::string &out)
+	{
+		out.clear();
+		out.append("{\"EasyDarwin\":{", 15);
+
+		//no Body at all when nothing is in it, as with a DOM never given a body value
+		size_t mark = out.size();
+		out.append("\"Body\":", 7);
+		char sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"Channel\":", 10);
+		EasyMessageCodec::AppendString(out, msg.channel);
+		out += sep;
+		sep = ',';
+		out.append("\"Protocol\":", 11);
+		EasyMessageCodec::AppendString(out, msg.protocol);
+		out += sep;
+		sep = ',';
+		out.append("\"Reserve\":", 10);
+		EasyMessageCodec::AppendString(out, msg.reserve);
+		out += sep;
+		sep = ',';
+		out.append("\"Serial\":", 9);
+		EasyMessageCodec::AppendString(out, msg.serial);
+		if (!msg.transport.empty())
+		{
+			out += sep;
+			sep = ',';
+			out.append("\"Transport\":", 12);
+			EasyMessageCodec::AppendString(out, msg.transport);
+		}
+		if (sep == '{')	out.resize(mark);
+		else				out.append("},", 2);
+
+		out.append("\"Header\":", 9);
+		sep = '{';
+		out += sep;
+		sep = ',';
+		out.append("\"CSeq\":", 7);
+		EasyMessageCodec::AppendInt(out, msg.header.cseq);
+		out.append(",\"ErrorNum\":", 12);
+		EasyMessageCodec::AppendInt(out, msg.header.errorNum);
+		out.append(",\"ErrorString\":", 15);
+		EasyMessageCodec::AppendErrorString(out, msg.header);
+		out.append(",\"MessageType\":\"MSG_DS_CONTROL_TALKBACK_ACK\"", 44);
+		out.append(",\"Version\":", 11);
+		EasyMessageCodec::AppendString(out, msg.header.version);
+		out.append("}}}\n", 4);
+	}
+
+	static bool SetDSControlTalkbackACK(void *ptr, int section, int /*list*/, boost::string_ref key, boost::string_ref value)
+	{
+		EASY_MSG_DS_CONTROL_TALKBACK_ACK_T &msg = *(EASY_MSG_DS_CONTROL_TALKBACK_ACK_T *)ptr;
+		switch (section)
+		{
+		case EASY_MSG_SECTION_BODY:
+			switch (key.size())
+			{
+			case 6:
+				if (memcmp(key.data(), "Serial", 6) == 0)	{ EasyMessageCodec::Assign(msg.serial, value); return true; }
+				break;
+			case 7:
+				if (memcmp(key.data(), "Channel", 7) == 0)	{ EasyMessageCodec::Assign(msg.channel, value); return true; }
+				if (memcmp(key.data(), "Reserve", 7) == 0)	{ EasyMessageCodec::Assign(msg.reserve, value); return true; }
+				break;
+			case 8:
+				if (memcmp(key.data(), "Protocol", 8) == 0)	{ EasyMessageCodec::Assign(msg.protocol, value); return true; }
+				break;
+			case 9:
+				if (memcmp(key.data(), "Transport", 9) == 0)	{ EasyMessageCodec::Assign(msg.transport, value); return true; }
+				break;
+			}
+			break;
+		}
+		return true;
+	}
+
+	bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_CONTROL_TALKBACK_ACK_T &msg)
+	{
+		msg = EASY_MSG_DS_CONTROL_TALKBACK_ACK_T();
+		return EasyMessageCodec::Decode(text, len, MSG_DS_CONTROL_TALKBACK_ACK, msg.header, &msg, SetDSControlTalkbackACK, AddNone);
+	}
+
+	bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_CONTROL_TALKBACK_ACK_T &msg)
+	{
+		std::string buf(text);
+		return !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);
+	}
+}}//namespace
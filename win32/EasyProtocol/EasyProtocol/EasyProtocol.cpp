@@ -8,8 +8,61 @@
 #include <EasyProtocol.h>
 #include <EasyUtil.h>
 
+#ifdef _WIN32
+#include <windows.h>
+
+#define	_Lazy_Load(p)			(*(p))		//volatile reads acquire under /volatile:ms
+#define	_Lazy_Store(p, v)		InterlockedExchange((p), (v))
+#define	_Lazy_CAS(p, o, n)		(InterlockedCompareExchange((p), (n), (o)) == (o))
+#define	_Lazy_Yield()			Sleep(0)
+#else
+#include <sched.h>
+
+#define	_Lazy_Load(p)			__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define	_Lazy_Store(p, v)		__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define	_Lazy_CAS(p, o, n)		__sync_bool_compare_and_swap((p), (o), (n))
+#define	_Lazy_Yield()			sched_yield()
+#endif
+
+#define	EASY_LAZY_EMPTY			0
+#define	EASY_LAZY_BUILDING		1
+#define	EASY_LAZY_READY			2
+
 namespace EasyDarwin { namespace Protocol
 {
+	//true for the one caller that should build; the others wait until it is ready
+	static bool LazyBegin(volatile long *state)
+	{
+		while (_Lazy_Load(state) != EASY_LAZY_READY)
+		{
+			if (_Lazy_CAS(state, EASY_LAZY_EMPTY, EASY_LAZY_BUILDING))	return true;
+			_Lazy_Yield();
+		}
+		return false;
+	}
+
+	static void LazyEnd(volatile long *state)
+	{
+		_Lazy_Store(state, EASY_LAZY_READY);
+	}
+
+	//keeps GetHeaderValue/GetBodyValue working for messages read into an EasyDeviceTable; only for a
+	//complete table, whose scalars are all of Header and Body but the list
+	static void CopyTableValues(Json::Value &root, const EasyDeviceTable &table)
+	{
+		const vector<EasyJsonField>& header = table.GetHeader();
+		for (size_t i = 0; i < header.size(); i++)
+		{
+			root[EASY_TAG_ROOT][EASY_TAG_HEADER][header[i].first.to_string()] = header[i].second.to_string();
+		}
+
+		const vector<EasyJsonField>& body = table.GetBody();
+		for (size_t i = 0; i < body.size(); i++)
+		{
+			root[EASY_TAG_ROOT][EASY_TAG_BODY][body[i].first.to_string()] = body[i].second.to_string();
+		}
+	}
+
 	EasyDevice::EasyDevice()
 	{
 		snapJpgPath_.clear();
@@ -82,14 +135,16 @@ namespace EasyDarwin { namespace Protocol
 
 		nvr_.channels_.clear();
 
-		int size = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_CHANNELS].size();
+		Json::Value &list = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_CHANNELS];
+		int size = list.isArray() ? list.size() : 0;
 		for (int i = 0; i < size; i++)
 		{
-			Json::Value &json_camera = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_CHANNELS][i];
+			Json::Value &json_camera = list[i];
+			if (!json_camera.isObject())	continue;
 			EasyDevice channel;
-			channel.channel_ = json_camera[EASY_TAG_CHANNEL].asString();
-			channel.name_ = json_camera[EASY_TAG_NAME].asString();
-			channel.status_ = json_camera[EASY_TAG_STATUS].asString();
+			TextOf(json_camera[EASY_TAG_CHANNEL], channel.channel_);
+			TextOf(json_camera[EASY_TAG_NAME], channel.name_);
+			TextOf(json_camera[EASY_TAG_STATUS], channel.status_);
 			//nvr_.channels_.push_back(channel);
 			nvr_.channels_[channel.channel_] = channel;
 		}
@@ -255,6 +310,7 @@ namespace EasyDarwin { namespace Protocol
 	EasyMsgSCDeviceListACK::EasyMsgSCDeviceListACK(EasyDevices & devices, size_t cseq, size_t error)
 		: EasyProtocol(MSG_SC_DEVICE_LIST_ACK)
 		, devices_(devices)
+		, devicesState_(EASY_LAZY_READY)
 	{
 		SetHeaderValue(EASY_TAG_CSEQ, cseq);
 		SetHeaderValue(EASY_TAG_ERROR_NUM, error);
@@ -273,21 +329,33 @@ namespace EasyDarwin { namespace Protocol
 	}
 
 	EasyMsgSCDeviceListACK::EasyMsgSCDeviceListACK(const string& msg)
-		: EasyProtocol(msg, MSG_SC_DEVICE_LIST_ACK)
+		: EasyProtocol(MSG_SC_DEVICE_LIST_ACK)
+		, devicesState_(EASY_LAZY_EMPTY)
 	{
-		devices_.clear();
-		int size = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_DEVICES].size();
+		if (table_.ParseDeviceList(msg.c_str(), msg.size()) >= 0)
+		{
+			if (table_.IsComplete())	CopyTableValues(root, table_);
+			else						Read(msg, MSG_SC_DEVICE_LIST_ACK);		//members the table leaves out
+			return;
+		}
+
+		//not something the table reader accepts, let jsoncpp have it
+		Read(msg, MSG_SC_DEVICE_LIST_ACK);
+		devicesState_ = EASY_LAZY_READY;
+		Json::Value &list = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_DEVICES];
+		int size = list.isArray() ? list.size() : 0;
 
 		for (int i = 0; i < size; i++)
 		{
-			Json::Value &json_ = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_DEVICES][i];
+			Json::Value &json_ = list[i];
+			if (!json_.isObject())	continue;
 			EasyDevice device;
-			device.name_ = json_[EASY_TAG_NAME].asString();
-			device.serial_ = json_[EASY_TAG_SERIAL].asString();
-			device.tag_ = json_[EASY_TAG_TAG].asString();
-			device.snapJpgPath_ =  json_[EASY_TAG_SNAP_URL].asString();
-			device.appType_ =  json_[EASY_TAG_APP_TYPE].asString();
-			device.terminalType_ =  json_[EASY_TAG_TERMINAL_TYPE].asString();
+			TextOf(json_[EASY_TAG_NAME], device.name_);
+			TextOf(json_[EASY_TAG_SERIAL], device.serial_);
+			TextOf(json_[EASY_TAG_TAG], device.tag_);
+			TextOf(json_[EASY_TAG_SNAP_URL], device.snapJpgPath_);
+			TextOf(json_[EASY_TAG_APP_TYPE], device.appType_);
+			TextOf(json_[EASY_TAG_TERMINAL_TYPE], device.terminalType_);
 
 // 				"AppType" : "EasyCamera",
 //                "Name" : "HI3518C",
@@ -302,8 +370,31 @@ namespace EasyDarwin { namespace Protocol
 		}
 	}
 
+	EasyDevices& EasyMsgSCDeviceListACK::GetDevices()
+	{
+		if (LazyBegin(&devicesState_))
+		{
+			for (size_t i = 0; i < table_.Size(); i++)
+			{
+				const EASY_DEVICE_ENTRY_T& entry = table_[i];
+				EasyDevice device;
+				device.name_ = entry.name.to_string();
+				device.serial_ = entry.serial.to_string();
+				device.tag_ = entry.tag.to_string();
+				device.snapJpgPath_ = entry.snapURL.to_string();
+				device.appType_ = entry.appType.to_string();
+				device.terminalType_ = entry.terminalType.to_string();
+				devices_[device.serial_] = device;
+			}
+			LazyEnd(&devicesState_);
+		}
+		return devices_;
+	}
+
 	EasyMsgSCDeviceInfoACK::EasyMsgSCDeviceInfoACK(EasyDevices& cameras, const string& device_serial, size_t cseq, size_t error)
 		: EasyProtocol(MSG_SC_CAMERA_LIST_ACK)
+		, channels_(cameras)
+		, channelsState_(EASY_LAZY_READY)
 	{
 		SetHeaderValue(EASY_TAG_CSEQ, cseq);
 		SetHeaderValue(EASY_TAG_ERROR_NUM, error);
@@ -322,22 +413,52 @@ namespace EasyDarwin { namespace Protocol
 	}
 
 	EasyMsgSCDeviceInfoACK::EasyMsgSCDeviceInfoACK(const string& msg)
-		: EasyProtocol(msg, MSG_SC_CAMERA_LIST_ACK)
+		: EasyProtocol(MSG_SC_CAMERA_LIST_ACK)
+		, channelsState_(EASY_LAZY_EMPTY)
 	{
-		channels_.clear();
-		int size = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_CHANNELS].size();
+		if (table_.ParseDeviceInfo(msg.c_str(), msg.size()) >= 0)
+		{
+			if (table_.IsComplete())	CopyTableValues(root, table_);
+			else						Read(msg, MSG_SC_CAMERA_LIST_ACK);
+			return;
+		}
+
+		Read(msg, MSG_SC_CAMERA_LIST_ACK);
+		channelsState_ = EASY_LAZY_READY;
+		Json::Value &list = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_CHANNELS];
+		int size = list.isArray() ? list.size() : 0;
 
 		for (int i = 0; i < size; i++)
 		{
-			Json::Value &json_ = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_CHANNELS][i];
+			Json::Value &json_ = list[i];
+			if (!json_.isObject())	continue;
 			EasyDevice channel;
-			channel.name_ = json_[EASY_TAG_SERIAL].asString();
-			channel.serial_ = json_[EASY_TAG_NAME].asString();
-			channel.status_ = json_[EASY_TAG_STATUS].asString();
+			TextOf(json_[EASY_TAG_SERIAL], channel.name_);
+			TextOf(json_[EASY_TAG_NAME], channel.serial_);
+			TextOf(json_[EASY_TAG_STATUS], channel.status_);
 			channels_[channel.serial_] = channel;
 		}
 	}
 
+	EasyDevices& EasyMsgSCDeviceInfoACK::GetCameras()
+	{
+		if (LazyBegin(&channelsState_))
+		{
+			//same field mapping as the jsoncpp path above
+			for (size_t i = 0; i < table_.Size(); i++)
+			{
+				const EASY_DEVICE_ENTRY_T& entry = table_[i];
+				EasyDevice channel;
+				channel.name_ = entry.serial.to_string();
+				channel.serial_ = entry.name.to_string();
+				channel.status_ = entry.status.to_string();
+				channels_[channel.serial_] = channel;
+			}
+			LazyEnd(&channelsState_);
+		}
+		return channels_;
+	}
+
 	EasyMsgSCGetStreamACK::EasyMsgSCGetStreamACK(EasyJsonValue &body, size_t cseq, size_t error)
 		: EasyProtocol(MSG_SC_GET_STREAM_ACK)
 	{
@@ -720,16 +841,18 @@ namespace EasyDarwin { namespace Protocol
 			{
 				//channels_.clear();//һ䲻Ҫ߳bug
 				Json::Value *proot = proTemp.GetRoot();
-				int size = (*proot)[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_CHANNELS].size(); //С 
+				Json::Value &list = (*proot)[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_CHANNELS];
+				int size = list.isArray() ? list.size() : 0; //С 
 
 
 				for (int i = 0; i < size; i++)
 				{
-					Json::Value &json_camera = (*proot)[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_CHANNELS][i];
+					Json::Value &json_camera = list[i];
+					if (!json_camera.isObject())	continue;
 					EasyDevice camera;
-					camera.name_ = json_camera[EASY_TAG_NAME].asString();
-					camera.channel_ = json_camera[EASY_TAG_CHANNEL].asString();
-					camera.status_ = json_camera[EASY_TAG_STATUS].asString();
+					EasyProtocol::TextOf(json_camera[EASY_TAG_NAME], camera.name_);
+					EasyProtocol::TextOf(json_camera[EASY_TAG_CHANNEL], camera.channel_);
+					EasyProtocol::TextOf(json_camera[EASY_TAG_STATUS], camera.status_);
 
 					//channels_.push_back(camera);
 					//Ѿڣֻ޸status_ԣ뵽mapС1߳д̶߳üΪֲԤ֪мֵ  
@@ -12,12 +12,13 @@ Website: http://www.easydarwin.org
 */
 
 #include <EasyProtocolBase.h>
+#include <EasyJsonPool.h>
 #include <string.h>
 
 namespace EasyDarwin { namespace Protocol
 {
 
-	EasyProtocol::MsgType EasyProtocol::MsgTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::MsgTypeMap[] = {
 		MSG_DS_REGISTER_REQ,							"MSG_DS_REGISTER_REQ",
 		MSG_SD_REGISTER_ACK,							"MSG_SD_REGISTER_ACK",
 		MSG_SD_PUSH_STREAM_REQ,							"MSG_SD_PUSH_STREAM_REQ",
@@ -60,7 +61,7 @@ namespace EasyDarwin { namespace Protocol
 
 	};
 
-	EasyProtocol::MsgType EasyProtocol::ErrorMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::ErrorMap[] = {
 		EASY_ERROR_SUCCESS_OK,							"Success OK",
 		EASY_ERROR_SUCCESS_CREATED,						"Success Created",
 		EASY_ERROR_SUCCESS_ACCEPTED,					"Success Accepted",
@@ -101,22 +102,22 @@ namespace EasyDarwin { namespace Protocol
 		EASY_ERROR_PARAM_ERROR,							"Param Error"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::StatusMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::StatusMap[] = {
 		EASY_DEVICE_STATUS_OFFLINE,						"DEVICE_STATUS_OFFLINE",
 		EASY_DEVICE_STATUS_ONLINE,						"DEVICE_STATUS_ONLINE"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::ProtocolTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::ProtocolTypeMap[] = {
 		EASY_PROTOCOL_TYPE_RTSP,						"RTSP",
 		EASY_PROTOCOL_TYPE_HLS,							"HLS"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::MediaEncodeTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::MediaEncodeTypeMap[] = {
 		EASY_MEDIA_ENCODE_AUDIO_AAC,					"AAC",
 		EASY_MEDIA_ENCODE_VIDEO_H264,					"H264"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::TerminalTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::TerminalTypeMap[] = {
 		EASY_TERMINAL_TYPE_ARM,							"ARM_Linux",
 		EASY_TERMINAL_TYPE_Android,						"Android",
 		EASY_TERMINAL_TYPE_IOS,							"IOS",
@@ -126,23 +127,23 @@ namespace EasyDarwin { namespace Protocol
 
 	};
 
-	EasyProtocol::MsgType EasyProtocol::AppTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::AppTypeMap[] = {
 		EASY_APP_TYPE_CAMERA,							"EasyCamera",
 		EASY_APP_TYPE_NVR,								"EasyNVR",
 		EASY_APP_TYPE_EASYDARWIN,						"EasyDarwin"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::SnapTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::SnapTypeMap[] = {
 		EASY_SNAP_TYPE_JPEG,							"JPEG",
 		EASY_SNAP_TYPE_IDR,								"IDR"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::PTZActionTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::PTZActionTypeMap[] = {
 		EASY_PTZ_ACTION_TYPE_CONTINUOUS,                "CONTINUOUS",
 		EASY_PTZ_ACTION_TYPE_SINGLE,                    "SINGLE"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::PTZCMDTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::PTZCMDTypeMap[] = {
 		EASY_PTZ_CMD_TYPE_STOP,                         "STOP",
 		EASY_PTZ_CMD_TYPE_UP,                           "UP",
 		EASY_PTZ_CMD_TYPE_DOWN,                         "DOWN",
@@ -160,35 +161,49 @@ namespace EasyDarwin { namespace Protocol
 		EASY_PTZ_CMD_TYPE_APERTUREOUT,                  "APERTUREOUT"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::PresetCMDTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::PresetCMDTypeMap[] = {
 		EASY_PRESET_CMD_TYPE_GOTO,						"GOTO",
 		EASY_PRESET_CMD_TYPE_SET,						"SET",
 		EASY_PRESET_CMD_TYPE_REMOVE,					"REMOVE"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::TalkbackAudioTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::TalkbackAudioTypeMap[] = {
 		EASY_TALKBACK_AUDIO_TYPE_G711A,					"G711A",
 		EASY_TALKBACK_AUDIO_TYPE_G711U,					"G711U",
 		EASY_TALKBACK_AUDIO_TYPE_G726,					"G726"
 	};
 
-	EasyProtocol::MsgType EasyProtocol::TalkbackCMDTypeMap[] = {
+	const EasyProtocol::MsgType EasyProtocol::TalkbackCMDTypeMap[] = {
 		EASY_TALKBACK_CMD_TYPE_START,					"START",
 		EASY_TALKBACK_CMD_TYPE_SENDDATA,				"SENDDATA",
 		EASY_TALKBACK_CMD_TYPE_STOP,					"STOP"
 	};
 
+	const EasyTypeMap EasyProtocol::MsgTypes = EASY_TYPE_MAP_INIT(MsgTypeMap);
+	const EasyTypeMap EasyProtocol::Errors = EASY_TYPE_MAP_INIT(ErrorMap);
+	const EasyTypeMap EasyProtocol::Statuses = EASY_TYPE_MAP_INIT(StatusMap);
+	const EasyTypeMap EasyProtocol::ProtocolTypes = EASY_TYPE_MAP_INIT(ProtocolTypeMap);
+	const EasyTypeMap EasyProtocol::MediaEncodeTypes = EASY_TYPE_MAP_INIT(MediaEncodeTypeMap);
+	const EasyTypeMap EasyProtocol::TerminalTypes = EASY_TYPE_MAP_INIT(TerminalTypeMap);
+	const EasyTypeMap EasyProtocol::AppTypes = EASY_TYPE_MAP_INIT(AppTypeMap);
+	const EasyTypeMap EasyProtocol::SnapTypes = EASY_TYPE_MAP_INIT(SnapTypeMap);
+	const EasyTypeMap EasyProtocol::PTZActionTypes = EASY_TYPE_MAP_INIT(PTZActionTypeMap);
+	const EasyTypeMap EasyProtocol::PTZCMDTypes = EASY_TYPE_MAP_INIT(PTZCMDTypeMap);
+	const EasyTypeMap EasyProtocol::PresetCMDTypes = EASY_TYPE_MAP_INIT(PresetCMDTypeMap);
+	const EasyTypeMap EasyProtocol::TalkbackAudioTypes = EASY_TYPE_MAP_INIT(TalkbackAudioTypeMap);
+	const EasyTypeMap EasyProtocol::TalkbackCMDTypes = EASY_TYPE_MAP_INIT(TalkbackCMDTypeMap);
+
 	EasyProtocol::EasyProtocol(int iMsgType)
 		:fMsgType(iMsgType)
 	{
 		SetHeaderValue(EASY_TAG_VERSION, EASY_PROTOCOL_VERSION);
-		root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_MESSAGE_TYPE] = GetMsgTypeString(fMsgType);
+		boost::string_ref type = GetMsgTypeString(fMsgType);
+		root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_MESSAGE_TYPE] = Json::Value(type.data(), type.data() + type.size());
 	}
 
 	EasyProtocol::EasyProtocol(const std::string& msg, int iMsgType)
 	{
-		reader.parse(msg, root);
-		//json = msg;
+		Parse(msg);
 
 		if (iMsgType != -1)
 		{
@@ -207,7 +222,7 @@ namespace EasyDarwin { namespace Protocol
 
 	void EasyProtocol::Read(const std::string& msg, int iMsgType)
 	{
-		reader.parse(msg, root);
+		Parse(msg);
 
 		if (iMsgType != -1)
 		{
@@ -219,9 +234,64 @@ namespace EasyDarwin { namespace Protocol
 		}
 	}
 
+	void EasyProtocol::Parse(const std::string& msg)
+	{
+		//root may still point into the previous text_
+		root = Json::Value();
+		text_ = msg;
+
+		EasyPooledReader reader;
+		const char *begin = text_.data();
+		reader->parseBorrowed(begin, begin + text_.size(), root);
+		Normalize();
+	}
+
+	void EasyProtocol::Normalize()
+	{
+		if (!root.isObject())
+		{
+			root = Json::Value();
+			return;
+		}
+
+		if (!root.isMember(EASY_TAG_ROOT))	return;
+		Json::Value &message = root[EASY_TAG_ROOT];
+		if (!message.isObject())
+		{
+			root.removeMember(EASY_TAG_ROOT);
+			return;
+		}
+
+		if (message.isMember(EASY_TAG_HEADER) && !message[EASY_TAG_HEADER].isObject())	message.removeMember(EASY_TAG_HEADER);
+		if (message.isMember(EASY_TAG_BODY) && !message[EASY_TAG_BODY].isObject())		message.removeMember(EASY_TAG_BODY);
+	}
+
+	std::string EasyProtocol::TextOf(const Json::Value& value)
+	{
+		if (value.isObject() || value.isArray())	return std::string();
+		return value.asString();
+	}
+
+	void EasyProtocol::TextOf(const Json::Value& value, std::string& out)
+	{
+		const char *begin;
+		const char *end;
+		if (value.getString(&begin, &end))	out.assign(begin, end);
+		else								out = TextOf(value);
+	}
+
+	boost::string_ref EasyProtocol::ViewOf(const Json::Value& value)
+	{
+		const char *begin;
+		const char *end;
+		if (value.getString(&begin, &end))	return boost::string_ref(begin, end - begin);
+		return boost::string_ref();
+	}
+
 	void EasyProtocol::Reset()
 	{
 		root.clear();
+		text_.clear();
 		fMsgType = -1;
 	}
 
@@ -237,382 +307,170 @@ namespace EasyDarwin { namespace Protocol
 		return fMsgType;
 	}
 
-	std::string EasyProtocol::GetMsgTypeStr() const
+	boost::string_ref EasyProtocol::GetMsgTypeStr() const
 	{
 		return GetMsgTypeString(fMsgType);
 	}
 
-	std::string EasyProtocol::GetMsgTypeString(int type)
+	boost::string_ref EasyProtocol::GetMsgTypeString(int type)
 	{
-		for (int i = 0; i < sizeof(MsgTypeMap) / sizeof(MsgType); i++)
-		{
-			if (type == MsgTypeMap[i].value)
-			{
-				return std::string(MsgTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return MsgTypes.String(type);
 	}
 
 	int EasyProtocol::GetMessageType()
 	{
-		std::string sMessageType = root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_MESSAGE_TYPE].asString();
-
-		return GetMsgType(sMessageType);
+		return GetMsgType(ViewOf(root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_MESSAGE_TYPE]));
 	}
 
 	int EasyProtocol::GetAppType()
 	{
-		std::string sAppType = root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_APP_TYPE].asString();
-
-		return GetAppType(sAppType);
+		return GetAppType(ViewOf(root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_APP_TYPE]));
 	}
 
 	int EasyProtocol::GetTerminalType()
 	{
-		std::string sTerminalType = root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_TERMINAL_TYPE].asString();
-
-		return GetTerminalType(sTerminalType);
+		return GetTerminalType(ViewOf(root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_TERMINAL_TYPE]));
 	}
 
 	int EasyProtocol::GetMsgCSeq()
 	{
-		std::string cseq = root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_CSEQ].asString();
+		std::string cseq = TextOf(root[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_CSEQ]);
 		return atoi(cseq.c_str());
 	}
 
-	std::string EasyProtocol::GetErrorString(int error)
+	boost::string_ref EasyProtocol::GetErrorString(int error)
 	{
-		for (int i = 0; i < sizeof(ErrorMap) / sizeof(MsgType); i++)
-		{
-			if (error == ErrorMap[i].value)
-			{
-				return std::string(ErrorMap[i].str);
-			}
-		}
-
-		return std::string();
+		return Errors.String(error);
 	}
 
-	int EasyProtocol::GetMsgType(const std::string& sMessageType)
+	int EasyProtocol::GetMsgType(boost::string_ref sMessageType)
 	{
-		for (int i = 0; i < sizeof(MsgTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sMessageType.compare(MsgTypeMap[i].str) == 0)
-			{
-				return MsgTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return MsgTypes.Value(sMessageType);
 	}
 
-	std::string EasyProtocol::GetDeviceStatusString(int status)
+	boost::string_ref EasyProtocol::GetDeviceStatusString(int status)
 	{
-		for (int i = 0; i < sizeof(StatusMap) / sizeof(MsgType); i++)
-		{
-			if (status == StatusMap[i].value)
-			{
-				return std::string(StatusMap[i].str);
-			}
-		}
-
-		return std::string();
+		return Statuses.String(status);
 	}
 
-	int EasyProtocol::GetDeviceStatus(const std::string& sStatus)
+	int EasyProtocol::GetDeviceStatus(boost::string_ref sStatus)
 	{
-		for (int i = 0; i < sizeof(StatusMap) / sizeof(MsgType); i++)
-		{
-			if (sStatus.compare(StatusMap[i].str) == 0)
-			{
-				return StatusMap[i].value;
-			}
-		}
-
-		return -1;
+		return Statuses.Value(sStatus);
 	}
 
-	int EasyProtocol::GetProtocolType(const std::string& sProtocolType)
+	int EasyProtocol::GetProtocolType(boost::string_ref sProtocolType)
 	{
-		for (int i = 0; i < sizeof(ProtocolTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sProtocolType.compare(ProtocolTypeMap[i].str) == 0)
-			{
-				return ProtocolTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return ProtocolTypes.Value(sProtocolType);
 	}
 
-	std::string EasyProtocol::GetProtocolString(int iProtocolType)
+	boost::string_ref EasyProtocol::GetProtocolString(int iProtocolType)
 	{
-		for (int i = 0; i < sizeof(ProtocolTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iProtocolType == ProtocolTypeMap[i].value)
-			{
-				return std::string(ProtocolTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return ProtocolTypes.String(iProtocolType);
 	}
 
-	int EasyProtocol::GetMediaEncodeType(const std::string& sMediaEncode)
+	int EasyProtocol::GetMediaEncodeType(boost::string_ref sMediaEncode)
 	{
-		for (int i = 0; i < sizeof(MediaEncodeTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sMediaEncode.compare(MediaEncodeTypeMap[i].str) == 0)
-			{
-				return MediaEncodeTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return MediaEncodeTypes.Value(sMediaEncode);
 	}
 
-	std::string EasyProtocol::GetMediaEncodeTypeString(int iMediaEncodeType)
+	boost::string_ref EasyProtocol::GetMediaEncodeTypeString(int iMediaEncodeType)
 	{
-		for (int i = 0; i < sizeof(MediaEncodeTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iMediaEncodeType == MediaEncodeTypeMap[i].value)
-			{
-				return std::string(MediaEncodeTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return MediaEncodeTypes.String(iMediaEncodeType);
 	}
 
-	int EasyProtocol::GetTerminalType(const std::string& sTerminalType)
+	int EasyProtocol::GetTerminalType(boost::string_ref sTerminalType)
 	{
-		for (int i = 0; i < sizeof(TerminalTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sTerminalType.compare(TerminalTypeMap[i].str) == 0)
-			{
-				return TerminalTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return TerminalTypes.Value(sTerminalType);
 	}
 
-	std::string EasyProtocol::GetTerminalTypeString(int iTerminalType)
+	boost::string_ref EasyProtocol::GetTerminalTypeString(int iTerminalType)
 	{
-		for (int i = 0; i < sizeof(TerminalTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iTerminalType == TerminalTypeMap[i].value)
-			{
-				return std::string(TerminalTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return TerminalTypes.String(iTerminalType);
 	}
 
 
-	int EasyProtocol::GetAppType(const std::string& sAppType)
+	int EasyProtocol::GetAppType(boost::string_ref sAppType)
 	{
-		for (int i = 0; i < sizeof(AppTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sAppType.compare(AppTypeMap[i].str) == 0)
-			{
-				return AppTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return AppTypes.Value(sAppType);
 	}
 
 
-	std::string EasyProtocol::GetAppTypeString(int iAppType)
+	boost::string_ref EasyProtocol::GetAppTypeString(int iAppType)
 	{
-		for (int i = 0; i < sizeof(AppTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iAppType == AppTypeMap[i].value)
-			{
-				return std::string(AppTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return AppTypes.String(iAppType);
 	}
 
 
-	int EasyProtocol::GetSnapType(const std::string& sSnapType)
+	int EasyProtocol::GetSnapType(boost::string_ref sSnapType)
 	{
-		for (int i = 0; i < sizeof(SnapTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sSnapType.compare(SnapTypeMap[i].str) == 0)
-			{
-				return SnapTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return SnapTypes.Value(sSnapType);
 	}
 
 
-	std::string EasyProtocol::GetSnapTypeString(int iSnapType)
+	boost::string_ref EasyProtocol::GetSnapTypeString(int iSnapType)
 	{
-		for (int i = 0; i < sizeof(SnapTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iSnapType == SnapTypeMap[i].value)
-			{
-				return std::string(SnapTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return SnapTypes.String(iSnapType);
 	}
 
-	int EasyProtocol::GetPTZActionType(const std::string& sPTZActionType)
+	int EasyProtocol::GetPTZActionType(boost::string_ref sPTZActionType)
 	{
-		for (int i = 0; i < sizeof(PTZActionTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sPTZActionType.compare(PTZActionTypeMap[i].str) == 0)
-			{
-				return PTZActionTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return PTZActionTypes.Value(sPTZActionType);
 	}
 
-	std::string EasyProtocol::GetPTZActionTypeString(int iPTZActionType)
+	boost::string_ref EasyProtocol::GetPTZActionTypeString(int iPTZActionType)
 	{
-		for (int i = 0; i < sizeof(PTZActionTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iPTZActionType == PTZActionTypeMap[i].value)
-			{
-				return std::string(PTZActionTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return PTZActionTypes.String(iPTZActionType);
 	}
 
-	int EasyProtocol::GetPTZCMDType(const std::string& sPTZCMDType)
+	int EasyProtocol::GetPTZCMDType(boost::string_ref sPTZCMDType)
 	{
-		for (int i = 0; i < sizeof(PTZCMDTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sPTZCMDType.compare(PTZCMDTypeMap[i].str) == 0)
-			{
-				return PTZCMDTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return PTZCMDTypes.Value(sPTZCMDType);
 	}
 
-	std::string EasyProtocol::GetPTZCMDTypeString(int iPTZCMDType)
+	boost::string_ref EasyProtocol::GetPTZCMDTypeString(int iPTZCMDType)
 	{
-		for (int i = 0; i < sizeof(PTZCMDTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iPTZCMDType == PTZCMDTypeMap[i].value)
-			{
-				return std::string(PTZCMDTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return PTZCMDTypes.String(iPTZCMDType);
 	}
 
-	int EasyProtocol::GetPresetCMDType(const std::string& sPresetCMDType)
+	int EasyProtocol::GetPresetCMDType(boost::string_ref sPresetCMDType)
 	{
-		for (int i = 0; i < sizeof(PresetCMDTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sPresetCMDType.compare(PresetCMDTypeMap[i].str) == 0)
-			{
-				return PresetCMDTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return PresetCMDTypes.Value(sPresetCMDType);
 	}
 
-	std::string EasyProtocol::GetPresetCMDTypeString(int iPresetCMDType)
+	boost::string_ref EasyProtocol::GetPresetCMDTypeString(int iPresetCMDType)
 	{
-		for (int i = 0; i < sizeof(PresetCMDTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iPresetCMDType == PresetCMDTypeMap[i].value)
-			{
-				return std::string(PresetCMDTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return PresetCMDTypes.String(iPresetCMDType);
 	}
 
-	int EasyProtocol::GetTalkbackAudioType(const std::string& sTalkbackAudioType)
+	int EasyProtocol::GetTalkbackAudioType(boost::string_ref sTalkbackAudioType)
 	{
-		for (int i = 0; i < sizeof(TalkbackAudioTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sTalkbackAudioType.compare(TalkbackAudioTypeMap[i].str) == 0)
-			{
-				return TalkbackAudioTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return TalkbackAudioTypes.Value(sTalkbackAudioType);
 	}
 
-	std::string EasyProtocol::GetTalkbackAudioTypeString(int iTalkbackAudioType)
+	boost::string_ref EasyProtocol::GetTalkbackAudioTypeString(int iTalkbackAudioType)
 	{
-		for (int i = 0; i < sizeof(TalkbackAudioTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iTalkbackAudioType == TalkbackAudioTypeMap[i].value)
-			{
-				return std::string(TalkbackAudioTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return TalkbackAudioTypes.String(iTalkbackAudioType);
 	}
 
-	int EasyProtocol::GetTalkbackCMDType(const std::string& sTalkbackCMDType)
+	int EasyProtocol::GetTalkbackCMDType(boost::string_ref sTalkbackCMDType)
 	{
-		for (int i = 0; i < sizeof(TalkbackCMDTypeMap) / sizeof(MsgType); i++)
-		{
-			if (sTalkbackCMDType.compare(TalkbackCMDTypeMap[i].str) == 0)
-			{
-				return TalkbackCMDTypeMap[i].value;
-			}
-		}
-
-		return -1;
+		return TalkbackCMDTypes.Value(sTalkbackCMDType);
 	}
 
-	std::string EasyProtocol::GetTalkbackCMDTypeString(int iTalkbackCMDType)
+	boost::string_ref EasyProtocol::GetTalkbackCMDTypeString(int iTalkbackCMDType)
 	{
-		for (int i = 0; i < sizeof(TalkbackCMDTypeMap) / sizeof(MsgType); i++)
-		{
-			if (iTalkbackCMDType == TalkbackCMDTypeMap[i].value)
-			{
-				return std::string(TalkbackCMDTypeMap[i].str);
-			}
-		}
-
-		return std::string();
+		return TalkbackCMDTypes.String(iTalkbackCMDType);
 	}
 
 	std::string EasyProtocol::GetMsg()
 	{
-		return writer.write(root);
+		EasyPooledWriter writer;
+		return writer->Write(root);
 	}
 
 	bool EasyProtocol::GetMsg(char *dest, int size)
 	{
-		std::string msg = GetMsg();
-		if (msg.empty() || msg.size() > size)
-		{
-			return false;
-		}
-		strncpy(dest, msg.c_str(), size);
-
-		return true;
+		return EasyJsonWriter::Write(root, dest, size) >= 0;
 	}
 
 	/*
@@ -631,12 +489,12 @@ namespace EasyDarwin { namespace Protocol
 
 	std::string EasyProtocol::GetHeaderValue(const char* tag)
 	{
-		return root[EASY_TAG_ROOT][EASY_TAG_HEADER][tag].asString();
+		return TextOf(root[EASY_TAG_ROOT][EASY_TAG_HEADER][tag]);
 	}
 
 	std::string EasyProtocol::GetBodyValue(const char* tag)
 	{
-		return root[EASY_TAG_ROOT][EASY_TAG_BODY][tag].asString();
+		return TextOf(root[EASY_TAG_ROOT][EASY_TAG_BODY][tag]);
 	}
 
 }}//namespace
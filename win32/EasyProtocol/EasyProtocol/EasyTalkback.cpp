@@ -0,0 +1,450 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyTalkback.cpp
+*/
+
+#include <EasyTalkback.h>
+#include <EasyProtocol.h>
+#include <EasyUtil.h>
+#include <EasyG711.h>
+#include <string.h>
+
+namespace EasyDarwin { namespace Protocol
+{
+	EasyTalkbackSender::EasyTalkbackSender()
+		: audioType_(EASY_TALKBACK_AUDIO_TYPE_G711A)
+		, samplerate_(8000)
+		, batchMs_(EASY_TALKBACK_DEFAULT_BATCH)
+		, batchSamples_(0)
+		, opened_(false)
+		, stream_(false)
+		, pendingPts_(0)
+		, pendingNow_(0)
+		, samplesIn_(0)
+		, paceStarted_(false)
+		, paceNow_(0)
+		, pacePts_(0)
+		, cseq_(1)
+		, seq_(0)
+		, wireBytes_(0)
+		, frames_(0)
+	{
+	}
+
+	EasyTalkbackSender::~EasyTalkbackSender()
+	{
+		Close();
+	}
+
+	int EasyTalkbackSender::Open(const string& serial, const string& channel, const string& protocol, const string& host,
+		int audioType, unsigned int samplerate, int batchMs)
+	{
+		if (audioType != EASY_TALKBACK_AUDIO_TYPE_G711A && audioType != EASY_TALKBACK_AUDIO_TYPE_G711U)	return -1;
+		if (samplerate < 1000 || batchMs < 10 || samplerate * batchMs / 1000 > EASY_TALKBACK_MAX_PAYLOAD)	return -1;
+
+		Close();
+
+		serial_ = serial;
+		channel_ = channel;
+		protocol_ = protocol;
+		host_ = host;
+		audioType_ = audioType;
+		samplerate_ = samplerate;
+		batchMs_ = batchMs;
+		batchSamples_ = samplerate * batchMs / 1000;
+		pending_.reserve(batchSamples_);
+		opened_ = true;
+
+		return 0;
+	}
+
+	void EasyTalkbackSender::Close()
+	{
+		opened_ = false;
+		stream_ = false;
+		pending_.clear();
+		queue_.clear();
+		samplesIn_ = 0;
+		paceStarted_ = false;
+		cseq_ = 1;
+		seq_ = 0;
+		wireBytes_ = 0;
+		frames_ = 0;
+	}
+
+	string EasyTalkbackSender::HttpPost(const string& host, const string& body)
+	{
+		string req = "POST / HTTP/1.1\r\nHost:";
+		req += host;
+		req += "\r\nContent-Type:text/plain;charset=utf-8\r\nContent-Length:";
+		req += EasyUtil::Int2String((int)body.size());
+		req += "\r\nConnection:Keep-Alive\r\n\r\n";
+		req += body;
+		return req;
+	}
+
+	string EasyTalkbackSender::BuildRequest(int cmd, const string& audioData, unsigned int pts)
+	{
+		EasyJsonValue body;
+		body[EASY_TAG_SERIAL] = serial_;
+		body[EASY_TAG_CHANNEL] = channel_;
+		body[EASY_TAG_CMD] = EasyProtocol::GetTalkbackCMDTypeString(cmd).to_string();
+		body[EASY_TAG_AUDIO_TYPE] = EasyProtocol::GetTalkbackAudioTypeString(audioType_).to_string();
+		body[EASY_TAG_PROTOCOL] = protocol_;
+		body[EASY_TAG_RESERVE] = string("1");
+		body[EASY_TAG_AUDIO_DATA] = audioData;
+		body[EASY_TAG_PTS] = EasyUtil::Int2String((int)pts);
+		if (cmd == EASY_TALKBACK_CMD_TYPE_START)
+		{
+			body[EASY_TAG_TRANSPORT] = string(EASY_TALKBACK_TRANSPORT_STREAM);
+			body[EASY_TAG_FRAME_DURATION] = EasyUtil::Int2String(batchMs_);
+		}
+
+		EasyMsgCSTalkbackControlREQ req(body, cseq_++);
+		return HttpPost(host_, req.GetMsg());
+	}
+
+	string EasyTalkbackSender::BuildStart()
+	{
+		if (!opened_)	return string();
+
+		stream_ = false;
+		return BuildRequest(EASY_TALKBACK_CMD_TYPE_START, string(), 0);
+	}
+
+	int EasyTalkbackSender::OnStartAck(const string& msg)
+	{
+		EasyMsgSCTalkbackControlACK ack(msg);
+		if (ack.GetMessageType() != MSG_SC_TALKBACK_CONTROL_ACK)	return -1;
+
+		string error = ack.GetHeaderValue(EASY_TAG_ERROR_NUM);
+		if (!error.empty() && EasyUtil::String2Int(error) != EASY_ERROR_SUCCESS_OK)	return -1;
+
+		//old servers do not echo the transport and stay on JSON
+		stream_ = (ack.GetBodyValue(EASY_TAG_TRANSPORT) == EASY_TALKBACK_TRANSPORT_STREAM);
+		return 0;
+	}
+
+	void EasyTalkbackSender::QueuePending()
+	{
+		if (pending_.empty())	return;
+
+		TALKBACK_FRAME_T frame;
+		frame.pts = pendingPts_;
+		queue_.push_back(frame);
+		queue_.back().payload.swap(pending_);
+		pending_.reserve(batchSamples_);
+	}
+
+	int EasyTalkbackSender::Write(const short *pcm, int samples, unsigned int nowMs, string& out)
+	{
+		if (!opened_ || NULL == pcm || samples < 0)	return -1;
+
+		if ((int)encBuf_.size() < samples)	encBuf_.resize(samples);
+		if (samples > 0)
+		{
+			if (audioType_ == EASY_TALKBACK_AUDIO_TYPE_G711U)	EasyG711::ULawEncode(&encBuf_[0], pcm, samples);
+			else												EasyG711::ALawEncode(&encBuf_[0], pcm, samples);
+		}
+
+		int offset = 0;
+		while (offset < samples)
+		{
+			if (pending_.empty())
+			{
+				pendingPts_ = (unsigned int)(samplesIn_ * 1000 / samplerate_);
+				pendingNow_ = nowMs;
+			}
+
+			int count = batchSamples_ - (int)pending_.size();
+			if (count > samples - offset)	count = samples - offset;
+
+			pending_.append((const char *)&encBuf_[offset], count);
+			offset += count;
+			samplesIn_ += count;
+
+			if ((int)pending_.size() >= batchSamples_)	QueuePending();
+		}
+
+		return Poll(nowMs, out);
+	}
+
+	int EasyTalkbackSender::Poll(unsigned int nowMs, string& out)
+	{
+		if (!opened_)	return -1;
+
+		//nagle timer: do not hold a partial batch longer than one batch time
+		if (!pending_.empty() && (int)(nowMs - pendingNow_) >= batchMs_)	QueuePending();
+
+		int bytes = 0;
+		while (!queue_.empty())
+		{
+			TALKBACK_FRAME_T& frame = queue_.front();
+			if (!paceStarted_)
+			{
+				paceStarted_ = true;
+				paceNow_ = nowMs;
+				pacePts_ = frame.pts;
+			}
+
+			int media = (int)(frame.pts - pacePts_);
+			int real = (int)(nowMs - paceNow_);
+			if (media > real + EASY_TALKBACK_PACING_LEAD)	break;
+
+			//capture or poll stalled: restart the pacing clock on this frame rather than burst the backlog
+			if (real - media > EASY_TALKBACK_PACING_RESET)
+			{
+				paceNow_ = nowMs;
+				pacePts_ = frame.pts;
+			}
+
+			bytes += Emit(frame, out);
+			queue_.pop_front();
+		}
+
+		return bytes;
+	}
+
+	int EasyTalkbackSender::Emit(const TALKBACK_FRAME_T& frame, string& out)
+	{
+		size_t before = out.size();
+
+		if (stream_)
+		{
+			unsigned char header[EASY_TALKBACK_FRAME_HEADER];
+			unsigned int len = (unsigned int)frame.payload.size();
+			header[0] = 'E';
+			header[1] = 'T';
+			header[2] = EASY_TALKBACK_FRAME_AUDIO;
+			header[3] = (unsigned char)audioType_;
+			header[4] = (unsigned char)(seq_ >> 8);
+			header[5] = (unsigned char)(seq_);
+			header[6] = (unsigned char)(frame.pts >> 24);
+			header[7] = (unsigned char)(frame.pts >> 16);
+			header[8] = (unsigned char)(frame.pts >> 8);
+			header[9] = (unsigned char)(frame.pts);
+			header[10] = (unsigned char)(len >> 8);
+			header[11] = (unsigned char)(len);
+
+			out.append((const char *)header, sizeof(header));
+			out.append(frame.payload);
+		}
+		else
+		{
+			out += BuildRequest(EASY_TALKBACK_CMD_TYPE_SENDDATA, EasyUtil::Base64Encode(frame.payload.data(), frame.payload.size()), frame.pts);
+		}
+
+		seq_++;
+		frames_++;
+		wireBytes_ += out.size() - before;
+
+		return (int)(out.size() - before);
+	}
+
+	int EasyTalkbackSender::BuildStop(string& out)
+	{
+		if (!opened_)	return -1;
+
+		size_t before = out.size();
+
+		QueuePending();
+		while (!queue_.empty())
+		{
+			Emit(queue_.front(), out);
+			queue_.pop_front();
+		}
+
+		unsigned int pts = (unsigned int)(samplesIn_ * 1000 / samplerate_);
+		if (stream_)
+		{
+			unsigned char header[EASY_TALKBACK_FRAME_HEADER];
+			header[0] = 'E';
+			header[1] = 'T';
+			header[2] = EASY_TALKBACK_FRAME_STOP;
+			header[3] = (unsigned char)audioType_;
+			header[4] = (unsigned char)(seq_ >> 8);
+			header[5] = (unsigned char)(seq_);
+			header[6] = (unsigned char)(pts >> 24);
+			header[7] = (unsigned char)(pts >> 16);
+			header[8] = (unsigned char)(pts >> 8);
+			header[9] = (unsigned char)(pts);
+			header[10] = 0;
+			header[11] = 0;
+			out.append((const char *)header, sizeof(header));
+		}
+		else
+		{
+			out += BuildRequest(EASY_TALKBACK_CMD_TYPE_STOP, string(), pts);
+		}
+
+		wireBytes_ += out.size() - before;
+		return (int)(out.size() - before);
+	}
+
+	EasyTalkbackReceiver::EasyTalkbackReceiver()
+		: samplerate_(8000)
+		, prebuffer_(0)
+		, maxBuffer_(0)
+		, buffering_(true)
+		, stopped_(false)
+		, inPos_(0)
+		, pcmPos_(0)
+		, havePts_(false)
+		, nextPts_(0)
+		, lostMs_(0)
+		, resyncs_(0)
+	{
+	}
+
+	EasyTalkbackReceiver::~EasyTalkbackReceiver()
+	{
+		Close();
+	}
+
+	int EasyTalkbackReceiver::Open(unsigned int samplerate, int prebufferMs, int maxMs)
+	{
+		if (samplerate < 1000 || prebufferMs < 0 || maxMs <= prebufferMs)	return -1;
+
+		Close();
+
+		samplerate_ = samplerate;
+		prebuffer_ = samplerate * prebufferMs / 1000;
+		maxBuffer_ = samplerate * maxMs / 1000;
+
+		return 0;
+	}
+
+	void EasyTalkbackReceiver::Close()
+	{
+		buffering_ = true;
+		stopped_ = false;
+		in_.clear();
+		inPos_ = 0;
+		pcm_.clear();
+		pcmPos_ = 0;
+		havePts_ = false;
+		nextPts_ = 0;
+		lostMs_ = 0;
+		resyncs_ = 0;
+	}
+
+	int EasyTalkbackReceiver::GetBufferedMs()
+	{
+		return (int)((pcm_.size() - pcmPos_) * 1000 / samplerate_);
+	}
+
+	int EasyTalkbackReceiver::Input(const char *data, int len)
+	{
+		if (NULL == data || len < 0)	return -1;
+
+		in_.append(data, len);
+
+		int frames = 0;
+		const unsigned char *p = (const unsigned char *)in_.data();
+		while (in_.size() - inPos_ >= EASY_TALKBACK_FRAME_HEADER)
+		{
+			const unsigned char *h = p + inPos_;
+			unsigned int length = (h[10] << 8) | h[11];
+			if (h[0] != 'E' || h[1] != 'T' || length > EASY_TALKBACK_MAX_PAYLOAD ||
+				(h[2] != EASY_TALKBACK_FRAME_AUDIO && h[2] != EASY_TALKBACK_FRAME_STOP))
+			{
+				//corrupt stream, look for the next magic
+				inPos_++;
+				resyncs_++;
+				continue;
+			}
+			if (in_.size() - inPos_ < EASY_TALKBACK_FRAME_HEADER + length)	break;
+
+			if (h[2] == EASY_TALKBACK_FRAME_STOP)
+			{
+				stopped_ = true;
+			}
+			else
+			{
+				unsigned int pts = ((unsigned int)h[6] << 24) | ((unsigned int)h[7] << 16) | ((unsigned int)h[8] << 8) | h[9];
+				PutFrame(h[3], pts, h + EASY_TALKBACK_FRAME_HEADER, length);
+			}
+
+			inPos_ += EASY_TALKBACK_FRAME_HEADER + length;
+			frames++;
+		}
+
+		if (inPos_ > 0 && inPos_ * 2 >= in_.size())
+		{
+			in_.erase(0, inPos_);
+			inPos_ = 0;
+		}
+
+		return frames;
+	}
+
+	void EasyTalkbackReceiver::PutFrame(int audioType, unsigned int pts, const unsigned char *payload, int len)
+	{
+		if (audioType != EASY_TALKBACK_AUDIO_TYPE_G711A && audioType != EASY_TALKBACK_AUDIO_TYPE_G711U)	return;
+
+		if (havePts_)
+		{
+			int gap = (int)(pts - nextPts_);
+			if (gap < 0)	return;		//duplicate or late
+
+			//conceal lost audio with silence, never more than the buffer can hold
+			if (gap > 0)
+			{
+				lostMs_ += gap;
+				int silence = (int)((unsigned long long)gap * samplerate_ / 1000);
+				if (silence > maxBuffer_)	silence = maxBuffer_;
+				pcm_.insert(pcm_.end(), silence, 0);
+			}
+		}
+		havePts_ = true;
+		nextPts_ = pts + (unsigned int)((unsigned long long)len * 1000 / samplerate_);
+
+		size_t size = pcm_.size();
+		pcm_.resize(size + len);
+		if (audioType == EASY_TALKBACK_AUDIO_TYPE_G711U)	EasyG711::ULawDecode(&pcm_[size], payload, len);
+		else												EasyG711::ALawDecode(&pcm_[size], payload, len);
+
+		//sender clock faster than ours or a burst after a stall: drop the oldest audio
+		int buffered = (int)(pcm_.size() - pcmPos_);
+		if (buffered > maxBuffer_)	pcmPos_ += buffered - prebuffer_;
+	}
+
+	int EasyTalkbackReceiver::Read(short *pcm, int samples)
+	{
+		if (NULL == pcm || samples < 0)	return -1;
+
+		int buffered = (int)(pcm_.size() - pcmPos_);
+		if (buffering_)
+		{
+			if (buffered < prebuffer_ + samples && !(stopped_ && buffered > 0))
+			{
+				memset(pcm, 0x00, samples * sizeof(short));
+				return 0;
+			}
+			buffering_ = false;
+		}
+
+		int count = buffered < samples ? buffered : samples;
+		if (count > 0)	memcpy(pcm, &pcm_[pcmPos_], count * sizeof(short));
+		if (count < samples)
+		{
+			//underrun, build up the jitter buffer again
+			memset(pcm + count, 0x00, (samples - count) * sizeof(short));
+			buffering_ = true;
+		}
+		pcmPos_ += count;
+
+		if (pcmPos_ > 0 && pcmPos_ * 2 >= pcm_.size())
+		{
+			pcm_.erase(pcm_.begin(), pcm_.begin() + pcmPos_);
+			pcmPos_ = 0;
+		}
+
+		return count;
+	}
+}}//namespace
@@ -0,0 +1,131 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyTypeMap.cpp
+*/
+
+#include <EasyTypeMap.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+#define	_Map_Load(p)			(*(p))		//volatile reads acquire under /volatile:ms
+#define	_Map_Store(p, v)		InterlockedExchange((p), (v))
+#define	_Map_CAS(p, o, n)		(InterlockedCompareExchange((p), (n), (o)) == (o))
+#define	_Map_Yield()			Sleep(0)
+#else
+#include <sched.h>
+
+#define	_Map_Load(p)			__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define	_Map_Store(p, v)		__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define	_Map_CAS(p, o, n)		__sync_bool_compare_and_swap((p), (o), (n))
+#define	_Map_Yield()			sched_yield()
+#endif
+
+#define	EASY_TYPE_MAP_EMPTY		0
+#define	EASY_TYPE_MAP_BUILDING	1
+#define	EASY_TYPE_MAP_READY		2
+
+namespace EasyDarwin { namespace Protocol
+{
+	void EasyTypeMap::Ready() const
+	{
+		while (_Map_Load(&state_) != EASY_TYPE_MAP_READY)
+		{
+			if (_Map_CAS(&state_, EASY_TYPE_MAP_EMPTY, EASY_TYPE_MAP_BUILDING))
+			{
+				Build();
+				_Map_Store(&state_, EASY_TYPE_MAP_READY);
+				return;
+			}
+			_Map_Yield();
+		}
+	}
+
+	void EasyTypeMap::Build() const
+	{
+		//at most half the slots in use keeps probe chains short
+		mask_ = 1;
+		while (mask_ + 1 < (unsigned int)count_ * 2)	mask_ = mask_ * 2 + 1;
+
+		memset(strSlots_, 0, sizeof(strSlots_));
+		memset(valueSlots_, 0, sizeof(valueSlots_));
+
+		for (int i = 0; i < count_; i++)
+		{
+			size_t len = strlen(entries_[i].str);		//wire strings are short, see EASY_TYPE_MAP_MAX_LEN
+			lens_[i] = (unsigned char)len;
+
+			if (FindString(boost::string_ref(entries_[i].str, lens_[i])) < 0)
+			{
+				unsigned int slot = HashString(boost::string_ref(entries_[i].str, lens_[i])) & mask_;
+				while (strSlots_[slot] != 0)	slot = (slot + 1) & mask_;
+				strSlots_[slot] = (unsigned char)(i + 1);
+			}
+
+			if (FindValue(entries_[i].value) < 0)
+			{
+				unsigned int slot = HashValue(entries_[i].value) & mask_;
+				while (valueSlots_[slot] != 0)	slot = (slot + 1) & mask_;
+				valueSlots_[slot] = (unsigned char)(i + 1);
+			}
+		}
+	}
+
+	int EasyTypeMap::Value(boost::string_ref str) const
+	{
+		Ready();
+		int i = FindString(str);
+		return i < 0 ? -1 : entries_[i].value;
+	}
+
+	boost::string_ref EasyTypeMap::String(int value) const
+	{
+		Ready();
+		int i = FindValue(value);
+		return i < 0 ? boost::string_ref() : boost::string_ref(entries_[i].str, lens_[i]);
+	}
+
+	int EasyTypeMap::FindString(boost::string_ref str) const
+	{
+		for (unsigned int slot = HashString(str) & mask_; strSlots_[slot] != 0; slot = (slot + 1) & mask_)
+		{
+			int i = strSlots_[slot] - 1;
+			if (lens_[i] == str.size() && memcmp(entries_[i].str, str.data(), str.size()) == 0)	return i;
+		}
+		return -1;
+	}
+
+	int EasyTypeMap::FindValue(int value) const
+	{
+		for (unsigned int slot = HashValue(value) & mask_; valueSlots_[slot] != 0; slot = (slot + 1) & mask_)
+		{
+			int i = valueSlots_[slot] - 1;
+			if (entries_[i].value == value)	return i;
+		}
+		return -1;
+	}
+
+	//FNV-1a
+	unsigned int EasyTypeMap::HashString(boost::string_ref str)
+	{
+		unsigned int hash = 2166136261u;
+		for (size_t i = 0; i < str.size(); i++)
+		{
+			hash ^= (unsigned char)str[i];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	//Fibonacci hashing, the enums are small and often consecutive
+	unsigned int EasyTypeMap::HashValue(int value)
+	{
+		return ((unsigned int)value * 2654435769u) >> 16;
+	}
+}}//namespace
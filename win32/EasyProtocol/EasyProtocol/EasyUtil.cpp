@@ -27,9 +27,8 @@
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
-#include <boost/archive/iterators/base64_from_binary.hpp>  
-#include <boost/archive/iterators/binary_from_base64.hpp>  
-#include <boost/archive/iterators/transform_width.hpp>
+#include <algorithm>
+#include <EasyBase64.h>
 
 std::string EasyUtil::TimeT2String(EasyDarwinTimeFormat whatFormat, unsigned long time)
 {
@@ -167,117 +166,67 @@ std::string EasyUtil::Int2String(int value)
 
 bool EasyUtil::Base64Decode(const std::string &sInput, string &sOutput)
 {
-	typedef boost::archive::iterators::transform_width<boost::archive::iterators::binary_from_base64<string::const_iterator>, 8, 6> Base64DecodeIterator;
-	stringstream result;
-	try
-	{
-		copy(Base64DecodeIterator(sInput.begin()), Base64DecodeIterator(sInput.end()), ostream_iterator<char>(result));
-	}
-	catch (...)
+	string result;
+	result.resize(EasyBase64::DecodeLength(sInput.size()));
+	int len = result.empty() ? -1 : EasyBase64::Decode((unsigned char *)&result[0], result.size(), sInput.data(), sInput.size());
+	if (len < 0)
 	{
 		return false;
 	}
-	sOutput = result.str();
+	result.resize(len);
+	sOutput.swap(result);
 
 	return !sOutput.empty();
 }
 
 bool EasyUtil::Base64Encode(const std::string &sInput, string &sOutput)
 {
-	typedef boost::archive::iterators::base64_from_binary<boost::archive::iterators::transform_width<string::const_iterator, 6, 8> > Base64EncodeIterator;
-	stringstream result;
-	copy(Base64EncodeIterator(sInput.begin()), Base64EncodeIterator(sInput.end()), ostream_iterator<char>(result));
-	size_t equal_count = (3 - sInput.length() % 3) % 3;
-	for (size_t i = 0; i < equal_count; i++)
+	sOutput.resize(EasyBase64::EncodeLength(sInput.size()));
+	if (!sOutput.empty())
 	{
-		result.put('=');
+		EasyBase64::Encode(&sOutput[0], sOutput.size(), (const unsigned char *)sInput.data(), sInput.size());
 	}
-	sOutput = result.str();
 
 	return !sOutput.empty();
 }
 
 string EasyUtil::Base64Encode(const char* src, size_t len)
 {
-	string sInput, sOutput;
-	sInput.assign(src, len);
-	Base64Encode(sInput, sOutput);
+	string sOutput;
+	sOutput.resize(EasyBase64::EncodeLength(len));
+	if (!sOutput.empty())
+	{
+		EasyBase64::Encode(&sOutput[0], sOutput.size(), (const unsigned char *)src, len);
+	}
 	return sOutput;
 }
 
 string EasyUtil::Base64Decode(const char* src, size_t len)
 {
-	try
-	{
-		string sInput, sOutput;
-		sInput.assign(src, len);
-		Base64Decode(sInput, sOutput);
-		return sOutput;
-	}
-	catch (std::exception &e)
-	{
-		printf("util::Base64Decode error: %s\n", e.what());
-	}
-	catch (...)
+	string sOutput;
+	sOutput.resize(EasyBase64::DecodeLength(len));
+	int ret = sOutput.empty() ? -1 : EasyBase64::Decode((unsigned char *)&sOutput[0], sOutput.size(), src, len);
+	if (ret < 0)
 	{
-		printf("util::Base64Decode error\n");
+		return std::string();
 	}
-	return std::string();
+	sOutput.resize(ret);
+	return sOutput;
 }
 
 string EasyUtil::Base64Encode(const string &sInput)
 {
-	typedef boost::archive::iterators::base64_from_binary<boost::archive::iterators::transform_width<string::const_iterator, 6, 8> > Base64EncodeIterator;
-	stringstream result;
-	copy(Base64EncodeIterator(sInput.begin()), Base64EncodeIterator(sInput.end()), ostream_iterator<char>(result));
-	size_t equal_count = (3 - sInput.length() % 3) % 3;
-	for (size_t i = 0; i < equal_count; i++)
-	{
-		result.put('=');
-	}
-
-	return result.str();
+	return Base64Encode(sInput.data(), sInput.size());
 }
 
 string EasyUtil::Base64Decode(const string &sInput)
 {
-	typedef boost::archive::iterators::transform_width<boost::archive::iterators::binary_from_base64<string::const_iterator>, 8, 6> Base64DecodeIterator;
-	stringstream result;
-	try
-	{
-		string temp = sInput;
-		int endIndex = temp.size() - 1;
-		if (temp[endIndex] == '=')
-		{
-			temp.erase(endIndex);
-		}
-
-		endIndex = temp.size() - 1;
-		if (temp[endIndex] == '=')
-		{
-			temp.erase(endIndex);
-		}
-
-		copy(Base64DecodeIterator(temp.begin()), Base64DecodeIterator(temp.end()), ostream_iterator<char>(result));
-	}
-	catch (...)
-	{
-		return string();
-	}
-
-	return result.str();
+	return Base64Decode(sInput.data(), sInput.size());
 }
 
 void EasyUtil::DelChar(std::string & sInput, char ch)
 {
-	int begin = 0;
-	begin = sInput.find(ch, begin);//查找ch在sInput的第一个位置
-
-	while (begin != std::string::npos)  //表示字符串中存在ch
-	{
-		sInput.replace(begin, 1, "");  // 用空串替换sInput中从begin开始的1个字符
-		begin = sInput.find(ch, begin);  //查找ch在替换后的sInput中第一次出现的位置
-	}
+	sInput.erase(std::remove(sInput.begin(), sInput.end(), ch), sInput.end());
 }
 
 //decode url
@@ -0,0 +1,488 @@
+/*
+	Copyright (c) 2013-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   ProtocolBench.cpp
+*/
+
+#include "ProtocolBench.h"
+#include <EasyUtil.h>
+#include <EasyMessages.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+
+#ifdef _WIN64
+#define	_Heap_Add(p, v)			((size_t)InterlockedExchangeAdd64((volatile LONG64 *)(p), (LONG64)(v)))
+#define	_Heap_CAS(p, o, n)		(InterlockedCompareExchange64((volatile LONG64 *)(p), (LONG64)(n), (LONG64)(o)) == (LONG64)(o))
+#else
+#define	_Heap_Add(p, v)			((size_t)InterlockedExchangeAdd((volatile LONG *)(p), (LONG)(v)))
+#define	_Heap_CAS(p, o, n)		(InterlockedCompareExchange((volatile LONG *)(p), (LONG)(n), (LONG)(o)) == (LONG)(o))
+#endif
+#else
+#define	_Heap_Add(p, v)			__sync_fetch_and_add((p), (v))
+#define	_Heap_CAS(p, o, n)		__sync_bool_compare_and_swap((p), (o), (n))
+#endif
+
+using namespace std;
+using namespace EasyDarwin::Protocol;
+
+//every block carries its size in front. The HTTP and fetch benchmarks allocate from
+//worker threads, so the counters are only changed with atomic adds
+size_t g_heapCurrent = 0;
+size_t g_heapPeak = 0;
+size_t g_heapAllocations = 0;
+size_t g_heapBytes = 0;
+
+void* operator new(size_t size)
+{
+	size_t *block = (size_t *)malloc(size + 16);
+	if (NULL == block)	throw std::bad_alloc();
+	block[0] = size;
+	_Heap_Add(&g_heapAllocations, 1);
+	_Heap_Add(&g_heapBytes, size);
+	size_t current = _Heap_Add(&g_heapCurrent, size) + size;
+	for (size_t peak = g_heapPeak; current > peak; peak = g_heapPeak)
+	{
+		if (_Heap_CAS(&g_heapPeak, peak, current))	break;
+	}
+	return (char *)block + 16;
+}
+
+void operator delete(void *ptr) throw()
+{
+	if (NULL == ptr)	return;
+	size_t *block = (size_t *)((char *)ptr - 16);
+	_Heap_Add(&g_heapCurrent, 0 - block[0]);
+	free(block);
+}
+
+//what C++14 compilers call when they know the size; the block knows it too
+void operator delete(void *ptr, size_t) throw()
+{
+	operator delete(ptr);
+}
+
+//keeps the timed work from being optimized away
+static volatile size_t benchSink;
+
+static EasyDevices MakeDevices(int count)
+{
+	EasyDevices devices;
+	char serial[16], name[32], snap[96];
+	for (int i = 0; i < count; i++)
+	{
+		sprintf(serial, "%012d", i);
+		sprintf(name, "camera %d", i);
+		sprintf(snap, "http://snap.easydarwin.org/%012d/%012d_0_20160811155829.JPEG", i, i);
+		EasyDevice device(serial, name, "online");
+		device.tag_ = "dev";
+		device.snapJpgPath_ = snap;
+		device.appType_ = "EasyCamera";
+		device.terminalType_ = "ARM_Linux";
+		devices[device.serial_] = device;
+	}
+	return devices;
+}
+
+static void StreamAckBody(EasyJsonValue &body)
+{
+	body[EASY_TAG_SERIAL] = string("001001000010");
+	body[EASY_TAG_CHANNEL] = string("0");
+	body[EASY_TAG_PROTOCOL] = string("RTSP");
+	body[EASY_TAG_RESERVE] = string("1");
+	body[EASY_TAG_URL] = string("rtsp://cms.easydarwin.org:554/001001000010/0.sdp");
+}
+
+//one G.711 packet of audioBytes, 8 bytes a millisecond
+static void TalkbackBody(EasyJsonValue &body, int audioBytes)
+{
+	string audio(audioBytes, '\0');
+	for (int i = 0; i < audioBytes; i++)	audio[i] = (char)(i * 37 + 11);
+
+	body[EASY_TAG_SERIAL] = string("001001000010");
+	body[EASY_TAG_CHANNEL] = string("0");
+	body[EASY_TAG_PROTOCOL] = string("ONVIF");
+	body[EASY_TAG_CMD] = EasyProtocol::GetTalkbackCMDTypeString(EASY_TALKBACK_CMD_TYPE_SENDDATA).to_string();
+	body[EASY_TAG_AUDIO_TYPE] = EasyProtocol::GetTalkbackAudioTypeString(EASY_TALKBACK_AUDIO_TYPE_G711A).to_string();
+	body[EASY_TAG_AUDIO_DATA] = EasyUtil::Base64Encode(audio.data(), audio.size());
+	body[EASY_TAG_PTS] = 1470902309;
+	body[EASY_TAG_RESERVE] = string("1");
+}
+
+class DeviceListCase : public BenchCase
+{
+public:
+	DeviceListCase(const string &name, int devices)
+		: BenchCase(name)
+		, devices_(MakeDevices(devices))
+		, built_(devices_)
+	{
+		text_ = ProtocolBench::DeviceListPayload(devices);
+	}
+
+	virtual void Build()
+	{
+		EasyMsgSCDeviceListACK ack(devices_);
+	}
+
+	virtual void Serialize()
+	{
+		benchSink = built_.GetMsg().size();
+	}
+
+	virtual void Parse()
+	{
+		EasyMsgSCDeviceListACK ack(text_);
+		benchSink = ack.GetDevices().size();
+	}
+
+private:
+	EasyDevices devices_;
+	EasyMsgSCDeviceListACK built_;
+};
+
+class DeviceInfoCase : public BenchCase
+{
+public:
+	DeviceInfoCase(const string &name, int channels)
+		: BenchCase(name)
+		, channels_(MakeDevices(channels))
+		, built_(channels_, "001001000010")
+	{
+		text_ = ProtocolBench::DeviceInfoPayload(channels);
+	}
+
+	virtual void Build()
+	{
+		EasyMsgSCDeviceInfoACK ack(channels_, "001001000010");
+	}
+
+	virtual void Serialize()
+	{
+		benchSink = built_.GetMsg().size();
+	}
+
+	virtual void Parse()
+	{
+		EasyMsgSCDeviceInfoACK ack(text_);
+		benchSink = ack.GetCameras().size();
+	}
+
+private:
+	EasyDevices channels_;
+	EasyMsgSCDeviceInfoACK built_;
+};
+
+class StreamAckCase : public BenchCase
+{
+public:
+	StreamAckCase(const string &name)
+		: BenchCase(name)
+		, built_(Body())
+	{
+		text_ = ProtocolBench::StreamAckPayload();
+	}
+
+	virtual void Build()
+	{
+		EasyMsgSCGetStreamACK ack(body_);
+	}
+
+	virtual void Serialize()
+	{
+		benchSink = built_.GetMsg().size();
+	}
+
+	virtual void Parse()
+	{
+		EasyMsgSCGetStreamACK ack(text_);
+		benchSink = ack.GetBodyValue(EASY_TAG_URL).size() + ack.GetHeaderValue(EASY_TAG_ERROR_NUM).size();
+	}
+
+private:
+	EasyJsonValue& Body()
+	{
+		StreamAckBody(body_);
+		return body_;
+	}
+
+	EasyJsonValue body_;
+	EasyMsgSCGetStreamACK built_;
+};
+
+class TalkbackCase : public BenchCase
+{
+public:
+	TalkbackCase(const string &name, int audioBytes)
+		: BenchCase(name)
+		, built_(Body(audioBytes))
+	{
+		text_ = ProtocolBench::TalkbackPayload(audioBytes);
+	}
+
+	virtual void Build()
+	{
+		EasyMsgCSTalkbackControlREQ req(body_);
+	}
+
+	virtual void Serialize()
+	{
+		benchSink = built_.GetMsg().size();
+	}
+
+	virtual void Parse()
+	{
+		EasyMsgCSTalkbackControlREQ req(text_);
+		benchSink = req.GetBodyValue(EASY_TAG_AUDIO_DATA).size() + req.GetBodyValue(EASY_TAG_PTS).size();
+	}
+
+private:
+	EasyJsonValue& Body(int audioBytes)
+	{
+		TalkbackBody(body_, audioBytes);
+		return body_;
+	}
+
+	EasyJsonValue body_;
+	EasyMsgCSTalkbackControlREQ built_;
+};
+
+ProtocolBench::ProtocolBench(double seconds)
+	: seconds_(seconds)
+{
+	//the names are the keys of a saved run, keep them stable
+	cases_.push_back(new DeviceListCase("device_list_16", 16));
+	cases_.push_back(new DeviceListCase("device_list_1000", 1000));
+	cases_.push_back(new DeviceInfoCase("device_info_64", 64));
+	cases_.push_back(new StreamAckCase("stream_ack"));
+	cases_.push_back(new TalkbackCase("talkback_20ms", 160));
+	cases_.push_back(new TalkbackCase("talkback_160ms", 1280));
+}
+
+ProtocolBench::~ProtocolBench()
+{
+	for (size_t i = 0; i < cases_.size(); i++)	delete cases_[i];
+}
+
+void ProtocolBench::Run(vector<BENCH_RESULT_T> &results)
+{
+	results.clear();
+	for (size_t i = 0; i < cases_.size(); i++)
+	{
+		BenchCase &bench = *cases_[i];
+		BENCH_RESULT_T result;
+		result.name = bench.Name();
+		result.bytes = bench.Text().size();
+		result.buildPerSec = Time(bench, &BenchCase::Build, result.buildAllocs);
+		result.serializePerSec = Time(bench, &BenchCase::Serialize, result.serializeAllocs);
+		result.parsePerSec = Time(bench, &BenchCase::Parse, result.parseAllocs);
+		results.push_back(result);
+	}
+}
+
+double ProtocolBench::Time(BenchCase &bench, void (BenchCase::*phase)(), double &allocs)
+{
+	(bench.*phase)();		//warm the pools
+
+	//double the batch until it runs long enough, then keep the best of five batches
+	int count = 1;
+	double best = 0;
+	for (int pass = 0; pass < 5; )
+	{
+		size_t before = g_heapAllocations;
+		clock_t start = clock();
+		for (int i = 0; i < count; i++)	(bench.*phase)();
+		double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+		allocs = (double)(g_heapAllocations - before) / count;
+
+		if (seconds < seconds_)
+		{
+			count *= 2;
+			continue;
+		}
+		if (count / seconds > best)	best = count / seconds;
+		pass++;
+	}
+	return best;
+}
+
+void ProtocolBench::Print(const vector<BENCH_RESULT_T> &results)
+{
+	printf("%-18s %8s %12s %12s %12s %8s %8s %8s\n", "case", "bytes", "build/s", "serialize/s", "parse/s", "b-alloc", "s-alloc", "p-alloc");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BENCH_RESULT_T &r = results[i];
+		printf("%-18s %8u %12.0f %12.0f %12.0f %8.1f %8.1f %8.1f\n", r.name.c_str(), (unsigned int)r.bytes,
+			r.buildPerSec, r.serializePerSec, r.parsePerSec, r.buildAllocs, r.serializeAllocs, r.parseAllocs);
+	}
+}
+
+bool ProtocolBench::Save(const char *path, const vector<BENCH_RESULT_T> &results)
+{
+	FILE *file = fopen(path, "w");
+	if (NULL == file)	return false;
+
+	fprintf(file, "#case bytes build/s serialize/s parse/s build-allocs serialize-allocs parse-allocs\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BENCH_RESULT_T &r = results[i];
+		fprintf(file, "%s %u %.0f %.0f %.0f %.2f %.2f %.2f\n", r.name.c_str(), (unsigned int)r.bytes,
+			r.buildPerSec, r.serializePerSec, r.parsePerSec, r.buildAllocs, r.serializeAllocs, r.parseAllocs);
+	}
+	return fclose(file) == 0;
+}
+
+int ProtocolBench::Compare(const char *path, const vector<BENCH_RESULT_T> &results, double tolerance)
+{
+	FILE *file = fopen(path, "r");
+	if (NULL == file)	return -1;
+
+	vector<BENCH_RESULT_T> baseline;
+	char line[512], name[128];
+	unsigned int bytes;
+	while (fgets(line, sizeof(line), file))
+	{
+		BENCH_RESULT_T r;
+		if (line[0] == '#' || sscanf(line, "%127s %u %lf %lf %lf %lf %lf %lf", name, &bytes,
+			&r.buildPerSec, &r.serializePerSec, &r.parsePerSec, &r.buildAllocs, &r.serializeAllocs, &r.parseAllocs) != 8)
+		{
+			continue;
+		}
+		r.name = name;
+		r.bytes = bytes;
+		baseline.push_back(r);
+	}
+	fclose(file);
+
+	int regressions = 0;
+	const char *phases[] = {"build", "serialize", "parse"};
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BENCH_RESULT_T &now = results[i];
+		const BENCH_RESULT_T *then = NULL;
+		for (size_t j = 0; j < baseline.size() && NULL == then; j++)
+		{
+			if (baseline[j].name == now.name)	then = &baseline[j];
+		}
+		if (NULL == then)
+		{
+			printf("%s: not in the baseline\n", now.name.c_str());
+			continue;
+		}
+
+		double nowRate[] = {now.buildPerSec, now.serializePerSec, now.parsePerSec};
+		double thenRate[] = {then->buildPerSec, then->serializePerSec, then->parsePerSec};
+		double nowAllocs[] = {now.buildAllocs, now.serializeAllocs, now.parseAllocs};
+		double thenAllocs[] = {then->buildAllocs, then->serializeAllocs, then->parseAllocs};
+		for (int p = 0; p < 3; p++)
+		{
+			if (nowRate[p] < thenRate[p] * (1 - tolerance))
+			{
+				printf("REGRESSION %s %s: %.0f -> %.0f msg/s (%.1f%%)\n", now.name.c_str(), phases[p],
+					thenRate[p], nowRate[p], (nowRate[p] / thenRate[p] - 1) * 100);
+				regressions++;
+			}
+			//allocation counts do not jitter, anything over rounding is real
+			if (nowAllocs[p] > thenAllocs[p] + 0.5)
+			{
+				printf("REGRESSION %s %s: %.1f -> %.1f allocations/msg\n", now.name.c_str(), phases[p], thenAllocs[p], nowAllocs[p]);
+				regressions++;
+			}
+		}
+	}
+	return regressions;
+}
+
+static bool WriteFile(const char *dir, const char *name, const string &text)
+{
+	string path = string(dir) + "/" + name + ".json";
+	FILE *file = fopen(path.c_str(), "wb");
+	if (NULL == file)	return false;
+
+	bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+	return fclose(file) == 0 && ok;
+}
+
+bool ProtocolBench::WriteCorpus(const char *dir)
+{
+	bool ok = true;
+	for (size_t i = 0; i < cases_.size(); i++)
+	{
+		ok = WriteFile(dir, cases_[i]->Name().c_str(), cases_[i]->Text()) && ok;
+	}
+
+	string text;
+#define EASY_WRITE_TYPED(type, T)	\
+	{	\
+		T msg;	\
+		EasyEncodeMsg(msg, text);	\
+		ok = WriteFile(dir, #type, text) && ok;	\
+	}
+	EASY_MSG_FOR_EACH(EASY_WRITE_TYPED)
+#undef EASY_WRITE_TYPED
+
+	return ok;
+}
+
+string ProtocolBench::DeviceListPayload(int devices)
+{
+	string msg = "{\"EasyDarwin\":{\"Body\":{\"DeviceCount\":\"";
+	msg += EasyValueText(devices).Str();
+	msg += "\",\"Devices\":[";
+
+	char buf[512];
+	for (int i = 0; i < devices; i++)
+	{
+		sprintf(buf, "%s{\"AppType\":\"EasyCamera\",\"Name\":\"camera %d\",\"Serial\":\"%012d\","
+			"\"SnapURL\":\"http://snap.easydarwin.org/%012d/%012d_0_20160811155829.JPEG\",\"Tag\":\"dev\",\"TerminalType\":\"ARM_Linux\"}",
+			i == 0 ? "" : ",", i, i, i, i);
+		msg += buf;
+	}
+
+	msg += "]},\"Header\":{\"CSeq\":\"1\",\"ErrorNum\":\"200\",\"ErrorString\":\"Success OK\",\"MessageType\":\"MSG_SC_DEVICE_LIST_ACK\",\"Version\":\"v1.0\"}}}";
+	return msg;
+}
+
+string ProtocolBench::DeviceInfoPayload(int channels)
+{
+	string msg = "{\"EasyDarwin\":{\"Body\":{\"ChannelCount\":\"";
+	msg += EasyValueText(channels).Str();
+	msg += "\",\"Channels\":[";
+
+	char buf[512];
+	for (int i = 0; i < channels; i++)
+	{
+		sprintf(buf, "%s{\"Channel\":\"%d\",\"Name\":\"channel %d\","
+			"\"SnapURL\":\"http://snap.easydarwin.org/001001000010/001001000010_%d_20160811155829.JPEG\",\"Status\":\"%s\"}",
+			i == 0 ? "" : ",", i, i, i, (i % 7) ? "online" : "offline");
+		msg += buf;
+	}
+
+	msg += "],\"Serial\":\"001001000010\"},\"Header\":{\"CSeq\":\"1\",\"ErrorNum\":\"200\",\"ErrorString\":\"Success OK\",\"MessageType\":\"MSG_SC_DEVICE_INFO_ACK\",\"Version\":\"v1.0\"}}}";
+	return msg;
+}
+
+string ProtocolBench::StreamAckPayload()
+{
+	EasyJsonValue body;
+	StreamAckBody(body);
+	EasyMsgSCGetStreamACK ack(body);
+	return ack.GetMsg();
+}
+
+string ProtocolBench::TalkbackPayload(int audioBytes)
+{
+	EasyJsonValue body;
+	TalkbackBody(body, audioBytes);
+	EasyMsgCSTalkbackControlREQ req(body);
+	return req.GetMsg();
+}
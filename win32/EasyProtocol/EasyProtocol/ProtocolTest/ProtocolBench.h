@@ -0,0 +1,94 @@
+/*
+	Copyright (c) 2013-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   ProtocolBench.h
+ *
+ * Throughput and allocation benchmark over the payloads EasyProtocol sees in
+ * practice: device lists, NVR device info, stream ACKs and talkback packets.
+ * Every case is timed for build (message object from native data), serialize
+ * (GetMsg) and parse (message object from the text, fields read back). A run
+ * can be saved and later runs compared against it.
+ */
+
+#ifndef PROTOCOLBENCH_H
+#define	PROTOCOLBENCH_H
+
+#include <EasyProtocol.h>
+#include <string>
+#include <vector>
+
+//heap accounting, operator new is replaced in ProtocolBench.cpp
+extern size_t g_heapCurrent;
+extern size_t g_heapPeak;
+extern size_t g_heapAllocations;
+extern size_t g_heapBytes;			//requested since start
+
+typedef struct __BENCH_RESULT_T
+{
+	std::string name;
+	size_t bytes;				//text of one message
+	double buildPerSec;
+	double serializePerSec;
+	double parsePerSec;
+	double buildAllocs;			//per message
+	double serializeAllocs;
+	double parseAllocs;
+}BENCH_RESULT_T;
+
+class BenchCase
+{
+public:
+	BenchCase(const std::string &name) : name_(name) {}
+	virtual ~BenchCase() {}
+
+	const std::string& Name() const { return name_; }
+	const std::string& Text() const { return text_; }
+
+	//message object from native data
+	virtual void Build() = 0;
+	//GetMsg of a message built once
+	virtual void Serialize() = 0;
+	//message object from Text(), with the fields a caller reads
+	virtual void Parse() = 0;
+
+protected:
+	std::string name_;
+	std::string text_;
+};
+
+class ProtocolBench
+{
+public:
+	//every phase runs at least seconds of CPU time
+	ProtocolBench(double seconds = 0.2);
+	~ProtocolBench();
+
+	void Run(std::vector<BENCH_RESULT_T> &results);
+
+	static void Print(const std::vector<BENCH_RESULT_T> &results);
+	static bool Save(const char *path, const std::vector<BENCH_RESULT_T> &results);
+	//number of regressions against a saved run: throughput under (1 - tolerance)
+	//of the baseline, or more allocations per message; -1 if path is unreadable
+	static int Compare(const char *path, const std::vector<BENCH_RESULT_T> &results, double tolerance);
+
+	//seed inputs for ProtocolFuzz: the case payloads and one of each typed message
+	bool WriteCorpus(const char *dir);
+
+	//deterministic payloads
+	static std::string DeviceListPayload(int devices);
+	static std::string DeviceInfoPayload(int channels);
+	static std::string StreamAckPayload();
+	static std::string TalkbackPayload(int audioBytes);
+
+private:
+	double Time(BenchCase &bench, void (BenchCase::*phase)(), double &allocs);
+
+	double seconds_;
+	std::vector<BenchCase*> cases_;
+};
+
+#endif	/* PROTOCOLBENCH_H */
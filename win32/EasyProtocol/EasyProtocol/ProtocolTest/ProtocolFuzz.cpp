@@ -0,0 +1,155 @@
+/*
+	Copyright (c) 2013-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   ProtocolFuzz.cpp
+ *
+ * libFuzzer target over everything that reads protocol text: EasyProtocol
+ * and Read, the text constructor of every EasyMsg* class with the getters
+ * behind it, strDevice::GetDevInfo, and the typed decoders of EasyMessages.h.
+ * A typed message that decodes must also survive encode and decode again
+ * unchanged. "make fuzz" builds it with clang; with EASY_FUZZ_REPLAY defined
+ * any compiler builds a main that runs the files named on the command line,
+ * for replaying a corpus or a crash.
+*/
+
+#include <EasyProtocol.h>
+#include <EasyMessages.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace EasyDarwin::Protocol;
+
+//what a caller does with a parsed message
+static void Touch(EasyProtocol &msg)
+{
+	msg.GetMsgType();
+	msg.GetMsgTypeStr();
+	msg.GetAppType();
+	msg.GetTerminalType();
+	msg.GetMsgCSeq();
+	msg.GetHeaderValue(EASY_TAG_ERROR_NUM);
+	msg.GetBodyValue(EASY_TAG_SERIAL);
+	msg.GetBodyValue(EASY_TAG_URL);
+
+	char buf[256];
+	msg.GetMsg(buf, sizeof(buf));
+	msg.GetMsg();
+}
+
+template <class T>
+static void TouchTyped(const string &text)
+{
+	T msg;
+	if (!EasyDecodeMsg(text, msg))	return;
+
+	string once, twice;
+	EasyEncodeMsg(msg, once);
+	T again;
+	if (!EasyDecodeMsg(once, again))	abort();
+	EasyEncodeMsg(again, twice);
+	if (once != twice)	abort();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size)
+{
+	string text((const char *)data, size);
+
+	{
+		EasyProtocol msg(text);
+		Touch(msg);
+		msg.Read(text, MSG_SC_DEVICE_LIST_ACK);
+		Touch(msg);
+	}
+	{
+		EasyMsgDSRegisterREQ msg(text);
+		msg.GetNVR();
+		Touch(msg);
+	}
+	{
+		EasyMsgSCDeviceListACK msg(text);
+		msg.GetDevices();
+		msg.GetDeviceTable().Size();
+		Touch(msg);
+	}
+	{
+		EasyMsgSCDeviceInfoACK msg(text);
+		msg.GetCameras();
+		msg.GetDeviceTable().Size();
+		Touch(msg);
+	}
+	{
+		strDevice device;
+		device.GetDevInfo(text);
+	}
+
+#define EASY_FUZZ_MSG(T)	\
+	{	\
+		T msg(text);	\
+		Touch(msg);	\
+	}
+	EASY_FUZZ_MSG(EasyMsgSDRegisterACK)
+	EASY_FUZZ_MSG(EasyMsgSDPushStreamREQ)
+	EASY_FUZZ_MSG(EasyMsgDSPushSteamACK)
+	EASY_FUZZ_MSG(EasyMsgSDStopStreamREQ)
+	EASY_FUZZ_MSG(EasyMsgDSStopStreamACK)
+	EASY_FUZZ_MSG(EasyMsgSCGetStreamACK)
+	EASY_FUZZ_MSG(EasyMsgCSFreeStreamREQ)
+	EASY_FUZZ_MSG(EasyMsgSCFreeStreamACK)
+	EASY_FUZZ_MSG(EasyMsgDSPostSnapREQ)
+	EASY_FUZZ_MSG(EasyMsgSDPostSnapACK)
+	EASY_FUZZ_MSG(EasyMsgCSPTZControlREQ)
+	EASY_FUZZ_MSG(EasyMsgSCPTZControlACK)
+	EASY_FUZZ_MSG(EasyMsgSDControlPTZREQ)
+	EASY_FUZZ_MSG(EasyMsgDSControlPTZACK)
+	EASY_FUZZ_MSG(EasyMsgCSPresetControlREQ)
+	EASY_FUZZ_MSG(EasyMsgSCPresetControlACK)
+	EASY_FUZZ_MSG(EasyMsgSDControlPresetREQ)
+	EASY_FUZZ_MSG(EasyMsgDSControlPresetACK)
+	EASY_FUZZ_MSG(EasyMsgCSTalkbackControlREQ)
+	EASY_FUZZ_MSG(EasyMsgSCTalkbackControlACK)
+	EASY_FUZZ_MSG(EasyMsgSDControlTalkbackREQ)
+	EASY_FUZZ_MSG(EasyMsgDSControlTalkbackACK)
+	EASY_FUZZ_MSG(EasyMsgSCStartHLSACK)
+	EASY_FUZZ_MSG(EasyMsgSCHLSessionListACK)
+	EASY_FUZZ_MSG(EasyMsgSCRTSPPushSessionListACK)
+	EASY_FUZZ_MSG(EasyMsgSCListRecordACK)
+#undef EASY_FUZZ_MSG
+
+#define EASY_FUZZ_TYPED(type, T)	TouchTyped<T>(text);
+	EASY_MSG_FOR_EACH(EASY_FUZZ_TYPED)
+#undef EASY_FUZZ_TYPED
+
+	return 0;
+}
+
+#ifdef EASY_FUZZ_REPLAY
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		FILE *file = fopen(argv[i], "rb");
+		if (NULL == file)
+		{
+			printf("cannot read %s\n", argv[i]);
+			return 1;
+		}
+
+		vector<unsigned char> data;
+		unsigned char buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), file)) > 0)	data.insert(data.end(), buf, buf + n);
+		fclose(file);
+
+		LLVMFuzzerTestOneInput(data.empty() ? buf : &data[0], data.size());
+	}
+	printf("%d inputs ran\n", argc - 1);
+	return 0;
+}
+#endif
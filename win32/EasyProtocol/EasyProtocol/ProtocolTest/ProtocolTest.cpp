@@ -14,9 +14,35 @@
 #include <sstream>
 
 #include "ProtocolTest.h"
+#include "ProtocolBench.h"
 
 #include <iostream>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <ctype.h>
+#include <algorithm>
+#include <EasyBase64.h>
+#include <EasyG711.h>
+#include <EasyTalkback.h>
+#include <EasyMessages.h>
+#include <EasyJsonReader.h>
+#include <EasyDeviceRegistry.h>
+#include <EasyHttpClient.h>
+#include <EasyFetchScheduler.h>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <pthread.h>
+#endif
+#include <boost/archive/iterators/base64_from_binary.hpp>
+#include <boost/archive/iterators/transform_width.hpp>
 using namespace std;
 
 using namespace EasyDarwin::Protocol;
@@ -35,48 +61,6 @@ void ProtocolTest::PrintMsg(const char* msg)
     cout << msg << endl;
 }
 
-//void ProtocolTest::TestCreateSessionAck()
-//{
-//    //use namepace 
-//    EasyDarwin::Protocol::EasyDSSCreateSessionAck msgpack;
-//    cout << "****************test CreateSessionAck pack*****************" << endl;
-//    msgpack.Pack(1000, "10000100010001", "www.easydss.org", 554, EASYDARWIN_ERROR_SUCCESS_OK);    
-//    PrintMsg(msgpack.GetMsg().c_str());  
-//    
-//    cout << "****************test CreateSessionAck parse*****************" << endl;
-//    EasyDSSCreateSessionAck msgparse(msgpack.GetMsg().c_str());
-//    cout << "Version: " << msgparse.GetVersion() <<endl;
-//    cout << "CSeq: " << msgparse.GetCSeq() << endl;
-//    cout << "SessionID: " << msgparse.GetSessionID() << endl;
-//    cout << "ServerAddress: " << msgparse.GetRedirectServerAddress() << endl;
-//    cout << "ServerPort: " << msgparse.GetRedirectServerPort() << endl;
-//    cout << "ErrorNum: " << msgparse.GetErrorNum() << endl;
-//    cout << "ErrorString: " << msgparse.GetErrorString() << endl;
-//}
-//
-//void ProtocolTest::TestCreateSessionReq()
-//{
-//    EasyDSSCreateSessionReq msg;
-//    cout << "****************test CreateSessionReq pack*****************" << endl;
-//    msg.Pack(100, EASYDARWIN_APP_TYPE_PC, EASYDARWIN_TERMINAL_TYPE_USER);    
-//    
-//    string buffer = msg.GetMsg();
-//    
-//    PrintMsg(buffer.c_str());  
-//
-//    cout << "****************test CreateSessionReq parse*****************" << endl;
-//    EasyDSSCreateSessionAck msgparse(buffer.c_str());
-//    //some tag not exist, will report a log
-//    cout << "Version: " << msgparse.GetVersion() <<endl;
-//    cout << "TerminalType: " << msgparse.GetTerminalType() << endl;
-//    cout << "CSeq: " << msgparse.GetCSeq() << endl;
-//    cout << "SessionID: " << msgparse.GetSessionID() << endl;
-//    cout << "ServerAddress: " << msgparse.GetRedirectServerAddress() << endl;
-//    cout << "ServerPort: " << msgparse.GetRedirectServerPort() << endl;
-//    cout << "ErrorNum: " << msgparse.GetErrorNum() << endl;
-//    cout << "ErrorString: " << msgparse.GetErrorString() << endl;    
-//}
-
 void ProtocolTest::TestRegisterReq()
 {
 	EasyDevices channels;
@@ -86,76 +70,72 @@ void ProtocolTest::TestRegisterReq()
 		char name[20];
 		sprintf(name, "camera00%i", i + 1);
 		EasyDevice camera(name, name, "online");
-		channels.push_back(camera);
+		camera.channel_ = name;
+		channels[name] = camera;
 	}
 
-	EasyNVR nvr("nvr001", "nvr001_", "123456", channels);
+	EasyNVR nvr("nvr001", "nvr001_", "123456", "dev", channels);
 	
-
-	EasyDarwinRegisterReq req(nvr);
-
+	EasyMsgDSRegisterREQ req(EASY_TERMINAL_TYPE_ARM, EASY_APP_TYPE_NVR, nvr);
 
 	string msg = req.GetMsg();
 
 	PrintMsg(msg.c_str());
 
 	
-	EasyDarwinRegisterReq parse(msg.c_str());
+	EasyMsgDSRegisterREQ parse(msg);
 
 	
-	cout << "header.version = " << parse.GetHeaderValue(EASYDARWIN_TAG_VERSION) << endl;
-	cout << "header.TerminialType = " << parse.GetHeaderValue(EASYDARWIN_TAG_TERMINAL_TYPE) << endl;
+	cout << "header.version = " << parse.GetHeaderValue(EASY_TAG_VERSION) << endl;
+	cout << "header.TerminialType = " << parse.GetHeaderValue(EASY_TAG_TERMINAL_TYPE) << endl;
 	cout << "header.MessageType = " << parse.GetMessageType() << ", " << EasyProtocol::GetMsgTypeString(parse.GetMessageType()) << endl;
 	
-	cout << "body.SerialNumber = " << parse.GetNVR().serial_ << endl;
-	cout << "body.CameraCount = " << parse.GetNVR().channels_.size() << endl;
-	cout << "body.AuthCode = " << parse.GetNVR().password_ << endl;
-	cout << "body.camera1 = " << parse.GetNVR().channels_[0].name_ << endl;
-	//////
-
+	cout << "body.Serial = " << parse.GetNVR().serial_ << endl;
+	cout << "body.ChannelCount = " << parse.GetNVR().channels_.size() << endl;
+	cout << "body.Token = " << parse.GetNVR().password_ << endl;
+	cout << "body.camera1 = " << parse.GetNVR().channels_["camera001"].name_ << endl;
 }
 
 void ProtocolTest::TestRegisterRsp()
 {
 	EasyJsonValue body;
-	body["DeviceSerial"] = "000000000001";
-	body["SessionID"] = "a939cd77c7cb4af6b2bd8f2090562b91";
-	EasyDarwinRegisterRSP rsp(body, 1, 200);
+	body[EASY_TAG_SERIAL] = string("000000000001");
+	body[EASY_TAG_SESSION_ID] = string("a939cd77c7cb4af6b2bd8f2090562b91");
+	EasyMsgSDRegisterACK rsp(body, 1, 200);
 
 	string msg = rsp.GetMsg();
 
 	PrintMsg(msg.c_str());
 
 	
-	EasyDarwinRegisterRSP rsp_parse(msg.c_str());
-
-	cout << "session id = " << rsp_parse.GetBodyValue("SessionID") << endl;
-	cout << "device serial = " << rsp_parse.GetBodyValue("DeviceSerial") << endl;
+	EasyMsgSDRegisterACK rsp_parse(msg);
 
+	cout << "session id = " << rsp_parse.GetBodyValue(EASY_TAG_SESSION_ID) << endl;
+	cout << "device serial = " << rsp_parse.GetBodyValue(EASY_TAG_SERIAL) << endl;
 }
 
 void ProtocolTest::TestDeviceStreamReq()
 {
 	EasyJsonValue body;
-	body["DeviceSerial"] = "000000000001";
-	body["CameraSerial"] = "CameraSerial_01";
-	body["StreamID"] = 2;
-	body["Protocol"] = "RTSP";
-	body["DssIP"] = "112.42.1.2";
-	body["DssPort"] = 554;
+	body[EASY_TAG_SERIAL] = string("000000000001");
+	body[EASY_TAG_CHANNEL] = string("1");
+	body[EASY_TAG_PROTOCOL] = string("RTSP");
+	body[EASY_TAG_RESERVE] = string("1");
+	body[EASY_TAG_SERVER_IP] = string("112.42.1.2");
+	body[EASY_TAG_SERVER_PORT] = 554;
 	
-	EasyDarwinDeviceStreamReq req(body, 1);
+	EasyMsgSDPushStreamREQ req(body, 1);
 	
 
 	string msg = req.GetMsg();
 
 	PrintMsg(msg.c_str());
 
-	EasyDarwinDeviceStreamReq rsp_parse(msg.c_str());
-	cout << "DssIP = " << rsp_parse.GetBodyValue("DssIP") << endl;
-	cout << "CameraSerial = " << rsp_parse.GetBodyValue("CameraSerial") << endl;
-	cout << "StreamID = " << rsp_parse.GetBodyValue("StreamID") << endl;
-	cout << "DssPort = " << rsp_parse.GetBodyValue("DssPort") << endl;
+	EasyMsgSDPushStreamREQ rsp_parse(msg);
+	cout << "Server_IP = " << rsp_parse.GetBodyValue(EASY_TAG_SERVER_IP) << endl;
+	cout << "Channel = " << rsp_parse.GetBodyValue(EASY_TAG_CHANNEL) << endl;
+	cout << "Reserve = " << rsp_parse.GetBodyValue(EASY_TAG_RESERVE) << endl;
+	cout << "Server_PORT = " << rsp_parse.GetBodyValue(EASY_TAG_SERVER_PORT) << endl;
 }
 
 void ProtocolTest::TestDeviceListRsp()
@@ -170,10 +150,10 @@ void ProtocolTest::TestDeviceListRsp()
 		device.name_ = string("device") + n;
 		device.serial_ = string("serial") + n;
 		
-		devices.push_back(device);
+		devices[device.serial_] = device;
 	}
 
-	EasyDarwinDeviceListRsp req(devices);
+	EasyMsgSCDeviceListACK req(devices);
 	
 	
 
@@ -181,17 +161,15 @@ void ProtocolTest::TestDeviceListRsp()
 
 	PrintMsg(msg.c_str());
 
-	EasyDarwinDeviceListRsp parse(msg.c_str());
+	EasyMsgSCDeviceListACK parse(msg);
 	
-	devices.clear();
-
 	devices = parse.GetDevices();
 		
-	cout << "body.device_count = " << parse.GetBodyValue("DeviceCount") << endl;
+	cout << "body.device_count = " << parse.GetBodyValue(EASY_TAG_DEVICE_COUNT) << endl;
 
 	for (EasyDevices::iterator it = devices.begin(); it != devices.end(); it++)
 	{
-		cout << it->name_ << "," << it->serial_ << endl;
+		cout << it->second.name_ << "," << it->second.serial_ << endl;
 	}
 }
 
@@ -207,10 +185,10 @@ void ProtocolTest::TestCameraListRsp()
 		device.name_ = string("camera") + n;
 		device.serial_ = string("serial") + n;
 		
-		devices.push_back(device);
+		devices[device.serial_] = device;
 	}
 
-	EasyDarwinCameraListRsp req(devices, "nvr00001");
+	EasyMsgSCDeviceInfoACK req(devices, "nvr00001");
 	
 	
 
@@ -218,143 +196,2088 @@ void ProtocolTest::TestCameraListRsp()
 
 	PrintMsg(msg.c_str());
 
-	EasyDarwinCameraListRsp parse(msg.c_str());
+	EasyMsgSCDeviceInfoACK parse(msg);
 	
-	devices.clear();
-
 	devices = parse.GetCameras();
 		
-	cout << "body.device_count = " << parse.GetBodyValue("CameraCount") << ", " << devices.size()<< endl;
+	cout << "body.device_count = " << parse.GetBodyValue(EASY_TAG_CHANNEL_COUNT) << ", " << devices.size()<< endl;
 
 	for (EasyDevices::iterator it = devices.begin(); it != devices.end(); it++)
 	{
-		cout << it->name_ << "," << it->serial_ << endl;
+		cout << it->second.name_ << "," << it->second.serial_ << endl;
 	}
 }
 
 void ProtocolTest::TestClientStartStreamRsp()
 {
 	EasyJsonValue body;
-	body["DeviceSerial"] = "000000000001";
-	body["CameraSerial"] = "CameraSerial_01";
-	body["URL"] = "112.42.1.2";
-	body["Protocol"] = "RTSP";		
-	body["StreamID"] = 2;
-	EasyDarwinClientStartStreamRsp req(body, 1, 200);
+	body[EASY_TAG_SERIAL] = string("000000000001");
+	body[EASY_TAG_CHANNEL] = string("1");
+	body[EASY_TAG_URL] = string("rtsp://112.42.1.2:554/000000000001/1.sdp");
+	body[EASY_TAG_PROTOCOL] = string("RTSP");		
+	body[EASY_TAG_RESERVE] = string("1");
+	EasyMsgSCGetStreamACK req(body, 1, 200);
 
 
 	string msg = req.GetMsg();
 
 	PrintMsg(msg.c_str());
 
-	EasyDarwinDeviceStreamReq rsp_parse(msg.c_str());
-	cout << "URL = " << rsp_parse.GetBodyValue("URL") << endl;
-	cout << "DeviceSerial = " << rsp_parse.GetBodyValue("DeviceSerial") << endl;
-	cout << "CameraSerial = " << rsp_parse.GetBodyValue("CameraSerial") << endl;
-	cout << "StreamID = " << rsp_parse.GetBodyValue("StreamID") << endl;
-	cout << "Protocol = " << rsp_parse.GetBodyValue("Protocol") << endl;
+	EasyMsgSCGetStreamACK rsp_parse(msg);
+	cout << "URL = " << rsp_parse.GetBodyValue(EASY_TAG_URL) << endl;
+	cout << "Serial = " << rsp_parse.GetBodyValue(EASY_TAG_SERIAL) << endl;
+	cout << "Channel = " << rsp_parse.GetBodyValue(EASY_TAG_CHANNEL) << endl;
+	cout << "Reserve = " << rsp_parse.GetBodyValue(EASY_TAG_RESERVE) << endl;
+	cout << "Protocol = " << rsp_parse.GetBodyValue(EASY_TAG_PROTOCOL) << endl;
 }
 
 void ProtocolTest::TestDeviceStreamRsp()
 {
 	EasyJsonValue body;
-	body["DeviceSerial"] = "000000000001";
-	body["CameraSerial"] = "CameraSerial_01";
-	body["StreamID"] = 0;
+	body[EASY_TAG_SERIAL] = string("000000000001");
+	body[EASY_TAG_CHANNEL] = string("1");
+	body[EASY_TAG_RESERVE] = string("1");
 
-	EasyDarwinDeviceStreamRsp rsp(body, 1, 200);
+	EasyMsgDSPushSteamACK rsp(body, 1, 200);
 
 	string msg = rsp.GetMsg();
 
 	PrintMsg(msg.c_str());
 
-	EasyDarwinDeviceStreamRsp rsp_parse(msg.c_str());
+	EasyMsgDSPushSteamACK rsp_parse(msg);
 	
-	cout << "Error: " << rsp_parse.GetHeaderValue("ErrorNum")<< ", " << rsp_parse.GetHeaderValue("ErrorString") << endl;
-	cout << "CameraSerial = " << rsp_parse.GetBodyValue("CameraSerial") << endl;
-	cout << "DeviceSerial = " << rsp_parse.GetBodyValue("DeviceSerial") << endl;
-
+	cout << "Error: " << rsp_parse.GetHeaderValue(EASY_TAG_ERROR_NUM)<< ", " << rsp_parse.GetHeaderValue(EASY_TAG_ERROR_STRING) << endl;
+	cout << "Channel = " << rsp_parse.GetBodyValue(EASY_TAG_CHANNEL) << endl;
+	cout << "Serial = " << rsp_parse.GetBodyValue(EASY_TAG_SERIAL) << endl;
 }
 
 void ProtocolTest::TestDeviceStreamStopReq()
 {
 	EasyJsonValue body;
-	body["DeviceSerial"] = "000000000001";
-	body["CameraSerial"] = "CameraSerial_01";
-	body["StreamID"] = 1;	 
+	body[EASY_TAG_SERIAL] = string("000000000001");
+	body[EASY_TAG_CHANNEL] = string("1");
+	body[EASY_TAG_RESERVE] = string("1");	 
 
-	EasyDarwinDeviceStreamStop req(body, 1);
+	EasyMsgSDStopStreamREQ req(body, 1);
 
 	string msg = req.GetMsg();
 
 	PrintMsg(msg.c_str());
 	
-	EasyDarwinDeviceStreamStop parse(msg.c_str());
-
-	cout << "StreamID: " << parse.GetBodyValue("StreamID") << endl;
-	cout << "CameraSerial = " << parse.GetBodyValue("CameraSerial") << endl;
-	cout << "DeviceSerial = " << parse.GetBodyValue("DeviceSerial") << endl;
+	EasyMsgSDStopStreamREQ parse(msg);
 
+	cout << "Reserve: " << parse.GetBodyValue(EASY_TAG_RESERVE) << endl;
+	cout << "Channel = " << parse.GetBodyValue(EASY_TAG_CHANNEL) << endl;
+	cout << "Serial = " << parse.GetBodyValue(EASY_TAG_SERIAL) << endl;
 }
 
 void ProtocolTest::TestDeviceStreamStopRsp()
 {
 	EasyJsonValue body;
-	body["DeviceSerial"] = "000000000001";
-	body["CameraSerial"] = "CameraSerial_01";
-	body["StreamID"] = 0;
+	body[EASY_TAG_SERIAL] = string("000000000001");
+	body[EASY_TAG_CHANNEL] = string("1");
+	body[EASY_TAG_RESERVE] = string("1");
 
-	EasyDarwinDeviceStreamStopRsp rsp(body, 1, 404);
+	EasyMsgDSStopStreamACK rsp(body, 1, 404);
 
 	string msg = rsp.GetMsg();
 
 	PrintMsg(msg.c_str());
 
-	EasyDarwinDeviceStreamStopRsp rsp_parse(msg.c_str());
+	EasyMsgDSStopStreamACK rsp_parse(msg);
 	
-	cout << "Error: " << rsp_parse.GetHeaderValue("ErrorNum")<< ", " << rsp_parse.GetHeaderValue("ErrorString") << endl;
-	cout << "CameraSerial = " << rsp_parse.GetBodyValue("CameraSerial") << endl;
-	cout << "DeviceSerial = " << rsp_parse.GetBodyValue("DeviceSerial") << endl;
+	cout << "Error: " << rsp_parse.GetHeaderValue(EASY_TAG_ERROR_NUM)<< ", " << rsp_parse.GetHeaderValue(EASY_TAG_ERROR_STRING) << endl;
+	cout << "Channel = " << rsp_parse.GetBodyValue(EASY_TAG_CHANNEL) << endl;
+	cout << "Serial = " << rsp_parse.GetBodyValue(EASY_TAG_SERIAL) << endl;
 }
 
 void ProtocolTest::TestDeviceSnapReq()
 {
 	EasyJsonValue body;
-	body["DeviceSerial"] = "000000000001";
-	body["CameraSerial"] = "CameraSerial_01";
-	body["Type"] = "JPEG";
-	body["Time"] = "2015-07-20 12:55:30";
-	body["Image"] = "Base64Encode_Image_Data";
-	EasyDarwinDeviceUpdateSnapReq req(body, 1);
+	body[EASY_TAG_SERIAL] = string("000000000001");
+	body[EASY_TAG_CHANNEL] = string("1");
+	body[EASY_TAG_TYPE] = string("JPEG");
+	body[EASY_TAG_TIME] = string("2015-07-20 12:55:30");
+	body[EASY_TAG_IMAGE] = string("Base64Encode_Image_Data");
+	EasyMsgDSPostSnapREQ req(body, 1);
 	
 	string msg = req.GetMsg();
 
 	PrintMsg(msg.c_str());
 
-	EasyDarwinDeviceUpdateSnapReq rsp_parse(msg.c_str());
+	EasyMsgDSPostSnapREQ rsp_parse(msg);
 	
-	cout << "DeviceSerial = " << rsp_parse.GetBodyValue("DeviceSerial") << endl;
-	cout << "CameraSerial = " << rsp_parse.GetBodyValue("CameraSerial") << endl;
-	cout << "Type = " << rsp_parse.GetBodyValue("Type") << endl;
-	cout << "Time = " << rsp_parse.GetBodyValue("Time") << endl;
-	cout << "Image = " << rsp_parse.GetBodyValue("Image") << endl;
+	cout << "Serial = " << rsp_parse.GetBodyValue(EASY_TAG_SERIAL) << endl;
+	cout << "Channel = " << rsp_parse.GetBodyValue(EASY_TAG_CHANNEL) << endl;
+	cout << "Type = " << rsp_parse.GetBodyValue(EASY_TAG_TYPE) << endl;
+	cout << "Time = " << rsp_parse.GetBodyValue(EASY_TAG_TIME) << endl;
+	cout << "Image = " << rsp_parse.GetBodyValue(EASY_TAG_IMAGE) << endl;
 }
 
 void ProtocolTest::TestDeviceSnapRsp()
 {
 	EasyJsonValue body;
-	body["DeviceSerial"] = "000000000001";
-	body["CameraSerial"] = "CameraSerial_01";
+	body[EASY_TAG_SERIAL] = string("000000000001");
+	body[EASY_TAG_CHANNEL] = string("1");
 
-	EasyDarwinDeviceUpdateSnapRsp rsp(body, 1, 200);
+	EasyMsgSDPostSnapACK rsp(body, 1, 200);
 
 	string msg = rsp.GetMsg();
 
 	PrintMsg(msg.c_str());
 
-	EasyDarwinDeviceUpdateSnapRsp rsp_parse(msg.c_str());
+	EasyMsgSDPostSnapACK rsp_parse(msg);
+
+	cout << "Error: " << rsp_parse.GetHeaderValue(EASY_TAG_ERROR_NUM) << ", " << rsp_parse.GetHeaderValue(EASY_TAG_ERROR_STRING) << endl;
+	cout << "Channel = " << rsp_parse.GetBodyValue(EASY_TAG_CHANNEL) << endl;
+	cout << "Serial = " << rsp_parse.GetBodyValue(EASY_TAG_SERIAL) << endl;
+}
+
+//the boost iterator encoder EasyUtil used before EasyBase64
+static string BoostBase64Encode(const string &sInput)
+{
+	typedef boost::archive::iterators::base64_from_binary<boost::archive::iterators::transform_width<string::const_iterator, 6, 8> > Base64EncodeIterator;
+	stringstream result;
+	copy(Base64EncodeIterator(sInput.begin()), Base64EncodeIterator(sInput.end()), ostream_iterator<char>(result));
+	size_t equal_count = (3 - sInput.length() % 3) % 3;
+	for (size_t i = 0; i < equal_count; i++)
+	{
+		result.put('=');
+	}
+	return result.str();
+}
+
+static string RandomBytes(size_t len)
+{
+	string data(len, 0);
+	for (size_t i = 0; i < len; i++)
+	{
+		data[i] = (char)rand();
+	}
+	return data;
+}
+
+void ProtocolTest::TestBase64()
+{
+	int failed = 0;
+	srand(1);
+
+	for (int simd = 1; simd >= 0; simd--)
+	{
+		EasyBase64::EnableSimd(simd != 0);
+
+		//lengths around every kernel block size, one shot and chunked
+		for (size_t len = 0; len < 300; len++)
+		{
+			string data = RandomBytes(len);
+			string ref = BoostBase64Encode(data);
+
+			if (EasyUtil::Base64Encode(data) != ref)	failed++;
+			if (EasyUtil::Base64Decode(ref) != data)	failed++;
+
+			EasyBase64Encoder encoder;
+			string chunked;
+			char buf[512];
+			for (size_t pos = 0; pos < len; )
+			{
+				size_t n = rand() % 7 + 1;
+				if (n > len - pos)	n = len - pos;
+				int ret = encoder.Update(buf, sizeof(buf), (const unsigned char *)data.data() + pos, n);
+				chunked.append(buf, ret);
+				pos += n;
+			}
+			chunked.append(buf, encoder.Final(buf, sizeof(buf)));
+			if (chunked != ref)	failed++;
+
+			//76 column lines as sent by mail/snapshot servers
+			string wrapped;
+			for (size_t i = 0; i < ref.size(); i += 76)
+			{
+				wrapped += ref.substr(i, 76);
+				wrapped += "\r\n";
+			}
+			EasyBase64Decoder decoder;
+			string decoded;
+			unsigned char out[512];
+			for (size_t pos = 0; pos < wrapped.size(); )
+			{
+				size_t n = rand() % 11 + 1;
+				if (n > wrapped.size() - pos)	n = wrapped.size() - pos;
+				int ret = decoder.Update(out, sizeof(out), wrapped.data() + pos, n);
+				if (ret < 0)	break;
+				decoded.append((const char *)out, ret);
+				pos += n;
+			}
+			int ret = decoder.Final(out, sizeof(out));
+			if (ret < 0)	failed++;
+			else			decoded.append((const char *)out, ret);
+			if (decoded != data)	failed++;
+		}
+
+		//padding and malformed input
+		if (EasyUtil::Base64Decode(string("QUJDRA")) != "ABCD")		failed++;
+		if (EasyUtil::Base64Decode(string("QUJDRA==")) != "ABCD")	failed++;
+		if (!EasyUtil::Base64Decode(string("QUJDR")).empty())		failed++;
+		if (!EasyUtil::Base64Decode(string("QU*D")).empty())		failed++;
+		if (!EasyUtil::Base64Decode(string("QQ==QQ==")).empty())	failed++;
+
+		cout << "TestBase64 " << EasyBase64::GetKernel() << ": " << (failed == 0 ? "PASS" : "FAIL") << endl;
+	}
+
+	EasyBase64::EnableSimd(true);
+}
+
+void ProtocolTest::BenchBase64()
+{
+	const size_t len = 1 << 20;
+	string data = RandomBytes(len);
+	string text = EasyUtil::Base64Encode(data);
+	string encoded(EasyBase64::EncodeLength(len), 0);
+	string decoded(EasyBase64::DecodeLength(text.size()), 0);
+
+	clock_t start = clock();
+	for (int i = 0; i < 4; i++)	BoostBase64Encode(data);
+	double boost = (double)(clock() - start) / CLOCKS_PER_SEC / 4;
+	printf("Base64 encode boost: %.0f MB/s\n", len / boost / 1e6);
+
+	for (int simd = 0; simd < 2; simd++)
+	{
+		EasyBase64::EnableSimd(simd != 0);
+
+		start = clock();
+		for (int i = 0; i < 100; i++)	EasyBase64::Encode(&encoded[0], encoded.size(), (const unsigned char *)data.data(), len);
+		double enc = (double)(clock() - start) / CLOCKS_PER_SEC / 100;
+
+		start = clock();
+		for (int i = 0; i < 100; i++)	EasyBase64::Decode((unsigned char *)&decoded[0], decoded.size(), text.data(), text.size());
+		double dec = (double)(clock() - start) / CLOCKS_PER_SEC / 100;
+
+		printf("Base64 %s: encode %.0f MB/s, decode %.0f MB/s\n", EasyBase64::GetKernel(), len / enc / 1e6, text.size() / dec / 1e6);
+	}
+
+	EasyBase64::EnableSimd(true);
+}
+
+//the jsoncpp path EasyMsgSCDeviceListACK used before EasyDeviceTable
+static void DomDeviceList(const string &msg, EasyDevices &devices)
+{
+	EasyProtocol protocol(msg, MSG_SC_DEVICE_LIST_ACK);
+	Json::Value &list = (*protocol.GetRoot())[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_DEVICES];
+	for (Json::ArrayIndex i = 0; i < list.size(); i++)
+	{
+		EasyDevice device;
+		device.name_ = list[i][EASY_TAG_NAME].asString();
+		device.serial_ = list[i][EASY_TAG_SERIAL].asString();
+		device.tag_ = list[i][EASY_TAG_TAG].asString();
+		device.snapJpgPath_ = list[i][EASY_TAG_SNAP_URL].asString();
+		device.appType_ = list[i][EASY_TAG_APP_TYPE].asString();
+		device.terminalType_ = list[i][EASY_TAG_TERMINAL_TYPE].asString();
+		devices[device.serial_] = device;
+	}
+}
+
+static bool SameDevices(EasyDevices &a, EasyDevices &b)
+{
+	if (a.size() != b.size())	return false;
+	for (EasyDevices::iterator it = a.begin(), jt = b.begin(); it != a.end(); ++it, ++jt)
+	{
+		if (it->first != jt->first || it->second.name_ != jt->second.name_ || it->second.tag_ != jt->second.tag_ ||
+			it->second.snapJpgPath_ != jt->second.snapJpgPath_ || it->second.appType_ != jt->second.appType_ ||
+			it->second.terminalType_ != jt->second.terminalType_)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void *GetDevicesThread(void *arg)
+{
+	EasyMsgSCDeviceListACK *list = (EasyMsgSCDeviceListACK *)arg;
+	return &list->GetDevices();
+}
+
+void ProtocolTest::TestDeviceTable()
+{
+	int failed = 0;
+
+	string msg = ProtocolBench::DeviceListPayload(100);
+	EasyDevices dom;
+	DomDeviceList(msg, dom);
+	EasyMsgSCDeviceListACK list(msg);
+	if (!SameDevices(list.GetDevices(), dom))	failed++;
+	if (list.GetBodyValue(EASY_TAG_DEVICE_COUNT) != "100" || list.GetHeaderValue(EASY_TAG_ERROR_NUM) != "200")	failed++;
+
+	const EASY_DEVICE_ENTRY_T *entry = list.GetDeviceTable().Find("000000000042");
+	if (NULL == entry || entry->name != "camera 42")	failed++;
+	if (NULL != list.GetDeviceTable().Find("000000000100"))	failed++;
+
+	//copies must not point into the original arena
+	EasyDeviceTable copy;
+	{
+		EasyDeviceTable table;
+		table.ParseDeviceList(msg.data(), msg.size());
+		copy = table;
+	}
+	if (copy.Size() != 100 || copy[7].serial != "000000000007" || copy.GetBodyValue(EASY_TAG_DEVICE_COUNT) != "100")	failed++;
+
+	//escapes, duplicate serials (last one wins) and unknown members
+	string escaped = "{\"EasyDarwin\":{\"Header\":{\"ErrorNum\":200},\"Body\":{\"Extra\":{\"Devices\":[{\"Serial\":\"x\"}]},"
+		"\"Devices\":[{\"Serial\":\"a\",\"Name\":\"one\"},{\"Serial\":\"a\",\"Name\":\"t\\\"w\\u00e9\\ud83d\\ude00\",\"Ids\":[1,2,{}]}]}}}";
+	EasyMsgSCDeviceListACK dup(escaped);
+	if (dup.GetDeviceTable().Size() != 2 || dup.GetDevices().size() != 1 || dup.GetDevices()["a"].name_ != "t\"w\xc3\xa9\xf0\x9f\x98\x80")	failed++;
+	if (dup.GetHeaderValue(EASY_TAG_ERROR_NUM) != "200")	failed++;
+	//"Extra" is not in the table, so root comes from jsoncpp and keeps it
+	if (dup.GetDeviceTable().IsComplete() || !(*dup.GetRoot())[EASY_TAG_ROOT][EASY_TAG_BODY]["Extra"].isObject())	failed++;
+
+	//null reads as "", as it does through jsoncpp
+	string nulls = "{\"EasyDarwin\":{\"Header\":{\"ErrorString\":null},\"Body\":{\"Devices\":[{\"Serial\":\"a\",\"Name\":null}]}}}";
+	EasyMsgSCDeviceListACK nullList(nulls);
+	if (!nullList.GetDeviceTable().IsComplete() || nullList.GetDeviceTable().Size() != 1)	failed++;
+	if (nullList.GetHeaderValue(EASY_TAG_ERROR_STRING) != "" || nullList.GetDevices()["a"].name_ != "")	failed++;
+
+	//threads asking for the devices at once all get the one map, built once
+	EasyMsgSCDeviceListACK shared(ProtocolBench::DeviceListPayload(1000));
+	pthread_t threads[8];
+	void *maps[8];
+	for (int i = 0; i < 8; i++)	pthread_create(&threads[i], NULL, GetDevicesThread, &shared);
+	for (int i = 0; i < 8; i++)	pthread_join(threads[i], &maps[i]);
+	for (int i = 0; i < 8; i++)
+	{
+		if (maps[i] != &shared.GetDevices())	failed++;
+	}
+	if (shared.GetDevices().size() != 1000)	failed++;
+
+	//device info keeps the Serial/Name swap of the jsoncpp path
+	EasyDevices cameras;
+	cameras["1"] = EasyDevice("1", "camera01", "online");
+	cameras["2"] = EasyDevice("2", "camera02", "offline");
+	EasyMsgSCDeviceInfoACK info(cameras, "nvr00001");
+	EasyMsgSCDeviceInfoACK infoParse(info.GetMsg());
+	EasyDevices &parsed = infoParse.GetCameras();
+	if (parsed.size() != 2 || parsed["camera02"].name_ != "2" || parsed["camera02"].status_ != "offline")	failed++;
+	if (infoParse.GetBodyValue(EASY_TAG_SERIAL) != "nvr00001")	failed++;
+
+	//malformed input is refused by the table
+	const char *bad[] = {"", "{", "{\"EasyDarwin\":}", "{\"a\":tru}", "{\"a\":\"\\x\"}", "[1,]", "{} {}", "{\"a\":\"\\ud800\"}"};
+	for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+	{
+		EasyDeviceTable table;
+		if (table.ParseDeviceList(bad[i], strlen(bad[i])) != -1)	failed++;
+	}
+
+	string deep(EASY_JSON_MAX_DEPTH + 1, '[');
+	deep += string(EASY_JSON_MAX_DEPTH + 1, ']');
+	EasyDeviceTable table;
+	if (table.ParseDeviceList(deep.data(), deep.size()) != -1)	failed++;
+
+	cout << "TestDeviceTable: " << (failed == 0 ? "PASS" : "FAIL") << endl;
+}
+
+void ProtocolTest::BenchDeviceList()
+{
+	int counts[] = {1000, 10000, 100000};
+	for (int i = 0; i < 3; i++)
+	{
+		string msg = ProtocolBench::DeviceListPayload(counts[i]);
+
+		size_t base = g_heapCurrent;
+		g_heapPeak = base;
+		clock_t start = clock();
+		{
+			EasyDevices devices;
+			DomDeviceList(msg, devices);
+		}
+		double dom = (double)(clock() - start) / CLOCKS_PER_SEC;
+		size_t domPeak = g_heapPeak - base;
+
+		g_heapPeak = base;
+		start = clock();
+		size_t tableSize;
+		{
+			EasyMsgSCDeviceListACK ack(msg);
+			tableSize = ack.GetDeviceTable().GetMemorySize();
+		}
+		double table = (double)(clock() - start) / CLOCKS_PER_SEC;
+		size_t tablePeak = g_heapPeak - base;
+
+		g_heapPeak = base;
+		start = clock();
+		{
+			EasyMsgSCDeviceListACK ack(msg);
+			ack.GetDevices();
+		}
+		double adapter = (double)(clock() - start) / CLOCKS_PER_SEC;
+		size_t adapterPeak = g_heapPeak - base;
+
+		printf("DeviceList %d devices, %.1f MB: jsoncpp %.1f ms %.1f MB peak, table %.1f ms %.1f MB peak (%.1f MB held), table+GetDevices %.1f ms %.1f MB peak\n",
+			counts[i], msg.size() / 1e6, dom * 1e3, domPeak / 1e6, table * 1e3, tablePeak / 1e6, tableSize / 1e6, adapter * 1e3, adapterPeak / 1e6);
+	}
+}
+
+void ProtocolTest::TestBorrowedParse()
+{
+	int failed = 0;
+
+	EasyProtocol *copy;
+	{
+		string msg = ProtocolBench::DeviceInfoPayload(4);
+		EasyProtocol original(msg);
+		Json::Value &body = (*original.GetRoot())[EASY_TAG_ROOT][EASY_TAG_BODY];
+		if (!body[EASY_TAG_SERIAL].isBorrowed())	failed++;
+
+		//a copy owns its strings
+		copy = new EasyProtocol(original);
+		msg.assign(msg.size(), '#');
+	}
+	EasyProtocol again(*copy);
+	delete copy;
+	if (again.GetBodyValue(EASY_TAG_SERIAL) != "001001000010" || EasyProtocol::ViewOf((*again.GetRoot())[EASY_TAG_ROOT][EASY_TAG_HEADER][EASY_TAG_ERROR_NUM]) != "200")	failed++;
+
+	//Read replaces the text and everything that pointed into it
+	EasyProtocol reread(ProtocolBench::StreamAckPayload());
+	reread.Read("{\"EasyDarwin\":{\"Body\":{\"URL\":\"rtsp://a\\/b\"}}}");
+	if (reread.GetBodyValue(EASY_TAG_URL) != "rtsp://a/b" || reread.GetBodyValue(EASY_TAG_SERIAL) != "")	failed++;
+	reread.Read("not json");
+	if (reread.GetBodyValue(EASY_TAG_URL) != "")	failed++;
+
+	cout << "TestBorrowedParse: " << (failed == 0 ? "PASS" : "FAIL") << endl;
+}
+
+//jsoncpp copying every string against strings pointing into the text
+void ProtocolTest::BenchBorrowedParse()
+{
+	int counts[] = {1000, 10000};
+	for (int i = 0; i < 2; i++)
+	{
+		string msg = ProtocolBench::DeviceListPayload(counts[i]);
+		for (int borrow = 0; borrow < 2; borrow++)
+		{
+			const int passes = 5;
+			size_t allocations = g_heapAllocations;
+			size_t bytes = g_heapBytes;
+			double best = 0;
+			size_t total = 0;
+			for (int pass = 0; pass < passes; pass++)
+			{
+				clock_t start = clock();
+				{
+					Json::Reader reader;
+					Json::Value root;
+					if (borrow)	reader.parseBorrowed(msg.data(), msg.data() + msg.size(), root);
+					else		reader.parse(msg, root, false);
+
+					Json::Value &list = root[EASY_TAG_ROOT][EASY_TAG_BODY][EASY_TAG_DEVICES];
+					for (Json::ArrayIndex n = 0; n < list.size(); n++)
+					{
+						total += EasyProtocol::ViewOf(list[n][EASY_TAG_SERIAL]).size();
+						total += EasyProtocol::ViewOf(list[n][EASY_TAG_SNAP_URL]).size();
+					}
+				}
+				double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+				if (best == 0 || seconds < best)	best = seconds;
+			}
+
+			printf("BorrowedParse %d devices, %s: %.1f ms, %.0f allocations %.2f MB per parse (%u chars read)\n",
+				counts[i], borrow ? "parseBorrowed" : "parse", best * 1e3, (double)(g_heapAllocations - allocations) / passes,
+				(double)(g_heapBytes - bytes) / passes / 1e6, (unsigned)(total / passes));
+		}
+	}
+}
+
+//"+serial", "-serial" and "~serial" in the order the registry reports them
+class RecordingListener : public EasyDeviceRegistryListener
+{
+public:
+	virtual void OnDeviceAdded(const EasyDevice& device)						{events_ += "+" + device.serial_ + " ";}
+	virtual void OnDeviceRemoved(const EasyDevice& device)						{events_ += "-" + device.serial_ + " ";}
+	virtual void OnDeviceChanged(const EasyDevice& before, const EasyDevice& after)
+	{
+		events_ += "~" + after.serial_ + (before.name_ != after.name_ ? "(" + after.name_ + ")" : string()) + " ";
+	}
+
+	string events_;
+};
+
+void ProtocolTest::TestDeviceRegistry()
+{
+	int failed = 0;
+
+	EasyDevices devices;
+	devices["a"] = EasyDevice("a", "camera a");
+	devices["b"] = EasyDevice("b", "nvr b");
+	devices["b"].appType_ = "EasyNVR";
+	devices["c"] = EasyDevice("c", "camera c");
+
+	EasyDeviceRegistry registry;
+	RecordingListener first;
+	EASY_REGISTRY_DELTA_T delta = registry.Update(devices, &first);
+	if (first.events_ != "+a +b +c " || delta.added != 3 || registry.Size() != 3)	failed++;
+	if (registry.NeedsChannels("a") || !registry.NeedsChannels("b") || registry.GetChannels("b") != NULL)	failed++;
+
+	EasyDevices channels;
+	channels["1"] = EasyDevice("1", "channel 1", "online");
+	registry.SetChannels("b", channels);
+	if (registry.NeedsChannels("b") || registry.GetChannels("b") == NULL || registry.GetChannels("b")->size() != 1)	failed++;
+
+	//nothing changed, nothing reported
+	RecordingListener same;
+	delta = registry.Update(devices, &same);
+	if (!same.events_.empty() || delta.unchanged != 3 || registry.NeedsChannels("b"))	failed++;
+
+	//a new snapshot keeps the NVR's channels, a new name drops them
+	devices["b"].snapJpgPath_ = "http://snap/b.jpg";
+	devices["c"].name_ = "renamed";
+	devices.erase("a");
+	devices["d"] = EasyDevice("d", "camera d");
+	RecordingListener delta1;
+	delta = registry.Update(devices, &delta1);
+	if (delta1.events_ != "-a ~b ~c(renamed) +d " || delta.added != 1 || delta.removed != 1 || delta.changed != 2)	failed++;
+	if (registry.NeedsChannels("b") || registry.Find("a") != NULL || registry.Find("c")->name_ != "renamed")	failed++;
+
+	devices["b"].name_ = "nvr b2";
+	registry.Update(devices, NULL);
+	if (!registry.NeedsChannels("b"))	failed++;
+	registry.SetChannels("b", channels);
+	registry.InvalidateChannels();
+	if (!registry.NeedsChannels("b"))	failed++;
+
+	//the table and the map of the same message agree; a repeated serial keeps its last entry
+	string msg = ProtocolBench::DeviceListPayload(50);
+	size_t at = msg.find("\"Devices\":[") + 11;
+	msg.insert(at, "{\"Serial\":\"000000000007\",\"Name\":\"stale\"},");
+	EasyMsgSCDeviceListACK ack(msg);
+	EasyDeviceRegistry fromTable;
+	delta = fromTable.Update(ack.GetDeviceTable(), NULL);
+	if (delta.added != 50 || fromTable.Find("000000000007")->name_ != "camera 7")	failed++;
+	RecordingListener none;
+	delta = fromTable.Update(ack.GetDevices(), &none);
+	if (!none.events_.empty() || delta.unchanged != 50)	failed++;
+
+	RecordingListener all;
+	fromTable.Update(EasyDevices(), &all);
+	if (fromTable.Size() != 0 || all.events_.size() != 50 * 14)	failed++;
+
+	cout << "TestDeviceRegistry: " << (failed == 0 ? "PASS" : "FAIL") << endl;
+}
+
+class CountingListener : public EasyDeviceRegistryListener
+{
+public:
+	CountingListener() : calls_(0) {}
+	virtual void OnDeviceAdded(const EasyDevice&)							{calls_++;}
+	virtual void OnDeviceRemoved(const EasyDevice&)							{calls_++;}
+	virtual void OnDeviceChanged(const EasyDevice&, const EasyDevice&)		{calls_++;}
+
+	size_t calls_;
+};
+
+void ProtocolTest::BenchDeviceRegistry()
+{
+	const int count = 50000;
+	string msg = ProtocolBench::DeviceListPayload(count);
+	EasyMsgSCDeviceListACK ack(msg);
+	EasyDevices changed = ack.GetDevices();
+
+	//1% renamed, 0.5% gone, 0.5% new
+	for (int i = 0; i < count / 100; i++)
+	{
+		char serial[16];
+		sprintf(serial, "%012d", i * 100);
+		changed[serial].name_ += " renamed";
+		sprintf(serial, "%012d", i * 100 + 50);
+		if (i % 2)	changed.erase(serial);
+		else		changed[string("n") + serial] = EasyDevice(string("n") + serial, "new camera");
+	}
+
+	const char *name[] = {"first list", "same list", "1% changed (map)", "back to the table"};
+	EasyDeviceRegistry registry;
+	for (int step = 0; step < 4; step++)
+	{
+		CountingListener listener;
+		EASY_REGISTRY_DELTA_T delta;
+		clock_t start = clock();
+		if (step == 2)	delta = registry.Update(changed, &listener);
+		else			delta = registry.Update(ack.GetDeviceTable(), &listener);
+		double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		printf("DeviceRegistry %d devices, %s: %.1f ms, +%u -%u ~%u =%u, %u callbacks\n", count, name[step], seconds * 1e3,
+			(unsigned)delta.added, (unsigned)delta.removed, (unsigned)delta.changed, (unsigned)delta.unchanged, (unsigned)listener.calls_);
+	}
+}
+
+#ifndef _WIN32
+//local HTTP/1.1 server for TestHttpClient and BenchHttpClient. The path picks the framing:
+//"/len/N", "/chunked/N", "/close/N" (Connection: close), "/nolength/N" (body ends with the
+//connection) and "/missing/N" (404); the N body bytes repeat the path. A connection is dropped
+//silently after maxRequests responses, and every batch of requests read together waits delayUs
+//first, like one network round trip would.
+class HttpStandIn
+{
+public:
+	HttpStandIn(int maxRequests = 0, int delayUs = 0)
+		: maxRequests_(maxRequests), delayUs_(delayUs), port_(0), accepted_(0), active_(0), busy_(0), maxBusy_(0)
+	{
+		pthread_mutex_init(&lock_, NULL);
+		pthread_cond_init(&done_, NULL);
+		listen_ = socket(AF_INET, SOCK_STREAM, 0);
+		int on = 1;
+		setsockopt(listen_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t len = sizeof(addr);
+		if (bind(listen_, (struct sockaddr *)&addr, sizeof(addr)) == 0 && listen(listen_, 64) == 0 &&
+			getsockname(listen_, (struct sockaddr *)&addr, &len) == 0)
+		{
+			port_ = ntohs(addr.sin_port);
+			pthread_create(&acceptor_, NULL, Accept, this);
+		}
+	}
+
+	~HttpStandIn()
+	{
+		if (port_ == 0)	return;
+
+		shutdown(listen_, SHUT_RDWR);
+		close(listen_);
+		pthread_join(acceptor_, NULL);
+
+		pthread_mutex_lock(&lock_);
+		for (size_t i = 0; i < fds_.size(); i++)	shutdown(fds_[i], SHUT_RDWR);
+		while (active_ > 0)	pthread_cond_wait(&done_, &lock_);
+		pthread_mutex_unlock(&lock_);
+		pthread_cond_destroy(&done_);
+		pthread_mutex_destroy(&lock_);
+	}
+
+	unsigned short Port()	{return port_;}
+	int Accepted()			{return accepted_;}
+	//most batches being answered at once
+	int MaxBusy()			{return maxBusy_;}
+	//paths in the order they were read
+	vector<string> Served()
+	{
+		pthread_mutex_lock(&lock_);
+		vector<string> served = served_;
+		pthread_mutex_unlock(&lock_);
+		return served;
+	}
+
+	static string Body(const string& path, size_t n)
+	{
+		string body;
+		body.reserve(n);
+		while (body.size() < n)	body.append(path, 0, n - body.size() < path.size() ? n - body.size() : path.size());
+		return body;
+	}
+
+private:
+	typedef struct __STAND_IN_CONN_T
+	{
+		HttpStandIn *server;
+		int fd;
+	}STAND_IN_CONN_T;
+
+	static void* Accept(void *param)
+	{
+		HttpStandIn *server = (HttpStandIn *)param;
+		for (;;)
+		{
+			int fd = accept(server->listen_, NULL, NULL);
+			if (fd < 0)	break;
+
+			int on = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+			STAND_IN_CONN_T *conn = new STAND_IN_CONN_T;
+			conn->server = server;
+			conn->fd = fd;
+
+			pthread_mutex_lock(&server->lock_);
+			server->accepted_++;
+			server->active_++;
+			server->fds_.push_back(fd);
+			pthread_t thread;
+			pthread_create(&thread, NULL, Serve, conn);
+			pthread_detach(thread);
+			pthread_mutex_unlock(&server->lock_);
+		}
+		return NULL;
+	}
+
+	static void* Serve(void *param)
+	{
+		STAND_IN_CONN_T *conn = (STAND_IN_CONN_T *)param;
+		HttpStandIn *server = conn->server;
+		string in;
+		char buf[4096];
+		int served = 0;
+		bool open = true;
+		while (open)
+		{
+			ssize_t n = recv(conn->fd, buf, sizeof(buf), 0);
+			if (n <= 0)	break;
+			in.append(buf, n);
+			if (in.find("\r\n\r\n") == string::npos)	continue;
+
+			pthread_mutex_lock(&server->lock_);
+			if (++server->busy_ > server->maxBusy_)	server->maxBusy_ = server->busy_;
+			pthread_mutex_unlock(&server->lock_);
+			if (server->delayUs_ > 0)	usleep(server->delayUs_);
+
+			string out;
+			size_t end;
+			while (open && (end = in.find("\r\n\r\n")) != string::npos)
+			{
+				size_t sp = in.find(' ');
+				string path = in.substr(sp + 1, in.find(' ', sp + 1) - sp - 1);
+				in.erase(0, end + 4);
+				pthread_mutex_lock(&server->lock_);
+				server->served_.push_back(path);
+				pthread_mutex_unlock(&server->lock_);
+
+				size_t slash = path.find('/', 1);
+				size_t size = slash == string::npos ? 64 : (size_t)atoi(path.c_str() + slash + 1);
+				string body = Body(path, size);
+				char head[128];
+				if (path.compare(0, 9, "/chunked/") == 0)
+				{
+					out += "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+					for (size_t at = 0; at < body.size(); at += 1000)
+					{
+						string chunk = body.substr(at, 1000);
+						sprintf(head, "%x;ext=1\r\n", (unsigned)chunk.size());
+						out += head + chunk + "\r\n";
+					}
+					out += "0\r\nX-Trailer: 1\r\n\r\n";
+				}
+				else if (path.compare(0, 9, "/missing/") == 0)
+				{
+					sprintf(head, "HTTP/1.1 404 Not Found\r\nContent-Length: %u\r\n\r\n", (unsigned)body.size());
+					out += head + body;
+				}
+				else if (path.compare(0, 10, "/nolength/") == 0)
+				{
+					out += "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n" + body;
+					open = false;
+				}
+				else
+				{
+					bool closing = path.compare(0, 7, "/close/") == 0;
+					sprintf(head, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %u\r\n%s\r\n",
+						(unsigned)body.size(), closing ? "Connection: close\r\n" : "");
+					out += head + body;
+					open = !closing;
+				}
+				if (server->maxRequests_ > 0 && ++served == server->maxRequests_)	open = false;
+			}
+			bool sent = out.empty() || send(conn->fd, out.data(), out.size(), MSG_NOSIGNAL) == (ssize_t)out.size();
+			pthread_mutex_lock(&server->lock_);
+			server->busy_--;
+			pthread_mutex_unlock(&server->lock_);
+			if (!sent)	break;
+		}
+		pthread_mutex_lock(&server->lock_);
+		server->fds_.erase(find(server->fds_.begin(), server->fds_.end(), conn->fd));
+		close(conn->fd);
+		if (--server->active_ == 0)	pthread_cond_signal(&server->done_);
+		pthread_mutex_unlock(&server->lock_);
+		delete conn;
+		return NULL;
+	}
+
+	int maxRequests_;
+	int delayUs_;
+	unsigned short port_;
+	int listen_;
+	pthread_t acceptor_;
+	pthread_mutex_t lock_;
+	pthread_cond_t done_;
+	int accepted_;
+	int active_;
+	int busy_;
+	int maxBusy_;
+	vector<int> fds_;			//connections still served
+	vector<string> served_;
+};
+
+//counts async responses whose body matches the path
+class CheckingHandler : public EasyHttpHandler
+{
+public:
+	CheckingHandler(size_t size) : size_(size), ok_(0), cancelled_(0) {pthread_mutex_init(&lock_, NULL);}
+	~CheckingHandler() {pthread_mutex_destroy(&lock_);}
+
+	virtual void OnHttpResponse(const string& path, void *context, const EASY_HTTP_RESPONSE_T& response)
+	{
+		bool ok = response.status == 200 && response.body == HttpStandIn::Body(path, size_) && context == this;
+		pthread_mutex_lock(&lock_);
+		if (ok)	ok_++;
+		if (response.status == EASY_HTTP_ERROR_CANCELLED)	cancelled_++;
+		pthread_mutex_unlock(&lock_);
+	}
+
+	size_t size_;
+	int ok_;
+	int cancelled_;
+	pthread_mutex_t lock_;
+};
+
+static bool CheckGet(EasyHttpClient& client, const string& path, size_t size)
+{
+	EASY_HTTP_RESPONSE_T response;
+	return client.Get(path, response) == 200 && response.body == HttpStandIn::Body(path, size);
+}
+
+static double WallSeconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+#endif
+
+void ProtocolTest::TestHttpClient()
+{
+#ifdef _WIN32
+	cout << "TestHttpClient: skipped, the stand-in server is POSIX only" << endl;
+#else
+	int failed = 0;
+
+	string host, path;
+	unsigned short port;
+	if (!EasyHttpClient::SplitURL("http://121.40.50.44:10000/API/getdevicelist", host, port, path) ||
+		host != "121.40.50.44" || port != 10000 || path != "/API/getdevicelist")	failed++;
+	if (!EasyHttpClient::SplitURL("snap.easydarwin.org", host, port, path) || port != 80 || path != "/")	failed++;
+
+	{
+		HttpStandIn server;
+		EasyHttpClient client("127.0.0.1", server.Port());
+
+		//keep-alive: three framings, one connection
+		if (!CheckGet(client, "/len/1000", 1000) || !CheckGet(client, "/chunked/70000", 70000) ||
+			!CheckGet(client, "/len/0", 0) || client.GetConnects() != 1)	failed++;
+
+		//the server closes, the next call reconnects
+		if (!CheckGet(client, "/close/10", 10) || !CheckGet(client, "/nolength/5000", 5000) ||
+			!CheckGet(client, "/len/10", 10) || client.GetConnects() != 3)	failed++;
+
+		//20 requests in one write, answered in order
+		vector<string> paths;
+		for (int i = 0; i < 20; i++)
+		{
+			char p[32];
+			sprintf(p, i % 3 ? "/len/%d" : "/chunked/%d", 100 + i * 997);
+			paths.push_back(p);
+		}
+		vector<EASY_HTTP_RESPONSE_T> responses;
+		if (client.Pipeline(paths, responses) != 20)	failed++;
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			if (responses[i].body != HttpStandIn::Body(paths[i], 100 + i * 997))	failed++;
+		}
+		if (client.GetConnects() != 3)	failed++;
+
+		CheckingHandler handler(4096);
+		for (int i = 0; i < 100; i++)
+		{
+			char p[32];
+			sprintf(p, "/len/4096?%d", i);
+			client.GetAsync(p, &handler, &handler);
+		}
+		client.Wait();
+		if (handler.ok_ != 100)	failed++;
+	}
+
+	//keep-alive connections the server drops after 3 requests, sequential and pipelined
+	{
+		HttpStandIn server(3);
+		EasyHttpClient client("127.0.0.1", server.Port());
+		for (int i = 0; i < 10; i++)
+		{
+			if (!CheckGet(client, "/len/100", 100))	failed++;
+		}
+		vector<string> paths(10, "/len/200");
+		vector<EASY_HTTP_RESPONSE_T> responses;
+		if (client.Pipeline(paths, responses) != 10 || responses[9].body != HttpStandIn::Body("/len/200", 200))	failed++;
+	}
+
+	//nothing listens any more
+	{
+		unsigned short closed;
+		{
+			HttpStandIn server;
+			closed = server.Port();
+		}
+		EasyHttpClient client("127.0.0.1", closed, 1, 500);
+		EASY_HTTP_RESPONSE_T response;
+		if (client.Get("/len/1", response) != EASY_HTTP_ERROR_CONNECT)	failed++;
+	}
+
+	//destroyed with requests queued: each one is answered or cancelled
+	{
+		HttpStandIn server(0, 20000);
+		CheckingHandler handler(16);
+		{
+			EasyHttpClient client("127.0.0.1", server.Port(), 1);
+			for (int i = 0; i < 10; i++)	client.GetAsync("/len/16", &handler, &handler);
+		}
+		if (handler.ok_ + handler.cancelled_ != 10)	failed++;
+	}
+
+	cout << "TestHttpClient: " << (failed == 0 ? "PASS" : "FAIL") << endl;
+#endif
+}
+
+void ProtocolTest::BenchHttpClient()
+{
+#ifndef _WIN32
+	const int delays[] = {0, 1000};
+	for (int d = 0; d < 2; d++)
+	{
+		HttpStandIn server(0, delays[d]);
+		const int count = delays[d] ? 200 : 2000;
+		const size_t size = 4096;
+
+		//what OpenURL cost per call: a TCP connection each time
+		EasyHttpClient client("127.0.0.1", server.Port());
+		double start = WallSeconds();
+		for (int i = 0; i < count; i++)	CheckGet(client, "/close/4096", size);
+		double perConnection = (WallSeconds() - start) / count;
+
+		start = WallSeconds();
+		for (int i = 0; i < count; i++)	CheckGet(client, "/len/4096", size);
+		double keepAlive = (WallSeconds() - start) / count;
+
+		vector<string> paths(16, "/len/4096");
+		vector<EASY_HTTP_RESPONSE_T> responses;
+		start = WallSeconds();
+		for (int i = 0; i < count / 16; i++)	client.Pipeline(paths, responses);
+		double pipelined = (WallSeconds() - start) / (count / 16 * 16);
+
+		CheckingHandler handler(size);
+		start = WallSeconds();
+		for (int i = 0; i < count; i++)	client.GetAsync("/len/4096", &handler, &handler);
+		client.Wait();
+		double async = (WallSeconds() - start) / count;
+
+		printf("HttpClient %d bytes, %d us round trip: connection per request %.0f us, keep-alive %.0f us, "
+			"pipelined x16 %.0f req/s, async x%d %.0f req/s (%d ok)\n", (int)size, delays[d], perConnection * 1e6, keepAlive * 1e6,
+			1 / pipelined, EASY_HTTP_DEFAULT_CONNECTIONS, 1 / async, handler.ok_);
+	}
+#endif
+}
+
+#ifndef _WIN32
+//what EasyFetchScheduler reported, by url
+class FetchRecorder : public EasyFetchHandler
+{
+public:
+	FetchRecorder() : calls_(0) {pthread_mutex_init(&lock_, NULL);}
+	~FetchRecorder() {pthread_mutex_destroy(&lock_);}
+
+	virtual void OnFetched(const string& url, void * /*context*/, const EASY_HTTP_RESPONSE_T& response)
+	{
+		pthread_mutex_lock(&lock_);
+		calls_++;
+		status_[url] = response.status;
+		body_[url] = response.body;
+		pthread_mutex_unlock(&lock_);
+	}
+
+	int calls_;
+	map<string, int> status_;
+	map<string, string> body_;
+	pthread_mutex_t lock_;
+};
+
+static bool ReadWholeFile(const string& file, string& data)
+{
+	FILE *fp = fopen(file.c_str(), "rb");
+	if (NULL == fp)	return false;
+	char buf[4096];
+	size_t n;
+	data.clear();
+	while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)	data.append(buf, n);
+	fclose(fp);
+	return true;
+}
+
+static bool FileExists(const string& file)
+{
+	string data;
+	return ReadWholeFile(file, data);
+}
+#endif
+
+void ProtocolTest::TestFetchScheduler()
+{
+#ifdef _WIN32
+	cout << "TestFetchScheduler: skipped, the stand-in server is POSIX only" << endl;
+#else
+	int failed = 0;
+
+	//repeated urls, a body to disk and a 404 that must not leave a file
+	{
+		HttpStandIn server(0, 20000);
+		char base[64];
+		sprintf(base, "http://127.0.0.1:%u", (unsigned)server.Port());
+		string snap = "fetch_test.jpg", missing = "fetch_missing.jpg";
+		remove(snap.c_str());
+		remove(missing.c_str());
+
+		FetchRecorder recorder;
+		EasyFetchScheduler fetcher(2);
+		if (fetcher.Fetch("rtsp://127.0.0.1/live", EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL))	failed++;
+		for (int i = 0; i < 5; i++)
+		{
+			if (!fetcher.Fetch(string(base) + "/len/300", EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL))	failed++;
+		}
+		fetcher.Fetch(string(base) + "/chunked/50000", EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL, snap);
+		fetcher.Fetch(string(base) + "/missing/10", EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL, missing);
+		fetcher.Wait();
+
+		string data;
+		if (recorder.calls_ != 7 || fetcher.GetRequests() != 3 || fetcher.GetMerged() != 4)	failed++;
+		if (recorder.body_[string(base) + "/len/300"] != HttpStandIn::Body("/len/300", 300))	failed++;
+		if (recorder.status_[string(base) + "/chunked/50000"] != 200 || !recorder.body_[string(base) + "/chunked/50000"].empty())	failed++;
+		if (!ReadWholeFile(snap, data) || data != HttpStandIn::Body("/chunked/50000", 50000) || FileExists(snap + ".part"))	failed++;
+		if (recorder.status_[string(base) + "/missing/10"] != 404 || FileExists(missing) || FileExists(missing + ".part"))	failed++;
+		remove(snap.c_str());
+	}
+
+	//one at a time: what is visible, or raised while queued, goes before the rest
+	{
+		HttpStandIn server(0, 5000);
+		char base[64];
+		sprintf(base, "http://127.0.0.1:%u", (unsigned)server.Port());
+		FetchRecorder recorder;
+		EasyFetchScheduler fetcher(1);
+		for (int i = 0; i < 10; i++)
+		{
+			char url[96];
+			sprintf(url, "%s/len/10?%d", base, i);
+			fetcher.Fetch(url, i == 7 || i == 8 ? EASY_FETCH_PRIORITY_VISIBLE : EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL);
+		}
+		if (!fetcher.SetPriority(string(base) + "/len/10?5", EASY_FETCH_PRIORITY_VISIBLE))	failed++;
+		fetcher.Wait();
+		if (fetcher.SetPriority(string(base) + "/len/10?5", EASY_FETCH_PRIORITY_NORMAL))	failed++;
+
+		const int expected[] = {0, 5, 7, 8, 1, 2, 3, 4, 6, 9};
+		vector<string> served = server.Served();
+		if (served.size() != 10 || recorder.calls_ != 10)	failed++;
+		for (size_t i = 0; i < served.size() && i < 10; i++)
+		{
+			char path[32];
+			sprintf(path, "/len/10?%d", expected[i]);
+			if (served[i] != path)	failed++;
+		}
+	}
+
+	//never more than perHost requests at the server
+	{
+		HttpStandIn server(0, 2000);
+		char base[64];
+		sprintf(base, "http://127.0.0.1:%u", (unsigned)server.Port());
+		FetchRecorder recorder;
+		EasyFetchScheduler fetcher(3);
+		for (int i = 0; i < 40; i++)
+		{
+			char url[96];
+			sprintf(url, "%s/len/1000?%d", base, i);
+			fetcher.Fetch(url, EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL);
+		}
+		fetcher.Wait();
+		if (recorder.calls_ != 40 || server.MaxBusy() > 3 || server.MaxBusy() < 2)	failed++;
+	}
+
+	//destroyed with fetches queued: each one is answered or cancelled
+	{
+		HttpStandIn server(0, 20000);
+		char base[64];
+		sprintf(base, "http://127.0.0.1:%u", (unsigned)server.Port());
+		FetchRecorder recorder;
+		{
+			EasyFetchScheduler fetcher(1);
+			for (int i = 0; i < 10; i++)
+			{
+				char url[96];
+				sprintf(url, "%s/len/16?%d", base, i);
+				fetcher.Fetch(url, EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL);
+			}
+		}
+		int cancelled = 0;
+		for (map<string, int>::iterator it = recorder.status_.begin(); it != recorder.status_.end(); ++it)
+		{
+			if (it->second == EASY_HTTP_ERROR_CANCELLED)	cancelled++;
+		}
+		if (recorder.calls_ != 10 || cancelled == 0)	failed++;
+	}
+
+	//Cancel: Wait returns once the running fetch is answered, a stopped scheduler refuses more
+	{
+		HttpStandIn server(0, 20000);
+		char base[64];
+		sprintf(base, "http://127.0.0.1:%u", (unsigned)server.Port());
+		FetchRecorder recorder;
+		EasyFetchScheduler fetcher(1);
+		for (int i = 0; i < 10; i++)
+		{
+			char url[96];
+			sprintf(url, "%s/len/16?%d", base, i);
+			fetcher.Fetch(url, EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL);
+		}
+		fetcher.Cancel(true);
+		fetcher.Wait();
+		int cancelled = 0;
+		for (map<string, int>::iterator it = recorder.status_.begin(); it != recorder.status_.end(); ++it)
+		{
+			if (it->second == EASY_HTTP_ERROR_CANCELLED)	cancelled++;
+		}
+		if (recorder.calls_ != 10 || cancelled < 8)	failed++;
+		if (fetcher.Fetch(string(base) + "/len/16", EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL))	failed++;
+	}
+
+	cout << "TestFetchScheduler: " << (failed == 0 ? "PASS" : "FAIL") << endl;
+#endif
+}
+
+void ProtocolTest::BenchFetchScheduler()
+{
+#ifndef _WIN32
+	//after a device list of 100 NVRs and 500 cameras: every getdeviceinfo and every snapshot
+	const int nvrs = 100, snaps = 500;
+	const size_t infoSize = 2048, snapSize = 30000;
+	const int delayUs = 2000;
+	HttpStandIn server(0, delayUs);
+	char base[64];
+	sprintf(base, "http://127.0.0.1:%u", (unsigned)server.Port());
+
+	//the way the dialog did it: one after another, a connection each, snapshots through memory
+	EasyHttpClient client("127.0.0.1", server.Port());
+	double start = WallSeconds();
+	int ok = 0;
+	for (int i = 0; i < nvrs + snaps; i++)
+	{
+		char path[64];
+		sprintf(path, i < nvrs ? "/close/%u?nvr=%d" : "/close/%u?snap=%d", (unsigned)(i < nvrs ? infoSize : snapSize), i);
+		EASY_HTTP_RESPONSE_T response;
+		if (client.Get(path, response) != 200)	continue;
+		if (i >= nvrs)
+		{
+			char file[64];
+			sprintf(file, "fetch_bench_%d.jpg", i);
+			FILE *fp = fopen(file, "wb");
+			if (fp)
+			{
+				fwrite(response.body.data(), 1, response.body.size(), fp);
+				fclose(fp);
+			}
+			remove(file);
+		}
+		ok++;
+	}
+	double sequential = WallSeconds() - start;
+	printf("FetchScheduler %d getdeviceinfo + %d snapshots, %d us round trip: sequential %.0f ms (%d ok)\n",
+		nvrs, snaps, delayUs, sequential * 1e3, ok);
+
+	const int limits[] = {4, 8};
+	for (int l = 0; l < 2; l++)
+	{
+		FetchRecorder recorder;
+		EasyFetchScheduler fetcher(limits[l]);
+		start = WallSeconds();
+		for (int i = 0; i < nvrs + snaps; i++)
+		{
+			char url[128];
+			sprintf(url, i < nvrs ? "%s/len/%u?nvr=%d" : "%s/len/%u?snap=%d", base, (unsigned)(i < nvrs ? infoSize : snapSize), i);
+			char file[64];
+			sprintf(file, "fetch_bench_%d.jpg", i);
+			fetcher.Fetch(url, i % 50 < 5 ? EASY_FETCH_PRIORITY_VISIBLE : EASY_FETCH_PRIORITY_NORMAL, &recorder, NULL,
+				i < nvrs ? string() : string(file));
+		}
+		fetcher.Wait();
+		double scheduled = WallSeconds() - start;
+
+		ok = 0;
+		for (map<string, int>::iterator it = recorder.status_.begin(); it != recorder.status_.end(); ++it)
+		{
+			if (it->second == 200)	ok++;
+		}
+		for (int i = nvrs; i < nvrs + snaps; i++)
+		{
+			char file[64];
+			sprintf(file, "fetch_bench_%d.jpg", i);
+			remove(file);
+		}
+		printf("FetchScheduler %d per host: %.0f ms, %.1fx, peak %d at the server (%d ok)\n",
+			limits[l], scheduled * 1e3, sequential / scheduled, server.MaxBusy(), ok);
+	}
+#endif
+}
+
+//one MSG_SC_GET_STREAM_ACK built, written, parsed and read back
+static void StreamAckRoundTrip(EasyJsonValue &body)
+{
+	EasyMsgSCGetStreamACK ack(body, 1, 200);
+	string msg = ack.GetMsg();
+
+	EasyMsgSCGetStreamACK parse(msg);
+	parse.GetBodyValue(EASY_TAG_URL);
+	parse.GetHeaderValue(EASY_TAG_ERROR_NUM);
+}
+
+void ProtocolTest::BenchMessages()
+{
+	EasyJsonValue body;
+	body[EASY_TAG_SERIAL] = string("001001000010");
+	body[EASY_TAG_CHANNEL] = string("0");
+	body[EASY_TAG_PROTOCOL] = string("RTSP");
+	body[EASY_TAG_RESERVE] = string("1");
+	body[EASY_TAG_URL] = string("rtsp://cms.easydarwin.org:554/001001000010/0.sdp");
+
+	const char *name[] = {"reader/writer per message", "pooled reader/writer", "pooled + arena"};
+	const int count = 100000;
+	Json::Arena arena;
+	for (int mode = 0; mode < 3; mode++)
+	{
+		StreamAckRoundTrip(body);		//warm the pools
+
+		//best of three passes, the allocation count is the same in each
+		double best = 0;
+		size_t allocations = 0;
+		for (int pass = 0; pass < 3; pass++)
+		{
+			size_t before = g_heapAllocations;
+			clock_t start = clock();
+			for (int i = 0; i < count; i++)
+			{
+				if (mode == 0)
+				{
+					//the Json::Reader and Json::StyledWriter every message used to own
+					Json::Reader reader[2];
+					Json::StyledWriter writer[2];
+					StreamAckRoundTrip(body);
+				}
+				else if (mode == 1)
+				{
+					StreamAckRoundTrip(body);
+				}
+				else
+				{
+					{
+						Json::ArenaScope scope(arena);
+						StreamAckRoundTrip(body);
+					}
+					arena.reset();
+				}
+			}
+			double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+			if (best == 0 || seconds < best)	best = seconds;
+			allocations = g_heapAllocations - before;
+		}
+
+		printf("Messages %s: %.1f allocations/msg, %.0f msg/s\n", name[mode], (double)allocations / count, count / best);
+	}
+}
+
+void ProtocolTest::TestJsonWriter()
+{
+	int failed = 0;
+
+	//everything FastWriter can meet: escapes, control bytes, NUL in keys and strings, sparse arrays, number limits
+	Json::Value root;
+	root["plain"] = "rtsp://cms.easydarwin.org:554/001001000010/0.sdp";
+	root["escape"] = "q\"b\\s/\b\f\n\r\t\x01\x1f\x7f\xe4\xb8\xad";
+	root[string("nul\0key", 7)] = Json::Value("a\0b", "a\0b" + 3);
+	root[""] = Json::Value();
+	root["int"] = Json::Value(Json::Int64(-9223372036854775807LL - 1));
+	root["uint"] = Json::Value(Json::UInt64(18446744073709551615ULL));
+	root["zero"] = 0;
+	root["small"] = -7;
+	root["real"] = 0.1;
+	root["huge"] = 1e300 * 1e10;
+	root["nan"] = sqrt(-1.0);
+	root["bool"] = false;
+	root["array"][5] = true;
+	root["array"][1] = "x";
+	root["nested"]["empty"] = Json::Value(Json::objectValue);
+	root["nested"]["list"] = Json::Value(Json::arrayValue);
+	root["nested"]["list"].append(1.5);
+
+	Json::FastWriter fast;
+	string expect = fast.write(root);
+	EasyJsonWriter writer;
+	if (writer.Write(root) != expect)	failed++;
+
+	//GetMsg matches FastWriter and GetMsg(char*, int) stops exactly at the buffer size
+	EasyJsonValue body;
+	body[EASY_TAG_SERIAL] = string("001001000010");
+	body[EASY_TAG_SPEED] = 5;
+	body[EASY_TAG_PTS] = 0.5f;
+	EasyMsgCSPTZControlREQ ptz(body, 42);
+	string msg = ptz.GetMsg();
+	if (msg != fast.write(*ptz.GetRoot()) || ptz.GetHeaderValue(EASY_TAG_CSEQ) != "42" || ptz.GetBodyValue(EASY_TAG_PTS) != "0.5")	failed++;
+
+	vector<char> buf(msg.size() + 1, 'x');
+	if (!ptz.GetMsg(&buf[0], (int)msg.size() + 1) || string(&buf[0]) != msg)	failed++;
+	if (!ptz.GetMsg(&buf[0], (int)msg.size()) || memcmp(&buf[0], msg.data(), msg.size()) != 0)	failed++;
+	if (ptz.GetMsg(&buf[0], (int)msg.size() - 1))	failed++;
+
+	//Set*Value text is what boost::lexical_cast gave
+	if (EasyValueText(size_t(0)).Str() != "0" || EasyValueText(-2147483647 - 1).Str() != "-2147483648")	failed++;
+	if (EasyValueText(0.1).Str() != boost::lexical_cast<string>(0.1) || EasyValueText(1.0f / 3).Str() != boost::lexical_cast<string>(1.0f / 3))	failed++;
+	if (EasyValueText(true).Str() != "1" || EasyValueText('A').Str() != "A" || EasyValueText("text").Str() != "text")	failed++;
+	if (EasyValueText(EASY_PTZ_ACTION_TYPE_SINGLE).Str() != "2")	failed++;
+	srand(3);
+	for (int i = 0; i < 100000; i++)
+	{
+		long long v = ((long long)rand() << 40) ^ ((long long)rand() << 20) ^ rand();
+		v >>= rand() % 60;
+		if (i & 1)	v = -v;
+		if (EasyValueText(v).Str() != boost::lexical_cast<string>(v))	failed++;
+	}
+
+	cout << "TestJsonWriter: " << (failed == 0 ? "PASS" : "FAIL") << endl;
+}
+
+void ProtocolTest::BenchJsonWriter()
+{
+	EasyJsonValue ptzBody;
+	ptzBody[EASY_TAG_SERIAL] = string("001001000010");
+	ptzBody[EASY_TAG_CHANNEL] = string("0");
+	ptzBody[EASY_TAG_PROTOCOL] = string("ONVIF");
+	ptzBody[EASY_TAG_ACTION_TYPE] = string("CONTINUOUS");
+	ptzBody[EASY_TAG_CMD] = string("LEFT");
+	ptzBody[EASY_TAG_SPEED] = 5;
+	ptzBody[EASY_TAG_RESERVE] = string("1");
+	EasyMsgCSPTZControlREQ ptz(ptzBody, 1);
+
+	//one 40ms batch of G.711
+	EasyJsonValue talkBody;
+	talkBody[EASY_TAG_SERIAL] = string("001001000010");
+	talkBody[EASY_TAG_CHANNEL] = string("0");
+	talkBody[EASY_TAG_CMD] = string("SENDDATA");
+	talkBody[EASY_TAG_AUDIO_TYPE] = string("G711A");
+	talkBody[EASY_TAG_PROTOCOL] = string("ONVIF");
+	talkBody[EASY_TAG_RESERVE] = string("1");
+	talkBody[EASY_TAG_AUDIO_DATA] = EasyUtil::Base64Encode(RandomBytes(320));
+	talkBody[EASY_TAG_PTS] = 123456;
+	EasyMsgCSTalkbackControlREQ talk(talkBody, 1);
+
+	EasyProtocol *msgs[] = {&ptz, &talk};
+	const char *names[] = {"PTZ", "talkback"};
+	const int count = 100000;
+	char buf[4096];
+
+	for (int m = 0; m < 2; m++)
+	{
+		Json::Value &root = *msgs[m]->GetRoot();
+		Json::StyledWriter styled;
+		Json::FastWriter fast;
+		size_t styledSize = styled.write(root).size();
+		size_t compactSize = msgs[m]->GetMsg().size();
+
+		clock_t start = clock();
+		for (int i = 0; i < count; i++)	styled.write(root);
+		double tStyled = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for (int i = 0; i < count; i++)	fast.write(root);
+		double tFast = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for (int i = 0; i < count; i++)	msgs[m]->GetMsg();
+		double tGetMsg = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for (int i = 0; i < count; i++)	msgs[m]->GetMsg(buf, sizeof(buf));
+		double tBuffer = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		printf("Encode %s (%d -> %d bytes): StyledWriter %.0f msg/s, FastWriter %.0f msg/s, GetMsg() %.0f msg/s, GetMsg(char*, int) %.0f msg/s\n",
+			names[m], (int)styledSize, (int)compactSize, count / tStyled, count / tFast, count / tGetMsg, count / tBuffer);
+	}
+
+	//building a message formats CSeq, ErrorNum and numeric body values
+	const int values = 1000000;
+	clock_t start = clock();
+	for (int i = 0; i < values; i++)	boost::lexical_cast<string>(i * 1009);
+	double tCast = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (int i = 0; i < values; i++)	EasyValueText text(i * 1009);
+	double tText = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("Format int: lexical_cast %.1f ns, EasyValueText %.1f ns\n", tCast * 1e9 / values, tText * 1e9 / values);
+}
+
+//looked up while this file is statically initialized, which may come before EasyProtocolBase.cpp
+static const int staticInitMsgType = EasyProtocol::GetMsgType("MSG_SC_DEVICE_LIST_ACK");
+static const std::string staticInitAppType = EasyProtocol::GetAppTypeString(EASY_APP_TYPE_NVR).to_string();
+
+//every table the string/enum lookups use, with the lookups themselves
+typedef int (*EasyTypeOf)(boost::string_ref);
+typedef boost::string_ref (*EasyStringOf)(int);
+struct TypeMapCase
+{
+	const EasyTypeMap *map;
+	EasyTypeOf typeOf;
+	EasyStringOf stringOf;
+};
+
+static const TypeMapCase typeMapCases[] = {
+	{&EasyProtocol::MsgTypes, EasyProtocol::GetMsgType, EasyProtocol::GetMsgTypeString},
+	{&EasyProtocol::Errors, NULL, EasyProtocol::GetErrorString},
+	{&EasyProtocol::Statuses, EasyProtocol::GetDeviceStatus, EasyProtocol::GetDeviceStatusString},
+	{&EasyProtocol::ProtocolTypes, EasyProtocol::GetProtocolType, EasyProtocol::GetProtocolString},
+	{&EasyProtocol::MediaEncodeTypes, EasyProtocol::GetMediaEncodeType, EasyProtocol::GetMediaEncodeTypeString},
+	{&EasyProtocol::TerminalTypes, EasyProtocol::GetTerminalType, EasyProtocol::GetTerminalTypeString},
+	{&EasyProtocol::AppTypes, EasyProtocol::GetAppType, EasyProtocol::GetAppTypeString},
+	{&EasyProtocol::SnapTypes, EasyProtocol::GetSnapType, EasyProtocol::GetSnapTypeString},
+	{&EasyProtocol::PTZActionTypes, EasyProtocol::GetPTZActionType, EasyProtocol::GetPTZActionTypeString},
+	{&EasyProtocol::PTZCMDTypes, EasyProtocol::GetPTZCMDType, EasyProtocol::GetPTZCMDTypeString},
+	{&EasyProtocol::PresetCMDTypes, EasyProtocol::GetPresetCMDType, EasyProtocol::GetPresetCMDTypeString},
+	{&EasyProtocol::TalkbackAudioTypes, EasyProtocol::GetTalkbackAudioType, EasyProtocol::GetTalkbackAudioTypeString},
+	{&EasyProtocol::TalkbackCMDTypes, EasyProtocol::GetTalkbackCMDType, EasyProtocol::GetTalkbackCMDTypeString}
+};
+
+//the linear scan over 512-byte entries the lookups used to do
+struct OldMsgType
+{
+	int value;
+	char str[512];
+};
+
+static int OldTypeOf(const vector<OldMsgType> &table, const std::string &str)
+{
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		if (str.compare(table[i].str) == 0)	return table[i].value;
+	}
+	return -1;
+}
+
+static std::string OldStringOf(const vector<OldMsgType> &table, int value)
+{
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		if (value == table[i].value)	return std::string(table[i].str);
+	}
+	return std::string();
+}
+
+static vector<OldMsgType> OldTable(const EasyTypeMap &map)
+{
+	vector<OldMsgType> table(map.Size());
+	for (int i = 0; i < map.Size(); i++)
+	{
+		table[i].value = map[i].value;
+		strcpy(table[i].str, map[i].str);
+	}
+	return table;
+}
+
+void ProtocolTest::TestTypeMaps()
+{
+	int failed = 0;
+	if (staticInitMsgType != MSG_SC_DEVICE_LIST_ACK || staticInitAppType != "EasyNVR")	failed++;
+	int checked = 0;
+
+	for (size_t c = 0; c < sizeof(typeMapCases) / sizeof(typeMapCases[0]); c++)
+	{
+		const TypeMapCase &tc = typeMapCases[c];
+		vector<OldMsgType> old = OldTable(*tc.map);
+
+		for (int i = 0; i < tc.map->Size(); i++)
+		{
+			const EASY_TYPE_ENTRY_T &entry = (*tc.map)[i];
+			string str = entry.str;
+
+			//both directions agree with the linear scan, including first-wins on duplicates
+			if (tc.stringOf(entry.value) != OldStringOf(old, entry.value))	failed++;
+			if (tc.typeOf && tc.typeOf(str) != OldTypeOf(old, str))	failed++;
+			if (tc.typeOf && tc.typeOf(tc.stringOf(entry.value)) != entry.value)	failed++;
+
+			//near misses are unknown
+			if (tc.typeOf)
+			{
+				string lower = str;
+				for (size_t k = 0; k < lower.size(); k++)	lower[k] = (char)tolower(lower[k]);
+				if (tc.typeOf(str.substr(0, str.size() - 1)) != OldTypeOf(old, str.substr(0, str.size() - 1)))	failed++;
+				if (tc.typeOf(str + " ") != -1 || tc.typeOf(string(str.c_str(), str.size() + 1)) != -1)	failed++;
+				if (tc.typeOf(lower) != OldTypeOf(old, lower))	failed++;
+			}
+			checked++;
+		}
+
+		//every other value in and around the enum range
+		for (int v = -1000; v < 0x10000; v++)
+		{
+			if (tc.stringOf(v) != OldStringOf(old, v))	failed++;
+		}
+		if (tc.typeOf && (tc.typeOf("") != -1 || tc.typeOf(boost::string_ref()) != -1))	failed++;
+	}
+
+	//a header read back from the wire
+	EasyDevices channels;
+	EasyNVR camera("001001000010", "camera", "123456", "dev", channels);
+	EasyMsgDSRegisterREQ reg(EASY_TERMINAL_TYPE_ARM, EASY_APP_TYPE_CAMERA, camera);
+	EasyProtocol parse(reg.GetMsg());
+	if (parse.GetMsgType() != MSG_DS_REGISTER_REQ || parse.GetTerminalType() != EASY_TERMINAL_TYPE_ARM || parse.GetAppType() != EASY_APP_TYPE_CAMERA)	failed++;
+	if (parse.GetMsgTypeStr() != "MSG_DS_REGISTER_REQ")	failed++;
+
+	cout << "TestTypeMaps: " << (failed == 0 ? "PASS" : "FAIL") << " (" << checked << " entries)" << endl;
+}
+
+//keeps the timed lookups from being optimized away
+static volatile size_t typeMapSink;
+
+void ProtocolTest::BenchTypeMaps()
+{
+	const TypeMapCase *tables[] = {&typeMapCases[0], &typeMapCases[1], &typeMapCases[9]};
+	const char *names[] = {"MessageType", "ErrorString", "PTZ CMD"};
+	const int count = 1000000;
+
+	for (int t = 0; t < 3; t++)
+	{
+		const EasyTypeMap &map = *tables[t]->map;
+		vector<OldMsgType> old = OldTable(map);
+		vector<string> strs;
+		for (int i = 0; i < map.Size(); i++)	strs.push_back(map[i].str);
+
+		size_t sink = 0;
+		clock_t start = clock();
+		for (int i = 0; i < count; i++)	sink += OldStringOf(old, map[i % map.Size()].value).size();
+		double oldString = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for (int i = 0; i < count; i++)	sink += map.String(map[i % map.Size()].value).size();
+		double newString = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for (int i = 0; i < count; i++)	sink += OldTypeOf(old, strs[i % strs.size()]);
+		double oldType = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for (int i = 0; i < count; i++)	sink += map.Value(strs[i % strs.size()]);
+		double newType = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		printf("TypeMap %s (%d entries, %d -> %d bytes): enum->string %.1f -> %.1f ns, string->enum %.1f -> %.1f ns\n",
+			names[t], map.Size(), map.Size() * (int)sizeof(OldMsgType), map.Size() * (int)sizeof(EASY_TYPE_ENTRY_T) + (int)sizeof(EasyTypeMap),
+			oldString * 1e9 / count, newString * 1e9 / count, oldType * 1e9 / count, newType * 1e9 / count);
+		typeMapSink = sink;
+	}
+}
+
+void ProtocolTest::TestMessageCodegen()
+{
+	int failed = 0;
+	string text;
+
+	//stream ACK: the typed encoding is GetMsg() byte for byte, and both decoders read it
+	EASY_MSG_SC_GET_STREAM_ACK_T ack;
+	ack.header.cseq = 7;
+	ack.header.errorNum = 404;
+	ack.serial = "001001000010";
+	ack.channel = "0";
+	ack.protocol = "RTSP";
+	ack.reserve = "1";
+	ack.url = "rtsp://cms.easydarwin.org:554/001001000010/0.sdp?a=\"b\"";
+	text = "stale";		//out is replaced, not appended to
+	EasyEncodeMsg(ack, text);
+
+	EasyJsonValue body;
+	body[EASY_TAG_SERIAL] = ack.serial;
+	body[EASY_TAG_CHANNEL] = ack.channel;
+	body[EASY_TAG_PROTOCOL] = ack.protocol;
+	body[EASY_TAG_RESERVE] = ack.reserve;
+	body[EASY_TAG_URL] = ack.url;
+	EasyMsgSCGetStreamACK oldAck(body, 7, 404);
+	if (text != oldAck.GetMsg())	failed++;
+
+	EASY_MSG_SC_GET_STREAM_ACK_T ackBack;
+	if (!EasyDecodeMsg(oldAck.GetMsg(), ackBack) || ackBack.url != ack.url || ackBack.serial != ack.serial || ackBack.reserve != "1")	failed++;
+	if (ackBack.header.cseq != 7 || ackBack.header.errorNum != 404 || ackBack.header.errorString != EasyProtocol::GetErrorString(404))	failed++;
+	EasyMsgSCGetStreamACK parse(text);
+	if (parse.GetBodyValue(EASY_TAG_URL) != ack.url || parse.GetHeaderValue(EASY_TAG_ERROR_NUM) != "404")	failed++;
+
+	//another message's text, or no message at all, is refused
+	EASY_MSG_CS_FREE_STREAM_REQ_T wrongType;
+	if (EasyDecodeMsg(text, wrongType))	failed++;
+	if (EasyDecodeMsg("", ackBack) || EasyDecodeMsg(text.substr(0, text.size() / 2), ackBack) || EasyDecodeMsg("{\"EasyDarwin\":[}", ackBack))	failed++;
+
+	//PTZ REQ: enums go out as their wire strings, numbers quoted
+	EASY_MSG_CS_PTZ_CONTROL_REQ_T ptz;
+	ptz.header.cseq = 3;
+	ptz.serial = "001001000010";
+	ptz.channel = "1";
+	ptz.protocol = "ONVIF";
+	ptz.actionType = EASY_PTZ_ACTION_TYPE_CONTINUOUS;
+	ptz.command = EASY_PTZ_CMD_TYPE_UP;
+	ptz.speed = 5;
+	ptz.reserve = "1";
+	EasyEncodeMsg(ptz, text);
+
+	body.clear();
+	body[EASY_TAG_SERIAL] = ptz.serial;
+	body[EASY_TAG_CHANNEL] = ptz.channel;
+	body[EASY_TAG_PROTOCOL] = ptz.protocol;
+	body[EASY_TAG_ACTION_TYPE] = EasyProtocol::GetPTZActionTypeString(ptz.actionType).to_string();
+	body[EASY_TAG_CMD] = EasyProtocol::GetPTZCMDTypeString(ptz.command).to_string();
+	body[EASY_TAG_SPEED] = ptz.speed;
+	body[EASY_TAG_RESERVE] = ptz.reserve;
+	EasyMsgCSPTZControlREQ oldPtz(body, 3);
+	if (text != oldPtz.GetMsg())	failed++;
+
+	EASY_MSG_CS_PTZ_CONTROL_REQ_T ptzBack;
+	if (!EasyDecodeMsg(oldPtz.GetMsg(), ptzBack) || ptzBack.actionType != ptz.actionType || ptzBack.command != ptz.command || ptzBack.speed != 5 || ptzBack.header.cseq != 3)	failed++;
+
+	//talkback REQ: optional members stay out until set
+	EASY_MSG_CS_TALKBACK_CONTROL_REQ_T talk;
+	talk.serial = "001001000010";
+	talk.channel = "0";
+	talk.protocol = "ONVIF";
+	talk.command = EASY_TALKBACK_CMD_TYPE_SENDDATA;
+	talk.audioType = EASY_TALKBACK_AUDIO_TYPE_G711A;
+	talk.audioData = "AAECAwQFBgc=";
+	talk.pts = 123456;
+	talk.reserve = "1";
+	EasyEncodeMsg(talk, text);
+
+	body.clear();
+	body[EASY_TAG_SERIAL] = talk.serial;
+	body[EASY_TAG_CHANNEL] = talk.channel;
+	body[EASY_TAG_PROTOCOL] = talk.protocol;
+	body[EASY_TAG_CMD] = EasyProtocol::GetTalkbackCMDTypeString(talk.command).to_string();
+	body[EASY_TAG_AUDIO_TYPE] = EasyProtocol::GetTalkbackAudioTypeString(talk.audioType).to_string();
+	body[EASY_TAG_AUDIO_DATA] = talk.audioData;
+	body[EASY_TAG_PTS] = talk.pts;
+	body[EASY_TAG_RESERVE] = talk.reserve;
+	EasyMsgCSTalkbackControlREQ oldTalk(body, 1);
+	if (text != oldTalk.GetMsg())	failed++;
+
+	talk.transport = "TCP";
+	talk.frameDuration = 20;
+	EasyEncodeMsg(talk, text);
+	body[EASY_TAG_TRANSPORT] = talk.transport;
+	body[EASY_TAG_FRAME_DURATION] = talk.frameDuration;
+	EasyMsgCSTalkbackControlREQ oldTalkFull(body, 1);
+	if (text != oldTalkFull.GetMsg())	failed++;
+
+	EASY_MSG_CS_TALKBACK_CONTROL_REQ_T talkBack;
+	if (!EasyDecodeMsg(text, talkBack) || talkBack.audioData != talk.audioData || talkBack.pts != talk.pts || talkBack.transport != "TCP" || talkBack.frameDuration != 20)	failed++;
+
+	//register REQ: the channel list in EasyDevices (map) order
+	EasyDevices channels;
+	for (int i = 0; i < 4; i++)
+	{
+		EASY_MSG_CHANNEL_T channel;
+		channel.channel = boost::lexical_cast<string>(i);
+		channel.name = "camera" + channel.channel;
+		channel.status = (i & 1) ? "offline" : "online";
+		EasyDevice device(channel.channel, channel.name, channel.status);
+		device.channel_ = channel.channel;
+		channels[channel.channel] = device;
+	}
+	EasyNVR nvr("001001000010", "nvr", "123456", "dev", channels);
+	EasyMsgDSRegisterREQ oldReg(EASY_TERMINAL_TYPE_ARM, EASY_APP_TYPE_NVR, nvr, 9);
+
+	EASY_MSG_DS_REGISTER_REQ_T reg;
+	if (!EasyDecodeMsg(oldReg.GetMsg(), reg) || reg.appType != EASY_APP_TYPE_NVR || reg.terminalType != EASY_TERMINAL_TYPE_ARM)	failed++;
+	if (reg.serial != "001001000010" || reg.token != "123456" || reg.channelCount != 4 || reg.channels.size() != 4 || reg.header.cseq != 9)	failed++;
+	if (reg.channels.size() == 4 && (reg.channels[3].name != "camera3" || reg.channels[3].status != "offline" || !reg.channels[3].serial.empty()))	failed++;
+	EasyEncodeMsg(reg, text);
+	if (text != oldReg.GetMsg())	failed++;
+
+	//device list ACK, empty and full
+	EASY_MSG_SC_DEVICE_LIST_ACK_T list;
+	EasyDevices devices;
+	EasyEncodeMsg(list, text);
+	if (text != EasyMsgSCDeviceListACK(devices).GetMsg())	failed++;
+	for (int i = 0; i < 100; i++)
+	{
+		EASY_MSG_DEVICE_T device;
+		device.serial = "0010010" + boost::lexical_cast<string>(10000 + i);
+		device.name = "device\t" + boost::lexical_cast<string>(i);
+		device.tag = "tag";
+		list.devices.push_back(device);
+		devices[device.serial] = EasyDevice(device.serial, device.name);
+		devices[device.serial].tag_ = device.tag;
+	}
+	list.deviceCount = (int)list.devices.size();
+	EasyEncodeMsg(list, text);
+	string oldList = EasyMsgSCDeviceListACK(devices).GetMsg();
+	if (text != oldList)	failed++;
+
+	EASY_MSG_SC_DEVICE_LIST_ACK_T listBack;
+	vector<char> insitu(oldList.begin(), oldList.end());
+	if (!EasyDecodeMsgInsitu(&insitu[0], insitu.size(), listBack) || listBack.deviceCount != 100 || listBack.devices.size() != 100)	failed++;
+	if (listBack.devices.size() == 100 && (listBack.devices[99].name != "device\t99" || listBack.devices[99].tag != "tag"))	failed++;
+
+	cout << "TestMessageCodegen: " << (failed == 0 ? "PASS" : "FAIL") << endl;
+}
+
+void ProtocolTest::BenchMessageCodegen()
+{
+	EasyJsonValue body;
+	body[EASY_TAG_SERIAL] = string("001001000010");
+	body[EASY_TAG_CHANNEL] = string("0");
+	body[EASY_TAG_PROTOCOL] = string("RTSP");
+	body[EASY_TAG_RESERVE] = string("1");
+	body[EASY_TAG_URL] = string("rtsp://cms.easydarwin.org:554/001001000010/0.sdp");
+
+	EASY_MSG_SC_GET_STREAM_ACK_T ack;
+	ack.serial = "001001000010";
+	ack.channel = "0";
+	ack.protocol = "RTSP";
+	ack.reserve = "1";
+	ack.url = "rtsp://cms.easydarwin.org:554/001001000010/0.sdp";
+
+	const int count = 200000;
+	StreamAckRoundTrip(body);
+
+	size_t before = g_heapAllocations;
+	clock_t start = clock();
+	for (int i = 0; i < count; i++)	StreamAckRoundTrip(body);
+	double classes = (double)(clock() - start) / CLOCKS_PER_SEC;
+	size_t classAllocations = g_heapAllocations - before;
+
+	//the reused struct and string are how a connection would hold them
+	string text;
+	EASY_MSG_SC_GET_STREAM_ACK_T parse;
+	size_t sink = 0;
+	before = g_heapAllocations;
+	start = clock();
+	for (int i = 0; i < count; i++)
+	{
+		EasyEncodeMsg(ack, text);
+		EasyDecodeMsg(text, parse);
+		sink += parse.url.size() + parse.header.errorNum;
+	}
+	double typed = (double)(clock() - start) / CLOCKS_PER_SEC;
+	size_t typedAllocations = g_heapAllocations - before;
+	typeMapSink = sink;
+
+	printf("MessageCodegen SC_GET_STREAM_ACK round trip: classes %.0f msg/s %.1f allocations/msg, typed %.0f msg/s %.1f allocations/msg\n",
+		count / classes, (double)classAllocations / count, count / typed, (double)typedAllocations / count);
+}
+
+//ITU-T G.191 (STL g711.c) written out from the recommendation, independent of EasyG711's tables
+static unsigned char RefALawCompress(short pcm)
+{
+	int ix = pcm < 0 ? (~pcm) >> 4 : pcm >> 4;
+	if (ix > 15)
+	{
+		int iexp = 1;
+		while (ix > 16 + 15)
+		{
+			ix >>= 1;
+			iexp++;
+		}
+		ix -= 16;
+		ix += iexp << 4;
+	}
+	if (pcm >= 0)	ix |= 0x80;
+	return (unsigned char)(ix ^ 0x55);
+}
+
+static short RefALawExpand(unsigned char code)
+{
+	int ix = (code ^ 0x55) & 0x7F;
+	int iexp = ix >> 4;
+	int mant = ix & 0x0F;
+	if (iexp > 0)	mant += 16;
+	mant = (mant << 4) + 8;
+	if (iexp > 1)	mant <<= iexp - 1;
+	return (short)(code > 0x7F ? mant : -mant);
+}
+
+static unsigned char RefULawCompress(short pcm)
+{
+	int absno = pcm < 0 ? ((~pcm) >> 2) + 33 : (pcm >> 2) + 33;
+	if (absno > 0x1FFF)	absno = 0x1FFF;
+	int segno = 1;
+	for (int i = absno >> 6; i != 0; i >>= 1)	segno++;
+	int out = ((8 - segno) << 4) | (0x0F - ((absno >> segno) & 0x0F));
+	if (pcm >= 0)	out |= 0x80;
+	return (unsigned char)out;
+}
+
+static short RefULawExpand(unsigned char code)
+{
+	int mantissa = ~code;
+	int exponent = (mantissa >> 4) & 0x07;
+	int step = 4 << (exponent + 1);
+	mantissa &= 0x0F;
+	int value = (0x80 << exponent) + step * mantissa + step / 2 - 4 * 33;
+	return (short)(code < 0x80 ? -value : value);
+}
+
+void ProtocolTest::TestG711()
+{
+	int failed = 0;
+
+	//G.711 tables 1 and 2: code points at zero, the extremes and segment ends
+	struct { short pcm; unsigned char alaw; unsigned char ulaw; } points[] =
+	{
+		{0, 0xD5, 0xFF}, {-1, 0x55, 0x7F}, {8, 0xD5, 0xFE}, {-8, 0x55, 0x7E},
+		{32767, 0xAA, 0x80}, {-32768, 0x2A, 0x00}, {32256, 0xAA, 0x80}, {-32256, 0x2A, 0x00},
+		{255, 0xDA, 0xE7}, {256, 0xC5, 0xE7}, {4095, 0x9A, 0xAF}, {4096, 0x85, 0xAF}
+	};
+	for (size_t i = 0; i < sizeof(points) / sizeof(points[0]); i++)
+	{
+		if (EasyG711::ALawEncodeSample(points[i].pcm) != points[i].alaw)	failed++;
+		if (EasyG711::ULawEncodeSample(points[i].pcm) != points[i].ulaw)	failed++;
+	}
+	if (EasyG711::ALawDecodeSample(0xD5) != 8 || EasyG711::ALawDecodeSample(0x2A) != -32256 || EasyG711::ALawDecodeSample(0xAA) != 32256)	failed++;
+	if (EasyG711::ULawDecodeSample(0xFF) != 0 || EasyG711::ULawDecodeSample(0x00) != -32124 || EasyG711::ULawDecodeSample(0x80) != 32124)		failed++;
+
+	//every 16 bit input: the reference, the batch SIMD path, and the table tail one sample at a time
+	vector<short> pcm(65536 + 15);
+	for (int i = 0; i < 65536; i++)	pcm[i] = (short)(i - 32768);
+	for (int i = 0; i < 15; i++)	pcm[65536 + i] = (short)(i * 4099);
+	vector<unsigned char> alaw(pcm.size()), ulaw(pcm.size());
+	if (EasyG711::ALawEncode(&alaw[0], &pcm[0], (int)pcm.size()) != (int)pcm.size())	failed++;
+	if (EasyG711::ULawEncode(&ulaw[0], &pcm[0], (int)pcm.size()) != (int)pcm.size())	failed++;
+	for (size_t i = 0; i < pcm.size(); i++)
+	{
+		unsigned char a = EasyG711::ALawEncodeSample(pcm[i]);
+		unsigned char u = EasyG711::ULawEncodeSample(pcm[i]);
+		if (a != RefALawCompress(pcm[i]) || u != RefULawCompress(pcm[i]))	failed++;
+		if (alaw[i] != a || ulaw[i] != u)	failed++;
+
+		unsigned char one;
+		EasyG711::ALawEncode(&one, &pcm[i], 1);
+		if (one != a)	failed++;
+		EasyG711::ULawEncode(&one, &pcm[i], 1);
+		if (one != u)	failed++;
+	}
+	//unaligned start
+	EasyG711::ALawEncode(&alaw[0], &pcm[3], 1000);
+	for (int i = 0; i < 1000; i++)
+	{
+		if (alaw[i] != EasyG711::ALawEncodeSample(pcm[3 + i]))	failed++;
+	}
+
+	//every code: batch decode against the reference, and decode then encode gives the code back
+	unsigned char codes[256 + 3];
+	short decoded[256 + 3];
+	for (int i = 0; i < 256 + 3; i++)	codes[i] = (unsigned char)i;
+	EasyG711::ALawDecode(decoded, codes, 256 + 3);
+	for (int i = 0; i < 256 + 3; i++)
+	{
+		if (decoded[i] != EasyG711::ALawDecodeSample(codes[i]))				failed++;
+		if (decoded[i] != RefALawExpand(codes[i]))							failed++;
+		if (EasyG711::ALawEncodeSample(decoded[i]) != codes[i])				failed++;
+	}
+	EasyG711::ULawDecode(decoded, codes, 256 + 3);
+	for (int i = 0; i < 256 + 3; i++)
+	{
+		if (decoded[i] != EasyG711::ULawDecodeSample(codes[i]))				failed++;
+		if (decoded[i] != RefULawExpand(codes[i]))							failed++;
+		//0x7F is negative zero, it encodes back as 0xFF
+		unsigned char expect = codes[i] == 0x7F ? 0xFF : codes[i];
+		if (EasyG711::ULawEncodeSample(decoded[i]) != expect)				failed++;
+	}
+
+	if (EasyG711::ALawEncode(NULL, &pcm[0], 1) != -1 || EasyG711::ULawDecode(&pcm[0], NULL, 1) != -1)	failed++;
+
+	cout << "TestG711: " << (failed == 0 ? "PASS" : "FAIL") << endl;
+}
+
+void ProtocolTest::BenchG711()
+{
+	const int samples = 1 << 20;
+	vector<short> pcm(samples);
+	vector<unsigned char> code(samples);
+	srand(1);
+	for (int i = 0; i < samples; i++)	pcm[i] = (short)(sin(i * 0.01) * 12000 + rand() % 2000 - 1000);
+
+	const int rounds = 50;
+	size_t sink = 0;
+	clock_t start = clock();
+	for (int r = 0; r < rounds; r++)
+	{
+		for (int i = 0; i < samples; i++)	code[i] = EasyG711::ALawEncodeSample(pcm[i]);
+		sink += code[r];
+	}
+	double refA = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (int r = 0; r < rounds; r++)
+	{
+		for (int i = 0; i < samples; i++)	code[i] = EasyG711::ULawEncodeSample(pcm[i]);
+		sink += code[r];
+	}
+	double refU = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (int r = 0; r < rounds; r++)	EasyG711::ALawEncode(&code[0], &pcm[0], samples);
+	double batchA = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (int r = 0; r < rounds; r++)	EasyG711::ULawEncode(&code[0], &pcm[0], samples);
+	double batchU = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (int r = 0; r < rounds; r++)	EasyG711::ALawDecode(&pcm[0], &code[0], samples);
+	double decA = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (int r = 0; r < rounds; r++)	EasyG711::ULawDecode(&pcm[0], &code[0], samples);
+	double decU = (double)(clock() - start) / CLOCKS_PER_SEC;
+	typeMapSink = sink + pcm[samples / 2];
 
-	cout << "Error: " << rsp_parse.GetHeaderValue("ErrorNum") << ", " << rsp_parse.GetHeaderValue("ErrorString") << endl;
-	cout << "CameraSerial = " << rsp_parse.GetBodyValue("CameraSerial") << endl;
-	cout << "DeviceSerial = " << rsp_parse.GetBodyValue("DeviceSerial") << endl;
+	double total = (double)samples * rounds / 1e6;
+	printf("G711 encode A-law: reference %.0f Msamples/s, batch %.0f Msamples/s\n", total / refA, total / batchA);
+	printf("G711 encode u-law: reference %.0f Msamples/s, batch %.0f Msamples/s\n", total / refU, total / batchU);
+	printf("G711 decode: A-law %.0f Msamples/s, u-law %.0f Msamples/s\n", total / decA, total / decU);
+}
+
+static string TalkbackAck(bool stream, size_t error = EASY_ERROR_SUCCESS_OK)
+{
+	EasyJsonValue body;
+	if (stream)	body[EASY_TAG_TRANSPORT] = string(EASY_TALKBACK_TRANSPORT_STREAM);
+	EasyMsgSCTalkbackControlACK ack(body, 1, error);
+	return ack.GetMsg();
+}
+
+void ProtocolTest::TestTalkback()
+{
+	int failed = 0;
+	short pcm[8000];
+	for (int i = 0; i < 8000; i++)	pcm[i] = (short)(8000 * sin(i * 0.3));
+	string out;
+
+	EasyTalkbackSender sender;
+	if (sender.Open("001001000008", "0", "ONVIF", "127.0.0.1:10000", 99) != -1)								failed++;
+	if (sender.Open("001001000008", "0", "ONVIF", "127.0.0.1:10000", EASY_TALKBACK_AUDIO_TYPE_G711A, 8000, 5) != -1)	failed++;
+	if (sender.Write(pcm, 160, 0, out) != -1 || sender.BuildStop(out) != -1)							failed++;
+
+	//JSON: a server that does not echo the transport gets one SENDDATA request per 40ms batch
+	if (sender.Open("001001000008", "0", "ONVIF", "127.0.0.1:10000") != 0)							failed++;
+	string start = sender.BuildStart();
+	if (start.compare(0, 15, "POST / HTTP/1.1") != 0 || start.find(EASY_TALKBACK_TRANSPORT_STREAM) == string::npos)	failed++;
+	if (sender.OnStartAck(TalkbackAck(false, EASY_ERROR_CLIENT_BAD_REQUEST)) != -1)					failed++;
+	if (sender.OnStartAck(TalkbackAck(false)) != 0 || sender.IsStream())								failed++;
+	if (sender.Write(pcm, 160, 0, out) != 0 || !out.empty())											failed++;
+	if (sender.Write(pcm + 160, 160, 20, out) <= 0 || sender.GetFrames() != 1)							failed++;
+	if (out.compare(0, 15, "POST / HTTP/1.1") != 0 || out.find(EASY_TAG_AUDIO_DATA) == string::npos)		failed++;
+	out.clear();
+	if (sender.BuildStop(out) <= 0 || out.find("POST") != 0)											failed++;
+
+	//stream: header fields, and the nagle timer flushes a partial batch after one batch time
+	if (sender.Open("001001000008", "0", "ONVIF", "127.0.0.1:10000") != 0)							failed++;
+	sender.BuildStart();
+	if (sender.OnStartAck(TalkbackAck(true)) != 0 || !sender.IsStream())								failed++;
+	out.clear();
+	sender.Write(pcm, 100, 0, out);
+	if (sender.Poll(39, out) != 0 || sender.Poll(40, out) != EASY_TALKBACK_FRAME_HEADER + 100)			failed++;
+	const unsigned char *h = (const unsigned char *)out.data();
+	if (out.size() != EASY_TALKBACK_FRAME_HEADER + 100 || h[0] != 'E' || h[1] != 'T' || h[2] != EASY_TALKBACK_FRAME_AUDIO ||
+		h[3] != EASY_TALKBACK_AUDIO_TYPE_G711A || h[5] != 0 || h[9] != 0 || h[10] != 0 || h[11] != 100)
+		failed++;
+	else if (h[EASY_TALKBACK_FRAME_HEADER] != EasyG711::ALawEncodeSample(pcm[0]))						failed++;
+
+	//pacing: a second of audio at once goes out no more than the lead ahead of real time
+	if (sender.Open("001001000008", "0", "ONVIF", "127.0.0.1:10000") != 0)							failed++;
+	sender.OnStartAck(TalkbackAck(true));
+	out.clear();
+	sender.Write(pcm, 8000, 1000, out);
+	if (sender.GetFrames() != 2)																		failed++;	//pts 0 and 40
+	sender.Poll(1040, out);
+	if (sender.GetFrames() != 3)																		failed++;
+	//a poll 1s late: pacing restarts from the late frame instead of bursting the backlog
+	sender.Poll(2040, out);
+	if (sender.GetFrames() != 5)																		failed++;
+	for (unsigned int now = 2060; now <= 2040 + 880; now += 20)	sender.Poll(now, out);
+	if (sender.GetFrames() != 25)																		failed++;
+
+	//receiver: frames split anywhere, a lost frame concealed, garbage skipped, STOP
+	if (sender.Open("001001000008", "0", "ONVIF", "127.0.0.1:10000") != 0)							failed++;
+	sender.OnStartAck(TalkbackAck(true));
+	EasyTalkbackReceiver receiver;
+	if (receiver.Open(8000, 60, 60) != -1 || receiver.Open(8000, 60, 2000) != 0)						failed++;
+	string wire;
+	for (int i = 0; i < 25; i++)
+	{
+		out.clear();
+		sender.Write(pcm + i * 320, 320, i * 40, out);
+		if (i == 5)			continue;						//lost
+		if (i == 10)		wire.append("xyz");				//corrupt
+		wire += out;
+	}
+	out.clear();
+	sender.BuildStop(out);
+	wire += out;
+	int frames = 0;
+	for (size_t pos = 0; pos < wire.size(); pos += 7)	frames += receiver.Input(wire.data() + pos, (int)(wire.size() - pos < 7 ? wire.size() - pos : 7));
+	if (frames != 25 || !receiver.IsStopped() || receiver.GetLostMs() != 40 || receiver.GetResyncs() != 3)	failed++;
+
+	vector<short> played;
+	short block[160];
+	int got;
+	while ((got = receiver.Read(block, 160)) > 0)	played.insert(played.end(), block, block + got);
+	if (played.size() != 8000)																			failed++;
+	else
+	{
+		for (int i = 0; i < 8000; i++)
+		{
+			short expect = (i >= 1600 && i < 1920) ? 0 : EasyG711::ALawDecodeSample(EasyG711::ALawEncodeSample(pcm[i]));
+			if (played[i] != expect)
+			{
+				failed++;
+				break;
+			}
+		}
+	}
+
+	cout << "TestTalkback: " << (failed == 0 ? "PASS" : "FAIL") << endl;
+}
+
+//bytes on the wire and sender cpu per second of 8k audio in 20ms captures, JSON against stream
+void ProtocolTest::BenchTalkback()
+{
+	short pcm[160];
+	for (int i = 0; i < 160; i++)	pcm[i] = (short)(8000 * sin(i * 0.3));
+
+	const int seconds = 600;
+	for (int stream = 0; stream < 2; stream++)
+	{
+		EasyTalkbackSender sender;
+		sender.Open("001001000008", "0", "ONVIF", "127.0.0.1:10000");
+		sender.BuildStart();
+		sender.OnStartAck(TalkbackAck(stream != 0));
+
+		string out;
+		clock_t start = clock();
+		for (int i = 0; i < seconds * 50; i++)
+		{
+			out.clear();
+			sender.Write(pcm, 160, (i + 1) * 20, out);
+		}
+		double cpu = (double)(clock() - start) / CLOCKS_PER_SEC;
+		printf("Talkback %-6s: %.0f bytes/s on the wire, %u frames, %.2f us cpu per second of audio\n",
+			stream ? "stream" : "JSON", (double)sender.GetWireBytes() / seconds, sender.GetFrames(), cpu * 1e6 / seconds);
+	}
+
+	EasyTalkbackSender sender;
+	sender.Open("001001000008", "0", "ONVIF", "127.0.0.1:10000");
+	sender.OnStartAck(TalkbackAck(true));
+	string wire;
+	for (int i = 0; i < seconds * 50; i++)	sender.Write(pcm, 160, (i + 1) * 20, wire);
+
+	EasyTalkbackReceiver receiver;
+	receiver.Open(8000, EASY_TALKBACK_JITTER_PREBUFFER, seconds * 1000);
+	short block[160];
+	clock_t start = clock();
+	for (size_t pos = 0; pos < wire.size(); pos += 1400)
+	{
+		receiver.Input(wire.data() + pos, (int)(wire.size() - pos < 1400 ? wire.size() - pos : 1400));
+		receiver.Read(block, 160);
+	}
+	double cpu = (double)(clock() - start) / CLOCKS_PER_SEC;
+	printf("Talkback receive: %.2f us cpu per second of audio\n", cpu * 1e6 / seconds);
 }
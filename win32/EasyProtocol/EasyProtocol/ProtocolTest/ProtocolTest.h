@@ -24,8 +24,6 @@ public:
     virtual ~ProtocolTest();
     
 public:
-    //void TestCreateSessionReq();
-    //void TestCreateSessionAck();
 	void TestRegisterReq();
 	void TestRegisterRsp();
 
@@ -43,6 +41,39 @@ public:
 	void TestDeviceSnapReq();
 	void TestDeviceSnapRsp();
 
+	void TestBase64();
+	void BenchBase64();
+
+	void TestDeviceTable();
+	void BenchDeviceList();
+
+	void TestBorrowedParse();
+	void BenchBorrowedParse();
+
+	void TestDeviceRegistry();
+	void BenchDeviceRegistry();
+
+	void TestHttpClient();
+	void BenchHttpClient();
+	void TestFetchScheduler();
+	void BenchFetchScheduler();
+	void BenchMessages();
+
+	void TestJsonWriter();
+	void BenchJsonWriter();
+
+	void TestTypeMaps();
+	void BenchTypeMaps();
+
+	void TestMessageCodegen();
+	void BenchMessageCodegen();
+
+	void TestG711();
+	void BenchG711();
+
+	void TestTalkback();
+	void BenchTalkback();
+
 private:
     void PrintMsg(const char *msg);
 };
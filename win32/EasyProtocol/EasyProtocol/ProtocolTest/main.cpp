@@ -13,18 +13,91 @@
 
 #include <cstdlib>
 #include "ProtocolTest.h"
+#include "ProtocolBench.h"
 #include <stdio.h>
+#include <string.h>
 
 using namespace std;
 
-/*
- * 
- */
+static int Usage()
+{
+	printf("usage: protocoltest                  message tests\n"
+		"       protocoltest micro            single-topic benchmarks\n"
+		"       protocoltest bench [-t seconds] [-s save.txt] [-b baseline.txt] [-r tolerance]\n"
+		"       protocoltest corpus dir       seed inputs for protocolfuzz\n");
+	return 2;
+}
+
+//exit status 1 when a baseline is given and the run falls behind it
+static int RunBench(int argc, char** argv)
+{
+	double seconds = 0.1;
+	double tolerance = 0.15;
+	const char *save = NULL;
+	const char *baseline = NULL;
+	for (int i = 2; i < argc; i += 2)
+	{
+		if (i + 1 >= argc)						return Usage();
+		else if (strcmp(argv[i], "-t") == 0)	seconds = atof(argv[i + 1]);
+		else if (strcmp(argv[i], "-s") == 0)	save = argv[i + 1];
+		else if (strcmp(argv[i], "-b") == 0)	baseline = argv[i + 1];
+		else if (strcmp(argv[i], "-r") == 0)	tolerance = atof(argv[i + 1]);
+		else									return Usage();
+	}
+
+	ProtocolBench bench(seconds);
+	vector<BENCH_RESULT_T> results;
+	bench.Run(results);
+	ProtocolBench::Print(results);
+
+	if (save && !ProtocolBench::Save(save, results))
+	{
+		printf("cannot write %s\n", save);
+		return 1;
+	}
+
+	if (baseline)
+	{
+		int regressions = ProtocolBench::Compare(baseline, results, tolerance);
+		if (regressions < 0)
+		{
+			printf("cannot read %s\n", baseline);
+			return 1;
+		}
+		printf("%d regressions against %s (tolerance %.0f%%)\n", regressions, baseline, tolerance * 100);
+		return regressions == 0 ? 0 : 1;
+	}
+	return 0;
+}
+
 int main(int argc, char** argv)
 {
+	if (argc > 1 && strcmp(argv[1], "bench") == 0)	return RunBench(argc, argv);
+	if (argc == 3 && strcmp(argv[1], "corpus") == 0)
+	{
+		ProtocolBench bench;
+		return bench.WriteCorpus(argv[2]) ? 0 : 1;
+	}
+
     ProtocolTest test;
-	//test.TestEasyDSSSnapUpdateReq();
-	//test.TestEasyDSSSnapUpdateAck();
+	if (argc == 2 && strcmp(argv[1], "micro") == 0)
+	{
+		test.BenchBase64();
+		test.BenchDeviceList();
+		test.BenchBorrowedParse();
+		test.BenchDeviceRegistry();
+		test.BenchHttpClient();
+		test.BenchFetchScheduler();
+		test.BenchMessages();
+		test.BenchJsonWriter();
+		test.BenchTypeMaps();
+		test.BenchMessageCodegen();
+		test.BenchG711();
+		test.BenchTalkback();
+		return 0;
+	}
+	if (argc > 1)	return Usage();
+
 	test.TestRegisterReq();
 	test.TestRegisterRsp();
 	test.TestDeviceStreamReq();
@@ -40,7 +113,20 @@ int main(int argc, char** argv)
 	test.TestDeviceSnapReq();
 	test.TestDeviceSnapRsp();
 
+	test.TestBase64();
+	test.TestDeviceTable();
+	test.TestBorrowedParse();
+	test.TestDeviceRegistry();
+	test.TestHttpClient();
+	test.TestFetchScheduler();
+	test.TestJsonWriter();
+	test.TestTypeMaps();
+	test.TestMessageCodegen();
+	test.TestG711();
+	test.TestTalkback();
+
+#ifdef _WIN32
 	getchar();
+#endif
     return 0;
 }
-
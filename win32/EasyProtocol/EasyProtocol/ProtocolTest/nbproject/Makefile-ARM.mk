@@ -35,6 +35,7 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
+	${OBJECTDIR}/ProtocolBench.o \
 	${OBJECTDIR}/ProtocolTest.o \
 	${OBJECTDIR}/main.o
 
@@ -53,7 +54,7 @@ FFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=-L../${CND_CONF} -L../../lib/Linux/ARM
+LDLIBSOPTIONS=-L../${CND_CONF} -L../../jsoncpp/${CND_CONF} -L../../lib/Linux/ARM
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -61,17 +62,22 @@ LDLIBSOPTIONS=-L../${CND_CONF} -L../../lib/Linux/ARM
 
 ${CND_CONF}/protocoltest: ${OBJECTFILES}
 	${MKDIR} -p ${CND_CONF}
-	${LINK.cc} -o ${CND_CONF}/protocoltest ${OBJECTFILES} ${LDLIBSOPTIONS} -lEasyProtocol -ljsoncpp
+	${LINK.cc} -o ${CND_CONF}/protocoltest ${OBJECTFILES} ${LDLIBSOPTIONS} -lEasyProtocol -ljsoncpp -lpthread
+
+${OBJECTDIR}/ProtocolBench.o: ProtocolBench.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../jsoncpp/include -I../../Include/ -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/ProtocolBench.o ProtocolBench.cpp
 
 ${OBJECTDIR}/ProtocolTest.o: ProtocolTest.cpp 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
-	$(COMPILE.cc) -O2 -I../../Include/ -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/ProtocolTest.o ProtocolTest.cpp
+	$(COMPILE.cc) -O2 -I../../jsoncpp/include -I../../Include/ -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/ProtocolTest.o ProtocolTest.cpp
 
 ${OBJECTDIR}/main.o: main.cpp 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
-	$(COMPILE.cc) -O2 -I../../Include/ -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/main.o main.cpp
+	$(COMPILE.cc) -O2 -I../../jsoncpp/include -I../../Include/ -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/main.o main.cpp
 
 # Subprojects
 .build-subprojects:
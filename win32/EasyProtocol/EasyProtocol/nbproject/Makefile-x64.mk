@@ -37,7 +37,20 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 OBJECTFILES= \
 	${OBJECTDIR}/EasyProtocol.o \
 	${OBJECTDIR}/EasyProtocolBase.o \
-	${OBJECTDIR}/EasyUtil.o
+	${OBJECTDIR}/EasyUtil.o \
+	${OBJECTDIR}/EasyG711.o \
+	${OBJECTDIR}/EasyTalkback.o \
+	${OBJECTDIR}/EasyBase64.o \
+	${OBJECTDIR}/EasyJsonReader.o \
+	${OBJECTDIR}/EasyDeviceTable.o \
+	${OBJECTDIR}/EasyJsonPool.o \
+	${OBJECTDIR}/EasyJsonWriter.o \
+	${OBJECTDIR}/EasyTypeMap.o \
+	${OBJECTDIR}/EasyMessageCodec.o \
+	${OBJECTDIR}/EasyMessages.o \
+	${OBJECTDIR}/EasyDeviceRegistry.o \
+	${OBJECTDIR}/EasyHttpClient.o \
+	${OBJECTDIR}/EasyFetchScheduler.o
 
 
 # C Compiler Flags
@@ -81,6 +94,71 @@ ${OBJECTDIR}/EasyUtil.o: EasyUtil.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyUtil.o EasyUtil.cpp
 
+${OBJECTDIR}/EasyG711.o: EasyG711.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyG711.o EasyG711.cpp
+
+${OBJECTDIR}/EasyTalkback.o: EasyTalkback.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyTalkback.o EasyTalkback.cpp
+
+${OBJECTDIR}/EasyBase64.o: EasyBase64.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyBase64.o EasyBase64.cpp
+
+${OBJECTDIR}/EasyJsonReader.o: EasyJsonReader.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyJsonReader.o EasyJsonReader.cpp
+
+${OBJECTDIR}/EasyDeviceTable.o: EasyDeviceTable.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyDeviceTable.o EasyDeviceTable.cpp
+
+${OBJECTDIR}/EasyJsonPool.o: EasyJsonPool.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyJsonPool.o EasyJsonPool.cpp
+
+${OBJECTDIR}/EasyJsonWriter.o: EasyJsonWriter.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyJsonWriter.o EasyJsonWriter.cpp
+
+${OBJECTDIR}/EasyTypeMap.o: EasyTypeMap.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyTypeMap.o EasyTypeMap.cpp
+
+${OBJECTDIR}/EasyMessageCodec.o: EasyMessageCodec.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyMessageCodec.o EasyMessageCodec.cpp
+
+${OBJECTDIR}/EasyMessages.o: EasyMessages.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyMessages.o EasyMessages.cpp
+
+${OBJECTDIR}/EasyDeviceRegistry.o: EasyDeviceRegistry.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyDeviceRegistry.o EasyDeviceRegistry.cpp
+
+${OBJECTDIR}/EasyHttpClient.o: EasyHttpClient.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyHttpClient.o EasyHttpClient.cpp
+
+${OBJECTDIR}/EasyFetchScheduler.o: EasyFetchScheduler.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../jsoncpp/include -I../Include -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/EasyFetchScheduler.o EasyFetchScheduler.cpp
+
 # Subprojects
 .build-subprojects:
 
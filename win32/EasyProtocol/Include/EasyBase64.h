@@ -0,0 +1,74 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyBase64.h
+ *
+ * RFC 4648 Base64 on caller buffers, one shot or chunked.
+ * SSSE3/AVX2 kernels are picked at runtime on x86, NEON is used when the
+ * compiler targets it, with a table driven scalar path for the rest.
+ * The decoder skips CR/LF, accepts missing padding and rejects anything
+ * else outside the alphabet.
+*/
+
+#ifndef EASY_BASE64_H
+#define	EASY_BASE64_H
+
+#include <EasyProtocolDef.h>
+#include <stddef.h>
+
+class Easy_API EasyBase64
+{
+public:
+	static size_t EncodeLength(size_t len)	{return (len + 2) / 3 * 4;}
+	static size_t DecodeLength(size_t len)	{return (len + 3) / 4 * 3;}		//upper bound
+
+	//return the number of bytes written, -1 if dest is too small or the input is not Base64
+	static int Encode(char *dest, size_t size, const unsigned char *src, size_t len);
+	static int Decode(unsigned char *dest, size_t size, const char *src, size_t len);
+
+	//"avx2", "ssse3", "neon" or "scalar"
+	static const char* GetKernel();
+	//false forces the scalar path, for tests and benchmarks
+	static void EnableSimd(bool enable);
+};
+
+class Easy_API EasyBase64Encoder
+{
+public:
+	EasyBase64Encoder();
+
+	void Reset();
+	//dest needs EasyBase64::EncodeLength(len + 2) chars; returns chars written or -1
+	int Update(char *dest, size_t size, const unsigned char *src, size_t len);
+	//writes the last group with padding, up to 4 chars
+	int Final(char *dest, size_t size);
+
+private:
+	unsigned char carry_[2];
+	int carryLen_;
+};
+
+class Easy_API EasyBase64Decoder
+{
+public:
+	EasyBase64Decoder();
+
+	void Reset();
+	//dest needs EasyBase64::DecodeLength(len + 3) bytes; returns bytes written or -1
+	int Update(unsigned char *dest, size_t size, const char *src, size_t len);
+	//flushes an unpadded tail, up to 2 bytes; -1 if the input ended inside a group
+	int Final(unsigned char *dest, size_t size);
+
+private:
+	unsigned char quad_[4];
+	int quadLen_;
+	int pad_;
+	bool end_;
+	bool error_;
+};
+
+#endif	/* EASY_BASE64_H */
@@ -0,0 +1,83 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyDeviceRegistry.h
+ *
+ * Last device list seen from the CMS, keyed by serial. Each Update diffs a new
+ * MSG_SC_DEVICE_LIST_ACK against it and tells a listener only what was added,
+ * removed or changed, so a client no longer rebuilds its whole view on every
+ * refresh. It also remembers which NVRs already have their channels from
+ * getdeviceinfo, so those are fetched again only when the NVR changed.
+*/
+
+#ifndef EASY_DEVICE_REGISTRY_H
+#define	EASY_DEVICE_REGISTRY_H
+
+#include <EasyProtocol.h>
+#include <EasyDeviceTable.h>
+#include <vector>
+
+namespace EasyDarwin { namespace Protocol
+{
+	//called from Update, in serial order; the references are only valid during the call
+	class Easy_API EasyDeviceRegistryListener
+	{
+	public:
+		virtual ~EasyDeviceRegistryListener() {}
+
+		virtual void OnDeviceAdded(const EasyDevice& device) = 0;
+		virtual void OnDeviceRemoved(const EasyDevice& device) = 0;
+		virtual void OnDeviceChanged(const EasyDevice& before, const EasyDevice& after) = 0;
+	};
+
+	typedef struct __EASY_REGISTRY_DELTA_T
+	{
+		size_t added;
+		size_t removed;
+		size_t changed;
+		size_t unchanged;
+	}EASY_REGISTRY_DELTA_T;
+
+	class Easy_API EasyDeviceRegistry
+	{
+	public:
+		EasyDeviceRegistry();
+		~EasyDeviceRegistry() {}
+
+		//makes the list the new snapshot and reports the differences to listener (may be NULL);
+		//a serial listed twice keeps its last entry, as EasyMsgSCDeviceListACK::GetDevices does
+		EASY_REGISTRY_DELTA_T Update(const EasyDeviceTable& table, EasyDeviceRegistryListener *listener);
+		EASY_REGISTRY_DELTA_T Update(const EasyDevices& devices, EasyDeviceRegistryListener *listener);
+
+		//an NVR whose channels were never set, or that changed since; SnapURL alone does not count
+		bool NeedsChannels(const string& serial) const;
+		void SetChannels(const string& serial, const EasyDevices& channels);
+		//NULL unless NeedsChannels would return false
+		const EasyDevices* GetChannels(const string& serial) const;
+		//the next Update or NeedsChannels asks for every NVR again
+		void InvalidateChannels();
+
+		const EasyDevice* Find(const string& serial) const;
+		size_t Size() const		{return entries_.size();}
+		void Clear()			{entries_.clear();}
+
+	private:
+		typedef struct __REGISTRY_ENTRY_T
+		{
+			EasyDevice device;
+			EasyDevices channels;
+			bool channelsValid;
+		}REGISTRY_ENTRY_T;
+
+		EASY_REGISTRY_DELTA_T Merge(vector<const EASY_DEVICE_ENTRY_T*>& sorted, EasyDeviceRegistryListener *listener);
+		const REGISTRY_ENTRY_T* Lookup(boost::string_ref serial) const;
+
+		vector<REGISTRY_ENTRY_T> entries_;		//sorted by serial
+	};
+}}//namespace
+
+#endif	/* EASY_DEVICE_REGISTRY_H */
@@ -0,0 +1,84 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyDeviceTable.h
+ *
+ * Flat device table filled straight from MSG_SC_DEVICE_LIST_ACK /
+ * MSG_SC_DEVICE_INFO_ACK by EasyJsonReader. The message is copied once into
+ * the table's arena and every field is a string_ref into it.
+*/
+
+#ifndef EASY_DEVICE_TABLE_H
+#define	EASY_DEVICE_TABLE_H
+
+#include <EasyProtocolDef.h>
+#include <boost/utility/string_ref.hpp>
+#include <vector>
+#include <utility>
+using namespace std;
+
+namespace EasyDarwin { namespace Protocol
+{
+	typedef struct __EASY_DEVICE_ENTRY_T
+	{
+		boost::string_ref serial;
+		boost::string_ref name;
+		boost::string_ref tag;
+		boost::string_ref snapURL;
+		boost::string_ref appType;
+		boost::string_ref terminalType;
+		boost::string_ref status;
+		boost::string_ref channel;
+	}EASY_DEVICE_ENTRY_T;
+
+	typedef pair<boost::string_ref, boost::string_ref> EasyJsonField;
+
+	class Easy_API EasyDeviceTable
+	{
+	public:
+		EasyDeviceTable();
+		EasyDeviceTable(const EasyDeviceTable& other);
+		EasyDeviceTable& operator=(const EasyDeviceTable& other);
+		~EasyDeviceTable() {}
+
+		//"Devices" of MSG_SC_DEVICE_LIST_ACK, returns the number of entries or -1
+		int ParseDeviceList(const char *msg, size_t len);
+		//"Channels" of MSG_SC_DEVICE_INFO_ACK
+		int ParseDeviceInfo(const char *msg, size_t len);
+		void Clear();
+
+		size_t Size() const									{return entries_.size();}
+		const EASY_DEVICE_ENTRY_T& operator[](size_t i) const	{return entries_[i];}
+
+		//last entry with this serial, as a map keyed by serial would keep; NULL if none
+		const EASY_DEVICE_ENTRY_T* Find(boost::string_ref serial);
+
+		//scalar members of "Header" and "Body", null reads as ""
+		boost::string_ref GetHeaderValue(boost::string_ref tag) const;
+		boost::string_ref GetBodyValue(boost::string_ref tag) const;
+		const vector<EasyJsonField>& GetHeader() const		{return header_;}
+		const vector<EasyJsonField>& GetBody() const		{return body_;}
+		//false when Header or Body hold an object or array other than the list, which the
+		//table leaves out; read the message with jsoncpp to get at those
+		bool IsComplete() const								{return complete_;}
+
+		size_t GetMemorySize() const;
+
+	private:
+		int Parse(const char *msg, size_t len, const char *listTag, const char *countTag);
+		void Rebase(const EasyDeviceTable& other);
+
+		vector<char> arena_;
+		vector<EASY_DEVICE_ENTRY_T> entries_;
+		vector<EasyJsonField> header_;
+		vector<EasyJsonField> body_;
+		vector<unsigned int> index_;		//entries sorted by serial, built by Find
+		bool complete_;
+	};
+}}//namespace
+
+#endif	/* EASY_DEVICE_TABLE_H */
@@ -0,0 +1,121 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyFetchScheduler.h
+ *
+ * Concurrent GETs for what follows a device list: getdeviceinfo of every
+ * NVR and the SnapURL JPEG of every device. Each host gets its own
+ * EasyHttpClient and at most perHost requests in flight; what waits is
+ * served by priority, so items visible in the tree go first. A URL asked
+ * for again while queued or in flight is fetched once, and a body meant for
+ * disk is written to the file as it arrives instead of being held in memory.
+*/
+
+#ifndef EASY_FETCH_SCHEDULER_H
+#define	EASY_FETCH_SCHEDULER_H
+
+#include <EasyHttpClient.h>
+#include <map>
+#include <set>
+
+#define EASY_FETCH_DEFAULT_PER_HOST						4			//requests in flight per host
+
+#define EASY_FETCH_PRIORITY_NORMAL						0
+#define EASY_FETCH_PRIORITY_VISIBLE						1			//shown in the tree, fetched first
+
+#define EASY_FETCH_ERROR_FILE							-10			//the file could not be written
+
+namespace EasyDarwin { namespace Protocol
+{
+	class Easy_API EasyFetchHandler
+	{
+	public:
+		virtual ~EasyFetchHandler() {}
+
+		//called on a fetch thread; response.body is empty when the body went to a file
+		virtual void OnFetched(const string& url, void *context, const EASY_HTTP_RESPONSE_T& response) = 0;
+	};
+
+	class Easy_API EasyFetchScheduler : private EasyHttpHandler
+	{
+	public:
+		EasyFetchScheduler(int perHost = EASY_FETCH_DEFAULT_PER_HOST, int timeoutMs = EASY_HTTP_DEFAULT_TIMEOUT);
+		//fetches still queued are reported as EASY_HTTP_ERROR_CANCELLED, running ones complete
+		~EasyFetchScheduler();
+
+		//queues an http:// url, false for anything else. A url already queued or running is
+		//fetched once and every handler gets the same response, written to the file of the first
+		//call if it gave one. With a file the body goes to file + ".part" and is renamed to file
+		//once complete, so an interrupted download never looks like a snapshot
+		bool Fetch(const string& url, int priority, EasyFetchHandler *handler, void *context, const string& file = string());
+		//moves a queued url; false once it has started or finished
+		bool SetPriority(const string& url, int priority);
+		//blocks until every fetch has been reported
+		void Wait();
+		//reports the queued fetches as EASY_HTTP_ERROR_CANCELLED, running ones complete; with
+		//stop, later Fetch calls fail too
+		void Cancel(bool stop = false);
+
+		unsigned int GetRequests()	{return requests_;}		//HTTP requests made
+		unsigned int GetMerged()	{return merged_;}		//Fetch calls served by another one's request
+
+	private:
+		typedef struct __FETCH_WAITER_T
+		{
+			EasyFetchHandler *handler;
+			void *context;
+		}FETCH_WAITER_T;
+
+		struct __FETCH_HOST_T;
+
+		typedef struct __FETCH_ITEM_T
+		{
+			string url;
+			string path;
+			int priority;
+			unsigned int seq;			//FIFO among equal priorities
+			bool running;
+			struct __FETCH_HOST_T *host;
+			EasyHttpSink *sink;			//NULL unless written to a file
+			vector<FETCH_WAITER_T> waiters;
+		}FETCH_ITEM_T;
+
+		struct ItemOrder
+		{
+			bool operator()(const FETCH_ITEM_T *a, const FETCH_ITEM_T *b) const
+			{
+				return a->priority != b->priority ? a->priority > b->priority : a->seq < b->seq;
+			}
+		};
+
+		typedef struct __FETCH_HOST_T
+		{
+			EasyHttpClient *client;
+			int running;
+			set<FETCH_ITEM_T*, ItemOrder> queue;
+		}FETCH_HOST_T;
+
+		EasyFetchScheduler(const EasyFetchScheduler&);
+		EasyFetchScheduler& operator=(const EasyFetchScheduler&);
+
+		virtual void OnHttpResponse(const string& path, void *context, const EASY_HTTP_RESPONSE_T& response);
+		//lock held
+		void Dispatch(FETCH_HOST_T *host);
+
+		int perHost_;
+		int timeoutMs_;
+		void *lock_;
+		bool stopping_;
+		map<string, FETCH_HOST_T*> hosts_;			//"host:port"
+		map<string, FETCH_ITEM_T*> items_;			//by url, until reported
+		unsigned int seq_;
+		unsigned int requests_;
+		unsigned int merged_;
+	};
+}}//namespace
+
+#endif	/* EASY_FETCH_SCHEDULER_H */
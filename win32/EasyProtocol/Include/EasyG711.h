@@ -0,0 +1,37 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyG711.h
+ *
+ * G.711 A-law/u-law codec shared by the Windows, Android (JNI) and iOS clients.
+ * Decoding uses 256-entry tables; encoding uses a branch-free SSE2/NEON
+ * formulation with a 4K (A-law) / 16K (u-law) table for the remaining samples.
+ * All paths are bit-exact with the ITU-T G.191 reference (EncodeSample/DecodeSample).
+*/
+
+#ifndef EASY_G711_H
+#define	EASY_G711_H
+
+#include <EasyProtocolDef.h>
+
+class Easy_API EasyG711
+{
+public:
+	//batch APIs, 16bit pcm <-> one byte per sample, return the number of samples
+	static int ALawEncode(unsigned char *pOut, const short *pPcm, int samples);
+	static int ALawDecode(short *pPcm, const unsigned char *pIn, int bytes);
+	static int ULawEncode(unsigned char *pOut, const short *pPcm, int samples);
+	static int ULawDecode(short *pPcm, const unsigned char *pIn, int bytes);
+
+	//ITU-T G.191 reference formulation, one sample
+	static unsigned char ALawEncodeSample(short pcm);
+	static short ALawDecodeSample(unsigned char code);
+	static unsigned char ULawEncodeSample(short pcm);
+	static short ULawDecodeSample(unsigned char code);
+};
+
+#endif	/* EASY_G711_H */
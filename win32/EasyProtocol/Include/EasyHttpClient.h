@@ -0,0 +1,152 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyHttpClient.h
+ *
+ * HTTP/1.1 GET client for the CMS API (getdevicelist, getdeviceinfo,
+ * getdevicestream, ptzcontrol). One client per CMS host keeps a small pool
+ * of keep-alive connections, so a call normally costs one round trip rather
+ * than a TCP handshake as well. Bodies are read by Content-Length or chunked
+ * framing straight into the response string, sized up front when the length
+ * is known. Several GETs can be pipelined on one connection, and GetAsync
+ * hands requests to worker threads that report back through a handler.
+*/
+
+#ifndef EASY_HTTP_CLIENT_H
+#define	EASY_HTTP_CLIENT_H
+
+#include <EasyProtocolDef.h>
+#include <string>
+#include <vector>
+#include <list>
+using namespace std;
+
+#define EASY_HTTP_DEFAULT_CONNECTIONS					4			//idle keep-alive connections kept, also the async worker count
+#define EASY_HTTP_DEFAULT_TIMEOUT						5000		//ms for connect, send and every receive
+
+#define EASY_HTTP_ERROR_CONNECT							-1			//host not resolved or connection refused
+#define EASY_HTTP_ERROR_SEND							-2
+#define EASY_HTTP_ERROR_RECV							-3			//closed or timed out before the response was complete
+#define EASY_HTTP_ERROR_RESPONSE						-4			//not an HTTP/1.x response
+#define EASY_HTTP_ERROR_CANCELLED						-5			//still queued when the client was destroyed
+
+namespace EasyDarwin { namespace Protocol
+{
+	typedef struct __EASY_HTTP_RESPONSE_T
+	{
+		int status;					//HTTP status code, or EASY_HTTP_ERROR_*
+		string body;
+	}EASY_HTTP_RESPONSE_T;
+
+	class Easy_API EasyHttpHandler
+	{
+	public:
+		virtual ~EasyHttpHandler() {}
+
+		//called on a worker thread, or from ~EasyHttpClient with EASY_HTTP_ERROR_CANCELLED
+		virtual void OnHttpResponse(const string& path, void *context, const EASY_HTTP_RESPONSE_T& response) = 0;
+	};
+
+	class Easy_API EasyHttpSink
+	{
+	public:
+		virtual ~EasyHttpSink() {}
+
+		//body bytes of a 2xx response as they arrive; false aborts it with EASY_HTTP_ERROR_RECV
+		virtual bool OnHttpBody(const char *data, size_t len) = 0;
+	};
+
+	class Easy_API EasyHttpClient
+	{
+	public:
+		EasyHttpClient(const string& host, unsigned short port, int connections = EASY_HTTP_DEFAULT_CONNECTIONS,
+			int timeoutMs = EASY_HTTP_DEFAULT_TIMEOUT);
+		//joins the workers; requests still queued are cancelled
+		~EasyHttpClient();
+
+		//blocking GET of path ("/API/getdevicelist?..."), returns response.status;
+		//a keep-alive connection the server closed meanwhile is retried once on a new one.
+		//With a sink a 2xx body goes to the sink and response.body stays empty
+		int Get(const string& path, EASY_HTTP_RESPONSE_T& response, EasyHttpSink *sink = NULL);
+		//writes every request before reading the first response; responses[i] answers paths[i].
+		//returns the number of responses with a status, the rest carry an EASY_HTTP_ERROR_*
+		int Pipeline(const vector<string>& paths, vector<EASY_HTTP_RESPONSE_T>& responses);
+		//queues a GET for the worker threads; handler may be NULL for fire-and-forget calls.
+		//Requests run in queue order only with a single connection
+		void GetAsync(const string& path, EasyHttpHandler *handler, void *context, EasyHttpSink *sink = NULL);
+		//blocks until every queued request has completed
+		void Wait();
+
+		const string& GetHost()		{return host_;}
+		unsigned short GetPort()	{return port_;}
+		//TCP connections opened so far, for telling reuse from reconnects
+		unsigned int GetConnects()	{return connects_;}
+
+		//"http://host[:port]/path" into its parts, port 80 when absent
+		static bool SplitURL(const string& url, string& host, unsigned short& port, string& path);
+
+	private:
+		typedef struct __HTTP_CONNECTION_T
+		{
+			long long fd;
+			string in;				//received but not yet parsed
+			size_t inPos;
+			bool reused;			//served a request before
+			unsigned long long received;
+		}HTTP_CONNECTION_T;
+
+		typedef struct __HTTP_JOB_T
+		{
+			string path;
+			EasyHttpHandler *handler;
+			void *context;
+			EasyHttpSink *sink;
+		}HTTP_JOB_T;
+
+		EasyHttpClient(const EasyHttpClient&);
+		EasyHttpClient& operator=(const EasyHttpClient&);
+
+		HTTP_CONNECTION_T* Acquire();
+		void Release(HTTP_CONNECTION_T *conn, bool keepAlive);
+		void Close(HTTP_CONNECTION_T *conn);
+		void CloseIdle();
+		HTTP_CONNECTION_T* Connect();
+
+		string Request(const string& path);
+		bool Send(HTTP_CONNECTION_T *conn, const string& data);
+		//status line, headers and body of the next response on conn
+		bool Receive(HTTP_CONNECTION_T *conn, EASY_HTTP_RESPONSE_T& response, bool& keepAlive, EasyHttpSink *sink);
+		bool Fill(HTTP_CONNECTION_T *conn);
+		bool ReadLine(HTTP_CONNECTION_T *conn, string& line);
+		bool ReadBody(HTTP_CONNECTION_T *conn, size_t length, string& body, EasyHttpSink *sink);
+
+		//shared by Get, Pipeline and the workers
+		void Exchange(const string *paths, size_t count, EASY_HTTP_RESPONSE_T *responses, EasyHttpSink *sink);
+
+		void StartWorkers();
+#ifdef _WIN32
+		static unsigned int __stdcall Worker(void *param);
+#else
+		static void* Worker(void *param);
+#endif
+		void RunJobs();
+
+		string host_;
+		unsigned short port_;
+		int connections_;
+		int timeoutMs_;
+		unsigned int connects_;
+		vector<HTTP_CONNECTION_T*> idle_;
+
+		void *sync_;				//lock, queue and idle signals, worker threads; see EasyHttpClient.cpp
+		list<HTTP_JOB_T> jobs_;
+		size_t busy_;				//queued plus running
+		bool stopping_;
+	};
+}}//namespace
+
+#endif	/* EASY_HTTP_CLIENT_H */
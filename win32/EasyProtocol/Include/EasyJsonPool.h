@@ -0,0 +1,70 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyJsonPool.h
+ *
+ * Idle Json::Reader / EasyJsonWriter objects shared by all EasyProtocol
+ * messages. Their buffers keep their capacity between messages, so a parse
+ * or a GetMsg() no longer starts from empty containers every time.
+*/
+
+#ifndef EASY_JSON_POOL_H
+#define	EASY_JSON_POOL_H
+
+#include <EasyProtocolDef.h>
+#include <json/json.h>
+#include <EasyJsonWriter.h>
+
+#define EASY_JSON_POOL_SIZE								8			//idle objects kept per type
+
+namespace EasyDarwin { namespace Protocol
+{
+	class Easy_API EasyJsonPool
+	{
+	public:
+		static Json::Reader* GetReader();
+		static void PutReader(Json::Reader *reader);
+		static EasyJsonWriter* GetWriter();
+		static void PutWriter(EasyJsonWriter *writer);
+
+		//frees the idle objects
+		static void Clear();
+	};
+
+	//borrows a pooled reader for the current scope
+	class EasyPooledReader
+	{
+	public:
+		EasyPooledReader() : reader_(EasyJsonPool::GetReader()) {}
+		~EasyPooledReader() { EasyJsonPool::PutReader(reader_); }
+
+		Json::Reader* operator->() { return reader_; }
+
+	private:
+		EasyPooledReader(const EasyPooledReader&);
+		EasyPooledReader& operator=(const EasyPooledReader&);
+
+		Json::Reader *reader_;
+	};
+
+	class EasyPooledWriter
+	{
+	public:
+		EasyPooledWriter() : writer_(EasyJsonPool::GetWriter()) {}
+		~EasyPooledWriter() { EasyJsonPool::PutWriter(writer_); }
+
+		EasyJsonWriter* operator->() { return writer_; }
+
+	private:
+		EasyPooledWriter(const EasyPooledWriter&);
+		EasyPooledWriter& operator=(const EasyPooledWriter&);
+
+		EasyJsonWriter *writer_;
+	};
+}}//namespace
+
+#endif	/* EASY_JSON_POOL_H */
@@ -0,0 +1,49 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyJsonReader.h
+ *
+ * Event driven JSON reader for the large list messages. It parses in place:
+ * strings are unescaped inside the caller's buffer and handed out as
+ * pointer/length pairs, so no DOM and no per value allocation is made.
+*/
+
+#ifndef EASY_JSON_READER_H
+#define	EASY_JSON_READER_H
+
+#include <EasyProtocolDef.h>
+#include <stddef.h>
+
+#define EASY_JSON_MAX_DEPTH								64
+
+namespace EasyDarwin { namespace Protocol
+{
+	//return false from any event to stop parsing
+	class Easy_API EasyJsonHandler
+	{
+	public:
+		virtual ~EasyJsonHandler() {}
+
+		virtual bool StartObject() = 0;
+		virtual bool EndObject() = 0;
+		virtual bool StartArray() = 0;
+		virtual bool EndArray() = 0;
+		virtual bool Key(const char *str, size_t len) = 0;
+		virtual bool String(const char *str, size_t len) = 0;
+		//numbers, true, false and null, as they appear in the text
+		virtual bool Scalar(const char *str, size_t len) = 0;
+	};
+
+	class Easy_API EasyJsonReader
+	{
+	public:
+		//buf is modified; returns false on a syntax error or when the handler stopped
+		static bool ParseInsitu(char *buf, size_t len, EasyJsonHandler &handler);
+	};
+}}//namespace
+
+#endif	/* EASY_JSON_READER_H */
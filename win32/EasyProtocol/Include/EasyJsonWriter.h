@@ -0,0 +1,103 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyJsonWriter.h
+ *
+ * Compact serializer for outgoing messages. The output is byte for byte what
+ * Json::FastWriter produces (members sorted, no spaces, trailing '\n'), but it
+ * is written straight into one reusable buffer instead of being assembled
+ * from temporary strings.
+*/
+
+#ifndef EASY_JSON_WRITER_H
+#define	EASY_JSON_WRITER_H
+
+#include <EasyProtocolDef.h>
+#include <json/json.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <string>
+#include <vector>
+#include <string.h>
+
+namespace EasyDarwin { namespace Protocol
+{
+	class Easy_API EasyJsonWriter
+	{
+	public:
+		EasyJsonWriter();
+		~EasyJsonWriter() {}
+
+		//valid until the next Write on this writer
+		const char* Write(const Json::Value& root, size_t *len);
+		std::string Write(const Json::Value& root);
+
+		//into dest, '\0' appended when there is room; returns the length or -1 if it does not fit
+		static int Write(const Json::Value& root, char *dest, int size);
+
+		//decimal text of value into buf, not terminated; returns the length
+		static int FormatInt(char *buf, long long value);
+		static int FormatUInt(char *buf, unsigned long long value);
+		//at most 32 bytes, as "%.17g" with the FastWriter spelling of inf and nan
+		static int FormatDouble(char *buf, double value);
+		//str quoted and escaped, appended to out
+		static void AppendQuoted(std::string &out, const char *str, size_t len);
+
+	private:
+		std::vector<char> buffer_;
+	};
+
+	//text of a SetHeaderValue/SetBodyValue argument, the same as boost::lexical_cast gives
+	class Easy_API EasyValueText
+	{
+	public:
+		EasyValueText(const char *value)			{ Set(value, value + strlen(value)); }
+		EasyValueText(const std::string &value)		{ Set(value.data(), value.data() + value.size()); }
+		EasyValueText(boost::string_ref value)		{ Set(value.data(), value.data() + value.size()); }
+		EasyValueText(char value)					{ Char(value); }
+		EasyValueText(signed char value)			{ Char((char)value); }
+		EasyValueText(unsigned char value)			{ Char((char)value); }
+		EasyValueText(bool value)					{ Char(value ? '1' : '0'); }
+		EasyValueText(short value)					{ Int(value); }
+		EasyValueText(unsigned short value)			{ UInt(value); }
+		EasyValueText(int value)					{ Int(value); }
+		EasyValueText(unsigned int value)			{ UInt(value); }
+		EasyValueText(long value)					{ Int(value); }
+		EasyValueText(unsigned long value)			{ UInt(value); }
+		EasyValueText(long long value)				{ Int(value); }
+		EasyValueText(unsigned long long value)		{ UInt(value); }
+		EasyValueText(float value);
+		EasyValueText(double value);
+
+		template <class type>
+		EasyValueText(const type &value)
+			: text_(boost::lexical_cast<std::string>(value))
+		{
+			Set(text_.data(), text_.data() + text_.size());
+		}
+
+		const char* Begin() const	{ return begin_; }
+		const char* End() const		{ return end_; }
+		std::string Str() const		{ return std::string(begin_, end_); }
+
+	private:
+		EasyValueText(const EasyValueText&);
+		EasyValueText& operator=(const EasyValueText&);
+
+		void Set(const char *begin, const char *end)	{ begin_ = begin; end_ = end; }
+		void Char(char c)								{ buf_[0] = c; Set(buf_, buf_ + 1); }
+		void Int(long long value)						{ Set(buf_, buf_ + EasyJsonWriter::FormatInt(buf_, value)); }
+		void UInt(unsigned long long value)				{ Set(buf_, buf_ + EasyJsonWriter::FormatUInt(buf_, value)); }
+
+		char buf_[32];
+		const char *begin_;
+		const char *end_;
+		std::string text_;
+	};
+}}//namespace
+
+#endif	/* EASY_JSON_WRITER_H */
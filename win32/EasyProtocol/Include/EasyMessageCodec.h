@@ -0,0 +1,73 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyMessageCodec.h
+ *
+ * Support code for the typed messages of EasyMessages.h. Encoding appends
+ * the compact text GetMsg() gives for the same message; decoding runs
+ * EasyJsonReader over the text and hands every scalar of Header, Body and
+ * the Body lists to a generated setter.
+*/
+
+#ifndef EASY_MESSAGE_CODEC_H
+#define	EASY_MESSAGE_CODEC_H
+
+#include <EasyProtocolDef.h>
+#include <EasyTypeMap.h>
+#include <boost/utility/string_ref.hpp>
+#include <string>
+
+namespace EasyDarwin { namespace Protocol
+{
+	//Header members every message carries; ErrorNum and ErrorString only go out on ACKs
+	typedef struct __EASY_MSG_HEADER_T
+	{
+		std::string version;
+		int cseq;
+		int errorNum;
+		std::string errorString;			//empty sends EasyProtocol::GetErrorString(errorNum)
+
+		__EASY_MSG_HEADER_T()
+			: version(EASY_PROTOCOL_VERSION)
+			, cseq(1)
+			, errorNum(200)
+		{
+		}
+	}EASY_MSG_HEADER_T;
+
+	enum
+	{
+		EASY_MSG_SECTION_HEADER = 0,
+		EASY_MSG_SECTION_BODY,
+		EASY_MSG_SECTION_ITEM
+	};
+
+	class Easy_API EasyMessageCodec
+	{
+	public:
+		//list is the value the adder returned for the current Body list, -1 outside of one
+		typedef bool (*Setter)(void *msg, int section, int list, boost::string_ref key, boost::string_ref value);
+		//a new element of Body list key; returns an id for the setter, -1 to skip the element
+		typedef int (*ItemAdder)(void *msg, boost::string_ref key);
+
+		//buf is modified; false on a syntax error or a MessageType other than msgType
+		static bool Decode(char *buf, size_t len, int msgType, EASY_MSG_HEADER_T &header, void *msg, Setter setter, ItemAdder adder);
+
+		//value as a JSON string, quoted and escaped as Json::FastWriter does
+		static void AppendString(std::string &out, boost::string_ref value);
+		//numbers go out quoted, as SetHeaderValue/SetBodyValue leave them
+		static void AppendInt(std::string &out, long long value);
+		static void AppendEnum(std::string &out, const EasyTypeMap &map, int value);
+		static void AppendErrorString(std::string &out, const EASY_MSG_HEADER_T &header);
+
+		//decimal text, or number; 0 for anything else
+		static int ToInt(boost::string_ref value);
+		static void Assign(std::string &dest, boost::string_ref value)	{ dest.assign(value.data(), value.size()); }
+	};
+}}//namespace
+
+#endif	/* EASY_MESSAGE_CODEC_H */
@@ -0,0 +1,572 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyMessages.h
+ *
+ * Typed EasyDarwin messages, generated by Schema/gen_messages.py from
+ * Schema/EasyMessages.schema; edit the schema, not this file.
+ *
+ * EasyEncodeMsg writes the text EasyProtocol::GetMsg() gives for the same
+ * message. EasyDecodeMsg fills a struct straight from the text and fails on
+ * malformed JSON or another MessageType; unknown members are skipped.
+*/
+
+#ifndef EASY_MESSAGES_H
+#define	EASY_MESSAGES_H
+
+#include <EasyMessageCodec.h>
+#include <string>
+#include <vector>
+
+namespace EasyDarwin { namespace Protocol
+{
+	typedef struct __EASY_MSG_CHANNEL_T
+	{
+		std::string channel;	//optional, not sent while empty
+		std::string name;		//optional, not sent while empty
+		std::string serial;		//optional, not sent while empty
+		std::string snapURL;	//optional, not sent while empty
+		std::string status;		//optional, not sent while empty
+	}EASY_MSG_CHANNEL_T;
+
+	typedef struct __EASY_MSG_DEVICE_T
+	{
+		std::string appType;		//optional, not sent while empty
+		std::string name;			//optional, not sent while empty
+		std::string serial;			//optional, not sent while empty
+		std::string snapURL;		//optional, not sent while empty
+		std::string tag;			//optional, not sent while empty
+		std::string terminalType;	//optional, not sent while empty
+	}EASY_MSG_DEVICE_T;
+
+	// MSG_DS_REGISTER_REQ
+	typedef struct __EASY_MSG_DS_REGISTER_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		int appType;								//EasyProtocol::AppTypes
+		int terminalType;							//EasyProtocol::TerminalTypes
+		std::string serial;
+		std::string name;
+		std::string tag;
+		std::string token;
+		int channelCount;							//optional, not sent while -1
+		std::vector<EASY_MSG_CHANNEL_T> channels;
+
+		__EASY_MSG_DS_REGISTER_REQ_T()
+			: appType(-1)
+			, terminalType(-1)
+			, channelCount(-1)
+		{
+		}
+	}EASY_MSG_DS_REGISTER_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_DS_REGISTER_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_REGISTER_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_REGISTER_REQ_T &msg);
+
+	// MSG_SD_REGISTER_ACK
+	typedef struct __EASY_MSG_SD_REGISTER_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string sessionID;		//optional, not sent while empty
+	}EASY_MSG_SD_REGISTER_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SD_REGISTER_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_REGISTER_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_REGISTER_ACK_T &msg);
+
+	// MSG_SD_PUSH_STREAM_REQ
+	typedef struct __EASY_MSG_SD_PUSH_STREAM_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+		std::string serverIP;
+		std::string serverPort;
+	}EASY_MSG_SD_PUSH_STREAM_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SD_PUSH_STREAM_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_PUSH_STREAM_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_PUSH_STREAM_REQ_T &msg);
+
+	// MSG_DS_PUSH_STREAM_ACK
+	typedef struct __EASY_MSG_DS_PUSH_STREAM_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+		std::string serverIP;
+		std::string serverPort;
+	}EASY_MSG_DS_PUSH_STREAM_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_DS_PUSH_STREAM_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_PUSH_STREAM_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_PUSH_STREAM_ACK_T &msg);
+
+	// MSG_SD_STREAM_STOP_REQ
+	typedef struct __EASY_MSG_SD_STREAM_STOP_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+	}EASY_MSG_SD_STREAM_STOP_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SD_STREAM_STOP_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_STREAM_STOP_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_STREAM_STOP_REQ_T &msg);
+
+	// MSG_DS_STREAM_STOP_ACK
+	typedef struct __EASY_MSG_DS_STREAM_STOP_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+	}EASY_MSG_DS_STREAM_STOP_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_DS_STREAM_STOP_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_STREAM_STOP_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_STREAM_STOP_ACK_T &msg);
+
+	// MSG_SC_DEVICE_LIST_ACK
+	typedef struct __EASY_MSG_SC_DEVICE_LIST_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		int deviceCount;
+		std::vector<EASY_MSG_DEVICE_T> devices;
+
+		__EASY_MSG_SC_DEVICE_LIST_ACK_T()
+			: deviceCount(0)
+		{
+		}
+	}EASY_MSG_SC_DEVICE_LIST_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SC_DEVICE_LIST_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_DEVICE_LIST_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_DEVICE_LIST_ACK_T &msg);
+
+	// MSG_SC_DEVICE_INFO_ACK
+	typedef struct __EASY_MSG_SC_DEVICE_INFO_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		int channelCount;
+		std::vector<EASY_MSG_CHANNEL_T> channels;
+
+		__EASY_MSG_SC_DEVICE_INFO_ACK_T()
+			: channelCount(0)
+		{
+		}
+	}EASY_MSG_SC_DEVICE_INFO_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SC_DEVICE_INFO_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_DEVICE_INFO_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_DEVICE_INFO_ACK_T &msg);
+
+	// MSG_SC_CAMERA_LIST_ACK
+	typedef struct __EASY_MSG_SC_CAMERA_LIST_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		int channelCount;
+		std::vector<EASY_MSG_CHANNEL_T> channels;
+
+		__EASY_MSG_SC_CAMERA_LIST_ACK_T()
+			: channelCount(0)
+		{
+		}
+	}EASY_MSG_SC_CAMERA_LIST_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SC_CAMERA_LIST_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_CAMERA_LIST_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_CAMERA_LIST_ACK_T &msg);
+
+	// MSG_CS_GET_STREAM_REQ
+	typedef struct __EASY_MSG_CS_GET_STREAM_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+	}EASY_MSG_CS_GET_STREAM_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_CS_GET_STREAM_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_GET_STREAM_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_GET_STREAM_REQ_T &msg);
+
+	// MSG_SC_GET_STREAM_ACK
+	typedef struct __EASY_MSG_SC_GET_STREAM_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+		std::string url;
+	}EASY_MSG_SC_GET_STREAM_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SC_GET_STREAM_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_GET_STREAM_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_GET_STREAM_ACK_T &msg);
+
+	// MSG_CS_FREE_STREAM_REQ
+	typedef struct __EASY_MSG_CS_FREE_STREAM_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+	}EASY_MSG_CS_FREE_STREAM_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_CS_FREE_STREAM_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_FREE_STREAM_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_FREE_STREAM_REQ_T &msg);
+
+	// MSG_SC_FREE_STREAM_ACK
+	typedef struct __EASY_MSG_SC_FREE_STREAM_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+	}EASY_MSG_SC_FREE_STREAM_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SC_FREE_STREAM_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_FREE_STREAM_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_FREE_STREAM_ACK_T &msg);
+
+	// MSG_DS_POST_SNAP_REQ
+	typedef struct __EASY_MSG_DS_POST_SNAP_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string type;
+		std::string time;
+		std::string image;
+	}EASY_MSG_DS_POST_SNAP_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_DS_POST_SNAP_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_POST_SNAP_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_POST_SNAP_REQ_T &msg);
+
+	// MSG_SD_POST_SNAP_ACK
+	typedef struct __EASY_MSG_SD_POST_SNAP_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;		//optional, not sent while empty
+	}EASY_MSG_SD_POST_SNAP_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SD_POST_SNAP_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_POST_SNAP_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_POST_SNAP_ACK_T &msg);
+
+	// MSG_CS_PTZ_CONTROL_REQ
+	typedef struct __EASY_MSG_CS_PTZ_CONTROL_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		int actionType;				//EasyProtocol::PTZActionTypes
+		int command;				//EasyProtocol::PTZCMDTypes
+		int speed;
+		std::string reserve;
+
+		__EASY_MSG_CS_PTZ_CONTROL_REQ_T()
+			: actionType(-1)
+			, command(-1)
+			, speed(0)
+		{
+		}
+	}EASY_MSG_CS_PTZ_CONTROL_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_CS_PTZ_CONTROL_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_PTZ_CONTROL_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_PTZ_CONTROL_REQ_T &msg);
+
+	// MSG_SC_PTZ_CONTROL_ACK
+	typedef struct __EASY_MSG_SC_PTZ_CONTROL_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+	}EASY_MSG_SC_PTZ_CONTROL_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SC_PTZ_CONTROL_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_PTZ_CONTROL_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_PTZ_CONTROL_ACK_T &msg);
+
+	// MSG_SD_CONTROL_PTZ_REQ
+	typedef struct __EASY_MSG_SD_CONTROL_PTZ_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		int actionType;				//EasyProtocol::PTZActionTypes
+		int command;				//EasyProtocol::PTZCMDTypes
+		int speed;
+		std::string reserve;
+
+		__EASY_MSG_SD_CONTROL_PTZ_REQ_T()
+			: actionType(-1)
+			, command(-1)
+			, speed(0)
+		{
+		}
+	}EASY_MSG_SD_CONTROL_PTZ_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SD_CONTROL_PTZ_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_CONTROL_PTZ_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_CONTROL_PTZ_REQ_T &msg);
+
+	// MSG_DS_CONTROL_PTZ_ACK
+	typedef struct __EASY_MSG_DS_CONTROL_PTZ_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+	}EASY_MSG_DS_CONTROL_PTZ_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_DS_CONTROL_PTZ_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_CONTROL_PTZ_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_CONTROL_PTZ_ACK_T &msg);
+
+	// MSG_CS_PRESET_CONTROL_REQ
+	typedef struct __EASY_MSG_CS_PRESET_CONTROL_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		int command;				//EasyProtocol::PresetCMDTypes
+		int preset;
+		std::string reserve;
+
+		__EASY_MSG_CS_PRESET_CONTROL_REQ_T()
+			: command(-1)
+			, preset(0)
+		{
+		}
+	}EASY_MSG_CS_PRESET_CONTROL_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_CS_PRESET_CONTROL_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_PRESET_CONTROL_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_PRESET_CONTROL_REQ_T &msg);
+
+	// MSG_SC_PRESET_CONTROL_ACK
+	typedef struct __EASY_MSG_SC_PRESET_CONTROL_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+	}EASY_MSG_SC_PRESET_CONTROL_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SC_PRESET_CONTROL_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_PRESET_CONTROL_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_PRESET_CONTROL_ACK_T &msg);
+
+	// MSG_SD_CONTROL_PRESET_REQ
+	typedef struct __EASY_MSG_SD_CONTROL_PRESET_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		int command;				//EasyProtocol::PresetCMDTypes
+		int preset;
+		std::string reserve;
+
+		__EASY_MSG_SD_CONTROL_PRESET_REQ_T()
+			: command(-1)
+			, preset(0)
+		{
+		}
+	}EASY_MSG_SD_CONTROL_PRESET_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SD_CONTROL_PRESET_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_CONTROL_PRESET_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_CONTROL_PRESET_REQ_T &msg);
+
+	// MSG_DS_CONTROL_PRESET_ACK
+	typedef struct __EASY_MSG_DS_CONTROL_PRESET_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+	}EASY_MSG_DS_CONTROL_PRESET_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_DS_CONTROL_PRESET_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_CONTROL_PRESET_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_CONTROL_PRESET_ACK_T &msg);
+
+	// MSG_CS_TALKBACK_CONTROL_REQ
+	typedef struct __EASY_MSG_CS_TALKBACK_CONTROL_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		int command;				//EasyProtocol::TalkbackCMDTypes
+		int audioType;				//EasyProtocol::TalkbackAudioTypes
+		std::string audioData;
+		int pts;
+		std::string reserve;
+		std::string transport;		//optional, not sent while empty
+		int frameDuration;			//optional, not sent while -1
+
+		__EASY_MSG_CS_TALKBACK_CONTROL_REQ_T()
+			: command(-1)
+			, audioType(-1)
+			, pts(0)
+			, frameDuration(-1)
+		{
+		}
+	}EASY_MSG_CS_TALKBACK_CONTROL_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_CS_TALKBACK_CONTROL_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_CS_TALKBACK_CONTROL_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_CS_TALKBACK_CONTROL_REQ_T &msg);
+
+	// MSG_SC_TALKBACK_CONTROL_ACK
+	typedef struct __EASY_MSG_SC_TALKBACK_CONTROL_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+		std::string transport;		//optional, not sent while empty
+	}EASY_MSG_SC_TALKBACK_CONTROL_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SC_TALKBACK_CONTROL_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SC_TALKBACK_CONTROL_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SC_TALKBACK_CONTROL_ACK_T &msg);
+
+	// MSG_SD_CONTROL_TALKBACK_REQ
+	typedef struct __EASY_MSG_SD_CONTROL_TALKBACK_REQ_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		int command;				//EasyProtocol::TalkbackCMDTypes
+		int audioType;				//EasyProtocol::TalkbackAudioTypes
+		std::string audioData;
+		int pts;
+		std::string reserve;
+		std::string transport;		//optional, not sent while empty
+		int frameDuration;			//optional, not sent while -1
+
+		__EASY_MSG_SD_CONTROL_TALKBACK_REQ_T()
+			: command(-1)
+			, audioType(-1)
+			, pts(0)
+			, frameDuration(-1)
+		{
+		}
+	}EASY_MSG_SD_CONTROL_TALKBACK_REQ_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_SD_CONTROL_TALKBACK_REQ_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_SD_CONTROL_TALKBACK_REQ_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_SD_CONTROL_TALKBACK_REQ_T &msg);
+
+	// MSG_DS_CONTROL_TALKBACK_ACK
+	typedef struct __EASY_MSG_DS_CONTROL_TALKBACK_ACK_T
+	{
+		EASY_MSG_HEADER_T header;
+		std::string serial;
+		std::string channel;
+		std::string protocol;
+		std::string reserve;
+		std::string transport;		//optional, not sent while empty
+	}EASY_MSG_DS_CONTROL_TALKBACK_ACK_T;
+
+	Easy_API void EasyEncodeMsg(const EASY_MSG_DS_CONTROL_TALKBACK_ACK_T &msg, std::string &out);
+	Easy_API bool EasyDecodeMsg(const std::string &text, EASY_MSG_DS_CONTROL_TALKBACK_ACK_T &msg);
+	//text is modified
+	Easy_API bool EasyDecodeMsgInsitu(char *text, size_t len, EASY_MSG_DS_CONTROL_TALKBACK_ACK_T &msg);
+
+	//X(MSG_XXX, EASY_MSG_XXX_T) for every message above, for code that covers them all
+	#define EASY_MSG_FOR_EACH(X)	\
+		X(MSG_DS_REGISTER_REQ, EASY_MSG_DS_REGISTER_REQ_T)	\
+		X(MSG_SD_REGISTER_ACK, EASY_MSG_SD_REGISTER_ACK_T)	\
+		X(MSG_SD_PUSH_STREAM_REQ, EASY_MSG_SD_PUSH_STREAM_REQ_T)	\
+		X(MSG_DS_PUSH_STREAM_ACK, EASY_MSG_DS_PUSH_STREAM_ACK_T)	\
+		X(MSG_SD_STREAM_STOP_REQ, EASY_MSG_SD_STREAM_STOP_REQ_T)	\
+		X(MSG_DS_STREAM_STOP_ACK, EASY_MSG_DS_STREAM_STOP_ACK_T)	\
+		X(MSG_SC_DEVICE_LIST_ACK, EASY_MSG_SC_DEVICE_LIST_ACK_T)	\
+		X(MSG_SC_DEVICE_INFO_ACK, EASY_MSG_SC_DEVICE_INFO_ACK_T)	\
+		X(MSG_SC_CAMERA_LIST_ACK, EASY_MSG_SC_CAMERA_LIST_ACK_T)	\
+		X(MSG_CS_GET_STREAM_REQ, EASY_MSG_CS_GET_STREAM_REQ_T)	\
+		X(MSG_SC_GET_STREAM_ACK, EASY_MSG_SC_GET_STREAM_ACK_T)	\
+		X(MSG_CS_FREE_STREAM_REQ, EASY_MSG_CS_FREE_STREAM_REQ_T)	\
+		X(MSG_SC_FREE_STREAM_ACK, EASY_MSG_SC_FREE_STREAM_ACK_T)	\
+		X(MSG_DS_POST_SNAP_REQ, EASY_MSG_DS_POST_SNAP_REQ_T)	\
+		X(MSG_SD_POST_SNAP_ACK, EASY_MSG_SD_POST_SNAP_ACK_T)	\
+		X(MSG_CS_PTZ_CONTROL_REQ, EASY_MSG_CS_PTZ_CONTROL_REQ_T)	\
+		X(MSG_SC_PTZ_CONTROL_ACK, EASY_MSG_SC_PTZ_CONTROL_ACK_T)	\
+		X(MSG_SD_CONTROL_PTZ_REQ, EASY_MSG_SD_CONTROL_PTZ_REQ_T)	\
+		X(MSG_DS_CONTROL_PTZ_ACK, EASY_MSG_DS_CONTROL_PTZ_ACK_T)	\
+		X(MSG_CS_PRESET_CONTROL_REQ, EASY_MSG_CS_PRESET_CONTROL_REQ_T)	\
+		X(MSG_SC_PRESET_CONTROL_ACK, EASY_MSG_SC_PRESET_CONTROL_ACK_T)	\
+		X(MSG_SD_CONTROL_PRESET_REQ, EASY_MSG_SD_CONTROL_PRESET_REQ_T)	\
+		X(MSG_DS_CONTROL_PRESET_ACK, EASY_MSG_DS_CONTROL_PRESET_ACK_T)	\
+		X(MSG_CS_TALKBACK_CONTROL_REQ, EASY_MSG_CS_TALKBACK_CONTROL_REQ_T)	\
+		X(MSG_SC_TALKBACK_CONTROL_ACK, EASY_MSG_SC_TALKBACK_CONTROL_ACK_T)	\
+		X(MSG_SD_CONTROL_TALKBACK_REQ, EASY_MSG_SD_CONTROL_TALKBACK_REQ_T)	\
+		X(MSG_DS_CONTROL_TALKBACK_ACK, EASY_MSG_DS_CONTROL_TALKBACK_ACK_T)
+}}//namespace
+
+#endif	/* EASY_MESSAGES_H */
@@ -8,6 +8,7 @@
 #define	EASY_PROTOCOL_H
 
 #include <EasyProtocolBase.h>
+#include <EasyDeviceTable.h>
 #include <map>
 #include <vector>
 #include <boost/variant.hpp>
@@ -70,8 +71,8 @@ typedef vector<EasyNVRMessage> EasyNVRMessageQueue;//NVR
 class EasyJsonValueVisitor : public boost::static_visitor<string>
 {
 public:
-	string operator()(int value) const { return boost::lexical_cast<string>(value); }
-	string operator()(float value) const { return boost::lexical_cast<string>(value); }
+	string operator()(int value) const { return EasyValueText(value).Str(); }
+	string operator()(float value) const { return EasyValueText(value).Str(); }
 	string operator()(string value) const { return value; }
 };
 
@@ -155,10 +156,16 @@ public:
 	EasyMsgSCDeviceListACK(const string& msg);
 	virtual ~EasyMsgSCDeviceListACK() {}
 
-	EasyDevices& GetDevices() { return devices_; }
+	//built from the table on first use, several threads may call it at once
+	EasyDevices& GetDevices();
+	//the list lives here; root holds the rest of Header and Body, and the list too
+	//when the table is not complete
+	EasyDeviceTable& GetDeviceTable() { return table_; }
 
 private:
 	EasyDevices devices_;
+	EasyDeviceTable table_;
+	volatile long devicesState_;		//EASY_LAZY_*
 };
 
 // MSG_SC_DEVICE_INFO_ACK
@@ -169,10 +176,16 @@ public:
 	EasyMsgSCDeviceInfoACK(const string& msg);
 	~EasyMsgSCDeviceInfoACK() {}
 
-	EasyDevices& GetCameras() { return channels_; }
+	//built from the table on first use, several threads may call it at once
+	EasyDevices& GetCameras();
+	//the list lives here; root holds the rest of Header and Body, and the list too
+	//when the table is not complete
+	EasyDeviceTable& GetDeviceTable() { return table_; }
 
 private:
 	EasyDevices channels_;
+	EasyDeviceTable table_;
+	volatile long channelsState_;		//EASY_LAZY_*
 };
 
 // MSG_SC_GET_STREAM_ACK
@@ -16,7 +16,8 @@
 
 #include <EasyProtocolDef.h>
 #include <json/json.h>
-#include <boost/lexical_cast.hpp>
+#include <EasyJsonWriter.h>
+#include <EasyTypeMap.h>
 
 namespace EasyDarwin { namespace Protocol
 {
@@ -26,6 +27,15 @@ namespace EasyDarwin { namespace Protocol
 	/*!
 	\brief EasyDarwin Protocol base class
 	\ingroup EasyProtocolBase
+
+	root comes from the heap, or from a Json::Arena when the message is created
+	inside a Json::ArenaScope; such a message must be destroyed before the arena
+	is reset.
+
+	A message read from text keeps a copy of it, and the strings in root point
+	into that copy (Json::Reader::parseBorrowed) instead of being copied one by
+	one. Read them with ViewOf/TextOf; a Json::Value copied out of root owns its
+	strings.
 	*/
 	class Easy_API EasyProtocol
 	{
@@ -34,21 +44,18 @@ namespace EasyDarwin { namespace Protocol
 		EasyProtocol(const std::string& msg, int iMsgType = -1);
 		virtual ~EasyProtocol();
 
-		struct MsgType
-		{
-			int value;
-			char str[512];
-		};
+		typedef EASY_TYPE_ENTRY_T MsgType;
 
 	public:
 		void Read(const std::string& msg, int iMsgType = -1);
 
+		//compact JSON, see EasyJsonWriter
 		std::string GetMsg();
 		bool GetMsg(char *dest, int size);
 
 		void SetMsgType(int type);
 		int GetMsgType() const;
-		std::string GetMsgTypeStr() const;
+		boost::string_ref GetMsgTypeStr() const;
 		int GetMessageType();
 
 		int GetAppType();
@@ -61,16 +68,18 @@ namespace EasyDarwin { namespace Protocol
 
 	public:
 		template <class type>
-		bool SetHeaderValue(const char* tag, type value)
+		bool SetHeaderValue(const char* tag, const type& value)
 		{
-			root[EASY_TAG_ROOT][EASY_TAG_HEADER][tag] = boost::lexical_cast<std::string>(value);
+			EasyValueText text(value);
+			root[EASY_TAG_ROOT][EASY_TAG_HEADER][tag] = Json::Value(text.Begin(), text.End());
 			return true;
 		}
 
 		template <class type>
-		bool SetBodyValue(const char* tag, type value)
+		bool SetBodyValue(const char* tag, const type& value)
 		{
-			root[EASY_TAG_ROOT][EASY_TAG_BODY][tag] = boost::lexical_cast<std::string>(value);
+			EasyValueText text(value);
+			root[EASY_TAG_ROOT][EASY_TAG_BODY][tag] = Json::Value(text.Begin(), text.End());
 			return true;
 		}
 
@@ -78,59 +87,82 @@ namespace EasyDarwin { namespace Protocol
 		std::string GetBodyValue(const char* tag);
 
 		Json::Value* GetRoot() { return &root; }
+
+		//asString() of a scalar, empty for objects and arrays instead of throwing
+		static std::string TextOf(const Json::Value& value);
+		//the same into out, reusing its buffer
+		static void TextOf(const Json::Value& value, std::string& out);
+		//the text of a string value without copying it, empty for anything else
+		static boost::string_ref ViewOf(const Json::Value& value);
 	public:
-		static std::string GetErrorString(int error);
+		//wire strings point into constant tables, lookups do not allocate
+		static boost::string_ref GetErrorString(int error);
 
-		static std::string GetMsgTypeString(int type);
-		static int GetMsgType(const std::string& sMessageType);
+		static boost::string_ref GetMsgTypeString(int type);
+		static int GetMsgType(boost::string_ref sMessageType);
 
 		//enum EasyDarwinDeviceStatus
-		static std::string GetDeviceStatusString(int status);
-		static int GetDeviceStatus(const std::string& sStatus);
+		static boost::string_ref GetDeviceStatusString(int status);
+		static int GetDeviceStatus(boost::string_ref sStatus);
 
 		//enum EasyDarwinPortType
-		static int GetPortType(const std::string& sPortType);
-		static std::string GetPortTypeString(int iPortType);
+		static int GetPortType(boost::string_ref sPortType);
+		static boost::string_ref GetPortTypeString(int iPortType);
 
 		//enum EasyDarwinProtocolType
-		static int GetProtocolType(const std::string& sProtocolType);
-		static std::string GetProtocolString(int iProtocolType);
+		static int GetProtocolType(boost::string_ref sProtocolType);
+		static boost::string_ref GetProtocolString(int iProtocolType);
 
 		//enum EasyDarwinEncodeType
-		static int GetMediaEncodeType(const std::string& sMediaEncode);
-		static std::string GetMediaEncodeTypeString(int iMediaEncodeType);
+		static int GetMediaEncodeType(boost::string_ref sMediaEncode);
+		static boost::string_ref GetMediaEncodeTypeString(int iMediaEncodeType);
 
 		//enum EasyDarwinTerminalType
-		static int GetTerminalType(const std::string& sTerminalType);
-		static std::string GetTerminalTypeString(int iTerminalType);
+		static int GetTerminalType(boost::string_ref sTerminalType);
+		static boost::string_ref GetTerminalTypeString(int iTerminalType);
 
 		//enum EasyDarwinAppType
-		static int GetAppType(const std::string& sAppType);
-		static std::string GetAppTypeString(int iAppType);
+		static int GetAppType(boost::string_ref sAppType);
+		static boost::string_ref GetAppTypeString(int iAppType);
 
 		//enum EasyDarwinSnapType
-		static int GetSnapType(const std::string& sSnapType);
-		static std::string GetSnapTypeString(int iSnapType);
+		static int GetSnapType(boost::string_ref sSnapType);
+		static boost::string_ref GetSnapTypeString(int iSnapType);
 
 		//enum EasyDarwinPTZActionType
-		static int GetPTZActionType(const std::string& sPTZActionType);
-		static std::string GetPTZActionTypeString(int iPTZActionType);
+		static int GetPTZActionType(boost::string_ref sPTZActionType);
+		static boost::string_ref GetPTZActionTypeString(int iPTZActionType);
 
 		//enum EasyDarwinPTZCMDType
-		static int GetPTZCMDType(const std::string& sPTZCMDType);
-		static std::string GetPTZCMDTypeString(int iPTZCMDType);
+		static int GetPTZCMDType(boost::string_ref sPTZCMDType);
+		static boost::string_ref GetPTZCMDTypeString(int iPTZCMDType);
 
 		//enum EasyDarwinPresetCMDType
-		static int GetPresetCMDType(const std::string& sPresetCMDType);
-		static std::string GetPresetCMDTypeString(int iPresetCMDType);
+		static int GetPresetCMDType(boost::string_ref sPresetCMDType);
+		static boost::string_ref GetPresetCMDTypeString(int iPresetCMDType);
 
 		//enum EasyDarwinTalkbackAudioType
-		static int GetTalkbackAudioType(const std::string& sTalkbackAudioType);
-		static std::string GetTalkbackAudioTypeString(int iTalkbackAudioType);
+		static int GetTalkbackAudioType(boost::string_ref sTalkbackAudioType);
+		static boost::string_ref GetTalkbackAudioTypeString(int iTalkbackAudioType);
 
 		//enum EasyDarwinTalkbackCMDType
-		static int GetTalkbackCMDType(const std::string& sTalkbackCMDType);
-		static std::string GetTalkbackCMDTypeString(int iTalkbackCMDType);
+		static int GetTalkbackCMDType(boost::string_ref sTalkbackCMDType);
+		static boost::string_ref GetTalkbackCMDTypeString(int iTalkbackCMDType);
+
+		//the tables behind the lookups above
+		static const EasyTypeMap MsgTypes;
+		static const EasyTypeMap Errors;
+		static const EasyTypeMap Statuses;
+		static const EasyTypeMap ProtocolTypes;
+		static const EasyTypeMap MediaEncodeTypes;
+		static const EasyTypeMap TerminalTypes;
+		static const EasyTypeMap AppTypes;
+		static const EasyTypeMap SnapTypes;
+		static const EasyTypeMap PTZActionTypes;
+		static const EasyTypeMap PTZCMDTypes;
+		static const EasyTypeMap PresetCMDTypes;
+		static const EasyTypeMap TalkbackAudioTypes;
+		static const EasyTypeMap TalkbackCMDTypes;
 
 		//common json tag define
 	protected:
@@ -141,27 +173,28 @@ namespace EasyDarwin { namespace Protocol
 		//Json::Value device_list;
 
 	private:
-		int fMsgType;
-		static MsgType MsgTypeMap[];
-		static MsgType ErrorMap[];
-		static MsgType StatusMap[];
-		static MsgType ServiceMap[];
-		static MsgType ProtocolTypeMap[];
-		static MsgType MediaEncodeTypeMap[];
-		static MsgType DeviceTypeMap[];
-		static MsgType TerminalTypeMap[];
-		static MsgType AppTypeMap[];
-		static MsgType LiveTypeMap[];
-		static MsgType SnapTypeMap[];
-		static MsgType PTZActionTypeMap[];
-		static MsgType PTZCMDTypeMap[];
-		static MsgType PresetCMDTypeMap[];
-		static MsgType TalkbackAudioTypeMap[];
-		static MsgType TalkbackCMDTypeMap[];
-
-		Json::Reader reader;
-		Json::StyledWriter writer;//or StyledWriter FastWriter
+		void Parse(const std::string& msg);
+		//drops an EasyDarwin/Header/Body that is not an object so lookups cannot throw
+		void Normalize();
 
+		std::string text_;			//what the strings in root point into
+		int fMsgType;
+		static const MsgType MsgTypeMap[];
+		static const MsgType ErrorMap[];
+		static const MsgType StatusMap[];
+		static const MsgType ServiceMap[];
+		static const MsgType ProtocolTypeMap[];
+		static const MsgType MediaEncodeTypeMap[];
+		static const MsgType DeviceTypeMap[];
+		static const MsgType TerminalTypeMap[];
+		static const MsgType AppTypeMap[];
+		static const MsgType LiveTypeMap[];
+		static const MsgType SnapTypeMap[];
+		static const MsgType PTZActionTypeMap[];
+		static const MsgType PTZCMDTypeMap[];
+		static const MsgType PresetCMDTypeMap[];
+		static const MsgType TalkbackAudioTypeMap[];
+		static const MsgType TalkbackCMDTypeMap[];
 	};
 
 }
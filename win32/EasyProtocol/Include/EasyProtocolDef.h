@@ -18,7 +18,7 @@
 #define Easy_API __declspec(dllimport)
 #endif
 #endif
-#elif defined(__linux__)
+#else
 #define Easy_API
 #endif
 //#define Easy_API
@@ -129,6 +129,8 @@
 #define EASY_TAG_AUDIO_TYPE								"AudioType"
 #define EASY_TAG_AUDIO_DATA								"AudioData"
 #define EASY_TAG_PTS									"Pts"
+#define EASY_TAG_TRANSPORT								"Transport"
+#define EASY_TAG_FRAME_DURATION							"FrameDuration"
 
 /*!
 \}
@@ -414,4 +416,14 @@ enum EasyDarwinTalkbackCMDType
 \}
 */
 
+/*!
+\ingroup EasyDarwin_Talkback_Transport_Define
+\{
+*/
+#define EASY_TALKBACK_TRANSPORT_JSON					"JSON"			///< one MSG_CS_TALKBACK_CONTROL_REQ per packet, Base64 AudioData
+#define EASY_TALKBACK_TRANSPORT_STREAM					"STREAM"		///< binary frames after the START handshake, see EasyTalkback.h
+/*!
+\}
+*/
+
 #endif	/* EASY_PROTOCOL_DEF_H */
\ No newline at end of file
@@ -0,0 +1,159 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyTalkback.h
+ *
+ * Talkback session. START is negotiated with one MSG_CS_TALKBACK_CONTROL_REQ
+ * carrying "Transport":"STREAM"; a server that echoes it in the ACK then
+ * receives length-prefixed binary G.711 frames on the same connection.
+ * Servers that do not know the tag keep getting one JSON SENDDATA request
+ * (Base64 AudioData) per batch, as before.
+ *
+ * Stream frame, all fields big-endian:
+ *	0	magic		2	'E' 'T'
+ *	2	type		1	EASY_TALKBACK_FRAME_AUDIO / EASY_TALKBACK_FRAME_STOP
+ *	3	audio type	1	EasyDarwinTalkbackAudioType
+ *	4	seq			2
+ *	6	pts			4	ms
+ *	10	length		2	payload bytes
+ *	12	payload
+*/
+
+#ifndef EASY_TALKBACK_H
+#define	EASY_TALKBACK_H
+
+#include <EasyProtocolDef.h>
+#include <string>
+#include <list>
+#include <vector>
+using namespace std;
+
+#define EASY_TALKBACK_FRAME_HEADER						12
+#define EASY_TALKBACK_MAX_PAYLOAD						8000		//1s of 8k G.711
+#define EASY_TALKBACK_FRAME_AUDIO						0x01
+#define EASY_TALKBACK_FRAME_STOP						0x02
+
+#define EASY_TALKBACK_DEFAULT_BATCH						40			//ms of audio per frame
+#define EASY_TALKBACK_PACING_LEAD						60			//ms a frame may be sent ahead of real time
+#define EASY_TALKBACK_PACING_RESET						200			//ms behind real time before the pacing clock restarts
+#define EASY_TALKBACK_JITTER_PREBUFFER					60			//ms buffered before playout starts
+#define EASY_TALKBACK_JITTER_MAX						400			//ms, older samples are dropped above this
+
+namespace EasyDarwin { namespace Protocol
+{
+	class Easy_API EasyTalkbackSender
+	{
+	public:
+		EasyTalkbackSender();
+		~EasyTalkbackSender();
+
+		//audioType: EASY_TALKBACK_AUDIO_TYPE_G711A or EASY_TALKBACK_AUDIO_TYPE_G711U, pcm is 16bit mono
+		int Open(const string& serial, const string& channel, const string& protocol, const string& host,
+			int audioType = EASY_TALKBACK_AUDIO_TYPE_G711A, unsigned int samplerate = 8000, int batchMs = EASY_TALKBACK_DEFAULT_BATCH);
+		void Close();
+
+		//http request for START, asks the server for the stream transport
+		string BuildStart();
+		//MSG_SC_TALKBACK_CONTROL_ACK, selects the transport; returns 0, or -1 if START was rejected
+		int OnStartAck(const string& msg);
+		//appends what is still queued and the STOP request/frame to 'out'
+		int BuildStop(string& out);
+
+		//queues pcm and appends whatever is due to 'out', returns the number of bytes appended
+		int Write(const short *pcm, int samples, unsigned int nowMs, string& out);
+		//timer driven: sends a partial batch older than batchMs and paced frames
+		int Poll(unsigned int nowMs, string& out);
+
+		bool IsStream()						{return stream_;}
+		unsigned long long GetWireBytes()	{return wireBytes_;}
+		unsigned int GetFrames()			{return frames_;}
+
+		static string HttpPost(const string& host, const string& body);
+
+	private:
+		typedef struct __TALKBACK_FRAME_T
+		{
+			unsigned int	pts;
+			string			payload;
+		}TALKBACK_FRAME_T;
+
+		void QueuePending();
+		int Emit(const TALKBACK_FRAME_T& frame, string& out);
+		string BuildRequest(int cmd, const string& audioData, unsigned int pts);
+
+		string serial_;
+		string channel_;
+		string protocol_;
+		string host_;
+		int audioType_;
+		unsigned int samplerate_;
+		int batchMs_;
+		int batchSamples_;
+		bool opened_;
+		bool stream_;
+
+		vector<unsigned char> encBuf_;
+		string pending_;
+		unsigned int pendingPts_;
+		unsigned int pendingNow_;
+		unsigned long long samplesIn_;
+
+		list<TALKBACK_FRAME_T> queue_;
+		bool paceStarted_;
+		unsigned int paceNow_;
+		unsigned int pacePts_;
+
+		size_t cseq_;
+		unsigned short seq_;
+		unsigned long long wireBytes_;
+		unsigned int frames_;
+	};
+
+	class Easy_API EasyTalkbackReceiver
+	{
+	public:
+		EasyTalkbackReceiver();
+		~EasyTalkbackReceiver();
+
+		int Open(unsigned int samplerate = 8000, int prebufferMs = EASY_TALKBACK_JITTER_PREBUFFER, int maxMs = EASY_TALKBACK_JITTER_MAX);
+		void Close();
+
+		//stream bytes split anywhere, returns the number of complete frames taken
+		int Input(const char *data, int len);
+
+		//fills 'samples' of pcm for the playout clock, silence while buffering;
+		//returns the number of samples that carried audio
+		int Read(short *pcm, int samples);
+
+		bool IsStopped()				{return stopped_;}
+		int GetBufferedMs();
+		unsigned int GetLostMs()		{return lostMs_;}
+		unsigned int GetResyncs()		{return resyncs_;}
+
+	private:
+		void PutFrame(int audioType, unsigned int pts, const unsigned char *payload, int len);
+
+		unsigned int samplerate_;
+		int prebuffer_;					//samples
+		int maxBuffer_;					//samples
+		bool buffering_;
+		bool stopped_;
+
+		string in_;
+		size_t inPos_;
+
+		vector<short> pcm_;
+		size_t pcmPos_;
+
+		bool havePts_;
+		unsigned int nextPts_;			//pts expected for the next frame
+		unsigned int lostMs_;
+		unsigned int resyncs_;
+	};
+}}//namespace
+
+#endif	/* EASY_TALKBACK_H */
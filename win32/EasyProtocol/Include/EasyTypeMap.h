@@ -0,0 +1,75 @@
+/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+/*
+ * File:   EasyTypeMap.h
+ *
+ * Two-way lookup between the protocol enums and their wire strings. A map is
+ * an aggregate initialized with EASY_TYPE_MAP_INIT, so it is constant data
+ * before any constructor runs and can be used from other static initializers.
+ * The hash slots over the entries are filled by the first lookup, from any
+ * thread; after that both directions are a hash and a probe or two, with no
+ * allocation.
+*/
+
+#ifndef EASY_TYPE_MAP_H
+#define	EASY_TYPE_MAP_H
+
+#include <EasyProtocolDef.h>
+#include <boost/utility/string_ref.hpp>
+
+namespace EasyDarwin { namespace Protocol
+{
+	typedef struct __EASY_TYPE_ENTRY_T
+	{
+		int value;
+		const char *str;
+	}EASY_TYPE_ENTRY_T;
+
+	#define EASY_TYPE_MAP_MAX_ENTRIES	64
+	#define EASY_TYPE_MAP_MAX_LEN		255
+
+	//const EasyTypeMap map = EASY_TYPE_MAP_INIT(entries); entries past EASY_TYPE_MAP_MAX_ENTRIES are ignored
+	#define EASY_TYPE_MAP_INIT(entries)	{(entries), (int)(sizeof(entries) / sizeof(entries[0])) < EASY_TYPE_MAP_MAX_ENTRIES ?	\
+											(int)(sizeof(entries) / sizeof(entries[0])) : EASY_TYPE_MAP_MAX_ENTRIES}
+
+	//the first of duplicate strings or values wins, as the old linear scans did
+	class Easy_API EasyTypeMap
+	{
+	public:
+		//-1 if unknown
+		int Value(boost::string_ref str) const;
+		//empty if unknown; points into the constant table
+		boost::string_ref String(int value) const;
+
+		int Size() const											{return count_;}
+		const EASY_TYPE_ENTRY_T& operator[](int i) const			{return entries_[i];}
+
+	private:
+		//fills the slots once, the other callers wait for it
+		void Ready() const;
+		void Build() const;
+		int FindString(boost::string_ref str) const;
+		int FindValue(int value) const;
+
+		static unsigned int HashString(boost::string_ref str);
+		static unsigned int HashValue(int value);
+
+	public:
+		//public only so that EASY_TYPE_MAP_INIT can brace-initialize a map; the rest starts zeroed
+		const EASY_TYPE_ENTRY_T *entries_;
+		int count_;
+
+		mutable volatile long state_;
+		mutable unsigned int mask_;
+		mutable unsigned char lens_[EASY_TYPE_MAP_MAX_ENTRIES];
+		//entry index + 1, 0 marks an empty slot
+		mutable unsigned char strSlots_[EASY_TYPE_MAP_MAX_ENTRIES * 2];
+		mutable unsigned char valueSlots_[EASY_TYPE_MAP_MAX_ENTRIES * 2];
+	};
+}}//namespace
+
+#endif	/* EASY_TYPE_MAP_H */
@@ -0,0 +1,430 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+# Github: https://github.com/EasyDarwin
+# WEChat: EasyDarwin
+# Website: http://www.easydarwin.org
+#
+# Generates Include/EasyMessages.h and EasyProtocol/EasyMessages.cpp from
+# EasyMessages.schema. Run it after editing the schema and commit the output:
+#
+#     python gen_messages.py
+#
+# Members are written in the order Json::FastWriter sorts them, so an
+# encoded message is byte for byte what EasyProtocol::GetMsg() gives.
+
+from __future__ import print_function
+
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SCHEMA = os.path.join(HERE, 'EasyMessages.schema')
+HEADER = os.path.join(HERE, '..', 'Include', 'EasyMessages.h')
+SOURCE = os.path.join(HERE, '..', 'EasyProtocol', 'EasyMessages.cpp')
+
+BANNER = '''/*
+	Copyright (c) 2012-2016 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+*/
+'''
+
+
+class Field(object):
+	def __init__(self, key, type, optional, item=None):
+		self.key = key
+		self.type = type
+		self.optional = optional
+		self.item = item
+		self.member = member_name(key)
+
+	def is_list(self):
+		return self.type == 'list'
+
+	def is_string(self):
+		return self.type == 'string'
+
+	def enum_map(self):
+		return self.type[len('enum:'):] if self.type.startswith('enum:') else None
+
+
+class Struct(object):
+	def __init__(self, name, line):
+		self.name = name
+		self.line = line
+		self.header = []
+		self.body = []
+		self.fields = []
+
+	def is_ack(self):
+		return self.name.endswith('_ACK')
+
+	def type_name(self):
+		return 'EASY_%s_T' % self.name if self.name.startswith('MSG_') else 'EASY_MSG_%s_T' % self.name
+
+	def func_name(self):
+		#MSG_DS_REGISTER_REQ -> DSRegisterREQ, CHANNEL -> Channel
+		parts = self.name.split('_')
+		if parts[0] != 'MSG':
+			return ''.join(p.capitalize() for p in parts)
+		parts = parts[1:]
+		return parts[0] + ''.join(p.capitalize() for p in parts[1:-1]) + parts[-1]
+
+
+def member_name(key):
+	#SnapURL -> snapURL, URL -> url, Server_PORT -> serverPort
+	parts = key.split('_')
+	out = ''
+	for i, part in enumerate(parts):
+		if i > 0 and part.isupper() and len(part) > 2:
+			part = part.capitalize()
+		out += part
+	m = re.match(r'[A-Z]+', out)
+	run = m.group(0) if m else ''
+	if len(run) > 1 and len(run) < len(out) and out[len(run)].islower():
+		run = run[:-1]
+	if not run:
+		run = out[:1]
+	return run.lower() + out[len(run):]
+
+
+def fail(line, msg):
+	sys.stderr.write('%s:%d: %s\n' % (SCHEMA, line, msg))
+	sys.exit(1)
+
+
+def parse(path):
+	items = {}
+	messages = []
+	current = None
+	with open(path) as f:
+		for n, raw in enumerate(f, 1):
+			line = raw.split('#', 1)[0].strip()
+			if not line:
+				continue
+			words = line.split()
+			kind = words[0]
+			if kind in ('item', 'message'):
+				if current is not None or len(words) != 2:
+					fail(n, 'expected "%s NAME" outside of a block' % kind)
+				current = Struct(words[1], n)
+				if kind == 'item':
+					items[current.name] = current
+				else:
+					messages.append(current)
+			elif kind == 'end':
+				if current is None:
+					fail(n, '"end" without a block')
+				current = None
+			elif kind in ('header', 'body', 'field', 'list'):
+				if current is None:
+					fail(n, '"%s" outside of a block' % kind)
+				if len(words) < 3 or len(words) > 4 or (len(words) == 4 and words[3] != 'optional'):
+					fail(n, 'expected "%s Key type [optional]"' % kind)
+				if kind == 'list':
+					if words[2] not in items:
+						fail(n, 'unknown item %s' % words[2])
+					field = Field(words[1], 'list', True, items[words[2]])
+				else:
+					if words[2] not in ('string', 'int') and not words[2].startswith('enum:'):
+						fail(n, 'unknown type %s' % words[2])
+					field = Field(words[1], words[2], len(words) == 4)
+				target = {'header': current.header, 'body': current.body, 'field': current.fields, 'list': current.body}[kind]
+				if any(f.key == field.key for f in target):
+					fail(n, 'duplicate member %s' % field.key)
+				target.append(field)
+			else:
+				fail(n, 'unknown keyword %s' % kind)
+	if current is not None:
+		fail(current.line, 'missing "end"')
+	return [items[k] for k in sorted(items, key=lambda k: items[k].line)], messages
+
+
+def c_literal(text):
+	return '"' + text.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def member_decl(field):
+	if field.is_list():
+		return 'std::vector<%s> %s;' % (field.item.type_name(), field.member)
+	if field.is_string():
+		return 'std::string %s;' % field.member
+	return 'int %s;' % field.member
+
+
+def member_comment(field):
+	notes = []
+	if field.enum_map():
+		notes.append('EasyProtocol::%s' % field.enum_map())
+	if field.optional and not field.is_list():
+		notes.append('optional, not sent while ' + ('empty' if field.is_string() else '-1'))
+	return ('//' + ', '.join(notes)) if notes else ''
+
+
+def default_value(field):
+	if field.is_list() or field.is_string():
+		return None
+	if field.optional or field.enum_map():
+		return '-1'
+	return '0'
+
+
+def emit_struct(out, struct, members):
+	out.append('\ttypedef struct __%s' % struct.type_name())
+	out.append('\t{')
+	decls = [('EASY_MSG_HEADER_T header;', '')] if struct.name.startswith('MSG_') else []
+	decls += [(member_decl(f), member_comment(f)) for f in members]
+	#comments line up on the first tab stop past the longest declaration
+	column = (max(len(d) for d, c in decls) // 4 + 1) * 4
+	for decl, comment in decls:
+		if comment:
+			out.append('\t\t%s%s%s' % (decl, '\t' * ((column - len(decl) // 4 * 4) // 4), comment))
+		else:
+			out.append('\t\t%s' % decl)
+	inits = [(f.member, default_value(f)) for f in members if default_value(f) is not None]
+	if inits:
+		out.append('')
+		out.append('\t\t__%s()' % struct.type_name())
+		for i, (member, value) in enumerate(inits):
+			out.append('\t\t\t%s %s(%s)' % (':' if i == 0 else ',', member, value))
+		out.append('\t\t{')
+		out.append('\t\t}')
+	out.append('\t}%s;' % struct.type_name())
+	out.append('')
+
+
+def generate_header(items, messages):
+	out = [BANNER.rstrip('\n'), '/*', ' * File:   EasyMessages.h', ' *',
+		' * Typed EasyDarwin messages, generated by Schema/gen_messages.py from',
+		' * Schema/EasyMessages.schema; edit the schema, not this file.', ' *',
+		' * EasyEncodeMsg writes the text EasyProtocol::GetMsg() gives for the same',
+		' * message. EasyDecodeMsg fills a struct straight from the text and fails on',
+		' * malformed JSON or another MessageType; unknown members are skipped.',
+		'*/', '', '#ifndef EASY_MESSAGES_H', '#define\tEASY_MESSAGES_H', '',
+		'#include <EasyMessageCodec.h>', '#include <string>', '#include <vector>', '',
+		'namespace EasyDarwin { namespace Protocol', '{']
+	for item in items:
+		emit_struct(out, item, item.fields)
+	for msg in messages:
+		out.append('\t// %s' % msg.name)
+		emit_struct(out, msg, msg.header + msg.body)
+		t = msg.type_name()
+		out.append('\tEasy_API void EasyEncodeMsg(const %s &msg, std::string &out);' % t)
+		out.append('\tEasy_API bool EasyDecodeMsg(const std::string &text, %s &msg);' % t)
+		out.append('\t//text is modified')
+		out.append('\tEasy_API bool EasyDecodeMsgInsitu(char *text, size_t len, %s &msg);' % t)
+		out.append('')
+	out.append('\t//X(MSG_XXX, EASY_MSG_XXX_T) for every message above, for code that covers them all')
+	out.append('\t#define EASY_MSG_FOR_EACH(X)\t\\')
+	for msg in messages:
+		out.append('\t\tX(%s, %s)%s' % (msg.name, msg.type_name(), '\t\\' if msg is not messages[-1] else ''))
+	out[len(out):] = ['}}//namespace', '', '#endif\t/* EASY_MESSAGES_H */', '']
+	return '\n'.join(out)
+
+
+def emit_value(out, indent, field, expr):
+	if field.is_string():
+		out.append('%sEasyMessageCodec::AppendString(out, %s);' % (indent, expr))
+	elif field.enum_map():
+		out.append('%sEasyMessageCodec::AppendEnum(out, EasyProtocol::%s, %s);' % (indent, field.enum_map(), expr))
+	else:
+		out.append('%sEasyMessageCodec::AppendInt(out, %s);' % (indent, expr))
+
+
+def emit_members(out, fields, prefix):
+	#members of one object in FastWriter order, sep is '{' until the first one is out
+	for f in sorted(fields, key=lambda f: f.key):
+		expr = prefix + f.member
+		key = c_literal('"%s":' % f.key)
+		indent = '\t\t'
+		if f.is_list():
+			out.append('\t\tif (!%s.empty())' % expr)
+		elif f.optional and f.is_string():
+			out.append('\t\tif (!%s.empty())' % expr)
+		elif f.optional:
+			out.append('\t\tif (%s != -1)' % expr)
+		if f.optional or f.is_list():
+			out.append('\t\t{')
+			indent = '\t\t\t'
+		out.append('%sout += sep;' % indent)
+		out.append('%ssep = \',\';' % indent)
+		out.append('%sout.append(%s, %d);' % (indent, key, len(f.key) + 3))
+		if f.is_list():
+			out.append('%sout += \'[\';' % indent)
+			out.append('%sfor (size_t i = 0; i < %s.size(); i++)' % (indent, expr))
+			out.append('%s{' % indent)
+			out.append('%s\tif (i > 0)\tout += \',\';' % indent)
+			out.append('%s\tEncode%s(out, %s[i]);' % (indent, f.item.func_name(), expr))
+			out.append('%s}' % indent)
+			out.append('%sout += \']\';' % indent)
+		else:
+			emit_value(out, indent, f, expr)
+		if f.optional or f.is_list():
+			out.append('\t\t}')
+
+
+def emit_setter_cases(out, indent, fields, target):
+	out.append('%sswitch (key.size())' % indent)
+	out.append('%s{' % indent)
+	by_len = {}
+	for f in fields:
+		if not f.is_list():
+			by_len.setdefault(len(f.key), []).append(f)
+	for length in sorted(by_len):
+		out.append('%scase %d:' % (indent, length))
+		for f in sorted(by_len[length], key=lambda f: f.key):
+			if f.is_string():
+				action = 'EasyMessageCodec::Assign(%s%s, value);' % (target, f.member)
+			elif f.enum_map():
+				action = '%s%s = EasyProtocol::%s.Value(value);' % (target, f.member, f.enum_map())
+			else:
+				action = '%s%s = EasyMessageCodec::ToInt(value);' % (target, f.member)
+			out.append('%s\tif (memcmp(key.data(), %s, %d) == 0)\t{ %s return true; }' % (indent, c_literal(f.key), length, action))
+		out.append('%s\tbreak;' % indent)
+	out.append('%s}' % indent)
+
+
+def generate_source(items, messages):
+	out = [BANNER.rstrip('\n'), '/*', ' * File:   EasyMessages.cpp', ' *',
+		' * Generated by Schema/gen_messages.py from Schema/EasyMessages.schema, do not edit.',
+		'*/', '', '#include <EasyMessages.h>', '#include <EasyProtocolBase.h>', '#include <string.h>', '',
+		'namespace EasyDarwin { namespace Protocol', '{']
+
+	out.append('\tstatic int AddNone(void *, boost::string_ref)')
+	out.append('\t{')
+	out.append('\t\treturn -1;')
+	out.append('\t}')
+	out.append('')
+
+	for item in items:
+		t = item.type_name()
+		out.append('\tstatic void Encode%s(std::string &out, const %s &item)' % (item.func_name(), t))
+		out.append('\t{')
+		out.append('\t\tchar sep = \'{\';')
+		emit_members(out, item.fields, 'item.')
+		out.append('\t\tif (sep == \'{\')\tout += sep;')
+		out.append('\t\tout += \'}\';')
+		out.append('\t}')
+		out.append('')
+		out.append('\tstatic bool Set%s(%s &item, boost::string_ref key, boost::string_ref value)' % (item.func_name(), t))
+		out.append('\t{')
+		emit_setter_cases(out, '\t\t', item.fields, 'item.')
+		out.append('\t\treturn true;')
+		out.append('\t}')
+		out.append('')
+
+	for msg in messages:
+		t = msg.type_name()
+		f = msg.func_name()
+		lists = [x for x in msg.body if x.is_list()]
+		header = [Field('CSeq', 'int', False), Field('MessageType', 'string', False), Field('Version', 'string', False)]
+		if msg.is_ack():
+			header += [Field('ErrorNum', 'int', False), Field('ErrorString', 'string', False)]
+
+		out.append('\t// %s' % msg.name)
+		out.append('\tvoid EasyEncodeMsg(const %s &msg, std::string &out)' % t)
+		out.append('\t{')
+		out.append('\t\tout.clear();')
+		out.append('\t\tout.append("{\\"EasyDarwin\\":{", 15);')
+		out.append('')
+		out.append('\t\t//no Body at all when nothing is in it, as with a DOM never given a body value')
+		out.append('\t\tsize_t mark = out.size();')
+		out.append('\t\tout.append("\\"Body\\":", 7);')
+		out.append('\t\tchar sep = \'{\';')
+		emit_members(out, msg.body, 'msg.')
+		out.append('\t\tif (sep == \'{\')\tout.resize(mark);')
+		out.append('\t\telse\t\t\t\tout.append("},", 2);')
+		out.append('')
+		out.append('\t\tout.append("\\"Header\\":", 9);')
+		out.append('\t\tsep = \'{\';')
+		for h in sorted(header + msg.header, key=lambda h: h.key):
+			if h.key == 'CSeq':
+				out += ['\t\tout += sep;', '\t\tsep = \',\';', '\t\tout.append("\\"CSeq\\":", 7);', '\t\tEasyMessageCodec::AppendInt(out, msg.header.cseq);']
+			elif h.key == 'ErrorNum':
+				out += ['\t\tout.append(",\\"ErrorNum\\":", 12);', '\t\tEasyMessageCodec::AppendInt(out, msg.header.errorNum);']
+			elif h.key == 'ErrorString':
+				out += ['\t\tout.append(",\\"ErrorString\\":", 15);', '\t\tEasyMessageCodec::AppendErrorString(out, msg.header);']
+			elif h.key == 'MessageType':
+				text = '"MessageType":"%s"' % msg.name
+				out += ['\t\tout.append(",%s", %d);' % (c_literal(text)[1:-1], len(text) + 1)]
+			elif h.key == 'Version':
+				out += ['\t\tout.append(",\\"Version\\":", 11);', '\t\tEasyMessageCodec::AppendString(out, msg.header.version);']
+			else:
+				emit_members(out, [h], 'msg.')
+		out.append('\t\tout.append("}}}\\n", 4);')
+		out.append('\t}')
+		out.append('')
+
+		#the parameter is only named where the ITEM case reads it, -Wextra warns otherwise
+		out.append('\tstatic bool Set%s(void *ptr, int section, int %s, boost::string_ref key, boost::string_ref value)' % (f, 'list' if lists else '/*list*/'))
+		out.append('\t{')
+		out.append('\t\t%s &msg = *(%s *)ptr;' % (t, t))
+		out.append('\t\tswitch (section)')
+		out.append('\t\t{')
+		if msg.header:
+			out.append('\t\tcase EASY_MSG_SECTION_HEADER:')
+			emit_setter_cases(out, '\t\t\t', msg.header, 'msg.')
+			out.append('\t\t\tbreak;')
+		out.append('\t\tcase EASY_MSG_SECTION_BODY:')
+		emit_setter_cases(out, '\t\t\t', msg.body, 'msg.')
+		out.append('\t\t\tbreak;')
+		if lists:
+			out.append('\t\tcase EASY_MSG_SECTION_ITEM:')
+			for i, l in enumerate(lists):
+				out.append('\t\t\tif (list == %d)\treturn Set%s(msg.%s.back(), key, value);' % (i, l.item.func_name(), l.member))
+			out.append('\t\t\tbreak;')
+		out.append('\t\t}')
+		out.append('\t\treturn true;')
+		out.append('\t}')
+		out.append('')
+
+		adder = 'AddNone'
+		if lists:
+			adder = 'Add%s' % f
+			out.append('\tstatic int Add%s(void *ptr, boost::string_ref key)' % f)
+			out.append('\t{')
+			out.append('\t\t%s &msg = *(%s *)ptr;' % (t, t))
+			for i, l in enumerate(lists):
+				out.append('\t\tif (key.size() == %d && memcmp(key.data(), %s, %d) == 0)' % (len(l.key), c_literal(l.key), len(l.key)))
+				out.append('\t\t{')
+				out.append('\t\t\tmsg.%s.push_back(%s());' % (l.member, l.item.type_name()))
+				out.append('\t\t\treturn %d;' % i)
+				out.append('\t\t}')
+			out.append('\t\treturn -1;')
+			out.append('\t}')
+			out.append('')
+
+		out.append('\tbool EasyDecodeMsgInsitu(char *text, size_t len, %s &msg)' % t)
+		out.append('\t{')
+		out.append('\t\tmsg = %s();' % t)
+		out.append('\t\treturn EasyMessageCodec::Decode(text, len, %s, msg.header, &msg, Set%s, %s);' % (msg.name, f, adder))
+		out.append('\t}')
+		out.append('')
+		out.append('\tbool EasyDecodeMsg(const std::string &text, %s &msg)' % t)
+		out.append('\t{')
+		out.append('\t\tstd::string buf(text);')
+		out.append('\t\treturn !buf.empty() && EasyDecodeMsgInsitu(&buf[0], buf.size(), msg);')
+		out.append('\t}')
+		out.append('')
+
+	out[-1:] = ['}}//namespace', '']
+	return '\n'.join(out)
+
+
+def write(path, text):
+	with open(path, 'w') as f:
+		f.write(text)
+	print('wrote %s' % os.path.normpath(path))
+
+
+def main():
+	items, messages = parse(SCHEMA)
+	write(HEADER, generate_header(items, messages))
+	write(SOURCE, generate_source(items, messages))
+
+
+if __name__ == '__main__':
+	main()
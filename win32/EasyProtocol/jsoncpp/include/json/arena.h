@@ -0,0 +1,136 @@
+// Copyright 2007-2010 Baptiste Lepilleur
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#ifndef JSON_ARENA_H_INCLUDED
+#define JSON_ARENA_H_INCLUDED
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "config.h"
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <cstddef>
+#include <new>
+
+namespace Json {
+
+/** \brief Monotonic memory for short-lived documents.
+ *
+ * While an ArenaScope is active on a thread, every string, key and object/array
+ * node that Value allocates on that thread comes from the arena, and releasing
+ * one of them is a no-op. reset() then gives back the whole document at once.
+ *
+ * Values built inside the scope may be read, modified and destroyed after the
+ * scope ends, but all of them must be destroyed before reset() or ~Arena().
+ * Memory allocated outside any scope is ordinary heap memory, so a document
+ * may freely mix both.
+ *
+ * \code
+ * Json::Arena arena;
+ * for (;;) {
+ *   {
+ *     Json::ArenaScope scope(arena);
+ *     Json::Value root;
+ *     reader.parse(text, root);
+ *     ...
+ *   }
+ *   arena.reset();
+ * }
+ * \endcode
+ */
+class JSON_API Arena {
+public:
+  explicit Arena(size_t blockSize = 4096);
+  ~Arena();
+
+  /// 8 byte aligned; never returns NULL.
+  void* allocate(size_t size);
+  /// Rewinds to the start, keeping the largest block for reuse.
+  void reset();
+
+  /// Bytes handed out since the last reset().
+  size_t used() const { return used_; }
+  /// Bytes of all blocks currently owned.
+  size_t capacity() const { return capacity_; }
+  /// Blocks obtained from the heap over the lifetime of the arena.
+  size_t blockAllocations() const { return blockAllocations_; }
+
+private:
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+
+  struct Block {
+    Block* next_;
+    size_t size_;
+  };
+
+  Block* head_;
+  char* current_;
+  char* end_;
+  size_t blockSize_;
+  size_t used_;
+  size_t capacity_;
+  size_t blockAllocations_;
+};
+
+/** \brief Routes this thread's Value allocations into an Arena.
+ *
+ * Scopes nest; the previous arena (or the heap) is restored on destruction.
+ */
+class JSON_API ArenaScope {
+public:
+  explicit ArenaScope(Arena& arena);
+  ~ArenaScope();
+
+  /// The arena of the innermost scope on this thread, or NULL.
+  static Arena* current();
+
+private:
+  ArenaScope(const ArenaScope&);
+  ArenaScope& operator=(const ArenaScope&);
+
+  Arena* previous_;
+};
+
+namespace Detail {
+
+/// Memory for Value internals: from the current arena if any, else the heap.
+JSON_API void* allocate(size_t size);
+/// Releases memory from allocate(); arena memory is left to its arena.
+JSON_API void release(void* p);
+
+/// std::allocator replacement used by the object/array node map.
+template <typename T> class Allocator {
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <typename U> struct rebind { typedef Allocator<U> other; };
+
+  Allocator() {}
+  template <typename U> Allocator(const Allocator<U>&) {}
+
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+  pointer allocate(size_type n, const void* = 0) {
+    return static_cast<pointer>(Detail::allocate(n * sizeof(T)));
+  }
+  void deallocate(pointer p, size_type) { Detail::release(p); }
+  size_type max_size() const { return size_t(-1) / sizeof(T); }
+  void construct(pointer p, const T& value) { new (p) T(value); }
+  void destroy(pointer p) { p->~T(); }
+
+  template <typename U> bool operator==(const Allocator<U>&) const { return true; }
+  template <typename U> bool operator!=(const Allocator<U>&) const { return false; }
+};
+
+} // namespace Detail
+
+} // namespace Json
+
+#endif // JSON_ARENA_H_INCLUDED
@@ -51,6 +51,17 @@
 #define JSON_API
 #endif
 
+// Thread local storage for the current Json::ArenaScope. Define
+// JSON_NO_THREAD_LOCAL on toolchains without it; arenas then apply to all
+// threads at once and must only be used from single threaded programs.
+#if defined(JSON_NO_THREAD_LOCAL)
+#define JSON_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define JSON_THREAD_LOCAL __declspec(thread)
+#else
+#define JSON_THREAD_LOCAL __thread
+#endif
+
 // If JSON_NO_INT64 is defined, then Json only support C++ "int" type for
 // integer
 // Storages, and 64 bits integer support is disabled.
@@ -22,6 +22,10 @@ class Reader;
 // features.h
 class Features;
 
+// arena.h
+class Arena;
+class ArenaScope;
+
 // value.h
 typedef unsigned int ArrayIndex;
 class StaticString;
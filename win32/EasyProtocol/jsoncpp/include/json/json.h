@@ -11,5 +11,6 @@
 #include "reader.h"
 #include "writer.h"
 #include "features.h"
+#include "arena.h"
 
 #endif // JSON_JSON_H_INCLUDED
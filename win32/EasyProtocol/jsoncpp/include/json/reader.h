@@ -97,6 +97,17 @@ namespace Json {
 			Value& root,
 			bool collectComments = true);
 
+		/** \brief Read a Value from a JSON document without copying its strings.
+		 *
+		 * Like parse(beginDoc, endDoc, root, false), but a string value or member
+		 * name that needs no unescaping is not copied: root refers to it in
+		 * [beginDoc, endDoc). Read such strings with Value::getString(); a copy of
+		 * a Value owns its strings again.
+		 * \note The document must stay alive and unchanged until root and every
+		 *       Value inside it is destroyed or overwritten.
+		 */
+		bool parseBorrowed(const char* beginDoc, const char* endDoc, Value& root);
+
 		/// \brief Parse from input stream.
 		/// \see Json::operator>>(std::istream&, Json::Value&).
 		bool parse(std::istream& is, Value& root, bool collectComments = true);
@@ -228,6 +239,8 @@ namespace Json {
 		void addComment(Location begin, Location end, CommentPlacement placement);
 		void skipCommentTokens(Token& token);
 
+		bool hasEscape(const Token& token) const;
+
 		typedef std::stack<Value*> Nodes;
 		Nodes nodes_;
 		Errors errors_;
@@ -240,6 +253,7 @@ namespace Json {
 		std::string commentsBefore_;
 		Features features_;
 		bool collectComments_;
+		bool borrow_;
 	};  // Reader
 
 	/** Interface for reading JSON from a char array.
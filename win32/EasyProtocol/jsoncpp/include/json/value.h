@@ -8,6 +8,7 @@
 
 #if !defined(JSON_IS_AMALGAMATION)
 #include "forwards.h"
+#include "arena.h"
 #endif // if !defined(JSON_IS_AMALGAMATION)
 #include <string>
 #include <vector>
@@ -161,6 +162,7 @@ private:
  */
 class JSON_API Value {
   friend class ValueIteratorBase;
+  friend class Reader;
 public:
   typedef std::vector<std::string> Members;
   typedef ValueIterator iterator;
@@ -207,7 +209,8 @@ private:
     enum DuplicationPolicy {
       noDuplication = 0,
       duplicate,
-      duplicateOnCopy
+      duplicateOnCopy,
+      borrowed ///< points into a Reader::parseBorrowed() document, copies duplicate it
     };
     CZString(ArrayIndex index);
     CZString(char const* str, unsigned length, DuplicationPolicy allocate);
@@ -221,6 +224,8 @@ private:
     char const* data() const;
     unsigned length() const;
     bool isStaticString() const;
+    /// Switches a noDuplication key already stored in a map to #borrowed.
+    void setBorrowed();
 
   private:
     void swap(CZString& other);
@@ -239,7 +244,9 @@ private:
 
 public:
 #ifndef JSON_USE_CPPTL_SMALLMAP
-  typedef std::map<CZString, Value> ObjectValues;
+  typedef std::map<CZString, Value, std::less<CZString>,
+                   Detail::Allocator<std::pair<const CZString, Value> > >
+      ObjectValues;
 #else
   typedef CppTL::SmallMap<CZString, Value> ObjectValues;
 #endif // ifndef JSON_USE_CPPTL_SMALLMAP
@@ -319,9 +326,13 @@ Json::Value obj_value(Json::objectValue); // {}
   std::string asString() const; ///< Embedded zeroes are possible.
   /** Get raw char* of string-value.
    *  \return false if !string. (Seg-fault if str or end are NULL.)
+   *  \note This is the way to read a string parsed by Reader::parseBorrowed()
+   *  without copying it: [begin, end) then points into the document.
    */
   bool getString(
       char const** begin, char const** end) const;
+  /// \c true if this string points into a Reader::parseBorrowed() document.
+  bool isBorrowed() const;
 #ifdef JSON_USE_CPPTL
   CppTL::ConstString asConstString() const;
 #endif
@@ -558,6 +569,11 @@ private:
   Value& resolveReference(const char* key);
   Value& resolveReference(const char* key, const char* end);
 
+  // Reader::parseBorrowed() support. The string is [begin, end) and ends at
+  // a '"', the member name is [key, end); neither is copied.
+  void setBorrowedString(const char* begin, const char* end);
+  Value& resolveBorrowedReference(const char* key, const char* end);
+
   struct CommentInfo {
     CommentInfo();
     ~CommentInfo();
@@ -587,6 +603,10 @@ private:
   ValueType type_ : 8;
   unsigned int allocated_ : 1; // Notes: if declared as bool, bitfield is useless.
                                // If not allocated_, string_ must be null-terminated.
+  unsigned int borrowed_ : 1;  // string_ points into a parseBorrowed() document
+                               // and ends at the next '"', not at a 0.
+  unsigned int borrowedLength_ : 22; // length of a borrowed string_, all ones if
+                                     // it did not fit and the '"' must be found
   CommentInfo* comments_;
 
   // [start, limit) byte offsets in the source JSON text from which this Value
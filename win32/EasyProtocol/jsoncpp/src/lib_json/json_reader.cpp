@@ -72,11 +72,12 @@ namespace Json {
 	Reader::Reader()
 		: errors_(), document_(), begin_(), end_(), current_(), lastValueEnd_(),
 		lastValue_(), commentsBefore_(), features_(Features::all()),
-		collectComments_() {}
+		collectComments_(), borrow_(false) {}
 
 	Reader::Reader(const Features& features)
 		: errors_(), document_(), begin_(), end_(), current_(), lastValueEnd_(),
-		lastValue_(), commentsBefore_(), features_(features), collectComments_() {
+		lastValue_(), commentsBefore_(), features_(features), collectComments_(),
+		borrow_(false) {
 	}
 
 	bool
@@ -87,6 +88,13 @@ namespace Json {
 		return parse(begin, end, root, collectComments);
 	}
 
+	bool Reader::parseBorrowed(const char* beginDoc, const char* endDoc, Value& root) {
+		borrow_ = true;
+		bool successful = parse(beginDoc, endDoc, root, false);
+		borrow_ = false;
+		return successful;
+	}
+
 	bool Reader::parse(std::istream& sin, Value& root, bool collectComments) {
 		// std::istream_iterator<char> begin(sin);
 		// std::istream_iterator<char> end;
@@ -447,6 +455,7 @@ namespace Json {
 	bool Reader::readObject(Token& tokenStart) {
 		Token tokenName;
 		std::string name;
+		bool emptyName = true;
 		Value init(objectValue);
 		currentValue().swapPayload(init);
 		currentValue().setOffsetStart(tokenStart.start_ - begin_);
@@ -456,11 +465,13 @@ namespace Json {
 				initialTokenOk = readToken(tokenName);
 			if (!initialTokenOk)
 				break;
-			if (tokenName.type_ == tokenObjectEnd && name.empty()) // empty object
+			if (tokenName.type_ == tokenObjectEnd && emptyName) // empty object
 				return true;
 			name = "";
+			bool borrowName = false;
 			if (tokenName.type_ == tokenString) {
-				if (!decodeString(tokenName, name))
+				borrowName = borrow_ && !hasEscape(tokenName);
+				if (!borrowName && !decodeString(tokenName, name))
 					return recoverFromError(tokenObjectEnd);
 			}
 			else if (tokenName.type_ == tokenNumber && features_.allowNumericKeys_) {
@@ -472,13 +483,16 @@ namespace Json {
 			else {
 				break;
 			}
+			emptyName = borrowName ? tokenName.end_ - tokenName.start_ == 2 : name.empty();
 
 			Token colon;
 			if (!readToken(colon) || colon.type_ != tokenMemberSeparator) {
 				return addErrorAndRecover(
 					"Missing ':' after object member name", colon, tokenObjectEnd);
 			}
-			Value& value = currentValue()[name];
+			Value& value = borrowName
+				? currentValue().resolveBorrowedReference(tokenName.start_ + 1, tokenName.end_ - 1)
+				: currentValue()[name];
 			nodes_.push(&value);
 			bool ok = readValue();
 			nodes_.pop();
@@ -614,7 +628,19 @@ namespace Json {
 		return true;
 	}
 
+	bool Reader::hasEscape(const Token& token) const {
+		return memchr(token.start_ + 1, '\\', token.end_ - token.start_ - 2) != 0;
+	}
+
 	bool Reader::decodeString(Token& token) {
+		if (borrow_ && !hasEscape(token)) {
+			Value borrowed;
+			borrowed.setBorrowedString(token.start_ + 1, token.end_ - 1);
+			currentValue().swapPayload(borrowed);
+			currentValue().setOffsetStart(token.start_ - begin_);
+			currentValue().setOffsetLimit(token.end_ - begin_);
+			return true;
+		}
 		std::string decoded_string;
 		if (!decodeString(token, decoded_string))
 			return false;
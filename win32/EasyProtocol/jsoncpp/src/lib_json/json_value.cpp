@@ -85,7 +85,7 @@ namespace Json {
 		if (length >= (size_t)Value::maxInt)
 			length = Value::maxInt - 1;
 
-		char* newString = static_cast<char*>(malloc(length + 1));
+		char* newString = static_cast<char*>(Detail::allocate(length + 1));
 		if (newString == NULL) {
 			throwRuntimeError(
 				"in Json::Value::duplicateStringValue(): "
@@ -108,7 +108,7 @@ namespace Json {
 			"in Json::Value::duplicateAndPrefixStringValue(): "
 			"length too big for prefixing");
 		unsigned actualLength = length + static_cast<unsigned>(sizeof(unsigned)) + 1U;
-		char* newString = static_cast<char*>(malloc(actualLength));
+		char* newString = static_cast<char*>(Detail::allocate(actualLength));
 		if (newString == 0) {
 			throwRuntimeError(
 				"in Json::Value::duplicateAndPrefixStringValue(): "
@@ -119,11 +119,29 @@ namespace Json {
 		newString[actualLength - 1U] = 0; // to avoid buffer over-run accidents by users later
 		return newString;
 	}
+	// Value::borrowedLength_ of a borrowed string too long for the bitfield
+	static const unsigned kBorrowedLengthUnknown = 0x3FFFFF;
+
 	inline static void decodePrefixedString(
-		bool isPrefixed, char const* prefixed,
+		bool isPrefixed, bool isBorrowed, unsigned borrowedLength, char const* prefixed,
 		unsigned* length, char const** value)
 	{
-		if (!isPrefixed) {
+		if (isBorrowed) {
+			// points into a document read by Reader::parseBorrowed(), which only
+			// borrows strings without escapes, so the first '"' ends it; the
+			// length was kept at parse time unless it was too long to fit
+			if (borrowedLength != kBorrowedLengthUnknown) {
+				*length = borrowedLength;
+			}
+			else {
+				char const* end = prefixed;
+				while (*end != '"')
+					++end;
+				*length = static_cast<unsigned>(end - prefixed);
+			}
+			*value = prefixed;
+		}
+		else if (!isPrefixed) {
 			*length = static_cast<unsigned>(strlen(prefixed));
 			*value = prefixed;
 		}
@@ -134,7 +152,28 @@ namespace Json {
 	}
 	/** Free the string duplicated by duplicateStringValue()/duplicateAndPrefixStringValue().
 	 */
-	static inline void releaseStringValue(char* value) { free(value); }
+	static inline void releaseStringValue(char* value) { Detail::release(value); }
+
+	static inline Value::ObjectValues* newObjectValues() {
+		return new (Detail::allocate(sizeof(Value::ObjectValues))) Value::ObjectValues();
+	}
+
+	static inline Value::ObjectValues* newObjectValues(const Value::ObjectValues& other) {
+		void* p = Detail::allocate(sizeof(Value::ObjectValues));
+		try {
+			return new (p) Value::ObjectValues(other);
+		}
+		catch (...) {
+			Detail::release(p);
+			throw;
+		}
+	}
+
+	static inline void releaseObjectValues(Value::ObjectValues* values) {
+		typedef Value::ObjectValues ObjectValues;
+		values->~ObjectValues();
+		Detail::release(values);
+	}
 
 } // namespace Json
 
@@ -176,6 +215,113 @@ namespace Json {
 		throw LogicError(msg);
 	}
 
+	// //////////////////////////////////////////////////////////////////
+	// //////////////////////////////////////////////////////////////////
+	// //////////////////////////////////////////////////////////////////
+	// class Arena
+	// //////////////////////////////////////////////////////////////////
+	// //////////////////////////////////////////////////////////////////
+	// //////////////////////////////////////////////////////////////////
+
+	static const size_t kArenaAlign = 8;
+	static const size_t kArenaMaxBlock = 1024 * 1024;
+
+	static JSON_THREAD_LOCAL Arena* currentArena = 0;
+
+	Arena::Arena(size_t blockSize)
+		: head_(0), current_(0), end_(0), blockSize_(blockSize < 256 ? 256 : blockSize),
+		used_(0), capacity_(0), blockAllocations_(0) {}
+
+	Arena::~Arena() {
+		while (head_) {
+			Block* next = head_->next_;
+			::operator delete(head_);
+			head_ = next;
+		}
+	}
+
+	void* Arena::allocate(size_t size) {
+		size = (size + kArenaAlign - 1) & ~(kArenaAlign - 1);
+		if (size > size_t(end_ - current_)) {
+			// blocks double up to kArenaMaxBlock so a reused arena settles on one
+			size_t blockSize = head_ ? head_->size_ * 2 : blockSize_;
+			if (blockSize > kArenaMaxBlock)
+				blockSize = kArenaMaxBlock;
+			if (blockSize < size)
+				blockSize = size;
+
+			Block* block = static_cast<Block*>(::operator new(sizeof(Block) + blockSize));
+			block->next_ = head_;
+			block->size_ = blockSize;
+			head_ = block;
+			current_ = reinterpret_cast<char*>(block + 1);
+			end_ = current_ + blockSize;
+			capacity_ += blockSize;
+			++blockAllocations_;
+		}
+		void* p = current_;
+		current_ += size;
+		used_ += size;
+		return p;
+	}
+
+	void Arena::reset() {
+		if (!head_)
+			return;
+		// the newest block is the largest one
+		Block* block = head_->next_;
+		while (block) {
+			Block* next = block->next_;
+			::operator delete(block);
+			block = next;
+		}
+		head_->next_ = 0;
+		current_ = reinterpret_cast<char*>(head_ + 1);
+		end_ = current_ + head_->size_;
+		used_ = 0;
+		capacity_ = head_->size_;
+	}
+
+	ArenaScope::ArenaScope(Arena& arena) : previous_(currentArena) {
+		currentArena = &arena;
+	}
+
+	ArenaScope::~ArenaScope() { currentArena = previous_; }
+
+	Arena* ArenaScope::current() { return currentArena; }
+
+	namespace Detail {
+
+		// Every block starts with this tag, so release() can tell arena memory
+		// from heap memory whichever scope is active when it is called.
+		union AllocationTag {
+			size_t fromArena_;
+			double align_;
+		};
+
+		void* allocate(size_t size) {
+			AllocationTag* tag;
+			if (currentArena) {
+				tag = static_cast<AllocationTag*>(currentArena->allocate(sizeof(AllocationTag) + size));
+				tag->fromArena_ = 1;
+			}
+			else {
+				tag = static_cast<AllocationTag*>(::operator new(sizeof(AllocationTag) + size));
+				tag->fromArena_ = 0;
+			}
+			return tag + 1;
+		}
+
+		void release(void* p) {
+			if (!p)
+				return;
+			AllocationTag* tag = static_cast<AllocationTag*>(p) - 1;
+			if (!tag->fromArena_)
+				::operator delete(tag);
+		}
+
+	} // namespace Detail
+
 	// //////////////////////////////////////////////////////////////////
 	// //////////////////////////////////////////////////////////////////
 	// //////////////////////////////////////////////////////////////////
@@ -282,6 +428,7 @@ namespace Json {
 	const char* Value::CZString::data() const { return cstr_; }
 	unsigned Value::CZString::length() const { return storage_.length_; }
 	bool Value::CZString::isStaticString() const { return storage_.policy_ == noDuplication; }
+	void Value::CZString::setBorrowed() { storage_.policy_ = borrowed; }
 
 	// //////////////////////////////////////////////////////////////////
 	// //////////////////////////////////////////////////////////////////
@@ -312,7 +459,7 @@ namespace Json {
 			break;
 		case arrayValue:
 		case objectValue:
-			value_.map_ = new ObjectValues();
+			value_.map_ = newObjectValues();
 			break;
 		case booleanValue:
 			value_.bool_ = false;
@@ -382,7 +529,7 @@ namespace Json {
 	}
 
 	Value::Value(Value const& other)
-		: type_(other.type_), allocated_(false)
+		: type_(other.type_), allocated_(false), borrowed_(false), borrowedLength_(0)
 		,
 		comments_(0), start_(other.start_), limit_(other.limit_)
 	{
@@ -395,10 +542,10 @@ namespace Json {
 			value_ = other.value_;
 			break;
 		case stringValue:
-			if (other.value_.string_ && other.allocated_) {
+			if (other.value_.string_ && (other.allocated_ || other.borrowed_)) {
 				unsigned len;
 				char const* str;
-				decodePrefixedString(other.allocated_, other.value_.string_,
+				decodePrefixedString(other.allocated_, other.borrowed_, other.borrowedLength_, other.value_.string_,
 					&len, &str);
 				value_.string_ = duplicateAndPrefixStringValue(str, len);
 				allocated_ = true;
@@ -410,7 +557,7 @@ namespace Json {
 			break;
 		case arrayValue:
 		case objectValue:
-			value_.map_ = new ObjectValues(*other.value_.map_);
+			value_.map_ = newObjectValues(*other.value_.map_);
 			break;
 		default:
 			JSON_ASSERT_UNREACHABLE;
@@ -440,7 +587,7 @@ namespace Json {
 			break;
 		case arrayValue:
 		case objectValue:
-			delete value_.map_;
+			releaseObjectValues(value_.map_);
 			break;
 		default:
 			JSON_ASSERT_UNREACHABLE;
@@ -463,6 +610,12 @@ namespace Json {
 		int temp2 = allocated_;
 		allocated_ = other.allocated_;
 		other.allocated_ = temp2 & 0x1;
+		int temp3 = borrowed_;
+		borrowed_ = other.borrowed_;
+		other.borrowed_ = temp3 & 0x1;
+		unsigned temp4 = borrowedLength_;
+		borrowedLength_ = other.borrowedLength_;
+		other.borrowedLength_ = temp4;
 	}
 
 	void Value::swap(Value& other) {
@@ -507,8 +660,8 @@ namespace Json {
 				unsigned other_len;
 				char const* this_str;
 				char const* other_str;
-				decodePrefixedString(this->allocated_, this->value_.string_, &this_len, &this_str);
-				decodePrefixedString(other.allocated_, other.value_.string_, &other_len, &other_str);
+				decodePrefixedString(this->allocated_, this->borrowed_, this->borrowedLength_, this->value_.string_, &this_len, &this_str);
+				decodePrefixedString(other.allocated_, other.borrowed_, other.borrowedLength_, other.value_.string_, &other_len, &other_str);
 				unsigned min_len = std::min(this_len, other_len);
 				int comp = memcmp(this_str, other_str, min_len);
 				if (comp < 0) return true;
@@ -562,8 +715,8 @@ namespace Json {
 				unsigned other_len;
 				char const* this_str;
 				char const* other_str;
-				decodePrefixedString(this->allocated_, this->value_.string_, &this_len, &this_str);
-				decodePrefixedString(other.allocated_, other.value_.string_, &other_len, &other_str);
+				decodePrefixedString(this->allocated_, this->borrowed_, this->borrowedLength_, this->value_.string_, &this_len, &this_str);
+				decodePrefixedString(other.allocated_, other.borrowed_, other.borrowedLength_, other.value_.string_, &other_len, &other_str);
 				if (this_len != other_len) return false;
 				int comp = memcmp(this_str, other_str, this_len);
 				return comp == 0;
@@ -583,10 +736,12 @@ namespace Json {
 	const char* Value::asCString() const {
 		JSON_ASSERT_MESSAGE(type_ == stringValue,
 			"in Json::Value::asCString(): requires stringValue");
+		JSON_ASSERT_MESSAGE(!borrowed_,
+			"in Json::Value::asCString(): a borrowed string is not null-terminated, use getString()");
 		if (value_.string_ == 0) return 0;
 		unsigned this_len;
 		char const* this_str;
-		decodePrefixedString(this->allocated_, this->value_.string_, &this_len, &this_str);
+		decodePrefixedString(this->allocated_, this->borrowed_, this->borrowedLength_, this->value_.string_, &this_len, &this_str);
 		return this_str;
 	}
 
@@ -594,11 +749,15 @@ namespace Json {
 		if (type_ != stringValue) return false;
 		if (value_.string_ == 0) return false;
 		unsigned length;
-		decodePrefixedString(this->allocated_, this->value_.string_, &length, str);
+		decodePrefixedString(this->allocated_, this->borrowed_, this->borrowedLength_, this->value_.string_, &length, str);
 		*cend = *str + length;
 		return true;
 	}
 
+	bool Value::isBorrowed() const {
+		return type_ == stringValue && borrowed_;
+	}
+
 	std::string Value::asString() const {
 		switch (type_) {
 		case nullValue:
@@ -608,7 +767,7 @@ namespace Json {
 				if (value_.string_ == 0) return "";
 				unsigned this_len;
 				char const* this_str;
-				decodePrefixedString(this->allocated_, this->value_.string_, &this_len, &this_str);
+				decodePrefixedString(this->allocated_, this->borrowed_, this->borrowedLength_, this->value_.string_, &this_len, &this_str);
 				return std::string(this_str, this_len);
 			}
 		case booleanValue:
@@ -629,7 +788,7 @@ namespace Json {
 	CppTL::ConstString Value::asConstString() const {
 		unsigned len;
 		char const* str;
-		decodePrefixedString(allocated_, value_.string_,
+		decodePrefixedString(allocated_, borrowed_, borrowedLength_, value_.string_,
 			&len, &str);
 		return CppTL::ConstString(str, len);
 	}
@@ -956,6 +1115,8 @@ namespace Json {
 	void Value::initBasic(ValueType vtype, bool allocated) {
 		type_ = vtype;
 		allocated_ = allocated;
+		borrowed_ = false;
+		borrowedLength_ = 0;
 		comments_ = 0;
 		start_ = 0;
 		limit_ = 0;
@@ -1002,6 +1163,37 @@ namespace Json {
 		return value;
 	}
 
+	void Value::setBorrowedString(const char* begin, const char* end) {
+		*this = Value(stringValue);
+		value_.string_ = const_cast<char*>(begin);
+		borrowed_ = true;
+		size_t length = static_cast<size_t>(end - begin);
+		borrowedLength_ = length < kBorrowedLengthUnknown
+			? static_cast<unsigned>(length) : kBorrowedLengthUnknown;
+	}
+
+	// @param key is not null-terminated and stays in the parsed document.
+	Value& Value::resolveBorrowedReference(char const* key, char const* cend)
+	{
+		JSON_ASSERT_MESSAGE(
+			type_ == nullValue || type_ == objectValue,
+			"in Json::Value::resolveBorrowedReference(key, end): requires objectValue");
+		if (type_ == nullValue)
+			*this = Value(objectValue);
+		CZString actualKey(
+			key, static_cast<unsigned>(cend - key), CZString::noDuplication);
+		ObjectValues::iterator it = value_.map_->lower_bound(actualKey);
+		if (it != value_.map_->end() && (*it).first == actualKey)
+			return (*it).second;
+
+		// inserted as noDuplication so the map keeps the pointer, then marked so
+		// that copies of this object duplicate the name
+		ObjectValues::value_type defaultValue(actualKey, nullRef);
+		it = value_.map_->insert(it, defaultValue);
+		const_cast<CZString&>((*it).first).setBorrowed();
+		return (*it).second;
+	}
+
 	Value Value::get(ArrayIndex index, const Value& defaultValue) const {
 		const Value* value = &((*this)[index]);
 		return value == &nullRef ? defaultValue : *value;
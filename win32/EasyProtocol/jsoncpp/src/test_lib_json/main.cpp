@@ -2334,6 +2334,143 @@ JSONTEST_FIXTURE(IteratorTest, indexes) {
   JSONTEST_ASSERT(it == json.end());
 }
 
+struct ArenaTest : JsonTest::TestCase {};
+
+JSONTEST_FIXTURE(ArenaTest, parseAndReset) {
+  Json::Arena arena(256);
+  Json::Reader reader;
+  std::string doc = "{\"key\":[\"a long string value, longer than any small buffer\",2,{\"x\":true}]}";
+  for (int pass = 0; pass < 3; ++pass) {
+    {
+      Json::ArenaScope scope(arena);
+      JSONTEST_ASSERT(Json::ArenaScope::current() == &arena);
+      Json::Value root;
+      JSONTEST_ASSERT(reader.parse(doc, root));
+      JSONTEST_ASSERT_STRING_EQUAL("a long string value, longer than any small buffer",
+                                   root["key"][0].asString());
+      JSONTEST_ASSERT_EQUAL(true, root["key"][2]["x"].asBool());
+      JSONTEST_ASSERT(arena.used() > 0);
+    }
+    JSONTEST_ASSERT(Json::ArenaScope::current() == 0);
+    arena.reset();
+    JSONTEST_ASSERT_EQUAL(0u, arena.used());
+  }
+  // the first pass grew the arena, later passes reuse its largest block
+  size_t blocks = arena.blockAllocations();
+  {
+    Json::ArenaScope scope(arena);
+    Json::Value root;
+    reader.parse(doc, root);
+  }
+  JSONTEST_ASSERT_EQUAL(blocks, arena.blockAllocations());
+}
+
+JSONTEST_FIXTURE(ArenaTest, mixedWithHeap) {
+  Json::Arena arena;
+  Json::Value heap;
+  {
+    Json::Value root;
+    {
+      Json::ArenaScope scope(arena);
+      root["inArena"] = "arena string";
+      heap = root; // copied inside the scope, so into the arena too
+    }
+    // modified and released outside the scope
+    root["onHeap"] = "heap string";
+    root.removeMember("inArena");
+    JSONTEST_ASSERT_STRING_EQUAL("heap string", root["onHeap"].asString());
+  }
+  JSONTEST_ASSERT_STRING_EQUAL("arena string", heap["inArena"].asString());
+  heap = Json::Value();
+  arena.reset();
+}
+
+struct BorrowTest : JsonTest::TestCase {};
+
+JSONTEST_FIXTURE(BorrowTest, pointsIntoDocument) {
+  Json::Reader reader;
+  std::string doc = "{\"name\":\"camera one\",\"esc\":\"a\\\"b\",\"list\":[\"x\",\"\"],\"n\":3}";
+  const char* begin = doc.data();
+  const char* end = begin + doc.size();
+  Json::Value root;
+  JSONTEST_ASSERT(reader.parseBorrowed(begin, end, root));
+
+  const char* str;
+  const char* strEnd;
+  JSONTEST_ASSERT(root["name"].isBorrowed());
+  JSONTEST_ASSERT(root["name"].getString(&str, &strEnd));
+  JSONTEST_ASSERT(str > begin && strEnd < end);
+  JSONTEST_ASSERT_STRING_EQUAL("camera one", std::string(str, strEnd));
+  JSONTEST_ASSERT_STRING_EQUAL("camera one", root["name"].asString());
+  // escaped strings are still decoded into a copy
+  JSONTEST_ASSERT(!root["esc"].isBorrowed());
+  JSONTEST_ASSERT_STRING_EQUAL("a\"b", root["esc"].asString());
+  JSONTEST_ASSERT_STRING_EQUAL("x", root["list"][0].asString());
+  JSONTEST_ASSERT_STRING_EQUAL("", root["list"][1].asString());
+  JSONTEST_ASSERT_EQUAL(3, root["n"].asInt());
+  JSONTEST_ASSERT(root["name"] == Json::Value("camera one"));
+
+  Json::Value::Members names = root.getMemberNames();
+  JSONTEST_ASSERT_EQUAL(4u, names.size());
+  JSONTEST_ASSERT_STRING_EQUAL("esc", names[0]);
+}
+
+JSONTEST_FIXTURE(BorrowTest, copiesOwnTheirStrings) {
+  Json::Reader reader;
+  Json::Value copy;
+  {
+    std::string doc = "{\"serial\":\"001001000010\",\"channels\":[{\"status\":\"online\"}]}";
+    Json::Value root;
+    JSONTEST_ASSERT(reader.parseBorrowed(doc.data(), doc.data() + doc.size(), root));
+    copy = root;
+    JSONTEST_ASSERT(!copy["serial"].isBorrowed());
+    doc.assign(doc.size(), '#'); // the copy must not see this
+  }
+  JSONTEST_ASSERT_STRING_EQUAL("001001000010", copy["serial"].asString());
+  JSONTEST_ASSERT_STRING_EQUAL("online", copy["channels"][0]["status"].asString());
+  JSONTEST_ASSERT(copy.isMember("channels"));
+  Json::FastWriter writer;
+  JSONTEST_ASSERT_STRING_EQUAL("{\"channels\":[{\"status\":\"online\"}],\"serial\":\"001001000010\"}\n",
+                               writer.write(copy));
+}
+
+JSONTEST_FIXTURE(BorrowTest, lengthKeptAtParse) {
+  Json::Reader reader;
+  // the length comes from the parse, not from looking for the '"' again
+  std::string doc = "[\"ab\",\"abc\"]";
+  Json::Value root;
+  JSONTEST_ASSERT(reader.parseBorrowed(doc.data(), doc.data() + doc.size(), root));
+  doc[4] = 'x'; // the closing quote is gone
+  JSONTEST_ASSERT_STRING_EQUAL("ab", root[0].asString());
+  JSONTEST_ASSERT(root[0] < root[1]);
+  JSONTEST_ASSERT(root[0] == Json::Value("ab"));
+
+  // too long for the bitfield: still read to its '"'
+  std::string big(0x400000 + 5, 'x');
+  std::string longDoc = "{\"big\":\"" + big + "\"}";
+  Json::Value longRoot;
+  JSONTEST_ASSERT(reader.parseBorrowed(longDoc.data(), longDoc.data() + longDoc.size(), longRoot));
+  JSONTEST_ASSERT(longRoot["big"].isBorrowed());
+  JSONTEST_ASSERT(big == longRoot["big"].asString());
+  Json::Value copy = longRoot;
+  JSONTEST_ASSERT_EQUAL(big.size(), copy["big"].asString().size());
+}
+
+JSONTEST_FIXTURE(BorrowTest, sameErrorsAsParse) {
+  const char* docs[] = { "{\"a\":1,}", "{\"\":1}", "{\"a\" 1}", "[\"open" };
+  for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); ++i) {
+    std::string doc(docs[i]);
+    Json::Reader copied;
+    Json::Reader borrowed;
+    Json::Value a;
+    Json::Value b;
+    bool okCopied = copied.parse(doc, a, false);
+    bool okBorrowed = borrowed.parseBorrowed(doc.data(), doc.data() + doc.size(), b);
+    JSONTEST_ASSERT_EQUAL(okCopied, okBorrowed);
+    JSONTEST_ASSERT(a == b);
+  }
+}
+
 int main(int argc, const char* argv[]) {
   JsonTest::Runner runner;
   JSONTEST_REGISTER_FIXTURE(runner, ValueTest, checkNormalizeFloatingPointStr);
@@ -2402,5 +2539,12 @@ int main(int argc, const char* argv[]) {
   JSONTEST_REGISTER_FIXTURE(runner, IteratorTest, names);
   JSONTEST_REGISTER_FIXTURE(runner, IteratorTest, indexes);
 
+  JSONTEST_REGISTER_FIXTURE(runner, ArenaTest, parseAndReset);
+  JSONTEST_REGISTER_FIXTURE(runner, ArenaTest, mixedWithHeap);
+  JSONTEST_REGISTER_FIXTURE(runner, BorrowTest, pointsIntoDocument);
+  JSONTEST_REGISTER_FIXTURE(runner, BorrowTest, copiesOwnTheirStrings);
+  JSONTEST_REGISTER_FIXTURE(runner, BorrowTest, lengthKeptAtParse);
+  JSONTEST_REGISTER_FIXTURE(runner, BorrowTest, sameErrorsAsParse);
+
   return runner.runCommandLine(argc, argv);
 }
@@ -0,0 +1,500 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "AudioMixer.h"
+#include "vssimd.h"
+#include <stdlib.h>
+#include <string.h>
+
+//acc[i] += (src[i] * gain) >> MIXER_GAIN_SHIFT
+void	MIX_Accumulate(int *acc, const short *src, int count, int gain)
+{
+	int i = 0;
+#if defined(__VS_SSE2)
+	__m128i g = _mm_set1_epi16((short)gain);
+	for (; i+8<=count; i+=8)
+	{
+		__m128i s  = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i lo = _mm_mullo_epi16(s, g);
+		__m128i hi = _mm_mulhi_epi16(s, g);
+		__m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), MIXER_GAIN_SHIFT);
+		__m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), MIXER_GAIN_SHIFT);
+		__m128i a0 = _mm_loadu_si128((const __m128i *)(acc + i));
+		__m128i a1 = _mm_loadu_si128((const __m128i *)(acc + i + 4));
+		_mm_storeu_si128((__m128i *)(acc + i),     _mm_add_epi32(a0, p0));
+		_mm_storeu_si128((__m128i *)(acc + i + 4), _mm_add_epi32(a1, p1));
+	}
+#elif defined(__VS_NEON)
+	int16x4_t g = vdup_n_s16((short)gain);
+	for (; i+8<=count; i+=8)
+	{
+		int16x8_t s  = vld1q_s16(src + i);
+		int32x4_t p0 = vshrq_n_s32(vmull_s16(vget_low_s16(s), g), MIXER_GAIN_SHIFT);
+		int32x4_t p1 = vshrq_n_s32(vmull_s16(vget_high_s16(s), g), MIXER_GAIN_SHIFT);
+		vst1q_s32(acc + i,     vaddq_s32(vld1q_s32(acc + i), p0));
+		vst1q_s32(acc + i + 4, vaddq_s32(vld1q_s32(acc + i + 4), p1));
+	}
+#endif
+	for (; i<count; i++)
+	{
+		acc[i] += (src[i] * gain) >> MIXER_GAIN_SHIFT;
+	}
+}
+
+//dst[i] = clamp(acc[i], -32768, 32767)
+void	MIX_Saturate(short *dst, const int *acc, int count)
+{
+	int i = 0;
+#if defined(__VS_SSE2)
+	for (; i+8<=count; i+=8)
+	{
+		__m128i a0 = _mm_loadu_si128((const __m128i *)(acc + i));
+		__m128i a1 = _mm_loadu_si128((const __m128i *)(acc + i + 4));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(a0, a1));
+	}
+#elif defined(__VS_NEON)
+	for (; i+8<=count; i+=8)
+	{
+		int16x4_t s0 = vqmovn_s32(vld1q_s32(acc + i));
+		int16x4_t s1 = vqmovn_s32(vld1q_s32(acc + i + 4));
+		vst1q_s16(dst + i, vcombine_s16(s0, s1));
+	}
+#endif
+	for (; i<count; i++)
+	{
+		int v = acc[i];
+		if (v > 32767)			v = 32767;
+		else if (v < -32768)	v = -32768;
+		dst[i] = (short)v;
+	}
+}
+
+
+CAudioMixer::CAudioMixer(void)
+{
+	memset(&input[0], 0x00, sizeof(MIXER_INPUT_T)*MAX_MIXER_INPUT_NUM);
+	outSamplerate	=	0;
+	outChannels		=	0;
+	prebufferFrames	=	0;
+	pAccBuf			=	NULL;
+	accSamples		=	0;
+	pConvBuf		=	NULL;
+	convFrames		=	0;
+	pMapBuf			=	NULL;
+	mapFrames		=	0;
+
+	_VS_InitLock(&crit);
+}
+
+CAudioMixer::~CAudioMixer(void)
+{
+	Close();
+	_VS_DeinitLock(&crit);
+}
+
+int	CAudioMixer::Open(unsigned int samplerate, unsigned int channels, unsigned int latencyMs)
+{
+	if (samplerate < 8000 || channels < 1 || channels > 2)		return -1;
+	if (latencyMs < MIXER_DEFAULT_PREBUFFER*2)	latencyMs = MIXER_DEFAULT_PREBUFFER*2;
+
+	Close();
+
+	_VS_Lock(&crit);
+	outSamplerate	=	samplerate;
+	outChannels		=	channels;
+	prebufferFrames	=	samplerate * MIXER_DEFAULT_PREBUFFER / 1000;
+	for (int i=0; i<MAX_MIXER_INPUT_NUM; i++)
+	{
+		input[i].fifoFrames = samplerate * latencyMs / 1000;
+	}
+	_VS_Unlock(&crit);
+
+	return 0;
+}
+
+void CAudioMixer::Close()
+{
+	_VS_Lock(&crit);
+	for (int i=0; i<MAX_MIXER_INPUT_NUM; i++)
+	{
+		if (NULL != input[i].pFifo)
+		{
+			delete []input[i].pFifo;
+		}
+		if (NULL != input[i].pResampler)
+		{
+			delete input[i].pResampler;
+		}
+		memset(&input[i], 0x00, sizeof(MIXER_INPUT_T));
+	}
+	if (NULL != pAccBuf)
+	{
+		delete []pAccBuf;
+		pAccBuf = NULL;
+	}
+	accSamples = 0;
+	if (NULL != pConvBuf)
+	{
+		delete []pConvBuf;
+		pConvBuf = NULL;
+	}
+	convFrames = 0;
+	if (NULL != pMapBuf)
+	{
+		delete []pMapBuf;
+		pMapBuf = NULL;
+	}
+	mapFrames = 0;
+	outSamplerate = 0;
+	outChannels = 0;
+	_VS_Unlock(&crit);
+}
+
+MIXER_INPUT_T	*CAudioMixer::GetInput(int inputId)
+{
+	if (inputId < 1 || inputId > MAX_MIXER_INPUT_NUM)		return NULL;
+
+	return &input[inputId-1];
+}
+
+void CAudioMixer::ResetInput(MIXER_INPUT_T *pInput)
+{
+	pInput->ready		=	0x00;
+	pInput->samplerate	=	0;
+	pInput->channels	=	0;
+	pInput->drift		=	1.0;
+	if (NULL != pInput->pResampler)		pInput->pResampler->Deinit();
+	pInput->readPos		=	0;
+	pInput->writePos	=	0;
+	pInput->frames		=	0;
+}
+
+int	CAudioMixer::AddInput(int inputId)
+{
+	int ret = -1;
+
+	_VS_Lock(&crit);
+	MIXER_INPUT_T *pInput = GetInput(inputId);
+	if (NULL != pInput && outSamplerate > 0)
+	{
+		if (NULL == pInput->pFifo)
+		{
+			pInput->pFifo = new short[pInput->fifoFrames * outChannels];
+		}
+		if (NULL != pInput->pFifo)
+		{
+			if (pInput->inuse == 0x00)
+			{
+				ResetInput(pInput);
+				pInput->mute	=	0x00;
+				pInput->gain	=	MIXER_GAIN_UNITY;
+				pInput->inuse	=	0x01;
+			}
+			ret = 0;
+		}
+	}
+	_VS_Unlock(&crit);
+
+	return ret;
+}
+
+int	CAudioMixer::RemoveInput(int inputId)
+{
+	_VS_Lock(&crit);
+	MIXER_INPUT_T *pInput = GetInput(inputId);
+	if (NULL != pInput)
+	{
+		pInput->inuse = 0x00;
+		ResetInput(pInput);
+	}
+	_VS_Unlock(&crit);
+
+	return NULL==pInput?-1:0;
+}
+
+int	CAudioMixer::IsInput(int inputId)
+{
+	MIXER_INPUT_T *pInput = GetInput(inputId);
+	if (NULL == pInput)		return 0;
+
+	return pInput->inuse;
+}
+
+int	CAudioMixer::GetInputNum()
+{
+	int num = 0;
+	for (int i=0; i<MAX_MIXER_INPUT_NUM; i++)
+	{
+		if (input[i].inuse == 0x01)		num ++;
+	}
+	return num;
+}
+
+int	CAudioMixer::ClearInput(int inputId)
+{
+	_VS_Lock(&crit);
+	MIXER_INPUT_T *pInput = GetInput(inputId);
+	if (NULL != pInput)
+	{
+		pInput->ready		=	0x00;
+		pInput->readPos		=	0;
+		pInput->writePos	=	0;
+		pInput->frames		=	0;
+	}
+	_VS_Unlock(&crit);
+
+	return NULL==pInput?-1:0;
+}
+
+int	CAudioMixer::SetVolume(int inputId, float volume)
+{
+	MIXER_INPUT_T *pInput = GetInput(inputId);
+	if (NULL == pInput)		return -1;
+
+	if (volume < 0.0f)					volume = 0.0f;
+	else if (volume > MIXER_MAX_VOLUME)	volume = MIXER_MAX_VOLUME;
+
+	pInput->gain = (int)(volume * MIXER_GAIN_UNITY + 0.5f);
+	if (pInput->gain > 32767)	pInput->gain = 32767;
+
+	return 0;
+}
+
+int	CAudioMixer::SetMute(int inputId, int mute)
+{
+	MIXER_INPUT_T *pInput = GetInput(inputId);
+	if (NULL == pInput)		return -1;
+
+	pInput->mute = (mute==0x00?0x00:0x01);
+	return 0;
+}
+
+int	CAudioMixer::SetDrift(int inputId, double ratio)
+{
+	_VS_Lock(&crit);
+	MIXER_INPUT_T *pInput = GetInput(inputId);
+	if (NULL == pInput)
+	{
+		_VS_Unlock(&crit);
+		return -1;
+	}
+	pInput->drift = ratio;
+	if (NULL != pInput->pResampler && pInput->pResampler->GetInRate() > 0)
+	{
+		pInput->pResampler->SetDrift(ratio);
+	}
+	else
+	{
+		pInput->samplerate = 0;		//the next Write sets up the resampler
+	}
+	_VS_Unlock(&crit);
+
+	return 0;
+}
+
+void CAudioMixer::PushFrames(MIXER_INPUT_T *pInput, const short *pcm, int frames)
+{
+	unsigned int num = (unsigned int)frames;
+	if (num > pInput->fifoFrames)
+	{
+		pcm += (num - pInput->fifoFrames) * outChannels;
+		num = pInput->fifoFrames;
+	}
+
+	//drop the oldest frames, keeps the latency bounded
+	if (pInput->frames + num > pInput->fifoFrames)
+	{
+		unsigned int drop = pInput->frames + num - pInput->fifoFrames;
+		pInput->readPos = (pInput->readPos + drop) % pInput->fifoFrames;
+		pInput->frames -= drop;
+	}
+
+	unsigned int tail = pInput->fifoFrames - pInput->writePos;
+	unsigned int n1 = num<tail?num:tail;
+	memcpy(pInput->pFifo + pInput->writePos * outChannels, pcm, n1 * outChannels * sizeof(short));
+	if (num > n1)
+	{
+		memcpy(pInput->pFifo, pcm + n1 * outChannels, (num - n1) * outChannels * sizeof(short));
+	}
+	pInput->writePos = (pInput->writePos + num) % pInput->fifoFrames;
+	pInput->frames += num;
+}
+
+//channel mapping and rate conversion to the output format
+void CAudioMixer::Convert(MIXER_INPUT_T *pInput, const short *pcm, int frames)
+{
+	unsigned int inCh = pInput->channels;
+	unsigned int rsCh = inCh<outChannels?inCh:outChannels;		//resample as few channels as possible
+	const short *pSrc = pcm;
+
+	if (inCh != rsCh)
+	{
+		if (frames > mapFrames)
+		{
+			if (NULL != pMapBuf)	delete []pMapBuf;
+			mapFrames = frames;
+			pMapBuf = new short[mapFrames * 2];
+			if (NULL == pMapBuf)
+			{
+				mapFrames = 0;
+				return;
+			}
+		}
+		for (int i=0; i<frames; i++)
+		{
+			const short *s = pcm + i * inCh;
+			if (rsCh == 1)	pMapBuf[i] = (short)((s[0] + s[1]) >> 1);
+			else
+			{
+				pMapBuf[i*2]   = s[0];
+				pMapBuf[i*2+1] = s[1];
+			}
+		}
+		pSrc = pMapBuf;
+	}
+
+	int num = frames;
+	int maxFrames = frames;
+	if (NULL != pInput->pResampler && pInput->pResampler->GetInRate() > 0)
+	{
+		maxFrames = pInput->pResampler->GetMaxOutFrames(frames);
+	}
+	if (maxFrames > convFrames)
+	{
+		if (NULL != pConvBuf)	delete []pConvBuf;
+		convFrames = maxFrames;
+		pConvBuf = new short[convFrames * 2];
+		if (NULL == pConvBuf)
+		{
+			convFrames = 0;
+			return;
+		}
+	}
+
+	if (NULL != pInput->pResampler && pInput->pResampler->GetInRate() > 0)
+	{
+		num = pInput->pResampler->Process(pSrc, frames, pConvBuf, convFrames);
+		if (num < 1)		return;
+		pSrc = pConvBuf;
+	}
+
+	//mono to stereo, backwards so it also works in place
+	if (rsCh < outChannels)
+	{
+		for (int i=num-1; i>=0; i--)
+		{
+			short v = pSrc[i];
+			pConvBuf[i*2]	= v;
+			pConvBuf[i*2+1]	= v;
+		}
+		pSrc = pConvBuf;
+	}
+
+	PushFrames(pInput, pSrc, num);
+}
+
+int	CAudioMixer::Write(int inputId, const short *pcm, int frames, unsigned int samplerate, unsigned int channels)
+{
+	if (NULL == pcm || frames < 1 || samplerate < 1 || channels < 1)	return -1;
+
+	_VS_Lock(&crit);
+	MIXER_INPUT_T *pInput = GetInput(inputId);
+	if (NULL == pInput || pInput->inuse == 0x00 || NULL == pInput->pFifo)
+	{
+		_VS_Unlock(&crit);
+		return -1;
+	}
+
+	if (pInput->samplerate != samplerate || pInput->channels != channels)
+	{
+		pInput->samplerate	=	samplerate;
+		pInput->channels	=	channels;
+
+		unsigned int rsCh = channels<outChannels?channels:outChannels;
+		if (samplerate != outSamplerate || pInput->drift != 1.0)
+		{
+			if (NULL == pInput->pResampler)		pInput->pResampler = new CAudioResampler();
+			if (NULL != pInput->pResampler && 0 == pInput->pResampler->Init(samplerate, outSamplerate, rsCh))
+			{
+				pInput->pResampler->SetDrift(pInput->drift);
+			}
+		}
+		else if (NULL != pInput->pResampler)
+		{
+			pInput->pResampler->Deinit();
+		}
+	}
+
+	if (samplerate == outSamplerate && channels == outChannels && (NULL == pInput->pResampler || pInput->pResampler->GetInRate() < 1))
+	{
+		PushFrames(pInput, pcm, frames);
+	}
+	else
+	{
+		Convert(pInput, pcm, frames);
+	}
+	_VS_Unlock(&crit);
+
+	return 0;
+}
+
+int	CAudioMixer::Mix(short *pOut, int frames)
+{
+	if (NULL == pOut || frames < 1)		return -1;
+
+	_VS_Lock(&crit);
+	if (outSamplerate < 1)
+	{
+		_VS_Unlock(&crit);
+		return -1;
+	}
+
+	int samples = frames * outChannels;
+	if (samples > accSamples)
+	{
+		if (NULL != pAccBuf)	delete []pAccBuf;
+		accSamples = samples;
+		pAccBuf = new int[accSamples];
+	}
+	memset(pAccBuf, 0x00, samples * sizeof(int));
+
+	int active = 0;
+	for (int i=0; i<MAX_MIXER_INPUT_NUM; i++)
+	{
+		MIXER_INPUT_T *pInput = &input[i];
+		if (pInput->inuse == 0x00)		continue;
+
+		if (pInput->ready == 0x00)
+		{
+			if (pInput->frames < prebufferFrames)	continue;
+			pInput->ready = 0x01;
+		}
+
+		unsigned int num = pInput->frames<(unsigned int)frames?pInput->frames:(unsigned int)frames;
+		if (pInput->mute == 0x00 && pInput->gain > 0)
+		{
+			unsigned int tail = pInput->fifoFrames - pInput->readPos;
+			unsigned int n1 = num<tail?num:tail;
+			MIX_Accumulate(pAccBuf, pInput->pFifo + pInput->readPos * outChannels, n1 * outChannels, pInput->gain);
+			if (num > n1)
+			{
+				MIX_Accumulate(pAccBuf + n1 * outChannels, pInput->pFifo, (num - n1) * outChannels, pInput->gain);
+			}
+			active ++;
+		}
+		pInput->readPos = (pInput->readPos + num) % pInput->fifoFrames;
+		pInput->frames -= num;
+
+		//underrun, wait for the prebuffer again
+		if (num < (unsigned int)frames)		pInput->ready = 0x00;
+	}
+
+	MIX_Saturate(pOut, pAccBuf, samples);
+	_VS_Unlock(&crit);
+
+	return active;
+}
@@ -0,0 +1,97 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __AUDIO_MIXER_H__
+#define __AUDIO_MIXER_H__
+
+#include "vslock.h"
+#include "AudioResampler.h"
+
+#define		MAX_MIXER_INPUT_NUM			64		//max number of inputs (one per channel)
+#define		MIXER_GAIN_SHIFT			12		//gain is Q12, 4096 = 0dB
+#define		MIXER_GAIN_UNITY			(1<<MIXER_GAIN_SHIFT)
+#define		MIXER_MAX_VOLUME			4.0f	//+12dB
+#define		MIXER_DEFAULT_LATENCY		500		//ms, older samples are dropped
+#define		MIXER_DEFAULT_PREBUFFER		60		//ms buffered before an input becomes audible
+
+typedef struct __MIXER_INPUT_T
+{
+	int				inuse;
+	int				mute;
+	int				gain;			//Q12
+	int				ready;			//0x00:prebuffering  0x01:mixing
+
+	//input format
+	unsigned int	samplerate;
+	unsigned int	channels;
+
+	double			drift;			//playout rate nudge, 1.0 nominal
+	CAudioResampler	*pResampler;	//created when rate conversion or drift is needed
+
+	//fifo of output format frames
+	short			*pFifo;
+	unsigned int	fifoFrames;
+	unsigned int	readPos;
+	unsigned int	writePos;
+	unsigned int	frames;			//frames in fifo
+}MIXER_INPUT_T;
+
+//Mixing kernels, count is the number of samples (frames * channels)
+void	MIX_Accumulate(int *acc, const short *src, int count, int gain);
+void	MIX_Saturate(short *dst, const int *acc, int count);
+
+class CAudioMixer
+{
+public:
+	CAudioMixer(void);
+	~CAudioMixer(void);
+
+	//output format, channels: 1 or 2
+	int		Open(unsigned int samplerate, unsigned int channels, unsigned int latencyMs=MIXER_DEFAULT_LATENCY);
+	void	Close();
+
+	int		AddInput(int inputId);
+	int		RemoveInput(int inputId);
+	int		IsInput(int inputId);
+	int		GetInputNum();
+	int		ClearInput(int inputId);
+
+	int		SetVolume(int inputId, float volume);		//0.0 - MIXER_MAX_VOLUME
+	int		SetMute(int inputId, int mute);
+	int		SetDrift(int inputId, double ratio);		//see CAudioResampler::SetDrift
+
+	//16bit interleaved pcm in any rate/channels, converted to the output format
+	int		Write(int inputId, const short *pcm, int frames, unsigned int samplerate, unsigned int channels);
+
+	//mix 'frames' output frames into pOut, returns the number of audible inputs
+	int		Mix(short *pOut, int frames);
+
+	unsigned int	GetSampleRate()	{return outSamplerate;}
+	unsigned int	GetChannels()	{return outChannels;}
+
+protected:
+	MIXER_INPUT_T	*GetInput(int inputId);
+	void	ResetInput(MIXER_INPUT_T *pInput);
+	void	PushFrames(MIXER_INPUT_T *pInput, const short *pcm, int frames);
+	void	Convert(MIXER_INPUT_T *pInput, const short *pcm, int frames);
+
+	MIXER_INPUT_T	input[MAX_MIXER_INPUT_NUM];
+	unsigned int	outSamplerate;
+	unsigned int	outChannels;
+	unsigned int	prebufferFrames;
+
+	int				*pAccBuf;
+	int				accSamples;
+	short			*pConvBuf;
+	int				convFrames;
+	short			*pMapBuf;
+	int				mapFrames;
+
+	VS_LOCK_T		crit;
+};
+
+#endif
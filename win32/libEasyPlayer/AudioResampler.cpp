@@ -0,0 +1,430 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "AudioResampler.h"
+#include "vssimd.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define		RESAMPLER_CUTOFF		0.91	//relative to the lower nyquist frequency
+#define		RESAMPLER_KAISER_BETA	7.0		//~70dB stopband
+
+#ifndef M_PI
+#define M_PI	3.14159265358979323846
+#endif
+
+#if defined(__VS_AVX2)
+__VS_TARGET_AVX2 static int __DotS16Avx2(const short *x, const short *c, int n)
+{
+	int i = 0;
+	__m256i acc8 = _mm256_setzero_si256();
+	for (; i+16<=n; i+=16)
+	{
+		__m256i vx = _mm256_loadu_si256((const __m256i *)(x + i));
+		__m256i vc = _mm256_loadu_si256((const __m256i *)(c + i));
+		acc8 = _mm256_add_epi32(acc8, _mm256_madd_epi16(vx, vc));
+	}
+	__m128i acc = _mm_add_epi32(_mm256_castsi256_si128(acc8), _mm256_extracti128_si256(acc8, 1));
+	_mm256_zeroupper();
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+	int sum = _mm_cvtsi128_si32(acc);
+	for (; i<n; i++)
+	{
+		sum += x[i] * c[i];
+	}
+	return sum;
+}
+
+__VS_TARGET_AVX2 static float __DotF32Avx2(const float *x, const float *c, int n)
+{
+	int i = 0;
+	__m256 acc8 = _mm256_setzero_ps();
+	for (; i+8<=n; i+=8)
+	{
+		acc8 = _mm256_add_ps(acc8, _mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(c + i)));
+	}
+	__m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc8), _mm256_extractf128_ps(acc8, 1));
+	_mm256_zeroupper();
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 0x55));
+	float sum = _mm_cvtss_f32(acc);
+	for (; i<n; i++)
+	{
+		sum += x[i] * c[i];
+	}
+	return sum;
+}
+#endif
+
+int		RS_DotS16(const short *x, const short *c, int n)
+{
+#if defined(__VS_AVX2)
+	if (_VS_UseAvx2())		return __DotS16Avx2(x, c, n);
+#endif
+	int i = 0;
+	int sum = 0;
+#if defined(__VS_SSE2)
+	__m128i acc = _mm_setzero_si128();
+	for (; i+8<=n; i+=8)
+	{
+		__m128i vx = _mm_loadu_si128((const __m128i *)(x + i));
+		__m128i vc = _mm_loadu_si128((const __m128i *)(c + i));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(vx, vc));
+	}
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+	sum = _mm_cvtsi128_si32(acc);
+#elif defined(__VS_NEON)
+	int32x4_t acc = vdupq_n_s32(0);
+	for (; i+8<=n; i+=8)
+	{
+		int16x8_t vx = vld1q_s16(x + i);
+		int16x8_t vc = vld1q_s16(c + i);
+		acc = vmlal_s16(acc, vget_low_s16(vx), vget_low_s16(vc));
+		acc = vmlal_s16(acc, vget_high_s16(vx), vget_high_s16(vc));
+	}
+	int32x2_t acc2 = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+	sum = vget_lane_s32(vpadd_s32(acc2, acc2), 0);
+#endif
+	for (; i<n; i++)
+	{
+		sum += x[i] * c[i];
+	}
+	return sum;
+}
+
+float	RS_DotF32(const float *x, const float *c, int n)
+{
+#if defined(__VS_AVX2)
+	if (_VS_UseAvx2())		return __DotF32Avx2(x, c, n);
+#endif
+	int i = 0;
+	float sum = 0.0f;
+#if defined(__VS_SSE2)
+	__m128 acc = _mm_setzero_ps();
+	for (; i+4<=n; i+=4)
+	{
+		acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(c + i)));
+	}
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 0x55));
+	sum = _mm_cvtss_f32(acc);
+#elif defined(__VS_NEON)
+	float32x4_t acc = vdupq_n_f32(0.0f);
+	for (; i+4<=n; i+=4)
+	{
+		acc = vmlaq_f32(acc, vld1q_f32(x + i), vld1q_f32(c + i));
+	}
+	float32x2_t acc2 = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+	sum = vget_lane_f32(vpadd_f32(acc2, acc2), 0);
+#endif
+	for (; i<n; i++)
+	{
+		sum += x[i] * c[i];
+	}
+	return sum;
+}
+
+//zeroth order modified bessel function, for the kaiser window
+static double __BesselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	for (int k=1; k<32; k++)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-12)		break;
+	}
+	return sum;
+}
+
+
+CAudioResampler::CAudioResampler(void)
+{
+	inRate		=	0;
+	outRate		=	0;
+	channels	=	0;
+	format		=	RESAMPLE_FORMAT_S16;
+	drift		=	1.0;
+	taps		=	0;
+	pCoefS16	=	NULL;
+	pCoefF32	=	NULL;
+	step		=	0;
+	pos			=	0;
+	for (int i=0; i<RESAMPLER_MAX_CHANNELS; i++)	pHistory[i] = NULL;
+	histFrames	=	0;
+	histSize	=	0;
+}
+
+CAudioResampler::~CAudioResampler(void)
+{
+	Deinit();
+}
+
+int	CAudioResampler::Init(unsigned int _inRate, unsigned int _outRate, unsigned int _channels, RESAMPLE_FORMAT _format)
+{
+	if (_inRate < 1 || _outRate < 1)		return -1;
+	if (_channels < 1 || _channels > RESAMPLER_MAX_CHANNELS)		return -1;
+
+	Deinit();
+
+	inRate		=	_inRate;
+	outRate		=	_outRate;
+	channels	=	_channels;
+	format		=	_format;
+	drift		=	1.0;
+
+	//downsampling needs a longer filter for the same transition band
+	double ratio = (double)outRate / (double)inRate;
+	int n = RESAMPLER_BASE_TAPS;
+	if (ratio < 1.0)	n = (int)ceil(RESAMPLER_BASE_TAPS / ratio);
+	taps = (n + 15) & ~15;
+	if (taps > RESAMPLER_MAX_TAPS)	taps = RESAMPLER_MAX_TAPS;
+
+	if (format == RESAMPLE_FORMAT_S16)	pCoefS16 = new short[(RESAMPLER_PHASE_NUM + 1) * taps];
+	else								pCoefF32 = new float[(RESAMPLER_PHASE_NUM + 1) * taps];
+	if (NULL == pCoefS16 && NULL == pCoefF32)
+	{
+		Deinit();
+		return -1;
+	}
+	BuildFilter();
+
+	histSize = taps + RESAMPLER_CHUNK_FRAMES;
+	int sampleSize = format==RESAMPLE_FORMAT_S16?sizeof(short):sizeof(float);
+	for (unsigned int i=0; i<channels; i++)
+	{
+		pHistory[i] = malloc(histSize * sampleSize);
+		if (NULL == pHistory[i])
+		{
+			Deinit();
+			return -1;
+		}
+	}
+
+	step = (((unsigned long long)inRate) << 32) / outRate;
+	Reset();
+
+	return 0;
+}
+
+void CAudioResampler::Deinit()
+{
+	if (NULL != pCoefS16)
+	{
+		delete []pCoefS16;
+		pCoefS16 = NULL;
+	}
+	if (NULL != pCoefF32)
+	{
+		delete []pCoefF32;
+		pCoefF32 = NULL;
+	}
+	for (int i=0; i<RESAMPLER_MAX_CHANNELS; i++)
+	{
+		if (NULL != pHistory[i])
+		{
+			free(pHistory[i]);
+			pHistory[i] = NULL;
+		}
+	}
+	histFrames	=	0;
+	histSize	=	0;
+	taps		=	0;
+	channels	=	0;
+	inRate		=	0;
+	outRate		=	0;
+}
+
+void CAudioResampler::Reset()
+{
+	//half a filter of silence, the first output is aligned with the first input frame
+	histFrames = taps / 2 - 1;
+	int sampleSize = format==RESAMPLE_FORMAT_S16?sizeof(short):sizeof(float);
+	for (unsigned int i=0; i<channels; i++)
+	{
+		if (NULL != pHistory[i])	memset(pHistory[i], 0x00, histFrames * sampleSize);
+	}
+	pos = 0;
+}
+
+void CAudioResampler::BuildFilter()
+{
+	double cutoff = RESAMPLER_CUTOFF;
+	if (outRate < inRate)	cutoff *= (double)outRate / (double)inRate;
+
+	double half = taps / 2.0;
+	double i0Beta = __BesselI0(RESAMPLER_KAISER_BETA);
+	double *pCoef = new double[taps];
+
+	//one extra phase (a full frame delay) for interpolating past the last bank
+	for (int p=0; p<=RESAMPLER_PHASE_NUM; p++)
+	{
+		double frac = (double)p / RESAMPLER_PHASE_NUM;
+		double sum = 0.0;
+		for (int k=0; k<taps; k++)
+		{
+			double t = k - (taps / 2 - 1) - frac;
+			double x = cutoff * t;
+			double sinc = fabs(x) < 1e-9 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+			double w = t / half;
+			double win = (w <= -1.0 || w >= 1.0) ? 0.0 : __BesselI0(RESAMPLER_KAISER_BETA * sqrt(1.0 - w * w)) / i0Beta;
+			pCoef[k] = sinc * win;
+			sum += pCoef[k];
+		}
+
+		//unity gain at DC for every phase
+		for (int k=0; k<taps; k++)
+		{
+			double c = pCoef[k] / sum;
+			if (NULL != pCoefS16)	pCoefS16[p * taps + k] = (short)floor(c * (1 << RESAMPLER_COEF_SHIFT) + 0.5);
+			if (NULL != pCoefF32)	pCoefF32[p * taps + k] = (float)c;
+		}
+	}
+	delete []pCoef;
+}
+
+int	CAudioResampler::SetDrift(double ratio)
+{
+	if (inRate < 1 || outRate < 1)		return -1;
+
+	if (ratio < 1.0 - RESAMPLER_MAX_DRIFT)			ratio = 1.0 - RESAMPLER_MAX_DRIFT;
+	else if (ratio > 1.0 + RESAMPLER_MAX_DRIFT)		ratio = 1.0 + RESAMPLER_MAX_DRIFT;
+
+	drift = ratio;
+	step = (unsigned long long)((double)(((unsigned long long)inRate) << 32) * drift / outRate);
+	return 0;
+}
+
+int	CAudioResampler::GetMaxOutFrames(int inFrames)
+{
+	if (inRate < 1)		return 0;
+
+	double ratio = (double)outRate / ((double)inRate * (1.0 - RESAMPLER_MAX_DRIFT));
+	return (int)(inFrames * ratio) + 2;
+}
+
+//filter every output frame that has a full window of history
+int	CAudioResampler::Run(int maxOutFrames, short *pOutS16, float *pOutF32, int outIdx)
+{
+	while (outIdx < maxOutFrames)
+	{
+		int idx = (int)(pos >> 32);
+		if (idx + taps > histFrames)	break;
+
+		int phase = (int)((pos >> (32 - RESAMPLER_PHASE_BITS)) & (RESAMPLER_PHASE_NUM - 1));
+		int frac  = (int)((pos >> (32 - RESAMPLER_PHASE_BITS - 15)) & 0x7FFF);		//Q15 between two phases
+		if (NULL != pOutS16)
+		{
+			const short *pCoef = pCoefS16 + phase * taps;
+			for (unsigned int ch=0; ch<channels; ch++)
+			{
+				const short *pHist = (const short *)pHistory[ch] + idx;
+				int v0 = RS_DotS16(pHist, pCoef, taps);
+				int v1 = RS_DotS16(pHist, pCoef + taps, taps);
+				int v = v0 + (int)(((long long)(v1 - v0) * frac) >> 15);
+				v = (v + (1 << (RESAMPLER_COEF_SHIFT - 1))) >> RESAMPLER_COEF_SHIFT;
+				if (v > 32767)			v = 32767;
+				else if (v < -32768)	v = -32768;
+				pOutS16[outIdx * channels + ch] = (short)v;
+			}
+		}
+		else
+		{
+			const float *pCoef = pCoefF32 + phase * taps;
+			float a = frac * (1.0f / 32768.0f);
+			for (unsigned int ch=0; ch<channels; ch++)
+			{
+				const float *pHist = (const float *)pHistory[ch] + idx;
+				float v0 = RS_DotF32(pHist, pCoef, taps);
+				float v1 = RS_DotF32(pHist, pCoef + taps, taps);
+				pOutF32[outIdx * channels + ch] = v0 + (v1 - v0) * a;
+			}
+		}
+		pos += step;
+		outIdx ++;
+	}
+
+	//keep only the frames still needed by the next window
+	int idx = (int)(pos >> 32);
+	if (idx > histFrames)	idx = histFrames;
+	if (idx > 0)
+	{
+		int sampleSize = format==RESAMPLE_FORMAT_S16?sizeof(short):sizeof(float);
+		for (unsigned int ch=0; ch<channels; ch++)
+		{
+			char *pHist = (char *)pHistory[ch];
+			memmove(pHist, pHist + idx * sampleSize, (histFrames - idx) * sampleSize);
+		}
+		histFrames -= idx;
+		pos -= ((unsigned long long)idx) << 32;
+	}
+
+	return outIdx;
+}
+
+int	CAudioResampler::Process(const short *pIn, int inFrames, short *pOut, int maxOutFrames)
+{
+	if (NULL == pCoefS16 || NULL == pIn || NULL == pOut)	return -1;
+
+	int outIdx = 0;
+	int consumed = 0;
+	while (consumed < inFrames)
+	{
+		int n = histSize - histFrames;
+		if (n > inFrames - consumed)	n = inFrames - consumed;
+
+		for (unsigned int ch=0; ch<channels; ch++)
+		{
+			short *pDst = (short *)pHistory[ch] + histFrames;
+			const short *pSrc = pIn + consumed * channels + ch;
+			for (int i=0; i<n; i++)
+			{
+				pDst[i] = pSrc[i * channels];
+			}
+		}
+		histFrames += n;
+		consumed += n;
+
+		outIdx = Run(maxOutFrames, pOut, NULL, outIdx);
+		if (outIdx >= maxOutFrames)		break;
+	}
+
+	return outIdx;
+}
+
+int	CAudioResampler::Process(const float *pIn, int inFrames, float *pOut, int maxOutFrames)
+{
+	if (NULL == pCoefF32 || NULL == pIn || NULL == pOut)	return -1;
+
+	int outIdx = 0;
+	int consumed = 0;
+	while (consumed < inFrames)
+	{
+		int n = histSize - histFrames;
+		if (n > inFrames - consumed)	n = inFrames - consumed;
+
+		for (unsigned int ch=0; ch<channels; ch++)
+		{
+			float *pDst = (float *)pHistory[ch] + histFrames;
+			const float *pSrc = pIn + consumed * channels + ch;
+			for (int i=0; i<n; i++)
+			{
+				pDst[i] = pSrc[i * channels];
+			}
+		}
+		histFrames += n;
+		consumed += n;
+
+		outIdx = Run(maxOutFrames, NULL, pOut, outIdx);
+		if (outIdx >= maxOutFrames)		break;
+	}
+
+	return outIdx;
+}
@@ -0,0 +1,81 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __AUDIO_RESAMPLER_H__
+#define __AUDIO_RESAMPLER_H__
+
+#define		RESAMPLER_PHASE_BITS		9
+#define		RESAMPLER_PHASE_NUM			(1<<RESAMPLER_PHASE_BITS)	//polyphase filter banks, interpolated
+#define		RESAMPLER_BASE_TAPS			48		//taps per phase when upsampling
+#define		RESAMPLER_MAX_TAPS			256
+#define		RESAMPLER_COEF_SHIFT		14		//int16 coefficients are Q14
+#define		RESAMPLER_MAX_CHANNELS		2
+#define		RESAMPLER_CHUNK_FRAMES		1024	//input frames processed per pass
+#define		RESAMPLER_MAX_DRIFT			0.05	//+-5%
+
+typedef enum __RESAMPLE_FORMAT
+{
+	RESAMPLE_FORMAT_S16		=	0x00,		//interleaved int16
+	RESAMPLE_FORMAT_FLT		=	0x01		//interleaved float, -1.0 ~ 1.0
+}RESAMPLE_FORMAT;
+
+//Dot product kernels, n must be a multiple of 16. AVX2 when _VS_UseAvx2() finds it at run time
+//(it is compiled into /arch:SSE2 builds too), otherwise SSE2 or NEON, then scalar
+int		RS_DotS16(const short *x, const short *c, int n);
+float	RS_DotF32(const float *x, const float *c, int n);
+
+//Windowed-sinc polyphase resampler, keeps its history across packets
+//Output between two filter phases is linearly interpolated
+class CAudioResampler
+{
+public:
+	CAudioResampler(void);
+	~CAudioResampler(void);
+
+	int		Init(unsigned int inRate, unsigned int outRate, unsigned int channels, RESAMPLE_FORMAT format=RESAMPLE_FORMAT_S16);
+	void	Deinit();
+	void	Reset();
+
+	//returns the number of output frames written, or -1
+	int		Process(const short *pIn, int inFrames, short *pOut, int maxOutFrames);
+	int		Process(const float *pIn, int inFrames, float *pOut, int maxOutFrames);
+
+	//playout rate nudge for A/V sync: 1.0 nominal, >1.0 consumes input faster (less output)
+	int		SetDrift(double ratio);
+	double	GetDrift()		{return drift;}
+
+	int		GetMaxOutFrames(int inFrames);
+	int		GetTaps()		{return taps;}
+
+	unsigned int	GetInRate()		{return inRate;}
+	unsigned int	GetOutRate()	{return outRate;}
+	unsigned int	GetChannels()	{return channels;}
+
+protected:
+	void	BuildFilter();
+	int		Run(int maxOutFrames, short *pOutS16, float *pOutF32, int outIdx);
+
+	unsigned int	inRate;
+	unsigned int	outRate;
+	unsigned int	channels;
+	RESAMPLE_FORMAT	format;
+	double			drift;
+
+	int				taps;			//multiple of 16
+	short			*pCoefS16;		//[RESAMPLER_PHASE_NUM+1][taps]
+	float			*pCoefF32;
+
+	unsigned long long	step;		//Q32 input frames per output frame
+	unsigned long long	pos;		//Q32 position in the history
+
+	//planar history, taps-1 frames of context + one chunk
+	void			*pHistory[RESAMPLER_MAX_CHANNELS];
+	int				histFrames;		//valid frames
+	int				histSize;
+};
+
+#endif
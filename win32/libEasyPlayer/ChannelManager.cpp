@@ -8,7 +8,9 @@
 #include "ChannelManager.h"
 #include <time.h>
 #include "vstime.h"
+#include "vstrace.h"
 #include "trace.h"
+#include "VideoConverter.h"
 
 
 #define		CHANNEL_ID_GAIN			1000
@@ -23,6 +25,11 @@ CChannelManager::CChannelManager(void)
 {
 	pRealtimePlayThread	=	NULL;
 	pAudioPlayThread	=	NULL;
+	pCompositorThread	=	NULL;
+	pThumbnail			=	NULL;
+	pSnapshot			=	NULL;
+	pStreamRecorder		=	NULL;
+	pStreamReplayer		=	NULL;
 	memset(&d3dAdapter, 0x00, sizeof(D3D_ADAPTER_T));
 
 	InitializeCriticalSection(&crit);
@@ -49,6 +56,7 @@ int	CChannelManager::Initial()
 			InitializeCriticalSection(&pRealtimePlayThread[i].crit);
 			pRealtimePlayThread[i].renderFormat = GDI_FORMAT_RGB24;		//ĬΪGDIʾ
 			pRealtimePlayThread[i].channelId = i+1;
+			pRealtimePlayThread[i].compositorTile = -1;
 		}
 	}
 
@@ -68,6 +76,8 @@ void CChannelManager::Release()
 				EasyRTSP_CloseStream(pRealtimePlayThread[i].nvsHandle);
 				EasyRTSP_Deinit(&pRealtimePlayThread[i].nvsHandle);
 			}
+			if (NULL != pStreamReplayer)		pStreamReplayer->Stop(i);
+			pRealtimePlayThread[i].replay = 0;
 
 			ClosePlayThread(&pRealtimePlayThread[i]);
 			DeleteCriticalSection(&pRealtimePlayThread[i].crit);
@@ -77,15 +87,39 @@ void CChannelManager::Release()
 	//Ƶ߳
 	if (NULL != pAudioPlayThread)
 	{
-		if (NULL != pAudioPlayThread->pSoundPlayer)
-		{
-			pAudioPlayThread->pSoundPlayer->Close();
-			delete pAudioPlayThread->pSoundPlayer;
-			pAudioPlayThread->pSoundPlayer = NULL;
-		}
+		CloseAudioOutput();
 		delete pAudioPlayThread;
 		pAudioPlayThread = NULL;
 	}
+	//ٺϳʾ߳, ̶߳ѹر, ͨд뻭
+	if (NULL != pCompositorThread)
+	{
+		CloseCompositor();
+		if (NULL != pCompositorThread->pCompositor)		delete pCompositorThread->pCompositor;
+		delete pCompositorThread;
+		pCompositorThread = NULL;
+	}
+	if (NULL != pThumbnail)
+	{
+		delete pThumbnail;
+		pThumbnail = NULL;
+	}
+	if (NULL != pSnapshot)
+	{
+		delete pSnapshot;
+		pSnapshot = NULL;
+	}
+	//ط̶ֹ߳ͣ, ProcessData
+	if (NULL != pStreamReplayer)
+	{
+		delete pStreamReplayer;
+		pStreamReplayer = NULL;
+	}
+	if (NULL != pStreamRecorder)
+	{
+		delete pStreamRecorder;
+		pStreamRecorder = NULL;
+	}
 }
 
 
@@ -100,7 +134,7 @@ int	CChannelManager::OpenStream(const char *url, HWND hWnd, RENDER_FORMAT render
 	{
 		for (int i=0; i<MAX_CHANNEL_NUM; i++)
 		{
-			if (NULL == pRealtimePlayThread[i].nvsHandle)
+			if (NULL == pRealtimePlayThread[i].nvsHandle && !pRealtimePlayThread[i].replay)
 			{
 				iNvsIdx = i;
 				break;
@@ -120,6 +154,8 @@ int	CChannelManager::OpenStream(const char *url, HWND hWnd, RENDER_FORMAT render
 		pRealtimePlayThread[iNvsIdx].pUserPtr = userPtr;
 
 		pRealtimePlayThread[iNvsIdx].hWnd = hWnd;
+		strncpy(pRealtimePlayThread[iNvsIdx].thumbnailKey, url, VTHUMB_MAX_KEY-1);
+		pRealtimePlayThread[iNvsIdx].thumbnailKey[VTHUMB_MAX_KEY-1] = '\0';
 		pRealtimePlayThread[iNvsIdx].renderFormat = (D3D_SUPPORT_FORMAT)renderFormat;
 		CreatePlayThread(&pRealtimePlayThread[iNvsIdx]);
 
@@ -139,11 +175,23 @@ void CChannelManager::CloseStream(int channelId)
 
 	EnterCriticalSection(&crit);
 
-	//رrtsp client
-	EasyRTSP_CloseStream(pRealtimePlayThread[iNvsIdx].nvsHandle);
-	EasyRTSP_Deinit(&pRealtimePlayThread[iNvsIdx].nvsHandle);
+	if (pRealtimePlayThread[iNvsIdx].replay)
+	{
+		//طͨ: ֹͣط߳, ֮ProcessData
+		if (NULL != pStreamReplayer)		pStreamReplayer->Stop(iNvsIdx);
+		pRealtimePlayThread[iNvsIdx].replay = 0;
+	}
+	else
+	{
+		//رrtsp client
+		EasyRTSP_CloseStream(pRealtimePlayThread[iNvsIdx].nvsHandle);
+		EasyRTSP_Deinit(&pRealtimePlayThread[iNvsIdx].nvsHandle);
+	}
+	if (NULL != pStreamRecorder)		pStreamRecorder->Stop(iNvsIdx);
 	//رղ߳
 	ClosePlayThread(&pRealtimePlayThread[iNvsIdx]);
+	//ûȡץͼ֡
+	if (NULL != pSnapshot)		pSnapshot->Cancel(iNvsIdx);
 
 	LeaveCriticalSection(&crit);
 }
@@ -283,62 +331,195 @@ int		CChannelManager::ResetDragPoint(int channelId)
 }
 
 //		2014.12.01
+//ͨ, ·ͬʱ
 int	CChannelManager::PlaySound(int channelId)
 {
-	int ret = -1;
+	int iNvsIdx = channelId - CHANNEL_ID_GAIN + 1;
+	if (iNvsIdx < 1 || iNvsIdx > MAX_CHANNEL_NUM)		return -1;
+
+	EnterCriticalSection(&crit);
 	if (NULL == pAudioPlayThread)
 	{
 		pAudioPlayThread = new AUDIO_PLAY_THREAD_OBJ;
-		if (NULL == pAudioPlayThread)		return ret;
-		memset(pAudioPlayThread, 0x00, sizeof(AUDIO_PLAY_THREAD_OBJ));
+		if (NULL != pAudioPlayThread)	memset(pAudioPlayThread, 0x00, sizeof(AUDIO_PLAY_THREAD_OBJ));
+	}
+	int ret = OpenAudioOutput();
+	if (ret == 0)
+	{
+		ret = pAudioPlayThread->pAudioMixer->AddInput(iNvsIdx);
+	}
+	if (ret == 0)
+	{
+		//ԭһֻѡеͨ; ͨڻо, SetSoundMute(channelId, 0)һ
+		for (int i=1; i<=MAX_CHANNEL_NUM; i++)
+		{
+			if (i != iNvsIdx && pAudioPlayThread->pAudioMixer->IsInput(i))		pAudioPlayThread->pAudioMixer->SetMute(i, 1);
+		}
+		pAudioPlayThread->pAudioMixer->SetMute(iNvsIdx, 0);
 	}
+	LeaveCriticalSection(&crit);
 
-	ClearAllSoundData();		//ǰڲƵ,
+	return ret;
+}
+int	CChannelManager::StopSound()
+{
+	EnterCriticalSection(&crit);
+	if (NULL != pAudioPlayThread && NULL != pAudioPlayThread->pAudioMixer)
+	{
+		for (int i=1; i<=MAX_CHANNEL_NUM; i++)
+		{
+			pAudioPlayThread->pAudioMixer->RemoveInput(i);
+		}
+	}
+	LeaveCriticalSection(&crit);
+	return 0;
+}
+int	CChannelManager::StopSound(int channelId)
+{
+	int iNvsIdx = channelId - CHANNEL_ID_GAIN + 1;
+	int ret = 0;
 
+	EnterCriticalSection(&crit);		//PlaySound/CloseAudioOutput replace the mixer
+	if (NULL != pAudioPlayThread && NULL != pAudioPlayThread->pAudioMixer)
+	{
+		ret = pAudioPlayThread->pAudioMixer->RemoveInput(iNvsIdx);
+	}
+	LeaveCriticalSection(&crit);
 
+	return ret;
+}
+int	CChannelManager::SetSoundVolume(int channelId, float volume)
+{
 	int iNvsIdx = channelId - CHANNEL_ID_GAIN + 1;
+	int ret = -1;
 
-	if (pAudioPlayThread->channelId != iNvsIdx)
+	EnterCriticalSection(&crit);		//PlaySound/CloseAudioOutput replace the mixer
+	if (NULL != pAudioPlayThread && NULL != pAudioPlayThread->pAudioMixer)
 	{
-		pAudioPlayThread->channelId = iNvsIdx;//channelId;
-	
-		if (NULL != pAudioPlayThread->pSoundPlayer)
-		{
-			pAudioPlayThread->pSoundPlayer->Close();
-		}
-
-		pAudioPlayThread->audiochannels	=	0;
-		pAudioPlayThread->samplerate	=	0;
-		pAudioPlayThread->bitpersample	=	0;
-		ret = 0;
+		ret = pAudioPlayThread->pAudioMixer->SetVolume(iNvsIdx, volume);
 	}
+	LeaveCriticalSection(&crit);
 
 	return ret;
 }
-int	CChannelManager::StopSound()
+int	CChannelManager::SetSoundMute(int channelId, int mute)
 {
-	if (NULL == pAudioPlayThread)		return 0;
+	int iNvsIdx = channelId - CHANNEL_ID_GAIN + 1;
+	int ret = -1;
 
-	if (NULL != pAudioPlayThread->pSoundPlayer)
+	EnterCriticalSection(&crit);		//PlaySound/CloseAudioOutput replace the mixer
+	if (NULL != pAudioPlayThread && NULL != pAudioPlayThread->pAudioMixer)
 	{
-		pAudioPlayThread->pSoundPlayer->Close();
+		ret = pAudioPlayThread->pAudioMixer->SetMute(iNvsIdx, mute);
 	}
-	pAudioPlayThread->audiochannels  = 0;
-	pAudioPlayThread->channelId = -1;
-	return 0;
+	LeaveCriticalSection(&crit);
+
+	return ret;
 }
-void CChannelManager::ClearAllSoundData()
+
+//·Ƶϳɵһ
+//ͨ֡תֱӻԼķֿ, һ̰߳ˢύhWnd
+int	CChannelManager::SetCompositor(HWND hWnd, int tiles)
 {
-	if (NULL != pChannelManager)
+	if (NULL == pRealtimePlayThread)			return -1;
+	if (NULL != hWnd && (tiles < 1 || tiles > VCOMP_MAX_TILES))		return -1;
+
+	EnterCriticalSection(&crit);
+	if (NULL == pCompositorThread)
 	{
-		if (NULL != pChannelManager->pAudioPlayThread)
+		pCompositorThread = new COMPOSITOR_THREAD_OBJ;
+		if (NULL != pCompositorThread)	memset(pCompositorThread, 0x00, sizeof(COMPOSITOR_THREAD_OBJ));
+	}
+	int ret = -1;
+	if (NULL != pCompositorThread)
+	{
+		CloseCompositor();
+		if (NULL != hWnd)
 		{
-			if (NULL != pChannelManager->pAudioPlayThread->pSoundPlayer)
+			ret = OpenCompositor(hWnd, tiles);
+		}
+		else
+		{
+			for (int i=0; i<MAX_CHANNEL_NUM; i++)
 			{
-				pChannelManager->pAudioPlayThread->pSoundPlayer->Clear();
+				if (pRealtimePlayThread[i].compositorTile < 0)		continue;
+				pRealtimePlayThread[i].compositorTile = -1;
+				pRealtimePlayThread[i].resetD3d = true;
 			}
+			ret = 0;
 		}
 	}
+	LeaveCriticalSection(&crit);
+
+	return ret;
+}
+int	CChannelManager::SetChannelTile(int channelId, int tile)
+{
+	if (NULL == pRealtimePlayThread)			return -1;
+
+	int iNvsIdx = channelId - CHANNEL_ID_GAIN;
+	if (iNvsIdx < 0 || iNvsIdx>= MAX_CHANNEL_NUM)	return -1;
+	if (tile < 0)	tile = -1;
+
+	EnterCriticalSection(&crit);
+	int ret = -1;
+	CVideoCompositor *pCompositor = (NULL != pCompositorThread) ? pCompositorThread->pCompositor : NULL;
+	if (tile < 0 || (NULL != pCompositor && pCompositorThread->presentThread.flag != 0x00 && tile < pCompositor->GetTiles()))
+	{
+		int oldTile = pRealtimePlayThread[iNvsIdx].compositorTile;
+		pRealtimePlayThread[iNvsIdx].compositorTile = tile;
+		pRealtimePlayThread[iNvsIdx].resetD3d = true;		//ͷŻؽͨԼd3dRender
+		if (oldTile >= 0 && oldTile != tile && NULL != pCompositor)		pCompositor->ClearTile(oldTile);
+		ret = 0;
+	}
+	LeaveCriticalSection(&crit);
+
+	return ret;
+}
+
+int	CChannelManager::StartThumbnail(int width, int height, int interval, int entries, const char *cacheDir)
+{
+	EnterCriticalSection(&crit);
+	if (NULL == pThumbnail)		pThumbnail = new CVideoThumbnail();
+	int ret = (NULL != pThumbnail) ? pThumbnail->Init(width, height, interval, entries, cacheDir, THUMBNAIL_WORKERS) : -1;
+	LeaveCriticalSection(&crit);
+
+	return ret;
+}
+int	CChannelManager::StopThumbnail()
+{
+	EnterCriticalSection(&crit);
+	if (NULL != pThumbnail)		pThumbnail->Deinit();
+	LeaveCriticalSection(&crit);
+
+	return 0;
+}
+int	CChannelManager::GetThumbnail(const char *url, unsigned char *buf, int bufSize, unsigned int *sequence)
+{
+	if (NULL == pThumbnail)		return -1;
+
+	return pThumbnail->Get(url, buf, bufSize, sequence);
+}
+
+int	CChannelManager::Snapshot(int channelId, const char *path, SNAPSHOT_FORMAT format, int count, int interval, SnapshotCallBack callback, void *userPtr)
+{
+	if (NULL == pRealtimePlayThread)			return -1;
+
+	int iNvsIdx = channelId - CHANNEL_ID_GAIN;
+	if (iNvsIdx < 0 || iNvsIdx>= MAX_CHANNEL_NUM)	return -1;
+	if (NULL == pRealtimePlayThread[iNvsIdx].nvsHandle && !pRealtimePlayThread[iNvsIdx].replay)	return -1;
+
+	//̵߳һץͼʱ, ֮ٽcrit, OpenStreamcritʱҲȴ
+	if (NULL == pSnapshot || !pSnapshot->IsRunning())
+	{
+		EnterCriticalSection(&crit);
+		if (NULL == pSnapshot)		pSnapshot = new CVideoSnapshot();
+		if (NULL != pSnapshot && !pSnapshot->IsRunning())		pSnapshot->Init(SNAPSHOT_WORKERS);
+		LeaveCriticalSection(&crit);
+		if (NULL == pSnapshot)		return -1;
+	}
+
+	return pSnapshot->Request(iNvsIdx, channelId, path, format, count, interval, (VSNAP_CALLBACK)callback, userPtr);
 }
 
 void CChannelManager::CreatePlayThread(PLAY_THREAD_OBJ	*_pPlayThread)
@@ -427,112 +608,310 @@ void CChannelManager::ClosePlayThread(PLAY_THREAD_OBJ	*_pPlayThread)
 	memset(&_pPlayThread->decodeThread, 0x00, sizeof(THREAD_OBJ));
 	memset(&_pPlayThread->displayThread, 0x00, sizeof(THREAD_OBJ));
 	_pPlayThread->hWnd	=	NULL;
+
+	if (_pPlayThread->compositorTile >= 0 && NULL != pCompositorThread && NULL != pCompositorThread->pCompositor)
+	{
+		pCompositorThread->pCompositor->ClearTile(_pPlayThread->compositorTile);
+	}
+	_pPlayThread->compositorTile = -1;
 }
 
 
 
-int	CChannelManager::SetAudioParams(unsigned int _channel, unsigned int _samplerate, unsigned int _bitpersample)
+//򿪻豸, ʽ̶, лͨʱ´豸
+int	CChannelManager::OpenAudioOutput()
 {
 	if (NULL == pAudioPlayThread)		return -1;
+	if (pAudioPlayThread->mixThread.flag != 0x00)		return 0;
+
+	pAudioPlayThread->samplerate	=	AUDIO_MIX_SAMPLERATE;
+	pAudioPlayThread->audiochannels	=	AUDIO_MIX_CHANNELS;
+	pAudioPlayThread->bitpersample	=	16;
 
 	WAVEFORMATEX wfx = {0,};
 	wfx.cbSize = sizeof(WAVEFORMATEX);
 	wfx.wFormatTag = WAVE_FORMAT_PCM;
-	wfx.nSamplesPerSec = _samplerate;
-	wfx.wBitsPerSample = _bitpersample;
-	wfx.nChannels = _channel;
-	wfx.nBlockAlign =  wfx.nChannels * ( wfx.wBitsPerSample / 8 );//(wfx.wBitsPerSample*wfx.nChannels)>>3; //wfx.nChannels * ( wfx.wBitsPerSample / 8 );
-	wfx.nAvgBytesPerSec = wfx.nBlockAlign * wfx.nSamplesPerSec;
-
+	wfx.nSamplesPerSec = pAudioPlayThread->samplerate;
+	wfx.wBitsPerSample = pAudioPlayThread->bitpersample;
+	wfx.nChannels = pAudioPlayThread->audiochannels;
 	wfx.nAvgBytesPerSec	= wfx.nSamplesPerSec * wfx.nChannels * wfx.wBitsPerSample / 8;
 	wfx.nBlockAlign		= wfx.nChannels * wfx.wBitsPerSample / 8;
 
+	if (NULL == pAudioPlayThread->pAudioMixer)
+	{
+		pAudioPlayThread->pAudioMixer = new CAudioMixer();
+		if (NULL == pAudioPlayThread->pAudioMixer)		return -1;
+	}
+	if (0 != pAudioPlayThread->pAudioMixer->Open(wfx.nSamplesPerSec, wfx.nChannels))	return -1;
+
 	if (NULL == pAudioPlayThread->pSoundPlayer)
 	{
 		pAudioPlayThread->pSoundPlayer = new CSoundPlayer();
+		if (NULL == pAudioPlayThread->pSoundPlayer)		return -1;
 	}
-	if (NULL != pAudioPlayThread->pSoundPlayer)
+	pAudioPlayThread->pSoundPlayer->Close();
+	if (0 != pAudioPlayThread->pSoundPlayer->Open(wfx))
 	{
-		pAudioPlayThread->pSoundPlayer->Close();
-		pAudioPlayThread->pSoundPlayer->Open(wfx);
+		_TRACE("Ƶ豸ʧ.\n");
+		return -1;
+	}
+
+	pAudioPlayThread->mixThread.flag = 0x01;
+	pAudioPlayThread->mixThread.hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)_lpAudioMixThread, pAudioPlayThread, 0, NULL);
+	while (pAudioPlayThread->mixThread.flag!=0x02 && pAudioPlayThread->mixThread.flag!=0x00)	{Sleep(100);}
+	if (NULL != pAudioPlayThread->mixThread.hThread)
+	{
+		SetThreadPriority(pAudioPlayThread->mixThread.hThread, THREAD_PRIORITY_HIGHEST);
 	}
-	pAudioPlayThread->audiochannels	=	_channel;
+
 	return 0;
 }
-
-void ParseDecoder2Render(int *_decoder, int _width, int _height, int renderFormat, int *yuvsize)
+void CChannelManager::CloseAudioOutput()
 {
-	if (NULL == _decoder)		return;
-	int nDecoder = 0x00;
-	int nYUVSize = 0x00;
-	if (renderFormat == D3D_FORMAT_UYVY)
+	if (NULL == pAudioPlayThread)		return;
+
+	if (pAudioPlayThread->mixThread.flag != 0x00)
 	{
-		nDecoder	=	17;	//PIX_FMT_UYVY422
-		nYUVSize	=	_width*_height*2+1;
+		pAudioPlayThread->mixThread.flag = 0x03;
+		while (pAudioPlayThread->mixThread.flag!=0x00)	{Sleep(100);}
 	}
-	else if (renderFormat == D3D_FORMAT_YV12)
+	if (NULL != pAudioPlayThread->mixThread.hThread)
 	{
-		nDecoder	=	0;//OUTPUT_PIX_FMT_YUV420P;
-		nYUVSize	=	_width*_height*3/2+1;
+		CloseHandle(pAudioPlayThread->mixThread.hThread);
+		pAudioPlayThread->mixThread.hThread = NULL;
 	}
-	else if (renderFormat == D3D_FORMAT_YUY2)
+	if (NULL != pAudioPlayThread->pSoundPlayer)
 	{
-		nDecoder	=	1;//OUTPUT_PIX_FMT_YUV422;
-		nYUVSize	=	_width*_height*2+1;
+		pAudioPlayThread->pSoundPlayer->Close();
+		delete pAudioPlayThread->pSoundPlayer;
+		pAudioPlayThread->pSoundPlayer = NULL;
 	}
-	else if (renderFormat == D3D_FORMAT_RGB565)				//23 ok
+	if (NULL != pAudioPlayThread->pAudioMixer)
 	{
-		nDecoder	=	44;
-		nYUVSize	=	_width*_height*2+1;
+		pAudioPlayThread->pAudioMixer->Close();
+		delete pAudioPlayThread->pAudioMixer;
+		pAudioPlayThread->pAudioMixer = NULL;
 	}
-	else if (renderFormat == D3D_FORMAT_RGB555)				//23 ok
+}
+
+//߳: ̶ڴӻȡд豸
+LPTHREAD_START_ROUTINE CChannelManager::_lpAudioMixThread( LPVOID _pParam )
+{
+	AUDIO_PLAY_THREAD_OBJ *pThread = (AUDIO_PLAY_THREAD_OBJ*)_pParam;
+	if (NULL == pThread)			return 0;
+
+	int frames = pThread->samplerate * AUDIO_MIX_PERIOD / 1000;
+	int bufsize = frames * pThread->audiochannels * sizeof(short);
+	short *pMixBuf = new short[frames * pThread->audiochannels];
+	if (NULL == pMixBuf)
+	{
+		pThread->mixThread.flag = 0x00;
+		return 0;
+	}
+
+	unsigned long long ullPeriod = 1000000ULL * AUDIO_MIX_PERIOD;
+	unsigned long long ullNextTime = _VS_GetNs();
+
+	pThread->mixThread.flag = 0x02;
+
+	_VS_BEGIN_TIME_PERIOD(1);
+	while (1)
 	{
-		nDecoder	=	46;
-		nYUVSize	=	_width*_height*2+1;
+		if (pThread->mixThread.flag == 0x03)		break;
+
+		//л, Ҫ
+		_VS_SleepUntilNs(ullNextTime, 0);
+		ullNextTime += ullPeriod;
+		unsigned long long ullNow = _VS_GetNs();
+		if (ullNow > ullNextTime && ullNow - ullNextTime > 500000000ULL)
+		{
+			ullNextTime = ullNow + ullPeriod;		//̫(ϵͳ), ¼ʱ
+		}
+
+		if (pThread->pAudioMixer->Mix(pMixBuf, frames) > 0)
+		{
+			pThread->pSoundPlayer->Write((char *)pMixBuf, bufsize);
+		}
 	}
-	else if (renderFormat == D3D_FORMAT_X8R8G8B8)
+	_VS_END_TIME_PERIOD(1);
+
+	delete []pMixBuf;
+	pThread->mixThread.flag = 0x00;
+
+	return 0;
+}
+
+//򿪺ϳʾ߳, , ٴδʱֻ²
+int	CChannelManager::OpenCompositor(HWND hWnd, int tiles)
+{
+	if (NULL == pCompositorThread)		return -1;
+	if (pCompositorThread->presentThread.flag != 0x00)		return 0;
+
+	if (NULL == pCompositorThread->pCompositor)
 	{
-		nDecoder	=	30;
-		nYUVSize	=	_width*_height*4+1;
+		pCompositorThread->pCompositor = new CVideoCompositor();
+		if (NULL == pCompositorThread->pCompositor)		return -1;
+		pCompositorThread->pCompositor->Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
 	}
-	else if (renderFormat == D3D_FORMAT_A8R8G8B8)			//21 ok
+	RECT rcWnd;
+	if (GetClientRect(hWnd, &rcWnd))
 	{
-		nDecoder	=	30;
-		nYUVSize	=	_width*_height*4+1;
+		pCompositorThread->pCompositor->Resize(rcWnd.right-rcWnd.left, rcWnd.bottom-rcWnd.top);
 	}
-	else if (renderFormat == (D3D_SUPPORT_FORMAT)22)		//22	ok
+	if (0 != pCompositorThread->pCompositor->SetLayout(tiles))		return -1;
+
+	pCompositorThread->hWnd = hWnd;
+	pCompositorThread->presentThread.flag = 0x01;
+	pCompositorThread->presentThread.hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)_lpCompositorThread, pCompositorThread, 0, NULL);
+	while (pCompositorThread->presentThread.flag!=0x02 && pCompositorThread->presentThread.flag!=0x00)	{Sleep(100);}
+	if (NULL != pCompositorThread->presentThread.hThread)
 	{
-		nDecoder	=	28;
-		nYUVSize	=	_width*_height*4+1;
+		SetThreadPriority(pCompositorThread->presentThread.hThread, THREAD_PRIORITY_HIGHEST);
 	}
-	else if (renderFormat == (D3D_SUPPORT_FORMAT)1498831189)
+
+	return 0;
+}
+void CChannelManager::CloseCompositor()
+{
+	if (NULL == pCompositorThread)		return;
+
+	if (pCompositorThread->presentThread.flag != 0x00)
 	{
-		nDecoder	=	17;
-		nYUVSize	=	_width*_height*4+1;
+		pCompositorThread->presentThread.flag = 0x03;
+		while (pCompositorThread->presentThread.flag!=0x00)	{Sleep(100);}
 	}
-	else if (renderFormat == (D3D_SUPPORT_FORMAT)36)
+	if (NULL != pCompositorThread->presentThread.hThread)
 	{
-		nDecoder	=	32;
-		nYUVSize	=	_width*_height*4+1;
+		CloseHandle(pCompositorThread->presentThread.hThread);
+		pCompositorThread->presentThread.hThread = NULL;
 	}
-	else if (renderFormat == (D3D_SUPPORT_FORMAT)20)
+	pCompositorThread->hWnd = NULL;
+}
+
+//һ϶µ32λDIB, ÿֻrectڵнGDI
+static void __PresentToDC(void *userPtr, const unsigned char *pCanvas, int stride, const VCOMP_RECT_T *rect)
+{
+	BITMAPINFO bmi;
+	memset(&bmi, 0x00, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize		=	sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth		=	stride / 4;
+	bmi.bmiHeader.biHeight		=	-rect->height;
+	bmi.bmiHeader.biPlanes		=	1;
+	bmi.bmiHeader.biBitCount	=	32;
+	bmi.bmiHeader.biCompression	=	BI_RGB;
+
+	SetDIBitsToDevice((HDC)userPtr, rect->x, rect->y, rect->width, rect->height, rect->x, 0, 0, rect->height,
+						pCanvas + (size_t)rect->y * stride, &bmi, DIB_RGB_COLORS);
+}
+
+//ϳʾ߳: ÿˢύһ, û֡ķֿ鲻ٻ
+LPTHREAD_START_ROUTINE CChannelManager::_lpCompositorThread( LPVOID _pParam )
+{
+	COMPOSITOR_THREAD_OBJ *pThread = (COMPOSITOR_THREAD_OBJ*)_pParam;
+	if (NULL == pThread)			return 0;
+
+	int refresh = 0;
+	HDC hDC = GetDC(pThread->hWnd);
+	if (NULL != hDC)
 	{
-		nDecoder	=	3;
-		nYUVSize	=	_width*_height*3+1;
+		refresh = GetDeviceCaps(hDC, VREFRESH);
+		ReleaseDC(pThread->hWnd, hDC);
 	}
-	else if (renderFormat == GDI_FORMAT_RGB24)
+	if (refresh <= 1)	refresh = COMPOSITOR_REFRESH;		//01ʾӲĬֵ
+
+	unsigned long long ullPeriod = 1000000000ULL / refresh;
+	unsigned long long ullNextTime = _VS_GetNs();
+
+	pThread->presentThread.flag = 0x02;
+
+	_VS_BEGIN_TIME_PERIOD(1);
+	while (1)
 	{
-		nDecoder	=	3;
-		nYUVSize	=	_width*_height*3+1;
+		if (pThread->presentThread.flag == 0x03)		break;
+
+		_VS_SleepUntilNs(ullNextTime);
+		ullNextTime += ullPeriod;
+		unsigned long long ullNow = _VS_GetNs();
+		if (ullNow > ullNextTime && ullNow - ullNextTime > 500000000ULL)
+		{
+			ullNextTime = ullNow + ullPeriod;
+		}
+
+		if (!IsWindow(pThread->hWnd) || !IsWindowVisible(pThread->hWnd))		continue;
+
+		//ڴС仯ʱؽ, ύ
+		RECT rcWnd;
+		if (GetClientRect(pThread->hWnd, &rcWnd) &&
+			(rcWnd.right-rcWnd.left != pThread->pCompositor->GetWidth() || rcWnd.bottom-rcWnd.top != pThread->pCompositor->GetHeight()))
+		{
+			pThread->pCompositor->Resize(rcWnd.right-rcWnd.left, rcWnd.bottom-rcWnd.top);
+		}
+		else if (GetUpdateRect(pThread->hWnd, NULL, FALSE))
+		{
+			pThread->pCompositor->Invalidate();		//ڱڵػ, ԭʧЧ
+		}
+
+		hDC = GetDC(pThread->hWnd);
+		if (NULL == hDC)		continue;
+		pThread->pCompositor->Present(__PresentToDC, hDC);
+		ReleaseDC(pThread->hWnd, hDC);
 	}
-	else
+	_VS_END_TIME_PERIOD(1);
+
+	pThread->presentThread.flag = 0x00;
+
+	return 0;
+}
+
+//the decoder always outputs YUV420P, the decode thread converts it to what the renderer takes
+VC_FORMAT ParseRenderFormat(int renderFormat, int _width, int _height, int *yuvsize)
+{
+	VC_FORMAT format = VC_FORMAT_BGRA;
+	if (renderFormat == D3D_FORMAT_YV12)						format = VC_FORMAT_YUV420P;
+	else if (renderFormat == D3D_FORMAT_UYVY)					format = VC_FORMAT_UYVY;
+	else if (renderFormat == D3D_FORMAT_YUY2)					format = VC_FORMAT_YUY2;
+	else if (renderFormat == D3D_FORMAT_RGB565)					format = VC_FORMAT_RGB565;
+	else if (renderFormat == D3D_FORMAT_RGB555)					format = VC_FORMAT_RGB555;
+	else if (renderFormat == GDI_FORMAT_RGB24 || renderFormat == (D3D_SUPPORT_FORMAT)20)	format = VC_FORMAT_BGR24;
+
+	if (NULL != yuvsize)	*yuvsize = VC_FrameSize(format, _width, _height) + 1;
+	return format;
+}
+
+//size to convert a frame, or the SetRenderRect window of it, to: the client area when that is smaller,
+//so a tile in a split layout never gets more pixels than it shows
+void GetRenderSize(PLAY_THREAD_OBJ *_pPlayThread, int _width, int _height, int *outWidth, int *outHeight)
+{
+	*outWidth	=	_width;
+	*outHeight	=	_height;
+
+	RECT rcWnd;
+	if (NULL == _pPlayThread->hWnd || !GetClientRect(_pPlayThread->hWnd, &rcWnd))		return;
+
+	int w = rcWnd.right - rcWnd.left;
+	int h = rcWnd.bottom - rcWnd.top;
+	if (_pPlayThread->ShownToScale)
 	{
-		nDecoder	=	28;
-		nYUVSize	=	_width*_height*4+1;
+		if (w * _height > h * _width)	w = h * _width / _height;
+		else							h = w * _height / _width;
 	}
+	w &= ~1;		//whole chroma samples
+	h &= ~1;
+	if (w < 16 || h < 16 || w >= _width || h >= _height)		return;
 
-	if (NULL != _decoder)	*_decoder = nDecoder;
-	if (NULL != yuvsize)	*yuvsize  = nYUVSize;
+	*outWidth	=	w;
+	*outHeight	=	h;
+}
+
+//the SetRenderRect window clipped to the frame, see VC_RenderRoi; a rect outside the frame is
+//left to the renderer as before
+int GetRenderRoi(const RECT *_rcRender, int _width, int _height, RECT *_rcRoi)
+{
+	int roi[4];
+	if (! VC_RenderRoi(_rcRender->left, _rcRender->top, _rcRender->right, _rcRender->bottom, _width, _height, roi))		return 0;
+
+	SetRect(_rcRoi, roi[0], roi[1], roi[2], roi[3]);
+	return 1;
 }
 
 DECODER_OBJ	*GetDecoder(PLAY_THREAD_OBJ	*_pPlayThread, unsigned int mediaType, MEDIA_FRAME_INFO *_frameinfo)
@@ -563,20 +942,7 @@ DECODER_OBJ	*GetDecoder(PLAY_THREAD_OBJ	*_pPlayThread, unsigned int mediaType, M
 				{
 					iExist = i;
 					int nDecoder = OUTPUT_PIX_FMT_YUV420P;
-					//ParseDecoder2Render(&nDecoder, _frameinfo->width, _frameinfo->height, _pPlayThread->renderFormat, &_pPlayThread->decoderObj[i].yuv_size);
-
-					if (_pPlayThread->renderFormat == GDI_FORMAT_RGB24)
-					{
-						ParseDecoder2Render(&nDecoder, _frameinfo->width, _frameinfo->height, _pPlayThread->renderFormat, &_pPlayThread->decoderObj[i].yuv_size);
-					}
-					else
-					{
-#ifdef __ENABLE_SSE
-						ParseDecoder2Render(&nDecoder, _frameinfo->width, _frameinfo->height, DISPLAY_FORMAT_YV12, &_pPlayThread->decoderObj[i].yuv_size);
-#else
-						ParseDecoder2Render(&nDecoder, _frameinfo->width, _frameinfo->height, _pPlayThread->renderFormat, &_pPlayThread->decoderObj[i].yuv_size);
-#endif
-					}
+					ParseRenderFormat(_pPlayThread->renderFormat, _frameinfo->width, _frameinfo->height, &_pPlayThread->decoderObj[i].yuv_size);
 
 					FFD_Init(&_pPlayThread->decoderObj[i].ffDecoder);
 					FFD_SetVideoDecoderParam(_pPlayThread->decoderObj[i].ffDecoder, _frameinfo->width, _frameinfo->height, _frameinfo->codec, nDecoder);
@@ -589,18 +955,7 @@ DECODER_OBJ	*GetDecoder(PLAY_THREAD_OBJ	*_pPlayThread, unsigned int mediaType, M
 				if (NULL == _pPlayThread->decoderObj[iIdx].ffDecoder)
 				{
 					int nDecoder = OUTPUT_PIX_FMT_YUV420P;
-					if (_pPlayThread->renderFormat == GDI_FORMAT_RGB24)
-					{
-						ParseDecoder2Render(&nDecoder, _frameinfo->width, _frameinfo->height, _pPlayThread->renderFormat, &_pPlayThread->decoderObj[iIdx].yuv_size);
-					}
-					else
-					{
-#ifdef __ENABLE_SSE
-						ParseDecoder2Render(&nDecoder, _frameinfo->width, _frameinfo->height, DISPLAY_FORMAT_YV12, &_pPlayThread->decoderObj[iIdx].yuv_size);
-#else
-						ParseDecoder2Render(&nDecoder, _frameinfo->width, _frameinfo->height, _pPlayThread->renderFormat, &_pPlayThread->decoderObj[iIdx].yuv_size);
-#endif
-					}
+					ParseRenderFormat(_pPlayThread->renderFormat, _frameinfo->width, _frameinfo->height, &_pPlayThread->decoderObj[iIdx].yuv_size);
 
 					FFD_Init(&_pPlayThread->decoderObj[iIdx].ffDecoder);
 					FFD_SetVideoDecoderParam(_pPlayThread->decoderObj[iIdx].ffDecoder, _frameinfo->width, _frameinfo->height, _frameinfo->codec, nDecoder);
@@ -731,6 +1086,13 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDecodeThread( LPVOID _pParam )
 	unsigned char *audio_buf = new unsigned char[audbuf_len+1];
 	memset(audio_buf, 0x00, audbuf_len);
 
+	//YUV420P from the decoder, when the render format needs a conversion
+	char *pDecodeYuv = NULL;
+	int decodeYuvSize = 0;
+	CVideoConverter	vcConverter;
+	vcConverter.Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	DWORD	dwThumbnailTime = 0;		//ϴνpThumbnailʱ
+
 
     //FILE *fES = fopen("1920x1080.h264", "wb");
 
@@ -768,8 +1130,8 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDecodeThread( LPVOID _pParam )
 			//_TRACE("DECODE queue: %d\n", pChannelObj->pQueue->pQueHeader->videoframes);
 			if (pThread->frameQueue > MAX_CACHE_FRAME)
 			{
-				//_TRACE("[ch%d]֡[%d]>趨֡[%d].  նвȴһKey frame.\n", pThread->renderCh, pThread->framequeue, MAX_CACHE_FRAME);
-				_TRACE("[ch%d]֡[%d]>趨֡[%d].  նвȴһKey frame.\n", pThread->channelId, pThread->frameQueue, MAX_CACHE_FRAME);
+				//նвȴһKey frame
+				_VS_TRACE(VSTRACE_EV_QUEUE_OVERFLOW, pThread->channelId, pThread->frameQueue, MAX_CACHE_FRAME);
 
 				SSQ_Clear(pThread->pAVQueue);
 				pThread->findKeyframe = 0x01;
@@ -794,19 +1156,14 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDecodeThread( LPVOID _pParam )
 			}
 			else if (pThread->findKeyframe==0x01)
 			{
-#ifdef _DEBUG
-				//_TRACE("[ch%d]Find Keyframe..\n", pThread->renderCh);
-				_TRACE("[ch%d]Find Keyframe..\n", pThread->channelId);
-#endif
+				_VS_TRACE(VSTRACE_EV_WAIT_KEYFRAME, pThread->channelId, frameinfo.type);
 				continue;
 			}
 
 			DECODER_OBJ *pDecoderObj = GetDecoder(pThread, MEDIA_TYPE_VIDEO, &frameinfo);		//ȡӦĽ
 			if (NULL == pDecoderObj)
 			{
-#ifdef _DEBUG
-				_TRACE("[ch%d]ȡʧ.  %d x %d\n", pThread->channelId, frameinfo.width, frameinfo.height);
-#endif
+				_VS_TRACE(VSTRACE_EV_NO_DECODER, pThread->channelId, frameinfo.width, frameinfo.height);
 				_VS_BEGIN_TIME_PERIOD(1);
 				__VS_Delay(1);
 				_VS_END_TIME_PERIOD(1);
@@ -871,26 +1228,63 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDecodeThread( LPVOID _pParam )
 				MP4C_CreateMp4File(pThread->mp4cHandle, pThread->manuRecordingFile, 1024*1024*2);
 			}
 
-			if (pThread->decodeKeyFrameOnly == 0x01)
+			//ͼ: ˵Ĺؼ֡СpThumbnail; ֻΪͼ򿪵ͨ֡
+			CVideoThumbnail *pThumbnail = (NULL != pChannelManager) ? pChannelManager->pThumbnail : NULL;
+			int thumbnailDue = frameinfo.type == EASY_SDK_VIDEO_FRAME_I && NULL != pThumbnail && pThumbnail->IsRunning() &&
+								GetTickCount() - dwThumbnailTime >= (DWORD)pThumbnail->GetInterval();
+			int thumbnailOnly = pThread->decodeKeyFrameOnly == DECODE_THUMBNAIL_ONLY;
+			if (pThread->decodeKeyFrameOnly != 0x00)
 			{
 				if (frameinfo.type != EASY_SDK_VIDEO_FRAME_I)
 				{
 					pThread->findKeyframe = 0x01;
 					continue;
 				}
+				if (thumbnailOnly && !thumbnailDue)		continue;
+			}
+
+			//SetRenderRect: only that window is converted and scaled, the renderer then shows the frame whole
+			RECT rcRender, rcRoi;
+			CopyRect(&rcRender, &pThread->rcSrcRender);
+			int roi = GetRenderRoi(&rcRender, frameinfo.width, frameinfo.height, &rcRoi);
+			int srcWidth	=	roi ? rcRoi.right - rcRoi.left : frameinfo.width;
+			int srcHeight	=	roi ? rcRoi.bottom - rcRoi.top : frameinfo.height;
+
+			//a compositor tile takes the decoder's YUV420P as it is, scaling happens on the way into the canvas
+			int tile = pThread->compositorTile;
+			VC_FORMAT vcFormat = VC_FORMAT_YUV420P;
+			int outWidth = srcWidth, outHeight = srcHeight;
+			if (tile < 0)
+			{
+				vcFormat = ParseRenderFormat(pThread->renderFormat, frameinfo.width, frameinfo.height, NULL);
+				if (roi || IsRectEmpty(&rcRender))		GetRenderSize(pThread, srcWidth, srcHeight, &outWidth, &outHeight);
+			}
+
+			char *pDecodeBuf = pThread->yuvFrame[pThread->decodeYuvIdx].pYuvBuf;
+			if (roi || thumbnailOnly || vcFormat != VC_FORMAT_YUV420P || outWidth != frameinfo.width || outHeight != frameinfo.height)
+			{
+				int yuvSize = VC_FrameSize(VC_FORMAT_YUV420P, frameinfo.width, frameinfo.height) + 1;
+				if (decodeYuvSize < yuvSize)
+				{
+					__DELETE_ARRAY(pDecodeYuv);
+					pDecodeYuv = new char[yuvSize];
+					decodeYuvSize = (NULL != pDecodeYuv) ? yuvSize : 0;
+				}
+				if (NULL == pDecodeYuv)		continue;
+				pDecodeBuf = pDecodeYuv;
 			}
 
 			//
 			EnterCriticalSection(&pThread->crit);
-			if (0 != FFD_DecodeVideo3(pDecoderObj->ffDecoder, pbuf, frameinfo.length, pThread->yuvFrame[pThread->decodeYuvIdx].pYuvBuf, frameinfo.width, frameinfo.height))
+			unsigned long long ullDecodeTime = gVSTraceOn ? _VS_GetNs() : 0;
+			if (0 != FFD_DecodeVideo3(pDecoderObj->ffDecoder, pbuf, frameinfo.length, pDecodeBuf, frameinfo.width, frameinfo.height))
 			{
-				_TRACE("ʧ... framesize:%d   %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X\n", frameinfo.length, 
-					(unsigned char)pbuf[0], (unsigned char)pbuf[1], (unsigned char)pbuf[2], (unsigned char)pbuf[3], (unsigned char)pbuf[4],
-					(unsigned char)pbuf[5], (unsigned char)pbuf[6], (unsigned char)pbuf[7], (unsigned char)pbuf[8], (unsigned char)pbuf[9]);
+				//ǰ4ֽ, ж֡ͷǷȷ
+				_VS_TRACE(VSTRACE_EV_DECODE_FAIL, pThread->channelId, frameinfo.length, frameinfo.type,
+					(int)(((unsigned char)pbuf[0]<<24) | ((unsigned char)pbuf[1]<<16) | ((unsigned char)pbuf[2]<<8) | (unsigned char)pbuf[3]));
 
 				if (frameinfo.type == EASY_SDK_VIDEO_FRAME_I)		//ؼ֡
 				{
-					_TRACE("[ch%d]ǰؼ֡ʧ...\n", pThread->channelId);
 #ifdef _DEBUG
 					FILE *f = fopen("keyframe.txt", "wb");
 					if (NULL != f)
@@ -915,6 +1309,42 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDecodeThread( LPVOID _pParam )
 			}
 			else
 			{
+				if (ullDecodeTime > 0)		_VS_TRACE(VSTRACE_EV_DECODE, pThread->channelId, frameinfo.length, (int)((_VS_GetNs() - ullDecodeTime) / 1000), frameinfo.type);
+
+				//ڽʾ֮߳ǰȡ, ʾ̻߳֡ϵOSD
+				if (thumbnailDue)
+				{
+					VC_FRAME_T vcThumbnail;
+					VC_FillFrame(&vcThumbnail, VC_FORMAT_YUV420P, frameinfo.width, frameinfo.height, (unsigned char*)pDecodeBuf);
+					//̶߳æʱһؼ֡
+					if (pThumbnail->Submit(pThread->thumbnailKey, &vcThumbnail, VC_RANGE_LIMITED) > 0)		dwThumbnailTime = GetTickCount();
+				}
+				//ץͼͬȡOSDǰ֡, ûʱ
+				CVideoSnapshot *pSnapshot = (NULL != pChannelManager) ? pChannelManager->pSnapshot : NULL;
+				if (NULL != pSnapshot)
+				{
+					VC_FRAME_T vcSnapshot;
+					VC_FillFrame(&vcSnapshot, VC_FORMAT_YUV420P, frameinfo.width, frameinfo.height, (unsigned char*)pDecodeBuf);
+					pSnapshot->Capture(pThread->channelId - 1, &vcSnapshot, VC_RANGE_LIMITED, GetTickCount());
+				}
+				if (thumbnailOnly)
+				{
+					LeaveCriticalSection(&pThread->crit);
+					continue;
+				}
+
+				if (pDecodeBuf == pDecodeYuv)
+				{
+					VC_FRAME_T vcSrc, vcDst;
+					VC_FillFrame(&vcSrc, VC_FORMAT_YUV420P, frameinfo.width, frameinfo.height, (unsigned char*)pDecodeYuv);
+					if (roi)	VC_CropFrame(&vcSrc, &vcSrc, rcRoi.left, rcRoi.top, srcWidth, srcHeight);
+					VC_FillFrame(&vcDst, vcFormat, outWidth, outHeight, (unsigned char*)pThread->yuvFrame[pThread->decodeYuvIdx].pYuvBuf);
+					vcConverter.Convert(&vcSrc, &vcDst);
+				}
+				pThread->yuvFrame[pThread->decodeYuvIdx].width	=	outWidth;
+				pThread->yuvFrame[pThread->decodeYuvIdx].height	=	outHeight;
+				pThread->yuvFrame[pThread->decodeYuvIdx].tile	=	tile;
+				pThread->yuvFrame[pThread->decodeYuvIdx].roi	=	roi;
 				memcpy(&pThread->yuvFrame[pThread->decodeYuvIdx].frameinfo, &frameinfo, sizeof(MEDIA_FRAME_INFO));
 
 				pThread->decodeYuvIdx ++;
@@ -927,7 +1357,8 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDecodeThread( LPVOID _pParam )
 #if 1
 			if (NULL != pChannelManager)
 			{
-				if (NULL != pChannelManager->pAudioPlayThread && pChannelManager->pAudioPlayThread->channelId == pThread->channelId)
+				AUDIO_PLAY_THREAD_OBJ *pAudioPlayThread = pChannelManager->pAudioPlayThread;
+				if (NULL != pAudioPlayThread && NULL != pAudioPlayThread->pAudioMixer && pAudioPlayThread->pAudioMixer->IsInput(pThread->channelId))
 				{
 					DECODER_OBJ *pDecoderObj = GetDecoder(pThread, MEDIA_TYPE_AUDIO, &frameinfo);
 					if (NULL == pDecoderObj)
@@ -943,21 +1374,13 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDecodeThread( LPVOID _pParam )
 					int ret = FFD_DecodeAudio(pDecoderObj->ffDecoder, (char*)pbuf, frameinfo.length, (char *)audio_buf, &pcm_data_size);	//Ƶ(֧g711(ulaw)AAC)
 					if (ret == 0)
 					{
-						//
-						if (pChannelManager->pAudioPlayThread->audiochannels == 0)
-						{
-							pChannelManager->SetAudioParams(pDecoderObj->codec.channels, pDecoderObj->codec.samplerate, 16);//32);// 16);
-						}
-						if (pChannelManager->pAudioPlayThread->audiochannels != 0 && NULL!=pChannelManager->pAudioPlayThread->pSoundPlayer)
-						{
-							pChannelManager->pAudioPlayThread->pSoundPlayer->Write((char *)audio_buf, pcm_data_size);
-						}
+						//, ɻתΪʽ
+						int audiochannels = pDecoderObj->codec.channels>0?pDecoderObj->codec.channels:1;
+						pAudioPlayThread->pAudioMixer->Write(pThread->channelId, (short *)audio_buf, pcm_data_size / (audiochannels*(int)sizeof(short)), pDecoderObj->codec.samplerate, audiochannels);
 					}
 					else
 					{
-#ifdef _DEBUG
-						_TRACE("[ERROR]Ƶʧ....\n");
-#endif
+						_VS_TRACE(VSTRACE_EV_AUDIO_DECODE_FAIL, pThread->channelId, frameinfo.codec, frameinfo.length);
 					}
 				}
 			}
@@ -976,14 +1399,9 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDecodeThread( LPVOID _pParam )
 		}
 	}
 
-	if ( (NULL != pChannelManager) && (NULL != pChannelManager->pAudioPlayThread) && (pChannelManager->pAudioPlayThread->channelId == pThread->channelId) )
+	if ( (NULL != pChannelManager) && (NULL != pChannelManager->pAudioPlayThread) && (NULL != pChannelManager->pAudioPlayThread->pAudioMixer) )
 	{
-		if (NULL!=pChannelManager->pAudioPlayThread->pSoundPlayer)
-		{
-			pChannelManager->pAudioPlayThread->pSoundPlayer->Close();
-		}
-		pChannelManager->pAudioPlayThread->channelId = -1;
-		pChannelManager->pAudioPlayThread->audiochannels = 0;
+		pChannelManager->pAudioPlayThread->pAudioMixer->RemoveInput(pThread->channelId);
 	}
 
 
@@ -996,6 +1414,7 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDecodeThread( LPVOID _pParam )
 	}
 
 	delete []audio_buf;
+	__DELETE_ARRAY(pDecodeYuv);
 	delete []pbuf;
 	pbuf = NULL;
 
@@ -1028,7 +1447,10 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 	RECT	rcVideoRender;
 	SetRectEmpty(&rcVideoRender);
 
-	int iInitTimestamp = 0;
+	//ʾ: ÿ֡PTSʱ, ۻ
+	VS_PACER_T	pacer;
+	_VS_PacerReset(&pacer);
+	unsigned long long ullWakeTime = 0;
 
 	pThread->rtpTimestamp = 0;
 	unsigned int deviceLostTime = (unsigned int)time(NULL)-2;
@@ -1050,9 +1472,18 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 
 	int iDelay = 0;
 
-	_VS_BEGIN_TIME_PERIOD(1);
-	QueryPerformanceFrequency(&pThread->cpuFreq);
-	_VS_END_TIME_PERIOD(1);
+	//ͳϢOSD: ÿһ, ֻդһ, رʱκδ
+	CVideoOsd	vOsd;
+	D3D_OSD		osd;
+	memset(&osd, 0x00, sizeof(D3D_OSD));
+	osd.color = RGB(0xff,0xff,0x00);
+	osd.shadowcolor = RGB(0x15,0x15,0x15);
+	osd.alpha = 180;
+	vOsd.SetColor(osd.color, osd.shadowcolor, osd.alpha);
+	DWORD	dwOsdTime = 0;
+	int		osdHeight = 0;		//OSDֶӦĻ߶
+
+	_VS_BEGIN_TIME_PERIOD(1);		//߳˳ʱָ
 	while (1)
 	{
 		if (pThread->displayThread.flag == 0x03)		break;
@@ -1110,7 +1541,10 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 			continue;
 		}
 
-		if ( (NULL==pThread->hWnd) || (NULL!=pThread->hWnd && (!IsWindow(pThread->hWnd))) || (NULL!=pThread->hWnd && (!IsWindowVisible(pThread->hWnd))))
+		//֡ĺϳɴڷֿ, ʱʹͨԼĴںd3dRender
+		int compositorTile = pThread->yuvFrame[iDispalyYuvIdx].tile;
+		if ( compositorTile < 0 &&
+			((NULL==pThread->hWnd) || (NULL!=pThread->hWnd && (!IsWindow(pThread->hWnd))) || (NULL!=pThread->hWnd && (!IsWindowVisible(pThread->hWnd)))) )
 		{
 			pThread->rtpTimestamp = pThread->yuvFrame[iDispalyYuvIdx].frameinfo.timestamp_sec*1000+pThread->yuvFrame[iDispalyYuvIdx].frameinfo.timestamp_usec/1000;
 
@@ -1147,13 +1581,14 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 
 		RECT rcSrc;
 		RECT rcDst;
-		if (! IsRectEmpty(&pThread->rcSrcRender))
+		if (! IsRectEmpty(&pThread->rcSrcRender) && !pThread->yuvFrame[iDispalyYuvIdx].roi)
 		{
 			CopyRect(&rcSrc, &pThread->rcSrcRender);
 		}
 		else
 		{
-			SetRect(&rcSrc, 0, 0, width, height);
+			//a window's size changes with the rect, take it from the frame itself
+			SetRect(&rcSrc, 0, 0, pThread->yuvFrame[iDispalyYuvIdx].width, pThread->yuvFrame[iDispalyYuvIdx].height);
 		}
 		if (NULL!=pThread->hWnd && (IsWindow(pThread->hWnd)) )
 		{
@@ -1161,8 +1596,8 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 		}
 
 		//ǰֱʺ֮ǰĲͬ,³ʼd3d
-		if (lastFrameInfo.width != pThread->yuvFrame[iDispalyYuvIdx].frameinfo.width ||
-			lastFrameInfo.height!= pThread->yuvFrame[iDispalyYuvIdx].frameinfo.height)
+		if (width != pThread->yuvFrame[iDispalyYuvIdx].width ||
+			height!= pThread->yuvFrame[iDispalyYuvIdx].height)
 		{
 			pThread->resetD3d = true;
 		}
@@ -1182,13 +1617,17 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 				D3D_Release(&pThread->d3dHandle);
 			}
 		}
-		width = pThread->yuvFrame[iDispalyYuvIdx].frameinfo.width;
-		height= pThread->yuvFrame[iDispalyYuvIdx].frameinfo.height;
+		width = pThread->yuvFrame[iDispalyYuvIdx].width;
+		height= pThread->yuvFrame[iDispalyYuvIdx].height;
 
 		LeaveCriticalSection(&pThread->crit);			//Unlock
 
 		//D3dRender
-		if (pThread->renderFormat == GDI_FORMAT_RGB24)
+		if (compositorTile >= 0)
+		{
+			//ϳɴڵĻ, ɺϳʾ߳ύ
+		}
+		else if (pThread->renderFormat == GDI_FORMAT_RGB24)
 		{
 			if (NULL == pThread->d3dHandle)	RGB_InitDraw(&pThread->d3dHandle);
 		}
@@ -1223,7 +1662,7 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 			}
 			if (NULL == pThread->d3dHandle)
 			{
-				_TRACE("DEVICE LOST...   times:%d\n", ((unsigned int)time(NULL)-deviceLostTime));
+				_VS_TRACE(VSTRACE_EV_DEVICE_LOST, pThread->channelId, (int)((unsigned int)time(NULL)-deviceLostTime));
 				deviceLostTime = (unsigned int)time(NULL);
 				//d3d ʼʧ,֡ͷϢ,Ա̼߳һ֡
 				pThread->rtpTimestamp = pThread->yuvFrame[iDispalyYuvIdx].frameinfo.timestamp_sec*1000+pThread->yuvFrame[iDispalyYuvIdx].frameinfo.timestamp_usec/1000;
@@ -1245,16 +1684,27 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 		pThread->rtpTimestamp = pThread->yuvFrame[iDispalyYuvIdx].frameinfo.timestamp_sec*1000+pThread->yuvFrame[iDispalyYuvIdx].frameinfo.timestamp_usec/1000;
 
 		//ͳϢ:  ʽ ֱ ֡ ֡    ֡
-		char sztmp[128] = {0,};
+		int showOSD = pThread->showStatisticalInfo;
+		int osdTarget = height;		//OSDڻĸ߶, ϳɴΪֿĸ߶
+		if (showOSD && compositorTile >= 0)
+		{
+			VCOMP_RECT_T rcTile;
+			COMPOSITOR_THREAD_OBJ *pCompositorThread = (NULL != pChannelManager) ? pChannelManager->pCompositorThread : NULL;
+			if (NULL != pCompositorThread && NULL != pCompositorThread->pCompositor &&
+				0 == pCompositorThread->pCompositor->GetTileRect(compositorTile, &rcTile))		osdTarget = rcTile.height;
+		}
+		if (showOSD && (GetTickCount() - dwOsdTime >= OSD_UPDATE_INTERVAL || osdHeight != osdTarget))
+		{
+			char sztmp[VOSD_MAX_TEXT] = {0,};
 #if 0
-		sprintf(sztmp, "%s[%d x %d]  FPS: %d[%s]    Bitrate: %.2fMbps   Cache: %d / %d",
-			pThread->yuvFrame[iDispalyYuvIdx].frameinfo.codec==0x1C?"H264":"MPEG4",
-			pThread->yuvFrame[iDispalyYuvIdx].frameinfo.width,
-			pThread->yuvFrame[iDispalyYuvIdx].frameinfo.height,
-			fps,
-			pThread->yuvFrame[iDispalyYuvIdx].frameinfo.type==0x01?"I":"P",
-			pThread->yuvFrame[iDispalyYuvIdx].frameinfo.bitrate/1024.0f,
-			nQueueFrame, iCache);
+			sprintf(sztmp, "%s[%d x %d]  FPS: %d[%s]    Bitrate: %.2fMbps   Cache: %d / %d",
+				pThread->yuvFrame[iDispalyYuvIdx].frameinfo.codec==0x1C?"H264":"MPEG4",
+				pThread->yuvFrame[iDispalyYuvIdx].frameinfo.width,
+				pThread->yuvFrame[iDispalyYuvIdx].frameinfo.height,
+				fps,
+				pThread->yuvFrame[iDispalyYuvIdx].frameinfo.type==0x01?"I":"P",
+				pThread->yuvFrame[iDispalyYuvIdx].frameinfo.bitrate/1024.0f,
+				nQueueFrame, iCache);
 #else
 			sprintf(sztmp, "[%dx%d] fps[%d] Bitrate[%.2fMbps]Cache[%d(%d+%d) / %d]  AverageTime: %.2f  Delay: %d  totaltime:%d / %d dropframe:%d",
 				pThread->yuvFrame[iDispalyYuvIdx].frameinfo.width,
@@ -1264,22 +1714,33 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 				nQueueFrame,  iQue1_DecodeQueue, iQue2_DisplayQueue,  iCache, 
 				fDisplayTimes, iDelay, (int)fDisplayTimes+(iDelay>0?iDelay:0), iOneFrameUsec, iDropFrame);
 #endif
-		D3D_OSD	osd;
-		memset(&osd, 0x00, sizeof(D3D_OSD));
-		MByteToWChar(sztmp, osd.string, sizeof(osd.string)/sizeof(osd.string[0]));
-		if (pThread->renderFormat == GDI_FORMAT_RGB24)
-		{
-			SetRect(&osd.rect, 2, 2, (int)wcslen(osd.string)*7, (int)(float)((height)*0.046f));//40);
+			MByteToWChar(sztmp, osd.string, sizeof(osd.string)/sizeof(osd.string[0]));
+			if (pThread->renderFormat == GDI_FORMAT_RGB24)
+			{
+				SetRect(&osd.rect, 2, 2, (int)wcslen(osd.string)*7, (int)(float)((height)*0.046f));//40);
+			}
+			else
+			{
+				SetRect(&osd.rect, 2, 2, (int)wcslen(osd.string)*20, (int)(float)((height)*0.046f));//40);
+			}
+
+			//滭߶ȱ仯, ڸ߶ȱ仯ʱؽ
+			int fontHeight = osdTarget / 60;
+			if (fontHeight < 12)	fontHeight = 12;
+			if (fontHeight > 32)	fontHeight = 32;
+			if (vOsd.GetFontHeight() != fontHeight)		vOsd.Init(fontHeight);
+			vOsd.SetText(sztmp);
+			dwOsdTime = GetTickCount();
+			osdHeight = osdTarget;
 		}
-		else
+
+		//ֱӻʱٽd3dRender, RGB565/RGB555d3dRender
+		if (showOSD && compositorTile < 0)
 		{
-			SetRect(&osd.rect, 2, 2, (int)wcslen(osd.string)*20, (int)(float)((height)*0.046f));//40);
+			VC_FRAME_T vcFrame;
+			VC_FillFrame(&vcFrame, ParseRenderFormat(pThread->renderFormat, width, height, NULL), width, height, (unsigned char*)pThread->yuvFrame[iDispalyYuvIdx].pYuvBuf);
+			if (0 == vOsd.Blend(&vcFrame, rcSrc.left+2, rcSrc.top+2))		showOSD = 0;
 		}
-		osd.color = RGB(0xff,0xff,0x00);
-		osd.shadowcolor = RGB(0x15,0x15,0x15);
-		osd.alpha = 180;
-
-		int showOSD = pThread->showStatisticalInfo;
 
 		int ret = 0;
 
@@ -1288,9 +1749,36 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 
 		if (nQueueFrame > iCache * 2)	iDropFrame ++;
 		else							iDropFrame = 0;
+
+		//˯һ֡ʱǰVS_SPIN_NS, ʱ; ֡iCacheʱ, ʱӿ
+		unsigned long long ullPts = (unsigned long long)lastFrameInfo.timestamp_sec*1000000 + lastFrameInfo.timestamp_usec;
+		if (iCache > 0 && fps > 0 && nQueueFrame != iCache)
+		{
+			_VS_PacerShift(&pacer, (long long)(iCache - nQueueFrame) * 1000000000LL / fps / fps);
+		}
+		unsigned long long ullDeadline = _VS_PacerDeadline(&pacer, ullPts, fps);
+		ullWakeTime = _VS_GetNs();
+		iDelay = 0;
+		if (iCache>0 && iCache*2>nQueueFrame && iDropFrame==0 && ullDeadline > ullWakeTime)
+		{
+			iDelay = (int)((ullDeadline - ullWakeTime) / 1000000);
+			_VS_SleepUntilNs(ullDeadline);
+			ullWakeTime = _VS_GetNs();
+		}
+
 		if (iDropFrame < 0x02)
 		{
-			if (pThread->renderFormat == GDI_FORMAT_RGB24)
+			if (compositorTile >= 0)
+			{
+				COMPOSITOR_THREAD_OBJ *pCompositorThread = (NULL != pChannelManager) ? pChannelManager->pCompositorThread : NULL;
+				if (NULL != pCompositorThread && NULL != pCompositorThread->pCompositor)
+				{
+					VC_FRAME_T vcFrame;
+					VC_FillFrame(&vcFrame, VC_FORMAT_YUV420P, width, height, (unsigned char*)pThread->yuvFrame[iDispalyYuvIdx].pYuvBuf);
+					pCompositorThread->pCompositor->UpdateTile(compositorTile, &vcFrame, pThread->ShownToScale, showOSD ? &vOsd : NULL);
+				}
+			}
+			else if (pThread->renderFormat == GDI_FORMAT_RGB24)
 			{
 				RGB_DrawData(pThread->d3dHandle, pThread->hWnd, pThread->yuvFrame[iDispalyYuvIdx].pYuvBuf, width, height, &rcSrc, pThread->ShownToScale, RGB(0x3c,0x3c,0x3c), 0, showOSD, &osd);
 				//D3D_RenderRGB24ByGDI(pThread->hWnd, pThread->yuvFrame[iDispalyYuvIdx].pYuvBuf, width, height, showOSD, &osd);
@@ -1322,92 +1810,36 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 		}
 		else
 		{
-			_TRACE("֡...%d\n", iDropFrame);
+			_VS_TRACE(VSTRACE_EV_DROP_FRAME, pThread->channelId, iDropFrame, nQueueFrame, iCache);
 		}
 		
 		memset(&pThread->yuvFrame[iDispalyYuvIdx].frameinfo, 0x00, sizeof(MEDIA_FRAME_INFO));
 
-		if (iInitTimestamp == 0x00)
+		//ʾʱͳ: ʾ
+		unsigned long long ullDoneTime = _VS_GetNs();
+		unsigned int iInterval = (unsigned int)((ullDoneTime - ullWakeTime) / 1000000);
+		if (iDropFrame < 0x02)
 		{
-			iInitTimestamp = 0x01;
-			_VS_BEGIN_TIME_PERIOD(1);
-			__VS_Delay(50);
-			QueryPerformanceCounter(&pThread->lastRenderTime);
-			_VS_END_TIME_PERIOD(1);
+			_VS_TRACE(VSTRACE_EV_RENDER, pThread->channelId, (int)((long long)(ullWakeTime - ullDeadline) / 1000), (int)((ullDoneTime - ullWakeTime) / 1000), nQueueFrame, iCache);
 		}
-		else
-		{
-			unsigned int iInterval = 0;
-			_LARGE_INTEGER	nowTime;
-
-
-#ifdef _DEBUG1
-			/*
-			static int nRandTally = 0;
-			if (nRandTally > 20)
-			{
-				Sleep(50);
-				if (nRandTally > 30)	nRandTally = 0;
-			}
-			nRandTally ++;
-			*/
-			
-			Sleep(30);
-#endif
-
-
-			_VS_BEGIN_TIME_PERIOD(1);
-			QueryPerformanceCounter(&nowTime);
-			_VS_END_TIME_PERIOD(1);
-			if (pThread->cpuFreq.QuadPart < 1)	pThread->cpuFreq.QuadPart = 1;
-			LONGLONG lInterval = (LONGLONG)(((nowTime.QuadPart - pThread->lastRenderTime.QuadPart) / (double)pThread->cpuFreq.QuadPart * (double)1000));
-			iInterval = (int)lInterval;
-
-			iDelay = iOneFrameUsec - iInterval;
-
-			if (iDelay<1)	iDelay = 0;
-			else if (iDelay>1500)	iDelay=1500;
-			if (nQueueFrame<iCache && fps>0)
-			{
-				int ii = ((iOneFrameUsec * (iCache-nQueueFrame))/fps);
-				iDelay += ii;
-			}
-			else if (nQueueFrame>iCache && fps>0)
-			{
-				int ii = ((iOneFrameUsec * (nQueueFrame-iCache))/fps);
-				iDelay -= ii;
-			}
-
 //#ifdef _DEBUG
 #if 1
-			unsigned int uiCurrTime = (unsigned int)time(NULL);
-			if (uiLastTotalTime == 0x00)		uiLastTotalTime = uiCurrTime;
-
-			if (uiLastTotalTime != uiCurrTime)
-			{
-				fDisplayTimes = (float)nDisplayTotalTimes / (float)displayFrameNum;
-				//fDisplayTimes = (float)nDisplayTotalTimes / iOneFrameUsec;
-				uiLastTotalTime = uiCurrTime;
-				nDisplayTotalTimes = iInterval;
-				displayFrameNum = 1;
-			}
-			else
-			{
-				nDisplayTotalTimes += iInterval;
-				displayFrameNum ++;
-			}
-#endif
-
-			_VS_BEGIN_TIME_PERIOD(1);
-			//_TRACE("[ch%d]ʱ: %d\tʾʱ:%d\tʱ:%d\t֡:%d\tǰ֡С:%d  OneFrameUsec:%d\n", pThread->renderCh, iInterval+iDelay, iInterval, iDelay, nQueueFrame, frame_size, iOneFrameUsec);
-			if (iDelay>0 && iDelay<1500 && iCache>0 && iCache*2>nQueueFrame && iDropFrame==0)
-			{
-				__VS_Delay(iDelay);
-			}
+		unsigned int uiCurrTime = (unsigned int)time(NULL);
+		if (uiLastTotalTime == 0x00)		uiLastTotalTime = uiCurrTime;
 
-			QueryPerformanceCounter(&pThread->lastRenderTime);
-			_VS_END_TIME_PERIOD(1);
+		if (uiLastTotalTime != uiCurrTime)
+		{
+			fDisplayTimes = (float)nDisplayTotalTimes / (float)displayFrameNum;
+			uiLastTotalTime = uiCurrTime;
+			nDisplayTotalTimes = iInterval;
+			displayFrameNum = 1;
+		}
+		else
+		{
+			nDisplayTotalTimes += iInterval;
+			displayFrameNum ++;
 		}
+#endif
 	}
 
 	if (pThread->renderFormat == GDI_FORMAT_RGB24)
@@ -1419,6 +1851,7 @@ LPTHREAD_START_ROUTINE CChannelManager::_lpDisplayThread( LPVOID _pParam )
 		D3D_Release(&pThread->d3dHandle);
 	}
 	pThread->rtpTimestamp = 0;
+	_VS_END_TIME_PERIOD(1);
 
 	pThread->displayThread.flag	=	0x00;
 
@@ -1437,16 +1870,6 @@ int CALLBACK __NVSourceCallBack( int _chid, int *_chPtr, int _mediatype, char *p
 
 	if (NULL == pChannelManager)	return -1;
 
-	if (NULL != frameinfo)
-	{
-		//frameinfo->width = 640;
-		//frameinfo->height = 360;
-
-		if (frameinfo->height==3008)		frameinfo->height=3000;
-		else if (frameinfo->height==1088)		frameinfo->height=1080;
-		else if (frameinfo->height==544)	frameinfo->height=540;
-	}
-
 	pChannelManager->ProcessData(_chid, _mediatype, pbuf, frameinfo);
 
 	return 0;
@@ -1460,16 +1883,6 @@ int CALLBACK __RTSPSourceCallBack( int _channelId, int *_channelPtr, int _frameT
 
 	if (NULL == pChannelManager)	return -1;
 
-	if (NULL != _frameInfo)
-	{
-		//frameinfo->width = 640;
-		//frameinfo->height = 360;
-
-		if (_frameInfo->height==3008)			_frameInfo->height=3000;
-		else if (_frameInfo->height==1088)		_frameInfo->height=1080;
-		else if (_frameInfo->height==544)		_frameInfo->height=540;
-	}
-
 	pChannelManager->ProcessData(_channelId, _frameType, pBuf, _frameInfo);
 
 	return 0;
@@ -1480,6 +1893,22 @@ int	CChannelManager::ProcessData(int _chid, int mediatype, char *pbuf, RTSP_FRAM
 {
 	if (NULL == pRealtimePlayThread)			return 0;
 
+	//¼: ¼Դصԭʼframeinfo, طͨݱļ
+	if (NULL != pStreamRecorder && !pRealtimePlayThread[_chid].replay)
+	{
+		pStreamRecorder->Write(_chid, mediatype, pbuf, frameinfo);
+	}
+
+	//¼֮߶, ʵʱͻطŵݶ
+	if (NULL != frameinfo)
+	{
+		//frameinfo->width = 640;
+		//frameinfo->height = 360;
+
+		if (frameinfo->height==3008)		frameinfo->height=3000;
+		else if (frameinfo->height==1088)		frameinfo->height=1080;
+		else if (frameinfo->height==544)	frameinfo->height=540;
+	}
 
 	MediaSourceCallBack pMediaCallback = (MediaSourceCallBack )pRealtimePlayThread[_chid].pCallback;
 	if (NULL != pMediaCallback && (mediatype == EASY_SDK_VIDEO_FRAME_FLAG || mediatype == EASY_SDK_AUDIO_FRAME_FLAG || mediatype == EASY_SDK_MEDIA_INFO_FLAG))
@@ -1519,7 +1948,7 @@ int	CChannelManager::ProcessData(int _chid, int mediatype, char *pbuf, RTSP_FRAM
 	{
 		if (NULL == pbuf && NULL == frameinfo)
 		{
-			_TRACE("[ch%d]...\n", _chid);
+			_VS_TRACE(VSTRACE_EV_CONNECTING, _chid);
 
 			MEDIA_FRAME_INFO	frameinfo;
 			memset(&frameinfo, 0x00, sizeof(MEDIA_FRAME_INFO));
@@ -1529,7 +1958,7 @@ int	CChannelManager::ProcessData(int _chid, int mediatype, char *pbuf, RTSP_FRAM
 		}
 		else if (NULL!=frameinfo && frameinfo->type==0xF1)
 		{
-			_TRACE("[ch%d][%.2f]...\n", _chid, frameinfo->losspacket);
+			_VS_TRACE(VSTRACE_EV_PACKET_LOSS, _chid, (int)(frameinfo->losspacket * 100));
 
 			frameinfo->length = 1;
 			SSQ_AddData(pRealtimePlayThread[_chid].pAVQueue, _chid, MEDIA_TYPE_EVENT, (MEDIA_FRAME_INFO*)frameinfo, "1");
@@ -1568,3 +1997,118 @@ int		CChannelManager::StopManuRecording(int channelId)
 
 	return 0;
 }
+
+int		CChannelManager::StartStreamRecording(int channelId, const char *path)
+{
+	if (NULL == pRealtimePlayThread)			return -1;
+
+	int iNvsIdx = channelId - CHANNEL_ID_GAIN;
+	if (iNvsIdx < 0 || iNvsIdx>= MAX_CHANNEL_NUM)	return -1;
+	if (NULL == pRealtimePlayThread[iNvsIdx].nvsHandle)	return -1;		//ֻ¼RTSPͨ
+
+	//һ¼ʱ, ֮ProcessDataȡpStreamRecorder, Release֮ǰɾ
+	if (NULL == pStreamRecorder)
+	{
+		EnterCriticalSection(&crit);
+		if (NULL == pStreamRecorder)		pStreamRecorder = new CStreamRecorder();
+		LeaveCriticalSection(&crit);
+		if (NULL == pStreamRecorder)		return -1;
+	}
+
+	return pStreamRecorder->Start(iNvsIdx, path);
+}
+int		CChannelManager::StopStreamRecording(int channelId)
+{
+	if (NULL == pRealtimePlayThread)			return -1;
+
+	int iNvsIdx = channelId - CHANNEL_ID_GAIN;
+	if (iNvsIdx < 0 || iNvsIdx>= MAX_CHANNEL_NUM)	return -1;
+
+	if (NULL != pStreamRecorder)		pStreamRecorder->Stop(iNvsIdx);
+	return 0;
+}
+
+int	CChannelManager::OpenReplay(const char *path, HWND hWnd, RENDER_FORMAT renderFormat, int speed, int loop, MediaSourceCallBack callback, void *userPtr)
+{
+	if (NULL == pRealtimePlayThread)			return -1;
+	if ( (NULL == path) || (0==strcmp(path, "\0")))		return -1;
+
+	int iNvsIdx = -1;
+	EnterCriticalSection(&crit);
+	do
+	{
+		if (NULL == pStreamReplayer)		pStreamReplayer = new CStreamReplayer();
+		if (NULL == pStreamReplayer)		break;
+
+		for (int i=0; i<MAX_CHANNEL_NUM; i++)
+		{
+			if (NULL == pRealtimePlayThread[i].nvsHandle && !pRealtimePlayThread[i].replay)
+			{
+				iNvsIdx = i;
+				break;
+			}
+		}
+
+		if (iNvsIdx == -1)		break;
+
+		pRealtimePlayThread[iNvsIdx].replay = 0x01;
+		pRealtimePlayThread[iNvsIdx].replaySpeed = speed;
+		pRealtimePlayThread[iNvsIdx].pCallback = callback;
+		pRealtimePlayThread[iNvsIdx].pUserPtr = userPtr;
+
+		pRealtimePlayThread[iNvsIdx].hWnd = hWnd;
+		strncpy(pRealtimePlayThread[iNvsIdx].thumbnailKey, path, VTHUMB_MAX_KEY-1);
+		pRealtimePlayThread[iNvsIdx].thumbnailKey[VTHUMB_MAX_KEY-1] = '\0';
+		pRealtimePlayThread[iNvsIdx].renderFormat = (D3D_SUPPORT_FORMAT)renderFormat;
+		CreatePlayThread(&pRealtimePlayThread[iNvsIdx]);
+
+		//߳̾ٿʼ
+		if (0 != pStreamReplayer->Start(iNvsIdx, path, speed, loop, _ReplayCallBack, this))
+		{
+			ClosePlayThread(&pRealtimePlayThread[iNvsIdx]);
+			pRealtimePlayThread[iNvsIdx].replay = 0;
+			iNvsIdx = -1;
+		}
+	}while (0);
+	LeaveCriticalSection(&crit);
+
+	if (iNvsIdx >= 0)	iNvsIdx += CHANNEL_ID_GAIN;
+	return iNvsIdx;
+}
+
+int	CChannelManager::GetReplayState(int channelId, unsigned int *records, unsigned int *loops)
+{
+	if (NULL == pRealtimePlayThread || NULL == pStreamReplayer)			return -1;
+
+	int iNvsIdx = channelId - CHANNEL_ID_GAIN;
+	if (iNvsIdx < 0 || iNvsIdx>= MAX_CHANNEL_NUM)	return -1;
+	if (!pRealtimePlayThread[iNvsIdx].replay)		return -1;
+
+	STREAM_REPLAY_STATS_T	stats;
+	int state = pStreamReplayer->GetStats(iNvsIdx, &stats);
+	if (NULL != records)		*records = stats.records;
+	if (NULL != loops)			*loops = stats.loops;
+	return state;
+}
+
+//ط̵߳. ʵʱٶ½ʱûطŵȴ, ý߳նжһؼ֡
+int CALLBACK CChannelManager::_ReplayCallBack(int _source, void *_userPtr, int _frameType, char *pBuf, RTSP_FRAME_INFO *_frameInfo)
+{
+	CChannelManager *pManager = (CChannelManager *)_userPtr;
+	if (NULL == pManager || NULL == pManager->pRealtimePlayThread)		return STREAM_FEED_OK;
+
+	PLAY_THREAD_OBJ *pThread = &pManager->pRealtimePlayThread[_source];
+	if (pThread->replaySpeed != STREAM_SPEED_REALTIME && NULL != pThread->pAVQueue && NULL != _frameInfo &&
+		(_frameType == EASY_SDK_VIDEO_FRAME_FLAG || _frameType == EASY_SDK_AUDIO_FRAME_FLAG))
+	{
+		SS_HEADER_T *pHeader = pThread->pAVQueue->pQueHeader;
+		if (NULL != pHeader && (pHeader->videoframes >= MAX_CACHE_FRAME/2 ||
+			pHeader->totalsize + _frameInfo->length + sizeof(MEDIA_FRAME_INFO) * 2 > pHeader->bufsize))
+		{
+			return STREAM_FEED_BUSY;
+		}
+	}
+
+	pManager->ProcessData(_source, _frameType, pBuf, _frameInfo);
+	return STREAM_FEED_OK;
+}
@@ -12,6 +12,12 @@
 #include "FFDecoder\FFDecoderAPI.h"
 #include "D3DRender\D3DRenderAPI.h"
 #include "SoundPlayer.h"
+#include "AudioMixer.h"
+#include "VideoCompositor.h"
+#include "VideoOsd.h"
+#include "VideoThumbnail.h"
+#include "VideoSnapshot.h"
+#include "StreamReplayer.h"
 #include "ssqueue.h"
 #pragma comment(lib, "EasyRTSPClient/libEasyRTSPClient.lib")
 #pragma comment(lib, "FFDecoder/FFDecoder.lib")
@@ -28,6 +34,14 @@ extern "C"
 #define		MAX_YUV_FRAME_NUM	3		//YUV֡
 #define		MAX_CACHE_FRAME		30		//֡,ֵֻI֡
 #define		MAX_AVQUEUE_SIZE	(1024*1024)	//дС
+#define		AUDIO_MIX_SAMPLERATE	48000	//
+#define		AUDIO_MIX_CHANNELS		2		//
+#define		AUDIO_MIX_PERIOD		20		//(ms)
+#define		COMPOSITOR_REFRESH		60		//ϳɴˢ, ȡʾˢʱʹ
+#define		OSD_UPDATE_INTERVAL		1000	//ͳϢָ¼(ms)
+#define		THUMBNAIL_WORKERS		2		//ͼJPEG߳
+#define		DECODE_THUMBNAIL_ONLY	0x02	//decodeKeyFrameOnly: ֻҪͼʱؼ֡, ʾ
+#define		SNAPSHOT_WORKERS		2		//ץͼ߳
 //#define		MAX_AVQUEUE_SIZE	(1920*1080*2)	//дС
 
 typedef struct __CODEC_T
@@ -63,6 +77,10 @@ typedef struct _YUV_FRAME_INFO			//YUV
 	MEDIA_FRAME_INFO	frameinfo;
 	char	*pYuvBuf;
 	int		Yuvsize;
+	int		width;			//of pYuvBuf, below frameinfo.width x height when scaled to the window
+	int		height;
+	int		tile;			//compositor tile it was decoded for, YUV420P at full size; -1 for hWnd
+	int		roi;			//1: holds only the SetRenderRect window, shown whole
 }YUV_FRAME_INFO;
 
 typedef struct __PLAY_THREAD_OBJ
@@ -71,6 +89,8 @@ typedef struct __PLAY_THREAD_OBJ
 	THREAD_OBJ		displayThread;		//ʾ߳
 
 	Easy_RTSP_Handle		nvsHandle;
+	int				replay;				//طͨ: pStreamReplayer, ûnvsHandle
+	int				replaySpeed;		//STREAM_SPEED_xxx, ʵʱʱûطŵȴ
 	HWND			hWnd;				//ʾƵĴھ
 	int				channelId;			//ͨ
 	int				showStatisticalInfo;//ʾͳϢ
@@ -92,14 +112,14 @@ typedef struct __PLAY_THREAD_OBJ
 	int				decodeKeyFrameOnly;	//ʾؼ֡
 
 	unsigned int	rtpTimestamp;
-	LARGE_INTEGER	cpuFreq;		//cpuƵ
-	_LARGE_INTEGER	lastRenderTime;	//ʾʱ
 
 	int				yuvFrameNo;		//ǰʾyuv֡
 	YUV_FRAME_INFO	yuvFrame[MAX_YUV_FRAME_NUM];
 	CRITICAL_SECTION	crit;
 	bool			resetD3d;		//ǷҪؽd3dRender
 	RECT			rcSrcRender;
+	int				compositorTile;	//ϳɴеķֿ, -1ΪʾhWnd
+	char			thumbnailKey[VTHUMB_MAX_KEY];	//ͼurl
 	D3D9_LINE		d3d9Line;
 
 	char			manuRecordingFile[MAX_PATH];
@@ -115,16 +135,26 @@ typedef struct __PLAY_THREAD_OBJ
 //Ƶ߳
 typedef struct __AUDIO_PLAY_THREAD_OBJ
 {
-	int				channelId;		//ǰͨ
+	THREAD_OBJ		mixThread;		//߳
 
-	unsigned int	samplerate;	//
-	unsigned int	audiochannels;	//
+	unsigned int	samplerate;	//
+	unsigned int	audiochannels;	//
 	unsigned int	bitpersample;
 
+	CAudioMixer		*pAudioMixer;	//,ÿͨӦһ·
 	//CWaveOut		*pWaveOut;
-	CSoundPlayer	*pSoundPlayer;
+	CSoundPlayer	*pSoundPlayer;	//Ψһ豸
 }AUDIO_PLAY_THREAD_OBJ;
 
+//ϳʾ߳: ͨͬһ, ÿˢֻύб仯ķֿ
+typedef struct __COMPOSITOR_THREAD_OBJ
+{
+	THREAD_OBJ		presentThread;	//ύ߳
+
+	HWND			hWnd;			//зֿʾһ
+	CVideoCompositor	*pCompositor;	//, һֱRelease
+}COMPOSITOR_THREAD_OBJ;
+
 
 class CChannelManager
 {
@@ -147,17 +177,41 @@ public:
 	int		SetDragEndPoint(int channelId, POINT pt);
 	int		ResetDragPoint(int channelId);
 
-	//ͬһʱֻ֧һ·
+	//·
 	int		PlaySound(int channelId);
-	int		StopSound();
+	int		StopSound();						//ֹͣͨ
+	int		StopSound(int channelId);
+	int		SetSoundVolume(int channelId, float volume);
+	int		SetSoundMute(int channelId, int mute);
+
+	//·Ƶϳɵһ
+	int		SetCompositor(HWND hWnd, int tiles);		//hWndΪNULLʱر, ͨصԼĴ
+	int		SetChannelTile(int channelId, int tile);	//tileΪ-1ʱʾOpenStreamhWnd
+
+	//ؼ֡ͼ
+	int		StartThumbnail(int width, int height, int interval, int entries, const char *cacheDir);
+	int		StopThumbnail();
+	int		GetThumbnail(const char *url, unsigned char *buf, int bufSize, unsigned int *sequence);
+
+	//ץͼ: ֻǼ, ɽ߳ȡһ֡߳
+	int		Snapshot(int channelId, const char *path, SNAPSHOT_FORMAT format, int count, int interval, SnapshotCallBack callback, void *userPtr);
 
 
 	int		StartManuRecording(int channelId);
 	int		StopManuRecording(int channelId);
 
+	//¼: ԭRTSPص֡Ϣݼʱ; ط: ļģһͨ, CloseStreamر
+	int		StartStreamRecording(int channelId, const char *path);
+	int		StopStreamRecording(int channelId);
+	int		OpenReplay(const char *path, HWND hWnd, RENDER_FORMAT renderFormat, int speed, int loop, MediaSourceCallBack callback=NULL, void *userPtr=NULL);
+	int		GetReplayState(int channelId, unsigned int *records, unsigned int *loops);
+
 
 	static LPTHREAD_START_ROUTINE __stdcall _lpDecodeThread( LPVOID _pParam );
 	static LPTHREAD_START_ROUTINE __stdcall _lpDisplayThread( LPVOID _pParam );
+	static LPTHREAD_START_ROUTINE __stdcall _lpAudioMixThread( LPVOID _pParam );
+	static LPTHREAD_START_ROUTINE __stdcall _lpCompositorThread( LPVOID _pParam );
+	static int CALLBACK _ReplayCallBack(int _source, void *_userPtr, int _frameType, char *pBuf, RTSP_FRAME_INFO *_frameInfo);
 
 
 
@@ -165,6 +219,11 @@ public:
 protected:
 	PLAY_THREAD_OBJ			*pRealtimePlayThread;		//ʵʱ߳
 	AUDIO_PLAY_THREAD_OBJ	*pAudioPlayThread;			//Ƶ߳
+	COMPOSITOR_THREAD_OBJ	*pCompositorThread;			//ϳʾ߳
+	CVideoThumbnail			*pThumbnail;				//ͼ, һֱRelease, ֱ߳ʹ
+	CVideoSnapshot			*pSnapshot;					//ץͼ, ͬ
+	CStreamRecorder			*pStreamRecorder;			//¼, ͬ, ProcessDataֱʹ
+	CStreamReplayer			*pStreamReplayer;			//ط, ͬ
 	CRITICAL_SECTION		crit;
 
 	D3D_ADAPTER_T		d3dAdapter;
@@ -173,8 +232,11 @@ protected:
 	void	CreatePlayThread(PLAY_THREAD_OBJ	*_pPlayThread);
 	void	ClosePlayThread(PLAY_THREAD_OBJ		*_pPlayThread);
 
-	int		SetAudioParams(unsigned int _channel, unsigned int _samplerate, unsigned int _bitpersample);
-	void	ClearAllSoundData();
+	int		OpenAudioOutput();
+	void	CloseAudioOutput();
+
+	int		OpenCompositor(HWND hWnd, int tiles);
+	void	CloseCompositor();
 
 	void	Release();
 };
@@ -0,0 +1,189 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "StreamRecorder.h"
+#include "vstime.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+static unsigned long long __StreamWallTime()
+{
+#ifdef _WIN32
+	FILETIME	ft;
+	GetSystemTimeAsFileTime(&ft);
+	return ((((unsigned long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime) - 116444736000000000ULL) / 10;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (unsigned long long)tv.tv_sec * 1000000ULL + tv.tv_usec;
+#endif
+}
+
+//after the file is closed, so nothing still buffered lands behind size
+static int __StreamTruncate(const char *path, unsigned long long size)
+{
+#ifdef _WIN32
+	int fd = -1;
+	if (0 != _sopen_s(&fd, path, _O_WRONLY | _O_BINARY, _SH_DENYNO, _S_IWRITE))		return -1;
+	int ret = (0 == _chsize_s(fd, (__int64)size)) ? 0 : -1;
+	_close(fd);
+	return ret;
+#else
+	return truncate(path, (off_t)size);
+#endif
+}
+
+//closes the file; after a failure it ends at the last record a flush wrote, as whatever came
+//later may be on disk only in part, and replay stops at a partial record even when looping
+static void __StreamClose(STREAM_TAP_T *pTap, int failed)
+{
+	if (0 != fclose(pTap->file))		failed = 1;
+	pTap->file = NULL;
+	if (failed)
+	{
+		pTap->errors ++;
+		__StreamTruncate(pTap->path, pTap->flushedBytes);
+	}
+}
+
+CStreamRecorder::CStreamRecorder(void)
+{
+	memset(tap, 0x00, sizeof(tap));
+	for (int i=0; i<STREAM_MAX_SOURCES; i++)		_VS_InitLock(&tap[i].lock);
+}
+
+CStreamRecorder::~CStreamRecorder(void)
+{
+	for (int i=0; i<STREAM_MAX_SOURCES; i++)
+	{
+		Stop(i);
+		_VS_DeinitLock(&tap[i].lock);
+	}
+}
+
+int CStreamRecorder::Start(int source, const char *path)
+{
+	if (source < 0 || source >= STREAM_MAX_SOURCES || NULL == path || strlen(path) >= STREAM_MAX_PATH)		return -1;
+
+	STREAM_TAP_T *pTap = &tap[source];
+	_VS_Lock(&pTap->lock);
+	if (NULL != pTap->file)
+	{
+		_VS_Unlock(&pTap->lock);
+		return -1;
+	}
+	pTap->file = fopen(path, "wb");
+	if (NULL == pTap->file)
+	{
+		_VS_Unlock(&pTap->lock);
+		return -1;
+	}
+	setvbuf(pTap->file, NULL, _IOFBF, STREAM_FILE_BUFFER);
+
+	STREAM_FILE_HEADER_T	header;
+	memset(&header, 0x00, sizeof(STREAM_FILE_HEADER_T));
+	header.magic		=	STREAM_FILE_MAGIC;
+	header.version		=	STREAM_FILE_VERSION;
+	header.infoSize		=	sizeof(RTSP_FRAME_INFO);
+	header.startTime	=	__StreamWallTime();
+	if (1 != fwrite(&header, sizeof(STREAM_FILE_HEADER_T), 1, pTap->file) || 0 != fflush(pTap->file))
+	{
+		fclose(pTap->file);
+		pTap->file = NULL;
+		_VS_Unlock(&pTap->lock);
+		return -1;
+	}
+
+	strcpy(pTap->path, path);
+	pTap->startNs		=	_VS_GetNs();
+	pTap->records		=	0;
+	pTap->errors		=	0;
+	pTap->flushedBytes	=	sizeof(STREAM_FILE_HEADER_T);
+	pTap->pendingBytes	=	0;
+	pTap->active		=	1;
+	_VS_Unlock(&pTap->lock);
+	return 0;
+}
+
+void CStreamRecorder::Stop(int source)
+{
+	if (source < 0 || source >= STREAM_MAX_SOURCES)		return;
+
+	STREAM_TAP_T *pTap = &tap[source];
+	_VS_Lock(&pTap->lock);
+	pTap->active = 0;
+	if (NULL != pTap->file)		__StreamClose(pTap, 0);
+	_VS_Unlock(&pTap->lock);
+}
+
+int CStreamRecorder::IsRecording(int source)
+{
+	if (source < 0 || source >= STREAM_MAX_SOURCES)		return 0;
+	return tap[source].active;
+}
+
+void CStreamRecorder::Write(int source, int frameType, const char *pBuf, const RTSP_FRAME_INFO *frameInfo)
+{
+	if (source < 0 || source >= STREAM_MAX_SOURCES || !tap[source].active)		return;
+
+	STREAM_RECORD_T	record;
+	memset(&record, 0x00, sizeof(STREAM_RECORD_T));
+	record.frameType	=	(unsigned int)frameType;
+	if (NULL != frameInfo)		record.flags |= STREAM_RECORD_INFO;
+	if (NULL != pBuf)
+	{
+		record.flags |= STREAM_RECORD_BUFFER;
+		if (frameType == EASY_SDK_MEDIA_INFO_FLAG)			record.payloadLength = sizeof(EASY_MEDIA_INFO_T);
+		else if (NULL != frameInfo)							record.payloadLength = frameInfo->length;
+		else if (frameType == EASY_SDK_SDP_FRAME_FLAG)		record.payloadLength = (unsigned int)strlen(pBuf) + 1;
+	}
+	if (record.payloadLength > STREAM_MAX_PAYLOAD)		return;
+
+	STREAM_TAP_T *pTap = &tap[source];
+	_VS_Lock(&pTap->lock);
+	if (NULL != pTap->file)
+	{
+		record.arrivalUs = (_VS_GetNs() - pTap->startNs) / 1000;
+		unsigned int size = sizeof(STREAM_RECORD_T) + (NULL != frameInfo ? sizeof(RTSP_FRAME_INFO) : 0) + record.payloadLength;
+
+		//flushed here rather than by the buffer filling up, so the records on disk are known
+		int ok = 1;
+		if (pTap->pendingBytes > 0 && pTap->pendingBytes + size > STREAM_FILE_BUFFER)
+		{
+			ok = (0 == fflush(pTap->file));
+			if (ok)
+			{
+				pTap->flushedBytes += pTap->pendingBytes;
+				pTap->pendingBytes = 0;
+			}
+		}
+		if (ok)										ok = (1 == fwrite(&record, sizeof(STREAM_RECORD_T), 1, pTap->file));
+		if (ok && NULL != frameInfo)				ok = (1 == fwrite(frameInfo, sizeof(RTSP_FRAME_INFO), 1, pTap->file));
+		if (ok && record.payloadLength > 0)			ok = (1 == fwrite(pBuf, record.payloadLength, 1, pTap->file));
+		if (ok)
+		{
+			pTap->records ++;
+			pTap->pendingBytes += size;
+		}
+		else
+		{
+			//disk full or gone
+			pTap->active = 0;
+			__StreamClose(pTap, 1);
+		}
+	}
+	_VS_Unlock(&pTap->lock);
+}
@@ -0,0 +1,79 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __STREAM_RECORDER_H__
+#define __STREAM_RECORDER_H__
+
+#include <stdio.h>
+#include "EasyRTSPClient/EasyTypes.h"
+#include "vslock.h"
+
+#define		STREAM_FILE_MAGIC		0x4D525453		//"STRM"
+#define		STREAM_FILE_VERSION		1
+#define		STREAM_MAX_SOURCES		64
+#define		STREAM_MAX_PATH			260
+#define		STREAM_MAX_PAYLOAD		(8*1024*1024)	//larger records are taken as a damaged file
+#define		STREAM_FILE_BUFFER		(512*1024)
+
+#define		STREAM_RECORD_INFO		0x01			//an RTSP_FRAME_INFO follows the record
+#define		STREAM_RECORD_BUFFER	0x02			//pBuf was not NULL, payloadLength bytes of it follow
+
+//the file: STREAM_FILE_HEADER_T, then for every source callback a STREAM_RECORD_T, the
+//RTSP_FRAME_INFO when STREAM_RECORD_INFO is set and the payload
+typedef struct __STREAM_FILE_HEADER_T
+{
+	unsigned int		magic;
+	unsigned int		version;
+	unsigned int		infoSize;		//sizeof(RTSP_FRAME_INFO) of the writer
+	unsigned int		reserved;
+	unsigned long long	startTime;		//wall clock of Start, us since 1970
+}STREAM_FILE_HEADER_T;
+
+typedef struct __STREAM_RECORD_T
+{
+	unsigned long long	arrivalUs;		//since Start
+	unsigned int		frameType;		//EASY_SDK_xxx_FLAG
+	unsigned int		flags;			//STREAM_RECORD_xxx
+	unsigned int		payloadLength;
+	unsigned int		reserved;
+}STREAM_RECORD_T;
+
+typedef struct __STREAM_TAP_T
+{
+	volatile int		active;			//read without the lock, so idle sources cost nothing
+	FILE				*file;
+	unsigned long long	startNs;		//_VS_GetNs of Start
+	unsigned int		records;
+	unsigned int		errors;			//write failures, the file is closed at the first
+	unsigned long long	flushedBytes;	//end of the records a flush has put on disk
+	unsigned int		pendingBytes;	//in the file buffer after them
+	char				path[STREAM_MAX_PATH];
+	VS_LOCK_T			lock;
+}STREAM_TAP_T;
+
+//Tap of the source callbacks: every frame, media info and event a channel's RTSP client
+//delivers is appended as it arrives, with its arrival time. CStreamReplayer plays it back
+class CStreamRecorder
+{
+public:
+	CStreamRecorder(void);
+	~CStreamRecorder(void);
+
+	//path is truncated; -1 if it cannot be created or source is already recording. A failed write
+	//stops the recording and cuts the file back to the last flushed record
+	int		Start(int source, const char *path);
+	void	Stop(int source);
+	int		IsRecording(int source);
+
+	//the source callback thread; mediaInfo frames carry an EASY_MEDIA_INFO_T in pBuf
+	void	Write(int source, int frameType, const char *pBuf, const RTSP_FRAME_INFO *frameInfo);
+
+protected:
+	STREAM_TAP_T	tap[STREAM_MAX_SOURCES];
+};
+
+#endif
@@ -0,0 +1,227 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "StreamReplayer.h"
+#include "vstime.h"
+#include <stdlib.h>
+#include <string.h>
+
+CStreamReplayer::CStreamReplayer(void)
+{
+	memset(source, 0x00, sizeof(source));
+	for (int i=0; i<STREAM_MAX_SOURCES; i++)
+	{
+		source[i].index	=	i;
+		source[i].owner	=	this;
+	}
+}
+
+CStreamReplayer::~CStreamReplayer(void)
+{
+	for (int i=0; i<STREAM_MAX_SOURCES; i++)		Stop(i);
+}
+
+int CStreamReplayer::Start(int _source, const char *path, int speed, int loop, STREAM_FEED_CALLBACK callback, void *userPtr)
+{
+	if (_source < 0 || _source >= STREAM_MAX_SOURCES || NULL == path || NULL == callback)		return -1;
+	if (speed < 0 || speed > STREAM_MAX_SPEED)		return -1;
+
+	STREAM_SOURCE_T *pSource = &source[_source];
+	if (pSource->state != STREAM_STATE_IDLE)		return -1;
+
+	FILE *f = fopen(path, "rb");
+	if (NULL == f)		return -1;
+	STREAM_FILE_HEADER_T	header;
+	if (1 != fread(&header, sizeof(STREAM_FILE_HEADER_T), 1, f) || header.magic != STREAM_FILE_MAGIC ||
+		header.version != STREAM_FILE_VERSION || header.infoSize != sizeof(RTSP_FRAME_INFO))
+	{
+		fclose(f);
+		return -1;
+	}
+	setvbuf(f, NULL, _IOFBF, STREAM_FILE_BUFFER);
+
+	pSource->file		=	f;
+	pSource->speed		=	speed;
+	pSource->loop		=	loop;
+	pSource->callback	=	callback;
+	pSource->userPtr	=	userPtr;
+	pSource->quit		=	0;
+	memset(&pSource->stats, 0x00, sizeof(STREAM_REPLAY_STATS_T));
+	pSource->state		=	STREAM_STATE_RUNNING;
+
+#ifdef _WIN32
+	pSource->hThread = CreateThread(NULL, 0, ReplayThread, pSource, 0, NULL);
+	int ready = (NULL != pSource->hThread);
+#else
+	pSource->threadValid = (0 == pthread_create(&pSource->thread, NULL, ReplayThread, pSource));
+	int ready = pSource->threadValid;
+#endif
+	if (!ready)
+	{
+		fclose(f);
+		pSource->file	=	NULL;
+		pSource->state	=	STREAM_STATE_IDLE;
+		return -1;
+	}
+	return 0;
+}
+
+void CStreamReplayer::Stop(int _source)
+{
+	if (_source < 0 || _source >= STREAM_MAX_SOURCES)		return;
+
+	STREAM_SOURCE_T *pSource = &source[_source];
+	if (pSource->state == STREAM_STATE_IDLE)		return;
+
+	pSource->quit = 1;
+#ifdef _WIN32
+	if (NULL != pSource->hThread)
+	{
+		WaitForSingleObject(pSource->hThread, INFINITE);
+		CloseHandle(pSource->hThread);
+		pSource->hThread = NULL;
+	}
+#else
+	if (pSource->threadValid)
+	{
+		pthread_join(pSource->thread, NULL);
+		pSource->threadValid = 0;
+	}
+#endif
+	if (NULL != pSource->file)
+	{
+		fclose(pSource->file);
+		pSource->file = NULL;
+	}
+	pSource->state = STREAM_STATE_IDLE;
+}
+
+int CStreamReplayer::GetStats(int _source, STREAM_REPLAY_STATS_T *stats)
+{
+	if (_source < 0 || _source >= STREAM_MAX_SOURCES)		return -1;
+
+	STREAM_SOURCE_T *pSource = &source[_source];
+	if (NULL != stats)
+	{
+		memcpy(stats, &pSource->stats, sizeof(STREAM_REPLAY_STATS_T));
+		stats->state = pSource->state;
+	}
+	return pSource->state;
+}
+
+#ifdef _WIN32
+DWORD WINAPI CStreamReplayer::ReplayThread(LPVOID lpParam)
+#else
+void *CStreamReplayer::ReplayThread(void *lpParam)
+#endif
+{
+	STREAM_SOURCE_T *pSource = (STREAM_SOURCE_T *)lpParam;
+	pSource->owner->Replay(pSource);
+	return 0;
+}
+
+long long CStreamReplayer::Wait(STREAM_SOURCE_T *pSource, unsigned long long deadlineNs)
+{
+	for (;;)
+	{
+		if (pSource->quit)		return -1;
+
+		unsigned long long now = _VS_GetNs();
+		if (deadlineNs > now && deadlineNs - now > STREAM_WAIT_SLICE_NS)
+		{
+			_VS_SleepUntilNs(now + STREAM_WAIT_SLICE_NS, 0);
+			continue;
+		}
+		//no spinning, a network delivers records with more jitter than the timer's 1ms
+		return _VS_SleepUntilNs(deadlineNs, 0) / 1000;
+	}
+}
+
+void CStreamReplayer::Replay(STREAM_SOURCE_T *pSource)
+{
+	char	*pPayload = NULL;
+	int		payloadSize = 0;
+	char	empty[4] = {0,};
+
+	//time line of the file: the first record plays at once, later ones at their distance from it
+	unsigned long long	startNs = _VS_GetNs();
+	long long			firstArrival = -1, lastArrival = 0, arrivalShift = 0;
+	long long			firstPts = -1, lastPts = 0, ptsShift = 0;
+
+	_VS_BEGIN_TIME_PERIOD(1);
+	while (!pSource->quit)
+	{
+		STREAM_RECORD_T	record;
+		if (1 != fread(&record, sizeof(STREAM_RECORD_T), 1, pSource->file))
+		{
+			if (!pSource->loop || firstArrival < 0)		break;
+
+			//next pass: arrival and PTS carry on from where this one ended
+			arrivalShift += lastArrival - firstArrival + STREAM_LOOP_GAP_US;
+			if (firstPts >= 0)		ptsShift += lastPts - firstPts + STREAM_LOOP_GAP_US;
+			pSource->stats.loops ++;
+			fseek(pSource->file, sizeof(STREAM_FILE_HEADER_T), SEEK_SET);
+			continue;
+		}
+		if (record.payloadLength > STREAM_MAX_PAYLOAD)		break;		//damaged
+
+		RTSP_FRAME_INFO	frameInfo;
+		if ((record.flags & STREAM_RECORD_INFO) && 1 != fread(&frameInfo, sizeof(RTSP_FRAME_INFO), 1, pSource->file))		break;
+		if ((int)record.payloadLength > payloadSize)
+		{
+			free(pPayload);
+			payloadSize	=	(int)record.payloadLength + (int)record.payloadLength / 4;
+			pPayload	=	(char *)malloc(payloadSize);
+			if (NULL == pPayload)		break;
+		}
+		if (record.payloadLength > 0 && 1 != fread(pPayload, record.payloadLength, 1, pSource->file))		break;
+
+		long long arrival = (long long)record.arrivalUs;
+		if (firstArrival < 0)		firstArrival = arrival;
+		lastArrival = arrival;
+
+		if ((record.flags & STREAM_RECORD_INFO) && (record.frameType == EASY_SDK_VIDEO_FRAME_FLAG || record.frameType == EASY_SDK_AUDIO_FRAME_FLAG))
+		{
+			long long pts = (long long)frameInfo.timestamp_sec * 1000000 + frameInfo.timestamp_usec;
+			if (pSource->stats.loops == 0)
+			{
+				if (firstPts < 0 || pts < firstPts)		firstPts = pts;
+				if (pts > lastPts)						lastPts = pts;
+			}
+			if (ptsShift > 0)
+			{
+				pts += ptsShift;
+				frameInfo.timestamp_sec		=	(unsigned int)(pts / 1000000);
+				frameInfo.timestamp_usec	=	(unsigned int)(pts % 1000000);
+			}
+		}
+
+		if (pSource->speed > 0)
+		{
+			unsigned long long offsetNs = (unsigned long long)(arrival - firstArrival + arrivalShift) * 1000ULL * STREAM_SPEED_REALTIME / pSource->speed;
+			long long late = Wait(pSource, startNs + offsetNs);
+			if (late < 0)		break;
+			if (late > pSource->stats.maxLateUs)		pSource->stats.maxLateUs = late;
+		}
+
+		char *pBuf = (record.flags & STREAM_RECORD_BUFFER) ? (record.payloadLength > 0 ? pPayload : empty) : NULL;
+		while (!pSource->quit)
+		{
+			if (STREAM_FEED_BUSY != pSource->callback(pSource->index, pSource->userPtr, (int)record.frameType, pBuf, (record.flags & STREAM_RECORD_INFO) ? &frameInfo : NULL))		break;
+			pSource->stats.busy ++;
+			__VS_Delay(1);
+		}
+		if (pSource->quit)		break;
+		pSource->stats.records ++;
+		pSource->stats.bytes += record.payloadLength;
+		if (record.frameType == EASY_SDK_VIDEO_FRAME_FLAG)		pSource->stats.videoFrames ++;
+	}
+	_VS_END_TIME_PERIOD(1);
+
+	free(pPayload);
+	pSource->state = STREAM_STATE_FINISHED;
+}
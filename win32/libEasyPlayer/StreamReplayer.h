@@ -0,0 +1,100 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __STREAM_REPLAYER_H__
+#define __STREAM_REPLAYER_H__
+
+#include "StreamRecorder.h"
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#define		STREAM_SPEED_FAST		0				//as fast as the callback takes the records
+#define		STREAM_SPEED_REALTIME	100				//percent of the recorded timing
+#define		STREAM_MAX_SPEED		10000
+#define		STREAM_LOOP_GAP_US		40000			//between the last record of a pass and the first of the next
+#define		STREAM_WAIT_SLICE_NS	100000000ULL	//longest sleep before looking at quit again
+
+#define		STREAM_FEED_OK			0
+#define		STREAM_FEED_BUSY		1				//from the callback: offer the same record again in 1ms
+
+#define		STREAM_STATE_IDLE		0
+#define		STREAM_STATE_RUNNING	1
+#define		STREAM_STATE_FINISHED	2				//end of file without loop, or a damaged record
+
+#ifdef _WIN32
+#define		STREAM_CALLTYPE			CALLBACK
+#else
+#define		STREAM_CALLTYPE
+#endif
+
+//called on the source's thread, with the record's arguments as the RTSP client gave them; pBuf
+//and frameInfo are valid until it returns and may be modified
+typedef int (STREAM_CALLTYPE *STREAM_FEED_CALLBACK)(int source, void *userPtr, int frameType, char *pBuf, RTSP_FRAME_INFO *frameInfo);
+
+typedef struct __STREAM_REPLAY_STATS_T
+{
+	int					state;			//STREAM_STATE_xxx
+	unsigned int		records;		//fed
+	unsigned int		videoFrames;
+	unsigned int		loops;
+	unsigned int		busy;			//STREAM_FEED_BUSY answers
+	unsigned long long	bytes;			//payload
+	long long			maxLateUs;		//worst wakeup after a record's time, paced speeds only
+}STREAM_REPLAY_STATS_T;
+
+typedef struct __STREAM_SOURCE_T
+{
+	volatile int		state;
+	volatile int		quit;
+	int					index;
+	class CStreamReplayer	*owner;
+	FILE				*file;
+	int					speed;
+	int					loop;
+	STREAM_FEED_CALLBACK	callback;
+	void				*userPtr;
+	STREAM_REPLAY_STATS_T	stats;
+#ifdef _WIN32
+	HANDLE				hThread;
+#else
+	pthread_t			thread;
+	int					threadValid;
+#endif
+}STREAM_SOURCE_T;
+
+//Plays files of CStreamRecorder back into a callback, each source on its own thread, so any
+//number of simulated channels can drive the pipeline without cameras. PTS keep increasing
+//across loops, each pass is shifted by the length of the previous ones
+class CStreamReplayer
+{
+public:
+	CStreamReplayer(void);
+	~CStreamReplayer(void);
+
+	//speed: STREAM_SPEED_REALTIME for the recorded timing, 200 twice as fast..., STREAM_SPEED_FAST
+	//for no waits. -1 if source is in use, finished ones too until Stop, or path is not a stream file
+	int		Start(int source, const char *path, int speed, int loop, STREAM_FEED_CALLBACK callback, void *userPtr);
+	//waits for the source's thread, the callback is not called after it returns
+	void	Stop(int source);
+	//STREAM_STATE_xxx, -1 for a bad source
+	int		GetStats(int source, STREAM_REPLAY_STATS_T *stats);
+
+protected:
+	STREAM_SOURCE_T		source[STREAM_MAX_SOURCES];
+
+#ifdef _WIN32
+	static DWORD WINAPI	ReplayThread(LPVOID lpParam);
+#else
+	static void *		ReplayThread(void *param);
+#endif
+	void	Replay(STREAM_SOURCE_T *pSource);
+	//paced speeds: sleeps until deadlineNs in slices, returns how late it woke, -1 on quit
+	long long	Wait(STREAM_SOURCE_T *pSource, unsigned long long deadlineNs);
+};
+
+#endif
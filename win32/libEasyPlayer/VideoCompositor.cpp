@@ -0,0 +1,326 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "VideoCompositor.h"
+#include "vssimd.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static void __FillRow(unsigned int *pDst, int n, unsigned int color)
+{
+	int x = 0;
+#if defined(__VS_SSE2)
+	__m128i c = _mm_set1_epi32((int)color);
+	for (; x+8<=n; x+=8)
+	{
+		_mm_storeu_si128((__m128i*)(pDst+x), c);
+		_mm_storeu_si128((__m128i*)(pDst+x+4), c);
+	}
+#elif defined(__VS_NEON)
+	uint32x4_t c = vdupq_n_u32(color);
+	for (; x+8<=n; x+=8)
+	{
+		vst1q_u32(pDst+x, c);
+		vst1q_u32(pDst+x+4, c);
+	}
+#endif
+	for (; x<n; x++)	pDst[x] = color;
+}
+
+static void __ClipRect(VCOMP_RECT_T *rect, int width, int height)
+{
+	int x1 = rect->x + rect->width;
+	int y1 = rect->y + rect->height;
+	if (rect->x < 0)	rect->x = 0;
+	if (rect->y < 0)	rect->y = 0;
+	if (x1 > width)		x1 = width;
+	if (y1 > height)	y1 = height;
+	rect->width		=	x1 > rect->x ? x1 - rect->x : 0;
+	rect->height	=	y1 > rect->y ? y1 - rect->y : 0;
+}
+
+
+CVideoCompositor::CVideoCompositor(void)
+{
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	filter		=	VC_FILTER_AREA;
+	bkColor		=	VCOMP_DEFAULT_BKCOLOR;
+	pCanvas		=	NULL;
+	width		=	0;
+	height		=	0;
+	stride		=	0;
+	tiles		=	0;
+	gridGap		=	VCOMP_DEFAULT_GAP;
+	fullDirty	=	0;
+	memset(layoutRect, 0x00, sizeof(layoutRect));
+	memset(tile, 0x00, sizeof(tile));
+	for (int i=0; i<VCOMP_MAX_TILES; i++)	_VS_InitLock(&lock[i]);
+}
+
+CVideoCompositor::~CVideoCompositor(void)
+{
+	Deinit();
+	for (int i=0; i<VCOMP_MAX_TILES; i++)	_VS_DeinitLock(&lock[i]);
+}
+
+int		CVideoCompositor::Init(VC_COLORSPACE colorspace, VC_RANGE range)
+{
+	Deinit();
+	VC_InitMatrix(&matrix, colorspace, range);
+	return 0;
+}
+
+void	CVideoCompositor::Deinit()
+{
+	LockAll();
+	if (NULL != pCanvas)
+	{
+		free(pCanvas);
+		pCanvas = NULL;
+	}
+	width		=	0;
+	height		=	0;
+	stride		=	0;
+	fullDirty	=	0;
+	memset(tile, 0x00, sizeof(tile));
+	UnlockAll();
+}
+
+void	CVideoCompositor::LockAll()
+{
+	for (int i=0; i<VCOMP_MAX_TILES; i++)	_VS_Lock(&lock[i]);
+}
+
+void	CVideoCompositor::UnlockAll()
+{
+	for (int i=VCOMP_MAX_TILES-1; i>=0; i--)	_VS_Unlock(&lock[i]);
+}
+
+void	CVideoCompositor::FillRect(const VCOMP_RECT_T *rect)
+{
+	for (int y=0; y<rect->height; y++)
+	{
+		__FillRow((unsigned int *)(pCanvas + (size_t)(rect->y + y) * stride) + rect->x, rect->width, bkColor);
+	}
+}
+
+//all locks held: places the tiles and paints the whole canvas with the background
+void	CVideoCompositor::Layout()
+{
+	if (gridGap >= 0 && tiles > 0)
+	{
+		int cols = (int)ceil(sqrt((double)tiles));
+		int rows = (tiles + cols - 1) / cols;
+		for (int i=0; i<tiles; i++)
+		{
+			int col = i % cols, row = i / cols;
+			VCOMP_RECT_T *r = &tile[i].rect;
+			r->x		=	col * (width + gridGap) / cols;
+			r->y		=	row * (height + gridGap) / rows;
+			r->width	=	(col+1) * (width + gridGap) / cols - gridGap - r->x;
+			r->height	=	(row+1) * (height + gridGap) / rows - gridGap - r->y;
+			__ClipRect(r, width, height);
+		}
+	}
+	else
+	{
+		for (int i=0; i<tiles; i++)
+		{
+			tile[i].rect = layoutRect[i];
+			__ClipRect(&tile[i].rect, width, height);
+		}
+	}
+
+	for (int i=0; i<VCOMP_MAX_TILES; i++)
+	{
+		memset(&tile[i].content, 0x00, sizeof(VCOMP_RECT_T));
+		tile[i].dirty = 0;
+		if (i >= tiles)		memset(&tile[i].rect, 0x00, sizeof(VCOMP_RECT_T));
+	}
+
+	if (NULL == pCanvas)	return;
+	VCOMP_RECT_T all = {0, 0, width, height};
+	FillRect(&all);
+	fullDirty = 1;
+}
+
+int		CVideoCompositor::Resize(int _width, int _height)
+{
+	if (_width < 1 || _height < 1)		return -1;
+
+	int _stride = (_width * 4 + 15) & ~15;
+	unsigned char *pBuf = (unsigned char *)malloc((size_t)_stride * _height);
+	if (NULL == pBuf)					return -1;
+
+	LockAll();
+	if (NULL != pCanvas)	free(pCanvas);
+	pCanvas	=	pBuf;
+	width	=	_width;
+	height	=	_height;
+	stride	=	_stride;
+	Layout();
+	UnlockAll();
+	return 0;
+}
+
+int		CVideoCompositor::SetLayout(int _tiles, int gap)
+{
+	if (_tiles < 1 || _tiles > VCOMP_MAX_TILES)		return -1;
+
+	LockAll();
+	tiles	=	_tiles;
+	gridGap	=	gap > 0 ? gap : 0;
+	Layout();
+	UnlockAll();
+	return 0;
+}
+
+int		CVideoCompositor::SetLayout(const VCOMP_RECT_T *rects, int _tiles)
+{
+	if (NULL == rects || _tiles < 1 || _tiles > VCOMP_MAX_TILES)		return -1;
+
+	LockAll();
+	tiles	=	_tiles;
+	gridGap	=	-1;
+	memcpy(layoutRect, rects, sizeof(VCOMP_RECT_T) * _tiles);
+	Layout();
+	UnlockAll();
+	return 0;
+}
+
+int		CVideoCompositor::GetTileRect(int _tile, VCOMP_RECT_T *rect)
+{
+	if (_tile < 0 || _tile >= VCOMP_MAX_TILES || NULL == rect)		return -1;
+
+	_VS_Lock(&lock[_tile]);
+	int ret = _tile < tiles ? 0 : -1;
+	if (ret == 0)	*rect = tile[_tile].rect;
+	_VS_Unlock(&lock[_tile]);
+	return ret;
+}
+
+void	CVideoCompositor::SetBackground(unsigned int _bkColor)
+{
+	LockAll();
+	bkColor = _bkColor;
+	Layout();
+	UnlockAll();
+}
+
+int		CVideoCompositor::UpdateTile(int _tile, const VC_FRAME_T *frame, int shownToScale, CVideoOsd *pOsd)
+{
+	if (_tile < 0 || _tile >= VCOMP_MAX_TILES || NULL == frame)		return -1;
+	if (frame->width < 1 || frame->height < 1)						return -1;
+
+	_VS_Lock(&lock[_tile]);
+	if (_tile >= tiles || NULL == pCanvas)
+	{
+		_VS_Unlock(&lock[_tile]);
+		return -1;
+	}
+
+	VCOMP_TILE_T *t = &tile[_tile];
+	VCOMP_RECT_T content = t->rect;
+	if (shownToScale)
+	{
+		if ((long long)content.width * frame->height > (long long)content.height * frame->width)
+			content.width = (int)((long long)content.height * frame->width / frame->height);
+		else
+			content.height = (int)((long long)content.width * frame->height / frame->width);
+		content.x += (t->rect.width - content.width) / 2;
+		content.y += (t->rect.height - content.height) / 2;
+	}
+	if (content.width < 1 || content.height < 1)
+	{
+		_VS_Unlock(&lock[_tile]);
+		return 0;
+	}
+
+	//a frame of another aspect leaves old pixels around it
+	if (0 != memcmp(&content, &t->content, sizeof(VCOMP_RECT_T)))
+	{
+		FillRect(&t->rect);
+		t->content = content;
+	}
+
+	VC_FRAME_T dst;
+	memset(&dst, 0x00, sizeof(VC_FRAME_T));
+	dst.format		=	VC_FORMAT_BGRA;
+	dst.width		=	content.width;
+	dst.height		=	content.height;
+	dst.plane[0]	=	pCanvas + (size_t)content.y * stride + content.x * 4;
+	dst.stride[0]	=	stride;
+	int ret = VC_ScaleRows(frame, &dst, &matrix, filter, 0, content.height);
+	if (ret == 0 && NULL != pOsd)	pOsd->Blend(&dst, 2, 2);
+	t->dirty = 1;
+	_VS_Unlock(&lock[_tile]);
+	return ret;
+}
+
+int		CVideoCompositor::ClearTile(int _tile)
+{
+	if (_tile < 0 || _tile >= VCOMP_MAX_TILES)		return -1;
+
+	_VS_Lock(&lock[_tile]);
+	int ret = (_tile < tiles && NULL != pCanvas) ? 0 : -1;
+	if (ret == 0 && tile[_tile].content.width > 0)
+	{
+		FillRect(&tile[_tile].rect);
+		memset(&tile[_tile].content, 0x00, sizeof(VCOMP_RECT_T));
+		tile[_tile].dirty = 1;
+	}
+	_VS_Unlock(&lock[_tile]);
+	return ret;
+}
+
+void	CVideoCompositor::Invalidate()
+{
+	LockAll();
+	if (NULL != pCanvas)	fullDirty = 1;
+	UnlockAll();
+}
+
+int		CVideoCompositor::Present(VCOMP_PRESENT_CALLBACK callback, void *userPtr)
+{
+	if (NULL == callback)		return -1;
+
+	//it is only set with every lock held
+	_VS_Lock(&lock[0]);
+	int full = fullDirty;
+	_VS_Unlock(&lock[0]);
+
+	int rects = 0;
+	if (full)
+	{
+		LockAll();
+		if (NULL != pCanvas)
+		{
+			VCOMP_RECT_T all = {0, 0, width, height};
+			callback(userPtr, pCanvas, stride, &all);
+			rects ++;
+		}
+		fullDirty = 0;
+		for (int i=0; i<VCOMP_MAX_TILES; i++)	tile[i].dirty = 0;
+		UnlockAll();
+		return rects;
+	}
+
+	//a tile stays locked while it is shown, so it never goes out half written
+	for (int i=0; i<VCOMP_MAX_TILES; i++)
+	{
+		_VS_Lock(&lock[i]);
+		if (i < tiles && tile[i].dirty && NULL != pCanvas)
+		{
+			callback(userPtr, pCanvas, stride, &tile[i].rect);
+			tile[i].dirty = 0;
+			rects ++;
+		}
+		_VS_Unlock(&lock[i]);
+	}
+	return rects;
+}
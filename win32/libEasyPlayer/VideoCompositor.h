@@ -0,0 +1,98 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VIDEO_COMPOSITOR_H__
+#define __VIDEO_COMPOSITOR_H__
+
+#include "VideoConverter.h"
+#include "VideoOsd.h"
+#include "vslock.h"
+
+#define		VCOMP_MAX_TILES			64
+#define		VCOMP_DEFAULT_GAP		2				//pixels between grid tiles
+#define		VCOMP_DEFAULT_BKCOLOR	0xFF3C3C3C		//BGRA as a little endian word, the GDI renderer's background
+
+typedef struct __VCOMP_RECT_T
+{
+	int		x;
+	int		y;
+	int		width;
+	int		height;
+}VCOMP_RECT_T;
+
+typedef struct __VCOMP_TILE_T
+{
+	VCOMP_RECT_T	rect;			//the tile in the canvas
+	VCOMP_RECT_T	content;		//where the last frame went inside it, empty while it shows background
+	int				dirty;			//changed since the last Present
+}VCOMP_TILE_T;
+
+//gets each rect Present hands out; pCanvas is the top left of the whole canvas
+typedef void (*VCOMP_PRESENT_CALLBACK)(void *userPtr, const unsigned char *pCanvas, int stride, const VCOMP_RECT_T *rect);
+
+//One BGRA canvas shared by many channels: each frame is scaled and converted straight into
+//its tile, and Present only hands out the tiles that changed. UpdateTile may be called from
+//every channel's thread at once, each tile is locked on its own
+class CVideoCompositor
+{
+public:
+	CVideoCompositor(void);
+	~CVideoCompositor(void);
+
+	int		Init(VC_COLORSPACE colorspace, VC_RANGE range);
+	void	Deinit();
+
+	//reallocates the canvas and lays the tiles out again, all of it dirty
+	int		Resize(int width, int height);
+	//tiles in a near square grid filling the canvas, e.g. 4, 9, 16, 36 or 64
+	int		SetLayout(int tiles, int gap=VCOMP_DEFAULT_GAP);
+	//or any rects, clipped to the canvas; a later Resize keeps them as they are
+	int		SetLayout(const VCOMP_RECT_T *rects, int tiles);
+	int		GetTileRect(int tile, VCOMP_RECT_T *rect);
+	void	SetBackground(unsigned int _bkColor);
+	void	SetFilter(VC_FILTER _filter)	{filter = _filter;}
+
+	//a YUV420P or YV12 frame into the tile, aspect fitted with background around it if shownToScale;
+	//pOsd, if given, is blended onto the scaled picture before the tile is unlocked
+	int		UpdateTile(int tile, const VC_FRAME_T *frame, int shownToScale, CVideoOsd *pOsd=NULL);
+	int		ClearTile(int tile);
+	//the next Present hands out the whole canvas, e.g. after the window was uncovered
+	void	Invalidate();
+
+	//calls callback for the whole canvas after a resize or relayout, otherwise for each
+	//dirty tile, and marks them clean. Returns the number of rects
+	int		Present(VCOMP_PRESENT_CALLBACK callback, void *userPtr);
+
+	int		GetWidth()		{return width;}
+	int		GetHeight()		{return height;}
+	int		GetTiles()		{return tiles;}
+
+protected:
+	VC_MATRIX_T		matrix;
+	VC_FILTER		filter;
+	unsigned int	bkColor;
+
+	unsigned char	*pCanvas;
+	int				width;
+	int				height;
+	int				stride;
+
+	int				tiles;
+	int				gridGap;		//-1 for a layout of explicit rects
+	VCOMP_RECT_T	layoutRect[VCOMP_MAX_TILES];	//the explicit rects as given
+	int				fullDirty;
+	VCOMP_TILE_T	tile[VCOMP_MAX_TILES];
+	//a tile's lock guards its pixels and state, layout changes hold all of them
+	VS_LOCK_T		lock[VCOMP_MAX_TILES];
+
+	void	LockAll();
+	void	UnlockAll();
+	void	Layout();
+	void	FillRect(const VCOMP_RECT_T *rect);
+};
+
+#endif
@@ -0,0 +1,1231 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "VideoConverter.h"
+#include "vssimd.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define		VC_ROUND		(1<<(VC_COEF_SHIFT-1))
+
+static inline int __Clamp255(int v)
+{
+	return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+//madd coefficient pair: lo multiplies the even int16, hi the odd one
+static inline int __Pair(int lo, int hi)
+{
+	return (int)(((unsigned int)(unsigned short)hi << 16) | (unsigned short)lo);
+}
+
+void	VC_InitMatrix(VC_MATRIX_T *matrix, VC_COLORSPACE colorspace, VC_RANGE range)
+{
+	if (NULL == matrix)		return;
+
+	double kr = 0.299, kb = 0.114;
+	if (colorspace == VC_COLORSPACE_BT709)
+	{
+		kr = 0.2126;
+		kb = 0.0722;
+	}
+	double kg = 1.0 - kr - kb;
+
+	double ys = 1.0, cs = 1.0;
+	matrix->yOffset = 0;
+	if (range == VC_RANGE_LIMITED)
+	{
+		ys = 255.0 / 219.0;
+		cs = 255.0 / 224.0;
+		matrix->yOffset = 16;
+	}
+
+	double one = (double)(1<<VC_COEF_SHIFT);
+	matrix->cy	= (short)floor(ys * one + 0.5);
+	matrix->crv	= (short)floor(cs * 2.0 * (1.0-kr) * one + 0.5);
+	matrix->cbu	= (short)floor(cs * 2.0 * (1.0-kb) * one + 0.5);
+	matrix->cgu	= (short)floor(cs * 2.0 * (1.0-kb) * kb / kg * one + 0.5);
+	matrix->cgv	= (short)floor(cs * 2.0 * (1.0-kr) * kr / kg * one + 0.5);
+}
+
+int		VC_FrameSize(VC_FORMAT format, int width, int height)
+{
+	if (width < 1 || height < 1)	return 0;
+
+	int cw = (width+1)/2;
+	switch (format)
+	{
+	case VC_FORMAT_YUV420P:
+	case VC_FORMAT_YV12:	return width*height + 2*cw*((height+1)/2);
+	case VC_FORMAT_YUY2:
+	case VC_FORMAT_UYVY:	return cw*4*height;
+	case VC_FORMAT_BGRA:	return width*4*height;
+	case VC_FORMAT_RGB565:
+	case VC_FORMAT_RGB555:	return width*2*height;
+	case VC_FORMAT_BGR24:	return width*3*height;
+	}
+	return 0;
+}
+
+int		VC_FillFrame(VC_FRAME_T *frame, VC_FORMAT format, int width, int height, unsigned char *pBuf)
+{
+	if (NULL == frame)		return 0;
+
+	memset(frame, 0x00, sizeof(VC_FRAME_T));
+	int size = VC_FrameSize(format, width, height);
+	if (size < 1)			return 0;
+
+	frame->format	=	format;
+	frame->width	=	width;
+	frame->height	=	height;
+	frame->plane[0]	=	pBuf;
+	frame->stride[0]=	size / height;
+	if (format == VC_FORMAT_YUV420P || format == VC_FORMAT_YV12)
+	{
+		int cw = (width+1)/2;
+		frame->stride[0]	=	width;
+		frame->stride[1]	=	cw;
+		frame->stride[2]	=	cw;
+		frame->plane[1]		=	pBuf + width*height;
+		frame->plane[2]		=	frame->plane[1] + cw*((height+1)/2);
+	}
+	return size;
+}
+
+int		VC_CropFrame(const VC_FRAME_T *src, VC_FRAME_T *dst, int x, int y, int width, int height)
+{
+	if (NULL == src || NULL == dst)		return -1;
+	if (src->format != VC_FORMAT_YUV420P && src->format != VC_FORMAT_YV12)		return -1;
+
+	int x1 = x + width, y1 = y + height;
+	if (x < 0)	x = 0;
+	if (y < 0)	y = 0;
+	x &= ~1;
+	y &= ~1;
+	x1 = (x1 + 1) & ~1;
+	y1 = (y1 + 1) & ~1;
+	if (x1 > src->width)	x1 = src->width;
+	if (y1 > src->height)	y1 = src->height;
+	if (x1 - x < 2 || y1 - y < 2)		return -1;
+
+	VC_FRAME_T frame = *src;		//dst may be src
+	frame.width		=	x1 - x;
+	frame.height	=	y1 - y;
+	frame.plane[0]	+=	(size_t)y * frame.stride[0] + x;
+	frame.plane[1]	+=	(size_t)(y>>1) * frame.stride[1] + (x>>1);
+	frame.plane[2]	+=	(size_t)(y>>1) * frame.stride[2] + (x>>1);
+	*dst = frame;
+	return 0;
+}
+
+int		VC_RenderRoi(int left, int top, int right, int bottom, int width, int height, int *roi)
+{
+	if (NULL == roi || right <= left || bottom <= top)		return 0;
+
+	left	=	(left > 0 ? left : 0) & ~1;
+	top		=	(top > 0 ? top : 0) & ~1;
+	right	=	(right + 1) & ~1;
+	bottom	=	(bottom + 1) & ~1;
+	if (right > width)		right = width;
+	if (bottom > height)	bottom = height;
+	if (right - left < 16 || bottom - top < 16)		return 0;
+	if (left == 0 && top == 0 && right == width && bottom == height)		return 0;
+
+	roi[0]	=	left;
+	roi[1]	=	top;
+	roi[2]	=	right;
+	roi[3]	=	bottom;
+	return 1;
+}
+
+//scalar reference, pixels [x, width)
+static void __RowRgbC(const unsigned char *pY, const unsigned char *pU, const unsigned char *pV, unsigned char *pDst,
+					  int x, int width, VC_FORMAT format, const VC_MATRIX_T *m)
+{
+	for (; x<width; x++)
+	{
+		int u = pU[x>>1] - 128;
+		int v = pV[x>>1] - 128;
+		int t = m->cy * (pY[x] - m->yOffset) + VC_ROUND;
+		int r = __Clamp255((t + m->crv * v) >> VC_COEF_SHIFT);
+		int g = __Clamp255((t - m->cgu * u - m->cgv * v) >> VC_COEF_SHIFT);
+		int b = __Clamp255((t + m->cbu * u) >> VC_COEF_SHIFT);
+
+		switch (format)
+		{
+		case VC_FORMAT_BGRA:
+			pDst[x*4]	=	(unsigned char)b;
+			pDst[x*4+1]	=	(unsigned char)g;
+			pDst[x*4+2]	=	(unsigned char)r;
+			pDst[x*4+3]	=	0xFF;
+			break;
+		case VC_FORMAT_BGR24:
+			pDst[x*3]	=	(unsigned char)b;
+			pDst[x*3+1]	=	(unsigned char)g;
+			pDst[x*3+2]	=	(unsigned char)r;
+			break;
+		case VC_FORMAT_RGB565:
+			((unsigned short *)pDst)[x] = (unsigned short)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+			break;
+		case VC_FORMAT_RGB555:
+			((unsigned short *)pDst)[x] = (unsigned short)(((r & 0xF8) << 7) | ((g & 0xF8) << 2) | (b >> 3));
+			break;
+		default:
+			return;
+		}
+	}
+}
+
+//scalar reference, pixels [x, width), x even; an odd last pixel repeats its luma
+static void __Row422C(const unsigned char *pY, const unsigned char *pU, const unsigned char *pV, unsigned char *pDst,
+					  int x, int width, VC_FORMAT format)
+{
+	for (; x<width; x+=2)
+	{
+		unsigned char y0 = pY[x];
+		unsigned char y1 = x+1 < width ? pY[x+1] : y0;
+		unsigned char *p = pDst + x*2;
+		if (format == VC_FORMAT_YUY2)
+		{
+			p[0] = y0;	p[1] = pU[x>>1];	p[2] = y1;	p[3] = pV[x>>1];
+		}
+		else
+		{
+			p[0] = pU[x>>1];	p[1] = y0;	p[2] = pV[x>>1];	p[3] = y1;
+		}
+	}
+}
+
+#if defined(__VS_SSE2)
+typedef struct __VC_K128_T
+{
+	__m128i	zero;
+	__m128i	yOffset;
+	__m128i	c128;
+	__m128i	one;
+	__m128i	max255;
+	__m128i	rnd;			//epi32
+	__m128i	kR;				//(cy, crv)
+	__m128i	kG;				//(cy, -cgu)
+	__m128i	kGV;			//(-cgv, round) against (V', 1)
+	__m128i	kB;				//(cy, cbu)
+	__m128i	alpha;
+	__m128i	mask5;
+	__m128i	mask6;
+}VC_K128_T;
+
+static void __InitK128(VC_K128_T *k, const VC_MATRIX_T *m)
+{
+	k->zero		=	_mm_setzero_si128();
+	k->yOffset	=	_mm_set1_epi16(m->yOffset);
+	k->c128		=	_mm_set1_epi16(128);
+	k->one		=	_mm_set1_epi16(1);
+	k->max255	=	_mm_set1_epi16(255);
+	k->rnd		=	_mm_set1_epi32(VC_ROUND);
+	k->kR		=	_mm_set1_epi32(__Pair(m->cy, m->crv));
+	k->kG		=	_mm_set1_epi32(__Pair(m->cy, -m->cgu));
+	k->kGV		=	_mm_set1_epi32(__Pair(-m->cgv, VC_ROUND));
+	k->kB		=	_mm_set1_epi32(__Pair(m->cy, m->cbu));
+	k->alpha	=	_mm_set1_epi16((short)0xFF00);
+	k->mask5	=	_mm_set1_epi16(0xF8);
+	k->mask6	=	_mm_set1_epi16(0xFC);
+}
+#endif
+
+#if defined(__VS_AVX2)
+typedef struct __VC_K256_T
+{
+	__m256i	zero;
+	__m256i	yOffset;
+	__m256i	c128;
+	__m256i	one;
+	__m256i	max255;
+	__m256i	rnd;
+	__m256i	kR;
+	__m256i	kG;
+	__m256i	kGV;
+	__m256i	kB;
+	__m256i	alpha;
+	__m256i	mask5;
+	__m256i	mask6;
+}VC_K256_T;
+
+__VS_TARGET_AVX2 static void __InitK256(VC_K256_T *k, const VC_MATRIX_T *m)
+{
+	k->zero		=	_mm256_setzero_si256();
+	k->yOffset	=	_mm256_set1_epi16(m->yOffset);
+	k->c128		=	_mm256_set1_epi16(128);
+	k->one		=	_mm256_set1_epi16(1);
+	k->max255	=	_mm256_set1_epi16(255);
+	k->rnd		=	_mm256_set1_epi32(VC_ROUND);
+	k->kR		=	_mm256_set1_epi32(__Pair(m->cy, m->crv));
+	k->kG		=	_mm256_set1_epi32(__Pair(m->cy, -m->cgu));
+	k->kGV		=	_mm256_set1_epi32(__Pair(-m->cgv, VC_ROUND));
+	k->kB		=	_mm256_set1_epi32(__Pair(m->cy, m->cbu));
+	k->alpha	=	_mm256_set1_epi16((short)0xFF00);
+	k->mask5	=	_mm256_set1_epi16(0xF8);
+	k->mask6	=	_mm256_set1_epi16(0xFC);
+}
+
+//16 pixels, y u v as int16 with the offsets removed; unpack and pack stay within
+//the 128 bit lanes, so r g b come back in pixel order
+__VS_TARGET_AVX2 static inline void __Rgb16(const VC_K256_T *k, __m256i y, __m256i u, __m256i v, __m256i *r, __m256i *g, __m256i *b)
+{
+	__m256i yvL = _mm256_unpacklo_epi16(y, v), yvH = _mm256_unpackhi_epi16(y, v);
+	__m256i yuL = _mm256_unpacklo_epi16(y, u), yuH = _mm256_unpackhi_epi16(y, u);
+	__m256i v1L = _mm256_unpacklo_epi16(v, k->one), v1H = _mm256_unpackhi_epi16(v, k->one);
+
+	__m256i rL = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvL, k->kR), k->rnd), VC_COEF_SHIFT);
+	__m256i rH = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvH, k->kR), k->rnd), VC_COEF_SHIFT);
+	__m256i gL = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuL, k->kG), _mm256_madd_epi16(v1L, k->kGV)), VC_COEF_SHIFT);
+	__m256i gH = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuH, k->kG), _mm256_madd_epi16(v1H, k->kGV)), VC_COEF_SHIFT);
+	__m256i bL = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuL, k->kB), k->rnd), VC_COEF_SHIFT);
+	__m256i bH = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuH, k->kB), k->rnd), VC_COEF_SHIFT);
+
+	*r = _mm256_min_epi16(_mm256_max_epi16(_mm256_packs_epi32(rL, rH), k->zero), k->max255);
+	*g = _mm256_min_epi16(_mm256_max_epi16(_mm256_packs_epi32(gL, gH), k->zero), k->max255);
+	*b = _mm256_min_epi16(_mm256_max_epi16(_mm256_packs_epi32(bL, bH), k->zero), k->max255);
+}
+
+__VS_TARGET_AVX2 static int __RowRgbAvx2(const unsigned char *pY, const unsigned char *pU, const unsigned char *pV, unsigned char *pDst,
+						int width, VC_FORMAT format, const VC_MATRIX_T *m)
+{
+	VC_K256_T k;
+	__InitK256(&k, m);
+
+	int x = 0;
+	for (; x+16<=width; x+=16)
+	{
+		__m128i u8 = _mm_loadl_epi64((const __m128i *)(pU + (x>>1)));
+		__m128i v8 = _mm_loadl_epi64((const __m128i *)(pV + (x>>1)));
+		__m256i y = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(pY + x))), k.yOffset);
+		__m256i u = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8)), k.c128);
+		__m256i v = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8)), k.c128);
+
+		__m256i r, g, b;
+		__Rgb16(&k, y, u, v, &r, &g, &b);
+
+		if (format == VC_FORMAT_BGRA || format == VC_FORMAT_BGR24)
+		{
+			__m256i bg = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+			__m256i ra = _mm256_or_si256(r, k.alpha);
+			__m256i lo = _mm256_unpacklo_epi16(bg, ra);		//pixels 0-3, 8-11
+			__m256i hi = _mm256_unpackhi_epi16(bg, ra);		//pixels 4-7, 12-15
+			__m256i p0 = _mm256_permute2x128_si256(lo, hi, 0x20);
+			__m256i p1 = _mm256_permute2x128_si256(lo, hi, 0x31);
+			if (format == VC_FORMAT_BGRA)
+			{
+				_mm256_storeu_si256((__m256i *)(pDst + x*4), p0);
+				_mm256_storeu_si256((__m256i *)(pDst + x*4 + 32), p1);
+			}
+			else
+			{
+				__VS_ALIGN16 unsigned char bgra[64];
+				_mm256_store_si256((__m256i *)bgra, p0);
+				_mm256_store_si256((__m256i *)(bgra + 32), p1);
+				unsigned char *p = pDst + x*3;
+				for (int i=0; i<16; i++, p+=3)
+				{
+					p[0] = bgra[i*4];	p[1] = bgra[i*4+1];	p[2] = bgra[i*4+2];
+				}
+			}
+		}
+		else
+		{
+			__m256i rgb;
+			if (format == VC_FORMAT_RGB565)
+			{
+				rgb = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(r, k.mask5), 8),
+					_mm256_slli_epi16(_mm256_and_si256(g, k.mask6), 3)), _mm256_srli_epi16(b, 3));
+			}
+			else
+			{
+				rgb = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(r, k.mask5), 7),
+					_mm256_slli_epi16(_mm256_and_si256(g, k.mask5), 2)), _mm256_srli_epi16(b, 3));
+			}
+			_mm256_storeu_si256((__m256i *)(pDst + x*2), rgb);
+		}
+	}
+	_mm256_zeroupper();
+	return x;
+}
+#endif
+
+#if defined(__VS_SSE2)
+//8 pixels, y u v as int16 with the offsets removed
+static inline void __Rgb8(const VC_K128_T *k, __m128i y, __m128i u, __m128i v, __m128i *r, __m128i *g, __m128i *b)
+{
+	__m128i yvL = _mm_unpacklo_epi16(y, v), yvH = _mm_unpackhi_epi16(y, v);
+	__m128i yuL = _mm_unpacklo_epi16(y, u), yuH = _mm_unpackhi_epi16(y, u);
+	__m128i v1L = _mm_unpacklo_epi16(v, k->one), v1H = _mm_unpackhi_epi16(v, k->one);
+
+	__m128i rL = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvL, k->kR), k->rnd), VC_COEF_SHIFT);
+	__m128i rH = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvH, k->kR), k->rnd), VC_COEF_SHIFT);
+	__m128i gL = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuL, k->kG), _mm_madd_epi16(v1L, k->kGV)), VC_COEF_SHIFT);
+	__m128i gH = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuH, k->kG), _mm_madd_epi16(v1H, k->kGV)), VC_COEF_SHIFT);
+	__m128i bL = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuL, k->kB), k->rnd), VC_COEF_SHIFT);
+	__m128i bH = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuH, k->kB), k->rnd), VC_COEF_SHIFT);
+
+	*r = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(rL, rH), k->zero), k->max255);
+	*g = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(gL, gH), k->zero), k->max255);
+	*b = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(bL, bH), k->zero), k->max255);
+}
+
+static inline void __StoreRgb8(const VC_K128_T *k, unsigned char *pDst, VC_FORMAT format, __m128i r, __m128i g, __m128i b)
+{
+	if (format == VC_FORMAT_BGRA || format == VC_FORMAT_BGR24)
+	{
+		__m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+		__m128i ra = _mm_or_si128(r, k->alpha);
+		if (format == VC_FORMAT_BGRA)
+		{
+			_mm_storeu_si128((__m128i *)pDst, _mm_unpacklo_epi16(bg, ra));
+			_mm_storeu_si128((__m128i *)(pDst + 16), _mm_unpackhi_epi16(bg, ra));
+		}
+		else
+		{
+			__VS_ALIGN16 unsigned char bgra[32];
+			_mm_store_si128((__m128i *)bgra, _mm_unpacklo_epi16(bg, ra));
+			_mm_store_si128((__m128i *)(bgra + 16), _mm_unpackhi_epi16(bg, ra));
+			for (int i=0; i<8; i++, pDst+=3)
+			{
+				pDst[0] = bgra[i*4];	pDst[1] = bgra[i*4+1];	pDst[2] = bgra[i*4+2];
+			}
+		}
+	}
+	else if (format == VC_FORMAT_RGB565)
+	{
+		_mm_storeu_si128((__m128i *)pDst, _mm_or_si128(_mm_or_si128(_mm_slli_epi16(_mm_and_si128(r, k->mask5), 8),
+			_mm_slli_epi16(_mm_and_si128(g, k->mask6), 3)), _mm_srli_epi16(b, 3)));
+	}
+	else
+	{
+		_mm_storeu_si128((__m128i *)pDst, _mm_or_si128(_mm_or_si128(_mm_slli_epi16(_mm_and_si128(r, k->mask5), 7),
+			_mm_slli_epi16(_mm_and_si128(g, k->mask5), 2)), _mm_srli_epi16(b, 3)));
+	}
+}
+
+static int __RowRgbSIMD(const unsigned char *pY, const unsigned char *pU, const unsigned char *pV, unsigned char *pDst,
+						int width, VC_FORMAT format, const VC_MATRIX_T *m)
+{
+#if defined(__VS_AVX2)
+	if (_VS_UseAvx2())		return __RowRgbAvx2(pY, pU, pV, pDst, width, format, m);
+#endif
+	VC_K128_T k;
+	__InitK128(&k, m);
+	int bpp = format == VC_FORMAT_BGRA ? 4 : (format == VC_FORMAT_BGR24 ? 3 : 2);
+
+	int x = 0;
+	for (; x+16<=width; x+=16)
+	{
+		__m128i y8 = _mm_loadu_si128((const __m128i *)(pY + x));
+		__m128i u8 = _mm_loadl_epi64((const __m128i *)(pU + (x>>1)));
+		__m128i v8 = _mm_loadl_epi64((const __m128i *)(pV + (x>>1)));
+		u8 = _mm_unpacklo_epi8(u8, u8);
+		v8 = _mm_unpacklo_epi8(v8, v8);
+
+		__m128i r, g, b;
+		__Rgb8(&k, _mm_sub_epi16(_mm_unpacklo_epi8(y8, k.zero), k.yOffset),
+			_mm_sub_epi16(_mm_unpacklo_epi8(u8, k.zero), k.c128), _mm_sub_epi16(_mm_unpacklo_epi8(v8, k.zero), k.c128), &r, &g, &b);
+		__StoreRgb8(&k, pDst + x*bpp, format, r, g, b);
+
+		__Rgb8(&k, _mm_sub_epi16(_mm_unpackhi_epi8(y8, k.zero), k.yOffset),
+			_mm_sub_epi16(_mm_unpackhi_epi8(u8, k.zero), k.c128), _mm_sub_epi16(_mm_unpackhi_epi8(v8, k.zero), k.c128), &r, &g, &b);
+		__StoreRgb8(&k, pDst + (x+8)*bpp, format, r, g, b);
+	}
+	return x;
+}
+#elif defined(__VS_NEON)
+//8 pixels, y u v as int16 with the offsets removed; same sums as the scalar path
+static inline void __Rgb8(const VC_MATRIX_T *m, int16x8_t y, int16x8_t u, int16x8_t v, uint8x8_t *r, uint8x8_t *g, uint8x8_t *b)
+{
+	int32x4_t rnd = vdupq_n_s32(VC_ROUND);
+	int32x4_t tL = vmlal_n_s16(rnd, vget_low_s16(y), m->cy);
+	int32x4_t tH = vmlal_n_s16(rnd, vget_high_s16(y), m->cy);
+
+	int32x4_t rL = vmlal_n_s16(tL, vget_low_s16(v), m->crv);
+	int32x4_t rH = vmlal_n_s16(tH, vget_high_s16(v), m->crv);
+	int32x4_t gL = vmlsl_n_s16(vmlsl_n_s16(tL, vget_low_s16(u), m->cgu), vget_low_s16(v), m->cgv);
+	int32x4_t gH = vmlsl_n_s16(vmlsl_n_s16(tH, vget_high_s16(u), m->cgu), vget_high_s16(v), m->cgv);
+	int32x4_t bL = vmlal_n_s16(tL, vget_low_s16(u), m->cbu);
+	int32x4_t bH = vmlal_n_s16(tH, vget_high_s16(u), m->cbu);
+
+	*r = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(rL, VC_COEF_SHIFT)), vqmovn_s32(vshrq_n_s32(rH, VC_COEF_SHIFT))));
+	*g = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(gL, VC_COEF_SHIFT)), vqmovn_s32(vshrq_n_s32(gH, VC_COEF_SHIFT))));
+	*b = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(bL, VC_COEF_SHIFT)), vqmovn_s32(vshrq_n_s32(bH, VC_COEF_SHIFT))));
+}
+
+static inline uint16x8_t __Pack16(VC_FORMAT format, uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+	if (format == VC_FORMAT_RGB565)
+	{
+		return vorrq_u16(vorrq_u16(vandq_u16(vshll_n_u8(r, 8), vdupq_n_u16(0xF800)),
+			vandq_u16(vshll_n_u8(g, 3), vdupq_n_u16(0x07E0))), vmovl_u8(vshr_n_u8(b, 3)));
+	}
+	return vorrq_u16(vorrq_u16(vandq_u16(vshll_n_u8(r, 7), vdupq_n_u16(0x7C00)),
+		vandq_u16(vshll_n_u8(g, 2), vdupq_n_u16(0x03E0))), vmovl_u8(vshr_n_u8(b, 3)));
+}
+
+static int __RowRgbSIMD(const unsigned char *pY, const unsigned char *pU, const unsigned char *pV, unsigned char *pDst,
+						int width, VC_FORMAT format, const VC_MATRIX_T *m)
+{
+	int16x8_t yOffset = vdupq_n_s16(m->yOffset);
+	int16x8_t c128 = vdupq_n_s16(128);
+
+	int x = 0;
+	for (; x+16<=width; x+=16)
+	{
+		uint8x16_t y8 = vld1q_u8(pY + x);
+		uint8x8x2_t u8 = vzip_u8(vld1_u8(pU + (x>>1)), vld1_u8(pU + (x>>1)));
+		uint8x8x2_t v8 = vzip_u8(vld1_u8(pV + (x>>1)), vld1_u8(pV + (x>>1)));
+
+		uint8x8_t r[2], g[2], b[2];
+		for (int h=0; h<2; h++)
+		{
+			int16x8_t y = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(h ? vget_high_u8(y8) : vget_low_u8(y8))), yOffset);
+			int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8.val[h])), c128);
+			int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8.val[h])), c128);
+			__Rgb8(m, y, u, v, &r[h], &g[h], &b[h]);
+		}
+
+		if (format == VC_FORMAT_BGRA)
+		{
+			uint8x16x4_t bgra;
+			bgra.val[0] = vcombine_u8(b[0], b[1]);
+			bgra.val[1] = vcombine_u8(g[0], g[1]);
+			bgra.val[2] = vcombine_u8(r[0], r[1]);
+			bgra.val[3] = vdupq_n_u8(0xFF);
+			vst4q_u8(pDst + x*4, bgra);
+		}
+		else if (format == VC_FORMAT_BGR24)
+		{
+			uint8x16x3_t bgr;
+			bgr.val[0] = vcombine_u8(b[0], b[1]);
+			bgr.val[1] = vcombine_u8(g[0], g[1]);
+			bgr.val[2] = vcombine_u8(r[0], r[1]);
+			vst3q_u8(pDst + x*3, bgr);
+		}
+		else
+		{
+			vst1q_u16((unsigned short *)(pDst + x*2), __Pack16(format, r[0], g[0], b[0]));
+			vst1q_u16((unsigned short *)(pDst + x*2 + 16), __Pack16(format, r[1], g[1], b[1]));
+		}
+	}
+	return x;
+}
+#else
+static int __RowRgbSIMD(const unsigned char *, const unsigned char *, const unsigned char *, unsigned char *,
+						int, VC_FORMAT, const VC_MATRIX_T *)
+{
+	return 0;
+}
+#endif
+
+//packed 4:2:2 only moves bytes, SSE2 is as fast as AVX2 here
+static int __Row422SIMD(const unsigned char *pY, const unsigned char *pU, const unsigned char *pV, unsigned char *pDst,
+						int width, VC_FORMAT format)
+{
+	int x = 0;
+#if defined(__VS_SSE2)
+	for (; x+16<=width; x+=16)
+	{
+		__m128i y = _mm_loadu_si128((const __m128i *)(pY + x));
+		__m128i uv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(pU + (x>>1))), _mm_loadl_epi64((const __m128i *)(pV + (x>>1))));
+		if (format == VC_FORMAT_YUY2)
+		{
+			_mm_storeu_si128((__m128i *)(pDst + x*2), _mm_unpacklo_epi8(y, uv));
+			_mm_storeu_si128((__m128i *)(pDst + x*2 + 16), _mm_unpackhi_epi8(y, uv));
+		}
+		else
+		{
+			_mm_storeu_si128((__m128i *)(pDst + x*2), _mm_unpacklo_epi8(uv, y));
+			_mm_storeu_si128((__m128i *)(pDst + x*2 + 16), _mm_unpackhi_epi8(uv, y));
+		}
+	}
+#elif defined(__VS_NEON)
+	for (; x+16<=width; x+=16)
+	{
+		uint8x8x2_t uv = vzip_u8(vld1_u8(pU + (x>>1)), vld1_u8(pV + (x>>1)));
+		uint8x16x2_t out;
+		out.val[format == VC_FORMAT_YUY2 ? 0 : 1] = vld1q_u8(pY + x);
+		out.val[format == VC_FORMAT_YUY2 ? 1 : 0] = vcombine_u8(uv.val[0], uv.val[1]);
+		vst2q_u8(pDst + x*2, out);
+	}
+#endif
+	return x;
+}
+
+//row y of dst from one row of each plane at the output size
+static void __WriteRow(VC_FRAME_T *dst, int y, const unsigned char *pY, const unsigned char *pU, const unsigned char *pV,
+					   const VC_MATRIX_T *matrix, int simd)
+{
+	int width = dst->width;
+	int dstV = dst->format == VC_FORMAT_YV12 ? 1 : 2;
+	unsigned char *pDst = dst->plane[0] + (size_t)y * dst->stride[0];
+
+	int x = 0;
+	switch (dst->format)
+	{
+	case VC_FORMAT_YUV420P:
+	case VC_FORMAT_YV12:
+		memcpy(pDst, pY, width);
+		if (0 == (y & 1))		//each chroma row once, by the slice owning its even row
+		{
+			memcpy(dst->plane[3-dstV] + (size_t)(y>>1) * dst->stride[3-dstV], pU, (width+1)/2);
+			memcpy(dst->plane[dstV] + (size_t)(y>>1) * dst->stride[dstV], pV, (width+1)/2);
+		}
+		break;
+	case VC_FORMAT_YUY2:
+	case VC_FORMAT_UYVY:
+		if (simd)	x = __Row422SIMD(pY, pU, pV, pDst, width, dst->format);
+		__Row422C(pY, pU, pV, pDst, x, width, dst->format);
+		break;
+	default:
+		if (simd)	x = __RowRgbSIMD(pY, pU, pV, pDst, width, dst->format, matrix);
+		__RowRgbC(pY, pU, pV, pDst, x, width, dst->format, matrix);
+		break;
+	}
+}
+
+static int __CheckRows(const VC_FRAME_T *src, const VC_FRAME_T *dst, const VC_MATRIX_T *matrix, int y0, int y1)
+{
+	if (NULL == src || NULL == dst || NULL == matrix)							return -1;
+	if (src->format != VC_FORMAT_YUV420P && src->format != VC_FORMAT_YV12)		return -1;
+	if (src->width < 1 || src->height < 1 || dst->width < 1 || dst->height < 1)	return -1;
+	if (y0 < 0 || (y0 & 1) || y0 > y1 || y1 > dst->height)						return -1;
+	if (dst->format > VC_FORMAT_BGR24)											return -1;
+	return 0;
+}
+
+int		VC_ConvertRows(const VC_FRAME_T *src, VC_FRAME_T *dst, const VC_MATRIX_T *matrix, int y0, int y1, int simd)
+{
+	if (__CheckRows(src, dst, matrix, y0, y1) < 0)							return -1;
+	if (src->width != dst->width || src->height != dst->height)			return -1;
+
+	int srcV = src->format == VC_FORMAT_YV12 ? 1 : 2;
+	for (int y=y0; y<y1; y++)
+	{
+		const unsigned char *pY = src->plane[0] + (size_t)y * src->stride[0];
+		const unsigned char *pU = src->plane[3-srcV] + (size_t)(y>>1) * src->stride[3-srcV];
+		const unsigned char *pV = src->plane[srcV] + (size_t)(y>>1) * src->stride[srcV];
+		__WriteRow(dst, y, pY, pU, pV, matrix, simd);
+	}
+	return 0;
+}
+
+
+//output pixel d of dstLen taken from srcLen: AREA covers source pixels [pos, pos+len),
+//BILINEAR blends pos and pos+1 with len/256 of the latter
+static void __ScaleAxis(int d, int srcLen, int dstLen, VC_FILTER filter, int *pos, int *len)
+{
+	if (filter == VC_FILTER_AREA)
+	{
+		int s0 = (int)((long long)d * srcLen / dstLen);
+		int s1 = (int)((long long)(d+1) * srcLen / dstLen);
+		*pos = s0;
+		*len = s1 > s0 ? s1 - s0 : 1;
+		return;
+	}
+
+	//centre of d in source pixels, Q8
+	long long p = (long long)(2*d+1) * srcLen * 256 / (2*dstLen) - 128;
+	if (p < 0)	p = 0;
+	*pos = (int)(p >> 8);
+	*len = (int)(p & 0xFF);
+	if (*pos >= srcLen-1)
+	{
+		*pos = srcLen-1;
+		*len = 0;
+	}
+}
+
+#if defined(__VS_AVX2)
+__VS_TARGET_AVX2 static int __AccumRowAvx2(unsigned short *acc, const unsigned char *row, int width, int first)
+{
+	int x = 0;
+	for (; x+16<=width; x+=16)
+	{
+		__m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(row + x)));
+		if (!first)		v = _mm256_add_epi16(v, _mm256_loadu_si256((const __m256i *)(acc + x)));
+		_mm256_storeu_si256((__m256i *)(acc + x), v);
+	}
+	_mm256_zeroupper();
+	return x;
+}
+
+__VS_TARGET_AVX2 static int __BlendRowsAvx2(unsigned char *out, const unsigned char *r0, const unsigned char *r1, int f, int width)
+{
+	__m256i w0 = _mm256_set1_epi16((short)(256-f)), w1 = _mm256_set1_epi16((short)f), rnd = _mm256_set1_epi16(128);
+	int x = 0;
+	for (; x+16<=width; x+=16)
+	{
+		__m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(r0 + x)));
+		__m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(r1 + x)));
+		__m256i v = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(a, w0), _mm256_mullo_epi16(b, w1)), rnd), 8);
+		v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+		_mm_storeu_si128((__m128i *)(out + x), _mm256_castsi256_si128(v));
+	}
+	_mm256_zeroupper();
+	return x;
+}
+#endif
+
+//acc[x] = row[x], or acc[x] += row[x]
+static void __AccumRow(unsigned short *acc, const unsigned char *row, int width, int first, int simd)
+{
+	int x = 0;
+	if (simd)
+	{
+#if defined(__VS_AVX2)
+		//leaves less than 16 columns, the SSE2 loop below then has nothing to do
+		if (_VS_UseAvx2())		x = __AccumRowAvx2(acc, row, width, first);
+#endif
+#if defined(__VS_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		for (; x+16<=width; x+=16)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i *)(row + x));
+			__m128i lo = _mm_unpacklo_epi8(v, zero);
+			__m128i hi = _mm_unpackhi_epi8(v, zero);
+			if (!first)
+			{
+				lo = _mm_add_epi16(lo, _mm_loadu_si128((const __m128i *)(acc + x)));
+				hi = _mm_add_epi16(hi, _mm_loadu_si128((const __m128i *)(acc + x + 8)));
+			}
+			_mm_storeu_si128((__m128i *)(acc + x), lo);
+			_mm_storeu_si128((__m128i *)(acc + x + 8), hi);
+		}
+#elif defined(__VS_NEON)
+		for (; x+16<=width; x+=16)
+		{
+			uint8x16_t v = vld1q_u8(row + x);
+			uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+			uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+			if (!first)
+			{
+				lo = vaddq_u16(lo, vld1q_u16(acc + x));
+				hi = vaddq_u16(hi, vld1q_u16(acc + x + 8));
+			}
+			vst1q_u16(acc + x, lo);
+			vst1q_u16(acc + x + 8, hi);
+		}
+#endif
+	}
+	for (; x<width; x++)	acc[x] = (unsigned short)(first ? row[x] : acc[x] + row[x]);
+}
+
+//out = (r0*(256-f) + r1*f + 128) >> 8, which stays below 65536
+static void __BlendRows(unsigned char *out, const unsigned char *r0, const unsigned char *r1, int f, int width, int simd)
+{
+	int x = 0;
+	if (simd)
+	{
+#if defined(__VS_AVX2)
+		if (_VS_UseAvx2())		x = __BlendRowsAvx2(out, r0, r1, f, width);
+#endif
+#if defined(__VS_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		__m128i w0 = _mm_set1_epi16((short)(256-f)), w1 = _mm_set1_epi16((short)f), rnd = _mm_set1_epi16(128);
+		for (; x+16<=width; x+=16)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i *)(r0 + x));
+			__m128i b = _mm_loadu_si128((const __m128i *)(r1 + x));
+			__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0), _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+			__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0), _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, rnd), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, rnd), 8);
+			_mm_storeu_si128((__m128i *)(out + x), _mm_packus_epi16(lo, hi));
+		}
+#elif defined(__VS_NEON)
+		uint16x8_t rnd = vdupq_n_u16(128);
+		for (; x+16<=width; x+=16)
+		{
+			uint8x16_t a = vld1q_u8(r0 + x);
+			uint8x16_t b = vld1q_u8(r1 + x);
+			uint16x8_t lo = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(a)), (unsigned short)(256-f)), vmovl_u8(vget_low_u8(b)), (unsigned short)f);
+			uint16x8_t hi = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(a)), (unsigned short)(256-f)), vmovl_u8(vget_high_u8(b)), (unsigned short)f);
+			vst1q_u8(out + x, vcombine_u8(vshrn_n_u16(vaddq_u16(lo, rnd), 8), vshrn_n_u16(vaddq_u16(hi, rnd), 8)));
+		}
+#endif
+	}
+	for (; x<width; x++)	out[x] = (unsigned char)((r0[x]*(256-f) + r1[x]*f + 128) >> 8);
+}
+
+//exact 2:1 columns: out[x] = (acc[2x] + acc[2x+1] + 2) >> 2, acc below 32768
+static int __HalfSum(const unsigned short *acc, unsigned char *out, int width)
+{
+	int x = 0;
+#if defined(__VS_SSE2)
+	__m128i lo16 = _mm_set1_epi32(0xFFFF), two = _mm_set1_epi32(2);
+	for (; x+8<=width; x+=8)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i *)(acc + x*2));
+		__m128i b = _mm_loadu_si128((const __m128i *)(acc + x*2 + 8));
+		a = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_and_si128(a, lo16), _mm_srli_epi32(a, 16)), two), 2);
+		b = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_and_si128(b, lo16), _mm_srli_epi32(b, 16)), two), 2);
+		__m128i v = _mm_packs_epi32(a, b);
+		_mm_storel_epi64((__m128i *)(out + x), _mm_packus_epi16(v, v));
+	}
+#elif defined(__VS_NEON)
+	for (; x+8<=width; x+=8)
+	{
+		uint32x4_t a = vpaddlq_u16(vld1q_u16(acc + x*2));
+		uint32x4_t b = vpaddlq_u16(vld1q_u16(acc + x*2 + 8));
+		vst1_u8(out + x, vmovn_u16(vcombine_u16(vrshrn_n_u32(a, 2), vrshrn_n_u32(b, 2))));
+	}
+#endif
+	return x;
+}
+
+//exact 2:1 columns: out[x] = (row[2x] + row[2x+1] + 1) >> 1, the bilinear weights at that ratio
+static int __HalfAvg(const unsigned char *row, unsigned char *out, int width)
+{
+	int x = 0;
+#if defined(__VS_SSE2)
+	__m128i lo8 = _mm_set1_epi16(0xFF);
+	for (; x+16<=width; x+=16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i *)(row + x*2));
+		__m128i b = _mm_loadu_si128((const __m128i *)(row + x*2 + 16));
+		a = _mm_avg_epu16(_mm_and_si128(a, lo8), _mm_srli_epi16(a, 8));
+		b = _mm_avg_epu16(_mm_and_si128(b, lo8), _mm_srli_epi16(b, 8));
+		_mm_storeu_si128((__m128i *)(out + x), _mm_packus_epi16(a, b));
+	}
+#elif defined(__VS_NEON)
+	for (; x+16<=width; x+=16)
+	{
+		uint8x16x2_t v = vld2q_u8(row + x*2);
+		vst1q_u8(out + x, vrhaddq_u8(v.val[0], v.val[1]));
+	}
+#endif
+	return x;
+}
+
+#if defined(__VS_AVX2)
+//any ratio, 8 columns per gather: sum of acc[pos, pos+len), len at most maxLen, times
+//the Q24 reciprocal of its count, invA for len minLen and invB for minLen+1
+__VS_TARGET_AVX2 static int __AreaGather(const unsigned short *acc, const int *xPos, const int *xLen, unsigned char *out, int width,
+						int minLen, int maxLen, unsigned int invA, unsigned int invB)
+{
+	__m256i lo16 = _mm256_set1_epi32(0xFFFF), rnd = _mm256_set1_epi32(1<<23), longer = _mm256_set1_epi32(minLen+1);
+	__m256i vInvA = _mm256_set1_epi32((int)invA), vInvB = _mm256_set1_epi32((int)invB);
+	int x = 0;
+	for (; x+8<=width; x+=8)
+	{
+		__m256i pos = _mm256_loadu_si256((const __m256i *)(xPos + x));
+		__m256i len = _mm256_loadu_si256((const __m256i *)(xLen + x));
+		__m256i sum = _mm256_setzero_si256();
+		for (int i=0; i<maxLen; i++)
+		{
+			__m256i mask = _mm256_cmpgt_epi32(len, _mm256_set1_epi32(i));
+			__m256i v = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *)acc, _mm256_add_epi32(pos, _mm256_set1_epi32(i)), mask, 2);
+			sum = _mm256_add_epi32(sum, _mm256_and_si256(v, lo16));
+		}
+		__m256i inv = _mm256_blendv_epi8(vInvA, vInvB, _mm256_cmpeq_epi32(len, longer));
+		__m256i v = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(sum, inv), rnd), 24);
+		v = _mm256_packus_epi32(v, v);
+		__m128i v8 = _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+		*(int *)(out + x) = _mm_cvtsi128_si32(v8);
+		*(int *)(out + x + 4) = _mm_extract_epi32(v8, 2);		//v4-v7 follow a repeat of v0-v3
+	}
+	_mm256_zeroupper();
+	return x;
+}
+
+//any ratio: (row[pos]*(256-f) + row[pos+1]*f + 128) >> 8, row readable 3 bytes past pos
+__VS_TARGET_AVX2 static int __BilinearGather(const unsigned char *row, const int *xPos, const int *xLen, unsigned char *out, int width)
+{
+	__m256i lo8 = _mm256_set1_epi32(0xFF), c256 = _mm256_set1_epi32(256), rnd = _mm256_set1_epi32(128);
+	int x = 0;
+	for (; x+8<=width; x+=8)
+	{
+		__m256i f = _mm256_loadu_si256((const __m256i *)(xLen + x));
+		__m256i v = _mm256_i32gather_epi32((const int *)row, _mm256_loadu_si256((const __m256i *)(xPos + x)), 1);
+		__m256i p0 = _mm256_and_si256(v, lo8);
+		__m256i p1 = _mm256_and_si256(_mm256_srli_epi32(v, 8), lo8);
+		v = _mm256_add_epi32(_mm256_mullo_epi16(p0, _mm256_sub_epi32(c256, f)), _mm256_mullo_epi16(p1, f));
+		v = _mm256_srli_epi32(_mm256_add_epi32(v, rnd), 8);
+		v = _mm256_packus_epi32(v, v);
+		__m128i v8 = _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+		*(int *)(out + x) = _mm_cvtsi128_si32(v8);
+		*(int *)(out + x + 4) = _mm_extract_epi32(v8, 2);		//v4-v7 follow a repeat of v0-v3
+	}
+	_mm256_zeroupper();
+	return x;
+}
+#endif
+
+typedef struct __VC_SCALE_T
+{
+	VC_FILTER		filter;
+	int				srcWidth;
+	int				srcHeight;
+	int				dstWidth;
+	int				dstHeight;
+	int				half;			//srcWidth is exactly 2*dstWidth
+	int				minLen;			//AREA columns cover minLen or minLen+1 source pixels
+	int				*xPos;			//__ScaleAxis of every output column
+	int				*xLen;
+	unsigned short	*acc;			//srcWidth, AREA
+	unsigned char	*tmp;			//srcWidth+1, BILINEAR
+}VC_SCALE_T;
+
+//output row y of one plane: the vertical pass runs over whole source rows with SIMD,
+//the horizontal one only over the output columns
+static void __ScaleLine(const VC_SCALE_T *s, const unsigned char *plane, int stride, int y, unsigned char *out, int simd)
+{
+	//locals, since the byte stores to out could alias *s
+	const int *xPos = s->xPos;
+	const int *xLen = s->xLen;
+	int srcWidth = s->srcWidth;
+	int dstWidth = s->dstWidth;
+
+	int sy, len;
+	__ScaleAxis(y, s->srcHeight, s->dstHeight, s->filter, &sy, &len);
+
+	if (s->filter == VC_FILTER_AREA)
+	{
+		const unsigned short *acc = s->acc;
+		int rows = len < 256 ? len : 256;		//keeps the sums in 16 bits
+		for (int i=0; i<rows; i++)	__AccumRow(s->acc, plane + (size_t)(sy+i) * stride, srcWidth, 0==i, simd);
+
+		//sum / n rounded by a Q24 reciprocal, exact to well under half a step while n < 65536
+		int minLen = s->minLen;
+		unsigned int n = (unsigned int)(rows * (minLen+1));
+		unsigned int invA = ((1U<<24) + rows*minLen/2) / (rows*minLen);
+		unsigned int invB = ((1U<<24) + n/2) / n;
+
+		int x = 0;
+		if (simd && s->half && 2 == rows)	x = __HalfSum(acc, out, dstWidth);
+#if defined(__VS_AVX2)
+		else if (simd && n < 65536 && minLen < 8 && _VS_UseAvx2())	x = __AreaGather(acc, xPos, xLen, out, dstWidth, minLen, minLen+1, invA, invB);
+#endif
+		if (n >= 65536)
+		{
+			for (; x<dstWidth; x++)
+			{
+				const unsigned short *p = acc + xPos[x];
+				unsigned long long sum = 0;
+				for (int i=0; i<xLen[x]; i++)	sum += p[i];
+				unsigned long long cnt = (unsigned long long)rows * xLen[x];
+				out[x] = (unsigned char)((sum + cnt/2) / cnt);
+			}
+			return;
+		}
+		for (; x<dstWidth; x++)
+		{
+			const unsigned short *p = acc + xPos[x];
+			unsigned int sum = 0;
+			for (int i=0; i<xLen[x]; i++)	sum += p[i];
+			out[x] = (unsigned char)((sum * (xLen[x] == minLen ? invA : invB) + (1U<<23)) >> 24);
+		}
+		return;
+	}
+
+	unsigned char *tmp = s->tmp;
+	int sy1 = sy+1 < s->srcHeight ? sy+1 : sy;
+	__BlendRows(tmp, plane + (size_t)sy * stride, plane + (size_t)sy1 * stride, len, srcWidth, simd);
+	tmp[srcWidth] = tmp[srcWidth-1];
+
+	int x = 0;
+	if (simd && s->half)	x = __HalfAvg(tmp, out, dstWidth);
+#if defined(__VS_AVX2)
+	else if (simd && _VS_UseAvx2())		x = __BilinearGather(tmp, xPos, xLen, out, dstWidth);
+#endif
+	for (; x<dstWidth; x++)
+	{
+		const unsigned char *p = tmp + xPos[x];
+		int f = xLen[x];
+		out[x] = (unsigned char)((p[0]*(256-f) + p[1]*f + 128) >> 8);
+	}
+}
+
+static void __InitScale(VC_SCALE_T *s, VC_FILTER filter, int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+						int *table, unsigned short *acc, unsigned char *tmp)
+{
+	s->filter		=	filter;
+	s->srcWidth		=	srcWidth;
+	s->srcHeight	=	srcHeight;
+	s->dstWidth		=	dstWidth;
+	s->dstHeight	=	dstHeight;
+	s->half			=	srcWidth == dstWidth*2;
+	s->xPos			=	table;
+	s->xLen			=	table + dstWidth;
+	s->acc			=	acc;
+	s->tmp			=	tmp;
+	s->minLen		=	srcWidth / dstWidth > 1 ? srcWidth / dstWidth : 1;
+	for (int x=0; x<dstWidth; x++)	__ScaleAxis(x, srcWidth, dstWidth, filter, &s->xPos[x], &s->xLen[x]);
+}
+
+int		VC_ScaleRows(const VC_FRAME_T *src, VC_FRAME_T *dst, const VC_MATRIX_T *matrix, VC_FILTER filter, int y0, int y1, int simd)
+{
+	if (__CheckRows(src, dst, matrix, y0, y1) < 0)							return -1;
+	if (src->width == dst->width && src->height == dst->height)			return VC_ConvertRows(src, dst, matrix, y0, y1, simd);
+	if (y0 == y1)															return 0;
+
+	int srcCW = (src->width+1)/2, srcCH = (src->height+1)/2;
+	int dstCW = (dst->width+1)/2, dstCH = (dst->height+1)/2;
+
+	//column tables, one source row of work space, and the output row of each plane
+	size_t tableSize = (size_t)(dst->width + dstCW) * 2 * sizeof(int);
+	size_t accSize = (size_t)(src->width + 2) * sizeof(unsigned short);		//gathers read past the last pixel
+	unsigned char *pMem = (unsigned char *)malloc(tableSize + accSize + (src->width + 4) + dst->width + 2*dstCW);
+	if (NULL == pMem)		return -1;
+
+	int *table = (int *)pMem;
+	unsigned short *acc = (unsigned short *)(pMem + tableSize);
+	unsigned char *tmp = pMem + tableSize + accSize;
+	unsigned char *pY = tmp + src->width + 4;
+	unsigned char *pU = pY + dst->width;
+	unsigned char *pV = pU + dstCW;
+
+	VC_SCALE_T luma, chroma;
+	__InitScale(&luma, filter, src->width, src->height, dst->width, dst->height, table, acc, tmp);
+	__InitScale(&chroma, filter, srcCW, srcCH, dstCW, dstCH, table + dst->width*2, acc, tmp);
+
+	int srcV = src->format == VC_FORMAT_YV12 ? 1 : 2;
+	for (int y=y0; y<y1; y++)
+	{
+		__ScaleLine(&luma, src->plane[0], src->stride[0], y, pY, simd);
+		if (y == y0 || 0 == (y & 1))
+		{
+			__ScaleLine(&chroma, src->plane[3-srcV], src->stride[3-srcV], y>>1, pU, simd);
+			__ScaleLine(&chroma, src->plane[srcV], src->stride[srcV], y>>1, pV, simd);
+		}
+		__WriteRow(dst, y, pY, pU, pV, matrix, simd);
+	}
+
+	free(pMem);
+	return 0;
+}
+
+
+//worker threads for row slices: worker i converts slice i+1, the caller slice 0
+typedef struct __VC_WORKER_T
+{
+	struct __VC_WORKERS_T	*pWorkers;
+	int						index;
+}VC_WORKER_T;
+
+typedef struct __VC_WORKERS_T
+{
+	int					num;			//threads running
+	int					quit;
+
+	const VC_FRAME_T	*src;			//the frame being converted
+	VC_FRAME_T			*dst;
+	const VC_MATRIX_T	*matrix;
+	VC_FILTER			filter;
+	int					slices;
+	int					rows[VC_MAX_THREADS+1];
+
+	VC_WORKER_T			worker[VC_MAX_THREADS];
+#ifdef _WIN32
+	HANDLE				hThread[VC_MAX_THREADS];
+	HANDLE				hStart[VC_MAX_THREADS];		//auto reset
+	HANDLE				hDone[VC_MAX_THREADS];
+#else
+	pthread_t			thread[VC_MAX_THREADS];
+	pthread_mutex_t		lock;
+	pthread_cond_t		start;
+	pthread_cond_t		done;
+	unsigned int		seq;			//frames handed out
+	int					pending;		//slices not finished
+#endif
+}VC_WORKERS_T;
+
+static void __RunSlice(VC_WORKERS_T *w, int slice)
+{
+	VC_ScaleRows(w->src, w->dst, w->matrix, w->filter, w->rows[slice], w->rows[slice+1]);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI __VC_WorkerThread(LPVOID lpParam)
+{
+	VC_WORKER_T *pWorker = (VC_WORKER_T *)lpParam;
+	VC_WORKERS_T *w = pWorker->pWorkers;
+	for (;;)
+	{
+		WaitForSingleObject(w->hStart[pWorker->index], INFINITE);
+		if (w->quit)	break;
+
+		__RunSlice(w, pWorker->index+1);
+		SetEvent(w->hDone[pWorker->index]);
+	}
+	return 0;
+}
+#else
+static void *__VC_WorkerThread(void *param)
+{
+	VC_WORKER_T *pWorker = (VC_WORKER_T *)param;
+	VC_WORKERS_T *w = pWorker->pWorkers;
+
+	unsigned int seq = 0;			//w->seq at Init, a frame may be handed out before we get here
+	pthread_mutex_lock(&w->lock);
+	for (;;)
+	{
+		while (!w->quit && w->seq == seq)	pthread_cond_wait(&w->start, &w->lock);
+		if (w->quit)	break;
+
+		seq = w->seq;
+		if (pWorker->index+1 >= w->slices)	continue;
+
+		pthread_mutex_unlock(&w->lock);
+		__RunSlice(w, pWorker->index+1);
+		pthread_mutex_lock(&w->lock);
+		if (--w->pending == 0)	pthread_cond_signal(&w->done);
+	}
+	pthread_mutex_unlock(&w->lock);
+	return NULL;
+}
+#endif
+
+static int __CpuCount()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#else
+	long num = sysconf(_SC_NPROCESSORS_ONLN);
+	return num > 0 ? (int)num : 1;
+#endif
+}
+
+
+CVideoConverter::CVideoConverter(void)
+{
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	threads		=	1;
+	sliceAll	=	0;
+	filter		=	VC_FILTER_AREA;
+	pWorkers	=	NULL;
+}
+
+CVideoConverter::~CVideoConverter(void)
+{
+	Deinit();
+}
+
+int		CVideoConverter::Init(VC_COLORSPACE colorspace, VC_RANGE range, int _threads)
+{
+	Deinit();
+
+	VC_InitMatrix(&matrix, colorspace, range);
+	sliceAll = _threads > 0 ? 1 : 0;
+	int num = (_threads > 0 ? _threads : __CpuCount()) - 1;
+	if (num > VC_MAX_THREADS-1)	num = VC_MAX_THREADS-1;
+	if (num < 1)				return 0;
+
+	VC_WORKERS_T *w = new VC_WORKERS_T;
+	memset(w, 0x00, sizeof(VC_WORKERS_T));
+#ifndef _WIN32
+	pthread_mutex_init(&w->lock, NULL);
+	pthread_cond_init(&w->start, NULL);
+	pthread_cond_init(&w->done, NULL);
+#endif
+	for (int i=0; i<num; i++)
+	{
+		w->worker[i].pWorkers	=	w;
+		w->worker[i].index		=	i;
+#ifdef _WIN32
+		w->hStart[i]	=	CreateEvent(NULL, FALSE, FALSE, NULL);
+		w->hDone[i]		=	CreateEvent(NULL, FALSE, FALSE, NULL);
+		if (NULL == w->hStart[i] || NULL == w->hDone[i])	break;
+		w->hThread[i]	=	CreateThread(NULL, 0, __VC_WorkerThread, &w->worker[i], 0, NULL);
+		if (NULL == w->hThread[i])	break;
+#else
+		if (0 != pthread_create(&w->thread[i], NULL, __VC_WorkerThread, &w->worker[i]))	break;
+#endif
+		w->num ++;
+	}
+	pWorkers = w;
+	threads = w->num + 1;
+
+	return 0;
+}
+
+void	CVideoConverter::Deinit()
+{
+	VC_WORKERS_T *w = (VC_WORKERS_T *)pWorkers;
+	if (NULL != w)
+	{
+#ifdef _WIN32
+		w->quit = 1;
+		for (int i=0; i<w->num; i++)	SetEvent(w->hStart[i]);
+		if (w->num > 0)		WaitForMultipleObjects(w->num, w->hThread, TRUE, INFINITE);
+		for (int i=0; i<VC_MAX_THREADS; i++)
+		{
+			if (NULL != w->hThread[i])	CloseHandle(w->hThread[i]);
+			if (NULL != w->hStart[i])	CloseHandle(w->hStart[i]);
+			if (NULL != w->hDone[i])	CloseHandle(w->hDone[i]);
+		}
+#else
+		pthread_mutex_lock(&w->lock);
+		w->quit = 1;
+		pthread_cond_broadcast(&w->start);
+		pthread_mutex_unlock(&w->lock);
+		for (int i=0; i<w->num; i++)	pthread_join(w->thread[i], NULL);
+		pthread_cond_destroy(&w->done);
+		pthread_cond_destroy(&w->start);
+		pthread_mutex_destroy(&w->lock);
+#endif
+		delete w;
+		pWorkers = NULL;
+	}
+	threads		=	1;
+	sliceAll	=	0;
+}
+
+int		CVideoConverter::Convert(const VC_FRAME_T *src, VC_FRAME_T *dst)
+{
+	if (NULL == src || NULL == dst)		return -1;
+
+	VC_WORKERS_T *w = (VC_WORKERS_T *)pWorkers;
+	int slices = threads;
+	if (NULL == w || (!sliceAll && src->width * src->height < VC_SLICE_MIN_PIXELS))	slices = 1;
+	if (slices > dst->height / 16)		slices = dst->height / 16;		//at least 16 rows each
+	if (slices <= 1)					return VC_ScaleRows(src, dst, &matrix, filter, 0, dst->height);
+
+	//check once here rather than in every slice
+	if (VC_ScaleRows(src, dst, &matrix, filter, 0, 0) < 0)	return -1;
+
+	w->src		=	src;
+	w->dst		=	dst;
+	w->matrix	=	&matrix;
+	w->filter	=	filter;
+	w->slices	=	slices;
+	for (int i=0; i<slices; i++)	w->rows[i] = (int)((long long)dst->height * i / slices) & ~1;
+	w->rows[slices] = dst->height;
+
+#ifdef _WIN32
+	for (int i=0; i<slices-1; i++)	SetEvent(w->hStart[i]);
+	__RunSlice(w, 0);
+	WaitForMultipleObjects(slices-1, w->hDone, TRUE, INFINITE);
+#else
+	pthread_mutex_lock(&w->lock);
+	w->pending = slices-1;
+	w->seq ++;
+	pthread_cond_broadcast(&w->start);
+	pthread_mutex_unlock(&w->lock);
+
+	__RunSlice(w, 0);
+
+	pthread_mutex_lock(&w->lock);
+	while (w->pending > 0)	pthread_cond_wait(&w->done, &w->lock);
+	pthread_mutex_unlock(&w->lock);
+#endif
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VIDEO_CONVERTER_H__
+#define __VIDEO_CONVERTER_H__
+
+#define		VC_COEF_SHIFT			13				//matrix coefficients are Q13
+#define		VC_MAX_THREADS			8
+#define		VC_SLICE_MIN_PIXELS		(2560*1440)		//smaller frames are converted on the calling thread
+
+typedef enum __VC_FORMAT
+{
+	VC_FORMAT_YUV420P	=	0x00,		//planar Y, U, V (I420), the decoder output
+	VC_FORMAT_YV12,						//planar Y, V, U
+	VC_FORMAT_YUY2,						//packed Y0 U Y1 V
+	VC_FORMAT_UYVY,						//packed U Y0 V Y1
+	VC_FORMAT_BGRA,						//bytes B G R A, D3D A8R8G8B8/X8R8G8B8, alpha 0xFF
+	VC_FORMAT_RGB565,					//16 bit little endian R5 G6 B5
+	VC_FORMAT_RGB555,					//16 bit little endian X1 R5 G5 B5, X is 0
+	VC_FORMAT_BGR24						//bytes B G R, GDI 24 bit
+}VC_FORMAT;
+
+typedef enum __VC_COLORSPACE
+{
+	VC_COLORSPACE_BT601	=	0x00,
+	VC_COLORSPACE_BT709	=	0x01
+}VC_COLORSPACE;
+
+typedef enum __VC_RANGE
+{
+	VC_RANGE_LIMITED	=	0x00,		//Y 16-235, UV 16-240
+	VC_RANGE_FULL		=	0x01		//0-255
+}VC_RANGE;
+
+typedef enum __VC_FILTER
+{
+	VC_FILTER_AREA		=	0x00,		//average of the source pixels an output pixel covers, for downscaling
+	VC_FILTER_BILINEAR	=	0x01
+}VC_FILTER;
+
+typedef struct __VC_FRAME_T
+{
+	VC_FORMAT		format;
+	int				width;
+	int				height;
+	unsigned char	*plane[3];		//packed formats use plane[0]
+	int				stride[3];		//bytes per row, at least the row itself
+}VC_FRAME_T;
+
+//R = (cy*(Y-yOffset) + crv*V' + round) >> VC_COEF_SHIFT, V' = V-128, and likewise
+//G with -cgu*U' - cgv*V', B with cbu*U'. Every kernel evaluates exactly this
+typedef struct __VC_MATRIX_T
+{
+	short	yOffset;
+	short	cy;
+	short	crv;
+	short	cgu;
+	short	cgv;
+	short	cbu;
+}VC_MATRIX_T;
+
+//bytes of a width x height frame with the tightest strides
+int		VC_FrameSize(VC_FORMAT format, int width, int height);
+//lays such a frame out in pBuf, returns its size
+int		VC_FillFrame(VC_FRAME_T *frame, VC_FORMAT format, int width, int height, unsigned char *pBuf);
+//a window of a YUV420P or YV12 frame without copying: planes offset, strides kept. x and y are
+//rounded down and width, height up to even so chroma stays aligned, then clipped to the frame
+int		VC_CropFrame(const VC_FRAME_T *src, VC_FRAME_T *dst, int x, int y, int width, int height);
+//a display window [left, right) x [top, bottom) clipped to a width x height frame and even aligned
+//for VC_CropFrame into roi as left, top, right, bottom. 0 when it is empty, smaller than 16x16 once
+//clipped, or the whole frame
+int		VC_RenderRoi(int left, int top, int right, int bottom, int width, int height, int *roi);
+void	VC_InitMatrix(VC_MATRIX_T *matrix, VC_COLORSPACE colorspace, VC_RANGE range);
+
+//Rows [y0, y1) of a YUV420P or YV12 frame into dst of the same size, y0 even.
+//Chroma is taken from the nearest sample, the packed YUV formats copy it unchanged.
+//simd 0 runs the scalar reference the SIMD kernels must match bit for bit
+int		VC_ConvertRows(const VC_FRAME_T *src, VC_FRAME_T *dst, const VC_MATRIX_T *matrix, int y0, int y1, int simd=1);
+//Rows [y0, y1) of dst, y0 even, scaled from a src of another size while converting; no
+//frame at either intermediate size is ever built. Same sizes go to VC_ConvertRows
+int		VC_ScaleRows(const VC_FRAME_T *src, VC_FRAME_T *dst, const VC_MATRIX_T *matrix, VC_FILTER filter, int y0, int y1, int simd=1);
+
+//YUV420P to any VC_FORMAT at any size, large frames split into row slices across worker threads
+class CVideoConverter
+{
+public:
+	CVideoConverter(void);
+	~CVideoConverter(void);
+
+	//threads 0: one per core, used for frames of VC_SLICE_MIN_PIXELS and more;
+	//threads n: every frame is cut into n slices
+	int		Init(VC_COLORSPACE colorspace, VC_RANGE range, int threads=0);
+	void	Deinit();
+
+	//returns 0, or -1 if the formats do not fit; dst of another size is scaled with the filter
+	int		Convert(const VC_FRAME_T *src, VC_FRAME_T *dst);
+	void	SetFilter(VC_FILTER _filter)	{filter = _filter;}
+
+	int		GetThreads()		{return threads;}
+	const VC_MATRIX_T *GetMatrix()	{return &matrix;}
+
+protected:
+	VC_MATRIX_T		matrix;
+	int				threads;		//slices for a large frame
+	int				sliceAll;		//slice small frames too
+	VC_FILTER		filter;			//VC_FILTER_AREA unless set
+	void			*pWorkers;		//VC_WORKERS_T, see VideoConverter.cpp
+};
+
+#endif
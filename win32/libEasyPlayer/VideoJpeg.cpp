@@ -0,0 +1,331 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "VideoJpeg.h"
+#include <stdlib.h>
+#include <string.h>
+
+//ITU T.81 Annex K tables
+static const unsigned char __baseQuantY[64] = {
+	16, 11, 10, 16, 24, 40, 51, 61,		12, 12, 14, 19, 26, 58, 60, 55,
+	14, 13, 16, 24, 40, 57, 69, 56,		14, 17, 22, 29, 51, 87, 80, 62,
+	18, 22, 37, 56, 68,109,103, 77,		24, 35, 55, 64, 81,104,113, 92,
+	49, 64, 78, 87,103,121,120,101,		72, 92, 95, 98,112,100,103, 99
+};
+static const unsigned char __baseQuantC[64] = {
+	17, 18, 24, 47, 99, 99, 99, 99,		18, 21, 26, 66, 99, 99, 99, 99,
+	24, 26, 56, 99, 99, 99, 99, 99,		47, 66, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99,		99, 99, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99,		99, 99, 99, 99, 99, 99, 99, 99
+};
+
+//codes of each length 1-16, then the symbols
+static const unsigned char __countDcY[16] = {0,1,5,1,1,1,1,1,1,0,0,0,0,0,0,0};
+static const unsigned char __countDcC[16] = {0,3,1,1,1,1,1,1,1,1,1,0,0,0,0,0};
+static const unsigned char __symbolDc[12] = {0,1,2,3,4,5,6,7,8,9,10,11};
+static const unsigned char __countAcY[16] = {0,2,1,3,3,2,4,3,5,5,4,4,0,0,1,0x7d};
+static const unsigned char __symbolAcY[162] = {
+	0x01,0x02,0x03,0x00,0x04,0x11,0x05,0x12,0x21,0x31,0x41,0x06,0x13,0x51,0x61,0x07,0x22,0x71,0x14,0x32,0x81,0x91,0xa1,0x08,
+	0x23,0x42,0xb1,0xc1,0x15,0x52,0xd1,0xf0,0x24,0x33,0x62,0x72,0x82,0x09,0x0a,0x16,0x17,0x18,0x19,0x1a,0x25,0x26,0x27,0x28,
+	0x29,0x2a,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x43,0x44,0x45,0x46,0x47,0x48,0x49,0x4a,0x53,0x54,0x55,0x56,0x57,0x58,0x59,
+	0x5a,0x63,0x64,0x65,0x66,0x67,0x68,0x69,0x6a,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x83,0x84,0x85,0x86,0x87,0x88,0x89,
+	0x8a,0x92,0x93,0x94,0x95,0x96,0x97,0x98,0x99,0x9a,0xa2,0xa3,0xa4,0xa5,0xa6,0xa7,0xa8,0xa9,0xaa,0xb2,0xb3,0xb4,0xb5,0xb6,
+	0xb7,0xb8,0xb9,0xba,0xc2,0xc3,0xc4,0xc5,0xc6,0xc7,0xc8,0xc9,0xca,0xd2,0xd3,0xd4,0xd5,0xd6,0xd7,0xd8,0xd9,0xda,0xe1,0xe2,
+	0xe3,0xe4,0xe5,0xe6,0xe7,0xe8,0xe9,0xea,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa
+};
+static const unsigned char __countAcC[16] = {0,2,1,2,4,4,3,4,7,5,4,4,0,1,2,0x77};
+static const unsigned char __symbolAcC[162] = {
+	0x00,0x01,0x02,0x03,0x11,0x04,0x05,0x21,0x31,0x06,0x12,0x41,0x51,0x07,0x61,0x71,0x13,0x22,0x32,0x81,0x08,0x14,0x42,0x91,
+	0xa1,0xb1,0xc1,0x09,0x23,0x33,0x52,0xf0,0x15,0x62,0x72,0xd1,0x0a,0x16,0x24,0x34,0xe1,0x25,0xf1,0x17,0x18,0x19,0x1a,0x26,
+	0x27,0x28,0x29,0x2a,0x35,0x36,0x37,0x38,0x39,0x3a,0x43,0x44,0x45,0x46,0x47,0x48,0x49,0x4a,0x53,0x54,0x55,0x56,0x57,0x58,
+	0x59,0x5a,0x63,0x64,0x65,0x66,0x67,0x68,0x69,0x6a,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x82,0x83,0x84,0x85,0x86,0x87,
+	0x88,0x89,0x8a,0x92,0x93,0x94,0x95,0x96,0x97,0x98,0x99,0x9a,0xa2,0xa3,0xa4,0xa5,0xa6,0xa7,0xa8,0xa9,0xaa,0xb2,0xb3,0xb4,
+	0xb5,0xb6,0xb7,0xb8,0xb9,0xba,0xc2,0xc3,0xc4,0xc5,0xc6,0xc7,0xc8,0xc9,0xca,0xd2,0xd3,0xd4,0xd5,0xd6,0xd7,0xd8,0xd9,0xda,
+	0xe2,0xe3,0xe4,0xe5,0xe6,0xe7,0xe8,0xe9,0xea,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa
+};
+
+//cos(k*pi/16)*sqrt(2), k>0, the output scale of the AAN DCT
+static const float __aanScale[8] = {1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f};
+
+//natural position -> zigzag index
+static const int __zigzag[64] = {
+	 0, 1, 5, 6,14,15,27,28,	 2, 4, 7,13,16,26,29,42,	 3, 8,12,17,25,30,41,43,	 9,11,18,24,31,40,44,53,
+	10,19,23,32,39,45,52,54,	20,22,33,38,46,51,55,60,	21,34,37,47,50,56,59,61,	35,36,48,49,57,58,62,63
+};
+
+//canonical codes from the counts per length
+static void __BuildCodes(const unsigned char *count, const unsigned char *symbol, unsigned short (*code)[2])
+{
+	int c = 0, k = 0;
+	for (int len=1; len<=16; len++)
+	{
+		for (int i=0; i<count[len-1]; i++, k++)
+		{
+			code[symbol[k]][0] = (unsigned short)c++;
+			code[symbol[k]][1] = (unsigned short)len;
+		}
+		c <<= 1;
+	}
+}
+
+static void __Quality(const unsigned char *base, int quality, unsigned char *quant, float *scale)
+{
+	int s = quality < 50 ? 5000 / quality : 200 - quality*2;
+	for (int i=0; i<64; i++)
+	{
+		int q = (base[i] * s + 50) / 100;
+		if (q < 1)		q = 1;
+		if (q > 255)	q = 255;
+		quant[__zigzag[i]] = (unsigned char)q;
+		scale[i] = 1.0f / (q * __aanScale[i>>3] * __aanScale[i&7] * 8.0f);
+	}
+}
+
+//AAN forward DCT of 8 samples a step apart, in place; outputs are scaled by __aanScale
+static void __DCT8(float *d, int step)
+{
+	float t0 = d[0]+d[7*step], t7 = d[0]-d[7*step];
+	float t1 = d[step]+d[6*step], t6 = d[step]-d[6*step];
+	float t2 = d[2*step]+d[5*step], t5 = d[2*step]-d[5*step];
+	float t3 = d[3*step]+d[4*step], t4 = d[3*step]-d[4*step];
+
+	float t10 = t0+t3, t13 = t0-t3, t11 = t1+t2, t12 = t1-t2;
+	d[0]		=	t10+t11;
+	d[4*step]	=	t10-t11;
+	float z1 = (t12+t13) * 0.707106781f;
+	d[2*step]	=	t13+z1;
+	d[6*step]	=	t13-z1;
+
+	t10 = t4+t5;	t11 = t5+t6;	t12 = t6+t7;
+	float z5 = (t10-t12) * 0.382683433f;
+	float z2 = t10 * 0.541196100f + z5;
+	float z4 = t12 * 1.306562965f + z5;
+	float z3 = t11 * 0.707106781f;
+	float z11 = t7+z3, z13 = t7-z3;
+	d[5*step]	=	z13+z2;
+	d[3*step]	=	z13-z2;
+	d[step]		=	z11+z4;
+	d[7*step]	=	z11-z4;
+}
+
+//8x8 samples at x, y of a plane, centred on 0; the last row and column repeat past the edge
+static void __LoadBlock(const unsigned char *pPlane, int stride, int width, int height, int x, int y, const float *lut, float *block)
+{
+	for (int row=0; row<8; row++)
+	{
+		const unsigned char *p = pPlane + (size_t)(y+row < height ? y+row : height-1) * stride;
+		float *b = block + row*8;
+		if (x+8 <= width)
+		{
+			for (int col=0; col<8; col++)	b[col] = lut[p[x+col]];
+		}
+		else
+		{
+			for (int col=0; col<8; col++)	b[col] = lut[p[x+col < width ? x+col : width-1]];
+		}
+	}
+}
+
+
+CVideoJpeg::CVideoJpeg(void)
+{
+	pOut		=	NULL;
+	outLen		=	0;
+	outCapacity	=	0;
+	bitBuf		=	0;
+	bitCnt		=	0;
+	Init(VJ_DEFAULT_QUALITY);
+}
+
+CVideoJpeg::~CVideoJpeg(void)
+{
+	Deinit();
+}
+
+int		CVideoJpeg::Init(int quality)
+{
+	if (quality < 1)	quality = 1;
+	if (quality > 100)	quality = 100;
+
+	__Quality(__baseQuantY, quality, quantY, scaleY);
+	__Quality(__baseQuantC, quality, quantC, scaleC);
+	__BuildCodes(__countDcY, __symbolDc, codeDcY);
+	__BuildCodes(__countDcC, __symbolDc, codeDcC);
+	__BuildCodes(__countAcY, __symbolAcY, codeAcY);
+	__BuildCodes(__countAcC, __symbolAcC, codeAcC);
+	return 0;
+}
+
+void	CVideoJpeg::Deinit()
+{
+	if (NULL != pOut)
+	{
+		free(pOut);
+		pOut = NULL;
+	}
+	outLen		=	0;
+	outCapacity	=	0;
+}
+
+int		CVideoJpeg::Reserve(int bytes)
+{
+	if (outLen + bytes <= outCapacity)		return 0;
+
+	int capacity = outCapacity > 0 ? outCapacity : 4096;
+	while (capacity < outLen + bytes)	capacity *= 2;
+	unsigned char *p = (unsigned char *)realloc(pOut, capacity);
+	if (NULL == p)		return -1;
+	pOut		=	p;
+	outCapacity	=	capacity;
+	return 0;
+}
+
+void	CVideoJpeg::PutBytes(const unsigned char *p, int n)
+{
+	memcpy(pOut + outLen, p, n);
+	outLen += n;
+}
+
+//bits gather at the top of bitBuf, every 0xFF byte out is followed by a stuffed 0x00
+void	CVideoJpeg::PutBits(unsigned int code, int len)
+{
+	bitCnt += len;
+	bitBuf |= code << (24 - bitCnt);
+	while (bitCnt >= 8)
+	{
+		unsigned char c = (unsigned char)(bitBuf >> 16);
+		pOut[outLen++] = c;
+		if (c == 0xFF)	pOut[outLen++] = 0x00;
+		bitBuf <<= 8;
+		bitCnt -= 8;
+	}
+}
+
+//the magnitude category of v and its bits, negative values one's complemented
+static inline void __Category(int v, unsigned int *bits, int *len)
+{
+	int a = v < 0 ? -v : v;
+	int n = 0;
+	while (a)	{n ++;	a >>= 1;}
+	*len	=	n;
+	*bits	=	(unsigned int)(v < 0 ? v-1 : v) & ((1u << n) - 1);
+}
+
+//transforms, quantizes and writes one block in place, returns its DC
+int		CVideoJpeg::EncodeBlock(const float *_block, const float *scale, int dc, unsigned short (*codeDc)[2], unsigned short (*codeAc)[2])
+{
+	float block[64];
+	memcpy(block, _block, sizeof(block));
+	for (int i=0; i<8; i++)		__DCT8(block + i*8, 1);
+	for (int i=0; i<8; i++)		__DCT8(block + i, 8);
+
+	int q[64];
+	for (int i=0; i<64; i++)
+	{
+		float v = block[i] * scale[i];
+		q[__zigzag[i]] = (int)(v < 0 ? v - 0.5f : v + 0.5f);
+	}
+
+	unsigned int bits;
+	int len;
+	__Category(q[0] - dc, &bits, &len);
+	PutBits(codeDc[len][0], codeDc[len][1]);
+	if (len > 0)	PutBits(bits, len);
+
+	int last = 63;
+	while (last > 0 && q[last] == 0)	last --;
+	for (int i=1; i<=last; i++)
+	{
+		int zeros = 0;
+		while (q[i] == 0)	{zeros ++;	i ++;}
+		for (; zeros >= 16; zeros -= 16)	PutBits(codeAc[0xF0][0], codeAc[0xF0][1]);
+		__Category(q[i], &bits, &len);
+		PutBits(codeAc[zeros*16 + len][0], codeAc[zeros*16 + len][1]);
+		PutBits(bits, len);
+	}
+	if (last != 63)		PutBits(codeAc[0x00][0], codeAc[0x00][1]);
+	return q[0];
+}
+
+int		CVideoJpeg::Encode(const VC_FRAME_T *frame, VC_RANGE range)
+{
+	if (NULL == frame)		return -1;
+	if (frame->format != VC_FORMAT_YUV420P && frame->format != VC_FORMAT_YV12)		return -1;
+	if (frame->width < 1 || frame->height < 1 || frame->width > VJ_MAX_SIZE || frame->height > VJ_MAX_SIZE)		return -1;
+
+	//JFIF is full range: Y 16-235 and UV 16-240 stretched to 0-255
+	float lutY[256], lutC[256];
+	for (int i=0; i<256; i++)
+	{
+		float y = range == VC_RANGE_FULL ? (float)i : (i - 16) * (255.0f / 219.0f);
+		float c = range == VC_RANGE_FULL ? (float)i : (i - 128) * (255.0f / 224.0f) + 128.0f;
+		lutY[i] = (y < 0 ? 0 : (y > 255 ? 255 : y)) - 128.0f;
+		lutC[i] = (c < 0 ? 0 : (c > 255 ? 255 : c)) - 128.0f;
+	}
+
+	int width = frame->width, height = frame->height;
+	int cw = (width + 1) / 2, ch = (height + 1) / 2;
+	int planeU = frame->format == VC_FORMAT_YV12 ? 2 : 1;
+
+	//a 16x16 MCU never takes more than this, stuffing included
+	const int mcuBytes = 6 * 64 * 8;
+	outLen	=	0;
+	bitBuf	=	0;
+	bitCnt	=	0;
+	if (Reserve(1024) < 0)		return -1;
+
+	static const unsigned char soi[] = {0xFF,0xD8, 0xFF,0xE0,0x00,0x10,'J','F','I','F',0x00,0x01,0x01,0x00,0x00,0x01,0x00,0x01,0x00,0x00};
+	PutBytes(soi, sizeof(soi));
+
+	unsigned char dqt[5] = {0xFF,0xDB,0x00,0x84,0x00};
+	PutBytes(dqt, 5);
+	PutBytes(quantY, 64);
+	pOut[outLen++] = 0x01;
+	PutBytes(quantC, 64);
+
+	unsigned char sof[19] = {0xFF,0xC0,0x00,0x11,0x08,
+		(unsigned char)(height>>8), (unsigned char)height, (unsigned char)(width>>8), (unsigned char)width,
+		0x03, 0x01,0x22,0x00, 0x02,0x11,0x01, 0x03,0x11,0x01};
+	PutBytes(sof, sizeof(sof));
+
+	unsigned char dht[4] = {0xFF,0xC4,0x01,0xA2};
+	PutBytes(dht, 4);
+	pOut[outLen++] = 0x00;	PutBytes(__countDcY, 16);	PutBytes(__symbolDc, 12);
+	pOut[outLen++] = 0x10;	PutBytes(__countAcY, 16);	PutBytes(__symbolAcY, 162);
+	pOut[outLen++] = 0x01;	PutBytes(__countDcC, 16);	PutBytes(__symbolDc, 12);
+	pOut[outLen++] = 0x11;	PutBytes(__countAcC, 16);	PutBytes(__symbolAcC, 162);
+
+	static const unsigned char sos[] = {0xFF,0xDA,0x00,0x0C,0x03,0x01,0x00,0x02,0x11,0x03,0x11,0x00,0x3F,0x00};
+	PutBytes(sos, sizeof(sos));
+
+	float block[64];
+	int dcY = 0, dcU = 0, dcV = 0;
+	for (int y=0; y<height; y+=16)
+	{
+		for (int x=0; x<width; x+=16)
+		{
+			if (Reserve(mcuBytes) < 0)		return -1;
+			for (int i=0; i<4; i++)
+			{
+				int bx = x + (i&1)*8, by = y + (i>>1)*8;
+				//blocks wholly past the edge still go out, as copies of the edge
+				__LoadBlock(frame->plane[0], frame->stride[0], width, height, bx < width ? bx : width-1, by < height ? by : height-1, lutY, block);
+				dcY = EncodeBlock(block, scaleY, dcY, codeDcY, codeAcY);
+			}
+			__LoadBlock(frame->plane[planeU], frame->stride[planeU], cw, ch, x/2, y/2, lutC, block);
+			dcU = EncodeBlock(block, scaleC, dcU, codeDcC, codeAcC);
+			__LoadBlock(frame->plane[3-planeU], frame->stride[3-planeU], cw, ch, x/2, y/2, lutC, block);
+			dcV = EncodeBlock(block, scaleC, dcV, codeDcC, codeAcC);
+		}
+	}
+
+	if (Reserve(16) < 0)		return -1;
+	PutBits(0x7F, 7);			//pad the last byte with ones
+	pOut[outLen++] = 0xFF;
+	pOut[outLen++] = 0xD9;
+	return outLen;
+}
@@ -0,0 +1,55 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VIDEO_JPEG_H__
+#define __VIDEO_JPEG_H__
+
+#include "VideoConverter.h"
+
+#define		VJ_DEFAULT_QUALITY		75				//1-100, as libjpeg scales its tables
+#define		VJ_MAX_SIZE				8192			//largest width or height
+
+//Baseline JFIF encoder taking the decoder's YUV420P as it is: 4:2:0 MCUs are cut straight from
+//the planes, limited range samples are stretched to full range on the way, standard Huffman tables
+class CVideoJpeg
+{
+public:
+	CVideoJpeg(void);
+	~CVideoJpeg(void);
+
+	int		Init(int quality=VJ_DEFAULT_QUALITY);
+	void	Deinit();
+
+	//a YUV420P or YV12 frame of the given range, returns the size of the JPEG in GetData() or -1
+	int		Encode(const VC_FRAME_T *frame, VC_RANGE range);
+
+	const unsigned char	*GetData()	{return pOut;}
+	int		GetSize()		{return outLen;}
+
+protected:
+	unsigned char	quantY[64];			//zigzag order, as written to DQT
+	unsigned char	quantC[64];
+	float			scaleY[64];			//1/(quant*AAN scale), natural order
+	float			scaleC[64];
+	unsigned short	codeDcY[12][2];		//code, length
+	unsigned short	codeAcY[256][2];
+	unsigned short	codeDcC[12][2];
+	unsigned short	codeAcC[256][2];
+
+	unsigned char	*pOut;
+	int				outLen;
+	int				outCapacity;
+	unsigned int	bitBuf;
+	int				bitCnt;
+
+	int		Reserve(int bytes);
+	void	PutBytes(const unsigned char *p, int n);
+	void	PutBits(unsigned int code, int len);
+	int		EncodeBlock(const float *block, const float *scale, int dc, unsigned short (*codeDc)[2], unsigned short (*codeAc)[2]);
+};
+
+#endif
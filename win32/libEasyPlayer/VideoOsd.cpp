@@ -0,0 +1,463 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "VideoOsd.h"
+#include "vssimd.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define		VOSD_GLYPHS		(VOSD_LAST_CHAR - VOSD_FIRST_CHAR + 1)
+#define		VOSD_MAX_WIDTH	4096
+
+#if defined(__VS_AVX2)
+__VS_TARGET_AVX2 static int __BlendRowAvx2(unsigned char *pDst, const unsigned char *pColor, const unsigned char *pInvAlpha, int n)
+{
+	int i = 0;
+	const __m256i zero8 = _mm256_setzero_si256(), round8 = _mm256_set1_epi16(128);
+	for (; i+32<=n; i+=32)
+	{
+		__m256i d = _mm256_loadu_si256((const __m256i*)(pDst+i));
+		__m256i a = _mm256_loadu_si256((const __m256i*)(pInvAlpha+i));
+		__m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero8), _mm256_unpacklo_epi8(a, zero8)), round8);
+		__m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero8), _mm256_unpackhi_epi8(a, zero8)), round8);
+		lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+		hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+		__m256i c = _mm256_loadu_si256((const __m256i*)(pColor+i));
+		_mm256_storeu_si256((__m256i*)(pDst+i), _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), c));
+	}
+	_mm256_zeroupper();
+	return i;
+}
+#endif
+
+//dst = color + dst*invAlpha/255, the division rounded as (t + (t>>8)) >> 8 with t = dst*invAlpha + 128
+static void __BlendRow(unsigned char *pDst, const unsigned char *pColor, const unsigned char *pInvAlpha, int n, int simd)
+{
+	int i = 0;
+	if (simd)
+	{
+#if defined(__VS_AVX2)
+		if (_VS_UseAvx2())		i = __BlendRowAvx2(pDst, pColor, pInvAlpha, n);
+#endif
+#if defined(__VS_SSE2)
+		const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi16(128);
+		for (; i+16<=n; i+=16)
+		{
+			__m128i d = _mm_loadu_si128((const __m128i*)(pDst+i));
+			__m128i a = _mm_loadu_si128((const __m128i*)(pInvAlpha+i));
+			__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(a, zero)), round);
+			__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(a, zero)), round);
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+			__m128i c = _mm_loadu_si128((const __m128i*)(pColor+i));
+			_mm_storeu_si128((__m128i*)(pDst+i), _mm_adds_epu8(_mm_packus_epi16(lo, hi), c));
+		}
+#elif defined(__VS_NEON)
+		for (; i+16<=n; i+=16)
+		{
+			uint8x16_t d = vld1q_u8(pDst+i);
+			uint8x16_t a = vld1q_u8(pInvAlpha+i);
+			uint16x8_t lo = vmull_u8(vget_low_u8(d), vget_low_u8(a));
+			uint16x8_t hi = vmull_u8(vget_high_u8(d), vget_high_u8(a));
+			//(x + ((x+128)>>8) + 128) >> 8, the same rounding as below
+			uint8x16_t r = vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)), vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+			vst1q_u8(pDst+i, vqaddq_u8(r, vld1q_u8(pColor+i)));
+		}
+#endif
+	}
+	for (; i<n; i++)
+	{
+		int t = pDst[i] * pInvAlpha[i] + 128;
+		int v = pColor[i] + ((t + (t >> 8)) >> 8);
+		pDst[i] = (unsigned char)(v > 255 ? 255 : v);
+	}
+}
+
+//0x00BBGGRR to the byte values of each channel: B, G, R, A for the RGB formats, Y, U, V for the others
+static void __Channels(unsigned int color, int yuv, int *c)
+{
+	int r = color & 0xFF, g = (color >> 8) & 0xFF, b = (color >> 16) & 0xFF;
+	if (!yuv)
+	{
+		c[0] = b;	c[1] = g;	c[2] = r;	c[3] = 255;
+		return;
+	}
+	//BT.601 limited range, what the decoder output is converted with
+	c[0] = (int)(16.5  + ( 65.481*r + 128.553*g +  24.966*b) / 255);
+	c[1] = (int)(128.5 + (-37.797*r -  74.203*g + 112.0  *b) / 255);
+	c[2] = (int)(128.5 + (112.0  *r -  93.786*g -  18.214*b) / 255);
+	c[3] = 255;
+}
+
+//text and shadow weights of each pixel with the overlay alpha applied, their sum the pixel's alpha
+static void __Weights(const unsigned char *pCoverage, int width, int height, int shadow, int alpha, unsigned char *pText, unsigned char *pShadow)
+{
+	for (int y=0; y<height; y++)
+	{
+		for (int x=0; x<width; x++)
+		{
+			int t = pCoverage[y * width + x];
+			int s = (x >= shadow && y >= shadow) ? pCoverage[(y-shadow) * width + x-shadow] : 0;
+			int cov = t * 255 + s * (255 - t);
+			int a = (alpha * cov + 32512) / 65025;
+			int wt = (alpha * t * 255 + 32512) / 65025;
+			if (wt > a)		wt = a;
+			pText[y * width + x]	=	(unsigned char)wt;
+			pShadow[y * width + x]	=	(unsigned char)(a - wt);
+		}
+	}
+}
+
+static inline void __Put(unsigned char *pColor, unsigned char *pInvAlpha, int tc, int sc, int wt, int ws)
+{
+	*pColor		=	(unsigned char)((tc * wt + sc * ws + 127) / 255);
+	*pInvAlpha	=	(unsigned char)(255 - wt - ws);
+}
+
+#ifdef _WIN32
+//the default glyph source: GDI draws each character into a DIB section, its green channel is the coverage
+typedef struct __VOSD_GDI_T
+{
+	HDC				hDC;
+	unsigned int	*pBits;
+	int				width;
+	int				height;
+}VOSD_GDI_T;
+
+static int __GdiGlyph(void *userPtr, char ch, unsigned char *pAlpha, int stride, int cellWidth, int height)
+{
+	VOSD_GDI_T *gdi = (VOSD_GDI_T *)userPtr;
+	memset(gdi->pBits, 0x00, gdi->width * gdi->height * 4);
+	TextOutA(gdi->hDC, 0, 0, &ch, 1);
+	GdiFlush();
+	for (int y=0; y<height && y<gdi->height; y++)
+	{
+		for (int x=0; x<cellWidth && x<gdi->width; x++)		pAlpha[y * stride + x] = (unsigned char)(gdi->pBits[y * gdi->width + x] >> 8);
+	}
+	SIZE size;
+	if (!GetTextExtentPoint32A(gdi->hDC, &ch, 1, &size))		return 0;
+	return size.cx;
+}
+#endif
+
+
+CVideoOsd::CVideoOsd(void)
+{
+	fontHeight	=	0;
+	cellWidth	=	0;
+	pAtlas		=	NULL;
+	memset(advance, 0x00, sizeof(advance));
+	textColor	=	0x00FFFFFF;
+	shadowColor	=	0x00151515;
+	alpha		=	255;
+	text[0]		=	'\0';
+	width		=	0;
+	height		=	0;
+	shadow		=	1;
+	pCoverage	=	NULL;
+	builtFormat	=	-1;
+	pOverlay	=	NULL;
+	memset(pColor, 0x00, sizeof(pColor));
+	memset(pInvAlpha, 0x00, sizeof(pInvAlpha));
+	memset(planeBytes, 0x00, sizeof(planeBytes));
+	memset(planeRows, 0x00, sizeof(planeRows));
+}
+
+CVideoOsd::~CVideoOsd(void)
+{
+	Deinit();
+}
+
+int		CVideoOsd::Init(int _fontHeight, VOSD_GLYPH_CALLBACK callback, void *userPtr)
+{
+	Deinit();
+	if (_fontHeight < 4 || _fontHeight > VOSD_MAX_FONT_HEIGHT)		return -1;
+
+	fontHeight	=	_fontHeight;
+	cellWidth	=	_fontHeight + _fontHeight / 4;		//wide enough for 'W' in the usual faces
+	shadow		=	_fontHeight >= 32 ? _fontHeight / 16 : 1;
+	pAtlas = (unsigned char *)calloc(VOSD_GLYPHS, cellWidth * fontHeight);
+	if (NULL == pAtlas)		return -1;
+
+#ifdef _WIN32
+	VOSD_GDI_T gdi;
+	HBITMAP hBitmap = NULL;
+	HFONT hFont = NULL;
+	memset(&gdi, 0x00, sizeof(VOSD_GDI_T));
+	if (NULL == callback)
+	{
+		BITMAPINFO bmi;
+		memset(&bmi, 0x00, sizeof(BITMAPINFO));
+		bmi.bmiHeader.biSize		=	sizeof(BITMAPINFOHEADER);
+		bmi.bmiHeader.biWidth		=	cellWidth;
+		bmi.bmiHeader.biHeight		=	-fontHeight;
+		bmi.bmiHeader.biPlanes		=	1;
+		bmi.bmiHeader.biBitCount	=	32;
+		bmi.bmiHeader.biCompression	=	BI_RGB;
+
+		gdi.width	=	cellWidth;
+		gdi.height	=	fontHeight;
+		gdi.hDC		=	CreateCompatibleDC(NULL);
+		if (NULL != gdi.hDC)	hBitmap = CreateDIBSection(gdi.hDC, &bmi, DIB_RGB_COLORS, (void **)&gdi.pBits, NULL, 0);
+		if (NULL != hBitmap)	hFont = CreateFontA(fontHeight, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE, ANSI_CHARSET, OUT_DEFAULT_PRECIS,
+													CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_SWISS, "Arial");
+		if (NULL != hFont)
+		{
+			SelectObject(gdi.hDC, hBitmap);
+			SelectObject(gdi.hDC, hFont);
+			SetTextColor(gdi.hDC, RGB(0xff, 0xff, 0xff));
+			SetBkMode(gdi.hDC, TRANSPARENT);
+			callback	=	__GdiGlyph;
+			userPtr		=	&gdi;
+		}
+	}
+#endif
+
+	int ret = -1;
+	if (NULL != callback)
+	{
+		for (int i=0; i<VOSD_GLYPHS; i++)
+		{
+			int adv = callback(userPtr, (char)(VOSD_FIRST_CHAR + i), pAtlas + i * cellWidth * fontHeight, cellWidth, cellWidth, fontHeight);
+			advance[i] = adv < 0 ? 0 : (adv > cellWidth ? cellWidth : adv);
+		}
+		ret = 0;
+	}
+
+#ifdef _WIN32
+	if (NULL != hFont)		DeleteObject(hFont);
+	if (NULL != hBitmap)	DeleteObject(hBitmap);
+	if (NULL != gdi.hDC)	DeleteDC(gdi.hDC);
+#endif
+
+	if (ret < 0)	Deinit();
+	return ret;
+}
+
+void	CVideoOsd::Deinit()
+{
+	if (NULL != pAtlas)		free(pAtlas);
+	if (NULL != pCoverage)	free(pCoverage);
+	if (NULL != pOverlay)	free(pOverlay);
+	pAtlas		=	NULL;
+	pCoverage	=	NULL;
+	pOverlay	=	NULL;
+	fontHeight	=	0;
+	text[0]		=	'\0';
+	width		=	0;
+	height		=	0;
+	builtFormat	=	-1;
+}
+
+void	CVideoOsd::SetColor(unsigned int _textColor, unsigned int _shadowColor, int _alpha)
+{
+	if (_alpha < 0)		_alpha = 0;
+	if (_alpha > 255)	_alpha = 255;
+	if (_textColor == textColor && _shadowColor == shadowColor && _alpha == alpha)	return;
+
+	textColor	=	_textColor & 0x00FFFFFF;
+	shadowColor	=	_shadowColor & 0x00FFFFFF;
+	alpha		=	_alpha;
+	builtFormat	=	-1;
+}
+
+int		CVideoOsd::SetText(const char *_text)
+{
+	if (NULL == pAtlas || NULL == _text)		return -1;
+	if (NULL != pCoverage && 0 == strncmp(text, _text, VOSD_MAX_TEXT-1))		return 0;
+
+	strncpy(text, _text, VOSD_MAX_TEXT-1);
+	text[VOSD_MAX_TEXT-1] = '\0';
+
+	int glyph[VOSD_MAX_TEXT];
+	int num = 0, textWidth = 0;
+	for (const char *p=text; *p; p++)
+	{
+		int g = (unsigned char)*p;
+		if (g < VOSD_FIRST_CHAR || g > VOSD_LAST_CHAR)	g = '?';
+		g -= VOSD_FIRST_CHAR;
+		if (textWidth + cellWidth + shadow > VOSD_MAX_WIDTH)	break;
+		glyph[num++] = g;
+		textWidth += advance[g];
+	}
+
+	if (NULL != pCoverage)	free(pCoverage);
+	width		=	textWidth + (cellWidth - (num > 0 ? advance[glyph[num-1]] : 0)) + shadow;		//room for the last glyph's overhang
+	height		=	fontHeight + shadow;
+	builtFormat	=	-1;
+	pCoverage = (unsigned char *)calloc(width, height);
+	if (NULL == pCoverage)
+	{
+		text[0] = '\0';
+		width = height = 0;
+		return -1;
+	}
+
+	int pen = 0;
+	for (int i=0; i<num; i++)
+	{
+		const unsigned char *pGlyph = pAtlas + glyph[i] * cellWidth * fontHeight;
+		for (int y=0; y<fontHeight; y++)
+		{
+			unsigned char *pRow = pCoverage + y * width + pen;
+			for (int x=0; x<cellWidth; x++)
+			{
+				if (pGlyph[y * cellWidth + x] > pRow[x])	pRow[x] = pGlyph[y * cellWidth + x];		//overlapping neighbours
+			}
+		}
+		pen += advance[glyph[i]];
+	}
+	return 1;
+}
+
+int		CVideoOsd::BuildPlanes(VC_FORMAT format)
+{
+	int cw = (width + 1) / 2, ch = (height + 1) / 2;
+	memset(planeBytes, 0x00, sizeof(planeBytes));
+	memset(planeRows, 0x00, sizeof(planeRows));
+	switch (format)
+	{
+	case VC_FORMAT_BGRA:	planeBytes[0] = width * 4;	planeRows[0] = height;	break;
+	case VC_FORMAT_BGR24:	planeBytes[0] = width * 3;	planeRows[0] = height;	break;
+	case VC_FORMAT_YUY2:
+	case VC_FORMAT_UYVY:	planeBytes[0] = cw * 4;		planeRows[0] = height;	break;
+	case VC_FORMAT_YUV420P:
+	case VC_FORMAT_YV12:
+		planeBytes[0] = width;	planeRows[0] = height;
+		planeBytes[1] = cw;		planeRows[1] = ch;
+		planeBytes[2] = cw;		planeRows[2] = ch;
+		break;
+	default:
+		return -1;
+	}
+
+	size_t total = (size_t)width * height * 2;		//the weights
+	for (int p=0; p<3; p++)		total += (size_t)planeBytes[p] * planeRows[p] * 2;
+	if (NULL != pOverlay)	free(pOverlay);
+	pOverlay = (unsigned char *)malloc(total);
+	if (NULL == pOverlay)	return -1;
+
+	unsigned char *pText = pOverlay, *pShadow = pOverlay + width * height;
+	unsigned char *pBuf = pShadow + width * height;
+	for (int p=0; p<3; p++)
+	{
+		pColor[p]		=	pBuf;
+		pInvAlpha[p]	=	pBuf + planeBytes[p] * planeRows[p];
+		pBuf += planeBytes[p] * planeRows[p] * 2;
+		memset(pColor[p], 0x00, planeBytes[p] * planeRows[p]);
+		memset(pInvAlpha[p], 0xFF, planeBytes[p] * planeRows[p]);		//bytes no pixel reaches, e.g. past an odd width
+	}
+	__Weights(pCoverage, width, height, shadow, alpha, pText, pShadow);
+
+	int yuv = (format == VC_FORMAT_BGRA || format == VC_FORMAT_BGR24) ? 0 : 1;
+	int tc[4], sc[4];
+	__Channels(textColor, yuv, tc);
+	__Channels(shadowColor, yuv, sc);
+
+	if (!yuv)
+	{
+		int bpp = format == VC_FORMAT_BGRA ? 4 : 3;
+		for (int i=0; i<width*height; i++)
+		{
+			for (int c=0; c<bpp; c++)	__Put(pColor[0] + i*bpp + c, pInvAlpha[0] + i*bpp + c, tc[c], sc[c], pText[i], pShadow[i]);
+		}
+	}
+	else
+	{
+		int rows = (format == VC_FORMAT_YUV420P || format == VC_FORMAT_YV12) ? 2 : 1;		//chroma rows per block
+		for (int y=0; y<height; y++)
+		{
+			for (int x=0; x<width; x++)
+			{
+				int i = y * width + x;
+				if (rows == 2)	__Put(pColor[0] + i, pInvAlpha[0] + i, tc[0], sc[0], pText[i], pShadow[i]);
+				else			__Put(pColor[0] + y * planeBytes[0] + (x/2)*4 + (format == VC_FORMAT_YUY2 ? 0 : 1) + (x&1)*2,
+									pInvAlpha[0] + y * planeBytes[0] + (x/2)*4 + (format == VC_FORMAT_YUY2 ? 0 : 1) + (x&1)*2,
+									tc[0], sc[0], pText[i], pShadow[i]);
+			}
+		}
+
+		//chroma weights are the mean over the block, pixels past the edge count as transparent
+		for (int y=0; y<(height + rows - 1) / rows; y++)
+		{
+			for (int x=0; x<cw; x++)
+			{
+				int sumT = 0, sumA = 0;
+				for (int dy=0; dy<rows; dy++)
+				{
+					for (int dx=0; dx<2; dx++)
+					{
+						int px = 2*x + dx, py = y*rows + dy;
+						if (px >= width || py >= height)	continue;
+						sumT += pText[py * width + px];
+						sumA += pText[py * width + px] + pShadow[py * width + px];
+					}
+				}
+				int n = rows * 2;
+				int a = (sumA + n/2) / n, wt = (sumT + n/2) / n;
+				if (wt > a)		wt = a;
+				if (rows == 2)
+				{
+					__Put(pColor[1] + y * cw + x, pInvAlpha[1] + y * cw + x, tc[1], sc[1], wt, a - wt);
+					__Put(pColor[2] + y * cw + x, pInvAlpha[2] + y * cw + x, tc[2], sc[2], wt, a - wt);
+				}
+				else
+				{
+					int u = format == VC_FORMAT_YUY2 ? 1 : 0;
+					int off = y * planeBytes[0] + x * 4;
+					__Put(pColor[0] + off + u, pInvAlpha[0] + off + u, tc[1], sc[1], wt, a - wt);
+					__Put(pColor[0] + off + u + 2, pInvAlpha[0] + off + u + 2, tc[2], sc[2], wt, a - wt);
+				}
+			}
+		}
+	}
+
+	builtFormat = format == VC_FORMAT_YV12 ? VC_FORMAT_YUV420P : format;
+	return 0;
+}
+
+int		CVideoOsd::Blend(VC_FRAME_T *frame, int x, int y, int simd)
+{
+	if (NULL == frame)		return -1;
+	if (frame->format == VC_FORMAT_RGB565 || frame->format == VC_FORMAT_RGB555 || frame->format > VC_FORMAT_BGR24)		return -1;
+	if (NULL == pCoverage || width < 1)		return 0;
+
+	VC_FORMAT format = frame->format == VC_FORMAT_YV12 ? VC_FORMAT_YUV420P : frame->format;
+	if (builtFormat != format && BuildPlanes(format) < 0)		return -1;
+
+	x = x < 0 ? 0 : (x & ~1);
+	y = y < 0 ? 0 : (y & ~1);
+	int w = frame->width - x < width ? frame->width - x : width;
+	int h = frame->height - y < height ? frame->height - y : height;
+	if (w < 1 || h < 1)		return 0;
+
+	for (int p=0; p<3; p++)
+	{
+		if (planeBytes[p] < 1)	continue;
+
+		//bytes and pixels of one unit of the plane, chroma rows per overlay row
+		int unitBytes = 1, unitPixels = 1, rowDiv = 1;
+		if (format == VC_FORMAT_BGRA)						unitBytes = 4;
+		else if (format == VC_FORMAT_BGR24)					unitBytes = 3;
+		else if (format == VC_FORMAT_YUY2 || format == VC_FORMAT_UYVY)	{unitBytes = 4;	unitPixels = 2;}
+		else if (p > 0)										{unitPixels = 2;	rowDiv = 2;}
+
+		int bytes = (w + unitPixels - 1) / unitPixels * unitBytes;
+		int rows = (h + rowDiv - 1) / rowDiv;
+		int plane = (p > 0 && frame->format == VC_FORMAT_YV12) ? 3 - p : p;
+		unsigned char *pDst = frame->plane[plane] + (size_t)(y / rowDiv) * frame->stride[plane] + x / unitPixels * unitBytes;
+		for (int r=0; r<rows; r++)
+		{
+			__BlendRow(pDst + (size_t)r * frame->stride[plane], pColor[p] + r * planeBytes[p], pInvAlpha[p] + r * planeBytes[p], bytes, simd);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,75 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VIDEO_OSD_H__
+#define __VIDEO_OSD_H__
+
+#include "VideoConverter.h"
+#include <stddef.h>
+
+#define		VOSD_FIRST_CHAR			0x20			//the atlas holds printable ASCII, others show as '?'
+#define		VOSD_LAST_CHAR			0x7E
+#define		VOSD_MAX_TEXT			256
+#define		VOSD_MAX_FONT_HEIGHT	96
+
+//draws ch white on black into a cell of the font height, returns its advance in pixels.
+//Called once per character when the atlas is built
+typedef int (*VOSD_GLYPH_CALLBACK)(void *userPtr, char ch, unsigned char *pAlpha, int stride, int cellWidth, int height);
+
+//A line of text with a drop shadow, rasterized once per SetText from a cached glyph atlas
+//into a premultiplied overlay in the target frame's own byte layout, so Blend is a single
+//pass of dst = overlay + dst*(255-alpha)/255 over the bytes it covers
+class CVideoOsd
+{
+public:
+	CVideoOsd(void);
+	~CVideoOsd(void);
+
+	//glyphs from callback, or from GDI on Windows when it is NULL
+	int		Init(int fontHeight, VOSD_GLYPH_CALLBACK callback=NULL, void *userPtr=NULL);
+	void	Deinit();
+
+	//colors are 0x00BBGGRR as RGB() makes them, alpha 0-255 applies to the whole overlay
+	void	SetColor(unsigned int _textColor, unsigned int _shadowColor, int _alpha);
+	//returns 1 if the overlay was rebuilt, 0 if the text is the same as before
+	int		SetText(const char *text);
+
+	//onto a frame of any VC_FORMAT but RGB565/RGB555 (-1), top left at x, y rounded down to even;
+	//whatever falls outside the frame is left out. simd 0 runs the scalar reference
+	int		Blend(VC_FRAME_T *frame, int x, int y, int simd=1);
+
+	int		GetFontHeight()	{return fontHeight;}
+	int		GetWidth()		{return width;}
+	int		GetHeight()		{return height;}
+
+protected:
+	int				fontHeight;
+	int				cellWidth;
+	unsigned char	*pAtlas;		//cellWidth x fontHeight per character
+	int				advance[VOSD_LAST_CHAR - VOSD_FIRST_CHAR + 1];
+
+	unsigned int	textColor;
+	unsigned int	shadowColor;
+	int				alpha;
+
+	char			text[VOSD_MAX_TEXT];
+	int				width;
+	int				height;
+	int				shadow;			//offset of the shadow, down and right
+	unsigned char	*pCoverage;		//of the text alone, width x height
+
+	int				builtFormat;	//format the planes below are laid out for, -1 none
+	unsigned char	*pOverlay;
+	unsigned char	*pColor[3];		//premultiplied bytes, one plane per frame plane (U before V)
+	unsigned char	*pInvAlpha[3];	//255 - alpha of each byte
+	int				planeBytes[3];	//per row
+	int				planeRows[3];
+
+	int		BuildPlanes(VC_FORMAT format);
+};
+
+#endif
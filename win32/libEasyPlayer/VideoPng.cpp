@@ -0,0 +1,309 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "VideoPng.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define		VPNG_WINDOW			32768
+#define		VPNG_MAX_MATCH		258
+
+//RFC 1951 3.2.5
+static const unsigned short __lengthBase[29] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+static const unsigned char __lengthExtra[29] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+static const unsigned short __distBase[30] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577};
+static const unsigned char __distExtra[30] = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+
+//CRC-32 a nibble at a time, so there is no table to build and share between workers
+static const unsigned int __crcNibble[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+static unsigned int __Crc32(unsigned int crc, const unsigned char *p, int n)
+{
+	crc = ~crc;
+	for (int i=0; i<n; i++)
+	{
+		crc ^= p[i];
+		crc = __crcNibble[crc & 0x0F] ^ (crc >> 4);
+		crc = __crcNibble[crc & 0x0F] ^ (crc >> 4);
+	}
+	return ~crc;
+}
+
+static unsigned int __Adler32(const unsigned char *p, int n)
+{
+	unsigned int a = 1, b = 0;
+	while (n > 0)
+	{
+		int k = n < 5552 ? n : 5552;		//the most bytes before b can overflow
+		n -= k;
+		for (; k>0; k--)	{a += *p++;	b += a;}
+		a %= 65521;
+		b %= 65521;
+	}
+	return (b << 16) | a;
+}
+
+static inline int __Paeth(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = p > a ? p - a : a - p;
+	int pb = p > b ? p - b : b - p;
+	int pc = p > c ? p - c : c - p;
+	if (pa <= pb && pa <= pc)	return a;
+	return pb <= pc ? b : c;
+}
+
+static inline void __Put32(unsigned char *p, unsigned int v)
+{
+	p[0] = (unsigned char)(v >> 24);	p[1] = (unsigned char)(v >> 16);
+	p[2] = (unsigned char)(v >> 8);		p[3] = (unsigned char)v;
+}
+
+
+CVideoPng::CVideoPng(void)
+{
+	pRaw		=	NULL;
+	rawCapacity	=	0;
+	pHead		=	NULL;
+	pOut		=	NULL;
+	outLen		=	0;
+	outCapacity	=	0;
+	bitBuf		=	0;
+	bitCnt		=	0;
+}
+
+CVideoPng::~CVideoPng(void)
+{
+	Deinit();
+}
+
+void	CVideoPng::Deinit()
+{
+	if (NULL != pRaw)	free(pRaw);
+	if (NULL != pHead)	free(pHead);
+	if (NULL != pOut)	free(pOut);
+	pRaw		=	NULL;
+	pHead		=	NULL;
+	pOut		=	NULL;
+	rawCapacity	=	0;
+	outLen		=	0;
+	outCapacity	=	0;
+}
+
+int		CVideoPng::Reserve(int bytes)
+{
+	if (outLen + bytes <= outCapacity)		return 0;
+
+	int capacity = outCapacity > 0 ? outCapacity : 65536;
+	while (capacity < outLen + bytes)	capacity *= 2;
+	unsigned char *p = (unsigned char *)realloc(pOut, capacity);
+	if (NULL == p)		return -1;
+	pOut		=	p;
+	outCapacity	=	capacity;
+	return 0;
+}
+
+//deflate packs bits from the least significant end
+void	CVideoPng::PutBits(unsigned int value, int len)
+{
+	bitBuf |= value << bitCnt;
+	bitCnt += len;
+	while (bitCnt >= 8)
+	{
+		pOut[outLen++] = (unsigned char)bitBuf;
+		bitBuf >>= 8;
+		bitCnt -= 8;
+	}
+}
+
+//Huffman codes go out most significant bit first
+void	CVideoPng::PutCode(unsigned int code, int len)
+{
+	unsigned int r = 0;
+	for (int i=0; i<len; i++)	{r = (r << 1) | (code & 1);	code >>= 1;}
+	PutBits(r, len);
+}
+
+void	CVideoPng::PutLiteral(int c)
+{
+	if (c < 144)	PutCode(0x30 + c, 8);
+	else			PutCode(0x190 + c - 144, 9);
+}
+
+void	CVideoPng::PutMatch(int length, int distance)
+{
+	int i = 28;
+	while (__lengthBase[i] > length)	i --;
+	int symbol = 257 + i;
+	if (symbol < 280)	PutCode(symbol - 256, 7);
+	else				PutCode(0xC0 + symbol - 280, 8);
+	if (__lengthExtra[i])	PutBits(length - __lengthBase[i], __lengthExtra[i]);
+
+	int d = 29;
+	while (__distBase[d] > distance)	d --;
+	PutCode(d, 5);
+	if (__distExtra[d])		PutBits(distance - __distBase[d], __distExtra[d]);
+}
+
+//one final block with the fixed codes; the caller reserved room for the worst case
+void	CVideoPng::Deflate(const unsigned char *p, int n)
+{
+	const int hashSize = 1 << VPNG_HASH_BITS;
+	for (int i=0; i<hashSize; i++)	pHead[i] = -VPNG_WINDOW-1;
+
+	PutBits(1, 1);		//BFINAL
+	PutBits(1, 2);		//BTYPE 01, fixed Huffman
+	int i = 0;
+	while (i < n)
+	{
+		int length = 0, distance = 0;
+		if (i + 3 <= n)
+		{
+			unsigned int h = ((p[i] << 16 | p[i+1] << 8 | p[i+2]) * 2654435761u) >> (32 - VPNG_HASH_BITS);
+			int candidate = pHead[h];
+			pHead[h] = i;
+			if (i - candidate <= VPNG_WINDOW)
+			{
+				int max = n - i < VPNG_MAX_MATCH ? n - i : VPNG_MAX_MATCH;
+				const unsigned char *a = p + candidate, *b = p + i;
+				while (length < max && a[length] == b[length])	length ++;
+				distance = i - candidate;
+			}
+		}
+		if (length >= 3)
+		{
+			PutMatch(length, distance);
+			//only the tail of a long run is worth remembering
+			int end = i + length;
+			for (int k = (end - 3 > i + 1 ? end - 3 : i + 1); k+3 <= n && k < end; k++)
+			{
+				pHead[((p[k] << 16 | p[k+1] << 8 | p[k+2]) * 2654435761u) >> (32 - VPNG_HASH_BITS)] = k;
+			}
+			i = end;
+		}
+		else
+		{
+			PutLiteral(p[i]);
+			i ++;
+		}
+	}
+	PutCode(0, 7);		//end of block
+	if (bitCnt > 0)		PutBits(0, 8 - bitCnt);
+}
+
+void	CVideoPng::PutChunk(const char *type, const unsigned char *pData, int n)
+{
+	__Put32(pOut + outLen, (unsigned int)n);
+	memcpy(pOut + outLen + 4, type, 4);
+	if (pOut + outLen + 8 != pData && n > 0)	memmove(pOut + outLen + 8, pData, n);
+	unsigned int crc = __Crc32(0, pOut + outLen + 4, n + 4);
+	__Put32(pOut + outLen + 8 + n, crc);
+	outLen += 12 + n;
+}
+
+int		CVideoPng::Encode(const VC_FRAME_T *frame)
+{
+	if (NULL == frame || (frame->format != VC_FORMAT_BGR24 && frame->format != VC_FORMAT_BGRA))		return -1;
+	if (frame->width < 1 || frame->height < 1 || frame->width > 16384 || frame->height > 16384)	return -1;
+
+	int width = frame->width, height = frame->height;
+	int bpp = frame->format == VC_FORMAT_BGRA ? 4 : 3;
+	int rowBytes = width * 3;
+	int rawSize = (rowBytes + 1) * height;
+	if (rawCapacity < rawSize + rowBytes*2)
+	{
+		if (NULL != pRaw)	free(pRaw);
+		rawCapacity = 0;
+		pRaw = (unsigned char *)malloc(rawSize + rowBytes*2);
+		if (NULL == pRaw)	return -1;
+		rawCapacity = rawSize + rowBytes*2;
+	}
+	if (NULL == pHead)
+	{
+		pHead = (int *)malloc(sizeof(int) << VPNG_HASH_BITS);
+		if (NULL == pHead)	return -1;
+	}
+
+	//RGB rows at the end of pRaw, the previous one kept for Up and Paeth
+	unsigned char *pRow = pRaw + rawSize, *pPrev = pRow + rowBytes;
+	memset(pPrev, 0x00, rowBytes);
+	for (int y=0; y<height; y++)
+	{
+		const unsigned char *pSrc = frame->plane[0] + (size_t)y * frame->stride[0];
+		for (int x=0; x<width; x++)
+		{
+			pRow[x*3]	=	pSrc[x*bpp+2];
+			pRow[x*3+1]	=	pSrc[x*bpp+1];
+			pRow[x*3+2]	=	pSrc[x*bpp];
+		}
+
+		//None, Sub, Up, Average, Paeth: the one whose bytes, read as signed, are smallest
+		unsigned char *pDst = pRaw + (size_t)y * (rowBytes + 1);
+		int best = 0, bestSum = 0x7FFFFFFF;
+		for (int f=0; f<5; f++)
+		{
+			int sum = 0;
+			for (int i=0; i<rowBytes && sum < bestSum; i++)
+			{
+				int a = i >= 3 ? pRow[i-3] : 0, b = pPrev[i], c = i >= 3 ? pPrev[i-3] : 0;
+				int v = pRow[i];
+				if (f == 1)			v -= a;
+				else if (f == 2)	v -= b;
+				else if (f == 3)	v -= (a + b) >> 1;
+				else if (f == 4)	v -= __Paeth(a, b, c);
+				v = (signed char)(unsigned char)v;
+				sum += v < 0 ? -v : v;
+			}
+			if (sum < bestSum)	{bestSum = sum;	best = f;}
+		}
+		pDst[0] = (unsigned char)best;
+		for (int i=0; i<rowBytes; i++)
+		{
+			int a = i >= 3 ? pRow[i-3] : 0, b = pPrev[i], c = i >= 3 ? pPrev[i-3] : 0;
+			int v = pRow[i];
+			if (best == 1)			v -= a;
+			else if (best == 2)		v -= b;
+			else if (best == 3)		v -= (a + b) >> 1;
+			else if (best == 4)		v -= __Paeth(a, b, c);
+			pDst[1+i] = (unsigned char)v;
+		}
+		unsigned char *t = pPrev;	pPrev = pRow;	pRow = t;
+	}
+
+	//9 bits a literal at worst, plus headers
+	outLen	=	0;
+	bitBuf	=	0;
+	bitCnt	=	0;
+	if (Reserve(rawSize + rawSize/8 + 1024) < 0)		return -1;
+
+	static const unsigned char signature[8] = {0x89,'P','N','G',0x0D,0x0A,0x1A,0x0A};
+	memcpy(pOut, signature, 8);
+	outLen = 8;
+
+	unsigned char ihdr[13];
+	__Put32(ihdr, (unsigned int)width);
+	__Put32(ihdr+4, (unsigned int)height);
+	ihdr[8] = 8;	ihdr[9] = 2;	ihdr[10] = 0;	ihdr[11] = 0;	ihdr[12] = 0;		//8 bit RGB
+	PutChunk("IHDR", ihdr, 13);
+
+	//IDAT is deflated in place, after room for its length and type
+	int idat = outLen;
+	outLen += 8;
+	pOut[outLen++] = 0x78;		//zlib, 32K window
+	pOut[outLen++] = 0x01;
+	Deflate(pRaw, rawSize);
+	__Put32(pOut + outLen, __Adler32(pRaw, rawSize));
+	outLen += 4;
+	int idatSize = outLen - idat - 8;
+	outLen = idat;
+	PutChunk("IDAT", pOut + idat + 8, idatSize);
+
+	PutChunk("IEND", NULL, 0);
+	return outLen;
+}
@@ -0,0 +1,49 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VIDEO_PNG_H__
+#define __VIDEO_PNG_H__
+
+#include "VideoConverter.h"
+
+#define		VPNG_HASH_BITS			15
+
+//24 bit RGB PNG writer without zlib: each row gets the PNG filter with the smallest sum of
+//magnitudes, then one deflate block with the fixed Huffman codes and greedy LZ77 matches
+class CVideoPng
+{
+public:
+	CVideoPng(void);
+	~CVideoPng(void);
+
+	//a BGR24 or BGRA frame (alpha dropped), returns the size of the PNG in GetData() or -1
+	int		Encode(const VC_FRAME_T *frame);
+	void	Deinit();
+
+	const unsigned char	*GetData()	{return pOut;}
+	int		GetSize()		{return outLen;}
+
+protected:
+	unsigned char	*pRaw;			//filtered rows, a filter byte before each
+	int				rawCapacity;
+	int				*pHead;			//last position of each 3 byte hash
+	unsigned char	*pOut;
+	int				outLen;
+	int				outCapacity;
+	unsigned int	bitBuf;
+	int				bitCnt;
+
+	int		Reserve(int bytes);
+	void	PutBits(unsigned int value, int len);
+	void	PutCode(unsigned int code, int len);
+	void	PutLiteral(int c);
+	void	PutMatch(int length, int distance);
+	void	Deflate(const unsigned char *p, int n);
+	void	PutChunk(const char *type, const unsigned char *pData, int n);
+};
+
+#endif
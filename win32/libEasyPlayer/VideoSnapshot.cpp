@@ -0,0 +1,434 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "VideoSnapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define		VSNAP_JOB_FREE			0x00
+#define		VSNAP_JOB_FILLING		0x01		//a Capture is copying into it
+#define		VSNAP_JOB_QUEUED		0x02
+#define		VSNAP_JOB_BUSY			0x03		//a worker is encoding it
+
+static void __Sleep(int ms)
+{
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+//path of frame index of a burst: "a.jpg" gives "a_3.jpg"
+static void __BurstPath(const char *path, int index, int count, char *out)
+{
+	if (count <= 1)
+	{
+		strcpy(out, path);
+		return;
+	}
+	const char *dot = strrchr(path, '.');
+	const char *slash = strrchr(path, '/');
+	const char *backslash = strrchr(path, '\\');
+	if (NULL == dot || (NULL != slash && slash > dot) || (NULL != backslash && backslash > dot))		dot = path + strlen(path);
+	sprintf(out, "%.*s_%d%s", (int)(dot - path), path, index, dot);
+}
+
+//plane by plane, the decoder's buffer may be strided
+static void __CopyFrame(const VC_FRAME_T *src, VC_FRAME_T *dst)
+{
+	for (int p=0; p<3; p++)
+	{
+		int width	=	p == 0 ? src->width : (src->width + 1) / 2;
+		int height	=	p == 0 ? src->height : (src->height + 1) / 2;
+		for (int y=0; y<height; y++)
+		{
+			memcpy(dst->plane[p] + (size_t)y * dst->stride[p], src->plane[p] + (size_t)y * src->stride[p], width);
+		}
+	}
+}
+
+
+CVideoSnapshot::CVideoSnapshot(void)
+{
+	running		=	0;
+	quality		=	VJ_DEFAULT_QUALITY;
+	requestId	=	0;
+	memset(request, 0x00, sizeof(request));
+	pending		=	0;
+	memset(job, 0x00, sizeof(job));
+	order		=	0;
+	filling		=	0;
+	quit		=	0;
+	workers		=	0;
+	_VS_InitLock(&lock);
+#ifdef _WIN32
+	memset(hThread, 0x00, sizeof(hThread));
+	hJobs		=	NULL;
+#else
+	pthread_cond_init(&jobs, NULL);
+#endif
+}
+
+CVideoSnapshot::~CVideoSnapshot(void)
+{
+	Deinit();
+	for (int i=0; i<VSNAP_MAX_JOBS; i++)
+	{
+		if (NULL != job[i].pYuv)	free(job[i].pYuv);
+	}
+#ifndef _WIN32
+	pthread_cond_destroy(&jobs);
+#endif
+	_VS_DeinitLock(&lock);
+}
+
+int		CVideoSnapshot::Init(int _workers, int _quality)
+{
+	Deinit();
+
+	if (_workers < 1)						_workers = 1;
+	if (_workers > VSNAP_MAX_WORKERS)		_workers = VSNAP_MAX_WORKERS;
+	quality	=	_quality;
+
+	quit = 0;
+#ifdef _WIN32
+	hJobs = CreateSemaphore(NULL, 0, 0x7FFFFFFF, NULL);
+	if (NULL == hJobs)		return -1;
+#endif
+	for (int i=0; i<_workers; i++)
+	{
+#ifdef _WIN32
+		hThread[i] = CreateThread(NULL, 0, WorkerThread, this, 0, NULL);
+		if (NULL == hThread[i])		break;
+		SetThreadPriority(hThread[i], THREAD_PRIORITY_BELOW_NORMAL);
+#else
+		if (0 != pthread_create(&thread[i], NULL, WorkerThread, this))	break;
+#endif
+		workers ++;
+	}
+	if (workers < 1)
+	{
+		Deinit();
+		return -1;
+	}
+
+	_VS_Lock(&lock);
+	running = 1;
+	_VS_Unlock(&lock);
+	return 0;
+}
+
+void	CVideoSnapshot::Deinit()
+{
+	_VS_Lock(&lock);
+	running = 0;
+	quit = 1;
+#ifndef _WIN32
+	pthread_cond_broadcast(&jobs);
+#endif
+	_VS_Unlock(&lock);
+
+#ifdef _WIN32
+	if (workers > 0)
+	{
+		ReleaseSemaphore(hJobs, workers, NULL);
+		WaitForMultipleObjects(workers, hThread, TRUE, INFINITE);
+	}
+	for (int i=0; i<VSNAP_MAX_WORKERS; i++)
+	{
+		if (NULL != hThread[i])		CloseHandle(hThread[i]);
+		hThread[i] = NULL;
+	}
+	if (NULL != hJobs)
+	{
+		CloseHandle(hJobs);
+		hJobs = NULL;
+	}
+#else
+	for (int i=0; i<workers; i++)	pthread_join(thread[i], NULL);
+#endif
+	workers = 0;
+
+	//a decode thread may still be copying into a job it took before running went to 0
+	for (;;)
+	{
+		_VS_Lock(&lock);
+		int busy = filling;
+		_VS_Unlock(&lock);
+		if (busy == 0)	break;
+		__Sleep(1);
+	}
+
+	//frames nobody will encode now, and requests that will get no more
+	for (int i=0; i<VSNAP_MAX_JOBS; i++)
+	{
+		if (job[i].state == VSNAP_JOB_QUEUED && NULL != job[i].callback)
+		{
+			job[i].callback(job[i].channelId, job[i].userPtr, job[i].requestId, job[i].index, VSNAP_STATUS_CANCELLED, NULL, 0, job[i].path);
+		}
+		job[i].state = VSNAP_JOB_FREE;
+	}
+	CancelRequests(-1);
+	order	=	0;
+	quit	=	0;
+}
+
+int		CVideoSnapshot::Request(int slot, int channelId, const char *path, int format, int count, int interval, VSNAP_CALLBACK callback, void *userPtr)
+{
+	if (format != VSNAP_FORMAT_JPEG && format != VSNAP_FORMAT_PNG)		return -1;
+	if (count < 1 || count > VSNAP_MAX_BURST)		return -1;
+	//room for the burst suffix
+	int hasPath = NULL != path && path[0] != '\0';
+	if (hasPath && strlen(path) >= VSNAP_MAX_PATH - 8)		return -1;
+	if (!hasPath && NULL == callback)		return -1;
+
+	_VS_Lock(&lock);
+	VSNAP_REQUEST_T *pRequest = NULL;
+	for (int i=0; i<VSNAP_MAX_REQUESTS && running; i++)
+	{
+		if (request[i].requestId == 0)		{pRequest = &request[i];	break;}
+	}
+	if (NULL == pRequest)
+	{
+		_VS_Unlock(&lock);
+		return -1;
+	}
+	if (++requestId <= 0)	requestId = 1;
+	pRequest->requestId	=	requestId;
+	pRequest->slot		=	slot;
+	pRequest->channelId	=	channelId;
+	if (hasPath)	strcpy(pRequest->path, path);
+	else			pRequest->path[0] = '\0';
+	pRequest->format	=	format;
+	pRequest->count		=	count;
+	pRequest->taken		=	0;
+	pRequest->interval	=	interval > 0 ? interval : 0;
+	pRequest->nextTime	=	0;
+	pRequest->callback	=	callback;
+	pRequest->userPtr	=	userPtr;
+	pending ++;
+	int ret = requestId;
+	_VS_Unlock(&lock);
+
+	return ret;
+}
+
+int		CVideoSnapshot::Capture(int slot, const VC_FRAME_T *frame, VC_RANGE range, unsigned int timeMs)
+{
+	if (NULL == frame || (frame->format != VC_FORMAT_YUV420P && frame->format != VC_FORMAT_YV12))	return 0;
+
+	//every request due on this frame gets its own job, a request finding none waits for the next frame
+	VSNAP_JOB_T *pTaken[VSNAP_MAX_JOBS];
+	int taken = 0;
+	_VS_Lock(&lock);
+	for (int i=0; i<VSNAP_MAX_REQUESTS && pending > 0 && running; i++)
+	{
+		VSNAP_REQUEST_T *r = &request[i];
+		if (r->requestId == 0 || r->slot != slot)		continue;
+		if (r->taken > 0 && (int)(timeMs - r->nextTime) < 0)		continue;
+
+		VSNAP_JOB_T *pJob = NULL;
+		for (int j=0; j<VSNAP_MAX_JOBS && NULL == pJob; j++)
+		{
+			if (job[j].state == VSNAP_JOB_FREE)		pJob = &job[j];
+		}
+		if (NULL == pJob)		break;
+
+		pJob->state		=	VSNAP_JOB_FILLING;
+		pJob->requestId	=	r->requestId;
+		pJob->channelId	=	r->channelId;
+		pJob->index		=	r->taken;
+		pJob->format	=	r->format;
+		pJob->callback	=	r->callback;
+		pJob->userPtr	=	r->userPtr;
+		pJob->range		=	range;
+		if (r->path[0] != '\0')		__BurstPath(r->path, r->taken, r->count, pJob->path);
+		else						pJob->path[0] = '\0';
+		pTaken[taken++] = pJob;
+
+		r->nextTime = timeMs + r->interval;
+		if (++r->taken >= r->count)
+		{
+			r->requestId = 0;
+			pending --;
+		}
+	}
+	filling += taken;
+	_VS_Unlock(&lock);
+	if (taken == 0)		return 0;
+
+	//one copy of the frame per job, the decoder reuses its buffer for the next frame
+	int yuvSize = VC_FrameSize(frame->format, frame->width, frame->height);
+	for (int i=0; i<taken; i++)
+	{
+		VSNAP_JOB_T *pJob = pTaken[i];
+		if (pJob->yuvSize < yuvSize)
+		{
+			if (NULL != pJob->pYuv)		free(pJob->pYuv);
+			pJob->pYuv		=	(unsigned char *)malloc(yuvSize);
+			pJob->yuvSize	=	(NULL != pJob->pYuv) ? yuvSize : 0;
+		}
+		if (NULL == pJob->pYuv)		continue;		//yuvSize 0, the worker reports VSNAP_STATUS_ENCODE
+		VC_FillFrame(&pJob->frame, frame->format, frame->width, frame->height, pJob->pYuv);
+		__CopyFrame(frame, &pJob->frame);
+	}
+
+	//Deinit closes the semaphore only after filling is back to 0, but never queues for a stopped pool
+	_VS_Lock(&lock);
+	filling -= taken;
+	for (int i=0; i<taken; i++)
+	{
+		VSNAP_JOB_T *pJob = pTaken[i];
+		pJob->order	=	++order;
+		pJob->state	=	VSNAP_JOB_QUEUED;
+		if (!running)	continue;		//Deinit cancels it
+#ifdef _WIN32
+		ReleaseSemaphore(hJobs, 1, NULL);
+#else
+		pthread_cond_signal(&jobs);
+#endif
+	}
+	_VS_Unlock(&lock);
+
+	return taken;
+}
+
+void	CVideoSnapshot::Cancel(int slot)
+{
+	if (slot < 0)	return;
+	CancelRequests(slot);
+}
+
+//slot -1: all. Callbacks run outside the lock, they may call Request again
+void	CVideoSnapshot::CancelRequests(int slot)
+{
+	VSNAP_REQUEST_T cancelled[VSNAP_MAX_REQUESTS];
+	int n = 0;
+	_VS_Lock(&lock);
+	for (int i=0; i<VSNAP_MAX_REQUESTS; i++)
+	{
+		if (request[i].requestId == 0 || (slot >= 0 && request[i].slot != slot))	continue;
+		if (NULL != request[i].callback)	cancelled[n++] = request[i];
+		request[i].requestId = 0;
+		pending --;
+	}
+	_VS_Unlock(&lock);
+
+	for (int i=0; i<n; i++)
+	{
+		VSNAP_REQUEST_T *r = &cancelled[i];
+		r->callback(r->channelId, r->userPtr, r->requestId, r->taken, VSNAP_STATUS_CANCELLED, NULL, 0, r->path);
+	}
+}
+
+#ifdef _WIN32
+DWORD WINAPI	CVideoSnapshot::WorkerThread(LPVOID lpParam)
+{
+	((CVideoSnapshot *)lpParam)->Work();
+	return 0;
+}
+#else
+void *	CVideoSnapshot::WorkerThread(void *param)
+{
+	((CVideoSnapshot *)param)->Work();
+	return NULL;
+}
+#endif
+
+void	CVideoSnapshot::Work()
+{
+	CVideoJpeg		jpeg;
+	CVideoPng		png;
+	VC_MATRIX_T		matrix;
+	unsigned char	*pRgb = NULL;
+	int				rgbSize = 0;
+	jpeg.Init(quality);
+
+	_VS_Lock(&lock);
+	for (;;)
+	{
+		//a semaphore count may find its job already taken by another worker
+		VSNAP_JOB_T *pJob = NULL;
+#ifdef _WIN32
+		_VS_Unlock(&lock);
+		WaitForSingleObject(hJobs, INFINITE);
+		_VS_Lock(&lock);
+		if (!quit)	pJob = NextJob();
+#else
+		while (!quit && NULL == (pJob = NextJob()))		pthread_cond_wait(&jobs, &lock);
+#endif
+		if (quit)				break;
+		if (NULL == pJob)		continue;
+
+		pJob->state = VSNAP_JOB_BUSY;
+		_VS_Unlock(&lock);
+
+		const unsigned char *pData = NULL;
+		int size = -1;
+		if (pJob->yuvSize > 0 && pJob->format == VSNAP_FORMAT_JPEG)
+		{
+			size = jpeg.Encode(&pJob->frame, pJob->range);
+			pData = jpeg.GetData();
+		}
+		else if (pJob->yuvSize > 0)
+		{
+			int needed = VC_FrameSize(VC_FORMAT_BGR24, pJob->frame.width, pJob->frame.height);
+			if (rgbSize < needed)
+			{
+				if (NULL != pRgb)	free(pRgb);
+				pRgb	=	(unsigned char *)malloc(needed);
+				rgbSize	=	(NULL != pRgb) ? needed : 0;
+			}
+			VC_FRAME_T rgb;
+			VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, pJob->range);
+			if (NULL != pRgb && VC_FillFrame(&rgb, VC_FORMAT_BGR24, pJob->frame.width, pJob->frame.height, pRgb) > 0 &&
+				0 == VC_ConvertRows(&pJob->frame, &rgb, &matrix, 0, rgb.height))
+			{
+				size = png.Encode(&rgb);
+				pData = png.GetData();
+			}
+		}
+
+		int status = size > 0 ? VSNAP_STATUS_OK : VSNAP_STATUS_ENCODE;
+		if (status == VSNAP_STATUS_OK && pJob->path[0] != '\0')
+		{
+			FILE *f = fopen(pJob->path, "wb");
+			int ok = NULL != f && (int)fwrite(pData, 1, size, f) == size;
+			if (NULL != f && 0 != fclose(f))	ok = 0;
+			if (!ok)	status = VSNAP_STATUS_FILE;
+		}
+		if (NULL != pJob->callback)
+		{
+			pJob->callback(pJob->channelId, pJob->userPtr, pJob->requestId, pJob->index, status,
+							status == VSNAP_STATUS_ENCODE ? NULL : pData, status == VSNAP_STATUS_ENCODE ? 0 : size, pJob->path);
+		}
+
+		_VS_Lock(&lock);
+		pJob->state = VSNAP_JOB_FREE;
+	}
+	_VS_Unlock(&lock);
+
+	if (NULL != pRgb)	free(pRgb);
+}
+
+//lock held: the oldest queued job
+VSNAP_JOB_T	*CVideoSnapshot::NextJob()
+{
+	VSNAP_JOB_T *pJob = NULL;
+	for (int i=0; i<VSNAP_MAX_JOBS; i++)
+	{
+		if (job[i].state == VSNAP_JOB_QUEUED && (NULL == pJob || (int)(job[i].order - pJob->order) < 0))	pJob = &job[i];
+	}
+	return pJob;
+}
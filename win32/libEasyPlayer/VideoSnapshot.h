@@ -0,0 +1,125 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VIDEO_SNAPSHOT_H__
+#define __VIDEO_SNAPSHOT_H__
+
+#include "VideoConverter.h"
+#include "VideoJpeg.h"
+#include "VideoPng.h"
+#include "vslock.h"
+
+#define		VSNAP_MAX_PATH			260
+#define		VSNAP_MAX_REQUESTS		32				//requests not yet fully captured, all channels
+#define		VSNAP_MAX_WORKERS		4
+#define		VSNAP_MAX_JOBS			6				//frames waiting for a worker, a due frame finding none is skipped
+#define		VSNAP_MAX_BURST			1000
+
+#define		VSNAP_FORMAT_JPEG		0x00
+#define		VSNAP_FORMAT_PNG		0x01
+
+#define		VSNAP_STATUS_OK			0
+#define		VSNAP_STATUS_ENCODE		-1
+#define		VSNAP_STATUS_FILE		-2				//encoded, pData is valid, but path could not be written
+#define		VSNAP_STATUS_CANCELLED	-3				//channel closed or pool stopped, index is the first frame not taken
+
+#ifdef _WIN32
+#define		VSNAP_CALLTYPE			CALLBACK
+#else
+#define		VSNAP_CALLTYPE
+#endif
+
+//called on a worker thread for every frame of a request; pData lives until the callback returns
+typedef int (VSNAP_CALLTYPE *VSNAP_CALLBACK)(int channelId, void *userPtr, int requestId, int index, int status, const unsigned char *pData, int size, const char *path);
+
+typedef struct __VSNAP_REQUEST_T
+{
+	int				requestId;		//0: free
+	int				slot;
+	int				channelId;
+	char			path[VSNAP_MAX_PATH];
+	int				format;
+	int				count;
+	int				taken;
+	int				interval;
+	unsigned int	nextTime;
+	VSNAP_CALLBACK	callback;
+	void			*userPtr;
+}VSNAP_REQUEST_T;
+
+typedef struct __VSNAP_JOB_T
+{
+	int				state;			//VSNAP_JOB_xxx, see VideoSnapshot.cpp
+	unsigned int	order;			//FIFO among the queued
+	int				requestId;
+	int				channelId;
+	int				index;
+	int				format;
+	char			path[VSNAP_MAX_PATH];	//the file of this frame, empty for memory only
+	VSNAP_CALLBACK	callback;
+	void			*userPtr;
+	VC_FRAME_T		frame;			//the decoded picture, in pYuv
+	VC_RANGE		range;
+	unsigned char	*pYuv;
+	int				yuvSize;
+}VSNAP_JOB_T;
+
+//Stills of live channels: Request only records what is wanted and returns, the decode thread
+//copies its next decoded frame of a channel with a pending request into a pooled job, and JPEG
+//or PNG encoding, file writing and the callback happen on a small worker pool
+class CVideoSnapshot
+{
+public:
+	CVideoSnapshot(void);
+	~CVideoSnapshot(void);
+
+	int		Init(int workers=1, int quality=VJ_DEFAULT_QUALITY);
+	//cancels what is pending, waits for the workers and for any Capture still copying
+	void	Deinit();
+
+	int		IsRunning()		{return running;}
+
+	//count frames of slot, interval ms apart; path may be NULL when callback is given, a burst
+	//inserts _index before the extension. Returns the request id (>0), -1 if full or not running
+	int		Request(int slot, int channelId, const char *path, int format, int count, int interval, VSNAP_CALLBACK callback, void *userPtr);
+	//the decode thread: a decoded YUV420P or YV12 frame of slot, returns the number of requests it served
+	int		Capture(int slot, const VC_FRAME_T *frame, VC_RANGE range, unsigned int timeMs);
+	//the channel of slot closed, its requests get VSNAP_STATUS_CANCELLED
+	void	Cancel(int slot);
+
+protected:
+	int				running;
+	int				quality;
+	int				requestId;
+	VSNAP_REQUEST_T	request[VSNAP_MAX_REQUESTS];
+	int				pending;		//requests in use, 0 lets Capture return at once
+
+	VSNAP_JOB_T		job[VSNAP_MAX_JOBS];
+	unsigned int	order;
+	int				filling;		//Captures copying outside the lock
+	int				quit;
+	int				workers;
+	VS_LOCK_T		lock;			//requests and job states
+#ifdef _WIN32
+	HANDLE			hThread[VSNAP_MAX_WORKERS];
+	HANDLE			hJobs;			//semaphore, one count per queued job
+#else
+	pthread_t		thread[VSNAP_MAX_WORKERS];
+	pthread_cond_t	jobs;
+#endif
+
+#ifdef _WIN32
+	static DWORD WINAPI	WorkerThread(LPVOID lpParam);
+#else
+	static void *		WorkerThread(void *param);
+#endif
+	void	Work();
+	VSNAP_JOB_T	*NextJob();
+	void	CancelRequests(int slot);
+};
+
+#endif
@@ -0,0 +1,468 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "VideoThumbnail.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define		VTHUMB_JOB_FREE			0x00
+#define		VTHUMB_JOB_FILLING		0x01		//a Submit is scaling into it
+#define		VTHUMB_JOB_QUEUED		0x02
+#define		VTHUMB_JOB_BUSY			0x03		//a worker is encoding it
+#define		VTHUMB_MAX_FILE			(4*1024*1024)
+
+//FNV-1a, names the cache file and speeds up lookups
+static unsigned long long __Hash(const char *key)
+{
+	unsigned long long h = 14695981039346656037ULL;
+	for (; *key; key++)
+	{
+		h ^= (unsigned char)*key;
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+static void __Sleep(int ms)
+{
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+//fits width x height in maxWidth x maxHeight keeping the aspect, never larger than it was, even sizes
+static void __FitSize(int width, int height, int maxWidth, int maxHeight, int *outWidth, int *outHeight)
+{
+	int w = width, h = height;
+	if (w > maxWidth)
+	{
+		h = (int)((long long)h * maxWidth / w);
+		w = maxWidth;
+	}
+	if (h > maxHeight)
+	{
+		w = (int)((long long)width * maxHeight / height);
+		h = maxHeight;
+	}
+	w &= ~1;
+	h &= ~1;
+	*outWidth	=	w < 2 ? 2 : w;
+	*outHeight	=	h < 2 ? 2 : h;
+}
+
+
+CVideoThumbnail::CVideoThumbnail(void)
+{
+	running		=	0;
+	maxWidth	=	VTHUMB_DEFAULT_WIDTH;
+	maxHeight	=	VTHUMB_DEFAULT_HEIGHT;
+	interval	=	VTHUMB_DEFAULT_INTERVAL;
+	quality		=	VJ_DEFAULT_QUALITY;
+	memset(cacheDir, 0x00, sizeof(cacheDir));
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	pEntry		=	NULL;
+	entries		=	0;
+	lruClock	=	0;
+	sequence	=	0;
+	memset(job, 0x00, sizeof(job));
+	order		=	0;
+	filling		=	0;
+	quit		=	0;
+	workers		=	0;
+	_VS_InitLock(&lock);
+#ifdef _WIN32
+	memset(hThread, 0x00, sizeof(hThread));
+	hJobs		=	NULL;
+#else
+	pthread_cond_init(&jobs, NULL);
+#endif
+}
+
+CVideoThumbnail::~CVideoThumbnail(void)
+{
+	Deinit();
+#ifndef _WIN32
+	pthread_cond_destroy(&jobs);
+#endif
+	_VS_DeinitLock(&lock);
+}
+
+int		CVideoThumbnail::Init(int _maxWidth, int _maxHeight, int _interval, int _entries, const char *_cacheDir, int _workers, int _quality)
+{
+	Deinit();
+
+	if (_maxWidth < 2 || _maxHeight < 2 || _maxWidth > VJ_MAX_SIZE || _maxHeight > VJ_MAX_SIZE)	return -1;
+	if (_entries < 1 || _entries > VTHUMB_MAX_ENTRIES)		return -1;
+	if (_workers < 1)						_workers = 1;
+	if (_workers > VTHUMB_MAX_WORKERS)		_workers = VTHUMB_MAX_WORKERS;
+
+	maxWidth	=	_maxWidth & ~1;
+	maxHeight	=	_maxHeight & ~1;
+	interval	=	_interval > 0 ? _interval : 0;
+	quality		=	_quality;
+	memset(cacheDir, 0x00, sizeof(cacheDir));
+	if (NULL != _cacheDir && _cacheDir[0] != '\0')
+	{
+		strncpy(cacheDir, _cacheDir, sizeof(cacheDir) - 1);
+#ifdef _WIN32
+		CreateDirectoryA(cacheDir, NULL);
+#else
+		mkdir(cacheDir, 0755);
+#endif
+	}
+
+	pEntry = (VTHUMB_ENTRY_T *)calloc(_entries, sizeof(VTHUMB_ENTRY_T));
+	if (NULL == pEntry)		return -1;
+	entries = _entries;
+
+	int yuvSize = VC_FrameSize(VC_FORMAT_YUV420P, maxWidth, maxHeight);
+	for (int i=0; i<VTHUMB_MAX_JOBS; i++)
+	{
+		job[i].pYuv = (unsigned char *)malloc(yuvSize);
+		if (NULL == job[i].pYuv)
+		{
+			Deinit();
+			return -1;
+		}
+	}
+
+	quit = 0;
+#ifdef _WIN32
+	hJobs = CreateSemaphore(NULL, 0, 0x7FFFFFFF, NULL);
+	if (NULL == hJobs)
+	{
+		Deinit();
+		return -1;
+	}
+#endif
+	for (int i=0; i<_workers; i++)
+	{
+#ifdef _WIN32
+		hThread[i] = CreateThread(NULL, 0, WorkerThread, this, 0, NULL);
+		if (NULL == hThread[i])		break;
+		SetThreadPriority(hThread[i], THREAD_PRIORITY_BELOW_NORMAL);
+#else
+		if (0 != pthread_create(&thread[i], NULL, WorkerThread, this))	break;
+#endif
+		workers ++;
+	}
+	if (workers < 1)
+	{
+		Deinit();
+		return -1;
+	}
+
+	_VS_Lock(&lock);
+	running = 1;
+	_VS_Unlock(&lock);
+	return 0;
+}
+
+void	CVideoThumbnail::Deinit()
+{
+	_VS_Lock(&lock);
+	running = 0;
+	quit = 1;
+#ifndef _WIN32
+	pthread_cond_broadcast(&jobs);
+#endif
+	_VS_Unlock(&lock);
+
+#ifdef _WIN32
+	if (workers > 0)
+	{
+		ReleaseSemaphore(hJobs, workers, NULL);
+		WaitForMultipleObjects(workers, hThread, TRUE, INFINITE);
+	}
+	for (int i=0; i<VTHUMB_MAX_WORKERS; i++)
+	{
+		if (NULL != hThread[i])		CloseHandle(hThread[i]);
+		hThread[i] = NULL;
+	}
+	if (NULL != hJobs)
+	{
+		CloseHandle(hJobs);
+		hJobs = NULL;
+	}
+#else
+	for (int i=0; i<workers; i++)	pthread_join(thread[i], NULL);
+#endif
+	workers = 0;
+
+	//a decode thread may still be scaling into a job it took before running went to 0
+	for (;;)
+	{
+		_VS_Lock(&lock);
+		int busy = filling;
+		_VS_Unlock(&lock);
+		if (busy == 0)	break;
+		__Sleep(1);
+	}
+
+	for (int i=0; i<VTHUMB_MAX_JOBS; i++)
+	{
+		if (NULL != job[i].pYuv)	free(job[i].pYuv);
+		memset(&job[i], 0x00, sizeof(VTHUMB_JOB_T));
+	}
+	if (NULL != pEntry)
+	{
+		for (int i=0; i<entries; i++)
+		{
+			if (NULL != pEntry[i].pJpeg)	free(pEntry[i].pJpeg);
+		}
+		free(pEntry);
+		pEntry = NULL;
+	}
+	entries		=	0;
+	lruClock	=	0;
+	order		=	0;
+	quit		=	0;
+}
+
+int		CVideoThumbnail::Submit(const char *key, const VC_FRAME_T *frame, VC_RANGE range)
+{
+	if (NULL == key || key[0] == '\0' || NULL == frame)		return -1;
+	if (frame->format != VC_FORMAT_YUV420P && frame->format != VC_FORMAT_YV12)		return -1;
+	if (frame->width < 2 || frame->height < 2)				return -1;
+
+	//a picture of the same stream still waiting is replaced rather than queued twice
+	_VS_Lock(&lock);
+	if (!running)
+	{
+		_VS_Unlock(&lock);
+		return -1;
+	}
+	VTHUMB_JOB_T *pJob = NULL;
+	for (int i=0; i<VTHUMB_MAX_JOBS && NULL == pJob; i++)
+	{
+		if (job[i].state == VTHUMB_JOB_QUEUED && 0 == strncmp(job[i].key, key, VTHUMB_MAX_KEY-1))	pJob = &job[i];
+	}
+	for (int i=0; i<VTHUMB_MAX_JOBS && NULL == pJob; i++)
+	{
+		if (job[i].state == VTHUMB_JOB_FREE)	pJob = &job[i];
+	}
+	if (NULL == pJob)
+	{
+		_VS_Unlock(&lock);
+		return 0;
+	}
+	pJob->state = VTHUMB_JOB_FILLING;
+	filling ++;
+	_VS_Unlock(&lock);
+
+	int width = 0, height = 0;
+	__FitSize(frame->width, frame->height, maxWidth, maxHeight, &width, &height);
+	VC_FillFrame(&pJob->frame, VC_FORMAT_YUV420P, width, height, pJob->pYuv);
+	int ret = VC_ScaleRows(frame, &pJob->frame, &matrix, VC_FILTER_AREA, 0, height);
+
+	//Deinit closes the semaphore only after filling is back to 0, but never queues for a stopped pool
+	_VS_Lock(&lock);
+	filling --;
+	if (ret == 0 && running)
+	{
+		strncpy(pJob->key, key, VTHUMB_MAX_KEY-1);
+		pJob->key[VTHUMB_MAX_KEY-1] = '\0';
+		pJob->range	=	range;
+		pJob->order	=	++order;
+		pJob->state	=	VTHUMB_JOB_QUEUED;
+#ifdef _WIN32
+		ReleaseSemaphore(hJobs, 1, NULL);
+#else
+		pthread_cond_signal(&jobs);
+#endif
+	}
+	else
+	{
+		pJob->state = VTHUMB_JOB_FREE;
+	}
+	_VS_Unlock(&lock);
+
+	return ret == 0 ? 1 : -1;
+}
+
+#ifdef _WIN32
+DWORD WINAPI	CVideoThumbnail::WorkerThread(LPVOID lpParam)
+{
+	((CVideoThumbnail *)lpParam)->Work();
+	return 0;
+}
+#else
+void *	CVideoThumbnail::WorkerThread(void *param)
+{
+	((CVideoThumbnail *)param)->Work();
+	return NULL;
+}
+#endif
+
+void	CVideoThumbnail::Work()
+{
+	CVideoJpeg	jpeg;
+	jpeg.Init(quality);
+
+	_VS_Lock(&lock);
+	for (;;)
+	{
+		//a semaphore count may find its job already taken by another worker
+		VTHUMB_JOB_T *pJob = NULL;
+#ifdef _WIN32
+		_VS_Unlock(&lock);
+		WaitForSingleObject(hJobs, INFINITE);
+		_VS_Lock(&lock);
+		if (!quit)	pJob = NextJob();
+#else
+		while (!quit && NULL == (pJob = NextJob()))		pthread_cond_wait(&jobs, &lock);
+#endif
+		if (quit)				break;
+		if (NULL == pJob)		continue;
+
+		pJob->state = VTHUMB_JOB_BUSY;
+		_VS_Unlock(&lock);
+
+		int size = jpeg.Encode(&pJob->frame, pJob->range);
+		unsigned long long hash = __Hash(pJob->key);
+		if (size > 0 && cacheDir[0] != '\0')
+		{
+			//written aside and renamed, a reader never sees half a file
+			char path[VTHUMB_MAX_KEY+32], temp[VTHUMB_MAX_KEY+40];
+			CachePath(hash, path);
+			sprintf(temp, "%s.tmp", path);
+			FILE *f = fopen(temp, "wb");
+			if (NULL != f)
+			{
+				int ok = (int)fwrite(jpeg.GetData(), 1, size, f) == size;
+				fclose(f);
+#ifdef _WIN32
+				if (!ok || !MoveFileExA(temp, path, MOVEFILE_REPLACE_EXISTING))		DeleteFileA(temp);
+#else
+				if (!ok || 0 != rename(temp, path))		remove(temp);
+#endif
+			}
+		}
+
+		_VS_Lock(&lock);
+		if (size > 0)	Put(pJob->key, hash, jpeg.GetData(), size);
+		pJob->state = VTHUMB_JOB_FREE;
+	}
+	_VS_Unlock(&lock);
+}
+
+//lock held: the oldest queued job
+VTHUMB_JOB_T	*CVideoThumbnail::NextJob()
+{
+	VTHUMB_JOB_T *pJob = NULL;
+	for (int i=0; i<VTHUMB_MAX_JOBS; i++)
+	{
+		if (job[i].state == VTHUMB_JOB_QUEUED && (NULL == pJob || (int)(job[i].order - pJob->order) < 0))	pJob = &job[i];
+	}
+	return pJob;
+}
+
+void	CVideoThumbnail::CachePath(unsigned long long hash, char *path)
+{
+	sprintf(path, "%s/%08x%08x.jpg", cacheDir, (unsigned int)(hash >> 32), (unsigned int)hash);
+}
+
+//lock held
+VTHUMB_ENTRY_T	*CVideoThumbnail::Find(const char *key, unsigned long long hash)
+{
+	for (int i=0; i<entries; i++)
+	{
+		if (pEntry[i].hash == hash && pEntry[i].size > 0 && 0 == strncmp(pEntry[i].key, key, VTHUMB_MAX_KEY-1))	return &pEntry[i];
+	}
+	return NULL;
+}
+
+//lock held: the entry of key, else an empty one, else the least recently used
+int		CVideoThumbnail::Put(const char *key, unsigned long long hash, const unsigned char *pJpeg, int size)
+{
+	if (NULL == pEntry)		return -1;
+
+	VTHUMB_ENTRY_T *e = Find(key, hash);
+	if (NULL == e)
+	{
+		for (int i=0; i<entries; i++)
+		{
+			if (pEntry[i].size == 0)	{e = &pEntry[i];	break;}
+			if (NULL == e || (int)(pEntry[i].lastUsed - e->lastUsed) < 0)	e = &pEntry[i];
+		}
+		strncpy(e->key, key, VTHUMB_MAX_KEY-1);
+		e->key[VTHUMB_MAX_KEY-1] = '\0';
+		e->hash = hash;
+		e->size = 0;
+	}
+	if (e->capacity < size)
+	{
+		unsigned char *p = (unsigned char *)realloc(e->pJpeg, size);
+		if (NULL == p)		return -1;
+		e->pJpeg	=	p;
+		e->capacity	=	size;
+	}
+	memcpy(e->pJpeg, pJpeg, size);
+	e->size		=	size;
+	e->sequence	=	++sequence;
+	e->lastUsed	=	++lruClock;
+	return 0;
+}
+
+int		CVideoThumbnail::Get(const char *key, unsigned char *pBuf, int bufSize, unsigned int *pSequence)
+{
+	if (NULL == key || key[0] == '\0')		return -1;
+
+	unsigned long long hash = __Hash(key);
+	for (int pass=0; pass<2; pass++)
+	{
+		_VS_Lock(&lock);
+		if (!running)
+		{
+			_VS_Unlock(&lock);
+			return -1;
+		}
+		VTHUMB_ENTRY_T *e = Find(key, hash);
+		if (NULL != e)
+		{
+			int size = e->size;
+			e->lastUsed = ++lruClock;
+			if (NULL != pBuf && bufSize >= size)	memcpy(pBuf, e->pJpeg, size);
+			if (NULL != pSequence)					*pSequence = e->sequence;
+			_VS_Unlock(&lock);
+			return size;
+		}
+		_VS_Unlock(&lock);
+
+		//not in memory: the one a previous run left on disk, read once into the cache
+		if (pass > 0 || cacheDir[0] == '\0')	break;
+
+		char path[VTHUMB_MAX_KEY+32];
+		CachePath(hash, path);
+		FILE *f = fopen(path, "rb");
+		if (NULL == f)		break;
+		fseek(f, 0, SEEK_END);
+		long size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		unsigned char *pFile = (size > 0 && size <= VTHUMB_MAX_FILE) ? (unsigned char *)malloc(size) : NULL;
+		int ok = NULL != pFile && (long)fread(pFile, 1, size, f) == size;
+		fclose(f);
+		if (ok)
+		{
+			_VS_Lock(&lock);
+			if (running && NULL == Find(key, hash))		Put(key, hash, pFile, (int)size);
+			_VS_Unlock(&lock);
+		}
+		if (NULL != pFile)	free(pFile);
+		if (!ok)	break;
+	}
+	return -1;
+}
@@ -0,0 +1,109 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VIDEO_THUMBNAIL_H__
+#define __VIDEO_THUMBNAIL_H__
+
+#include "VideoConverter.h"
+#include "VideoJpeg.h"
+#include "vslock.h"
+
+#define		VTHUMB_MAX_KEY			260
+#define		VTHUMB_MAX_ENTRIES		1024
+#define		VTHUMB_MAX_WORKERS		4
+#define		VTHUMB_MAX_JOBS			8				//frames waiting for a worker, more are dropped
+#define		VTHUMB_DEFAULT_WIDTH	176
+#define		VTHUMB_DEFAULT_HEIGHT	144
+#define		VTHUMB_DEFAULT_INTERVAL	5000			//ms between thumbnails of a stream
+
+typedef struct __VTHUMB_ENTRY_T
+{
+	char				key[VTHUMB_MAX_KEY];
+	unsigned long long	hash;
+	unsigned char		*pJpeg;
+	int					size;
+	int					capacity;
+	unsigned int		sequence;		//bumped on every new picture
+	unsigned int		lastUsed;		//LRU clock
+}VTHUMB_ENTRY_T;
+
+typedef struct __VTHUMB_JOB_T
+{
+	int					state;			//VTHUMB_JOB_xxx, see VideoThumbnail.cpp
+	unsigned int		order;			//FIFO among the queued
+	char				key[VTHUMB_MAX_KEY];
+	VC_FRAME_T			frame;			//the scaled picture, in pYuv
+	VC_RANGE			range;
+	unsigned char		*pYuv;
+}VTHUMB_JOB_T;
+
+//Thumbnails of live streams: a decode thread hands over a key frame, it is scaled down right
+//away with the SIMD scaler and JPEG encoded on a small worker pool. The newest JPEG of each
+//key is kept in an LRU memory cache, and written to cacheDir if one is given so previews
+//survive a restart
+class CVideoThumbnail
+{
+public:
+	CVideoThumbnail(void);
+	~CVideoThumbnail(void);
+
+	//pictures fit in maxWidth x maxHeight keeping their aspect; cacheDir may be NULL
+	int		Init(int maxWidth, int maxHeight, int interval, int entries, const char *cacheDir, int workers=1, int quality=VJ_DEFAULT_QUALITY);
+	//waits for the workers and for any Submit still scaling, then frees everything
+	void	Deinit();
+
+	int		IsRunning()		{return running;}
+	int		GetInterval()	{return interval;}
+
+	//a decoded YUV420P or YV12 key frame of the given range. Returns 1 if queued, 0 if every
+	//job slot is busy (try again with the next key frame), -1 if not running or bad arguments
+	int		Submit(const char *key, const VC_FRAME_T *frame, VC_RANGE range);
+	//copies the newest JPEG of key into pBuf and returns its size; if bufSize is too small
+	//only the size is returned. -1 if there is none, in memory or on disk
+	int		Get(const char *key, unsigned char *pBuf, int bufSize, unsigned int *pSequence);
+
+protected:
+	int				running;
+	int				maxWidth;
+	int				maxHeight;
+	int				interval;
+	int				quality;
+	char			cacheDir[VTHUMB_MAX_KEY];
+	VC_MATRIX_T		matrix;
+
+	VTHUMB_ENTRY_T	*pEntry;
+	int				entries;
+	unsigned int	lruClock;
+	unsigned int	sequence;
+
+	VTHUMB_JOB_T	job[VTHUMB_MAX_JOBS];
+	unsigned int	order;
+	int				filling;		//Submits scaling outside the lock
+	int				quit;
+	int				workers;
+	VS_LOCK_T		lock;			//entries and job states
+#ifdef _WIN32
+	HANDLE			hThread[VTHUMB_MAX_WORKERS];
+	HANDLE			hJobs;			//semaphore, one count per queued job
+#else
+	pthread_t		thread[VTHUMB_MAX_WORKERS];
+	pthread_cond_t	jobs;
+#endif
+
+#ifdef _WIN32
+	static DWORD WINAPI	WorkerThread(LPVOID lpParam);
+#else
+	static void *		WorkerThread(void *param);
+#endif
+	void	Work();
+	VTHUMB_JOB_T	*NextJob();
+	int		Put(const char *key, unsigned long long hash, const unsigned char *pJpeg, int size);
+	VTHUMB_ENTRY_T	*Find(const char *key, unsigned long long hash);
+	void	CachePath(unsigned long long hash, char *path);
+};
+
+#endif
@@ -7,6 +7,7 @@
 */
 #include "libEasyPlayerAPI.h"
 #include "ChannelManager.h"
+#include "vstrace.h"
 
 CChannelManager	*g_pChannelManager = NULL;
 
@@ -56,6 +57,7 @@ LIB_EASYPLAYER_API int EasyPlayer_Init()
 // Release
 LIB_EASYPLAYER_API void EasyPlayer_Release()
 {
+	_VS_TraceStop();
 	if (NULL != g_pChannelManager)
 	{
 		delete g_pChannelManager;
@@ -143,6 +145,63 @@ LIB_EASYPLAYER_API int EasyPlayer_StopSound()
 
 	return g_pChannelManager->StopSound();
 }
+LIB_EASYPLAYER_API int EasyPlayer_StopChannelSound(int channelId)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->StopSound(channelId);
+}
+LIB_EASYPLAYER_API int EasyPlayer_SetSoundVolume(int channelId, float volume)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->SetSoundVolume(channelId, volume);
+}
+LIB_EASYPLAYER_API int EasyPlayer_SetSoundMute(int channelId, int mute)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->SetSoundMute(channelId, mute);
+}
+
+LIB_EASYPLAYER_API int EasyPlayer_SetCompositor(HWND hWnd, int tiles)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->SetCompositor(hWnd, tiles);
+}
+LIB_EASYPLAYER_API int EasyPlayer_SetChannelTile(int channelId, int tile)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->SetChannelTile(channelId, tile);
+}
+
+LIB_EASYPLAYER_API int EasyPlayer_StartThumbnail(int width, int height, int interval, int entries, const char *cacheDir)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->StartThumbnail(width, height, interval, entries, cacheDir);
+}
+LIB_EASYPLAYER_API int EasyPlayer_StopThumbnail()
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->StopThumbnail();
+}
+LIB_EASYPLAYER_API int EasyPlayer_GetThumbnail(const char *url, unsigned char *buf, int bufSize, unsigned int *sequence)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->GetThumbnail(url, buf, bufSize, sequence);
+}
+
+LIB_EASYPLAYER_API int EasyPlayer_Snapshot(int channelId, const char *path, SNAPSHOT_FORMAT format, int count, int interval, SnapshotCallBack callback, void *userPtr)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->Snapshot(channelId, path, format, count, interval, callback, userPtr);
+}
 
 LIB_EASYPLAYER_API int EasyPlayer_StartManuRecording(int channelId)
 {
@@ -158,3 +217,41 @@ LIB_EASYPLAYER_API int EasyPlayer_StopManuRecording(int channelId)
 	return g_pChannelManager->StopManuRecording(channelId);
 }
 
+LIB_EASYPLAYER_API int EasyPlayer_StartStreamRecording(int channelId, const char *path)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->StartStreamRecording(channelId, path);
+}
+
+LIB_EASYPLAYER_API int EasyPlayer_StopStreamRecording(int channelId)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->StopStreamRecording(channelId);
+}
+
+LIB_EASYPLAYER_API int EasyPlayer_OpenReplay(const char *path, HWND hWnd, RENDER_FORMAT renderFormat, int speed, int loop, MediaSourceCallBack callback, void *userPtr)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->OpenReplay(path, hWnd, renderFormat, speed, loop, callback, userPtr);
+}
+
+LIB_EASYPLAYER_API int EasyPlayer_GetReplayState(int channelId, unsigned int *records, unsigned int *loops)
+{
+	if (NULL == g_pChannelManager)		return -1;
+
+	return g_pChannelManager->GetReplayState(channelId, records, loops);
+}
+
+LIB_EASYPLAYER_API int EasyPlayer_StartTrace(const char *path)
+{
+	return _VS_TraceStart(path);
+}
+
+LIB_EASYPLAYER_API int EasyPlayer_StopTrace()
+{
+	_VS_TraceStop();
+	return 0;
+}
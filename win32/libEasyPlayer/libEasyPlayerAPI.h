@@ -34,7 +34,17 @@ typedef enum __RENDER_FORMAT
 
 
 
+typedef enum __SNAPSHOT_FORMAT
+{
+	SNAPSHOT_FORMAT_JPEG	=		0x00,
+	SNAPSHOT_FORMAT_PNG		=		0x01
+}SNAPSHOT_FORMAT;
+
+
+
 typedef int (CALLBACK *MediaSourceCallBack)( int _channelId, int *_channelPtr, int _frameType, char *pBuf, RTSP_FRAME_INFO* _frameInfo);
+//status: 0ɹ, -1ʧ, -2дļʧ(pBufЧ), -3ͨرջֹͣ, indexΪδȡĵһ֡; pBufֻڻصЧ
+typedef int (CALLBACK *SnapshotCallBack)( int _channelId, void *userPtr, int requestId, int index, int status, const unsigned char *pBuf, int size, const char *path);
 
 
 LIB_EASYPLAYER_API int EasyPlayer_Init();
@@ -45,6 +55,7 @@ LIB_EASYPLAYER_API void EasyPlayer_CloseStream(int channelId);
 LIB_EASYPLAYER_API int EasyPlayer_SetFrameCache(int channelId, int cache);
 LIB_EASYPLAYER_API int EasyPlayer_SetShownToScale(int channelId, int shownToScale);
 LIB_EASYPLAYER_API int EasyPlayer_SetDecodeType(int channelId, int decodeKeyframeOnly);
+//ַŴ: lpSrcRectΪе, ֻתŵڴС; NULLʱָ
 LIB_EASYPLAYER_API int EasyPlayer_SetRenderRect(int channelId, LPRECT lpSrcRect);
 LIB_EASYPLAYER_API int EasyPlayer_ShowStatisticalInfo(int channelId, int show);
 
@@ -55,8 +66,46 @@ LIB_EASYPLAYER_API int EasyPlayer_ResetDragPoint(int channelId);
 LIB_EASYPLAYER_API int EasyPlayer_StartManuRecording(int channelId);
 LIB_EASYPLAYER_API int EasyPlayer_StopManuRecording(int channelId);
 
+//·: PlaySoundֻͨ(ԭһ), Ѽͨ;
+//ͨSetSoundMute(channelId, 0)ͬʱŶͨ
 LIB_EASYPLAYER_API int EasyPlayer_PlaySound(int channelId);
 LIB_EASYPLAYER_API int EasyPlayer_StopSound();
+LIB_EASYPLAYER_API int EasyPlayer_StopChannelSound(int channelId);
+LIB_EASYPLAYER_API int EasyPlayer_SetSoundVolume(int channelId, float volume);		//0.0 - 4.0, 1.0Ϊԭʼ
+LIB_EASYPLAYER_API int EasyPlayer_SetSoundMute(int channelId, int mute);
+
+//·Ƶϳɵһ: 水tiles(4, 9, 16, 36, 64...)ֿ, ÿˢֻػ֡ķֿ
+//SetChannelTileͨʹOpenStreamhWnd, tileΪ-1ʱָ; hWndΪNULLʱرպϳ
+LIB_EASYPLAYER_API int EasyPlayer_SetCompositor(HWND hWnd, int tiles);
+LIB_EASYPLAYER_API int EasyPlayer_SetChannelTile(int channelId, int tile);
+
+//ؼ֡ͼ: ÿͨÿintervalȡһؼ֡, Сwidth x height, ں̨ΪJPEG,
+//OpenStreamurlentries, cacheDirΪNULLʱͬʱдĿ¼, ´Կȡ.
+//SetDecodeType(channelId, 2)ֻͨΪͼؼ֡, ʾ
+LIB_EASYPLAYER_API int EasyPlayer_StartThumbnail(int width, int height, int interval, int entries, const char *cacheDir);
+LIB_EASYPLAYER_API int EasyPlayer_StopThumbnail();
+//JPEGС, bufSizeʱֻشС; ûͼʱ-1. sequenceÿθ¶仯, δ仯ʱˢ
+LIB_EASYPLAYER_API int EasyPlayer_GetThumbnail(const char *url, unsigned char *buf, int bufSize, unsigned int *sequence);
+
+//ץͼ: ID(>0), ʧܷ-1. ߳ȡ֮ͨcount֡, ÿ֡interval,
+//ں̨ΪJPEGPNG, pathΪNULLʱдļ(count>1ʱΪname_0.jpg, name_1.jpg...), ÿ֡ɺcallback.
+//pathcallbackٸһ
+LIB_EASYPLAYER_API int EasyPlayer_Snapshot(int channelId, const char *path, SNAPSHOT_FORMAT format, int count=1, int interval=0, SnapshotCallBack callback=NULL, void *userPtr=NULL);
+
+//¼: , ʾ, ֡, дpath, ÿ¼ʮ, Ӱ첥ʱ.
+//tools/vstracedumpתΪıChrome trace JSON. ڸʱStartTrace-1
+LIB_EASYPLAYER_API int EasyPlayer_StartTrace(const char *path);
+LIB_EASYPLAYER_API int EasyPlayer_StopTrace();
+
+//¼: RTSPͨյÿһ֡(֡Ϣ͵ʱ)ԭдpath, CloseStreamʱԶֹͣ
+LIB_EASYPLAYER_API int EasyPlayer_StartStreamRecording(int channelId, const char *path);
+LIB_EASYPLAYER_API int EasyPlayer_StopStreamRecording(int channelId);
+//ط¼Ƶļ, ΪһͨchannelId, CloseStreamر. Ҫɸͬ.
+//speed: 100¼ʱʱ, 200..., 0ȴ; 100ʱϻûطŵȴ֡.
+//speedΪ0SetFrameCache(channelId, 0)ʱʾ̲, ܲ. loop: ѭ, ʱ
+LIB_EASYPLAYER_API int EasyPlayer_OpenReplay(const char *path, HWND hWnd, RENDER_FORMAT renderFormat, int speed=100, int loop=0, MediaSourceCallBack callback=NULL, void *userPtr=NULL);
+//0: δʼ, 1: ط, 2: ѽ; ǻطͨ-1
+LIB_EASYPLAYER_API int EasyPlayer_GetReplayState(int channelId, unsigned int *records, unsigned int *loops);
 
 
 
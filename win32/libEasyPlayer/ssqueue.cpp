@@ -9,6 +9,7 @@
 #include <time.h>
 #include <stdarg.h>
 #include "trace.h"
+#include "vstrace.h"
 
 int		SSQ_Init(SS_QUEUE_OBJ_T *pObj, unsigned int sharememory, unsigned int channelid, wchar_t *sharename, unsigned int bufsize, unsigned int prerecordsecs, unsigned int createsharememory)
 {
@@ -335,8 +336,8 @@ int		SSQ_AddData(SS_QUEUE_OBJ_T *pObj, unsigned int channelid, unsigned int medi
 
 	if (pObj->pQueHeader->clear_flag == 0x01)
 	{
-		//SSQ_TRACE("Received clear signal... Clear Buffer..\n");
-		SSQ_TRACE("յź.  ջ..  WritePos: %d\n", pObj->pQueHeader->writepos);
+		//յź
+		_VS_TRACE(VSTRACE_EV_SSQ_CLEAR, pObj->channelid, pObj->pQueHeader->writepos, pObj->pQueHeader->videoframes);
 		SSQ_Clear(pObj);
 		pObj->pQueHeader->clear_flag = 0x00;
 	}
@@ -352,7 +353,8 @@ int		SSQ_AddData(SS_QUEUE_OBJ_T *pObj, unsigned int channelid, unsigned int medi
 
 	if (sizeof(SS_BUF_T) + frameinfo->length + pObj->pQueHeader->totalsize > pObj->pQueHeader->bufsize)
 	{
-		SSQ_TRACE("С.. ֡:%d\ttotalsize:%d\tbufsize:%d  ֡:%d\n", frameinfo->length, pObj->pQueHeader->totalsize, pObj->pQueHeader->bufsize, pObj->pQueHeader->videoframes);
+		//С, ʱÿ֡ᵽ
+		_VS_TRACE(VSTRACE_EV_SSQ_FULL, pObj->channelid, frameinfo->length, pObj->pQueHeader->totalsize, pObj->pQueHeader->bufsize, pObj->pQueHeader->videoframes);
 		ReleaseMutex(pObj->hMutex);
 		pObj->pQueHeader->isfull = 0x01;
 		return -1;
@@ -0,0 +1,165 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//CAudioMixer: kernels against the scalar formulas, input handling, and the cost of one 20ms
+//output period for 1-64 inputs
+#include "PlayerTest.h"
+#include "AudioMixer.h"
+#include <math.h>
+
+#define	MIXTEST_RATE		48000
+#define	MIXTEST_PERIOD		960				//20ms at 48kHz
+
+static void TestKernels()
+{
+	int before = gTestFailures;
+	unsigned int seed = 1;
+	static const int gains[] = {0, 1, 2048, MIXER_GAIN_UNITY, 3 * MIXER_GAIN_UNITY, (int)(MIXER_MAX_VOLUME * MIXER_GAIN_UNITY), 32767};
+
+	short	src[203], dst[203];
+	int		acc[203], ref[203];
+	for (int g=0; g<(int)(sizeof(gains)/sizeof(gains[0])); g++)
+	{
+		//odd count, the SIMD part and the scalar tail both run
+		for (int count=1; count<=203; count+=101)
+		{
+			for (int i=0; i<count; i++)
+			{
+				src[i] = (short)__TestRand(&seed);
+				acc[i] = ref[i] = (int)(__TestRand(&seed) % 200001) - 100000;
+			}
+			MIX_Accumulate(acc, src, count, gains[g]);
+			for (int i=0; i<count; i++)		ref[i] += (src[i] * gains[g]) >> MIXER_GAIN_SHIFT;
+			TEST_CHECK(0 == memcmp(acc, ref, count * sizeof(int)));
+
+			MIX_Saturate(dst, acc, count);
+			int same = 1;
+			for (int i=0; i<count; i++)
+			{
+				int v = ref[i] > 32767 ? 32767 : (ref[i] < -32768 ? -32768 : ref[i]);
+				if (dst[i] != v)		same = 0;
+			}
+			TEST_CHECK(same);
+		}
+	}
+	__TestResult("TestKernels", before);
+}
+
+static void TestMix()
+{
+	int before = gTestFailures;
+
+	CAudioMixer mixer;
+	TEST_CHECK(0 == mixer.Open(MIXTEST_RATE, 2));
+	TEST_CHECK(0 == mixer.AddInput(1));
+	TEST_CHECK(0 == mixer.AddInput(2));
+	TEST_CHECK(-1 == mixer.AddInput(MAX_MIXER_INPUT_NUM + 1));
+	TEST_CHECK(2 == mixer.GetInputNum());
+
+	short out[MIXTEST_PERIOD * 2];
+	TEST_CHECK(0 == mixer.Mix(out, MIXTEST_PERIOD));		//nothing buffered
+	TEST_CHECK(out[0] == 0 && out[MIXTEST_PERIOD * 2 - 1] == 0);
+
+	//input 1: 48kHz stereo constant, input 2: 8kHz mono constant, both past the prebuffer
+	short a[MIXTEST_RATE / 10 * 2], b[800];
+	for (int i=0; i<MIXTEST_RATE / 10 * 2; i++)		a[i] = 1000;
+	for (int i=0; i<800; i++)							b[i] = 2000;
+	TEST_CHECK(0 == mixer.Write(1, a, MIXTEST_RATE / 10, MIXTEST_RATE, 2));
+	TEST_CHECK(0 == mixer.Write(2, b, 800, 8000, 1));
+	TEST_CHECK(-1 == mixer.Write(3, b, 800, 8000, 1));		//not added
+
+	mixer.SetVolume(1, 2.0f);
+	TEST_CHECK(2 == mixer.Mix(out, MIXTEST_PERIOD));
+	//past the resampler's start, 2000 + 2 * 1000 on both sides within the filter ripple
+	TEST_CHECK(abs(out[MIXTEST_PERIOD] - 4000) < 40 && abs(out[MIXTEST_PERIOD + 1] - 4000) < 40);
+
+	mixer.SetMute(2, 1);
+	TEST_CHECK(1 == mixer.Mix(out, MIXTEST_PERIOD));
+	TEST_CHECK(out[0] == 2000 && out[1] == 2000);
+
+	//saturates instead of wrapping
+	mixer.SetVolume(1, MIXER_MAX_VOLUME);
+	for (int i=0; i<MIXTEST_RATE / 10 * 2; i++)		a[i] = 30000;
+	mixer.ClearInput(1);
+	mixer.Write(1, a, MIXTEST_RATE / 10, MIXTEST_RATE, 2);
+	TEST_CHECK(1 == mixer.Mix(out, MIXTEST_PERIOD));
+	TEST_CHECK(out[0] == 32767);
+
+	TEST_CHECK(0 == mixer.RemoveInput(2));
+	TEST_CHECK(1 == mixer.GetInputNum());
+	__TestResult("TestMix", before);
+}
+
+//us per 20ms output period: mixing alone with inputs already at 48kHz stereo, then with
+//8kHz mono inputs (G.711 cameras) where every Write goes through the resampler
+static void BenchMix(double seconds)
+{
+	printf("%-8s %14s %10s %18s %10s\n", "inputs", "mix us/20ms", "% of 20ms", "8k+mix us/20ms", "% of 20ms");
+
+	static short	a[MIXTEST_PERIOD * 2], b[160];
+	short			out[MIXTEST_PERIOD * 2];
+	for (int i=0; i<MIXTEST_PERIOD * 2; i++)		a[i] = (short)(8000 * sin(i * 0.01));
+	for (int i=0; i<160; i++)						b[i] = (short)(8000 * sin(i * 0.3));
+
+	for (int inputs=1; inputs<=MAX_MIXER_INPUT_NUM; inputs*=2)
+	{
+		double cost[2];
+		for (int pass=0; pass<2; pass++)
+		{
+			CAudioMixer mixer;
+			mixer.Open(MIXTEST_RATE, 2);
+			for (int i=1; i<=inputs; i++)		mixer.AddInput(i);
+
+			//warm up past the prebuffer, every input audible
+			for (int p=0; p<10; p++)
+			{
+				for (int i=1; i<=inputs; i++)
+				{
+					if (pass == 0)		mixer.Write(i, a, MIXTEST_PERIOD, MIXTEST_RATE, 2);
+					else				mixer.Write(i, b, 160, 8000, 1);
+				}
+				mixer.Mix(out, MIXTEST_PERIOD);
+			}
+
+			unsigned long long	busyNs = 0;
+			int					periods = 0;
+			unsigned long long	start = _VS_GetNs();
+			while (__TestSeconds(start) < seconds)
+			{
+				unsigned long long t0 = _VS_GetNs();
+				if (pass == 1)
+				{
+					for (int i=1; i<=inputs; i++)		mixer.Write(i, b, 160, 8000, 1);
+				}
+				if (inputs != mixer.Mix(out, MIXTEST_PERIOD))		printf("  not every input mixed\n");
+				busyNs += _VS_GetNs() - t0;
+				periods ++;
+
+				//pass 0 refills outside the timed part, it is only a copy into the fifo
+				if (pass == 0)
+				{
+					for (int i=1; i<=inputs; i++)		mixer.Write(i, a, MIXTEST_PERIOD, MIXTEST_RATE, 2);
+				}
+			}
+			cost[pass] = (double)busyNs / 1000.0 / periods;
+		}
+		printf("%-8d %14.2f %9.3f%% %18.2f %9.3f%%\n", inputs, cost[0], cost[0] / 200.0, cost[1], cost[1] / 200.0);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (__TestIsBench(argc, argv))
+	{
+		BenchMix(argc > 2 ? atof(argv[2]) : 0.5);
+		return 0;
+	}
+
+	TestKernels();
+	TestMix();
+	return gTestFailures;
+}
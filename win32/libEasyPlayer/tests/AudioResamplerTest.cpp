@@ -0,0 +1,286 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//CAudioResampler: dot product kernels (AVX2 against SSE2/NEON against scalar), SNR of a tone
+//at every camera rate pair, packet independence and drift; throughput per kernel
+#include "PlayerTest.h"
+#include "AudioResampler.h"
+#include "vssimd.h"
+#include <math.h>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI	3.14159265358979323846
+#endif
+
+#define	RSTEST_TONE			1000.0
+#define	RSTEST_AMPLITUDE	16000.0
+#define	RSTEST_PACKET		441			//frames per Process, not a multiple of anything
+#define	RSTEST_MIN_SNR		60.0		//dB, the filter's stopband is ~70dB
+
+static const unsigned int	gRates[] = {8000, 16000, 44100, 48000};
+#define	RSTEST_RATES		(int)(sizeof(gRates)/sizeof(gRates[0]))
+
+static void TestKernels()
+{
+	int before = gTestFailures;
+	unsigned int seed = 7;
+	short	xs[RESAMPLER_MAX_TAPS], cs[RESAMPLER_MAX_TAPS];
+	float	xf[RESAMPLER_MAX_TAPS], cf[RESAMPLER_MAX_TAPS];
+
+	for (int n=16; n<=RESAMPLER_MAX_TAPS; n+=16)
+	{
+		int		refS16 = 0;
+		double	refF32 = 0.0, mag = 0.0;
+		for (int i=0; i<n; i++)
+		{
+			xs[i] = (short)__TestRand(&seed);
+			cs[i] = (short)(__TestRand(&seed) % 32768) - 16384;		//Q14 coefficients
+			xf[i] = (float)xs[i] / 32768.0f;
+			cf[i] = (float)cs[i] / 16384.0f;
+			refS16 += xs[i] * cs[i];
+			refF32 += (double)xf[i] * cf[i];
+			mag += fabs((double)xf[i] * cf[i]);
+		}
+
+		//every kernel this machine has: the detected one, then the baseline
+		for (int avx2=1; avx2>=0; avx2--)
+		{
+			_VS_SetAvx2(avx2);
+			TEST_CHECK(RS_DotS16(xs, cs, n) == refS16);
+			TEST_CHECK(fabs(RS_DotF32(xf, cf, n) - refF32) <= mag * 1e-6);
+		}
+	}
+	_VS_SetAvx2(1);
+	__TestResult("TestKernels", before);
+}
+
+//SNR in dB of a resampled tone, the filter's start and end are skipped
+template <class T>
+static double __ToneSnr(unsigned int inRate, unsigned int outRate, unsigned int channels, RESAMPLE_FORMAT format, double scale, int *outFrames)
+{
+	CAudioResampler resampler;
+	if (0 != resampler.Init(inRate, outRate, channels, format))		return 0.0;
+
+	int inFrames = inRate;		//1s
+	std::vector<T> in(inFrames * channels);
+	for (int i=0; i<inFrames; i++)
+	{
+		for (unsigned int c=0; c<channels; c++)		in[i*channels+c] = (T)(scale * sin(2 * M_PI * RSTEST_TONE * i / inRate));
+	}
+	std::vector<T> out((resampler.GetMaxOutFrames(inFrames) + RSTEST_PACKET * 8) * channels);
+
+	int total = 0;
+	for (int off=0; off<inFrames; off+=RSTEST_PACKET)
+	{
+		int n = inFrames - off < RSTEST_PACKET ? inFrames - off : RSTEST_PACKET;
+		int got = resampler.Process(&in[off*channels], n, &out[total*channels], (int)out.size() / channels - total);
+		if (got < 0)		return 0.0;
+		total += got;
+	}
+	*outFrames = total;
+
+	//least squares fit of a tone at any phase, the filter's delay is not a whole frame; what the
+	//fit leaves is noise and aliasing
+	int		first = resampler.GetTaps() * 4, last = total - resampler.GetTaps() * 4;
+	double	w = 2 * M_PI * RSTEST_TONE / outRate;
+	double	snr = 200.0;
+	for (unsigned int c=0; c<channels; c++)
+	{
+		double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+		for (int i=first; i<last; i++)
+		{
+			double s = sin(w * i), k = cos(w * i), y = (double)out[i*channels+c];
+			ss += s * s;	sc += s * k;	cc += k * k;
+			ys += y * s;	yc += y * k;
+		}
+		double det = ss * cc - sc * sc;
+		double a = (ys * cc - yc * sc) / det, b = (yc * ss - ys * sc) / det;
+
+		double se = 0.0, sp = 0.0;
+		for (int i=first; i<last; i++)
+		{
+			double ref = a * sin(w * i) + b * cos(w * i);
+			double e = (double)out[i*channels+c] - ref;
+			se += e * e;
+			sp += ref * ref;
+		}
+		double channelSnr = se > 0.0 ? 10.0 * log10(sp / se) : 200.0;
+		if (channelSnr < snr)		snr = channelSnr;
+	}
+	return snr;
+}
+
+static void TestQuality(int verbose)
+{
+	int before = gTestFailures;
+	if (verbose)		printf("%-14s %6s %12s %12s %12s\n", "rate", "taps", "S16 stereo", "S16 mono", "float");
+	for (int a=0; a<RSTEST_RATES; a++)
+	{
+		for (int b=0; b<RSTEST_RATES; b++)
+		{
+			if (a == b)		continue;
+
+			int frames[3] = {0,};
+			double snr[3];
+			snr[0] = __ToneSnr<short>(gRates[a], gRates[b], 2, RESAMPLE_FORMAT_S16, RSTEST_AMPLITUDE, &frames[0]);
+			snr[1] = __ToneSnr<short>(gRates[a], gRates[b], 1, RESAMPLE_FORMAT_S16, RSTEST_AMPLITUDE, &frames[1]);
+			snr[2] = __ToneSnr<float>(gRates[a], gRates[b], 1, RESAMPLE_FORMAT_FLT, RSTEST_AMPLITUDE / 32768.0, &frames[2]);
+
+			for (int i=0; i<3; i++)
+			{
+				TEST_CHECK(snr[i] >= RSTEST_MIN_SNR);
+				//1s in, 1s out but for the half filter still in the history
+				TEST_CHECK(frames[i] <= (int)gRates[b] && frames[i] >= (int)gRates[b] - RESAMPLER_MAX_TAPS * 6);
+			}
+			if (verbose)
+			{
+				CAudioResampler r;
+				r.Init(gRates[a], gRates[b], 1);
+				char szRate[32];
+				sprintf(szRate, "%u->%u", gRates[a], gRates[b]);
+				printf("%-14s %6d %9.1f dB %9.1f dB %9.1f dB\n", szRate, r.GetTaps(), snr[0], snr[1], snr[2]);
+			}
+		}
+	}
+	__TestResult("TestQuality", before);
+}
+
+//the output does not depend on how the input is cut into packets
+static void TestPackets()
+{
+	int before = gTestFailures;
+	unsigned int seed = 3;
+	std::vector<short> in(8000 * 2), outWhole(60000 * 2), outCut(60000 * 2);
+	for (size_t i=0; i<in.size(); i++)		in[i] = (short)(__TestRand(&seed) % 20000) - 10000;
+
+	CAudioResampler whole, cut;
+	whole.Init(8000, 48000, 2);
+	cut.Init(8000, 48000, 2);
+	int n1 = whole.Process(&in[0], 8000, &outWhole[0], 60000);
+
+	int n2 = 0;
+	for (int off=0, size=1; off<8000; off+=size, size=size*3%1277+1)
+	{
+		int n = 8000 - off < size ? 8000 - off : size;
+		n2 += cut.Process(&in[off*2], n, &outCut[n2*2], 60000 - n2);
+	}
+	TEST_CHECK(n1 > 0 && n1 == n2);
+	TEST_CHECK(n1 > 0 && 0 == memcmp(&outWhole[0], &outCut[0], n1 * 2 * sizeof(short)));
+
+	//Reset starts over
+	whole.Reset();
+	int n3 = whole.Process(&in[0], 8000, &outCut[0], 60000);
+	TEST_CHECK(n3 == n1 && 0 == memcmp(&outWhole[0], &outCut[0], n1 * 2 * sizeof(short)));
+	__TestResult("TestPackets", before);
+}
+
+static void TestDrift()
+{
+	int before = gTestFailures;
+	std::vector<short> in(48000), out(60000);
+	for (int i=0; i<48000; i++)		in[i] = (short)(8000 * sin(i * 0.05));
+
+	static const double ratios[] = {1.0, 1.02, 0.97, RESAMPLER_MAX_DRIFT + 1.0};
+	for (int r=0; r<4; r++)
+	{
+		CAudioResampler resampler;
+		resampler.Init(48000, 48000, 1);
+		TEST_CHECK(0 == resampler.SetDrift(ratios[r]));
+		int total = 0;
+		for (int off=0; off<48000; off+=960)		total += resampler.Process(&in[off], 960, &out[total], 60000 - total);
+		double expect = 48000.0 / ratios[r];
+		TEST_CHECK(fabs(total - expect) < RESAMPLER_MAX_TAPS);
+	}
+	CAudioResampler resampler;
+	TEST_CHECK(0 != resampler.SetDrift(1.01));		//not initialized
+	resampler.Init(48000, 48000, 1);
+	TEST_CHECK(0 == resampler.SetDrift(1.5) && resampler.GetDrift() == 1.0 + RESAMPLER_MAX_DRIFT);		//clamped
+	__TestResult("TestDrift", before);
+}
+
+//times real time for one stream, stereo S16 and mono float, with each kernel this machine has
+static void BenchThroughput(double seconds)
+{
+	int avx2 = _VS_UseAvx2();
+	printf("%-14s %6s %14s %14s %14s %14s\n", "rate", "taps", "S16x2 AVX2", "S16x2 base", "flt AVX2", "flt base");
+
+	std::vector<short> inS16(48000 * 2);
+	std::vector<float> inF32(48000);
+	std::vector<short> outS16(60000 * 2 * 6);
+	std::vector<float> outF32(60000 * 6);
+	for (int i=0; i<48000; i++)
+	{
+		inS16[i*2] = inS16[i*2+1] = (short)(RSTEST_AMPLITUDE * sin(i * 0.13));
+		inF32[i] = (float)sin(i * 0.13);
+	}
+
+	for (int a=0; a<RSTEST_RATES; a++)
+	{
+		for (int b=0; b<RSTEST_RATES; b++)
+		{
+			if (a == b)		continue;
+			double speed[4] = {0,};
+			int taps = 0;
+			for (int k=0; k<4; k++)
+			{
+				int useAvx2 = (k % 2 == 0);
+				if (useAvx2 && !avx2)		continue;
+				_VS_SetAvx2(useAvx2);
+
+				RESAMPLE_FORMAT format = k < 2 ? RESAMPLE_FORMAT_S16 : RESAMPLE_FORMAT_FLT;
+				CAudioResampler resampler;
+				resampler.Init(gRates[a], gRates[b], format == RESAMPLE_FORMAT_S16 ? 2 : 1, format);
+				taps = resampler.GetTaps();
+
+				int inFrames = gRates[a] / 50;		//20ms packets
+				unsigned long long busy = 0, start = _VS_GetNs();
+				double audio = 0.0;
+				while (__TestSeconds(start) < seconds)
+				{
+					for (int off=0; off+inFrames<=48000; off+=inFrames)
+					{
+						unsigned long long t0 = _VS_GetNs();
+						if (format == RESAMPLE_FORMAT_S16)	resampler.Process(&inS16[off*2], inFrames, &outS16[0], (int)outS16.size() / 2);
+						else								resampler.Process(&inF32[off], inFrames, &outF32[0], (int)outF32.size());
+						busy += _VS_GetNs() - t0;
+						audio += (double)inFrames / gRates[a];
+					}
+				}
+				speed[k] = audio / ((double)busy / 1000000000.0);
+			}
+			_VS_SetAvx2(1);
+
+			char szRate[32];
+			sprintf(szRate, "%u->%u", gRates[a], gRates[b]);
+			printf("%-14s %6d", szRate, taps);
+			for (int k=0; k<4; k++)
+			{
+				if (speed[k] > 0.0)		printf(" %13.0fx", speed[k]);
+				else					printf(" %14s", "-");
+			}
+			printf("\n");
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (__TestIsBench(argc, argv))
+	{
+		printf("AVX2 kernels: %s\n", _VS_UseAvx2() ? "yes" : "not on this CPU");
+		TestQuality(1);
+		BenchThroughput(argc > 2 ? atof(argv[2]) : 0.2);
+		return gTestFailures;
+	}
+
+	TestKernels();
+	TestQuality(0);
+	TestPackets();
+	TestDrift();
+	return gTestFailures;
+}
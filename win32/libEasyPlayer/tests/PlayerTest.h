@@ -0,0 +1,47 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __PLAYER_TEST_H__
+#define __PLAYER_TEST_H__
+
+//Shared by the programs of tests/: each one runs its checks without arguments and exits with
+//the number of failures, "bench" runs its benchmarks instead
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vstime.h"
+
+static int	gTestFailures = 0;
+
+#define	TEST_CHECK(x)		do { if (!(x)) { printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #x); gTestFailures ++; } } while (0)
+
+//prints the result line of a check group, returns its failures
+static inline int __TestResult(const char *name, int failuresBefore)
+{
+	int failures = gTestFailures - failuresBefore;
+	printf("%s: %s\n", name, failures == 0 ? "PASS" : "FAIL");
+	return failures;
+}
+
+static inline int __TestIsBench(int argc, char *argv[])
+{
+	return argc > 1 && 0 == strcmp(argv[1], "bench");
+}
+
+//deterministic, so a failure reproduces
+static inline unsigned int __TestRand(unsigned int *seed)
+{
+	*seed = *seed * 1103515245u + 12345u;
+	return *seed >> 8;
+}
+
+static inline double __TestSeconds(unsigned long long startNs)
+{
+	return (double)(_VS_GetNs() - startNs) / 1000000000.0;
+}
+
+#endif
@@ -0,0 +1,495 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//CStreamRecorder and CStreamReplayer: a recorded stream comes back record for record, on time at
+//paced speeds, with PTS going on across loops and under backpressure; a failed write leaves a
+//file that ends at a complete record. "soak N [seconds] [speed] [file...]" loops N sources
+//through the replayer for the CI soak harness, over the given recordings or a synthetic one
+#include "PlayerTest.h"
+#include "StreamReplayer.h"
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
+
+typedef struct __REPLAY_RECORD_T
+{
+	int					frameType;
+	int					hasInfo;
+	int					hasBuffer;
+	RTSP_FRAME_INFO		frameInfo;
+	std::vector<char>	payload;
+	unsigned long long	ns;				//since the first record
+}REPLAY_RECORD_T;
+
+//what a source's callback got
+typedef struct __REPLAY_SINK_T
+{
+	std::vector<REPLAY_RECORD_T>	records;
+	int					keep;			//records kept, counted beyond
+	int					busyEvery;		//answers STREAM_FEED_BUSY to every busyEvery-th call
+	unsigned int		calls;
+	unsigned int		fed;
+	unsigned long long	bytes;
+	unsigned long long	firstNs;
+	long long			lastVideoPts;
+	unsigned int		ptsBack;		//video PTS not increasing
+}REPLAY_SINK_T;
+
+static REPLAY_SINK_T	gSink[STREAM_MAX_SOURCES];
+
+static void __ResetSinks(int keep, int busyEvery)
+{
+	for (int i=0; i<STREAM_MAX_SOURCES; i++)
+	{
+		gSink[i].records.clear();
+		gSink[i].keep			=	keep;
+		gSink[i].busyEvery		=	busyEvery;
+		gSink[i].calls			=	0;
+		gSink[i].fed			=	0;
+		gSink[i].bytes			=	0;
+		gSink[i].firstNs		=	0;
+		gSink[i].lastVideoPts	=	-1;
+		gSink[i].ptsBack		=	0;
+	}
+}
+
+static void __FillRecord(REPLAY_RECORD_T *record, int frameType, const char *pBuf, const RTSP_FRAME_INFO *frameInfo)
+{
+	record->frameType	=	frameType;
+	record->hasInfo		=	NULL != frameInfo;
+	record->hasBuffer	=	NULL != pBuf;
+	if (NULL != frameInfo)		record->frameInfo = *frameInfo;
+	else						memset(&record->frameInfo, 0x00, sizeof(RTSP_FRAME_INFO));
+	unsigned int length = (EASY_SDK_MEDIA_INFO_FLAG == frameType) ? sizeof(EASY_MEDIA_INFO_T) : (NULL != frameInfo && NULL != pBuf ? frameInfo->length : 0);
+	if (NULL != pBuf)		record->payload.assign(pBuf, pBuf + length);
+	else					record->payload.clear();
+}
+
+static int __SameRecord(const REPLAY_RECORD_T *a, const REPLAY_RECORD_T *b)
+{
+	return a->frameType == b->frameType && a->hasInfo == b->hasInfo && a->hasBuffer == b->hasBuffer &&
+		   0 == memcmp(&a->frameInfo, &b->frameInfo, sizeof(RTSP_FRAME_INFO)) && a->payload == b->payload;
+}
+
+static int STREAM_CALLTYPE __Feed(int source, void * /*userPtr*/, int frameType, char *pBuf, RTSP_FRAME_INFO *frameInfo)
+{
+	REPLAY_SINK_T *sink = &gSink[source];
+	sink->calls ++;
+	if (sink->busyEvery > 0 && 0 == sink->calls % sink->busyEvery)		return STREAM_FEED_BUSY;
+
+	unsigned long long now = _VS_GetNs();
+	if (0 == sink->fed)		sink->firstNs = now;
+	sink->fed ++;
+	if (EASY_SDK_VIDEO_FRAME_FLAG == frameType && NULL != frameInfo)
+	{
+		long long pts = (long long)frameInfo->timestamp_sec * 1000000 + frameInfo->timestamp_usec;
+		if (pts <= sink->lastVideoPts)		sink->ptsBack ++;
+		sink->lastVideoPts = pts;
+		sink->bytes += frameInfo->length;
+	}
+	if ((int)sink->records.size() < sink->keep)
+	{
+		sink->records.push_back(REPLAY_RECORD_T());
+		__FillRecord(&sink->records.back(), frameType, pBuf, frameInfo);
+		sink->records.back().ns = now - sink->firstNs;
+	}
+	return STREAM_FEED_OK;
+}
+
+//writes a record and keeps what went in
+static void __Put(CStreamRecorder *recorder, int source, int frameType, const char *pBuf, const RTSP_FRAME_INFO *frameInfo, unsigned long long startNs, std::vector<REPLAY_RECORD_T> *records)
+{
+	recorder->Write(source, frameType, pBuf, frameInfo);
+	if (NULL == records)		return;
+	records->push_back(REPLAY_RECORD_T());
+	__FillRecord(&records->back(), frameType, pBuf, frameInfo);
+	records->back().ns = _VS_GetNs() - startNs;
+}
+
+//what an RTSP channel delivers: the connecting event, media info, 50 fps G.711 and 25 fps H.264
+//with an I frame every second, a packet loss event halfway; arrival with up to 3 ms of jitter
+static int __Record(CStreamRecorder *recorder, int source, const char *path, int ms, unsigned int *seed, std::vector<REPLAY_RECORD_T> *records)
+{
+	if (0 != recorder->Start(source, path))		return -1;
+	unsigned long long startNs = _VS_GetNs();
+	std::vector<char> buf(160000);
+
+	EASY_MEDIA_INFO_T	mediaInfo;
+	memset(&mediaInfo, 0x00, sizeof(EASY_MEDIA_INFO_T));
+	mediaInfo.u32VideoCodec		=	EASY_SDK_VIDEO_CODEC_H264;
+	mediaInfo.u32VideoFps		=	25;
+	mediaInfo.u32AudioCodec		=	EASY_SDK_AUDIO_CODEC_G711A;
+	mediaInfo.u32AudioSamplerate=	8000;
+	mediaInfo.u32AudioChannel	=	1;
+	__Put(recorder, source, EASY_SDK_EVENT_FRAME_FLAG, NULL, NULL, startNs, records);
+	__Put(recorder, source, EASY_SDK_MEDIA_INFO_FLAG, (const char *)&mediaInfo, NULL, startNs, records);
+
+	for (int t=0; t<ms; t+=20)
+	{
+		_VS_SleepUntilNs(startNs + (unsigned long long)t * 1000000ULL + (__TestRand(seed) % 3000) * 1000ULL);
+
+		RTSP_FRAME_INFO	frameInfo;
+		memset(&frameInfo, 0x00, sizeof(RTSP_FRAME_INFO));
+		frameInfo.codec				=	EASY_SDK_AUDIO_CODEC_G711A;
+		frameInfo.length			=	320;
+		frameInfo.timestamp_sec		=	1000 + t / 1000;
+		frameInfo.timestamp_usec	=	(t % 1000) * 1000;
+		frameInfo.sample_rate		=	8000;
+		frameInfo.channels			=	1;
+		for (unsigned int i=0; i<frameInfo.length; i++)		buf[i] = (char)__TestRand(seed);
+		__Put(recorder, source, EASY_SDK_AUDIO_FRAME_FLAG, &buf[0], &frameInfo, startNs, records);
+		if (0 != t % 40)		continue;
+
+		memset(&frameInfo, 0x00, sizeof(RTSP_FRAME_INFO));
+		frameInfo.codec				=	EASY_SDK_VIDEO_CODEC_H264;
+		frameInfo.type				=	(0 == t % 1000) ? EASY_SDK_VIDEO_FRAME_I : EASY_SDK_VIDEO_FRAME_P;
+		frameInfo.width				=	1920;
+		frameInfo.height			=	1080;
+		frameInfo.fps				=	25;
+		frameInfo.length			=	EASY_SDK_VIDEO_FRAME_I == frameInfo.type ? 150000 : 5000 + __TestRand(seed) % 20000;
+		frameInfo.timestamp_sec		=	1000 + t / 1000;
+		frameInfo.timestamp_usec	=	(t % 1000) * 1000;
+		for (unsigned int i=0; i<frameInfo.length; i++)		buf[i] = (char)__TestRand(seed);
+		__Put(recorder, source, EASY_SDK_VIDEO_FRAME_FLAG, &buf[0], &frameInfo, startNs, records);
+
+		if (ms / 2 / 40 * 40 == t)
+		{
+			memset(&frameInfo, 0x00, sizeof(RTSP_FRAME_INFO));
+			frameInfo.type			=	0xF1;
+			frameInfo.losspacket	=	2.5f;
+			__Put(recorder, source, EASY_SDK_EVENT_FRAME_FLAG, NULL, &frameInfo, startNs, records);
+		}
+	}
+	recorder->Stop(source);
+	return 0;
+}
+
+//waits for the sources to finish, or to have looped loops times; -1 after timeoutMs
+static int __WaitSources(CStreamReplayer *replayer, int sources, unsigned int loops, int timeoutMs)
+{
+	unsigned long long endNs = _VS_GetNs() + (unsigned long long)timeoutMs * 1000000ULL;
+	while (_VS_GetNs() < endNs)
+	{
+		int done = 1;
+		for (int i=0; i<sources; i++)
+		{
+			STREAM_REPLAY_STATS_T stats;
+			if (STREAM_STATE_RUNNING == replayer->GetStats(i, &stats) && (0 == loops || stats.loops < loops))		done = 0;
+		}
+		if (done)		return 0;
+		__VS_Delay(5);
+	}
+	return -1;
+}
+
+static char	gDir[] = "/tmp/streamtestXXXXXX";
+
+static void TestRoundTrip()
+{
+	int before = gTestFailures;
+	unsigned int seed = 11;
+	char path[128];
+	sprintf(path, "%s/a.strm", gDir);
+
+	CStreamRecorder recorder;
+	std::vector<REPLAY_RECORD_T> recorded;
+	TEST_CHECK(0 == __Record(&recorder, 3, path, 1000, &seed, &recorded));
+	TEST_CHECK(-1 == recorder.Start(STREAM_MAX_SOURCES, path));
+	TEST_CHECK(0 == recorder.IsRecording(3));
+
+	//as fast as it goes, then paced at the recorded timing and four times faster
+	static const int speeds[] = {STREAM_SPEED_FAST, STREAM_SPEED_REALTIME, 400};
+	for (int s=0; s<(int)(sizeof(speeds)/sizeof(speeds[0])); s++)
+	{
+		__ResetSinks((int)recorded.size(), 0);
+		CStreamReplayer replayer;
+		TEST_CHECK(0 == replayer.Start(0, path, speeds[s], 0, __Feed, NULL));
+		TEST_CHECK(0 == __WaitSources(&replayer, 1, 0, 10000));
+		STREAM_REPLAY_STATS_T stats;
+		TEST_CHECK(STREAM_STATE_FINISHED == replayer.GetStats(0, &stats));
+		TEST_CHECK(-1 == replayer.Start(0, path, speeds[s], 0, __Feed, NULL));		//finished, but not stopped
+		replayer.Stop(0);
+		TEST_CHECK(STREAM_STATE_IDLE == replayer.GetStats(0, &stats));
+
+		int same = (gSink[0].records.size() == recorded.size() && stats.records == recorded.size());
+		std::vector<double> error;
+		for (size_t i=0; same && i<recorded.size(); i++)
+		{
+			same = __SameRecord(&recorded[i], &gSink[0].records[i]);
+			if (speeds[s] > 0)
+			{
+				double want = (double)(recorded[i].ns - recorded[0].ns) * STREAM_SPEED_REALTIME / speeds[s];
+				error.push_back(fabs((double)gSink[0].records[i].ns - want) / 1000.0);
+			}
+		}
+		TEST_CHECK(same);
+		TEST_CHECK(0 == gSink[0].ptsBack);
+		if (!error.empty())
+		{
+			std::sort(error.begin(), error.end());
+			printf("  speed %3d: %u records, timing error us p50 %.0f p99 %.0f max %.0f, latest wakeup %lld us\n",
+				   speeds[s], stats.records, error[error.size() / 2], error[error.size() * 99 / 100], error.back(), stats.maxLateUs);
+			TEST_CHECK(error[error.size() / 2] < 1000.0);
+		}
+	}
+	unlink(path);
+	__TestResult("TestRoundTrip", before);
+}
+
+//many sources looping under backpressure: first pass as recorded, PTS going on every pass;
+//Stop returns at once from a long wait
+static void TestLoop()
+{
+	int before = gTestFailures;
+	unsigned int seed = 13;
+	char path[128], bad[128];
+	sprintf(path, "%s/b.strm", gDir);
+	sprintf(bad, "%s/bad.strm", gDir);
+
+	CStreamRecorder recorder;
+	std::vector<REPLAY_RECORD_T> recorded;
+	TEST_CHECK(0 == __Record(&recorder, 0, path, 400, &seed, &recorded));
+	FILE *f = fopen(bad, "wb");
+	if (NULL != f)
+	{
+		fwrite(path, 1, sizeof(path), f);
+		fclose(f);
+	}
+
+	const int sources = 16;
+	__ResetSinks((int)recorded.size(), 7);
+	CStreamReplayer replayer;
+	for (int i=0; i<sources; i++)		TEST_CHECK(0 == replayer.Start(i, path, STREAM_SPEED_FAST, 1, __Feed, NULL));
+	TEST_CHECK(-1 == replayer.Start(0, path, STREAM_SPEED_FAST, 1, __Feed, NULL));
+	TEST_CHECK(-1 == replayer.Start(sources, bad, STREAM_SPEED_FAST, 1, __Feed, NULL));
+	TEST_CHECK(-1 == replayer.Start(STREAM_MAX_SOURCES, path, STREAM_SPEED_FAST, 1, __Feed, NULL));
+	TEST_CHECK(0 == __WaitSources(&replayer, sources, 4, 30000));
+
+	for (int i=0; i<sources; i++)
+	{
+		STREAM_REPLAY_STATS_T stats;
+		TEST_CHECK(STREAM_STATE_RUNNING == replayer.GetStats(i, &stats));
+		replayer.Stop(i);
+		int same = (gSink[i].records.size() == recorded.size());
+		for (size_t k=0; same && k<recorded.size(); k++)		same = __SameRecord(&recorded[k], &gSink[i].records[k]);
+		TEST_CHECK(same);
+		TEST_CHECK(0 == gSink[i].ptsBack && stats.busy > 0 && stats.loops >= 4);
+	}
+
+	__ResetSinks(0, 0);
+	TEST_CHECK(0 == replayer.Start(0, path, 1, 0, __Feed, NULL));			//a hundred times slower
+	__VS_Delay(50);
+	unsigned long long start = _VS_GetNs();
+	replayer.Stop(0);
+	TEST_CHECK(__TestSeconds(start) < 0.5);
+	unsigned int fed = gSink[0].fed;
+	__VS_Delay(30);
+	TEST_CHECK(fed == gSink[0].fed);
+
+	unlink(path);
+	unlink(bad);
+	__TestResult("TestLoop", before);
+}
+
+//the file size limit fails a write part way: the file still ends at a complete record, and it
+//replays and loops up to there
+static void TestWriteFailure()
+{
+	int before = gTestFailures;
+	unsigned int seed = 17;
+	char path[128];
+	sprintf(path, "%s/c.strm", gDir);
+
+	struct rlimit limit, saved;
+	getrlimit(RLIMIT_FSIZE, &saved);
+	limit = saved;
+	limit.rlim_cur = 3 * STREAM_FILE_BUFFER + 12345;
+	signal(SIGXFSZ, SIG_IGN);
+	TEST_CHECK(0 == setrlimit(RLIMIT_FSIZE, &limit));
+
+	CStreamRecorder recorder;
+	TEST_CHECK(0 == recorder.Start(5, path));
+	std::vector<char> buf(30000);
+	RTSP_FRAME_INFO	frameInfo;
+	memset(&frameInfo, 0x00, sizeof(RTSP_FRAME_INFO));
+	frameInfo.codec = EASY_SDK_VIDEO_CODEC_H264;
+	unsigned int writes = 0;
+	for (; writes<1000 && recorder.IsRecording(5); writes++)
+	{
+		frameInfo.length			=	1000 + __TestRand(&seed) % 29000;
+		frameInfo.timestamp_sec		=	writes / 25;
+		frameInfo.timestamp_usec	=	writes % 25 * 40000;
+		recorder.Write(5, EASY_SDK_VIDEO_FRAME_FLAG, &buf[0], &frameInfo);
+	}
+	recorder.Stop(5);
+	setrlimit(RLIMIT_FSIZE, &saved);
+	TEST_CHECK(writes < 1000);
+
+	//walk the file: complete records up to its very end
+	struct stat st;
+	TEST_CHECK(0 == stat(path, &st));
+	FILE *f = fopen(path, "rb");
+	unsigned int records = 0;
+	long long offset = sizeof(STREAM_FILE_HEADER_T), end = (long long)st.st_size;
+	STREAM_RECORD_T record;
+	while (NULL != f && 0 == fseek(f, (long)offset, SEEK_SET) && 1 == fread(&record, sizeof(STREAM_RECORD_T), 1, f))
+	{
+		offset += sizeof(STREAM_RECORD_T) + ((record.flags & STREAM_RECORD_INFO) ? sizeof(RTSP_FRAME_INFO) : 0) + record.payloadLength;
+		if (offset <= end)		records ++;
+	}
+	if (NULL != f)		fclose(f);
+	TEST_CHECK(offset == end && records > 0 && end <= (long long)limit.rlim_cur);
+
+	__ResetSinks(0, 0);
+	CStreamReplayer replayer;
+	TEST_CHECK(0 == replayer.Start(0, path, STREAM_SPEED_FAST, 1, __Feed, NULL));
+	TEST_CHECK(0 == __WaitSources(&replayer, 1, 2, 10000));
+	STREAM_REPLAY_STATS_T stats;
+	TEST_CHECK(STREAM_STATE_RUNNING == replayer.GetStats(0, &stats));		//not stopped at a damaged record
+	replayer.Stop(0);
+	replayer.GetStats(0, &stats);
+	TEST_CHECK(stats.records >= 2 * records && 0 == gSink[0].ptsBack);
+
+	unlink(path);
+	__TestResult("TestWriteFailure", before);
+}
+
+static void BenchReplay()
+{
+	unsigned int seed = 19;
+	char path[128];
+	sprintf(path, "%s/bench.strm", gDir);
+	CStreamRecorder recorder;
+	__Record(&recorder, 0, path, 2000, &seed, NULL);
+
+	static const int counts[] = {1, 16, 64};
+	for (int c=0; c<(int)(sizeof(counts)/sizeof(counts[0])); c++)
+	{
+		__ResetSinks(0, 0);
+		CStreamReplayer replayer;
+		unsigned long long start = _VS_GetNs();
+		for (int i=0; i<counts[c]; i++)		replayer.Start(i, path, STREAM_SPEED_FAST, 1, __Feed, NULL);
+		__WaitSources(&replayer, counts[c], 10, 60000);
+		double sec = __TestSeconds(start);
+		unsigned long long records = 0, bytes = 0;
+		for (int i=0; i<counts[c]; i++)
+		{
+			replayer.Stop(i);
+			records += gSink[i].fed;
+			bytes += gSink[i].bytes;
+		}
+		printf("fast, %2d sources x 10 passes: %9.0f records/s %8.1f MB/s video\n", counts[c], records / sec, bytes / sec / 1e6);
+	}
+	unlink(path);
+}
+
+//N sources looping over the files in turn for seconds, a line every 10 s; fails on a source
+//that stops before the end, PTS going back, or a source fed nothing
+static int Soak(int argc, char *argv[])
+{
+	int sources = argc > 2 ? atoi(argv[2]) : 16;
+	int seconds = argc > 3 ? atoi(argv[3]) : 60;
+	int speed = argc > 4 ? atoi(argv[4]) : STREAM_SPEED_REALTIME;
+	if (sources < 1 || sources > STREAM_MAX_SOURCES || seconds < 1 || speed < 0 || speed > STREAM_MAX_SPEED)
+	{
+		printf("usage: %s soak [1-%d sources] [seconds] [speed, %d realtime, 0 fast] [file.strm ...]\n", argv[0], STREAM_MAX_SOURCES, STREAM_SPEED_REALTIME);
+		return 1;
+	}
+
+	std::vector<const char *> files;
+	for (int i=5; i<argc; i++)		files.push_back(argv[i]);
+	char path[128];
+	if (files.empty())
+	{
+		unsigned int seed = 23;
+		sprintf(path, "%s/soak.strm", gDir);
+		CStreamRecorder recorder;
+		if (0 != __Record(&recorder, 0, path, 4000, &seed, NULL))		return 1;
+		files.push_back(path);
+	}
+
+	__ResetSinks(0, 0);
+	CStreamReplayer replayer;
+	for (int i=0; i<sources; i++)
+	{
+		const char *file = files[i % files.size()];
+		if (0 != replayer.Start(i, file, speed, 1, __Feed, NULL))
+		{
+			printf("  FAIL source %d: %s is not a stream file\n", i, file);
+			gTestFailures ++;
+		}
+	}
+	printf("soak: %d sources, %d s, speed %d, %d file(s)\n", sources, seconds, speed, (int)files.size());
+
+	unsigned long long start = _VS_GetNs();
+	for (int t=1; t<=seconds && 0 == gTestFailures; t++)
+	{
+		_VS_SleepUntilNs(start + (unsigned long long)t * 1000000000ULL);
+		if (0 != t % 10 && seconds != t)		continue;
+
+		unsigned long long records = 0, bytes = 0;
+		unsigned int loops = 0, busy = 0;
+		long long late = 0;
+		for (int i=0; i<sources; i++)
+		{
+			STREAM_REPLAY_STATS_T stats;
+			if (STREAM_STATE_RUNNING != replayer.GetStats(i, &stats))
+			{
+				printf("  FAIL source %d stopped after %u records: %s damaged\n", i, stats.records, files[i % files.size()]);
+				gTestFailures ++;
+			}
+			records += stats.records;
+			bytes += stats.bytes;
+			loops += stats.loops;
+			busy += stats.busy;
+			late = std::max(late, stats.maxLateUs);
+		}
+		printf("  %4d s: %llu records, %.1f MB, %u passes, %u busy, latest wakeup %lld us\n", t, records, bytes / 1e6, loops, busy, late);
+	}
+
+	for (int i=0; i<sources; i++)
+	{
+		replayer.Stop(i);
+		TEST_CHECK(0 == gSink[i].ptsBack);
+		TEST_CHECK(gSink[i].fed > 0);
+	}
+	if (files[0] == path)		unlink(path);
+	__TestResult("Soak", 0);
+	return gTestFailures;
+}
+
+int main(int argc, char *argv[])
+{
+	if (NULL == mkdtemp(gDir))
+	{
+		printf("no temporary directory\n");
+		return 1;
+	}
+
+	int ret = 0;
+	if (argc > 1 && 0 == strcmp(argv[1], "soak"))
+	{
+		ret = Soak(argc, argv);
+	}
+	else if (__TestIsBench(argc, argv))
+	{
+		BenchReplay();
+	}
+	else
+	{
+		TestRoundTrip();
+		TestLoop();
+		TestWriteFailure();
+		ret = gTestFailures;
+	}
+	rmdir(gDir);
+	return ret;
+}
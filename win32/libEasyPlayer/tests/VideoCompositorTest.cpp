@@ -0,0 +1,323 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//CVideoCompositor on an offscreen canvas: grid layout, tiles against a direct scale, letterbox,
+//dirty tracking, explicit layouts, concurrent updates; update and present cost per grid
+#include "PlayerTest.h"
+#include "VideoCompositor.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <vector>
+
+//a random YUV420P frame
+typedef struct __TEST_SOURCE_T
+{
+	std::vector<unsigned char>	mem;
+	VC_FRAME_T					frame;
+}TEST_SOURCE_T;
+
+static void __InitSource(TEST_SOURCE_T *src, int width, int height, unsigned int *seed)
+{
+	src->mem.resize(VC_FrameSize(VC_FORMAT_YUV420P, width, height));
+	for (size_t i=0; i<src->mem.size(); i++)		src->mem[i] = (unsigned char)__TestRand(seed);
+	VC_FillFrame(&src->frame, VC_FORMAT_YUV420P, width, height, &src->mem[0]);
+}
+
+//stands in for the window: Present copies the dirty rects into it
+typedef struct __TEST_SCREEN_T
+{
+	std::vector<unsigned char>	pixels;
+	int							width;
+	long long					bytes;			//copied since reset
+	int							rects;
+}TEST_SCREEN_T;
+
+static void __InitScreen(TEST_SCREEN_T *screen, int width, int height)
+{
+	screen->pixels.assign((size_t)width * height * 4, 0);
+	screen->width = width;
+	screen->bytes = 0;
+	screen->rects = 0;
+}
+
+static void __CopyToScreen(void *userPtr, const unsigned char *pCanvas, int stride, const VCOMP_RECT_T *rect)
+{
+	TEST_SCREEN_T *screen = (TEST_SCREEN_T *)userPtr;
+	for (int y=0; y<rect->height; y++)
+	{
+		memcpy(&screen->pixels[((size_t)(rect->y + y) * screen->width + rect->x) * 4],
+			   pCanvas + (size_t)(rect->y + y) * stride + rect->x * 4, rect->width * 4);
+	}
+	screen->bytes += (long long)rect->width * rect->height * 4;
+	screen->rects ++;
+}
+
+static void __CountRects(void *userPtr, const unsigned char * /*pCanvas*/, int /*stride*/, const VCOMP_RECT_T * /*rect*/)
+{
+	(*(int *)userPtr) ++;
+}
+
+static void TestLayout()
+{
+	int before = gTestFailures;
+	CVideoCompositor compositor;
+	compositor.Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	TEST_CHECK(0 == compositor.Resize(1920, 1080));
+	TEST_CHECK(0 == compositor.SetLayout(36));
+
+	//every tile inside the canvas, none overlap, only the gaps are left over
+	std::vector<int> cover(1920*1080, 0);
+	for (int i=0; i<36; i++)
+	{
+		VCOMP_RECT_T rect;
+		TEST_CHECK(0 == compositor.GetTileRect(i, &rect));
+		TEST_CHECK(rect.x >= 0 && rect.y >= 0 && rect.x + rect.width <= 1920 && rect.y + rect.height <= 1080);
+		TEST_CHECK(rect.width > 300 && rect.height > 170);
+		for (int y=rect.y; y<rect.y+rect.height; y++)
+		{
+			for (int x=rect.x; x<rect.x+rect.width; x++)		cover[y*1920+x] ++;
+		}
+	}
+	int maxCover = 0;
+	long long covered = 0;
+	for (size_t i=0; i<cover.size(); i++)
+	{
+		if (cover[i] > maxCover)		maxCover = cover[i];
+		covered += cover[i];
+	}
+	TEST_CHECK(1 == maxCover);
+	TEST_CHECK(covered > 1920*1080*97/100);
+	VCOMP_RECT_T rect;
+	TEST_CHECK(-1 == compositor.GetTileRect(36, &rect));
+
+	//an explicit layout is clipped to the canvas and survives a resize
+	VCOMP_RECT_T rects[2] = {{0, 0, 1280, 720}, {1280, 0, 1280, 720}};
+	TEST_CHECK(0 == compositor.SetLayout(rects, 2));
+	compositor.GetTileRect(1, &rect);
+	TEST_CHECK(1280 == rect.x && 640 == rect.width);
+	TEST_CHECK(0 == compositor.Resize(2560, 1440));
+	compositor.GetTileRect(1, &rect);
+	TEST_CHECK(1280 == rect.x && 1280 == rect.width && 720 == rect.height);
+	__TestResult("TestLayout", before);
+}
+
+static void TestTiles()
+{
+	int before = gTestFailures;
+	unsigned int seed = 3;
+	CVideoCompositor compositor;
+	TEST_SOURCE_T src, src43;
+	__InitSource(&src, 640, 360, &seed);
+	__InitSource(&src43, 352, 288, &seed);
+
+	TEST_CHECK(-1 == compositor.UpdateTile(0, &src.frame, 0));		//before Init
+	compositor.Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	TEST_CHECK(-1 == compositor.UpdateTile(0, NULL, 0));
+	compositor.Resize(1920, 1080);
+	compositor.SetLayout(36);
+
+	//the first Present hands out the whole background
+	TEST_SCREEN_T screen;
+	__InitScreen(&screen, 1920, 1080);
+	TEST_CHECK(1 == compositor.Present(__CopyToScreen, &screen));
+	TEST_CHECK(0 == compositor.Present(__CopyToScreen, &screen));
+	TEST_CHECK(0x3C == screen.pixels[0] && 0xFF == screen.pixels[3]);
+
+	//a tile holds exactly what scaling the frame to its size gives
+	VCOMP_RECT_T rect;
+	compositor.GetTileRect(7, &rect);
+	TEST_CHECK(0 == compositor.UpdateTile(7, &src.frame, 0));
+	std::vector<unsigned char> ref((size_t)rect.width * rect.height * 4);
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	VC_FRAME_T dst;
+	VC_FillFrame(&dst, VC_FORMAT_BGRA, rect.width, rect.height, &ref[0]);
+	VC_ScaleRows(&src.frame, &dst, &matrix, VC_FILTER_AREA, 0, rect.height);
+	TEST_CHECK(1 == compositor.Present(__CopyToScreen, &screen));
+	int same = 1;
+	for (int y=0; y<rect.height; y++)
+	{
+		if (0 != memcmp(&screen.pixels[((size_t)(rect.y + y) * 1920 + rect.x) * 4], &ref[(size_t)y * rect.width * 4], rect.width * 4))		same = 0;
+	}
+	TEST_CHECK(same);
+
+	//4:3 shown to scale in a 16:9 tile: background left and right of it
+	TEST_CHECK(0 == compositor.UpdateTile(7, &src43.frame, 1));
+	TEST_CHECK(1 == compositor.Present(__CopyToScreen, &screen));
+	const unsigned int *row = (const unsigned int *)&screen.pixels[((size_t)(rect.y + rect.height/2) * 1920 + rect.x) * 4];
+	TEST_CHECK(VCOMP_DEFAULT_BKCOLOR == row[0] && VCOMP_DEFAULT_BKCOLOR == row[rect.width-1] && VCOMP_DEFAULT_BKCOLOR != row[rect.width/2]);
+
+	//only the changed tiles are presented, a cleared tile once
+	int rects = 0;
+	compositor.UpdateTile(1, &src.frame, 0);
+	compositor.UpdateTile(30, &src.frame, 0);
+	compositor.UpdateTile(1, &src.frame, 0);
+	TEST_CHECK(2 == compositor.Present(__CountRects, &rects) && 2 == rects);
+	TEST_CHECK(0 == compositor.ClearTile(30));
+	TEST_CHECK(0 == compositor.ClearTile(30));
+	TEST_CHECK(1 == compositor.Present(__CountRects, &rects));
+	TEST_CHECK(0 == compositor.ClearTile(5));
+	TEST_CHECK(0 == compositor.Present(__CountRects, &rects));			//already background
+
+	//odd canvas, both scale modes
+	TEST_CHECK(0 == compositor.Resize(333, 199));
+	TEST_CHECK(0 == compositor.SetLayout(9, 3));
+	for (int i=0; i<9; i++)		TEST_CHECK(0 == compositor.UpdateTile(i, &src43.frame, i & 1));
+	TEST_CHECK(1 == compositor.Present(__CountRects, &rects));
+	TEST_CHECK(-1 == compositor.UpdateTile(9, &src.frame, 0));
+
+	compositor.Deinit();
+	TEST_CHECK(-1 == compositor.UpdateTile(0, &src.frame, 0));
+	__TestResult("TestTiles", before);
+}
+
+typedef struct __TEST_UPDATER_T
+{
+	CVideoCompositor	*compositor;
+	const VC_FRAME_T	*frame;
+	int					tile;
+	volatile int		*stop;
+}TEST_UPDATER_T;
+
+static void *__UpdateThread(void *lpParam)
+{
+	TEST_UPDATER_T *updater = (TEST_UPDATER_T *)lpParam;
+	while (! *updater->stop)
+	{
+		updater->compositor->UpdateTile(updater->tile, updater->frame, updater->tile & 1);
+		usleep(500);
+	}
+	return NULL;
+}
+
+static void *__PresentThread(void *lpParam)
+{
+	TEST_UPDATER_T *updater = (TEST_UPDATER_T *)lpParam;
+	int rects = 0;
+	while (! *updater->stop)
+	{
+		updater->compositor->Present(__CountRects, &rects);
+		usleep(2000);
+	}
+	return NULL;
+}
+
+//every tile updated from its own thread while another presents and the canvas changes size
+static void TestThreads()
+{
+	int before = gTestFailures;
+	unsigned int seed = 5;
+	CVideoCompositor compositor;
+	compositor.Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	TEST_CHECK(0 == compositor.Resize(1920, 1080));
+	TEST_CHECK(0 == compositor.SetLayout(16));
+	TEST_SOURCE_T src;
+	__InitSource(&src, 320, 180, &seed);
+
+	volatile int stop = 0;
+	TEST_UPDATER_T updater[17];
+	pthread_t thread[17];
+	for (int i=0; i<17; i++)
+	{
+		updater[i].compositor = &compositor;
+		updater[i].frame = &src.frame;
+		updater[i].tile = i;
+		updater[i].stop = &stop;
+		TEST_CHECK(0 == pthread_create(&thread[i], NULL, i < 16 ? __UpdateThread : __PresentThread, &updater[i]));
+	}
+	for (int k=0; k<20; k++)
+	{
+		TEST_CHECK(0 == compositor.Resize(1280 + k*16, 720 + k*8));
+		TEST_CHECK(0 == compositor.SetLayout((k & 1) ? 9 : 16));
+	}
+	stop = 1;
+	for (int i=0; i<17; i++)		pthread_join(thread[i], NULL);
+
+	TEST_SCREEN_T screen;
+	__InitScreen(&screen, compositor.GetWidth(), compositor.GetHeight());
+	compositor.Invalidate();
+	TEST_CHECK(compositor.Present(__CopyToScreen, &screen) >= 1);
+	TEST_CHECK(screen.bytes == (long long)compositor.GetWidth() * compositor.GetHeight() * 4);
+	__TestResult("TestThreads", before);
+}
+
+//a 1080p canvas: every tile updated once, then Present with all tiles or a quarter of them dirty
+static void BenchCompositor()
+{
+	unsigned int seed = 7;
+	static const int layouts[] = {16, 36, 64};
+	static const int sizes[][2] = {{352,288}, {640,360}, {1280,720}};
+
+	printf("%-6s %-9s %10s %10s %12s %9s %12s %9s\n", "tiles", "source", "update ms", "ms/tile", "present all", "MB", "present 1/4", "MB");
+	for (int l=0; l<(int)(sizeof(layouts)/sizeof(layouts[0])); l++)
+	{
+		for (int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++)
+		{
+			int tiles = layouts[l];
+			CVideoCompositor compositor;
+			compositor.Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+			compositor.Resize(1920, 1080);
+			compositor.SetLayout(tiles);
+			TEST_SCREEN_T screen;
+			__InitScreen(&screen, 1920, 1080);
+			compositor.Present(__CopyToScreen, &screen);
+			TEST_SOURCE_T src;
+			__InitSource(&src, sizes[s][0], sizes[s][1], &seed);
+
+			double update = 1e9, presentAll = 1e9, presentPart = 1e9;
+			for (int run=0; run<5; run++)
+			{
+				unsigned long long start = _VS_GetNs();
+				for (int i=0; i<tiles; i++)		compositor.UpdateTile(i, &src.frame, 1);
+				double sec = __TestSeconds(start);
+				if (sec < update)		update = sec;
+			}
+			compositor.Present(__CopyToScreen, &screen);
+
+			long long bytesAll = 0, bytesPart = 0;
+			for (int run=0; run<5; run++)
+			{
+				for (int i=0; i<tiles; i++)		compositor.UpdateTile(i, &src.frame, 1);
+				screen.bytes = 0;
+				unsigned long long start = _VS_GetNs();
+				compositor.Present(__CopyToScreen, &screen);
+				double sec = __TestSeconds(start);
+				if (sec < presentAll)		presentAll = sec;
+				bytesAll = screen.bytes;
+			}
+			for (int run=0; run<5; run++)
+			{
+				for (int i=0; i<tiles; i+=4)	compositor.UpdateTile(i, &src.frame, 1);
+				screen.bytes = 0;
+				unsigned long long start = _VS_GetNs();
+				compositor.Present(__CopyToScreen, &screen);
+				double sec = __TestSeconds(start);
+				if (sec < presentPart)		presentPart = sec;
+				bytesPart = screen.bytes;
+			}
+
+			char szSize[32];
+			sprintf(szSize, "%dx%d", sizes[s][0], sizes[s][1]);
+			printf("%-6d %-9s %10.2f %10.3f %12.2f %9.1f %12.2f %9.1f\n", tiles, szSize, update * 1e3, update * 1e3 / tiles,
+				   presentAll * 1e3, bytesAll / 1e6, presentPart * 1e3, bytesPart / 1e6);
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (__TestIsBench(argc, argv))
+	{
+		BenchCompositor();
+		return 0;
+	}
+
+	TestLayout();
+	TestTiles();
+	TestThreads();
+	return gTestFailures;
+}
@@ -0,0 +1,578 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//VC_ConvertRows/VC_ScaleRows: every SIMD kernel (AVX2, then SSE2/NEON) against the scalar
+//reference, the matrix against floating point, threaded slices against one thread, crops against
+//the full frame; throughput per kernel, of 1080p scaled to the grid tiles and of 4K crops
+#include "PlayerTest.h"
+#include "VideoConverter.h"
+#include "vssimd.h"
+#include <math.h>
+#include <vector>
+
+static const VC_FORMAT	gFormats[] = {VC_FORMAT_YUV420P, VC_FORMAT_YV12, VC_FORMAT_YUY2, VC_FORMAT_UYVY,
+									  VC_FORMAT_BGRA, VC_FORMAT_RGB565, VC_FORMAT_RGB555, VC_FORMAT_BGR24};
+static const char		*gFormatNames[] = {"YUV420P", "YV12", "YUY2", "UYVY", "BGRA", "RGB565", "RGB555", "BGR24"};
+#define	VCTEST_FORMATS	(int)(sizeof(gFormats)/sizeof(gFormats[0]))
+
+//a frame in mem with pad bytes after every row, so a kernel writing past the row shows up
+static void __AllocFrame(VC_FRAME_T *frame, std::vector<unsigned char>& mem, VC_FORMAT format, int width, int height, int pad)
+{
+	VC_FillFrame(frame, format, width, height, NULL);
+	int		rows[3] = {height, (height+1)/2, (height+1)/2};
+	size_t	offset[3] = {0, 0, 0}, total = 0;
+	for (int p=0; p<3; p++)
+	{
+		if (0 == frame->stride[p])		continue;
+		frame->stride[p] += pad;
+		offset[p] = total;
+		total += (size_t)frame->stride[p] * rows[p];
+	}
+	mem.assign(total, 0xCD);
+	for (int p=0; p<3; p++)
+	{
+		frame->plane[p] = frame->stride[p] ? &mem[offset[p]] : NULL;
+	}
+}
+
+static void __FillRandom(std::vector<unsigned char>& mem, unsigned int *seed)
+{
+	for (size_t i=0; i<mem.size(); i++)		mem[i] = (unsigned char)__TestRand(seed);
+}
+
+static void TestKernels()
+{
+	int before = gTestFailures;
+	unsigned int seed = 1;
+	static const int sizes[][2] = {{1,1}, {2,2}, {15,3}, {16,2}, {17,5}, {33,7}, {63,9}, {64,4}, {127,11}, {320,17}};
+
+	//every kernel this machine has: the detected one, then the baseline
+	for (int avx2=1; avx2>=0; avx2--)
+	{
+		_VS_SetAvx2(avx2);
+		for (int cs=0; cs<2; cs++)
+		{
+			VC_MATRIX_T matrix;
+			VC_InitMatrix(&matrix, (VC_COLORSPACE)cs, cs ? VC_RANGE_FULL : VC_RANGE_LIMITED);
+			for (int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++)
+			{
+				for (int pad=0; pad<=5; pad+=5)
+				{
+					VC_FRAME_T src;
+					std::vector<unsigned char> srcMem;
+					__AllocFrame(&src, srcMem, pad ? VC_FORMAT_YV12 : VC_FORMAT_YUV420P, sizes[s][0], sizes[s][1], pad);
+					__FillRandom(srcMem, &seed);
+
+					for (int f=0; f<VCTEST_FORMATS; f++)
+					{
+						VC_FRAME_T a, b;
+						std::vector<unsigned char> aMem, bMem;
+						__AllocFrame(&a, aMem, gFormats[f], sizes[s][0], sizes[s][1], pad);
+						__AllocFrame(&b, bMem, gFormats[f], sizes[s][0], sizes[s][1], pad);
+						TEST_CHECK(0 == VC_ConvertRows(&src, &a, &matrix, 0, sizes[s][1], 1));
+						TEST_CHECK(0 == VC_ConvertRows(&src, &b, &matrix, 0, sizes[s][1], 0));
+						TEST_CHECK(aMem == bMem);
+					}
+				}
+			}
+		}
+	}
+	_VS_SetAvx2(1);
+	__TestResult("TestKernels", before);
+}
+
+static int __Round255(double v)
+{
+	v = floor(v + 0.5);
+	return v < 0.0 ? 0 : (v > 255.0 ? 255 : (int)v);
+}
+
+//the Q13 matrix within one step of the floating point formulas, and fixed points
+static void TestMatrix()
+{
+	int before = gTestFailures;
+
+	for (int cs=0; cs<2; cs++)
+	{
+		for (int range=0; range<2; range++)
+		{
+			VC_MATRIX_T matrix;
+			VC_InitMatrix(&matrix, (VC_COLORSPACE)cs, (VC_RANGE)range);
+			double kr = cs ? 0.2126 : 0.299, kb = cs ? 0.0722 : 0.114, kg = 1.0 - kr - kb;
+			double yScale = range ? 1.0 : 255.0 / 219.0, cScale = range ? 1.0 : 255.0 / 224.0;
+
+			int maxErr = 0;
+			for (int Y=0; Y<256; Y+=3)
+			{
+				for (int U=0; U<256; U+=5)
+				{
+					for (int V=0; V<256; V+=7)
+					{
+						unsigned char yv[2] = {(unsigned char)Y, (unsigned char)Y}, u = (unsigned char)U, v = (unsigned char)V, out[8];
+						VC_FRAME_T src, dst;
+						VC_FillFrame(&src, VC_FORMAT_YUV420P, 2, 1, NULL);
+						src.plane[0] = yv;	src.plane[1] = &u;	src.plane[2] = &v;
+						VC_FillFrame(&dst, VC_FORMAT_BGRA, 2, 1, out);
+						VC_ConvertRows(&src, &dst, &matrix, 0, 1, 0);
+
+						double y = range ? Y : (Y - 16) * yScale, cu = (U - 128) * cScale, cv = (V - 128) * cScale;
+						int ref[3] = {__Round255(y + 2*(1-kb)*cu), __Round255(y - 2*(1-kb)*kb/kg*cu - 2*(1-kr)*kr/kg*cv), __Round255(y + 2*(1-kr)*cv)};
+						for (int c=0; c<3; c++)
+						{
+							int err = abs(ref[c] - out[c]);
+							if (err > maxErr)		maxErr = err;
+						}
+						TEST_CHECK(0xFF == out[3]);
+					}
+				}
+			}
+			TEST_CHECK(maxErr <= 1);
+		}
+	}
+
+	//BT.601 limited: 235 white, 16 black in every output format
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	unsigned char yv[2] = {235, 16}, u = 128, v = 128, out[8];
+	VC_FRAME_T src, dst;
+	VC_FillFrame(&src, VC_FORMAT_YUV420P, 2, 1, NULL);
+	src.plane[0] = yv;	src.plane[1] = &u;	src.plane[2] = &v;
+	VC_FillFrame(&dst, VC_FORMAT_BGRA, 2, 1, out);
+	VC_ConvertRows(&src, &dst, &matrix, 0, 1);
+	TEST_CHECK(out[0] == 255 && out[1] == 255 && out[2] == 255 && out[4] == 0 && out[5] == 0 && out[6] == 0);
+	unsigned short px[2];
+	VC_FillFrame(&dst, VC_FORMAT_RGB565, 2, 1, (unsigned char *)px);
+	VC_ConvertRows(&src, &dst, &matrix, 0, 1);
+	TEST_CHECK(px[0] == 0xFFFF && px[1] == 0);
+	VC_FillFrame(&dst, VC_FORMAT_RGB555, 2, 1, (unsigned char *)px);
+	VC_ConvertRows(&src, &dst, &matrix, 0, 1);
+	TEST_CHECK(px[0] == 0x7FFF && px[1] == 0);
+	unsigned char yuy2[4];
+	VC_FillFrame(&dst, VC_FORMAT_YUY2, 2, 1, yuy2);
+	VC_ConvertRows(&src, &dst, &matrix, 0, 1);
+	TEST_CHECK(yuy2[0] == 235 && yuy2[1] == 128 && yuy2[2] == 16 && yuy2[3] == 128);
+
+	TEST_CHECK(-1 == VC_ConvertRows(&src, &dst, &matrix, 1, 1));		//odd y0
+	dst.width = 4;
+	TEST_CHECK(-1 == VC_ConvertRows(&src, &dst, &matrix, 0, 1));		//other size
+	TEST_CHECK(VC_FrameSize(VC_FORMAT_YUV420P, 3, 3) == 9 + 2*4);
+	TEST_CHECK(VC_FrameSize(VC_FORMAT_UYVY, 3, 3) == 8*3);
+	__TestResult("TestMatrix", before);
+}
+
+static void TestThreads()
+{
+	int before = gTestFailures;
+	unsigned int seed = 3;
+	static const int sizes[][2] = {{3840,2160}, {1921,1081}, {64,40}};
+
+	for (int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++)
+	{
+		VC_FRAME_T src;
+		std::vector<unsigned char> srcMem;
+		__AllocFrame(&src, srcMem, VC_FORMAT_YUV420P, sizes[s][0], sizes[s][1], 0);
+		__FillRandom(srcMem, &seed);
+		for (int f=0; f<VCTEST_FORMATS; f++)
+		{
+			VC_FRAME_T a, b;
+			std::vector<unsigned char> aMem, bMem;
+			__AllocFrame(&a, aMem, gFormats[f], sizes[s][0], sizes[s][1], 0);
+			__AllocFrame(&b, bMem, gFormats[f], sizes[s][0], sizes[s][1], 0);
+			CVideoConverter one, four;
+			one.Init(VC_COLORSPACE_BT709, VC_RANGE_LIMITED, 1);
+			four.Init(VC_COLORSPACE_BT709, VC_RANGE_LIMITED, 4);
+			TEST_CHECK(4 == four.GetThreads());
+			for (int i=0; i<3; i++)		TEST_CHECK(0 == four.Convert(&src, &a));
+			TEST_CHECK(0 == one.Convert(&src, &b));
+			TEST_CHECK(aMem == bMem);
+		}
+	}
+
+	CVideoConverter converter;
+	TEST_CHECK(0 == converter.Init(VC_COLORSPACE_BT601, VC_RANGE_FULL));
+	converter.Deinit();
+	TEST_CHECK(0 == converter.Init(VC_COLORSPACE_BT601, VC_RANGE_FULL, 3));
+	converter.Deinit();
+	__TestResult("TestThreads", before);
+}
+
+//both filters, up and down, odd sizes, padded rows: SIMD equals scalar and two slices equal one
+static void TestScale()
+{
+	int before = gTestFailures;
+	unsigned int seed = 7;
+	static const int sizes[][4] = {{1920,1080,320,180}, {1920,1080,641,361}, {100,50,33,17}, {35,21,70,43},
+								   {17,9,1,1}, {1,1,5,3}, {64,64,64,32}, {300,200,299,201}};
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+
+	for (int avx2=1; avx2>=0; avx2--)
+	{
+		_VS_SetAvx2(avx2);
+		for (int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++)
+		{
+			int dstWidth = sizes[s][2], dstHeight = sizes[s][3], mid = (dstHeight / 2) & ~1;
+			for (int filter=0; filter<2; filter++)
+			{
+				for (int pad=0; pad<=3; pad+=3)
+				{
+					VC_FRAME_T src;
+					std::vector<unsigned char> srcMem;
+					__AllocFrame(&src, srcMem, VC_FORMAT_YUV420P, sizes[s][0], sizes[s][1], pad);
+					__FillRandom(srcMem, &seed);
+
+					for (int f=0; f<VCTEST_FORMATS; f++)
+					{
+						VC_FRAME_T a, b, c;
+						std::vector<unsigned char> aMem, bMem, cMem;
+						__AllocFrame(&a, aMem, gFormats[f], dstWidth, dstHeight, pad);
+						__AllocFrame(&b, bMem, gFormats[f], dstWidth, dstHeight, pad);
+						__AllocFrame(&c, cMem, gFormats[f], dstWidth, dstHeight, pad);
+						TEST_CHECK(0 == VC_ScaleRows(&src, &a, &matrix, (VC_FILTER)filter, 0, dstHeight, 1));
+						TEST_CHECK(0 == VC_ScaleRows(&src, &b, &matrix, (VC_FILTER)filter, 0, dstHeight, 0));
+						TEST_CHECK(aMem == bMem);
+						TEST_CHECK(0 == VC_ScaleRows(&src, &c, &matrix, (VC_FILTER)filter, 0, mid));
+						TEST_CHECK(0 == VC_ScaleRows(&src, &c, &matrix, (VC_FILTER)filter, mid, dstHeight));
+						TEST_CHECK(cMem == aMem);
+					}
+				}
+			}
+		}
+	}
+	_VS_SetAvx2(1);
+	__TestResult("TestScale", before);
+}
+
+//a flat colour stays flat through either filter, area 2:1 is the rounded mean of 2x2
+static void TestScaleValues()
+{
+	int before = gTestFailures;
+	unsigned int seed = 9;
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+
+	VC_FRAME_T src;
+	std::vector<unsigned char> srcMem;
+	__AllocFrame(&src, srcMem, VC_FORMAT_YUV420P, 64, 32, 0);
+	memset(src.plane[0], 90, 64*32);
+	memset(src.plane[1], 100, 32*16);
+	memset(src.plane[2], 200, 32*16);
+	for (int filter=0; filter<2; filter++)
+	{
+		VC_FRAME_T dst;
+		std::vector<unsigned char> dstMem;
+		__AllocFrame(&dst, dstMem, VC_FORMAT_YUV420P, 21, 11, 0);
+		TEST_CHECK(0 == VC_ScaleRows(&src, &dst, &matrix, (VC_FILTER)filter, 0, 11));
+		for (int i=0; i<21*11; i++)		TEST_CHECK(90 == dst.plane[0][i]);
+		for (int i=0; i<11*6; i++)		TEST_CHECK(100 == dst.plane[1][i] && 200 == dst.plane[2][i]);
+	}
+
+	__FillRandom(srcMem, &seed);
+	VC_FRAME_T dst;
+	std::vector<unsigned char> dstMem;
+	__AllocFrame(&dst, dstMem, VC_FORMAT_YUV420P, 32, 16, 0);
+	TEST_CHECK(0 == VC_ScaleRows(&src, &dst, &matrix, VC_FILTER_AREA, 0, 16));
+	for (int y=0; y<16; y++)
+	{
+		for (int x=0; x<32; x++)
+		{
+			const unsigned char *p = src.plane[0] + y*2*64 + x*2;
+			TEST_CHECK(dst.plane[0][y*32+x] == (p[0] + p[1] + p[64] + p[65] + 2) / 4);
+		}
+	}
+	__TestResult("TestScaleValues", before);
+}
+
+static void TestScaleThreads()
+{
+	int before = gTestFailures;
+	unsigned int seed = 11;
+	VC_FRAME_T src;
+	std::vector<unsigned char> srcMem;
+	__AllocFrame(&src, srcMem, VC_FORMAT_YUV420P, 3840, 2160, 0);
+	__FillRandom(srcMem, &seed);
+
+	for (int filter=0; filter<2; filter++)
+	{
+		for (int f=0; f<VCTEST_FORMATS; f++)
+		{
+			VC_FRAME_T a, b;
+			std::vector<unsigned char> aMem, bMem;
+			__AllocFrame(&a, aMem, gFormats[f], 1280, 720, 0);
+			__AllocFrame(&b, bMem, gFormats[f], 1280, 720, 0);
+			CVideoConverter one, four;
+			one.Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED, 1);
+			four.Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED, 4);
+			one.SetFilter((VC_FILTER)filter);
+			four.SetFilter((VC_FILTER)filter);
+			TEST_CHECK(0 == four.Convert(&src, &a));
+			TEST_CHECK(0 == one.Convert(&src, &b));
+			TEST_CHECK(aMem == bMem);
+		}
+	}
+	__TestResult("TestScaleThreads", before);
+}
+
+//VC_RenderRoi as GetRenderRoi uses it, then a cropped conversion is the same bytes as those rows
+//and columns of the whole frame converted
+static void TestCrop()
+{
+	int before = gTestFailures;
+	unsigned int seed = 15;
+	int roi[4];
+	TEST_CHECK(0 == VC_RenderRoi(0, 0, 0, 0, 1920, 1080, roi));				//SetRenderRect(NULL)
+	TEST_CHECK(0 == VC_RenderRoi(100, 100, 50, 200, 1920, 1080, roi));
+	TEST_CHECK(0 == VC_RenderRoi(0, 0, 1920, 1080, 1920, 1080, roi));			//the whole frame
+	TEST_CHECK(0 == VC_RenderRoi(-5, -5, 3000, 2000, 1920, 1080, roi));
+	TEST_CHECK(0 == VC_RenderRoi(100, 100, 114, 400, 1920, 1080, roi));			//narrower than 16
+	TEST_CHECK(0 == VC_RenderRoi(2000, 0, 2100, 100, 1920, 1080, roi));			//outside
+	TEST_CHECK(1 == VC_RenderRoi(101, 51, 1001, 551, 1920, 1080, roi));
+	TEST_CHECK(100 == roi[0] && 50 == roi[1] && 1002 == roi[2] && 552 == roi[3]);
+	TEST_CHECK(1 == VC_RenderRoi(-10, 1000, 700, 1200, 1920, 1080, roi));
+	TEST_CHECK(0 == roi[0] && 1000 == roi[1] && 700 == roi[2] && 1080 == roi[3]);
+
+	VC_FRAME_T src;
+	std::vector<unsigned char> srcMem;
+	__AllocFrame(&src, srcMem, VC_FORMAT_YUV420P, 1921, 1081, 3);
+	__FillRandom(srcMem, &seed);
+	VC_FRAME_T crop;
+	TEST_CHECK(-1 == VC_CropFrame(&src, &crop, 1921, 0, 10, 10));
+	TEST_CHECK(0 == VC_CropFrame(&src, &crop, 1911, 1071, 100, 100));
+	TEST_CHECK(1910 == (int)(crop.plane[0] - src.plane[0]) % src.stride[0] && 11 == crop.width && 11 == crop.height);
+
+	static const int windows[][4] = {{1201,801,959,539}, {0,0,640,360}, {1280,720,641,361}, {2,1,2,2}, {100,200,1,1}};
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	for (int f=0; f<VCTEST_FORMATS; f++)
+	{
+		VC_FRAME_T full;
+		std::vector<unsigned char> fullMem;
+		__AllocFrame(&full, fullMem, gFormats[f], src.width, src.height, 0);
+		TEST_CHECK(0 == VC_ConvertRows(&src, &full, &matrix, 0, src.height));
+		for (int w=0; w<(int)(sizeof(windows)/sizeof(windows[0])); w++)
+		{
+			TEST_CHECK(0 == VC_CropFrame(&src, &crop, windows[w][0], windows[w][1], windows[w][2], windows[w][3]));
+			int x = windows[w][0] & ~1, y = windows[w][1] & ~1;
+			VC_FRAME_T dst;
+			std::vector<unsigned char> dstMem;
+			__AllocFrame(&dst, dstMem, gFormats[f], crop.width, crop.height, 5);
+			CVideoConverter converter;
+			converter.Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED, 3);
+			TEST_CHECK(0 == converter.Convert(&crop, &dst));
+
+			//bytes per pixel of plane 0, chroma planes at half
+			int bytes = full.stride[0] / full.width;
+			int same = 1;
+			for (int p=0; p<3 && same; p++)
+			{
+				if (0 == dst.stride[p])		continue;
+				int shift = p ? 1 : 0, rows = p ? (crop.height + 1) / 2 : crop.height;
+				int rowBytes = p ? (crop.width + 1) / 2 : crop.width * bytes;
+				int xBytes = p ? x >> 1 : x * bytes;
+				for (int r=0; r<rows; r++)
+				{
+					if (0 != memcmp(dst.plane[p] + (size_t)r * dst.stride[p], full.plane[p] + (size_t)((y >> shift) + r) * full.stride[p] + xBytes, rowBytes))
+					{
+						same = 0;
+						break;
+					}
+				}
+			}
+			TEST_CHECK(same);
+		}
+	}
+	__TestResult("TestCrop", before);
+}
+
+//best of a few runs of one frame on the calling thread, ms
+static double __BestConvertMs(const VC_FRAME_T *src, VC_FRAME_T *dst, const VC_MATRIX_T *matrix, int simd, int runs)
+{
+	double best = 1e9;
+	for (int i=0; i<runs; i++)
+	{
+		unsigned long long start = _VS_GetNs();
+		VC_ConvertRows(src, dst, matrix, 0, src->height, simd);
+		double ms = (double)(_VS_GetNs() - start) / 1000000.0;
+		if (ms < best)		best = ms;
+	}
+	return best;
+}
+
+static void BenchConvert()
+{
+	unsigned int seed = 5;
+	static const int sizes[][2] = {{1280,720}, {1920,1080}, {3840,2160}};
+	int avx2 = _VS_UseAvx2();
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+
+	printf("%-10s %-8s %10s %10s %10s %10s\n", "size", "format", "scalar ms", "base ms", "AVX2 ms", "Mpx/s");
+	for (int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++)
+	{
+		VC_FRAME_T src;
+		std::vector<unsigned char> srcMem;
+		__AllocFrame(&src, srcMem, VC_FORMAT_YUV420P, sizes[s][0], sizes[s][1], 0);
+		__FillRandom(srcMem, &seed);
+		int runs = sizes[s][0] > 2000 ? 5 : 15;
+
+		for (int f=0; f<VCTEST_FORMATS; f++)
+		{
+			VC_FRAME_T dst;
+			std::vector<unsigned char> dstMem;
+			__AllocFrame(&dst, dstMem, gFormats[f], sizes[s][0], sizes[s][1], 0);
+
+			double scalar = __BestConvertMs(&src, &dst, &matrix, 0, runs);
+			_VS_SetAvx2(0);
+			double base = __BestConvertMs(&src, &dst, &matrix, 1, runs);
+			_VS_SetAvx2(1);
+			double fast = avx2 ? __BestConvertMs(&src, &dst, &matrix, 1, runs) : base;
+
+			char szSize[32];
+			sprintf(szSize, "%dx%d", sizes[s][0], sizes[s][1]);
+			printf("%-10s %-8s %10.2f %10.2f", szSize, gFormatNames[f], scalar, base);
+			if (avx2)		printf(" %10.2f", fast);
+			else			printf(" %10s", "-");
+			printf(" %10.0f\n", (double)sizes[s][0] * sizes[s][1] / fast / 1000.0);
+		}
+	}
+}
+
+static double __BestScaleMs(const VC_FRAME_T *src, VC_FRAME_T *dst, const VC_MATRIX_T *matrix, VC_FILTER filter, int runs)
+{
+	double best = 1e9;
+	for (int i=0; i<runs; i++)
+	{
+		unsigned long long start = _VS_GetNs();
+		VC_ScaleRows(src, dst, matrix, filter, 0, dst->height);
+		double ms = (double)(_VS_GetNs() - start) / 1000000.0;
+		if (ms < best)		best = ms;
+	}
+	return best;
+}
+
+//1080p scaled to the 4x4, 3x3 and 2x2 grid tiles against converting the full frame
+static void BenchScale()
+{
+	unsigned int seed = 13;
+	static const VC_FORMAT formats[] = {VC_FORMAT_BGR24, VC_FORMAT_BGRA, VC_FORMAT_YUV420P};
+	static const char *formatNames[] = {"BGR24", "BGRA", "YUV420P"};
+	static const int tiles[][2] = {{320,180}, {640,360}, {960,540}};
+	int avx2 = _VS_UseAvx2();
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+
+	VC_FRAME_T src;
+	std::vector<unsigned char> srcMem;
+	__AllocFrame(&src, srcMem, VC_FORMAT_YUV420P, 1920, 1080, 0);
+	__FillRandom(srcMem, &seed);
+
+	printf("\n%-8s %-10s %-9s %10s %10s %10s\n", "format", "tile", "filter", "base ms", "AVX2 ms", "vs full");
+	for (int f=0; f<(int)(sizeof(formats)/sizeof(formats[0])); f++)
+	{
+		VC_FRAME_T full;
+		std::vector<unsigned char> fullMem;
+		__AllocFrame(&full, fullMem, formats[f], 1920, 1080, 0);
+		double fullMs = __BestConvertMs(&src, &full, &matrix, 1, 15);
+		printf("%-8s %-10s %-9s %10s %10.2f\n", formatNames[f], "1920x1080", "-", "-", fullMs);
+
+		for (int t=0; t<(int)(sizeof(tiles)/sizeof(tiles[0])); t++)
+		{
+			for (int filter=0; filter<2; filter++)
+			{
+				VC_FRAME_T dst;
+				std::vector<unsigned char> dstMem;
+				__AllocFrame(&dst, dstMem, formats[f], tiles[t][0], tiles[t][1], 0);
+				_VS_SetAvx2(0);
+				double base = __BestScaleMs(&src, &dst, &matrix, (VC_FILTER)filter, 15);
+				_VS_SetAvx2(1);
+				double fast = avx2 ? __BestScaleMs(&src, &dst, &matrix, (VC_FILTER)filter, 15) : base;
+
+				char szTile[32];
+				sprintf(szTile, "%dx%d", tiles[t][0], tiles[t][1]);
+				printf("%-8s %-10s %-9s %10.2f", formatNames[f], szTile, filter ? "bilinear" : "area", base);
+				if (avx2)		printf(" %10.2f", fast);
+				else			printf(" %10s", "-");
+				printf(" %9.1fx\n", fullMs / fast);
+			}
+		}
+	}
+}
+
+//a 4K source shown through a SetRenderRect window: the whole frame converted as before, against
+//only the window converted, or the window scaled down to the window's display size
+static void BenchCrop()
+{
+	unsigned int seed = 17;
+	static const struct
+	{
+		int			x, y, width, height;
+		int			outWidth, outHeight;
+		VC_FORMAT	format;
+		const char	*name;
+	}cases[] = {
+		{0, 0, 3840, 2160, 3840, 2160, VC_FORMAT_BGRA, "BGRA"},
+		{960, 540, 1920, 1080, 1920, 1080, VC_FORMAT_BGRA, "BGRA"},
+		{1200, 800, 960, 540, 960, 540, VC_FORMAT_BGRA, "BGRA"},
+		{101, 99, 480, 270, 480, 270, VC_FORMAT_BGRA, "BGRA"},
+		{0, 0, 3840, 2160, 3840, 2160, VC_FORMAT_YUY2, "YUY2"},
+		{1200, 800, 960, 540, 960, 540, VC_FORMAT_YUY2, "YUY2"},
+		{960, 540, 1920, 1080, 640, 360, VC_FORMAT_BGR24, "BGR24"},
+	};
+	VC_FRAME_T src;
+	std::vector<unsigned char> srcMem;
+	__AllocFrame(&src, srcMem, VC_FORMAT_YUV420P, 3840, 2160, 0);
+	__FillRandom(srcMem, &seed);
+	CVideoConverter converter;
+	converter.Init(VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+
+	printf("\n%-24s %-10s %-7s %10s %10s\n", "4K window", "out", "format", "ms", "MB out");
+	for (int c=0; c<(int)(sizeof(cases)/sizeof(cases[0])); c++)
+	{
+		int roi[4] = {0, 0, src.width, src.height};
+		VC_RenderRoi(cases[c].x, cases[c].y, cases[c].x + cases[c].width, cases[c].y + cases[c].height, src.width, src.height, roi);
+		VC_FRAME_T crop;
+		VC_CropFrame(&src, &crop, roi[0], roi[1], roi[2] - roi[0], roi[3] - roi[1]);
+		VC_FRAME_T dst;
+		std::vector<unsigned char> dstMem;
+		__AllocFrame(&dst, dstMem, cases[c].format, cases[c].outWidth, cases[c].outHeight, 0);
+		converter.Convert(&crop, &dst);
+
+		double best = 1e9;
+		for (int run=0; run<10; run++)
+		{
+			unsigned long long start = _VS_GetNs();
+			converter.Convert(&crop, &dst);
+			double ms = (double)(_VS_GetNs() - start) / 1000000.0;
+			if (ms < best)		best = ms;
+		}
+		char szWindow[64], szOut[32];
+		sprintf(szWindow, "%dx%d at %d,%d", crop.width, crop.height, roi[0], roi[1]);
+		sprintf(szOut, "%dx%d", dst.width, dst.height);
+		printf("%-24s %-10s %-7s %10.2f %10.2f\n", szWindow, szOut, cases[c].name, best, dstMem.size() / 1048576.0);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (__TestIsBench(argc, argv))
+	{
+		printf("AVX2 kernels: %s\n", _VS_UseAvx2() ? "yes" : "not on this CPU");
+		BenchConvert();
+		BenchScale();
+		BenchCrop();
+		return 0;
+	}
+
+	TestKernels();
+	TestMatrix();
+	TestThreads();
+	TestScale();
+	TestScaleValues();
+	TestScaleThreads();
+	TestCrop();
+	return gTestFailures;
+}
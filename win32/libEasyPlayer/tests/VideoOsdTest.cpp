@@ -0,0 +1,193 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//CVideoOsd with a synthetic font: every blend kernel against the scalar one, clipped and odd
+//placements, colours at full and zero alpha; SetText and 1080p blend cost per format
+#include "PlayerTest.h"
+#include "VideoOsd.h"
+#include "vssimd.h"
+#include <vector>
+
+static const VC_FORMAT	gFormats[] = {VC_FORMAT_YUV420P, VC_FORMAT_YV12, VC_FORMAT_YUY2, VC_FORMAT_UYVY, VC_FORMAT_BGRA, VC_FORMAT_BGR24};
+static const char		*gFormatNames[] = {"YUV420P", "YV12", "YUY2", "UYVY", "BGRA", "BGR24"};
+#define	OSDTEST_FORMATS	(int)(sizeof(gFormats)/sizeof(gFormats[0]))
+
+static int	gGlyphCalls = 0;
+
+//box outlines with some half covered pixels inside, solid for '#'
+static int __Glyph(void * /*userPtr*/, char ch, unsigned char *pAlpha, int stride, int cellWidth, int height)
+{
+	gGlyphCalls ++;
+	int glyphWidth = height * 6 / 10;
+	if (' ' == ch)		return glyphWidth;
+	for (int y=1; y<height-1; y++)
+	{
+		for (int x=0; x<glyphWidth && x<cellWidth; x++)
+		{
+			int edge = (0 == x || glyphWidth-1 == x || 1 == y || height-2 == y);
+			pAlpha[y * stride + x] = ('#' == ch || edge) ? 255 : (0 == (x*7 + y*13 + ch) % 5 ? 128 : 0);
+		}
+	}
+	return glyphWidth;
+}
+
+//a frame of random bytes
+static void __AllocFrame(VC_FRAME_T *frame, std::vector<unsigned char>& mem, VC_FORMAT format, int width, int height, unsigned int *seed)
+{
+	mem.resize(VC_FrameSize(format, width, height));
+	for (size_t i=0; i<mem.size(); i++)		mem[i] = (unsigned char)__TestRand(seed);
+	VC_FillFrame(frame, format, width, height, &mem[0]);
+}
+
+static void TestBlend()
+{
+	int before = gTestFailures;
+	unsigned int seed = 5;
+	CVideoOsd osd;
+	TEST_CHECK(-1 == osd.SetText("x"));
+#ifndef _WIN32
+	TEST_CHECK(-1 == osd.Init(20));				//no GDI font to fall back on
+#endif
+	TEST_CHECK(-1 == osd.Init(2, __Glyph));
+	TEST_CHECK(0 == osd.Init(27, __Glyph));
+	TEST_CHECK(VOSD_LAST_CHAR - VOSD_FIRST_CHAR + 1 == gGlyphCalls);		//the atlas is built once
+	osd.SetColor(0x0000FFFF, 0x00151515, 180);
+	TEST_CHECK(1 == osd.SetText("[1920x1080] fps[25] Bitrate[4.00Mbps]"));
+	TEST_CHECK(0 == osd.SetText("[1920x1080] fps[25] Bitrate[4.00Mbps]"));
+	TEST_CHECK(28 == osd.GetHeight() && osd.GetWidth() > 37*16);
+
+	//inside, at the corners, clipped right and bottom, fully outside
+	static const int places[][4] = {{0,0,640,360}, {3,5,641,363}, {600,340,640,360}, {10,10,101,17}, {700,0,640,360}};
+	for (int avx2=1; avx2>=0; avx2--)
+	{
+		_VS_SetAvx2(avx2);
+		for (int f=0; f<OSDTEST_FORMATS; f++)
+		{
+			for (int p=0; p<(int)(sizeof(places)/sizeof(places[0])); p++)
+			{
+				VC_FRAME_T a, b;
+				std::vector<unsigned char> aMem, bMem;
+				__AllocFrame(&a, aMem, gFormats[f], places[p][2], places[p][3], &seed);
+				bMem = aMem;
+				VC_FillFrame(&b, gFormats[f], places[p][2], places[p][3], &bMem[0]);
+				TEST_CHECK(0 == osd.Blend(&a, places[p][0], places[p][1], 1));
+				TEST_CHECK(0 == osd.Blend(&b, places[p][0], places[p][1], 0));
+				TEST_CHECK(aMem == bMem);
+			}
+		}
+	}
+	_VS_SetAvx2(1);
+
+	VC_FRAME_T frame;
+	std::vector<unsigned char> mem;
+	__AllocFrame(&frame, mem, VC_FORMAT_RGB565, 64, 64, &seed);
+	TEST_CHECK(-1 == osd.Blend(&frame, 0, 0));
+	__TestResult("TestBlend", before);
+}
+
+//a solid glyph at full alpha is the text colour, zero alpha leaves the frame as it was
+static void TestColor()
+{
+	int before = gTestFailures;
+	unsigned int seed = 7;
+	CVideoOsd osd;
+	osd.Init(16, __Glyph);
+	osd.SetColor(0x00336699, 0x00000000, 255);
+	osd.SetText("##");
+
+	VC_FRAME_T frame;
+	std::vector<unsigned char> mem;
+	__AllocFrame(&frame, mem, VC_FORMAT_BGRA, 64, 32, &seed);
+	osd.Blend(&frame, 0, 0);
+	const unsigned char *px = frame.plane[0] + 5 * frame.stride[0] + 4*4;
+	TEST_CHECK(0x33 == px[0] && 0x66 == px[1] && 0x99 == px[2] && 255 == px[3]);
+
+	__AllocFrame(&frame, mem, VC_FORMAT_YUV420P, 64, 32, &seed);
+	osd.Blend(&frame, 0, 0);
+	TEST_CHECK(frame.plane[0][5 * frame.stride[0] + 4] == (int)(16.5 + (65.481*0x99 + 128.553*0x66 + 24.966*0x33) / 255));
+
+	osd.SetColor(0x00336699, 0, 0);
+	__AllocFrame(&frame, mem, VC_FORMAT_BGR24, 64, 32, &seed);
+	std::vector<unsigned char> copy = mem;
+	osd.Blend(&frame, 0, 0);
+	TEST_CHECK(copy == mem);
+	__TestResult("TestColor", before);
+}
+
+//the player's statistics line on a 1080p frame
+static void BenchOsd()
+{
+	unsigned int seed = 9;
+	int avx2 = _VS_UseAvx2();
+	char text[256];
+	sprintf(text, "[%dx%d] fps[%d] Bitrate[%.2fMbps]Cache[%d(%d+%d) / %d]  AverageTime: %.2f  Delay: %d  totaltime:%d / %d dropframe:%d",
+			1920, 1080, 25, 4.0, 3, 1, 2, 3, 12.5, 40, 52, 40, 0);
+	CVideoOsd osd;
+	osd.Init(1080/40, __Glyph);
+	osd.SetColor(0x0000FFFF, 0x00151515, 180);
+
+	unsigned long long start = _VS_GetNs();
+	for (int i=0; i<100; i++)
+	{
+		text[1] = (char)('0' + i % 10);
+		osd.SetText(text);
+	}
+	double rebuild = __TestSeconds(start) / 100;
+	start = _VS_GetNs();
+	for (int i=0; i<100000; i++)		osd.SetText(text);
+	double same = __TestSeconds(start) / 100000;
+	printf("text %d chars, overlay %dx%d: SetText rebuild %.3f ms, unchanged %.3f us\n", (int)strlen(text), osd.GetWidth(), osd.GetHeight(), rebuild * 1e3, same * 1e6);
+
+	printf("%-8s %12s %12s %12s %14s\n", "1080p", "scalar us", "base us", "AVX2 us", "first blend ms");
+	for (int f=0; f<OSDTEST_FORMATS; f++)
+	{
+		VC_FRAME_T frame;
+		std::vector<unsigned char> mem;
+		__AllocFrame(&frame, mem, gFormats[f], 1920, 1080, &seed);
+		osd.Blend(&frame, 2, 2);
+
+		double best[3] = {1e9, 1e9, 1e9};
+		for (int k=0; k<3; k++)
+		{
+			if (2 == k && !avx2)	break;
+			_VS_SetAvx2(2 == k);
+			for (int run=0; run<30; run++)
+			{
+				start = _VS_GetNs();
+				osd.Blend(&frame, 2, 2, k > 0);
+				double sec = __TestSeconds(start);
+				if (sec < best[k])		best[k] = sec;
+			}
+		}
+		_VS_SetAvx2(1);
+
+		//a colour change rebuilds the planes on the next blend
+		osd.SetColor(0x0000FFFE, 0x00151515, 180);
+		start = _VS_GetNs();
+		osd.Blend(&frame, 2, 2);
+		double first = __TestSeconds(start);
+		osd.SetColor(0x0000FFFF, 0x00151515, 180);
+
+		printf("%-8s %12.1f %12.1f", gFormatNames[f], best[0] * 1e6, best[1] * 1e6);
+		if (avx2)		printf(" %12.1f", best[2] * 1e6);
+		else			printf(" %12s", "-");
+		printf(" %14.2f\n", first * 1e3);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (__TestIsBench(argc, argv))
+	{
+		BenchOsd();
+		return 0;
+	}
+
+	TestBlend();
+	TestColor();
+	return gTestFailures;
+}
@@ -0,0 +1,823 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//CVideoPng, CVideoJpeg and CVideoSnapshot without a display or image libraries: PNGs are inflated
+//and unfiltered back to the exact pixels, JPEGs are entropy decoded and every block's DC checked
+//against the source colour; snapshot requests, bursts, file errors and cancels on a real pool
+#include "PlayerTest.h"
+#include "VideoSnapshot.h"
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+
+//canonical Huffman codes as counts per length and the symbols in code order, deflate and JPEG alike
+typedef struct __TEST_HUFF_T
+{
+	short	count[17];
+	short	symbol[288];
+}TEST_HUFF_T;
+
+typedef int (*TEST_BIT_FUNC)(void *reader);
+
+static int __HuffDecode(const TEST_HUFF_T *h, TEST_BIT_FUNC bit, void *reader)
+{
+	int code = 0, first = 0, index = 0;
+	for (int len=1; len<=16; len++)
+	{
+		code |= bit(reader);
+		int count = h->count[len];
+		if (code - first < count)		return h->symbol[index + code - first];
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+//deflate gives code lengths per symbol
+static void __HuffFromLengths(TEST_HUFF_T *h, const unsigned char *lengths, int n)
+{
+	memset(h->count, 0x00, sizeof(h->count));
+	for (int i=0; i<n; i++)		h->count[lengths[i]] ++;
+	h->count[0] = 0;
+	short offset[17];
+	offset[1] = 0;
+	for (int len=1; len<16; len++)		offset[len+1] = offset[len] + h->count[len];
+	for (int i=0; i<n; i++)
+	{
+		if (lengths[i] != 0)	h->symbol[offset[lengths[i]]++] = (short)i;
+	}
+}
+
+static unsigned int __Crc32(const unsigned char *p, int n)
+{
+	unsigned int crc = 0xFFFFFFFF;
+	for (int i=0; i<n; i++)
+	{
+		crc ^= p[i];
+		for (int k=0; k<8; k++)		crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+	}
+	return ~crc;
+}
+
+static unsigned int __Be32(const unsigned char *p)
+{
+	return ((unsigned int)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+//deflate bits, least significant first
+typedef struct __TEST_INFLATE_T
+{
+	const unsigned char	*p;
+	int					n;
+	int					pos;
+	int					bit;
+	int					overrun;
+}TEST_INFLATE_T;
+
+static int __InflateBit(void *reader)
+{
+	TEST_INFLATE_T *in = (TEST_INFLATE_T *)reader;
+	if (in->pos >= in->n)
+	{
+		in->overrun = 1;
+		return 0;
+	}
+	int b = (in->p[in->pos] >> in->bit) & 1;
+	if (++in->bit == 8)
+	{
+		in->bit = 0;
+		in->pos ++;
+	}
+	return b;
+}
+
+static int __InflateBits(TEST_INFLATE_T *in, int n)
+{
+	int v = 0;
+	for (int i=0; i<n; i++)		v |= __InflateBit(in) << i;
+	return v;
+}
+
+//a zlib stream of stored and fixed Huffman blocks, what CVideoPng writes; 0 when the Adler-32 matches
+static int __Inflate(const unsigned char *p, int n, std::vector<unsigned char>& out)
+{
+	static const short lenBase[29] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+	static const short lenExtra[29] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+	static const short distBase[30] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577};
+	static const short distExtra[30] = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+
+	if (n < 6 || (p[0] & 0x0F) != 8 || ((p[0] << 8) | p[1]) % 31 != 0)		return -1;
+	unsigned char lengths[288];
+	for (int i=0; i<288; i++)	lengths[i] = i < 144 ? 8 : (i < 256 ? 9 : (i < 280 ? 7 : 8));
+	TEST_HUFF_T litLen, dist;
+	__HuffFromLengths(&litLen, lengths, 288);
+	memset(lengths, 5, 30);
+	__HuffFromLengths(&dist, lengths, 30);
+
+	TEST_INFLATE_T in = {p, n - 4, 2, 0, 0};
+	out.clear();
+	int last = 0;
+	while (!last && !in.overrun)
+	{
+		last = __InflateBit(&in);
+		int type = __InflateBits(&in, 2);
+		if (0 == type)
+		{
+			if (in.bit != 0)	{in.bit = 0;	in.pos ++;}
+			if (in.pos + 4 > in.n)		return -1;
+			int len = in.p[in.pos] | (in.p[in.pos+1] << 8);
+			if ((len ^ 0xFFFF) != (in.p[in.pos+2] | (in.p[in.pos+3] << 8)) || in.pos + 4 + len > in.n)		return -1;
+			out.insert(out.end(), in.p + in.pos + 4, in.p + in.pos + 4 + len);
+			in.pos += 4 + len;
+			continue;
+		}
+		if (1 != type)		return -1;
+		for (;;)
+		{
+			int sym = __HuffDecode(&litLen, __InflateBit, &in);
+			if (sym < 0 || sym > 285 || in.overrun)		return -1;
+			if (sym < 256)
+			{
+				out.push_back((unsigned char)sym);
+				continue;
+			}
+			if (256 == sym)		break;
+			int len = lenBase[sym-257] + __InflateBits(&in, lenExtra[sym-257]);
+			int d = __HuffDecode(&dist, __InflateBit, &in);
+			if (d < 0 || d > 29)		return -1;
+			int distance = distBase[d] + __InflateBits(&in, distExtra[d]);
+			if (distance > (int)out.size())		return -1;
+			for (int i=0; i<len; i++)	out.push_back(out[out.size() - distance]);
+		}
+	}
+	if (in.overrun)		return -1;
+
+	unsigned int a = 1, b = 0;
+	for (size_t i=0; i<out.size(); i++)
+	{
+		a = (a + out[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	return __Be32(p + n - 4) == ((b << 16) | a) ? 0 : -1;
+}
+
+//a PNG from CVideoPng back to RGB bytes, every chunk CRC checked; 0 on success
+static int __DecodePng(const unsigned char *p, int n, int *width, int *height, std::vector<unsigned char>& rgb)
+{
+	static const unsigned char signature[8] = {0x89,'P','N','G',0x0D,0x0A,0x1A,0x0A};
+	if (n < 8 || 0 != memcmp(p, signature, 8))		return -1;
+	std::vector<unsigned char> idat;
+	int pos = 8, end = 0;
+	*width = *height = 0;
+	while (!end && pos + 12 <= n)
+	{
+		int len = (int)__Be32(p + pos);
+		if (len < 0 || pos + 12 + len > n)		return -1;
+		const unsigned char *type = p + pos + 4, *data = p + pos + 8;
+		if (__Crc32(type, len + 4) != __Be32(data + len))		return -1;
+		if (0 == memcmp(type, "IHDR", 4))
+		{
+			*width	=	(int)__Be32(data);
+			*height	=	(int)__Be32(data + 4);
+			if (13 != len || 8 != data[8] || 2 != data[9] || 0 != data[10] || 0 != data[11] || 0 != data[12])		return -1;
+		}
+		else if (0 == memcmp(type, "IDAT", 4))		idat.insert(idat.end(), data, data + len);
+		else if (0 == memcmp(type, "IEND", 4))		end = 1;
+		pos += 12 + len;
+	}
+	if (!end || pos != n || *width <= 0 || *height <= 0)		return -1;
+
+	std::vector<unsigned char> raw;
+	if (0 != __Inflate(&idat[0], (int)idat.size(), raw))		return -1;
+	int rowBytes = *width * 3;
+	if ((int)raw.size() != (rowBytes + 1) * *height)		return -1;
+	rgb.assign((size_t)rowBytes * *height, 0);
+	for (int y=0; y<*height; y++)
+	{
+		const unsigned char *src = &raw[(size_t)y * (rowBytes + 1)];
+		unsigned char *row = &rgb[(size_t)y * rowBytes];
+		const unsigned char *up = y > 0 ? row - rowBytes : NULL;
+		if (src[0] > 4)		return -1;
+		for (int x=0; x<rowBytes; x++)
+		{
+			int a = x >= 3 ? row[x-3] : 0, b = up ? up[x] : 0, c = (up && x >= 3) ? up[x-3] : 0, pred = 0;
+			switch (src[0])
+			{
+			case 1:		pred = a;					break;
+			case 2:		pred = b;					break;
+			case 3:		pred = (a + b) / 2;			break;
+			case 4:
+				{
+					int pa = abs(b - c), pb = abs(a - c), pc = abs(a + b - 2*c);
+					pred = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+				}
+				break;
+			}
+			row[x] = (unsigned char)(src[1+x] + pred);
+		}
+	}
+	return 0;
+}
+
+//JPEG entropy bits, most significant first, stuffed zero bytes dropped
+typedef struct __TEST_JPEG_T
+{
+	const unsigned char	*p;
+	int					n;
+	int					pos;
+	int					bit;
+	int					overrun;
+}TEST_JPEG_T;
+
+static int __JpegBit(void *reader)
+{
+	TEST_JPEG_T *in = (TEST_JPEG_T *)reader;
+	if (in->pos >= in->n || (0xFF == in->p[in->pos] && (in->pos + 1 >= in->n || 0x00 != in->p[in->pos+1])))
+	{
+		in->overrun = 1;
+		return 1;
+	}
+	int b = (in->p[in->pos] >> (7 - in->bit)) & 1;
+	if (++in->bit == 8)
+	{
+		in->bit = 0;
+		in->pos += (0xFF == in->p[in->pos]) ? 2 : 1;
+	}
+	return b;
+}
+
+static int __JpegValue(TEST_JPEG_T *in, int size)
+{
+	int v = 0;
+	for (int i=0; i<size; i++)		v = (v << 1) | __JpegBit(in);
+	return (size > 0 && v < (1 << (size-1))) ? v - (1 << size) + 1 : v;
+}
+
+//the mean of every 8x8 block from its DC, per component: Y in 2x2 per MCU, Cb and Cr one each
+typedef struct __TEST_JPEG_DC_T
+{
+	int					width;
+	int					height;
+	int					blocksX;			//luma blocks per row, chroma has half
+	int					blocksY;
+	std::vector<double>	mean[3];
+	int					acBlocks;			//blocks with any AC coefficient
+}TEST_JPEG_DC_T;
+
+//a 4:2:0 baseline JPEG from CVideoJpeg; 0 when it parses to EOI with every MCU in place
+static int __DecodeJpegDc(const unsigned char *p, int n, TEST_JPEG_DC_T *dc)
+{
+	int quant[4] = {0, 0, 0, 0}, compQuant[3] = {0, 0, 0}, compDc[3] = {0, 0, 0}, compAc[3] = {0, 0, 0};
+	TEST_HUFF_T huff[2][4];
+	if (n < 4 || 0xFF != p[0] || 0xD8 != p[1])		return -1;
+	int pos = 2;
+	dc->width = dc->height = 0;
+	for (;;)
+	{
+		if (pos + 4 > n || 0xFF != p[pos])		return -1;
+		int marker = p[pos+1], len = (p[pos+2] << 8) | p[pos+3];
+		const unsigned char *seg = p + pos + 4;
+		if (pos + 2 + len > n)		return -1;
+		if (0xDB == marker)
+		{
+			for (int i=0; i+65<=len-2; i+=65)		quant[seg[i] & 3] = seg[i+1];
+		}
+		else if (0xC0 == marker)
+		{
+			dc->height	=	(seg[1] << 8) | seg[2];
+			dc->width	=	(seg[3] << 8) | seg[4];
+			if (8 != seg[0] || 3 != seg[5] || 0x22 != seg[7] || 0x11 != seg[10] || 0x11 != seg[13])		return -1;
+			for (int c=0; c<3; c++)		compQuant[c] = seg[8 + c*3];
+		}
+		else if (0xC4 == marker)
+		{
+			for (int i=0; i<len-2; )
+			{
+				TEST_HUFF_T *h = &huff[seg[i] >> 4][seg[i] & 3];
+				int total = 0;
+				h->count[0] = 0;
+				for (int k=1; k<=16; k++)
+				{
+					h->count[k] = seg[i+k];
+					total += seg[i+k];
+				}
+				for (int k=0; k<total; k++)		h->symbol[k] = seg[i+17+k];
+				i += 17 + total;
+			}
+		}
+		else if (0xDA == marker)
+		{
+			for (int c=0; c<3; c++)
+			{
+				compDc[c] = seg[2 + c*2] >> 4;
+				compAc[c] = seg[2 + c*2] & 3;
+			}
+			pos += 2 + len;
+			break;
+		}
+		pos += 2 + len;
+	}
+	if (dc->width <= 0 || dc->height <= 0)		return -1;
+
+	int mcusX = (dc->width + 15) / 16, mcusY = (dc->height + 15) / 16;
+	dc->blocksX = mcusX * 2;
+	dc->blocksY = mcusY * 2;
+	dc->mean[0].assign((size_t)dc->blocksX * dc->blocksY, 0.0);
+	dc->mean[1].assign((size_t)mcusX * mcusY, 0.0);
+	dc->mean[2].assign((size_t)mcusX * mcusY, 0.0);
+	dc->acBlocks = 0;
+
+	TEST_JPEG_T in = {p, n, pos, 0, 0};
+	int pred[3] = {0, 0, 0};
+	for (int my=0; my<mcusY; my++)
+	{
+		for (int mx=0; mx<mcusX; mx++)
+		{
+			for (int b=0; b<6; b++)
+			{
+				int c = b < 4 ? 0 : b - 3;
+				int size = __HuffDecode(&huff[0][compDc[c]], __JpegBit, &in);
+				if (size < 0 || size > 11)		return -1;
+				pred[c] += __JpegValue(&in, size);
+				int ac = 0;
+				for (int k=1; k<64; k++)
+				{
+					int sym = __HuffDecode(&huff[1][compAc[c]], __JpegBit, &in);
+					if (sym < 0)		return -1;
+					if (0 == (sym & 0x0F))
+					{
+						if (0xF0 != sym)	break;		//EOB
+						k += 15;
+						continue;
+					}
+					k += sym >> 4;
+					__JpegValue(&in, sym & 0x0F);
+					ac = 1;
+				}
+				dc->acBlocks += ac;
+				double mean = pred[c] * quant[compQuant[c]] / 8.0 + 128.0;
+				if (0 == c)		dc->mean[0][(size_t)(my*2 + b/2) * dc->blocksX + mx*2 + (b&1)] = mean;
+				else			dc->mean[c][(size_t)my * mcusX + mx] = mean;
+			}
+			if (in.overrun)		return -1;
+		}
+	}
+	//the last byte padded with ones, then EOI
+	if (in.bit != 0)	in.pos ++;
+	return (in.pos + 2 == n && 0xFF == p[n-2] && 0xD9 == p[n-1]) ? 0 : -1;
+}
+
+//a frame in mem, rows padded so the encoders must honour the stride
+static void __AllocFrame(VC_FRAME_T *frame, std::vector<unsigned char>& mem, VC_FORMAT format, int width, int height, int pad)
+{
+	VC_FillFrame(frame, format, width, height, NULL);
+	int		rows[3] = {height, (height+1)/2, (height+1)/2};
+	size_t	offset[3] = {0, 0, 0}, total = 0;
+	for (int p=0; p<3; p++)
+	{
+		if (0 == frame->stride[p])		continue;
+		frame->stride[p] += pad;
+		offset[p] = total;
+		total += (size_t)frame->stride[p] * rows[p];
+	}
+	mem.assign(total, 0);
+	for (int p=0; p<3; p++)		frame->plane[p] = frame->stride[p] ? &mem[offset[p]] : NULL;
+}
+
+//YV12 keeps V in plane[1]
+static void __FillYuv(VC_FRAME_T *frame, int y, int u, int v)
+{
+	int iu = VC_FORMAT_YV12 == frame->format ? 2 : 1, cw = (frame->width + 1) / 2, ch = (frame->height + 1) / 2;
+	for (int r=0; r<frame->height; r++)		memset(frame->plane[0] + (size_t)r * frame->stride[0], y, frame->width);
+	for (int r=0; r<ch; r++)
+	{
+		memset(frame->plane[iu] + (size_t)r * frame->stride[iu], u, cw);
+		memset(frame->plane[3-iu] + (size_t)r * frame->stride[3-iu], v, cw);
+	}
+}
+
+static double __FullY(int y, VC_RANGE range)
+{
+	return VC_RANGE_FULL == range ? y : (y - 16) * 255.0 / 219.0;
+}
+
+static double __FullC(int c, VC_RANGE range)
+{
+	return VC_RANGE_FULL == range ? c : (c - 128) * 255.0 / 224.0 + 128.0;
+}
+
+//gradients, noise and flat squares, in BGR24 and BGRA, back to the same RGB
+static void TestPng()
+{
+	int before = gTestFailures;
+	unsigned int seed = 3;
+	static const int sizes[][2] = {{1,1}, {2,3}, {7,5}, {64,33}, {641,363}};
+	CVideoPng png;
+
+	for (int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++)
+	{
+		int width = sizes[s][0], height = sizes[s][1];
+		for (int pattern=0; pattern<3; pattern++)
+		{
+			for (int bgra=0; bgra<2; bgra++)
+			{
+				VC_FRAME_T frame;
+				std::vector<unsigned char> mem;
+				int bpp = bgra ? 4 : 3;
+				__AllocFrame(&frame, mem, bgra ? VC_FORMAT_BGRA : VC_FORMAT_BGR24, width, height, 5);
+				for (int y=0; y<height; y++)
+				{
+					for (int x=0; x<width; x++)
+					{
+						unsigned char *q = frame.plane[0] + (size_t)y * frame.stride[0] + x * bpp;
+						if (0 == pattern)
+						{
+							q[0] = (unsigned char)(x * 255 / width);
+							q[1] = (unsigned char)(y * 255 / height);
+							q[2] = (unsigned char)(x ^ y);
+						}
+						else if (1 == pattern)
+						{
+							for (int c=0; c<3; c++)		q[c] = (unsigned char)__TestRand(&seed);
+						}
+						else
+						{
+							q[0] = q[1] = q[2] = (unsigned char)(((x/16 + y/16) & 1) * 200);
+						}
+						if (bgra)	q[3] = 0x55;
+					}
+				}
+
+				int size = png.Encode(&frame);
+				TEST_CHECK(size > 0 && size == png.GetSize());
+				int w = 0, h = 0;
+				std::vector<unsigned char> rgb;
+				TEST_CHECK(0 == __DecodePng(png.GetData(), size, &w, &h, rgb));
+				TEST_CHECK(w == width && h == height);
+				int same = (w == width && h == height);
+				for (int y=0; y<height && same; y++)
+				{
+					for (int x=0; x<width; x++)
+					{
+						const unsigned char *q = frame.plane[0] + (size_t)y * frame.stride[0] + x * bpp;
+						const unsigned char *r = &rgb[((size_t)y * width + x) * 3];
+						if (r[0] != q[2] || r[1] != q[1] || r[2] != q[0])		same = 0;
+					}
+				}
+				TEST_CHECK(same);
+			}
+		}
+	}
+
+	VC_FRAME_T yuv;
+	std::vector<unsigned char> mem;
+	__AllocFrame(&yuv, mem, VC_FORMAT_YUV420P, 16, 16, 0);
+	TEST_CHECK(-1 == png.Encode(&yuv));
+	__TestResult("TestPng", before);
+}
+
+//flat colours in both ranges land on the full range value in every block, a gradient block by block
+static void TestJpeg()
+{
+	int before = gTestFailures;
+	static const int colors[][3] = {{16,128,128}, {235,128,128}, {81,90,240}, {145,54,34}, {41,240,110}, {128,128,128}};
+	static const int sizes[][2] = {{64,48}, {17,9}, {1,1}, {161,91}};
+	CVideoJpeg jpeg;
+	TEST_CHECK(0 == jpeg.Init());
+
+	for (int range=0; range<2; range++)
+	{
+		for (int c=0; c<(int)(sizeof(colors)/sizeof(colors[0])); c++)
+		{
+			for (int s=0; s<(int)(sizeof(sizes)/sizeof(sizes[0])); s++)
+			{
+				VC_FRAME_T frame;
+				std::vector<unsigned char> mem;
+				__AllocFrame(&frame, mem, (s & 1) ? VC_FORMAT_YV12 : VC_FORMAT_YUV420P, sizes[s][0], sizes[s][1], 3);
+				__FillYuv(&frame, colors[c][0], colors[c][1], colors[c][2]);
+				int size = jpeg.Encode(&frame, (VC_RANGE)range);
+				TEST_CHECK(size > 0 && size == jpeg.GetSize());
+
+				TEST_JPEG_DC_T dc;
+				TEST_CHECK(0 == __DecodeJpegDc(jpeg.GetData(), size, &dc));
+				TEST_CHECK(dc.width == sizes[s][0] && dc.height == sizes[s][1]);
+				TEST_CHECK(0 == dc.acBlocks);
+				double expect[3] = {__FullY(colors[c][0], (VC_RANGE)range), __FullC(colors[c][1], (VC_RANGE)range), __FullC(colors[c][2], (VC_RANGE)range)};
+				double worst = 0.0;
+				for (int k=0; k<3; k++)
+				{
+					for (size_t i=0; i<dc.mean[k].size(); i++)
+					{
+						double err = fabs(dc.mean[k][i] - expect[k]);
+						if (err > worst)	worst = err;
+					}
+				}
+				TEST_CHECK(worst <= 1.0);
+			}
+		}
+	}
+
+	//a smooth gradient: each whole block's mean against the source block's
+	VC_FRAME_T frame;
+	std::vector<unsigned char> mem;
+	__AllocFrame(&frame, mem, VC_FORMAT_YUV420P, 160, 96, 0);
+	for (int y=0; y<96; y++)
+	{
+		for (int x=0; x<160; x++)		frame.plane[0][y * frame.stride[0] + x] = (unsigned char)(16 + x + y/2);
+	}
+	for (int y=0; y<48; y++)
+	{
+		for (int x=0; x<80; x++)
+		{
+			frame.plane[1][y * frame.stride[1] + x] = (unsigned char)(40 + x + y);
+			frame.plane[2][y * frame.stride[2] + x] = (unsigned char)(200 - x);
+		}
+	}
+	int size = jpeg.Encode(&frame, VC_RANGE_LIMITED);
+	TEST_JPEG_DC_T dc;
+	TEST_CHECK(0 == __DecodeJpegDc(jpeg.GetData(), size, &dc));
+	double worst = 0.0;
+	for (int k=0; k<3; k++)
+	{
+		int bw = k ? 10 : 20, bh = k ? 6 : 12;
+		for (int by=0; by<bh; by++)
+		{
+			for (int bx=0; bx<bw; bx++)
+			{
+				double sum = 0.0;
+				for (int y=0; y<8; y++)
+				{
+					for (int x=0; x<8; x++)
+					{
+						int v = frame.plane[k][(by*8 + y) * frame.stride[k] + bx*8 + x];
+						sum += k ? __FullC(v, VC_RANGE_LIMITED) : __FullY(v, VC_RANGE_LIMITED);
+					}
+				}
+				double err = fabs(dc.mean[k][(size_t)by * (k ? dc.blocksX/2 : dc.blocksX) + bx] - sum / 64.0);
+				if (err > worst)	worst = err;
+			}
+		}
+	}
+	TEST_CHECK(worst <= 1.5);
+
+	VC_FRAME_T rgb;
+	__AllocFrame(&rgb, mem, VC_FORMAT_BGR24, 16, 16, 0);
+	TEST_CHECK(-1 == jpeg.Encode(&rgb, VC_RANGE_FULL));
+	__TestResult("TestJpeg", before);
+}
+
+//what the callbacks of one request saw
+typedef struct __TEST_SNAP_RESULT_T
+{
+	int							calls;
+	int							ok;
+	int							file;
+	int							cancelled;
+	int							lastIndex;
+	std::vector<unsigned char>	data;			//of the last frame with data
+}TEST_SNAP_RESULT_T;
+
+static pthread_mutex_t		gSnapLock = PTHREAD_MUTEX_INITIALIZER;
+static TEST_SNAP_RESULT_T	gSnap[64];
+static int					gSnapCalls = 0;
+
+static int __SnapCallback(int /*channelId*/, void * /*userPtr*/, int requestId, int index, int status, const unsigned char *pData, int size, const char * /*path*/)
+{
+	pthread_mutex_lock(&gSnapLock);
+	if (requestId > 0 && requestId < 64)
+	{
+		TEST_SNAP_RESULT_T *r = &gSnap[requestId];
+		r->calls ++;
+		r->lastIndex = index;
+		if (VSNAP_STATUS_OK == status)				r->ok ++;
+		else if (VSNAP_STATUS_FILE == status)		r->file ++;
+		else if (VSNAP_STATUS_CANCELLED == status)	r->cancelled ++;
+		if (NULL != pData && size > 0)		r->data.assign(pData, pData + size);
+	}
+	gSnapCalls ++;
+	pthread_mutex_unlock(&gSnapLock);
+	return 0;
+}
+
+static int __WaitSnapCalls(int calls)
+{
+	for (int i=0; i<500; i++)
+	{
+		pthread_mutex_lock(&gSnapLock);
+		int n = gSnapCalls;
+		pthread_mutex_unlock(&gSnapLock);
+		if (n >= calls)		return 1;
+		usleep(10000);
+	}
+	return 0;
+}
+
+static long __FileSize(const char *path)
+{
+	struct stat st;
+	return 0 == stat(path, &st) ? (long)st.st_size : -1;
+}
+
+//the decode thread is played by this one: Capture hands frames over, the pool encodes them
+static void TestSnapshot()
+{
+	int before = gTestFailures;
+	char dir[] = "/tmp/vsnaptestXXXXXX";
+	TEST_CHECK(NULL != mkdtemp(dir));
+	char jpgPath[128], pngPath[128], burstPath[128], badPath[128];
+	sprintf(jpgPath, "%s/a.jpg", dir);
+	sprintf(pngPath, "%s/b.png", dir);
+	sprintf(burstPath, "%s/c.jpg", dir);
+	sprintf(badPath, "%s/missing/x.jpg", dir);
+
+	CVideoSnapshot snapshot;
+	TEST_CHECK(-1 == snapshot.Request(0, 1000, jpgPath, VSNAP_FORMAT_JPEG, 1, 0, NULL, NULL));		//not running
+	TEST_CHECK(0 == snapshot.Init(2));
+	TEST_CHECK(-1 == snapshot.Request(0, 1000, NULL, VSNAP_FORMAT_JPEG, 1, 0, NULL, NULL));		//nowhere to go
+	TEST_CHECK(-1 == snapshot.Request(0, 1000, jpgPath, 7, 1, 0, NULL, NULL));
+	TEST_CHECK(-1 == snapshot.Request(0, 1000, jpgPath, VSNAP_FORMAT_JPEG, 0, 0, NULL, NULL));
+
+	VC_FRAME_T frame[2];
+	std::vector<unsigned char> mem[2];
+	__AllocFrame(&frame[0], mem[0], VC_FORMAT_YUV420P, 320, 180, 8);
+	__AllocFrame(&frame[1], mem[1], VC_FORMAT_YV12, 176, 144, 0);
+	__FillYuv(&frame[0], 81, 90, 240);
+	__FillYuv(&frame[1], 145, 54, 34);
+
+	int a = snapshot.Request(0, 1000, jpgPath, VSNAP_FORMAT_JPEG, 1, 0, __SnapCallback, NULL);
+	int b = snapshot.Request(1, 1001, pngPath, VSNAP_FORMAT_PNG, 1, 0, __SnapCallback, NULL);
+	int c = snapshot.Request(0, 1000, burstPath, VSNAP_FORMAT_JPEG, 3, 40, __SnapCallback, NULL);
+	int d = snapshot.Request(1, 1001, NULL, VSNAP_FORMAT_PNG, 1, 0, __SnapCallback, NULL);
+	int e = snapshot.Request(1, 1001, badPath, VSNAP_FORMAT_JPEG, 1, 0, __SnapCallback, NULL);
+	int f = snapshot.Request(0, 1000, NULL, VSNAP_FORMAT_JPEG, 100, 1000, __SnapCallback, NULL);
+	TEST_CHECK(a > 0 && b > a && c > b && d > c && e > d && f > e && f < 64);
+
+	//slot 1 serves b, d and e on one frame; slot 0 serves a, c and f, then c every 40 ms
+	unsigned int timeMs = 1000;
+	TEST_CHECK(3 == snapshot.Capture(1, &frame[1], VC_RANGE_LIMITED, timeMs));
+	TEST_CHECK(0 == snapshot.Capture(1, &frame[1], VC_RANGE_LIMITED, timeMs));
+	TEST_CHECK(__WaitSnapCalls(3));
+	TEST_CHECK(3 == snapshot.Capture(0, &frame[0], VC_RANGE_LIMITED, timeMs));
+	TEST_CHECK(0 == snapshot.Capture(0, &frame[0], VC_RANGE_LIMITED, timeMs + 20));
+	TEST_CHECK(1 == snapshot.Capture(0, &frame[0], VC_RANGE_LIMITED, timeMs + 40));
+	TEST_CHECK(1 == snapshot.Capture(0, &frame[0], VC_RANGE_LIMITED, timeMs + 80));
+	TEST_CHECK(0 == snapshot.Capture(0, &frame[0], VC_RANGE_LIMITED, timeMs + 120));
+	TEST_CHECK(__WaitSnapCalls(8));
+
+	//Deinit cancels what is still queued, so only once everything came back
+	snapshot.Cancel(0);				//f after one frame
+	TEST_CHECK(__WaitSnapCalls(9));
+	snapshot.Deinit();
+
+	TEST_CHECK(1 == gSnap[a].calls && 1 == gSnap[a].ok);
+	TEST_CHECK(1 == gSnap[b].calls && 1 == gSnap[b].ok);
+	TEST_CHECK(3 == gSnap[c].calls && 3 == gSnap[c].ok);		//two workers, in either order
+	TEST_CHECK(1 == gSnap[d].calls && 1 == gSnap[d].ok);
+	TEST_CHECK(1 == gSnap[e].calls && 1 == gSnap[e].file && !gSnap[e].data.empty());		//encoded, only the file failed
+	TEST_CHECK(2 == gSnap[f].calls && 1 == gSnap[f].ok && 1 == gSnap[f].cancelled && 1 == gSnap[f].lastIndex);
+	TEST_CHECK(__FileSize(jpgPath) == (long)gSnap[a].data.size());
+	TEST_CHECK(__FileSize(pngPath) == (long)gSnap[b].data.size());
+	char path[160];
+	for (int i=0; i<3; i++)
+	{
+		sprintf(path, "%s/c_%d.jpg", dir, i);
+		TEST_CHECK(__FileSize(path) > 0);
+		unlink(path);
+	}
+	sprintf(path, "%s/c_3.jpg", dir);
+	TEST_CHECK(__FileSize(path) < 0);
+
+	//the JPEG carries the frame's colour, the PNG is exactly the BT.601 conversion of the frame
+	TEST_JPEG_DC_T dc;
+	TEST_CHECK(!gSnap[a].data.empty() && 0 == __DecodeJpegDc(&gSnap[a].data[0], (int)gSnap[a].data.size(), &dc));
+	TEST_CHECK(320 == dc.width && 180 == dc.height && 0 == dc.acBlocks);
+	TEST_CHECK(!dc.mean[0].empty() && fabs(dc.mean[0][0] - __FullY(81, VC_RANGE_LIMITED)) <= 1.0);
+	TEST_CHECK(!dc.mean[1].empty() && fabs(dc.mean[1][0] - __FullC(90, VC_RANGE_LIMITED)) <= 1.0);
+	TEST_CHECK(!dc.mean[2].empty() && fabs(dc.mean[2][0] - __FullC(240, VC_RANGE_LIMITED)) <= 1.0);
+
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	VC_FRAME_T bgr;
+	std::vector<unsigned char> bgrMem;
+	__AllocFrame(&bgr, bgrMem, VC_FORMAT_BGR24, 176, 144, 0);
+	VC_ConvertRows(&frame[1], &bgr, &matrix, 0, 144);
+	for (int k=0; k<2; k++)
+	{
+		const std::vector<unsigned char>& data = k ? gSnap[d].data : gSnap[b].data;
+		int w = 0, h = 0;
+		std::vector<unsigned char> rgb;
+		TEST_CHECK(!data.empty() && 0 == __DecodePng(&data[0], (int)data.size(), &w, &h, rgb));
+		TEST_CHECK(176 == w && 144 == h);
+		int same = (176 == w && 144 == h);
+		for (int i=0; i<176*144 && same; i++)
+		{
+			if (rgb[i*3] != bgrMem[i*3+2] || rgb[i*3+1] != bgrMem[i*3+1] || rgb[i*3+2] != bgrMem[i*3])		same = 0;
+		}
+		TEST_CHECK(same);
+	}
+
+	//requests still open at Deinit are cancelled, not lost
+	TEST_CHECK(0 == snapshot.Init(1));
+	int g = snapshot.Request(2, 1002, NULL, VSNAP_FORMAT_JPEG, 1, 0, __SnapCallback, NULL);
+	TEST_CHECK(g > 0 && g < 64);
+	snapshot.Deinit();
+	TEST_CHECK(1 == gSnap[g].calls && 1 == gSnap[g].cancelled && 0 == gSnap[g].lastIndex);
+	TEST_CHECK(-1 == snapshot.Request(2, 1002, NULL, VSNAP_FORMAT_JPEG, 1, 0, __SnapCallback, NULL));
+
+	unlink(jpgPath);
+	unlink(pngPath);
+	rmdir(dir);
+	__TestResult("TestSnapshot", before);
+}
+
+//1080p: what the decode thread pays per Capture, what a worker pays per still
+static void BenchSnapshot()
+{
+	unsigned int seed = 7;
+	VC_FRAME_T frame;
+	std::vector<unsigned char> mem;
+	__AllocFrame(&frame, mem, VC_FORMAT_YUV420P, 1920, 1080, 0);
+	for (int y=0; y<1080; y++)
+	{
+		for (int x=0; x<1920; x++)		frame.plane[0][y * frame.stride[0] + x] = (unsigned char)(16 + (x + y) % 200 + (__TestRand(&seed) & 7));
+	}
+	for (int y=0; y<540; y++)
+	{
+		for (int x=0; x<960; x++)
+		{
+			frame.plane[1][y * frame.stride[1] + x] = (unsigned char)(100 + x % 40);
+			frame.plane[2][y * frame.stride[2] + x] = (unsigned char)(150 - y % 30);
+		}
+	}
+
+	CVideoJpeg jpeg;
+	jpeg.Init();
+	double best = 1e9;
+	int size = 0;
+	for (int run=0; run<10; run++)
+	{
+		unsigned long long start = _VS_GetNs();
+		size = jpeg.Encode(&frame, VC_RANGE_LIMITED);
+		double sec = __TestSeconds(start);
+		if (sec < best)		best = sec;
+	}
+	printf("1080p JPEG encode %7.2f ms, %d KB\n", best * 1e3, size / 1024);
+
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	VC_FRAME_T bgr;
+	std::vector<unsigned char> bgrMem;
+	__AllocFrame(&bgr, bgrMem, VC_FORMAT_BGR24, 1920, 1080, 0);
+	VC_ConvertRows(&frame, &bgr, &matrix, 0, 1080);
+	CVideoPng png;
+	best = 1e9;
+	for (int run=0; run<5; run++)
+	{
+		unsigned long long start = _VS_GetNs();
+		size = png.Encode(&bgr);
+		double sec = __TestSeconds(start);
+		if (sec < best)		best = sec;
+	}
+	printf("1080p PNG encode  %7.2f ms, %d KB\n", best * 1e3, size / 1024);
+
+	//Capture with nothing pending, then with a request due
+	CVideoSnapshot snapshot;
+	snapshot.Init(2);
+	unsigned long long start = _VS_GetNs();
+	for (int i=0; i<100000; i++)		snapshot.Capture(0, &frame, VC_RANGE_LIMITED, i);
+	double idle = __TestSeconds(start) / 100000;
+	double worst = 0.0, total = 0.0;
+	for (int i=0; i<20; i++)
+	{
+		snapshot.Request(0, 1000, NULL, VSNAP_FORMAT_JPEG, 1, 0, __SnapCallback, NULL);
+		start = _VS_GetNs();
+		snapshot.Capture(0, &frame, VC_RANGE_LIMITED, i);
+		double sec = __TestSeconds(start);
+		total += sec;
+		if (sec > worst)	worst = sec;
+		usleep(30000);
+	}
+	snapshot.Deinit();
+	printf("Capture on the decode thread: idle %.3f us, due avg %.2f ms worst %.2f ms\n", idle * 1e6, total / 20 * 1e3, worst * 1e3);
+}
+
+int main(int argc, char *argv[])
+{
+	if (__TestIsBench(argc, argv))
+	{
+		BenchSnapshot();
+		return 0;
+	}
+
+	TestPng();
+	TestJpeg();
+	TestSnapshot();
+	return gTestFailures;
+}
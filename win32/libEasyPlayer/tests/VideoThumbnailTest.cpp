@@ -0,0 +1,420 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//CVideoThumbnail on a real pool: pictures fit the box, the least recently read key is evicted,
+//every new picture bumps the sequence, a key still queued is replaced rather than queued twice,
+//full job slots answer 0, a restart reads the disk cache back, Init and Deinit race with Submit.
+//A FIFO at the worker's temporary cache file holds it mid job, so the queue can be filled.
+//The benchmark prints what the decode thread pays per Submit and what a worker pays per JPEG
+#include "PlayerTest.h"
+#include "VideoThumbnail.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+
+#define	THUMBTEST_WAIT_MS		5000
+#define	THUMBTEST_SUBMITTERS	4
+
+static void __MakeFrame(VC_FRAME_T *frame, std::vector<unsigned char>& mem, VC_FORMAT format, int width, int height, int level)
+{
+	mem.assign(VC_FrameSize(format, width, height), 0);
+	VC_FillFrame(frame, format, width, height, &mem[0]);
+	for (int y=0; y<height; y++)
+	{
+		for (int x=0; x<width; x++)		frame->plane[0][y * frame->stride[0] + x] = (unsigned char)(16 + (x + y + level) % 200);
+	}
+	for (int p=1; p<3; p++)
+	{
+		for (int y=0; y<(height+1)/2; y++)		memset(frame->plane[p] + y * frame->stride[p], 64 * p + level % 64, (width+1)/2);
+	}
+}
+
+//width and height from the SOF0 segment
+static int __JpegSize(const unsigned char *p, int size, int *width, int *height)
+{
+	for (int i=2; i+9<size && 0xFF == p[i]; i+=2+((p[i+2]<<8)|p[i+3]))
+	{
+		if (0xC0 == p[i+1])
+		{
+			*height	=	(p[i+5]<<8) | p[i+6];
+			*width	=	(p[i+7]<<8) | p[i+8];
+			return 0;
+		}
+	}
+	return -1;
+}
+
+//the picture of key newer than sequence after, its size or -1 on timeout
+static int __WaitPicture(CVideoThumbnail *thumb, const char *key, unsigned int after, unsigned int *pSequence, std::vector<unsigned char> *pJpeg)
+{
+	for (int i=0; i<THUMBTEST_WAIT_MS; i++)
+	{
+		unsigned int seq = 0;
+		int size = thumb->Get(key, NULL, 0, &seq);
+		if (size > 0 && seq != after)
+		{
+			if (NULL != pSequence)		*pSequence = seq;
+			if (NULL != pJpeg)
+			{
+				pJpeg->assign(size, 0);
+				thumb->Get(key, &(*pJpeg)[0], size, NULL);
+			}
+			return size;
+		}
+		usleep(1000);
+	}
+	return -1;
+}
+
+//where a worker writes the JPEG of key before renaming it, see CVideoThumbnail::CachePath
+static void __TempPath(const char *dir, const char *key, char *path)
+{
+	unsigned long long h = 14695981039346656037ULL;
+	for (; *key; key++)
+	{
+		h ^= (unsigned char)*key;
+		h *= 1099511628211ULL;
+	}
+	sprintf(path, "%s/%08x%08x.jpg.tmp", dir, (unsigned int)(h >> 32), (unsigned int)h);
+}
+
+static void TestCache()
+{
+	int before = gTestFailures;
+	VC_FRAME_T frame, small;
+	std::vector<unsigned char> mem, smallMem;
+	__MakeFrame(&frame, mem, VC_FORMAT_YUV420P, 1280, 720, 0);
+	__MakeFrame(&small, smallMem, VC_FORMAT_YV12, 64, 48, 9);
+
+	CVideoThumbnail thumb;
+	TEST_CHECK(-1 == thumb.Submit("a", &frame, VC_RANGE_LIMITED));			//not running
+	TEST_CHECK(-1 == thumb.Get("a", NULL, 0, NULL));
+	TEST_CHECK(-1 == thumb.Init(1, 144, 0, 2, NULL));
+	TEST_CHECK(-1 == thumb.Init(176, 144, 0, 0, NULL));
+	TEST_CHECK(0 == thumb.Init(176, 144, 0, 2, NULL, 2));
+	TEST_CHECK(thumb.IsRunning());
+
+	VC_FRAME_T bgr = frame;
+	bgr.format = VC_FORMAT_BGR24;
+	TEST_CHECK(-1 == thumb.Submit(NULL, &frame, VC_RANGE_LIMITED));
+	TEST_CHECK(-1 == thumb.Submit("", &frame, VC_RANGE_LIMITED));
+	TEST_CHECK(-1 == thumb.Submit("a", NULL, VC_RANGE_LIMITED));
+	TEST_CHECK(-1 == thumb.Submit("a", &bgr, VC_RANGE_LIMITED));
+	TEST_CHECK(-1 == thumb.Get("", NULL, 0, NULL));
+
+	//fits 176x144 keeping 16:9, even sizes; a smaller one is not enlarged
+	unsigned int seqA = 0, seqB = 0, seqC = 0;
+	std::vector<unsigned char> jpeg;
+	int width = 0, height = 0;
+	TEST_CHECK(1 == thumb.Submit("a", &frame, VC_RANGE_LIMITED));
+	int size = __WaitPicture(&thumb, "a", 0, &seqA, &jpeg);
+	TEST_CHECK(size > 0 && 0 == __JpegSize(&jpeg[0], size, &width, &height));
+	TEST_CHECK(176 == width && 98 == height);
+	TEST_CHECK(1 == thumb.Submit("b", &small, VC_RANGE_LIMITED));
+	size = __WaitPicture(&thumb, "b", 0, &seqB, &jpeg);
+	TEST_CHECK(size > 0 && 0 == __JpegSize(&jpeg[0], size, &width, &height));
+	TEST_CHECK(64 == width && 48 == height);
+
+	//too small a buffer: the size only, nothing copied
+	unsigned char tiny[16];
+	memset(tiny, 0x5A, sizeof(tiny));
+	TEST_CHECK(size == thumb.Get("b", tiny, sizeof(tiny), NULL));
+	TEST_CHECK(0x5A == tiny[0] && 0x5A == tiny[15]);
+
+	//every new picture of a key gets a sequence above everything before it
+	unsigned int seq = 0;
+	TEST_CHECK(seqB != seqA && (int)(seqB - seqA) > 0);
+	TEST_CHECK(1 == thumb.Submit("a", &frame, VC_RANGE_LIMITED));
+	TEST_CHECK(__WaitPicture(&thumb, "a", seqA, &seq, NULL) > 0);
+	TEST_CHECK((int)(seq - seqB) > 0);
+	seqA = seq;
+
+	//two entries: reading a makes b the least recently used, c takes its place
+	TEST_CHECK(thumb.Get("a", NULL, 0, NULL) > 0);
+	TEST_CHECK(1 == thumb.Submit("c", &small, VC_RANGE_LIMITED));
+	TEST_CHECK(__WaitPicture(&thumb, "c", 0, &seqC, NULL) > 0);
+	TEST_CHECK(-1 == thumb.Get("b", NULL, 0, NULL));
+	TEST_CHECK(thumb.Get("a", NULL, 0, &seq) > 0 && seq == seqA);
+	TEST_CHECK(thumb.Get("c", NULL, 0, NULL) > 0);
+
+	thumb.Deinit();
+	TEST_CHECK(!thumb.IsRunning());
+	TEST_CHECK(-1 == thumb.Get("a", NULL, 0, NULL));
+	TEST_CHECK(-1 == thumb.Submit("a", &frame, VC_RANGE_LIMITED));
+	__TestResult("TestCache", before);
+}
+
+static void TestQueue()
+{
+	int before = gTestFailures;
+	char dir[] = "/tmp/vthumbtestXXXXXX";
+	TEST_CHECK(NULL != mkdtemp(dir));
+	char fifo[128];
+	__TempPath(dir, "block", fifo);
+
+	VC_FRAME_T frame, older, newer;
+	std::vector<unsigned char> mem, olderMem, newerMem;
+	__MakeFrame(&frame, mem, VC_FORMAT_YUV420P, 320, 240, 0);
+	__MakeFrame(&older, olderMem, VC_FORMAT_YUV420P, 64, 48, 1);
+	__MakeFrame(&newer, newerMem, VC_FORMAT_YUV420P, 96, 48, 2);
+
+	//one worker, stuck opening the FIFO until this thread reads it
+	CVideoThumbnail thumb;
+	TEST_CHECK(0 == thumb.Init(176, 144, 0, 16, dir, 1));
+	TEST_CHECK(0 == mkfifo(fifo, 0644));
+	TEST_CHECK(1 == thumb.Submit("block", &frame, VC_RANGE_LIMITED));
+
+	//b queued twice takes one slot, so six more keys fill the rest and the next finds none
+	TEST_CHECK(1 == thumb.Submit("b", &older, VC_RANGE_LIMITED));
+	TEST_CHECK(1 == thumb.Submit("b", &newer, VC_RANGE_LIMITED));
+	char key[VTHUMB_MAX_JOBS][16];
+	for (int i=0; i<VTHUMB_MAX_JOBS-2; i++)
+	{
+		sprintf(key[i], "k%d", i);
+		TEST_CHECK(1 == thumb.Submit(key[i], &frame, VC_RANGE_LIMITED));
+	}
+	TEST_CHECK(0 == thumb.Submit("full", &frame, VC_RANGE_LIMITED));
+	TEST_CHECK(0 == thumb.Submit("full", &frame, VC_RANGE_LIMITED));
+
+	//let the worker go: what it wrote is what it keeps
+	std::vector<unsigned char> written;
+	FILE *f = fopen(fifo, "rb");
+	TEST_CHECK(NULL != f);
+	if (NULL != f)
+	{
+		int c;
+		while (EOF != (c = fgetc(f)))		written.push_back((unsigned char)c);
+		fclose(f);
+	}
+
+	//oldest first: block, b, then k0..k5 in order
+	std::vector<unsigned char> jpeg;
+	unsigned int seqBlock = 0, seq = 0, last = 0;
+	TEST_CHECK(__WaitPicture(&thumb, "block", 0, &seqBlock, &jpeg) > 0);
+	TEST_CHECK(!written.empty() && jpeg == written);
+	int width = 0, height = 0;
+	int size = __WaitPicture(&thumb, "b", 0, &last, &jpeg);
+	TEST_CHECK(size > 0 && 0 == __JpegSize(&jpeg[0], size, &width, &height));
+	TEST_CHECK(96 == width && 48 == height);					//the newer frame, encoded once
+	TEST_CHECK((int)(last - seqBlock) == 1);
+	for (int i=0; i<VTHUMB_MAX_JOBS-2; i++)
+	{
+		TEST_CHECK(__WaitPicture(&thumb, key[i], 0, &seq, NULL) > 0);
+		TEST_CHECK((int)(seq - last) == 1);
+		last = seq;
+	}
+	TEST_CHECK(-1 == thumb.Get("full", NULL, 0, NULL));		//dropped, not queued later
+	TEST_CHECK(1 == thumb.Submit("full", &frame, VC_RANGE_LIMITED));
+	TEST_CHECK(__WaitPicture(&thumb, "full", 0, NULL, NULL) > 0);
+	thumb.Deinit();
+
+	char command[160];							//the FIFO too, renamed into place
+	sprintf(command, "rm -f %s/*.jpg", dir);
+	TEST_CHECK(0 == system(command));
+	TEST_CHECK(0 == rmdir(dir));
+	__TestResult("TestQueue", before);
+}
+
+static void TestRestart()
+{
+	int before = gTestFailures;
+	char dir[] = "/tmp/vthumbtestXXXXXX";
+	TEST_CHECK(NULL != mkdtemp(dir));
+	VC_FRAME_T frame;
+	std::vector<unsigned char> mem;
+	__MakeFrame(&frame, mem, VC_FORMAT_YUV420P, 640, 360, 3);
+
+	std::vector<unsigned char> first, again;
+	unsigned int seq = 0;
+	{
+		CVideoThumbnail thumb;
+		TEST_CHECK(0 == thumb.Init(176, 144, 0, 4, dir, 2));
+		TEST_CHECK(1 == thumb.Submit("rtsp://cam/1", &frame, VC_RANGE_LIMITED));
+		TEST_CHECK(__WaitPicture(&thumb, "rtsp://cam/1", 0, NULL, &first) > 0);
+	}
+
+	//a new process: nothing in memory, the file written by the last one is read back once
+	CVideoThumbnail thumb;
+	TEST_CHECK(0 == thumb.Init(176, 144, 0, 4, dir, 1));
+	int size = thumb.Get("rtsp://cam/1", NULL, 0, &seq);
+	TEST_CHECK(size > 0 && size == (int)first.size());
+	again.assign(size > 0 ? size : 1, 0);
+	TEST_CHECK(size == thumb.Get("rtsp://cam/1", &again[0], size, NULL));
+	TEST_CHECK(again == first);
+	TEST_CHECK(-1 == thumb.Get("rtsp://cam/2", NULL, 0, NULL));
+
+	//a new picture replaces it, on disk too
+	unsigned int newer = 0;
+	__MakeFrame(&frame, mem, VC_FORMAT_YUV420P, 320, 320, 5);
+	TEST_CHECK(1 == thumb.Submit("rtsp://cam/1", &frame, VC_RANGE_LIMITED));
+	TEST_CHECK(__WaitPicture(&thumb, "rtsp://cam/1", seq, &newer, &first) > 0);
+	thumb.Deinit();
+	TEST_CHECK(0 == thumb.Init(176, 144, 0, 4, dir, 1));
+	size = thumb.Get("rtsp://cam/1", NULL, 0, NULL);
+	TEST_CHECK(size == (int)first.size());
+	thumb.Deinit();
+
+	//no cache directory, nothing survives
+	TEST_CHECK(0 == thumb.Init(176, 144, 0, 4, NULL, 1));
+	TEST_CHECK(-1 == thumb.Get("rtsp://cam/1", NULL, 0, NULL));
+	thumb.Deinit();
+
+	char command[160];
+	sprintf(command, "rm -f %s/*.jpg", dir);
+	TEST_CHECK(0 == system(command));
+	TEST_CHECK(0 == rmdir(dir));
+	__TestResult("TestRestart", before);
+}
+
+typedef struct __THUMB_SUBMITTER_T
+{
+	CVideoThumbnail		*thumb;
+	const VC_FRAME_T	*frame;
+	volatile int		*stop;
+	int					result[3];		//-1, 0, 1
+	int					other;
+}THUMB_SUBMITTER_T;
+
+static void *__SubmitThread(void *lpParam)
+{
+	THUMB_SUBMITTER_T *s = (THUMB_SUBMITTER_T *)lpParam;
+	unsigned int seed = (unsigned int)(size_t)s;
+	char key[16];
+	while (!*s->stop)
+	{
+		sprintf(key, "s%u", __TestRand(&seed) % 24);
+		int ret = s->thumb->Submit(key, s->frame, VC_RANGE_LIMITED);
+		if (ret >= -1 && ret <= 1)	s->result[ret + 1] ++;
+		else						s->other ++;
+	}
+	return NULL;
+}
+
+//the decode threads keep submitting while the pool is started and stopped under them
+static void TestInitRace()
+{
+	int before = gTestFailures;
+	VC_FRAME_T frame;
+	std::vector<unsigned char> mem;
+	__MakeFrame(&frame, mem, VC_FORMAT_YUV420P, 352, 288, 4);
+
+	CVideoThumbnail thumb;
+	volatile int stop = 0;
+	THUMB_SUBMITTER_T submitter[THUMBTEST_SUBMITTERS];
+	pthread_t thread[THUMBTEST_SUBMITTERS];
+	for (int i=0; i<THUMBTEST_SUBMITTERS; i++)
+	{
+		memset(&submitter[i], 0x00, sizeof(submitter[i]));
+		submitter[i].thumb	=	&thumb;
+		submitter[i].frame	=	&frame;
+		submitter[i].stop	=	&stop;
+		TEST_CHECK(0 == pthread_create(&thread[i], NULL, __SubmitThread, &submitter[i]));
+	}
+
+	unsigned int seed = 11;
+	int inits = 0;
+	for (int i=0; i<200; i++)
+	{
+		if (0 == thumb.Init(176 - (i % 3) * 32, 144, 0, 1 + i % 8, NULL, 1 + i % VTHUMB_MAX_WORKERS))	inits ++;
+		usleep(__TestRand(&seed) % 2000);
+		if (i % 2)		thumb.Deinit();			//otherwise Init stops it first
+	}
+	TEST_CHECK(200 == inits);
+	thumb.Deinit();
+	stop = 1;				//after the stop, so every thread also finds it stopped
+
+	int queued = 0, stopped = 0, other = 0;
+	for (int i=0; i<THUMBTEST_SUBMITTERS; i++)
+	{
+		pthread_join(thread[i], NULL);
+		stopped	+=	submitter[i].result[0];
+		queued	+=	submitter[i].result[2];
+		other	+=	submitter[i].other;
+	}
+	TEST_CHECK(0 == other);
+	TEST_CHECK(queued > 0 && stopped > 0);
+	TEST_CHECK(-1 == thumb.Submit("last", &frame, VC_RANGE_LIMITED));
+	__TestResult("TestInitRace", before);
+}
+
+//1080p: what Submit costs the decode thread, what a worker pays per JPEG, pictures per second
+static void BenchThumbnail()
+{
+	VC_FRAME_T frame;
+	std::vector<unsigned char> mem;
+	__MakeFrame(&frame, mem, VC_FORMAT_YUV420P, 1920, 1080, 0);
+
+	CVideoThumbnail thumb;
+	thumb.Init(VTHUMB_DEFAULT_WIDTH, VTHUMB_DEFAULT_HEIGHT, 0, 64, NULL, 1);
+	double best = 1e9, total = 0.0;
+	for (int i=0; i<200; i++)
+	{
+		unsigned long long start = _VS_GetNs();
+		thumb.Submit("bench", &frame, VC_RANGE_LIMITED);		//one key: replaces what is still queued
+		double sec = __TestSeconds(start);
+		total += sec;
+		if (sec < best)		best = sec;
+	}
+	thumb.Deinit();
+	printf("1080p Submit (scale to %dx%d) %7.3f ms best, %7.3f ms avg\n", VTHUMB_DEFAULT_WIDTH, VTHUMB_DEFAULT_HEIGHT, best * 1e3, total / 200 * 1e3);
+
+	VC_FRAME_T scaled;
+	std::vector<unsigned char> scaledMem;
+	__MakeFrame(&scaled, scaledMem, VC_FORMAT_YUV420P, VTHUMB_DEFAULT_WIDTH, 98, 0);
+	VC_MATRIX_T matrix;
+	VC_InitMatrix(&matrix, VC_COLORSPACE_BT601, VC_RANGE_LIMITED);
+	VC_ScaleRows(&frame, &scaled, &matrix, VC_FILTER_AREA, 0, scaled.height);
+	CVideoJpeg jpeg;
+	jpeg.Init();
+	best = 1e9;
+	int size = 0;
+	for (int i=0; i<200; i++)
+	{
+		unsigned long long start = _VS_GetNs();
+		size = jpeg.Encode(&scaled, VC_RANGE_LIMITED);
+		double sec = __TestSeconds(start);
+		if (sec < best)		best = sec;
+	}
+	printf("%dx%d JPEG encode            %7.3f ms, %d bytes\n", scaled.width, scaled.height, best * 1e3, size);
+
+	//64 streams handing over a key frame each, until all have a picture
+	for (int workers=1; workers<=VTHUMB_MAX_WORKERS; workers*=2)
+	{
+		thumb.Init(VTHUMB_DEFAULT_WIDTH, VTHUMB_DEFAULT_HEIGHT, 0, 64, NULL, workers);
+		char key[16];
+		unsigned long long start = _VS_GetNs();
+		for (int i=0; i<64; i++)
+		{
+			sprintf(key, "cam%d", i);
+			while (0 == thumb.Submit(key, &frame, VC_RANGE_LIMITED))		usleep(100);
+		}
+		for (int i=0; i<64; i++)
+		{
+			sprintf(key, "cam%d", i);
+			__WaitPicture(&thumb, key, 0, NULL, NULL);
+		}
+		double sec = __TestSeconds(start);
+		thumb.Deinit();
+		printf("64 streams from one thread, %d worker(s): %7.1f thumbnails/s\n", workers, 64 / sec);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (__TestIsBench(argc, argv))
+	{
+		BenchThumbnail();
+		return 0;
+	}
+
+	TestCache();
+	TestQueue();
+	TestRestart();
+	TestInitRace();
+	return gTestFailures;
+}
@@ -0,0 +1,178 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//_VS_PacerDeadline and _VS_SleepUntilNs: the deadline arithmetic on PTS, without PTS and across
+//discontinuities, then how late the display loop really wakes at 25/30/50/60 fps with 1-6 ms of
+//rendering per frame, and how far it drifts; the benchmark runs longer and against the old loop
+#include "PlayerTest.h"
+#include <algorithm>
+#include <vector>
+
+//keeps the core busy like a render would
+static void __Work(int us)
+{
+	unsigned long long end = _VS_GetNs() + (unsigned long long)us * 1000ULL;
+	while (_VS_GetNs() < end)		;
+}
+
+static void TestDeadlines()
+{
+	int before = gTestFailures;
+	VS_PACER_T pacer;
+	_VS_PacerReset(&pacer);
+
+	//on PTS every deadline is anchor + PTS distance, however late the caller is
+	unsigned long long a = _VS_PacerDeadline(&pacer, 5000000, 25);
+	unsigned long long b = _VS_PacerDeadline(&pacer, 5040000, 25);
+	__Work(3000);
+	unsigned long long c = _VS_PacerDeadline(&pacer, 5080000, 25);
+	unsigned long long d = _VS_PacerDeadline(&pacer, 5120001, 25);
+	TEST_CHECK(40000000ULL == b - a && 80000000ULL == c - a && 120001000ULL == d - a);
+
+	//no PTS: one period after the last deadline
+	unsigned long long e = _VS_PacerDeadline(&pacer, 0, 25);
+	unsigned long long f = _VS_PacerDeadline(&pacer, 0, 50);
+	TEST_CHECK(40000000ULL == e - d && 20000000ULL == f - e);
+	TEST_CHECK(33333333ULL == _VS_PacerDeadline(&pacer, 0, 0) - f);		//30 fps when unknown
+
+	//backwards and far ahead are new time lines, one frame on; the next frame follows it
+	_VS_PacerReset(&pacer);
+	a = _VS_PacerDeadline(&pacer, 5000000, 25);
+	b = _VS_PacerDeadline(&pacer, 1000, 25);
+	c = _VS_PacerDeadline(&pacer, 41000, 25);
+	d = _VS_PacerDeadline(&pacer, 41000 + VS_PACER_MAX_JUMP_US + 1, 25);
+	TEST_CHECK(40000000ULL == b - a && 40000000ULL == c - b && 40000000ULL == d - c);
+
+	//a deadline further than VS_PACER_MAX_SKEW_NS from now starts again at now
+	_VS_PacerReset(&pacer);
+	_VS_PacerDeadline(&pacer, 1000000, 25);
+	unsigned long long now = _VS_GetNs();
+	_VS_PacerShift(&pacer, -(VS_PACER_MAX_SKEW_NS + 500000000LL));
+	e = _VS_PacerDeadline(&pacer, 1040000, 25);
+	TEST_CHECK(e >= now && e - now < 100000000ULL);
+	_VS_PacerShift(&pacer, 10000000);
+	TEST_CHECK(50000000ULL == _VS_PacerDeadline(&pacer, 1080000, 25) - e);
+
+	//how late a sleep returns: never early
+	for (int i=0; i<20; i++)
+	{
+		unsigned long long deadline = _VS_GetNs() + 1000000ULL + i * 100000ULL;
+		long long late = _VS_SleepUntilNs(deadline, i & 1 ? VS_SPIN_NS : 0);
+		TEST_CHECK(late >= 0 && _VS_GetNs() >= deadline);
+	}
+	TEST_CHECK(_VS_SleepUntilNs(_VS_GetNs() - 1000) >= 1000);
+
+	_VS_BEGIN_TIME_PERIOD(1);
+	_VS_END_TIME_PERIOD(1);
+	__TestResult("TestDeadlines", before);
+}
+
+typedef struct __PACE_RESULT_T
+{
+	double	p50;			//wakeup error, us
+	double	p90;
+	double	p99;
+	double	max;
+	double	within;			//share of wakeups less than 0.5 ms late
+	double	driftMs;		//last frame against where the frame rate puts it
+}PACE_RESULT_T;
+
+//the display loop: deadline from the frame's PTS, sleep to it, render
+static void __Pace(int fps, int frames, unsigned int *seed, PACE_RESULT_T *result)
+{
+	VS_PACER_T pacer;
+	_VS_PacerReset(&pacer);
+	std::vector<double> late;
+	unsigned long long first = 0, last = 0;
+	for (int i=0; i<frames; i++)
+	{
+		unsigned long long pts = 123456789ULL + (unsigned long long)i * 1000000ULL / fps;
+		long long ns = _VS_SleepUntilNs(_VS_PacerDeadline(&pacer, pts, fps));
+		last = _VS_GetNs();
+		if (0 == i)		first = last;
+		else			late.push_back(ns / 1000.0);
+		__Work(1000 + __TestRand(seed) % 5000);
+	}
+	std::sort(late.begin(), late.end());
+	result->p50		=	late[late.size() / 2];
+	result->p90		=	late[late.size() * 9 / 10];
+	result->p99		=	late[late.size() * 99 / 100];
+	result->max		=	late.back();
+	result->within	=	(double)(std::lower_bound(late.begin(), late.end(), 500.0) - late.begin()) / late.size();
+	result->driftMs	=	((double)(last - first) / 1e9 - (double)(frames - 1) / fps) * 1e3;
+}
+
+static void __PrintPace(const char *name, int fps, int frames, const PACE_RESULT_T *result)
+{
+	printf("  %s %2d fps, %4d frames: late us p50 %6.1f p90 %6.1f p99 %7.1f max %7.1f, %5.1f%% within 0.5 ms, drift %+.2f ms\n",
+		   name, fps, frames, result->p50, result->p90, result->p99, result->max, result->within * 100.0, result->driftMs);
+}
+
+//one second per rate; loose bounds, a shared CI machine preempts now and then, but the time line
+//must hold: PTS deadlines do not drift whatever a single wakeup did
+static void TestPace()
+{
+	int before = gTestFailures;
+	unsigned int seed = 3;
+	static const int rates[] = {25, 30, 50, 60};
+	for (int r=0; r<(int)(sizeof(rates)/sizeof(rates[0])); r++)
+	{
+		PACE_RESULT_T result;
+		__Pace(rates[r], rates[r], &seed, &result);
+		__PrintPace("pacer", rates[r], rates[r], &result);
+		TEST_CHECK(result.p50 < 500.0);
+		TEST_CHECK(result.p90 < 2000.0);
+		TEST_CHECK(result.driftMs > -1.0 && result.driftMs < 1000.0 / rates[r]);
+	}
+	__TestResult("TestPace", before);
+}
+
+//the loop the display thread had: render, then sleep whole ms for what is left of 1000/fps
+static double __LegacyDrift(int fps, int frames, unsigned int *seed)
+{
+	unsigned long long first = 0, last = 0;
+	int period = 1000 / fps;
+	for (int i=0; i<frames; i++)
+	{
+		if (i > 0)
+		{
+			int interval = (int)((_VS_GetNs() - last) / 1000000ULL);
+			if (period - interval > 0)		__VS_Delay(period - interval);
+		}
+		last = _VS_GetNs();
+		if (0 == i)		first = last;
+		__Work(1000 + __TestRand(seed) % 5000);
+	}
+	return ((double)(last - first) / 1e9 - (double)(frames - 1) / fps) * 1e3;
+}
+
+static void BenchPace()
+{
+	unsigned int seed = 5;
+	static const int rates[] = {25, 30, 50, 60};
+	for (int r=0; r<(int)(sizeof(rates)/sizeof(rates[0])); r++)
+	{
+		int frames = rates[r] * 4;
+		PACE_RESULT_T result;
+		__Pace(rates[r], frames, &seed, &result);
+		__PrintPace("pacer ", rates[r], frames, &result);
+		printf("  legacy %2d fps, %4d frames: drift %+.2f ms\n", rates[r], frames, __LegacyDrift(rates[r], frames, &seed));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (__TestIsBench(argc, argv))
+	{
+		BenchPace();
+		return 0;
+	}
+
+	TestDeadlines();
+	TestPace();
+	return gTestFailures;
+}
@@ -0,0 +1,264 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//_VS_TraceStart/_VS_TRACE: the file read back, every event either recorded in order or counted as
+//dropped, with more threads than rings and a ring overflowing; tools/vstracedump run on it as
+//text and JSON. The benchmark prints what an event costs off, on, and on many threads at once
+#include "PlayerTest.h"
+#include "vstrace.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#define	TRACETEST_THREADS		70				//more than VSTRACE_MAX_THREADS
+#define	TRACETEST_EVENTS		200				//per thread
+
+static char	gDumpPath[512] = "vstracedump";
+
+//what the file holds: records per thread in file order, drops noted in the blocks
+typedef struct __TRACE_FILE_T
+{
+	VSTRACE_FILE_HEADER_T							header;
+	unsigned int									events;			//descriptions
+	std::map<unsigned int, std::vector<VSTRACE_RECORD_T> >	records;
+	unsigned int									recorded;
+	unsigned int									dropped;		//ring full
+	unsigned int									lost;			//no ring, thread 0 blocks
+	unsigned int									dropBlocks;		//blocks with a drop count, a dump entry each
+}TRACE_FILE_T;
+
+static int __ReadTrace(const char *path, TRACE_FILE_T *trace)
+{
+	FILE *f = fopen(path, "rb");
+	if (NULL == f)		return -1;
+	trace->recorded = trace->dropped = trace->lost = trace->dropBlocks = 0;
+	trace->records.clear();
+
+	int ok = (1 == fread(&trace->header, sizeof(trace->header), 1, f));
+	trace->events = ok ? trace->header.events : 0;
+	for (unsigned int i=0; ok && i<trace->events; i++)
+	{
+		VSTRACE_EVENT_DESC_T desc;
+		ok = (1 == fread(&desc, sizeof(desc), 1, f)) && desc.id == i + 1;
+	}
+	VSTRACE_BLOCK_T block;
+	while (ok && 1 == fread(&block, sizeof(block), 1, f))
+	{
+		if (VSTRACE_BLOCK_MAGIC != block.magic)
+		{
+			ok = 0;
+			break;
+		}
+		std::vector<VSTRACE_RECORD_T>& records = trace->records[block.threadId];
+		for (unsigned int i=0; ok && i<block.count; i++)
+		{
+			VSTRACE_RECORD_T record;
+			ok = (1 == fread(&record, sizeof(record), 1, f));
+			records.push_back(record);
+		}
+		trace->recorded += block.count;
+		if (0 == block.threadId)	trace->lost += block.dropped;
+		else						trace->dropped += block.dropped;
+		if (block.dropped > 0)		trace->dropBlocks ++;
+	}
+	fclose(f);
+	return ok ? 0 : -1;
+}
+
+typedef struct __TRACE_WORKER_T
+{
+	int					tag;
+	pthread_barrier_t	*barrier;
+}TRACE_WORKER_T;
+
+//every thread's events are its tag and a sequence number, so order and loss can be told apart
+static void *__TraceThread(void *lpParam)
+{
+	TRACE_WORKER_T *worker = (TRACE_WORKER_T *)lpParam;
+	for (int i=0; i<TRACETEST_EVENTS; i++)		_VS_TRACE(VSTRACE_EV_DECODE, worker->tag, 1000, i, 1);
+	pthread_barrier_wait(worker->barrier);		//all alive at once, so some find no ring
+	return NULL;
+}
+
+static int __CountLines(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (NULL == f)		return -1;
+	int lines = 0, c;
+	while (EOF != (c = fgetc(f)))
+	{
+		if ('\n' == c)		lines ++;
+	}
+	fclose(f);
+	return lines;
+}
+
+static void TestTrace()
+{
+	int before = gTestFailures;
+	char dir[] = "/tmp/vstracetestXXXXXX";
+	TEST_CHECK(NULL != mkdtemp(dir));
+	char path[128], text[128], json[128];
+	sprintf(path, "%s/t.vst", dir);
+	sprintf(text, "%s/t.txt", dir);
+	sprintf(json, "%s/t.json", dir);
+
+	_VS_TRACE(VSTRACE_EV_RENDER, 0, 0, 0, 0, 0);			//off: nothing, not even a ring
+	TEST_CHECK(-1 == _VS_TraceStart(NULL));
+	TEST_CHECK(0 == _VS_TraceStart(path));
+	TEST_CHECK(-1 == _VS_TraceStart(path));
+
+	//this thread, tag 0: a few events, then a burst larger than its ring between two drains
+	int emitted = 0;
+	for (int i=0; i<10; i++, emitted++)		_VS_TRACE(VSTRACE_EV_RENDER, 0, i, 2, 3, 4);
+	__VS_Delay(VSTRACE_DRAIN_PERIOD * 3);
+	for (int i=10; i<10 + 3*VSTRACE_RING_RECORDS; i++, emitted++)		_VS_TRACE(VSTRACE_EV_RENDER, 0, i, 2, 3, 4);
+
+	pthread_barrier_t barrier;
+	pthread_barrier_init(&barrier, NULL, TRACETEST_THREADS);
+	TRACE_WORKER_T worker[TRACETEST_THREADS];
+	pthread_t thread[TRACETEST_THREADS];
+	for (int i=0; i<TRACETEST_THREADS; i++)
+	{
+		worker[i].tag = i + 1;
+		worker[i].barrier = &barrier;
+		TEST_CHECK(0 == pthread_create(&thread[i], NULL, __TraceThread, &worker[i]));
+	}
+	for (int i=0; i<TRACETEST_THREADS; i++)		pthread_join(thread[i], NULL);
+	pthread_barrier_destroy(&barrier);
+	emitted += TRACETEST_THREADS * TRACETEST_EVENTS;
+	_VS_TraceStop();
+	_VS_TRACE(VSTRACE_EV_RENDER, 0, 0, 0, 0, 0);			//after the stop, not in the file
+
+	TRACE_FILE_T trace;
+	TEST_CHECK(0 == __ReadTrace(path, &trace));
+	TEST_CHECK(VSTRACE_MAGIC == trace.header.magic && VSTRACE_VERSION == trace.header.version);
+	TEST_CHECK(sizeof(VSTRACE_RECORD_T) == trace.header.recordSize && trace.header.ticksPerSec > 0);
+	TEST_CHECK(VSTRACE_EV_COUNT - 1 == trace.events && (unsigned int)getpid() == trace.header.pid);
+	TEST_CHECK(trace.recorded + trace.dropped + trace.lost == (unsigned int)emitted);
+	TEST_CHECK(trace.dropped >= VSTRACE_RING_RECORDS);		//the burst, less what a drain took meanwhile
+	TEST_CHECK((TRACETEST_THREADS + 1 - VSTRACE_MAX_THREADS) * TRACETEST_EVENTS == (int)trace.lost);		//no ring is freed while all live
+
+	//per thread: one tag, in order, time never going back; the burst keeps what came first
+	int threads = 0, ordered = 1;
+	for (std::map<unsigned int, std::vector<VSTRACE_RECORD_T> >::iterator it=trace.records.begin(); it!=trace.records.end(); it++)
+	{
+		const std::vector<VSTRACE_RECORD_T>& records = it->second;
+		if (0 == it->first)		continue;				//the lost count, no records
+		threads ++;
+		for (size_t i=0; i<records.size(); i++)
+		{
+			const VSTRACE_RECORD_T *r = &records[i];
+			int seq = r->arg[0 == r->arg[0] ? 1 : 2];
+			if (r->arg[0] != records[0].arg[0] || r->ticks < trace.header.startTicks ||
+				(i > 0 && (r->ticks < records[i-1].ticks || seq <= records[i-1].arg[0 == r->arg[0] ? 1 : 2])))		ordered = 0;
+			if (0 != r->arg[0] && (VSTRACE_EV_DECODE != r->event || 1000 != r->arg[1] || 1 != r->arg[3]))		ordered = 0;
+			if (0 == r->arg[0] && (VSTRACE_EV_RENDER != r->event || 4 != r->arg[4]))		ordered = 0;
+		}
+	}
+	TEST_CHECK(ordered);
+	TEST_CHECK(threads + (int)(trace.lost / TRACETEST_EVENTS) == TRACETEST_THREADS + 1);
+	TEST_CHECK(VSTRACE_MAX_THREADS >= threads);
+
+	//the dump tool: a header line and one line per record or drop note; JSON wraps the same
+	char command[1024];
+	sprintf(command, "%s %s %s", gDumpPath, path, text);
+	TEST_CHECK(0 == system(command));
+	TEST_CHECK(1 + (int)(trace.recorded + trace.dropBlocks) == __CountLines(text));
+	sprintf(command, "%s -json %s %s", gDumpPath, path, json);
+	TEST_CHECK(0 == system(command));
+	TEST_CHECK(2 + (int)(trace.recorded + trace.dropBlocks) == __CountLines(json));
+
+	//a second trace starts empty: nothing left over from the first
+	TEST_CHECK(0 == _VS_TraceStart(path));
+	_VS_TRACE(VSTRACE_EV_CONNECTING, 7);
+	_VS_TraceStop();
+	TEST_CHECK(0 == __ReadTrace(path, &trace));
+	TEST_CHECK(1 == trace.recorded && 0 == trace.dropped && 0 == trace.lost);
+
+	unlink(path);
+	unlink(text);
+	unlink(json);
+	rmdir(dir);
+	__TestResult("TestTrace", before);
+}
+
+//ns per event of a burst that stays within the ring
+static double __BurstNs(int events)
+{
+	unsigned long long start = _VS_GetNs();
+	for (int i=0; i<events; i++)		_VS_TRACE(VSTRACE_EV_RENDER, 1, i, 2, 3, 4);
+	return (double)(_VS_GetNs() - start) / events;
+}
+
+static void *__BenchThread(void *lpParam)
+{
+	double *ns = (double *)lpParam;
+	std::vector<double> runs;
+	for (int r=0; r<20; r++)
+	{
+		runs.push_back(__BurstNs(VSTRACE_RING_RECORDS / 2));
+		__VS_Delay(VSTRACE_DRAIN_PERIOD + 5);
+	}
+	std::sort(runs.begin(), runs.end());
+	*ns = runs[runs.size() / 2];
+	return NULL;
+}
+
+static void BenchTrace()
+{
+	char path[] = "/tmp/vstracebenchXXXXXX";
+	int fd = mkstemp(path);
+	if (fd >= 0)		close(fd);
+
+	printf("off:                %6.2f ns/event\n", __BurstNs(10000000));
+
+	unsigned long long start = _VS_GetNs();
+	volatile unsigned long long sink = 0;
+	for (int i=0; i<1000000; i++)		sink += _VS_GetNs();
+	printf("clock read alone:   %6.2f ns\n", (double)(_VS_GetNs() - start) / 1e6);
+
+	_VS_TraceStart(path);
+	double one = 0.0;
+	__BenchThread(&one);
+	printf("on, one thread:     %6.2f ns/event (median of bursts)\n", one);
+
+	static const int counts[] = {4, 16, 48};
+	for (int c=0; c<(int)(sizeof(counts)/sizeof(counts[0])); c++)
+	{
+		pthread_t thread[48];
+		double ns[48];
+		for (int i=0; i<counts[c]; i++)		pthread_create(&thread[i], NULL, __BenchThread, &ns[i]);
+		for (int i=0; i<counts[c]; i++)		pthread_join(thread[i], NULL);
+		std::sort(ns, ns + counts[c]);
+		printf("on, %2d threads:     %6.2f ns/event median, %6.2f worst thread\n", counts[c], ns[counts[c] / 2], ns[counts[c] - 1]);
+	}
+	_VS_TraceStop();
+
+	TRACE_FILE_T trace;
+	__ReadTrace(path, &trace);
+	printf("file: %u records, %u dropped, %u lost\n", trace.recorded, trace.dropped, trace.lost);
+	unlink(path);
+}
+
+int main(int argc, char *argv[])
+{
+	//the dump tool is built next to this program
+	const char *slash = strrchr(argv[0], '/');
+	if (NULL != slash)		sprintf(gDumpPath, "%.*s/vstracedump", (int)(slash - argv[0]), argv[0]);
+
+	if (__TestIsBench(argc, argv))
+	{
+		BenchTrace();
+		return 0;
+	}
+
+	TestTrace();
+	return gTestFailures;
+}
@@ -0,0 +1,230 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+//Converts a trace written by _VS_TraceStart (vstrace.h) to text or to Chrome trace JSON
+//(chrome://tracing, ui.perfetto.dev). make -C tests build/vstracedump builds it on Linux; stand-alone:
+//	cl /O2 vstracedump.cpp		g++ -O2 -o vstracedump vstracedump.cpp
+//
+//	vstracedump [-json] trace.vst [output]
+#include "../vstrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define	DUMP_EVENT_DROPPED		0xFFFFFFFF		//a block's dropped count, arg[0]
+
+typedef struct __DUMP_ENTRY_T
+{
+	unsigned long long	ticks;
+	unsigned int		seq;			//file order, keeps equal ticks stable
+	unsigned int		threadId;
+	unsigned int		event;
+	int					arg[VSTRACE_MAX_ARGS];
+}DUMP_ENTRY_T;
+
+static int __CompareEntry(const void *_a, const void *_b)
+{
+	const DUMP_ENTRY_T *a = (const DUMP_ENTRY_T *)_a;
+	const DUMP_ENTRY_T *b = (const DUMP_ENTRY_T *)_b;
+	if (a->ticks != b->ticks)		return a->ticks < b->ticks ? -1 : 1;
+	return a->seq < b->seq ? -1 : (a->seq > b->seq ? 1 : 0);
+}
+
+static const VSTRACE_EVENT_DESC_T *__FindDesc(const VSTRACE_EVENT_DESC_T *desc, unsigned int events, unsigned int id)
+{
+	for (unsigned int i=0; i<events; i++)
+	{
+		if (desc[i].id == id)		return &desc[i];
+	}
+	return NULL;
+}
+
+static unsigned char *__ReadFile(const char *path, long *size)
+{
+	FILE *f = fopen(path, "rb");
+	if (NULL == f)		return NULL;
+	fseek(f, 0, SEEK_END);
+	*size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	unsigned char *data = (unsigned char *)malloc(*size > 0 ? *size : 1);
+	if (NULL != data && *size > 0 && fread(data, 1, *size, f) != (size_t)*size)
+	{
+		free(data);
+		data = NULL;
+	}
+	fclose(f);
+	return data;
+}
+
+int main(int argc, char *argv[])
+{
+	int json = 0;
+	int argi = 1;
+	if (argi < argc && 0 == strcmp(argv[argi], "-json"))
+	{
+		json = 1;
+		argi ++;
+	}
+	if (argi >= argc)
+	{
+		fprintf(stderr, "usage: vstracedump [-json] trace.vst [output]\n");
+		return 1;
+	}
+
+	long size = 0;
+	unsigned char *data = __ReadFile(argv[argi], &size);
+	if (NULL == data)
+	{
+		fprintf(stderr, "cannot read %s\n", argv[argi]);
+		return 1;
+	}
+
+	VSTRACE_FILE_HEADER_T header;
+	if (size < (long)sizeof(header))
+	{
+		fprintf(stderr, "%s: too short\n", argv[argi]);
+		return 1;
+	}
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != VSTRACE_MAGIC || header.version != VSTRACE_VERSION || header.recordSize != sizeof(VSTRACE_RECORD_T) ||
+		header.ticksPerSec == 0 || (long)(sizeof(header) + header.events * sizeof(VSTRACE_EVENT_DESC_T)) > size)
+	{
+		fprintf(stderr, "%s: not a version %d trace\n", argv[argi], VSTRACE_VERSION);
+		return 1;
+	}
+	const VSTRACE_EVENT_DESC_T *desc = (const VSTRACE_EVENT_DESC_T *)(data + sizeof(header));
+	long pos = sizeof(header) + header.events * sizeof(VSTRACE_EVENT_DESC_T);
+
+	//every record and every drop note, then one sort by time across the threads
+	unsigned int entries = 0, capacity = 0, truncated = 0;
+	DUMP_ENTRY_T *entry = NULL;
+	unsigned long long lastTicks = header.startTicks;
+	while (pos + (long)sizeof(VSTRACE_BLOCK_T) <= size)
+	{
+		VSTRACE_BLOCK_T block;
+		memcpy(&block, data + pos, sizeof(block));
+		pos += sizeof(block);
+		if (block.magic != VSTRACE_BLOCK_MAGIC || pos + (long)block.count * (long)sizeof(VSTRACE_RECORD_T) > size)
+		{
+			truncated = 1;
+			break;
+		}
+
+		if (entries + block.count + 1 > capacity)
+		{
+			capacity = (entries + block.count + 1) * 2;
+			entry = (DUMP_ENTRY_T *)realloc(entry, capacity * sizeof(DUMP_ENTRY_T));
+			if (NULL == entry)
+			{
+				fprintf(stderr, "out of memory\n");
+				return 1;
+			}
+		}
+		for (unsigned int i=0; i<block.count; i++)
+		{
+			VSTRACE_RECORD_T record;
+			memcpy(&record, data + pos, sizeof(record));
+			pos += sizeof(record);
+
+			DUMP_ENTRY_T *e = &entry[entries];
+			e->ticks	=	record.ticks;
+			e->seq		=	entries;
+			e->threadId	=	block.threadId;
+			e->event	=	record.event;
+			memcpy(e->arg, record.arg, sizeof(e->arg));
+			entries ++;
+			lastTicks = record.ticks;
+		}
+		if (block.dropped > 0)
+		{
+			DUMP_ENTRY_T *e = &entry[entries];
+			memset(e, 0x00, sizeof(DUMP_ENTRY_T));
+			e->ticks	=	lastTicks;		//the drops happened before this drain
+			e->seq		=	entries;
+			e->threadId	=	block.threadId;
+			e->event	=	DUMP_EVENT_DROPPED;
+			e->arg[0]	=	(int)block.dropped;
+			entries ++;
+		}
+	}
+	if (truncated || pos != size)		fprintf(stderr, "%s: truncated at byte %ld\n", argv[argi], pos);
+	if (entries > 0)		qsort(entry, entries, sizeof(DUMP_ENTRY_T), __CompareEntry);
+
+	FILE *out = stdout;
+	if (argi + 1 < argc)
+	{
+		out = fopen(argv[argi+1], "w");
+		if (NULL == out)
+		{
+			fprintf(stderr, "cannot create %s\n", argv[argi+1]);
+			return 1;
+		}
+	}
+
+	if (json)
+	{
+		fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	}
+	else
+	{
+		time_t start = (time_t)(header.startTime / 1000000);
+		char szTime[32] = {0,};
+		strftime(szTime, sizeof(szTime), "%Y-%m-%d %H:%M:%S", localtime(&start));
+		fprintf(out, "# pid %u, started %s.%06u, %u events, times in ms\n", header.pid, szTime, (unsigned int)(header.startTime % 1000000), entries);
+	}
+
+	for (unsigned int i=0; i<entries; i++)
+	{
+		const DUMP_ENTRY_T *e = &entry[i];
+		double us = e->ticks >= header.startTicks ? (double)(e->ticks - header.startTicks) * 1000000.0 / (double)header.ticksPerSec
+												   : -(double)(header.startTicks - e->ticks) * 1000000.0 / (double)header.ticksPerSec;
+		const VSTRACE_EVENT_DESC_T *d = __FindDesc(desc, header.events, e->event);
+		char szName[32] = {0,};
+		if (e->event == DUMP_EVENT_DROPPED)		strcpy(szName, e->threadId == 0 ? "lost_no_ring" : "dropped_ring_full");
+		else if (NULL != d)						memcpy(szName, d->name, sizeof(d->name));		//may fill it without a 0
+		else									sprintf(szName, "event_%u", e->event);
+
+		if (json)
+		{
+			if (NULL != d && d->durationArg >= 0 && d->durationArg < VSTRACE_MAX_ARGS && e->arg[d->durationArg] >= 0)
+			{
+				int dur = e->arg[d->durationArg];
+				fprintf(out, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%d,\"pid\":%u,\"tid\":%u,\"args\":{", szName, us - dur, dur, header.pid, e->threadId);
+			}
+			else
+			{
+				fprintf(out, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"%s\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u,\"args\":{", szName, e->threadId == 0 ? "p" : "t", us, header.pid, e->threadId);
+			}
+		}
+		else
+		{
+			fprintf(out, "%14.3f  %6u  %-18s", us / 1000.0, e->threadId, szName);
+		}
+
+		int comma = 0;
+		for (int a=0; a<VSTRACE_MAX_ARGS; a++)
+		{
+			char szArg[20] = {0,};
+			if (e->event == DUMP_EVENT_DROPPED)		{ if (a > 0) break;  strcpy(szArg, "count"); }
+			else if (NULL != d)						{ if (d->args[a][0] == '\0') continue;  memcpy(szArg, d->args[a], sizeof(d->args[a])); }
+			else									sprintf(szArg, "arg%d", a);
+
+			if (json)		fprintf(out, "%s\"%s\":%d", comma ? "," : "", szArg, e->arg[a]);
+			else			fprintf(out, "  %s=%d", szArg, e->arg[a]);
+			comma = 1;
+		}
+		if (json)		fprintf(out, "}}%s\n", i + 1 < entries ? "," : "");
+		else			fprintf(out, "\n");
+	}
+
+	if (json)		fprintf(out, "]}\n");
+	if (out != stdout)		fclose(out);
+	free(entry);
+	free(data);
+	return 0;
+}
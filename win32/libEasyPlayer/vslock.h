@@ -0,0 +1,31 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VS_LOCK_H__
+#define __VS_LOCK_H__
+
+#ifdef _WIN32
+#include <winsock2.h>
+
+typedef CRITICAL_SECTION	VS_LOCK_T;
+
+#define	_VS_InitLock(x)		InitializeCriticalSection(x)
+#define	_VS_DeinitLock(x)	DeleteCriticalSection(x)
+#define	_VS_Lock(x)			EnterCriticalSection(x)
+#define	_VS_Unlock(x)		LeaveCriticalSection(x)
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t		VS_LOCK_T;
+
+#define	_VS_InitLock(x)		pthread_mutex_init(x, NULL)
+#define	_VS_DeinitLock(x)	pthread_mutex_destroy(x)
+#define	_VS_Lock(x)			pthread_mutex_lock(x)
+#define	_VS_Unlock(x)		pthread_mutex_unlock(x)
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "vssimd.h"
+#if defined(__VS_AVX2)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+volatile int	gVSAvx2 = -1;
+
+static int __VS_CpuHasAvx2()
+{
+#if defined(__VS_AVX2)
+	int info[4] = {0};
+#ifdef _MSC_VER
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+#else
+	unsigned int a, b, c, d;
+	unsigned int maxLeaf = __get_cpuid_max(0, NULL);
+	__cpuid(1, a, b, c, d);
+	info[2] = c;
+#endif
+	//the OS has to save the ymm state too: OSXSAVE, AVX, then XCR0 bits 1 and 2
+	if (maxLeaf < 7 || !(info[2] & (1 << 27)) || !(info[2] & (1 << 28)))		return 0;
+
+	unsigned long long xcr0;
+#ifdef _MSC_VER
+	xcr0 = _xgetbv(0);
+	__cpuidex(info, 7, 0);
+	int ebx = info[1];
+#else
+	unsigned int lo, hi;
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	xcr0 = ((unsigned long long)hi << 32) | lo;
+	__cpuid_count(7, 0, a, b, c, d);
+	int ebx = (int)b;
+#endif
+	return ((xcr0 & 0x06) == 0x06 && (ebx & (1 << 5))) ? 1 : 0;
+#else
+	return 0;
+#endif
+}
+
+int _VS_DetectAvx2()
+{
+	//racing threads store the same value
+	gVSAvx2 = __VS_CpuHasAvx2();
+	return gVSAvx2;
+}
+
+void _VS_SetAvx2(int enable)
+{
+	if (enable)		_VS_DetectAvx2();
+	else			gVSAvx2 = 0;
+}
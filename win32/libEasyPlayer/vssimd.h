@@ -0,0 +1,42 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VS_SIMD_H__
+#define __VS_SIMD_H__
+
+//SSE2 or NEON is the baseline, selected at compile time; the scalar path is always available.
+//AVX2 kernels are compiled whenever the compiler can emit them, whatever /arch says, and are
+//only entered when _VS_UseAvx2() finds the CPU and the OS support them
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define	__VS_SSE2
+#include <emmintrin.h>
+#if (defined(_MSC_VER) && _MSC_VER >= 1700) || defined(__GNUC__)
+#define	__VS_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define	__VS_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#define	__VS_ALIGN16	__declspec(align(16))
+#define	__VS_TARGET_AVX2					//cl emits AVX2 intrinsics under /arch:SSE2 too
+#else
+#define	__VS_ALIGN16	__attribute__((aligned(16)))
+#define	__VS_TARGET_AVX2	__attribute__((target("avx2")))
+#endif
+
+extern volatile int	gVSAvx2;		//-1 until detected
+
+int		_VS_DetectAvx2();
+//every AVX2 kernel starts with it, one load once detected
+static inline int	_VS_UseAvx2()	{return gVSAvx2 >= 0 ? gVSAvx2 : _VS_DetectAvx2();}
+//0 runs the SSE2 kernels on an AVX2 machine, for tests and benchmarks; 1 goes back to detection
+void	_VS_SetAvx2(int enable);
+
+#endif
@@ -6,41 +6,34 @@
 	Author: Gavin@easydarwin.org
 */
 #include "vstime.h"
-#include <winsock2.h>
 #include <time.h>
+#ifdef _WIN32
+#include <winsock2.h>
 #include "trace.h"
+#else
+#include <sched.h>
+#include <sys/time.h>
+#endif
+
+#ifdef _WIN32
+static volatile LONG	gVSTimePeriods = 0;		//_VS_BEGIN_TIME_PERIOD calls not yet ended
+#endif
 
 void __VS_Delay(unsigned int _msec)
 {
-	//timeBeginPeriod(1);
-	//Sleep(_msec);
-	//timeEndPeriod(1);
-/*
-	static LARGE_INTEGER	cpuFreq;
-	static int gVSTimeInit = 0x00;
-	if (gVSTimeInit == 0x00)
-	{
-		QueryPerformanceFrequency(&cpuFreq);
-		gVSTimeInit = 0x01;
-	}
-
-	_LARGE_INTEGER lastRenderTime;
-	QueryPerformanceCounter(&lastRenderTime);
-*/
+#ifdef _WIN32
 	SleepEx(_msec, FALSE);
-	//Sleep(_msec);
-/*
-	_LARGE_INTEGER	nowTime;
-	QueryPerformanceCounter(&nowTime);
-
-	LONGLONG lInterval = (LONGLONG)(((nowTime.QuadPart - lastRenderTime.QuadPart) / (double)cpuFreq.QuadPart * (double)1000));
-	//if (_msec != lInterval && _msec>1)
-		//_TRACE("%ld\t\t%d\n",_msec,  lInterval);
-*/
+#else
+	struct timespec ts;
+	ts.tv_sec	=	_msec / 1000;
+	ts.tv_nsec	=	(long)(_msec % 1000) * 1000000L;
+	nanosleep(&ts, NULL);
+#endif
 }
 
 unsigned int _VS_GetTime(VS_TIME_T *_usagetime)
 {
+#ifdef _WIN32
 	SYSTEMTIME	systemTime;
 	GetSystemTime(&systemTime);
 
@@ -53,11 +46,18 @@ unsigned int _VS_GetTime(VS_TIME_T *_usagetime)
 	tmpTm.tm_sec	=	systemTime.wSecond;
 	unsigned int uiTime	=	(unsigned int)mktime(&tmpTm);
 	if (uiTime == 0x00)		return -1;
+	unsigned int uiMsec	=	systemTime.wMilliseconds;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	unsigned int uiTime	=	(unsigned int)tv.tv_sec;
+	unsigned int uiMsec	=	(unsigned int)(tv.tv_usec / 1000);
+#endif
 
 	if (NULL != _usagetime)
 	{
 		_usagetime->time_sec	=	uiTime;
-		_usagetime->msec		=	systemTime.wMilliseconds;
+		_usagetime->msec		=	uiMsec;
 	}
 
 	return uiTime;
@@ -83,10 +83,122 @@ unsigned int _VS_CalcTimeInterval(VS_TIME_T *_starttime, VS_TIME_T *_endtime)
 
 void _VS_BEGIN_TIME_PERIOD(unsigned int _msec)
 {
-	timeBeginPeriod(_msec);
+#ifdef _WIN32
+	if (InterlockedIncrement(&gVSTimePeriods) == 1)		timeBeginPeriod(_msec);
+#else
+	(void)_msec;
+#endif
 }
 
 void _VS_END_TIME_PERIOD(unsigned int _msec)
 {
-	timeEndPeriod(_msec);
+#ifdef _WIN32
+	if (InterlockedDecrement(&gVSTimePeriods) == 0)		timeEndPeriod(_msec);
+#else
+	(void)_msec;
+#endif
+}
+
+unsigned long long _VS_GetNs()
+{
+#ifdef _WIN32
+	static LARGE_INTEGER	cpuFreq = {0};
+	if (cpuFreq.QuadPart == 0)		QueryPerformanceFrequency(&cpuFreq);		//the same on every thread
+	LARGE_INTEGER	counter;
+	QueryPerformanceCounter(&counter);
+	//seconds and remainder apart, counter * 1e9 would overflow after a few days of uptime
+	unsigned long long sec = counter.QuadPart / cpuFreq.QuadPart;
+	unsigned long long rem = counter.QuadPart % cpuFreq.QuadPart;
+	return sec * 1000000000ULL + rem * 1000000000ULL / cpuFreq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+long long _VS_SleepUntilNs(unsigned long long _deadlineNs, unsigned long long _spinNs)
+{
+	for (;;)
+	{
+		unsigned long long now = _VS_GetNs();
+		if (now >= _deadlineNs)		return (long long)(now - _deadlineNs);
+
+		unsigned long long remain = _deadlineNs - now;
+		if (remain > _spinNs)
+		{
+#ifdef _WIN32
+			unsigned long long sleepNs = remain - _spinNs;
+			if (_spinNs == 0)	sleepNs += 999999ULL;		//nothing to spin on, round up instead of polling
+			SleepEx((DWORD)(sleepNs / 1000000ULL), FALSE);
+#else
+			struct timespec ts;
+			ts.tv_sec	=	(time_t)((remain - _spinNs) / 1000000000ULL);
+			ts.tv_nsec	=	(long)((remain - _spinNs) % 1000000000ULL);
+			nanosleep(&ts, NULL);
+#endif
+		}
+		else
+		{
+			//the last stretch: give the core away but stay runnable
+#ifdef _WIN32
+			SwitchToThread();
+#else
+			sched_yield();
+#endif
+		}
+	}
+}
+
+void _VS_PacerReset(VS_PACER_T *_pacer)
+{
+	if (NULL != _pacer)		memset(_pacer, 0x00, sizeof(VS_PACER_T));
+}
+
+unsigned long long _VS_PacerDeadline(VS_PACER_T *_pacer, unsigned long long _ptsUs, int _fps)
+{
+	unsigned long long now = _VS_GetNs();
+	if (NULL == _pacer)		return now;
+
+	unsigned long long period = 1000000000ULL / (unsigned long long)(_fps > 0 ? _fps : 30);
+	unsigned long long deadline = 0;
+	int anchor = 1;
+	if (!_pacer->started)
+	{
+		deadline = now;
+	}
+	else if (_ptsUs == 0 || _pacer->lastPts == 0 || _ptsUs < _pacer->lastPts || (long long)(_ptsUs - _pacer->lastPts) > VS_PACER_MAX_JUMP_US)
+	{
+		deadline = _pacer->lastDeadline + period;		//no PTS or a new time line: one frame on
+	}
+	else
+	{
+		//from the anchor, so per frame rounding and late wakeups never add up
+		deadline = _pacer->anchorNs + (_ptsUs - _pacer->anchorPts) * 1000ULL;
+		anchor = 0;
+	}
+	if ((now > deadline && now - deadline > (unsigned long long)VS_PACER_MAX_SKEW_NS) ||
+		(deadline > now && deadline - now > (unsigned long long)VS_PACER_MAX_SKEW_NS))
+	{
+		deadline = now;
+		anchor = 1;
+	}
+
+	if (anchor)
+	{
+		_pacer->anchorNs	=	deadline;
+		_pacer->anchorPts	=	_ptsUs;
+	}
+	_pacer->started			=	1;
+	_pacer->lastPts			=	_ptsUs;
+	_pacer->lastDeadline	=	deadline;
+	return deadline;
+}
+
+void _VS_PacerShift(VS_PACER_T *_pacer, long long _ns)
+{
+	if (NULL == _pacer || !_pacer->started)		return;
+
+	_pacer->anchorNs		+=	_ns;
+	_pacer->lastDeadline	+=	_ns;
 }
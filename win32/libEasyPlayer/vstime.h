@@ -9,19 +9,42 @@
 #define __VS_TIME_H__
 
 
+#ifdef _WIN32
 #include <winsock2.h>
+#pragma comment(lib, "winmm.lib")
+#endif
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#pragma comment(lib, "winmm.lib")
+
+#ifdef _WIN32
+#define		VS_SPIN_NS				1500000ULL		//Sleep(1) may take 2ms even with timeBeginPeriod(1)
+#else
+#define		VS_SPIN_NS				300000ULL		//nanosleep overshoots by tens of us
+#endif
+#define		VS_PACER_MAX_SKEW_NS	1500000000LL	//a deadline further than this from now, either way, starts counting again
+#define		VS_PACER_MAX_JUMP_US	2000000LL		//a PTS step larger than this, or backwards, is a discontinuity
+
 typedef struct __VS_TIME_T
 {
 	unsigned int time_sec;
 	unsigned int msec;
 }VS_TIME_T;
 
+//frame deadlines kept on one absolute time line: a late wakeup does not push the frames after it
+typedef struct __VS_PACER_T
+{
+	int					started;
+	unsigned long long	anchorNs;		//clock of anchorPts
+	unsigned long long	anchorPts;		//us
+	unsigned long long	lastPts;
+	unsigned long long	lastDeadline;
+}VS_PACER_T;
+
 
 
+//reference counted: the timer resolution is raised by the first caller and restored by the last,
+//so pairs around every wait cost nothing
 void _VS_BEGIN_TIME_PERIOD(unsigned int _msec);
 void _VS_END_TIME_PERIOD(unsigned int _msec);
 
@@ -29,6 +52,19 @@ void __VS_Delay(unsigned int _msec);
 unsigned int _VS_GetTime(VS_TIME_T *_usagetime);
 unsigned int _VS_CalcTimeInterval(VS_TIME_T *_starttime, VS_TIME_T *_endtime);
 
+//monotonic nanoseconds from an arbitrary start, never stepped by clock changes
+unsigned long long _VS_GetNs();
+//sleeps until _spinNs before the deadline and spins the rest; returns how late it returned, in ns.
+//_spinNs 0 for periodic work that can take the timer granularity
+long long _VS_SleepUntilNs(unsigned long long _deadlineNs, unsigned long long _spinNs=VS_SPIN_NS);
+
+void _VS_PacerReset(VS_PACER_T *_pacer);
+//the _VS_GetNs deadline of a frame: from its PTS (us) relative to the anchor, or one 1/fps period
+//after the previous frame when it has none. Re-anchors on a discontinuity or a deadline far off
+unsigned long long _VS_PacerDeadline(VS_PACER_T *_pacer, unsigned long long _ptsUs, int _fps);
+//moves every later deadline, e.g. to let a frame cache fill or drain
+void _VS_PacerShift(VS_PACER_T *_pacer, long long _ns);
+
 
 
 
@@ -0,0 +1,346 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#include "vstrace.h"
+#include "vstime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+#define	VSTRACE_RING_FREE		0
+#define	VSTRACE_RING_OWNED		1
+#define	VSTRACE_RING_RETIRED	2		//its thread exited, the drain thread frees it once empty
+
+#define	VSTRACE_STOPPED			0
+#define	VSTRACE_BUSY			1		//starting or stopping
+#define	VSTRACE_RUNNING			2
+
+#define	VSTRACE_FILE_BUFFER		(256*1024)
+
+//head and tail are the only words two threads exchange: the owner publishes records with head,
+//the drain thread hands the space back with tail
+#ifdef _WIN32
+#define	__VSTRACE_LOAD(p)		(*(p))						//volatile reads acquire on MSVC
+#define	__VSTRACE_STORE(p, v)	(*(p) = (v))				//volatile writes release on MSVC
+#define	__VSTRACE_CAS(p, o, n)	(InterlockedCompareExchange((p), (n), (o)) == (o))
+#define	__VSTRACE_INC(p)		InterlockedIncrement(p)
+#else
+#define	__VSTRACE_LOAD(p)		__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define	__VSTRACE_STORE(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define	__VSTRACE_CAS(p, o, n)	__sync_bool_compare_and_swap((p), (o), (n))
+#define	__VSTRACE_INC(p)		__sync_add_and_fetch((p), 1)
+#endif
+
+typedef struct __VSTRACE_RING_T
+{
+	volatile long		state;			//VSTRACE_RING_xxx
+	unsigned int		threadId;
+	VSTRACE_RECORD_T	*records;		//allocated on first claim and kept, a late event may still write
+	char				pad0[64];
+	volatile unsigned int	head;		//owner only
+	volatile unsigned int	dropped;	//owner only, ring full
+	char				pad1[64];
+	volatile unsigned int	tail;		//drain thread only
+	unsigned int		reported;		//dropped already written
+	char				pad2[64];
+}VSTRACE_RING_T;
+
+static const VSTRACE_EVENT_DESC_T gTraceEvents[] =
+{
+	{VSTRACE_EV_DECODE,				2,	"decode",			{"ch", "bytes", "us", "type"}},
+	{VSTRACE_EV_DECODE_FAIL,		-1,	"decode_fail",		{"ch", "bytes", "type", "head"}},
+	{VSTRACE_EV_AUDIO_DECODE_FAIL,	-1,	"audio_decode_fail",{"ch", "codec", "bytes"}},
+	{VSTRACE_EV_NO_DECODER,			-1,	"no_decoder",		{"ch", "width", "height"}},
+	{VSTRACE_EV_QUEUE_OVERFLOW,		-1,	"queue_overflow",	{"ch", "frames", "max"}},
+	{VSTRACE_EV_WAIT_KEYFRAME,		-1,	"wait_keyframe",	{"ch", "type"}},
+	{VSTRACE_EV_RENDER,				2,	"render",			{"ch", "late_us", "us", "queue", "cache"}},
+	{VSTRACE_EV_DROP_FRAME,			-1,	"drop_frame",		{"ch", "drops", "queue", "cache"}},
+	{VSTRACE_EV_DEVICE_LOST,		-1,	"device_lost",		{"ch", "seconds"}},
+	{VSTRACE_EV_CONNECTING,			-1,	"connecting",		{"ch"}},
+	{VSTRACE_EV_PACKET_LOSS,		-1,	"packet_loss",		{"ch", "loss_x100"}},
+	{VSTRACE_EV_SSQ_CLEAR,			-1,	"ssq_clear",		{"ch", "writepos", "frames"}},
+	{VSTRACE_EV_SSQ_FULL,			-1,	"ssq_full",			{"ch", "bytes", "totalsize", "bufsize", "frames"}},
+};
+
+volatile int			gVSTraceOn = 0;
+static volatile long	gTraceState = VSTRACE_STOPPED;
+static VSTRACE_RING_T	gTraceRing[VSTRACE_MAX_THREADS];
+static volatile long	gTraceLost = 0;		//events of threads finding no free ring
+static long				gTraceLostReported = 0;
+static FILE				*gTraceFile = NULL;
+static volatile int		gTraceQuit = 0;
+#ifdef _WIN32
+static DWORD			gTraceFls = FLS_OUT_OF_INDEXES;
+static HANDLE			gTraceThread = NULL;
+#else
+static pthread_key_t	gTraceKey;
+static int				gTraceKeyInit = 0;
+static pthread_t		gTraceThread;
+#endif
+
+
+static inline unsigned long long __VSTraceTicks()
+{
+#ifdef _WIN32
+	LARGE_INTEGER	counter;
+	QueryPerformanceCounter(&counter);
+	return (unsigned long long)counter.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static unsigned int __VSTraceThreadId()
+{
+#ifdef _WIN32
+	return (unsigned int)GetCurrentThreadId();
+#elif defined(__linux__)
+	return (unsigned int)syscall(SYS_gettid);
+#else
+	return (unsigned int)(size_t)pthread_self();
+#endif
+}
+
+//thread exit: the drain thread writes what is left and frees the ring
+#ifdef _WIN32
+static VOID WINAPI __VSTraceThreadExit(PVOID _ring)
+#else
+static void __VSTraceThreadExit(void *_ring)
+#endif
+{
+	VSTRACE_RING_T *ring = (VSTRACE_RING_T *)_ring;
+	if (NULL != ring)		__VSTRACE_STORE(&ring->state, VSTRACE_RING_RETIRED);
+}
+
+static VSTRACE_RING_T *__VSTraceClaim()
+{
+	for (int i=0; i<VSTRACE_MAX_THREADS; i++)
+	{
+		VSTRACE_RING_T *ring = &gTraceRing[i];
+		if (__VSTRACE_LOAD(&ring->state) != VSTRACE_RING_FREE || !__VSTRACE_CAS(&ring->state, VSTRACE_RING_FREE, VSTRACE_RING_OWNED))		continue;
+
+		if (NULL == ring->records)		ring->records = (VSTRACE_RECORD_T *)malloc(sizeof(VSTRACE_RECORD_T) * VSTRACE_RING_RECORDS);
+		if (NULL == ring->records)
+		{
+			__VSTRACE_STORE(&ring->state, VSTRACE_RING_FREE);
+			return NULL;
+		}
+		ring->threadId = __VSTraceThreadId();
+#ifdef _WIN32
+		FlsSetValue(gTraceFls, ring);
+#else
+		pthread_setspecific(gTraceKey, ring);
+#endif
+		return ring;
+	}
+	return NULL;
+}
+
+void _VS_Trace(unsigned int event, int arg0, int arg1, int arg2, int arg3, int arg4)
+{
+	if (!gVSTraceOn)		return;
+
+#ifdef _WIN32
+	VSTRACE_RING_T *ring = (VSTRACE_RING_T *)FlsGetValue(gTraceFls);
+#else
+	VSTRACE_RING_T *ring = (VSTRACE_RING_T *)pthread_getspecific(gTraceKey);
+#endif
+	if (NULL == ring)		ring = __VSTraceClaim();
+	if (NULL == ring)
+	{
+		__VSTRACE_INC(&gTraceLost);
+		return;
+	}
+
+	unsigned int head = ring->head;
+	if (head - __VSTRACE_LOAD(&ring->tail) >= VSTRACE_RING_RECORDS)
+	{
+		ring->dropped = ring->dropped + 1;		//never block the caller
+		return;
+	}
+
+	VSTRACE_RECORD_T *record = &ring->records[head & (VSTRACE_RING_RECORDS-1)];
+	record->ticks	=	__VSTraceTicks();
+	record->event	=	event;
+	record->arg[0]	=	arg0;
+	record->arg[1]	=	arg1;
+	record->arg[2]	=	arg2;
+	record->arg[3]	=	arg3;
+	record->arg[4]	=	arg4;
+	__VSTRACE_STORE(&ring->head, head + 1);
+}
+
+//writes every ring's new records; f NULL only skips them, for what was left from a previous trace
+static void __VSTraceDrain(FILE *f)
+{
+	for (int i=0; i<VSTRACE_MAX_THREADS; i++)
+	{
+		VSTRACE_RING_T *ring = &gTraceRing[i];
+		long state = __VSTRACE_LOAD(&ring->state);
+		if (state == VSTRACE_RING_FREE)		continue;
+
+		unsigned int head = __VSTRACE_LOAD(&ring->head);		//after state: a retired ring's last records are visible
+		unsigned int tail = ring->tail;
+		unsigned int dropped = ring->dropped;
+		if (NULL != f && (head != tail || dropped != ring->reported))
+		{
+			VSTRACE_BLOCK_T	block;
+			block.magic		=	VSTRACE_BLOCK_MAGIC;
+			block.threadId	=	ring->threadId;
+			block.count		=	head - tail;
+			block.dropped	=	dropped - ring->reported;
+			fwrite(&block, sizeof(VSTRACE_BLOCK_T), 1, f);
+
+			unsigned int first = tail & (VSTRACE_RING_RECORDS-1);
+			unsigned int count = block.count;
+			if (count > VSTRACE_RING_RECORDS - first)
+			{
+				fwrite(&ring->records[first], sizeof(VSTRACE_RECORD_T), VSTRACE_RING_RECORDS - first, f);
+				count -= VSTRACE_RING_RECORDS - first;
+				first = 0;
+			}
+			if (count > 0)		fwrite(&ring->records[first], sizeof(VSTRACE_RECORD_T), count, f);
+		}
+		ring->reported = dropped;
+		__VSTRACE_STORE(&ring->tail, head);
+
+		if (state == VSTRACE_RING_RETIRED)
+		{
+			ring->head		=	0;
+			ring->tail		=	0;
+			ring->dropped	=	0;
+			ring->reported	=	0;
+			__VSTRACE_STORE(&ring->state, VSTRACE_RING_FREE);
+		}
+	}
+
+	long lost = gTraceLost;
+	if (NULL != f && lost != gTraceLostReported)
+	{
+		VSTRACE_BLOCK_T	block;
+		block.magic		=	VSTRACE_BLOCK_MAGIC;
+		block.threadId	=	0;
+		block.count		=	0;
+		block.dropped	=	(unsigned int)(lost - gTraceLostReported);
+		fwrite(&block, sizeof(VSTRACE_BLOCK_T), 1, f);
+	}
+	gTraceLostReported = lost;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI __VSTraceThread(LPVOID /*lpParam*/)
+#else
+static void *__VSTraceThread(void * /*lpParam*/)
+#endif
+{
+	while (!gTraceQuit)
+	{
+		__VS_Delay(VSTRACE_DRAIN_PERIOD);
+		__VSTraceDrain(gTraceFile);
+	}
+	return 0;
+}
+
+int _VS_TraceStart(const char *path)
+{
+	if (NULL == path)		return -1;
+	if (!__VSTRACE_CAS(&gTraceState, VSTRACE_STOPPED, VSTRACE_BUSY))		return -1;
+
+#ifdef _WIN32
+	if (gTraceFls == FLS_OUT_OF_INDEXES)		gTraceFls = FlsAlloc(__VSTraceThreadExit);		//kept for the process
+	int keyReady = (gTraceFls != FLS_OUT_OF_INDEXES);
+#else
+	if (!gTraceKeyInit)		gTraceKeyInit = (0 == pthread_key_create(&gTraceKey, __VSTraceThreadExit));
+	int keyReady = gTraceKeyInit;
+#endif
+	FILE *f = keyReady ? fopen(path, "wb") : NULL;
+	if (NULL == f)
+	{
+		__VSTRACE_STORE(&gTraceState, VSTRACE_STOPPED);
+		return -1;
+	}
+	setvbuf(f, NULL, _IOFBF, VSTRACE_FILE_BUFFER);
+
+	__VSTraceDrain(NULL);
+
+	VSTRACE_FILE_HEADER_T	header;
+	memset(&header, 0x00, sizeof(VSTRACE_FILE_HEADER_T));
+	header.magic		=	VSTRACE_MAGIC;
+	header.version		=	VSTRACE_VERSION;
+	header.recordSize	=	sizeof(VSTRACE_RECORD_T);
+	header.events		=	sizeof(gTraceEvents) / sizeof(gTraceEvents[0]);
+#ifdef _WIN32
+	LARGE_INTEGER	freq;
+	QueryPerformanceFrequency(&freq);
+	FILETIME	ft;
+	GetSystemTimeAsFileTime(&ft);
+	header.ticksPerSec	=	(unsigned long long)freq.QuadPart;
+	header.startTicks	=	__VSTraceTicks();
+	header.startTime	=	((((unsigned long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime) - 116444736000000000ULL) / 10;
+	header.pid			=	(unsigned int)GetCurrentProcessId();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	header.ticksPerSec	=	1000000000ULL;
+	header.startTicks	=	__VSTraceTicks();
+	header.startTime	=	(unsigned long long)tv.tv_sec * 1000000ULL + tv.tv_usec;
+	header.pid			=	(unsigned int)getpid();
+#endif
+	fwrite(&header, sizeof(VSTRACE_FILE_HEADER_T), 1, f);
+	fwrite(gTraceEvents, sizeof(VSTRACE_EVENT_DESC_T), header.events, f);
+
+	gTraceFile	=	f;
+	gTraceQuit	=	0;
+#ifdef _WIN32
+	gTraceThread = CreateThread(NULL, 0, __VSTraceThread, NULL, 0, NULL);
+	int threadReady = (NULL != gTraceThread);
+#else
+	int threadReady = (0 == pthread_create(&gTraceThread, NULL, __VSTraceThread, NULL));
+#endif
+	if (!threadReady)
+	{
+		fclose(f);
+		gTraceFile = NULL;
+		__VSTRACE_STORE(&gTraceState, VSTRACE_STOPPED);
+		return -1;
+	}
+
+	gVSTraceOn = 1;
+	__VSTRACE_STORE(&gTraceState, VSTRACE_RUNNING);
+	return 0;
+}
+
+void _VS_TraceStop()
+{
+	if (!__VSTRACE_CAS(&gTraceState, VSTRACE_RUNNING, VSTRACE_BUSY))		return;
+
+	gVSTraceOn = 0;
+	gTraceQuit = 1;
+#ifdef _WIN32
+	WaitForSingleObject(gTraceThread, INFINITE);
+	CloseHandle(gTraceThread);
+	gTraceThread = NULL;
+#else
+	pthread_join(gTraceThread, NULL);
+#endif
+	__VSTraceDrain(gTraceFile);
+	fclose(gTraceFile);
+	gTraceFile = NULL;
+
+	__VSTRACE_STORE(&gTraceState, VSTRACE_STOPPED);
+}
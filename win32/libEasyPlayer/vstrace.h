@@ -0,0 +1,98 @@
+/*
+	Copyright (c) 2013-2014 EasyDarwin.ORG.  All rights reserved.
+	Github: https://github.com/EasyDarwin
+	WEChat: EasyDarwin
+	Website: http://www.easydarwin.org
+	Author: Gavin@easydarwin.org
+*/
+#ifndef __VS_TRACE_H__
+#define __VS_TRACE_H__
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
+//Binary event trace: every thread writes fixed size records into its own lock-free ring, a drain
+//thread appends them to a file in blocks. tools/vstracedump.cpp turns the file into text or
+//Chrome trace JSON. Off, an event costs one load and a branch
+
+#define		VSTRACE_MAGIC			0x52545356		//"VSTR"
+#define		VSTRACE_BLOCK_MAGIC		0x4B4C4256		//"VBLK"
+#define		VSTRACE_VERSION			1
+#define		VSTRACE_MAX_ARGS		5
+#define		VSTRACE_MAX_THREADS		64				//threads tracing at the same time, more lose their events
+#define		VSTRACE_RING_RECORDS	4096			//per thread, power of 2; 128KB
+#define		VSTRACE_DRAIN_PERIOD	20				//ms
+
+typedef enum __VSTRACE_EVENT
+{
+	VSTRACE_EV_NONE				=	0,
+	VSTRACE_EV_DECODE,				//ch, bytes, us, type
+	VSTRACE_EV_DECODE_FAIL,			//ch, bytes, type, first 4 bytes
+	VSTRACE_EV_AUDIO_DECODE_FAIL,	//ch, codec, bytes
+	VSTRACE_EV_NO_DECODER,			//ch, width, height
+	VSTRACE_EV_QUEUE_OVERFLOW,		//ch, frames, max
+	VSTRACE_EV_WAIT_KEYFRAME,		//ch, type
+	VSTRACE_EV_RENDER,				//ch, late us, us, queue, cache
+	VSTRACE_EV_DROP_FRAME,			//ch, drops, queue, cache
+	VSTRACE_EV_DEVICE_LOST,			//ch, seconds
+	VSTRACE_EV_CONNECTING,			//ch
+	VSTRACE_EV_PACKET_LOSS,			//ch, loss % x100
+	VSTRACE_EV_SSQ_CLEAR,			//ch, writepos, frames
+	VSTRACE_EV_SSQ_FULL,			//ch, bytes, totalsize, bufsize, frames
+
+	VSTRACE_EV_COUNT
+}VSTRACE_EVENT;
+
+//the file: VSTRACE_FILE_HEADER_T, one VSTRACE_EVENT_DESC_T per event, then blocks of
+//VSTRACE_BLOCK_T followed by count records. Blocks of different threads interleave
+typedef struct __VSTRACE_FILE_HEADER_T
+{
+	unsigned int		magic;
+	unsigned int		version;
+	unsigned int		recordSize;
+	unsigned int		events;			//VSTRACE_EVENT_DESC_T following
+	unsigned long long	ticksPerSec;
+	unsigned long long	startTicks;
+	unsigned long long	startTime;		//wall clock of startTicks, us since 1970
+	unsigned int		pid;
+	unsigned int		reserved;
+}VSTRACE_FILE_HEADER_T;
+
+typedef struct __VSTRACE_EVENT_DESC_T
+{
+	unsigned int		id;
+	int					durationArg;	//index of an arg holding the us the event took until ticks, -1 none
+	char				name[24];
+	char				args[VSTRACE_MAX_ARGS][16];		//empty: unused
+}VSTRACE_EVENT_DESC_T;
+
+typedef struct __VSTRACE_BLOCK_T
+{
+	unsigned int		magic;
+	unsigned int		threadId;
+	unsigned int		count;
+	unsigned int		dropped;		//events of this thread lost to a full ring since the previous block
+}VSTRACE_BLOCK_T;
+
+typedef struct __VSTRACE_RECORD_T
+{
+	unsigned long long	ticks;
+	unsigned int		event;
+	int					arg[VSTRACE_MAX_ARGS];
+}VSTRACE_RECORD_T;
+
+
+extern volatile int	gVSTraceOn;
+
+#define	_VS_TRACE(...)		do { if (gVSTraceOn) _VS_Trace(__VA_ARGS__); } while (0)
+
+//starts draining into path, truncated; -1 if it cannot be created or a trace is running
+int		_VS_TraceStart(const char *path);
+//writes what is still in the rings and closes the file
+void	_VS_TraceStop();
+//use _VS_TRACE, which skips the call while no trace is running
+void	_VS_Trace(unsigned int event, int arg0=0, int arg1=0, int arg2=0, int arg3=0, int arg4=0);
+
+
+#endif